@@ -21,10 +21,14 @@
 
 #include <stdio.h>
 
+#include "SWGChannelSettings.h"
+#include "SWGChannelAnalyzerSettings.h"
+
 #include "device/deviceapi.h"
 #include "audio/audiooutput.h"
 #include "dsp/dspcommands.h"
 #include "chanalyzer.h"
+#include "chanalyzerwebapiadapter.h"
 
 MESSAGE_CLASS_DEFINITION(ChannelAnalyzer::MsgConfigureChannelAnalyzer, Message)
 
@@ -35,14 +39,20 @@ ChannelAnalyzer::ChannelAnalyzer(DeviceAPI *deviceAPI) :
         ChannelAPI(m_channelIdURI, ChannelAPI::StreamSingleSink),
         m_deviceAPI(deviceAPI),
         m_spectrumVis(SDR_RX_SCALEF),
+        m_spectrumScopeComboVis(&m_spectrumVis, &m_scopeVis),
         m_basebandSampleRate(0)
 {
     qDebug("ChannelAnalyzer::ChannelAnalyzer");
     setObjectName(m_channelId);
 
     m_basebandSink = new ChannelAnalyzerBaseband();
+    m_basebandSink->setSampleSink(&m_spectrumScopeComboVis);
     m_basebandSink->moveToThread(&m_thread);
 
+    // same default trace and trigger as the scope GUI
+    m_scopeSettings.m_tracesData.push_back(GLScopeSettings::TraceData());
+    m_scopeSettings.m_triggersData.push_back(GLScopeSettings::TriggerData());
+
 	applySettings(m_settings, true);
 
     m_deviceAPI->addChannelSink(this);
@@ -112,6 +122,7 @@ bool ChannelAnalyzer::handleMessage(const Message& cmd)
         m_centerFrequency = cfg.getCenterFrequency();
         DSPSignalNotification *notif = new DSPSignalNotification(cfg);
         m_basebandSink->getInputMessageQueue()->push(notif);
+        setScopeLiveRate(m_settings);
 
         if (getMessageQueueToGUI())
         {
@@ -141,11 +152,194 @@ void ChannelAnalyzer::applySettings(const ChannelAnalyzerSettings& settings, boo
             << " m_pll: " << settings.m_pll
             << " m_fll: " << settings.m_fll
             << " m_pllPskOrder: " << settings.m_pllPskOrder
-            << " m_inputType: " << (int) settings.m_inputType;
+            << " m_inputType: " << (int) settings.m_inputType
+            << " m_wsScope: " << settings.m_wsScope
+            << " m_wsScopeAddress: " << settings.m_wsScopeAddress
+            << " m_wsScopePort: " << settings.m_wsScopePort;
 
     ChannelAnalyzerBaseband::MsgConfigureChannelAnalyzerBaseband *msg
         = ChannelAnalyzerBaseband::MsgConfigureChannelAnalyzerBaseband::create(settings, force);
     m_basebandSink->getInputMessageQueue()->push(msg);
 
+    if ((settings.m_inputType != m_settings.m_inputType) || force)
+    {
+        if (settings.m_inputType == ChannelAnalyzerSettings::InputAutoCorr) {
+            m_scopeVis.setTraceChunkSize(ChannelAnalyzerSink::m_corrFFTLen);
+        } else {
+            m_scopeVis.setTraceChunkSize(ScopeVis::m_traceChunkDefaultSize);
+        }
+    }
+
+    if ((settings.m_rationalDownSample != m_settings.m_rationalDownSample)
+     || (settings.m_rationalDownSamplerRate != m_settings.m_rationalDownSamplerRate)
+     || (settings.m_log2Decim != m_settings.m_log2Decim) || force)
+    {
+        setScopeLiveRate(settings);
+    }
+
+    if ((settings.m_wsScopeAddress != m_settings.m_wsScopeAddress)
+     || (settings.m_wsScopePort != m_settings.m_wsScopePort) || force)
+    {
+        m_scopeVis.configureWSScope(settings.m_wsScopeAddress, settings.m_wsScopePort);
+    }
+
+    if ((settings.m_wsScope != m_settings.m_wsScope) || force)
+    {
+        if (settings.m_wsScope) {
+            m_scopeVis.openWSScope();
+        } else {
+            m_scopeVis.closeWSScope();
+        }
+    }
+
+    // Without GUI the traces and triggers come from the API scope configuration. The GUI sets them otherwise.
+    if (!getMessageQueueToGUI() && settings.m_wsScope
+     && ((settings.m_wsScope != m_settings.m_wsScope) || (settings.m_inputType != m_settings.m_inputType) || force))
+    {
+        applyScopeSettings(m_scopeSettings); // trace length follows the chunk size
+    }
+
     m_settings = settings;
 }
+
+void ChannelAnalyzer::setScopeLiveRate(const ChannelAnalyzerSettings& settings)
+{
+    int sinkSampleRate = settings.m_rationalDownSample ?
+        settings.m_rationalDownSamplerRate
+        : m_basebandSampleRate / (1<<settings.m_log2Decim);
+    m_scopeVis.setLiveRate(sinkSampleRate == 0 ? 48000 : sinkSampleRate);
+}
+
+void ChannelAnalyzer::applyScopeSettings(const GLScopeSettings& scopeSettings)
+{
+    // same conversions as GLScopeGUI from its controls
+    uint32_t traceSize = scopeSettings.m_traceLen * m_scopeVis.getTraceChunkSize();
+    m_scopeVis.configure(
+        traceSize,
+        scopeSettings.m_time,
+        scopeSettings.m_timeOfs*10,
+        (uint32_t) (traceSize * (scopeSettings.m_trigPre/100.0f)),
+        m_scopeVis.getFreeRun()
+    );
+
+    uint32_t nbTraces = m_scopeVis.getTracesData().size();
+
+    for (uint32_t iTrace = nbTraces; iTrace > scopeSettings.m_tracesData.size(); iTrace--) {
+        m_scopeVis.removeTrace(iTrace - 1);
+    }
+
+    for (uint32_t iTrace = 0; iTrace < scopeSettings.m_tracesData.size(); iTrace++)
+    {
+        const GLScopeSettings::TraceData& settingsTrace = scopeSettings.m_tracesData[iTrace];
+        ScopeVis::TraceData traceData;
+        traceData.m_projectionType = settingsTrace.m_projectionType;
+        traceData.m_inputIndex = settingsTrace.m_inputIndex;
+        traceData.m_amp = settingsTrace.m_amp;
+        traceData.m_ampIndex = settingsTrace.m_ampIndex;
+        traceData.m_ofs = settingsTrace.m_ofs;
+        traceData.m_ofsCoarse = settingsTrace.m_ofsCoarse;
+        traceData.m_ofsFine = settingsTrace.m_ofsFine;
+        traceData.m_traceDelay = settingsTrace.m_traceDelay;
+        traceData.m_traceDelayCoarse = settingsTrace.m_traceDelayCoarse;
+        traceData.m_traceDelayFine = settingsTrace.m_traceDelayFine;
+        traceData.m_triggerDisplayLevel = settingsTrace.m_triggerDisplayLevel;
+        traceData.setColor(settingsTrace.m_traceColor);
+        traceData.m_hasTextOverlay = settingsTrace.m_hasTextOverlay;
+        traceData.m_textOverlay = settingsTrace.m_textOverlay;
+        traceData.m_viewTrace = settingsTrace.m_viewTrace;
+
+        if (iTrace < nbTraces) {
+            m_scopeVis.changeTrace(traceData, iTrace);
+        } else {
+            m_scopeVis.addTrace(traceData);
+        }
+    }
+
+    uint32_t nbTriggers = m_scopeVis.getNbTriggers();
+
+    for (uint32_t iTrigger = nbTriggers; iTrigger > scopeSettings.m_triggersData.size(); iTrigger--) {
+        m_scopeVis.removeTrigger(iTrigger - 1);
+    }
+
+    for (uint32_t iTrigger = 0; iTrigger < scopeSettings.m_triggersData.size(); iTrigger++)
+    {
+        const GLScopeSettings::TriggerData& settingsTrigger = scopeSettings.m_triggersData[iTrigger];
+        ScopeVis::TriggerData triggerData;
+        triggerData.m_projectionType = settingsTrigger.m_projectionType;
+        triggerData.m_inputIndex = settingsTrigger.m_inputIndex;
+        triggerData.m_triggerLevel = settingsTrigger.m_triggerLevel;
+        triggerData.m_triggerLevelCoarse = settingsTrigger.m_triggerLevelCoarse;
+        triggerData.m_triggerLevelFine = settingsTrigger.m_triggerLevelFine;
+        triggerData.m_triggerPositiveEdge = settingsTrigger.m_triggerPositiveEdge;
+        triggerData.m_triggerBothEdges = settingsTrigger.m_triggerBothEdges;
+        triggerData.m_triggerHoldoff = settingsTrigger.m_triggerHoldoff;
+        triggerData.m_triggerDelay = settingsTrigger.m_triggerDelay;
+        triggerData.m_triggerDelayMult = settingsTrigger.m_triggerDelayMult;
+        triggerData.m_triggerDelayCoarse = settingsTrigger.m_triggerDelayCoarse;
+        triggerData.m_triggerDelayFine = settingsTrigger.m_triggerDelayFine;
+        triggerData.m_triggerRepeat = settingsTrigger.m_triggerRepeat;
+        triggerData.setColor(settingsTrigger.m_triggerColor);
+
+        if (iTrigger < nbTriggers) {
+            m_scopeVis.changeTrigger(triggerData, iTrigger);
+        } else {
+            m_scopeVis.addTrigger(triggerData);
+        }
+    }
+}
+
+int ChannelAnalyzer::webapiSettingsGet(
+        SWGSDRangel::SWGChannelSettings& response,
+        QString& errorMessage)
+{
+    (void) errorMessage;
+    response.setChannelAnalyzerSettings(new SWGSDRangel::SWGChannelAnalyzerSettings());
+    response.getChannelAnalyzerSettings()->init();
+    ChannelAnalyzerWebAPIAdapter::webapiFormatChannelSettings(response, m_settings, m_scopeSettings, m_spectrumSettings);
+    return 200;
+}
+
+int ChannelAnalyzer::webapiSettingsPutPatch(
+        bool force,
+        const QStringList& channelSettingsKeys,
+        SWGSDRangel::SWGChannelSettings& response,
+        QString& errorMessage)
+{
+    (void) errorMessage;
+    ChannelAnalyzerSettings settings = m_settings;
+    ChannelAnalyzerWebAPIAdapter::webapiUpdateChannelSettings(settings, m_scopeSettings, m_spectrumSettings, channelSettingsKeys, response);
+
+    MsgConfigureChannelAnalyzer *msg = MsgConfigureChannelAnalyzer::create(settings, force);
+    m_inputMessageQueue.push(msg);
+
+    qDebug("ChannelAnalyzer::webapiSettingsPutPatch: forward to GUI: %p", getMessageQueueToGUI());
+    if (getMessageQueueToGUI()) // forward to GUI if any
+    {
+        MsgConfigureChannelAnalyzer *msgToGUI = MsgConfigureChannelAnalyzer::create(settings, force);
+        getMessageQueueToGUI()->push(msgToGUI);
+    }
+    else // the scope and spectrum are configured from the GUI controls when there is a GUI
+    {
+        if (channelSettingsKeys.contains("scopeConfig")) {
+            applyScopeSettings(m_scopeSettings);
+        }
+
+        if (channelSettingsKeys.contains("spectrumConfig"))
+        {
+            m_spectrumVis.configure(
+                m_spectrumSettings.m_fftSize,
+                m_spectrumSettings.m_refLevel,
+                m_spectrumSettings.m_powerRange,
+                m_spectrumSettings.m_fftOverlap,
+                m_spectrumSettings.m_averagingNb,
+                (SpectrumVis::AvgMode) m_spectrumSettings.m_averagingMode,
+                (FFTWindow::Function) m_spectrumSettings.m_fftWindow,
+                m_spectrumSettings.m_linear
+            );
+        }
+    }
+
+    ChannelAnalyzerWebAPIAdapter::webapiFormatChannelSettings(response, settings, m_scopeSettings, m_spectrumSettings);
+
+    return 200;
+}
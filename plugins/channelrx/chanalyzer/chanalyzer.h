@@ -24,6 +24,10 @@
 
 #include "dsp/basebandsamplesink.h"
 #include "dsp/spectrumvis.h"
+#include "dsp/scopevis.h"
+#include "dsp/spectrumscopecombovis.h"
+#include "dsp/glscopesettings.h"
+#include "dsp/glspectrumsettings.h"
 #include "channel/channelapi.h"
 #include "util/message.h"
 #include "util/movingaverage.h"
@@ -60,7 +64,7 @@ public:
 	virtual ~ChannelAnalyzer();
 	virtual void destroy() { delete this; }
     SpectrumVis *getSpectrumVis() { return &m_spectrumVis; }
-    void setSampleSink(BasebandSampleSink *sink) { m_basebandSink->setSampleSink(sink); }
+    ScopeVis *getScopeVis() { return &m_scopeVis; }
 
     int getChannelSampleRate() const { return m_basebandSink->getChannelSampleRate(); }
     int getDecimation() const { return 1<<m_settings.m_log2Decim; }
@@ -94,6 +98,16 @@ public:
         return m_settings.m_inputFrequencyOffset;
     }
 
+    virtual int webapiSettingsGet(
+            SWGSDRangel::SWGChannelSettings& response,
+            QString& errorMessage);
+
+    virtual int webapiSettingsPutPatch(
+            bool force,
+            const QStringList& channelSettingsKeys,
+            SWGSDRangel::SWGChannelSettings& response,
+            QString& errorMessage);
+
     static const QString m_channelIdURI;
     static const QString m_channelId;
 
@@ -103,10 +117,16 @@ private:
     ChannelAnalyzerBaseband *m_basebandSink;
     ChannelAnalyzerSettings m_settings;
     SpectrumVis m_spectrumVis;
+    ScopeVis m_scopeVis;
+    SpectrumScopeComboVis m_spectrumScopeComboVis;
+    GLScopeSettings m_scopeSettings;       //!< scope configuration from the API used without GUI
+    GLSpectrumSettings m_spectrumSettings; //!< spectrum configuration from the API used without GUI
     int m_basebandSampleRate; //!< stored from device message used when starting baseband sink
     qint64 m_centerFrequency; //!< stored from device message used when starting baseband sink
 
 	void applySettings(const ChannelAnalyzerSettings& settings, bool force = false);
+    void applyScopeSettings(const GLScopeSettings& scopeSettings);
+    void setScopeLiveRate(const ChannelAnalyzerSettings& settings);
 };
 
 #endif // INCLUDE_CHANALYZER_H
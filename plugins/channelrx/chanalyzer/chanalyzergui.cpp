@@ -19,7 +19,7 @@
 #include <QMainWindow>
 
 #include "device/deviceuiset.h"
-#include "dsp/spectrumscopecombovis.h"
+#include "dsp/scopevis.h"
 #include "dsp/spectrumvis.h"
 #include "dsp/dspengine.h"
 #include "dsp/dspcommands.h"
@@ -161,7 +161,17 @@ bool ChannelAnalyzerGUI::deserialize(const QByteArray& data)
 
 bool ChannelAnalyzerGUI::handleMessage(const Message& message)
 {
-    if (DSPSignalNotification::match(message))
+    if (ChannelAnalyzer::MsgConfigureChannelAnalyzer::match(message))
+    {
+        qDebug("ChannelAnalyzerGUI::handleMessage: ChannelAnalyzer::MsgConfigureChannelAnalyzer");
+        const ChannelAnalyzer::MsgConfigureChannelAnalyzer& cfg = (ChannelAnalyzer::MsgConfigureChannelAnalyzer&) message;
+        m_settings = cfg.getSettings();
+        blockApplySettings(true);
+        displaySettings();
+        blockApplySettings(false);
+        return true;
+    }
+    else if (DSPSignalNotification::match(message))
     {
         DSPSignalNotification& cmd = (DSPSignalNotification&) message;
         m_basebandSampleRate = cmd.getSampleRate();
@@ -367,16 +377,15 @@ ChannelAnalyzerGUI::ChannelAnalyzerGUI(PluginAPI* pluginAPI, DeviceUISet *device
 	ui->setupUi(this);
 	setAttribute(Qt::WA_DeleteOnClose, true);
 	connect(this, SIGNAL(widgetRolled(QWidget*,bool)), this, SLOT(onWidgetRolled(QWidget*,bool)));
-	m_scopeVis = new ScopeVis(ui->glScope);
 
 	connect(this, SIGNAL(customContextMenuRequested(const QPoint &)), this, SLOT(onMenuDialogCalled(const QPoint &)));
 
 	m_channelAnalyzer = (ChannelAnalyzer*) rxChannel;
     m_spectrumVis = m_channelAnalyzer->getSpectrumVis();
 	m_spectrumVis->setGLSpectrum(ui->glSpectrum);
-	m_spectrumScopeComboVis = new SpectrumScopeComboVis(m_spectrumVis, m_scopeVis);
+    m_scopeVis = m_channelAnalyzer->getScopeVis();
+    m_scopeVis->setGLScope(ui->glScope);
     m_basebandSampleRate = m_channelAnalyzer->getChannelSampleRate();
-    m_channelAnalyzer->setSampleSink(m_spectrumScopeComboVis);
 	m_channelAnalyzer->setMessageQueueToGUI(getInputMessageQueue());
 
     ui->deltaFrequencyLabel->setText(QString("%1f").arg(QChar(0x94, 0x03)));
@@ -429,9 +438,8 @@ ChannelAnalyzerGUI::~ChannelAnalyzerGUI()
     qDebug("ChannelAnalyzerGUI::~ChannelAnalyzerGUI");
 	ui->glSpectrum->disconnectTimer();
 	ui->glScope->disconnectTimer();
+    m_scopeVis->setGLScope(nullptr);
 	delete ui;
-	delete m_spectrumScopeComboVis;
-	delete m_scopeVis;
     qDebug("ChannelAnalyzerGUI::~ChannelAnalyzerGUI: done");
 }
 
@@ -459,8 +467,6 @@ void ChannelAnalyzerGUI::setSinkSampleRate()
 
 	QString s = QString::number(sinkSampleRate/1000.0, 'f', 1);
 	ui->sinkSampleRateText->setText(tr("%1 kS/s").arg(s));
-
-	m_scopeVis->setLiveRate(sinkSampleRate == 0 ? 48000 : sinkSampleRate);
 }
 
 void ChannelAnalyzerGUI::setFiltersUIBoundaries()
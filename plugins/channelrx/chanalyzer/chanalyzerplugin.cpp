@@ -18,9 +18,11 @@
 #include <QtPlugin>
 
 #include "plugin/pluginapi.h"
+#ifndef SERVER_MODE
+#include "chanalyzergui.h"
+#endif
 #include "chanalyzer.h"
 #include "chanalyzerplugin.h"
-#include "chanalyzergui.h"
 #include "chanalyzerwebapiadapter.h"
 
 const PluginDescriptor ChannelAnalyzerPlugin::m_pluginDescriptor = {
@@ -68,10 +70,19 @@ void ChannelAnalyzerPlugin::createRxChannel(DeviceAPI *deviceAPI, BasebandSample
 	}
 }
 
+#ifdef SERVER_MODE
+ChannelGUI* ChannelAnalyzerPlugin::createRxChannelGUI(
+        DeviceUISet *deviceUISet,
+        BasebandSampleSink *rxChannel) const
+{
+    return 0;
+}
+#else
 ChannelGUI* ChannelAnalyzerPlugin::createRxChannelGUI(DeviceUISet *deviceUISet, BasebandSampleSink *rxChannel) const
 {
     return ChannelAnalyzerGUI::create(m_pluginAPI, deviceUISet, rxChannel);
 }
+#endif
 
 ChannelWebAPIAdapter* ChannelAnalyzerPlugin::createChannelWebAPIAdapter() const
 {
@@ -48,6 +48,9 @@ void ChannelAnalyzerSettings::resetToDefaults()
     m_inputType = InputSignal;
     m_rgbColor = QColor(128, 128, 128).rgb();
     m_title = "Channel Analyzer";
+    m_wsScope = false;
+    m_wsScopeAddress = "127.0.0.1";
+    m_wsScopePort = 8888;
 }
 
 QByteArray ChannelAnalyzerSettings::serialize() const
@@ -71,6 +74,9 @@ QByteArray ChannelAnalyzerSettings::serialize() const
     s.writeString(15, m_title);
     s.writeBool(16, m_rrc);
     s.writeU32(17, m_rrcRolloff);
+    s.writeBool(18, m_wsScope);
+    s.writeString(19, m_wsScopeAddress);
+    s.writeU32(20, m_wsScopePort);
 
     return s.final();
 }
@@ -89,6 +95,7 @@ bool ChannelAnalyzerSettings::deserialize(const QByteArray& data)
     {
         QByteArray bytetmp;
         int tmp;
+        uint32_t utmp;
 
         d.readS32(1, &m_inputFrequencyOffset, 0);
         d.readS32(2, &m_bandwidth, 5000);
@@ -118,6 +125,15 @@ bool ChannelAnalyzerSettings::deserialize(const QByteArray& data)
         d.readString(15, &m_title, "Channel Analyzer");
         d.readBool(16, &m_rrc, false);
         d.readU32(17, &m_rrcRolloff, 35);
+        d.readBool(18, &m_wsScope, false);
+        d.readString(19, &m_wsScopeAddress, "127.0.0.1");
+        d.readU32(20, &utmp, 0);
+
+        if ((utmp > 1023) && (utmp < 65535)) {
+            m_wsScopePort = utmp;
+        } else {
+            m_wsScopePort = 8888;
+        }
 
         return true;
     }
@@ -46,6 +46,9 @@ struct ChannelAnalyzerSettings
     InputType m_inputType;
     quint32 m_rgbColor;
     QString m_title;
+    bool m_wsScope;            //!< stream the scope traces to websocket clients
+    QString m_wsScopeAddress;  //!< websocket listening address
+    uint16_t m_wsScopePort;    //!< websocket listening port
     Serializable *m_channelMarker;
     Serializable *m_spectrumGUI;
     Serializable *m_scopeGUI;
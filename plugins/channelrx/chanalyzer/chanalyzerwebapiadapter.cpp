@@ -61,6 +61,9 @@ void ChannelAnalyzerWebAPIAdapter::webapiFormatChannelSettings(
     response.getChannelAnalyzerSettings()->setInputType((int) settings.m_inputType);
     response.getChannelAnalyzerSettings()->setRgbColor(settings.m_rgbColor);
     response.getChannelAnalyzerSettings()->setTitle(new QString(settings.m_title));
+    response.getChannelAnalyzerSettings()->setWsScope(settings.m_wsScope ? 1 : 0);
+    response.getChannelAnalyzerSettings()->setWsScopeAddress(new QString(settings.m_wsScopeAddress));
+    response.getChannelAnalyzerSettings()->setWsScopePort(settings.m_wsScopePort);
 
     // scope
     SWGSDRangel::SWGGLScope *swgScope = new SWGSDRangel::SWGGLScope();
@@ -210,6 +213,15 @@ void ChannelAnalyzerWebAPIAdapter::webapiUpdateChannelSettings(
     if (channelSettingsKeys.contains("title")) {
         settings.m_title = *response.getChannelAnalyzerSettings()->getTitle();
     }
+    if (channelSettingsKeys.contains("wsScope")) {
+        settings.m_wsScope = response.getChannelAnalyzerSettings()->getWsScope() != 0;
+    }
+    if (channelSettingsKeys.contains("wsScopeAddress")) {
+        settings.m_wsScopeAddress = *response.getChannelAnalyzerSettings()->getWsScopeAddress();
+    }
+    if (channelSettingsKeys.contains("wsScopePort")) {
+        settings.m_wsScopePort = response.getChannelAnalyzerSettings()->getWsScopePort();
+    }
     // scope
     if (channelSettingsKeys.contains("scopeConfig"))
     {
@@ -23,6 +23,8 @@
 #define ADS_B_PREAMBLE_CHIPS    (ADS_B_PREAMBLE_BITS*ADS_B_CHIPS_PER_BIT)
 #define ADS_B_ES_BITS           112
 #define ADS_B_ES_BYTES          (ADS_B_ES_BITS/8)
+#define ADS_B_SHORT_BITS        56
+#define ADS_B_SHORT_BYTES       (ADS_B_SHORT_BITS/8)
 #define ADS_B_DF_MASK           0x1f
 #define ADS_B_BITS_PER_SECOND   1000000
 
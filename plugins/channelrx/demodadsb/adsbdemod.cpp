@@ -42,6 +42,7 @@
 #include "adsbdemodworker.h"
 
 MESSAGE_CLASS_DEFINITION(ADSBDemod::MsgConfigureADSBDemod, Message)
+MESSAGE_POOL_DEFINITION(ADSBDemod::MsgConfigureADSBDemod)
 
 const QString ADSBDemod::m_channelIdURI = "sdrangel.channel.adsbdemod";
 const QString ADSBDemod::m_channelId = "ADSBDemod";
@@ -118,9 +119,10 @@ void ADSBDemod::start()
 void ADSBDemod::stop()
 {
     qDebug() << "ADSBDemod::stop";
-    m_worker->stopWork();
     m_thread->exit();
     m_thread->wait();
+    m_basebandSink->flushReports(); // frames still being decoded are reported before the worker stops
+    m_worker->stopWork();
 }
 
 bool ADSBDemod::handleMessage(const Message& cmd)
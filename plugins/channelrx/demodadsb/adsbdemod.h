@@ -27,6 +27,7 @@
 #include "dsp/basebandsamplesink.h"
 #include "channel/channelapi.h"
 #include "util/message.h"
+#include "util/messagepool.h"
 
 #include "adsbdemodbaseband.h"
 #include "adsbdemodsettings.h"
@@ -42,6 +43,7 @@ class ADSBDemod : public BasebandSampleSink, public ChannelAPI {
 public:
     class MsgConfigureADSBDemod : public Message {
         MESSAGE_CLASS_DECLARATION
+        MESSAGE_POOL_DECLARATION
 
     public:
         const ADSBDemodSettings& getSettings() const { return m_settings; }
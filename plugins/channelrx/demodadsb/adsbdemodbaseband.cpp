@@ -26,6 +26,7 @@
 #include "adsb.h"
 
 MESSAGE_CLASS_DEFINITION(ADSBDemodBaseband::MsgConfigureADSBDemodBaseband, Message)
+MESSAGE_POOL_DEFINITION(ADSBDemodBaseband::MsgConfigureADSBDemodBaseband)
 
 ADSBDemodBaseband::ADSBDemodBaseband() :
     m_mutex(QMutex::Recursive)
@@ -56,6 +57,12 @@ void ADSBDemodBaseband::reset()
     m_sampleFifo.reset();
 }
 
+void ADSBDemodBaseband::flushReports()
+{
+    QMutexLocker mutexLocker(&m_mutex);
+    m_sink.flushReports();
+}
+
 void ADSBDemodBaseband::feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end)
 {
     m_sampleFifo.write(begin, end);
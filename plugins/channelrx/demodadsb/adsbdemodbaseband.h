@@ -24,6 +24,7 @@
 
 #include "dsp/samplesinkfifo.h"
 #include "util/message.h"
+#include "util/messagepool.h"
 #include "util/messagequeue.h"
 
 #include "adsbdemodsink.h"
@@ -36,6 +37,7 @@ class ADSBDemodBaseband : public QObject
 public:
     class MsgConfigureADSBDemodBaseband : public Message {
         MESSAGE_CLASS_DECLARATION
+        MESSAGE_POOL_DECLARATION
 
     public:
         const ADSBDemodSettings& getSettings() const { return m_settings; }
@@ -60,6 +62,7 @@ public:
     ADSBDemodBaseband();
     ~ADSBDemodBaseband();
     void reset();
+    void flushReports(); //!< reports the frames still being decoded. Call with the baseband thread stopped.
     void feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end);
     MessageQueue *getInputMessageQueue() { return &m_inputMessageQueue; } //!< Get the queue for asynchronous inbound communication
     int getChannelSampleRate() const;
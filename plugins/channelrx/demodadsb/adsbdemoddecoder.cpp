@@ -0,0 +1,207 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+
+#include <QDebug>
+
+#include "util/crc.h"
+
+#include "adsbdemoddecoder.h"
+
+const int ADSBDemodDecoder::m_maxWorkers;
+
+ADSBDemodDecoder::ADSBDemodDecoder(int nbWorkers) :
+    m_candidates(m_nbCandidates),
+    m_head(0),
+    m_committed(0),
+    m_tail(0),
+    m_claimed(0),
+    m_stop(false)
+{
+    if (nbWorkers < 0) {
+        nbWorkers = getDefaultNbWorkers();
+    }
+
+    for (int i = 0; i < nbWorkers; i++)
+    {
+        m_workers.push_back(new Worker(this));
+        m_workers.back()->start();
+    }
+
+    qDebug("ADSBDemodDecoder::ADSBDemodDecoder: %d workers", nbWorkers);
+}
+
+ADSBDemodDecoder::~ADSBDemodDecoder()
+{
+    m_stop.store(true);
+    m_available.release(m_workers.size());
+
+    for (auto worker : m_workers)
+    {
+        worker->wait();
+        delete worker;
+    }
+}
+
+int ADSBDemodDecoder::getDefaultNbWorkers()
+{
+    // one core is left to the channel thread
+    return std::max(0, std::min(m_maxWorkers, QThread::idealThreadCount() - 1));
+}
+
+ADSBDemodDecoder::Candidate *ADSBDemodDecoder::getNextCandidate()
+{
+    if (m_head - m_tail == m_nbCandidates) {
+        return nullptr;
+    }
+
+    return &m_candidates[m_head & (m_nbCandidates - 1)];
+}
+
+void ADSBDemodDecoder::push()
+{
+    m_candidates[m_head & (m_nbCandidates - 1)].m_done.store(false, std::memory_order_relaxed);
+    m_head++;
+}
+
+void ADSBDemodDecoder::commit()
+{
+    int nbCommitted = m_head - m_committed;
+
+    if (nbCommitted == 0) {
+        return;
+    }
+
+    if (m_workers.size() == 0)
+    {
+        for (; m_committed < m_head; m_committed++)
+        {
+            Candidate& candidate = m_candidates[m_committed & (m_nbCandidates - 1)];
+            decode(candidate);
+            candidate.m_done.store(true, std::memory_order_relaxed);
+        }
+
+        return;
+    }
+
+    m_committed = m_head;
+    m_available.release(nbCommitted); // publishes the slots contents
+}
+
+ADSBDemodDecoder::Candidate *ADSBDemodDecoder::front(bool wait)
+{
+    if (m_tail == m_head) {
+        return nullptr;
+    }
+
+    Candidate& candidate = m_candidates[m_tail & (m_nbCandidates - 1)];
+
+    if (!candidate.m_done.load(std::memory_order_acquire))
+    {
+        if (!wait) {
+            return nullptr;
+        }
+
+        commit();
+
+        while (!candidate.m_done.load(std::memory_order_acquire)) {
+            QThread::yieldCurrentThread(); // a frame takes a few microseconds to decode
+        }
+    }
+
+    return &candidate;
+}
+
+void ADSBDemodDecoder::pop()
+{
+    m_tail++;
+}
+
+void ADSBDemodDecoder::clear()
+{
+    while (front(true)) {
+        pop();
+    }
+}
+
+void ADSBDemodDecoder::work()
+{
+    while (true)
+    {
+        m_available.acquire();
+
+        if (m_stop.load()) {
+            break;
+        }
+
+        quint64 index = m_claimed.fetch_add(1);
+        Candidate& candidate = m_candidates[index & (m_nbCandidates - 1)];
+        decode(candidate);
+        candidate.m_done.store(true, std::memory_order_release);
+    }
+}
+
+void ADSBDemodDecoder::Worker::run()
+{
+    m_decoder->work();
+}
+
+void ADSBDemodDecoder::decode(Candidate& candidate)
+{
+    // PPM (Pulse position modulation) - Each bit spreads to two chips, 1->10, 0->01
+    // Determine if bit is 1 or 0, by seeing which chip has largest combined energy over the sampling period
+    int nbBytes = ADS_B_ES_BYTES;
+    const Real *chips = candidate.m_chips;
+    candidate.m_length = 0;
+
+    for (int byteIdx = 0; byteIdx < nbBytes; byteIdx++)
+    {
+        unsigned char currentByte = 0;
+
+        // Convert bits to bytes - MSB first
+        for (int bit = 7; bit >= 0; bit--, chips += 2) {
+            currentByte |= (chips[0] > chips[1]) << bit;
+        }
+
+        candidate.m_data[byteIdx] = currentByte;
+
+        if (byteIdx == 0)
+        {
+            // Downlink format. ADS-B extended squitters (17) and TIS-B / non transponder squitters (18) are long frames.
+            // All call replies (11) are short frames giving the ICAO address that Mode S receivers use for acquisition.
+            int df = (currentByte >> 3) & ADS_B_DF_MASK;
+
+            if (df == 11) {
+                nbBytes = ADS_B_SHORT_BYTES;
+            } else if ((df != 17) && (df != 18)) {
+                return;
+            }
+        }
+    }
+
+    crcadsb crc;
+    int parity = (candidate.m_data[nbBytes-3] << 16) | (candidate.m_data[nbBytes-2] << 8) | candidate.m_data[nbBytes-1]; // Parity / CRC
+
+    crc.calculate(candidate.m_data, nbBytes-3);
+
+    // all call replies parity is overlaid with the interrogator identifier. Only the replies to
+    // acquisition squitters (identifier 0) can be checked without knowing the interrogator.
+    if (parity == (int) crc.get()) {
+        candidate.m_length = nbBytes;
+    }
+}
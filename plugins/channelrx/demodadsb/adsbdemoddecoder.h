@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_ADSBDEMODDECODER_H
+#define INCLUDE_ADSBDEMODDECODER_H
+
+#include <atomic>
+#include <vector>
+
+#include <QThread>
+#include <QSemaphore>
+
+#include "dsp/dsptypes.h"
+
+#include "adsb.h"
+
+/**
+ * Decodes the frame candidates found by the sink preamble detector on worker threads.
+ *
+ * The sink (single producer) fills candidates in a ring of fixed slots and commits them once
+ * per block of detected windows. Workers claim the committed slots with an atomic counter and
+ * only sleep on a semaphore when there is nothing left to decode. The sink takes the decoded
+ * candidates back in detection order so that the frames it reports and the windows it skips
+ * are the same as if they were decoded inline.
+ *
+ * With no worker threads (single core host) commit decodes the candidates immediately.
+ */
+class ADSBDemodDecoder
+{
+public:
+    struct Candidate
+    {
+        quint64 m_position;             //!< sample index of the preamble start
+        Real m_preambleCorrelationOnes;
+        Real m_preambleCorrelationZeros;
+        Real m_chips[2*ADS_B_ES_BITS];  //!< energy in the first and second chip of each bit
+        // decoding result
+        int m_length;                   //!< frame bytes: ADS_B_ES_BYTES, ADS_B_SHORT_BYTES or 0 if not valid
+        unsigned char m_data[ADS_B_ES_BYTES];
+        std::atomic<bool> m_done;
+    };
+
+    ADSBDemodDecoder(int nbWorkers = -1); //!< -1 for getDefaultNbWorkers()
+    ~ADSBDemodDecoder();
+
+    int getNbWorkers() const { return (int) m_workers.size(); }
+    Candidate *getNextCandidate(); //!< slot to fill or nullptr if all slots are in flight
+    void push();    //!< the slot given by getNextCandidate is filled
+    void commit();  //!< hands the candidates pushed since the last commit to the workers
+    Candidate *front(bool wait); //!< oldest candidate if decoded (or when decoded if wait) else nullptr. nullptr also if nothing is in flight.
+    void pop();     //!< releases the candidate given by front
+    void clear();   //!< waits for the candidates in flight and drops them
+
+    static void decode(Candidate& candidate);
+    static int getDefaultNbWorkers();
+    static const int m_maxWorkers = 2;
+
+private:
+    class Worker : public QThread
+    {
+    public:
+        Worker(ADSBDemodDecoder *decoder) : m_decoder(decoder) {}
+    protected:
+        virtual void run();
+    private:
+        ADSBDemodDecoder *m_decoder;
+    };
+
+    static const unsigned int m_nbCandidates = 256; //!< power of two
+
+    std::vector<Candidate> m_candidates;
+    std::vector<Worker*> m_workers;
+    quint64 m_head;       //!< next slot to fill (producer only)
+    quint64 m_committed;  //!< slots before are visible to the workers (producer only)
+    quint64 m_tail;       //!< oldest slot in flight (producer only)
+    std::atomic<quint64> m_claimed; //!< next slot to decode
+    std::atomic<bool> m_stop;
+    QSemaphore m_available; //!< committed candidates not claimed yet
+
+    void work();
+};
+
+#endif // INCLUDE_ADSBDEMODDECODER_H
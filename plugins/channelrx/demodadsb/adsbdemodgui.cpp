@@ -608,13 +608,23 @@ void ADSBDemodGUI::handleADSB(const QByteArray data, const QDateTime dateTime, f
 
 bool ADSBDemodGUI::handleMessage(const Message& message)
 {
-    if (ADSBDemodReport::MsgReportADSB::match(message))
+    if (ADSBDemodReport::MsgReportADSBBatch::match(message))
     {
-        ADSBDemodReport::MsgReportADSB& report = (ADSBDemodReport::MsgReportADSB&) message;
-        handleADSB(
-            report.getData(), report.getDateTime(),
-            report.getPreambleCorrelationOnes(),
-            report.getPreambleCorrelationZeros());
+        ADSBDemodReport::MsgReportADSBBatch& report = (ADSBDemodReport::MsgReportADSBBatch&) message;
+
+        for (int i = 0; i < report.getNbFrames(); i++)
+        {
+            // Mode S short frames are only forwarded by the worker
+            if (report.getFrame(i).m_length != ADS_B_ES_BYTES) {
+                continue;
+            }
+
+            handleADSB(
+                report.getData(i), report.getDateTime(i),
+                report.getPreambleCorrelationOnes(i),
+                report.getPreambleCorrelationZeros(i));
+        }
+
         return true;
     }
     else if (ADSBDemod::MsgConfigureADSBDemod::match(message))
@@ -18,4 +18,5 @@
 
 #include "adsbdemodreport.h"
 
-MESSAGE_CLASS_DEFINITION(ADSBDemodReport::MsgReportADSB, Message)
+MESSAGE_CLASS_DEFINITION(ADSBDemodReport::MsgReportADSBBatch, Message)
+MESSAGE_POOL_DEFINITION(ADSBDemodReport::MsgReportADSBBatch)
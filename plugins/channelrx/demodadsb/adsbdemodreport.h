@@ -19,45 +19,73 @@
 #ifndef PLUGINS_CHANNELRX_DEMOADSB_ADSBDEMODREPORT_H_
 #define PLUGINS_CHANNELRX_DEMOADSB_ADSBDEMODREPORT_H_
 
+#include <atomic>
+#include <memory>
+
 #include <QObject>
 #include <QByteArray>
 #include <QDateTime>
 
 #include "dsp/dsptypes.h"
 #include "util/message.h"
+#include "util/messagepool.h"
+
+#include "adsb.h"
 
 class ADSBDemodReport : public QObject
 {
     Q_OBJECT
 public:
-    class MsgReportADSB : public Message {
+    struct Frame
+    {
+        unsigned char m_data[ADS_B_ES_BYTES];
+        int m_length;           //!< bytes: ADS_B_ES_BYTES or ADS_B_SHORT_BYTES
+        qint64 m_msecsSinceEpoch;
+        float m_premableCorrelationOnes;
+        float m_premableCorrelationZeros;
+    };
+
+    /**
+     * Frames decoded over some time. Batches are recycled by the sink once all the messages
+     * referring to them have been deleted so that no memory is allocated per frame.
+     * The same batch is shared by the GUI and worker messages.
+     */
+    struct FrameBatch
+    {
+        static const int m_capacity = 64;
+        Frame m_frames[m_capacity];
+        int m_nbFrames;
+        std::atomic<int> m_readers; //!< messages not deleted yet
+
+        FrameBatch() : m_nbFrames(0), m_readers(0) {}
+    };
+
+    class MsgReportADSBBatch : public Message {
         MESSAGE_CLASS_DECLARATION
+        MESSAGE_POOL_DECLARATION
 
     public:
-        QByteArray getData() const { return m_data; }
-        QDateTime getDateTime() const { return m_dateTime; }
-        float getPreambleCorrelationOnes() const { return m_premableCorrelationOnes; }
-        float getPreambleCorrelationZeros() const { return m_premableCorrelationZeros; }
+        ~MsgReportADSBBatch() { m_batch->m_readers.fetch_sub(1, std::memory_order_release); }
 
-        static MsgReportADSB* create(QByteArray data, float premableCorrelationOnes, float premableCorrelationZeros)
+        int getNbFrames() const { return m_batch->m_nbFrames; }
+        const Frame& getFrame(int i) const { return m_batch->m_frames[i]; }
+        QByteArray getData(int i) const { return QByteArray::fromRawData((const char *) m_batch->m_frames[i].m_data, m_batch->m_frames[i].m_length); } //!< valid while the message exists
+        QDateTime getDateTime(int i) const { return QDateTime::fromMSecsSinceEpoch(m_batch->m_frames[i].m_msecsSinceEpoch); }
+        float getPreambleCorrelationOnes(int i) const { return m_batch->m_frames[i].m_premableCorrelationOnes; }
+        float getPreambleCorrelationZeros(int i) const { return m_batch->m_frames[i].m_premableCorrelationZeros; }
+
+        static MsgReportADSBBatch* create(const std::shared_ptr<FrameBatch>& batch) //!< m_readers is counted by the sender
         {
-            return new MsgReportADSB(data, premableCorrelationOnes, premableCorrelationZeros);
+            return new MsgReportADSBBatch(batch);
         }
 
     private:
-        QByteArray m_data;
-        QDateTime m_dateTime;
-        float m_premableCorrelationOnes;
-        float m_premableCorrelationZeros;
+        std::shared_ptr<FrameBatch> m_batch; //!< the batch outlives the sink if the message is still queued
 
-        MsgReportADSB(QByteArray data, float premableCorrelationOnes, float premableCorrelationZeros) :
+        MsgReportADSBBatch(const std::shared_ptr<FrameBatch>& batch) :
             Message(),
-            m_data(data),
-            m_premableCorrelationOnes(premableCorrelationOnes),
-            m_premableCorrelationZeros(premableCorrelationZeros)
-        {
-            m_dateTime = QDateTime::currentDateTime();
-        }
+            m_batch(batch)
+        { }
     };
 
 public:
@@ -17,6 +17,7 @@
 ///////////////////////////////////////////////////////////////////////////////////
 
 #include <stdio.h>
+#include <algorithm>
 #include <complex.h>
 #include <cmath>
 
@@ -25,7 +26,6 @@
 
 #include "util/stepfunctions.h"
 #include "util/db.h"
-#include "util/crc.h"
 #include "audio/audiooutput.h"
 #include "dsp/dspengine.h"
 #include "dsp/dspcommands.h"
@@ -36,27 +36,42 @@
 #include "adsbdemodsink.h"
 #include "adsb.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define ADSB_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ADSB_NEON
+#endif
+
 ADSBDemodSink::ADSBDemodSink() :
         m_channelSampleRate(6000000),
         m_channelFrequencyOffset(0),
-        m_sampleIdx(0),
-        m_sampleCount(0),
-        m_skipCount(0),
+        m_ringSize(0),
+        m_writeIndex(0),
+        m_nextPosition(0),
         m_correlationThresholdLinear(0.0),
+        m_lastFrameEnd(0),
+        m_reportBatchIndex(0),
+        m_reportBatchStart(0),
+        m_reportsDropped(0),
         m_magsq(0.0f),
         m_magsqSum(0.0f),
         m_magsqPeak(0.0f),
         m_magsqCount(0),
         m_messageQueueToGUI(nullptr),
-        m_sampleBuffer(nullptr)
+        m_messageQueueToWorker(nullptr)
 {
+    for (int i = 0; i < m_nbReportBatches; i++) {
+        m_reportBatches.push_back(std::make_shared<ADSBDemodReport::FrameBatch>());
+    }
+
     applySettings(m_settings, true);
     applyChannelSettings(m_channelSampleRate, m_channelFrequencyOffset, true);
 }
 
 ADSBDemodSink::~ADSBDemodSink()
 {
-    delete m_sampleBuffer;
 }
 
 void ADSBDemodSink::feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end)
@@ -94,8 +109,6 @@ void ADSBDemodSink::feed(const SampleVector::const_iterator& begin, const Sample
 
 void ADSBDemodSink::processOneSample(Complex &ci)
 {
-    Real sample;
-
     double magsqRaw = ci.real()*ci.real() + ci.imag()*ci.imag();
     Real magsq = magsqRaw / (SDR_RX_SCALED*SDR_RX_SCALED);
     m_movingAverage(magsq);
@@ -107,146 +120,315 @@ void ADSBDemodSink::processOneSample(Complex &ci)
     }
     m_magsqCount++;
 
-    sample = magsq;
-    m_sampleBuffer[m_sampleCount] = sample;
-    m_sampleCount++;
+    unsigned int index = m_writeIndex & (m_ringSize - 1);
+    m_sampleBuffer[index] = magsq;
+    m_sampleBuffer[index + m_ringSize] = magsq;
+    m_writeIndex++;
 
-    // Do we have enough data for a frame
-    if ((m_sampleCount >= m_totalSamples) && (m_skipCount == 0))
-    {
-        int startIdx = m_sampleCount - m_totalSamples;
+    // Do we have enough data for a block of frame windows
+    if (m_writeIndex - m_nextPosition >= (quint64) (m_totalSamples + m_detectBlockSize - 1)) {
+        detectFrames();
+    }
+}
 
-        // Correlate received signal with expected preamble
-        // chip+ indexes are 0, 2, 7, 9
-        // we correlate only over 6 symbols so that the number of zero chips is twice the
-        // number of one chips - empirically this is enough to get good correlation
-        Real premableCorrelationOnes = 0.0;
-        Real preambleCorrelationZeros = 0.0;
+// Preamble correlation: chip+ indexes are 0, 2, 7, 9
+// we correlate only over 6 symbols so that the number of zero chips is twice the
+// number of one chips - empirically this is enough to get good correlation.
+// Returns the first position in [from, to[ where the correlation passes the thresholds or to if none.
+// As the ones threshold is strictly positive, an exactly 0 correlation that is probably no signal never passes.
+static int findPreamble(const Real *chipSums, int samplesPerChip, int from, int to, Real onesThreshold, Real zerosThreshold)
+{
+    const Real *c0 = chipSums;
+    const Real *c1 = chipSums + 1*samplesPerChip;
+    const Real *c2 = chipSums + 2*samplesPerChip;
+    const Real *c3 = chipSums + 3*samplesPerChip;
+    const Real *c4 = chipSums + 4*samplesPerChip;
+    const Real *c5 = chipSums + 5*samplesPerChip;
+    const Real *c6 = chipSums + 6*samplesPerChip;
+    const Real *c7 = chipSums + 7*samplesPerChip;
+    const Real *c8 = chipSums + 8*samplesPerChip;
+    const Real *c9 = chipSums + 9*samplesPerChip;
+    const Real *c10 = chipSums + 10*samplesPerChip;
+    const Real *c11 = chipSums + 11*samplesPerChip;
+    int k = from;
+
+#if defined(ADSB_SSE2)
+    const __m128 onesThresholdV = _mm_set1_ps(onesThreshold);
+    const __m128 zerosThresholdV = _mm_set1_ps(zerosThreshold);
+
+    for (; k + 4 <= to; k += 4)
+    {
+        __m128 ones = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(&c0[k]), _mm_loadu_ps(&c2[k])),
+                                 _mm_add_ps(_mm_loadu_ps(&c7[k]), _mm_loadu_ps(&c9[k])));
+        __m128 zeros = _mm_add_ps(
+            _mm_add_ps(_mm_add_ps(_mm_loadu_ps(&c1[k]), _mm_loadu_ps(&c3[k])), _mm_add_ps(_mm_loadu_ps(&c4[k]), _mm_loadu_ps(&c5[k]))),
+            _mm_add_ps(_mm_add_ps(_mm_loadu_ps(&c6[k]), _mm_loadu_ps(&c8[k])), _mm_add_ps(_mm_loadu_ps(&c10[k]), _mm_loadu_ps(&c11[k]))));
+        int mask = _mm_movemask_ps(_mm_and_ps(_mm_cmpgt_ps(ones, onesThresholdV), _mm_cmplt_ps(zeros, zerosThresholdV)));
+
+        if (mask != 0)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                if (mask & (1 << i)) {
+                    return k + i;
+                }
+            }
+        }
+    }
+#elif defined(ADSB_NEON)
+    const float32x4_t onesThresholdV = vdupq_n_f32(onesThreshold);
+    const float32x4_t zerosThresholdV = vdupq_n_f32(zerosThreshold);
 
-        for (int i = 0; i < m_samplesPerChip; i++)
+    for (; k + 4 <= to; k += 4)
+    {
+        float32x4_t ones = vaddq_f32(vaddq_f32(vld1q_f32(&c0[k]), vld1q_f32(&c2[k])),
+                                     vaddq_f32(vld1q_f32(&c7[k]), vld1q_f32(&c9[k])));
+        float32x4_t zeros = vaddq_f32(
+            vaddq_f32(vaddq_f32(vld1q_f32(&c1[k]), vld1q_f32(&c3[k])), vaddq_f32(vld1q_f32(&c4[k]), vld1q_f32(&c5[k]))),
+            vaddq_f32(vaddq_f32(vld1q_f32(&c6[k]), vld1q_f32(&c8[k])), vaddq_f32(vld1q_f32(&c10[k]), vld1q_f32(&c11[k]))));
+        uint32x4_t pass = vandq_u32(vcgtq_f32(ones, onesThresholdV), vcltq_f32(zeros, zerosThresholdV));
+        uint32_t lanes[4];
+        vst1q_u32(lanes, pass);
+
+        for (int i = 0; i < 4; i++)
         {
-            premableCorrelationOnes  += m_sampleBuffer[startIdx +  0*m_samplesPerChip + i];
-            preambleCorrelationZeros += m_sampleBuffer[startIdx +  1*m_samplesPerChip + i];
+            if (lanes[i]) {
+                return k + i;
+            }
+        }
+    }
+#endif
+
+    for (; k < to; k++)
+    {
+        Real ones = (c0[k] + c2[k]) + (c7[k] + c9[k]);
+        Real zeros = ((c1[k] + c3[k]) + (c4[k] + c5[k])) + ((c6[k] + c8[k]) + (c10[k] + c11[k]));
+
+        if ((ones > onesThreshold) && (zeros < zerosThreshold)) {
+            return k;
+        }
+    }
+
+    return to;
+}
+
+void ADSBDemodSink::detectFrames()
+{
+    int nbPositions = m_writeIndex - m_nextPosition - m_totalSamples + 1;
+    int nbSamples = nbPositions + m_totalSamples - 1;
+    int nbChipSums = nbSamples - m_samplesPerChip + 1;
+    const Real *samples = &m_sampleBuffer[m_nextPosition & (m_ringSize - 1)];
+
+    // Chip energies from running sums restarted at each block. Sums are in double
+    // so that a weak chip following a strong pulse is not lost in rounding.
+    m_prefixSums[0] = 0.0;
+
+    for (int i = 0; i < nbSamples; i++) {
+        m_prefixSums[i + 1] = m_prefixSums[i] + samples[i];
+    }
+
+    for (int i = 0; i < nbChipSums; i++) {
+        m_chipSums[i] = m_prefixSums[i + m_samplesPerChip] - m_prefixSums[i];
+    }
+
+    Real onesThreshold = m_correlationThresholdLinear;
+    Real zerosThreshold = 2.0*m_correlationThresholdLinear;
+    int position = findPreamble(m_chipSums.data(), m_samplesPerChip, 0, nbPositions, onesThreshold, zerosThreshold);
+
+    while (position < nbPositions)
+    {
+        const Real *chipSums = &m_chipSums[position];
+        Real preambleCorrelationOnes = (chipSums[0] + chipSums[2*m_samplesPerChip])
+            + (chipSums[7*m_samplesPerChip] + chipSums[9*m_samplesPerChip]);
+        Real preambleCorrelationZeros = (chipSums[1*m_samplesPerChip] + chipSums[3*m_samplesPerChip])
+            + (chipSums[4*m_samplesPerChip] + chipSums[5*m_samplesPerChip])
+            + (chipSums[6*m_samplesPerChip] + chipSums[8*m_samplesPerChip])
+            + (chipSums[10*m_samplesPerChip] + chipSums[11*m_samplesPerChip]);
+
+        pushCandidate(position, preambleCorrelationOnes, preambleCorrelationZeros);
+        position = findPreamble(m_chipSums.data(), m_samplesPerChip, position + 1, nbPositions, onesThreshold, zerosThreshold);
+    }
+
+    m_nextPosition += nbPositions;
+    m_decoder.commit();
+    collectFrames(false);
+
+    ADSBDemodReport::FrameBatch *batch = m_reportBatchIndex < 0 ? nullptr : m_reportBatches[m_reportBatchIndex].get();
+
+    if (batch && (batch->m_nbFrames != 0)
+        && (m_writeIndex - m_reportBatchStart >= (quint64) m_reportPeriodMs * (ADS_B_BITS_PER_SECOND / 1000) * m_settings.m_samplesPerBit))
+    {
+        sendReports();
+    }
+}
+
+void ADSBDemodSink::pushCandidate(int position, Real preambleCorrelationOnes, Real preambleCorrelationZeros)
+{
+    quint64 framePosition = m_nextPosition + position;
+
+    if (framePosition < m_lastFrameEnd) { // Don't try to re-demodulate the same frame
+        return;
+    }
+
+    // Skip over preamble
+    const Real *chipSums = &m_chipSums[position + m_settings.m_samplesPerBit*ADS_B_PREAMBLE_BITS];
+    int df = 0;
+
+    // Don't hand over the candidate if the downlink format is not decoded to help reduce processing overhead
+    for (int bit = 0; bit < 5; bit++) {
+        df = (df << 1) | (chipSums[bit*m_settings.m_samplesPerBit] > chipSums[bit*m_settings.m_samplesPerBit + m_samplesPerChip]);
+    }
+
+    if ((df != 11) && (df != 17) && (df != 18)) {
+        return;
+    }
 
-            premableCorrelationOnes  += m_sampleBuffer[startIdx +  2*m_samplesPerChip + i];
-            preambleCorrelationZeros += m_sampleBuffer[startIdx +  3*m_samplesPerChip + i];
+    ADSBDemodDecoder::Candidate *candidate = m_decoder.getNextCandidate();
 
-            preambleCorrelationZeros += m_sampleBuffer[startIdx +  4*m_samplesPerChip + i];
-            preambleCorrelationZeros += m_sampleBuffer[startIdx +  5*m_samplesPerChip + i];
+    if (!candidate)
+    {
+        collectFrames(true);
+        candidate = m_decoder.getNextCandidate();
 
-            preambleCorrelationZeros += m_sampleBuffer[startIdx +  6*m_samplesPerChip + i];
-            premableCorrelationOnes  += m_sampleBuffer[startIdx +  7*m_samplesPerChip + i];
+        if (framePosition < m_lastFrameEnd) {
+            return;
+        }
+    }
 
-            preambleCorrelationZeros += m_sampleBuffer[startIdx +  8*m_samplesPerChip + i];
-            premableCorrelationOnes  += m_sampleBuffer[startIdx +  9*m_samplesPerChip + i];
+    candidate->m_position = framePosition;
+    candidate->m_preambleCorrelationOnes = preambleCorrelationOnes;
+    candidate->m_preambleCorrelationZeros = preambleCorrelationZeros;
+
+    for (int bit = 0; bit < ADS_B_ES_BITS; bit++)
+    {
+        candidate->m_chips[2*bit] = chipSums[0];
+        candidate->m_chips[2*bit + 1] = chipSums[m_samplesPerChip];
+        chipSums += m_settings.m_samplesPerBit;
+    }
 
-            preambleCorrelationZeros += m_sampleBuffer[startIdx + 10*m_samplesPerChip + i];
-            preambleCorrelationZeros += m_sampleBuffer[startIdx + 11*m_samplesPerChip + i];
+    m_decoder.push();
+}
+
+// Candidates come back in detection order. A valid frame hides the candidates found within it
+// as they would not have been decoded if the frames were decoded as soon as detected.
+void ADSBDemodSink::collectFrames(bool wait)
+{
+    ADSBDemodDecoder::Candidate *candidate;
+
+    while ((candidate = m_decoder.front(wait)))
+    {
+        if ((candidate->m_length != 0) && (candidate->m_position >= m_lastFrameEnd))
+        {
+            m_lastFrameEnd = candidate->m_position + m_settings.m_samplesPerBit*(ADS_B_PREAMBLE_BITS + 8*candidate->m_length);
+            reportFrame(*candidate);
         }
 
-        // If the correlation is exactly 0, it's probably no signal
-        if ((premableCorrelationOnes  > m_correlationThresholdLinear) &&
-            (preambleCorrelationZeros < 2.0*m_correlationThresholdLinear) &&
-            (premableCorrelationOnes != 0.0f))
+        m_decoder.pop();
+    }
+}
+
+void ADSBDemodSink::reportFrame(const ADSBDemodDecoder::Candidate& candidate)
+{
+    if (!getMessageQueueToGUI() && !getMessageQueueToWorker()) {
+        return;
+    }
+
+    if (m_reportBatchIndex < 0)
+    {
+        // take the first batch that is not referred by any message
+        for (int i = 0; i < m_nbReportBatches; i++)
         {
-            // Skip over preamble
-            startIdx += m_settings.m_samplesPerBit*ADS_B_PREAMBLE_BITS;
-
-            // Demodulate waveform to bytes
-            unsigned char data[ADS_B_ES_BYTES];
-            int byteIdx = 0;
-            int currentBit;
-            unsigned char currentByte = 0;
-            bool adsbOnly = true;
-            int df;
-
-            for (int bit = 0; bit < ADS_B_ES_BITS; bit++)
+            if (m_reportBatches[i]->m_readers.load(std::memory_order_acquire) == 0)
             {
-                // PPM (Pulse position modulation) - Each bit spreads to two chips, 1->10, 0->01
-                // Determine if bit is 1 or 0, by seeing which chip has largest combined energy over the sampling period
-                Real oneSum = 0.0f;
-                Real zeroSum = 0.0f;
-                for (int i = 0; i < m_samplesPerChip; i++)
-                {
-                    oneSum += m_sampleBuffer[startIdx+i];
-                    zeroSum += m_sampleBuffer[startIdx+m_samplesPerChip+i];
-                }
-                currentBit = oneSum > zeroSum;
-                startIdx += m_settings.m_samplesPerBit;
-                // Convert bit to bytes - MSB first
-                currentByte |= currentBit << (7-(bit & 0x7));
-                if ((bit & 0x7) == 0x7)
-                {
-                    data[byteIdx++] = currentByte;
-                    currentByte = 0;
-                    // Don't try to demodulate any further, if this isn't an ADS-B frame
-                    // to help reduce processing overhead
-                    if (adsbOnly && (bit == 7))
-                    {
-                        df = ((data[0] >> 3) & ADS_B_DF_MASK);
-                        if ((df != 17) && (df != 18))
-                            break;
-                    }
-                }
+                m_reportBatchIndex = i;
+                m_reportBatches[i]->m_nbFrames = 0;
+                break;
             }
+        }
 
-            // Is ADS-B?
-            df = ((data[0] >> 3) & ADS_B_DF_MASK);
-            if ((df == 17) || (df == 18))
-            {
-                crcadsb crc;
-                //int icao = (data[1] << 16) | (data[2] << 8) | data[3]; // ICAO aircraft address
-                int parity = (data[11] << 16) | (data[12] << 8) | data[13]; // Parity / CRC
-
-                crc.calculate(data, ADS_B_ES_BYTES-3);
-                if (parity == crc.get())
-                {
-                    // Got a valid frame
-                    // Don't try to re-demodulate the same frame
-                    m_skipCount = (ADS_B_ES_BITS+ADS_B_PREAMBLE_BITS)*ADS_B_CHIPS_PER_BIT*m_samplesPerChip;
-                    // Pass to GUI
-                    if (getMessageQueueToGUI())
-                    {
-                        ADSBDemodReport::MsgReportADSB *msg = ADSBDemodReport::MsgReportADSB::create(
-                            QByteArray((char*)data, sizeof(data)),
-                            premableCorrelationOnes,
-                            preambleCorrelationZeros/2.0);
-                        getMessageQueueToGUI()->push(msg);
-                    }
-                    // Pass to worker
-                    if (getMessageQueueToWorker())
-                    {
-                        ADSBDemodReport::MsgReportADSB *msg = ADSBDemodReport::MsgReportADSB::create(
-                            QByteArray((char*)data, sizeof(data)),
-                            premableCorrelationOnes,
-                            preambleCorrelationZeros/2.0);
-                        getMessageQueueToWorker()->push(msg);
-                    }
-                }
-            }
+        if (m_reportBatchIndex < 0)
+        {
+            m_reportsDropped++;
+            return;
+        }
+
+        if (m_reportsDropped != 0)
+        {
+            qWarning("ADSBDemodSink::reportFrame: %d frames dropped as reports were not processed", m_reportsDropped);
+            m_reportsDropped = 0;
         }
     }
-    if (m_skipCount > 0)
-        m_skipCount--;
-    if (m_sampleCount >= 2*m_totalSamples)
-    {
-        // Copy second half of buffer to first
-        memcpy(&m_sampleBuffer[0], &m_sampleBuffer[m_totalSamples], m_totalSamples*sizeof(Real));
-        m_sampleCount = m_totalSamples;
+
+    ADSBDemodReport::FrameBatch& batch = *m_reportBatches[m_reportBatchIndex];
+
+    if (batch.m_nbFrames == 0) {
+        m_reportBatchStart = candidate.m_position;
     }
-    m_sampleIdx++;
 
+    ADSBDemodReport::Frame& frame = batch.m_frames[batch.m_nbFrames++];
+    std::copy(candidate.m_data, candidate.m_data + candidate.m_length, frame.m_data);
+    frame.m_length = candidate.m_length;
+    frame.m_msecsSinceEpoch = QDateTime::currentMSecsSinceEpoch();
+    frame.m_premableCorrelationOnes = candidate.m_preambleCorrelationOnes;
+    frame.m_premableCorrelationZeros = candidate.m_preambleCorrelationZeros/2.0;
+
+    if (batch.m_nbFrames == ADSBDemodReport::FrameBatch::m_capacity) {
+        sendReports();
+    }
+}
+
+void ADSBDemodSink::sendReports()
+{
+    if ((m_reportBatchIndex < 0) || (m_reportBatches[m_reportBatchIndex]->m_nbFrames == 0)) {
+        return;
+    }
+
+    const std::shared_ptr<ADSBDemodReport::FrameBatch>& batch = m_reportBatches[m_reportBatchIndex];
+    int nbReaders = (getMessageQueueToGUI() ? 1 : 0) + (getMessageQueueToWorker() ? 1 : 0);
+    batch->m_readers.store(nbReaders, std::memory_order_relaxed); // published by the queues
+
+    // Pass to GUI
+    if (getMessageQueueToGUI()) {
+        getMessageQueueToGUI()->push(ADSBDemodReport::MsgReportADSBBatch::create(batch));
+    }
+    // Pass to worker
+    if (getMessageQueueToWorker()) {
+        getMessageQueueToWorker()->push(ADSBDemodReport::MsgReportADSBBatch::create(batch));
+    }
+
+    m_reportBatchIndex = -1;
+}
+
+void ADSBDemodSink::flushReports()
+{
+    m_decoder.commit();
+    collectFrames(true);
+    sendReports();
 }
 
 void ADSBDemodSink::init(int samplesPerBit)
 {
-    if (m_sampleBuffer)
-        delete m_sampleBuffer;
+    // report the frames of the candidates still being decoded from the current buffer
+    flushReports();
 
     m_totalSamples = samplesPerBit*(ADS_B_PREAMBLE_BITS+ADS_B_ES_BITS);
     m_samplesPerChip = samplesPerBit/ADS_B_CHIPS_PER_BIT;
 
-    m_sampleBuffer = new Real[2*m_totalSamples];
+    // room for a block of frame windows
+    m_ringSize = 1;
+
+    while (m_ringSize < (unsigned int) (m_totalSamples + m_detectBlockSize)) {
+        m_ringSize <<= 1;
+    }
+
+    m_sampleBuffer.assign(2*m_ringSize, 0.0f);
+    m_prefixSums.resize(m_totalSamples + m_detectBlockSize);
+    m_chipSums.resize(m_totalSamples + m_detectBlockSize);
+    m_writeIndex = 0;
+    m_nextPosition = 0;
+
+    // sample positions restart from 0
+    m_lastFrameEnd = 0;
 }
 
 void ADSBDemodSink::applyChannelSettings(int channelSampleRate, int channelFrequencyOffset, bool force)
@@ -295,7 +477,7 @@ void ADSBDemodSink::applySettings(const ADSBDemodSettings& settings, bool force)
     }
 
     if ((settings.m_correlationThreshold != m_settings.m_correlationThreshold) || force) {
-        m_correlationThresholdLinear = CalcDb::powerFromdB(m_settings.m_correlationThreshold);
+        m_correlationThresholdLinear = CalcDb::powerFromdB(settings.m_correlationThreshold);
     }
 
     m_settings = settings;
@@ -19,6 +19,7 @@
 #ifndef INCLUDE_ADSBDEMODSINK_H
 #define INCLUDE_ADSBDEMODSINK_H
 
+#include <memory>
 #include <vector>
 
 #include "dsp/channelsamplesink.h"
@@ -27,6 +28,8 @@
 #include "util/movingaverage.h"
 
 #include "adsbdemodsettings.h"
+#include "adsbdemodreport.h"
+#include "adsbdemoddecoder.h"
 
 class ADSBDemodSink : public ChannelSampleSink {
 public:
@@ -58,6 +61,7 @@ public:
     void applySettings(const ADSBDemodSettings& settings, bool force = false);
     void setMessageQueueToGUI(MessageQueue *messageQueue) { m_messageQueueToGUI = messageQueue; }
     void setMessageQueueToWorker(MessageQueue *messageQueue) { m_messageQueueToWorker = messageQueue; }
+    void flushReports(); //!< waits for the candidates being decoded and sends the frames not reported yet
 
 private:
     struct MagSqLevelsStore
@@ -78,14 +82,29 @@ private:
     Interpolator m_interpolator;
     Real m_interpolatorDistance;
     Real m_interpolatorDistanceRemain;
-    int m_sampleIdx;
-    int m_sampleCount;
-    int m_skipCount;            // Samples to skip, because we've already received a frame
-    Real *m_sampleBuffer;
+
+    // Magnitude squared samples ring buffer. Each sample is written twice, at its index and at its index
+    // plus the ring size, so that any window shorter than the ring size is contiguous.
+    std::vector<Real> m_sampleBuffer;
+    unsigned int m_ringSize;    //!< power of two
+    quint64 m_writeIndex;       //!< number of samples written since init
+    quint64 m_nextPosition;     //!< start of the next frame window to check
+    std::vector<double> m_prefixSums; //!< running sums of the samples of the block of windows being checked
+    std::vector<Real> m_chipSums;     //!< sums over one chip period starting at each sample of the block
 
     int m_totalSamples;         // These two values are derived from samplesPerBit
     int m_samplesPerChip;
     double m_correlationThresholdLinear; //!< settings m_correlationThreshold is in dB. Linear value is calculated once.
+    static const int m_detectBlockSize = 512; //!< frame windows checked at once
+
+    ADSBDemodDecoder m_decoder;
+    quint64 m_lastFrameEnd;     //!< windows starting before are within the last frame received and are skipped
+    std::vector<std::shared_ptr<ADSBDemodReport::FrameBatch>> m_reportBatches; //!< recycled when not referred by messages any more
+    int m_reportBatchIndex;     //!< batch being filled or -1 if none is free
+    quint64 m_reportBatchStart; //!< sample index of the first frame in the batch
+    int m_reportsDropped;       //!< frames lost while no batch was free
+    static const int m_nbReportBatches = 8;
+    static const int m_reportPeriodMs = 50; //!< frames are sent at least this often
 
     double m_magsq; //!< displayed averaged value
     double m_magsqSum;
@@ -99,6 +118,11 @@ private:
     MessageQueue *m_messageQueueToWorker;
 
     void processOneSample(Complex &ci);
+    void detectFrames();
+    void pushCandidate(int position, Real preambleCorrelationOnes, Real preambleCorrelationZeros);
+    void collectFrames(bool wait);
+    void reportFrame(const ADSBDemodDecoder::Candidate& candidate);
+    void sendReports();
     MessageQueue *getMessageQueueToGUI() { return m_messageQueueToGUI; }
     MessageQueue *getMessageQueueToWorker() { return m_messageQueueToWorker; }
 };
@@ -24,8 +24,10 @@
 
 #include "adsbdemodworker.h"
 #include "adsbdemodreport.h"
+#include "adsb.h"
 
 MESSAGE_CLASS_DEFINITION(ADSBDemodWorker::MsgConfigureADSBDemodWorker, Message)
+MESSAGE_POOL_DEFINITION(ADSBDemodWorker::MsgConfigureADSBDemodWorker)
 
 ADSBDemodWorker::ADSBDemodWorker() :
     m_running(false),
@@ -85,10 +87,14 @@ bool ADSBDemodWorker::handleMessage(const Message& message)
         applySettings(cfg.getSettings(), cfg.getForce());
         return true;
     }
-    else if (ADSBDemodReport::MsgReportADSB::match(message))
+    else if (ADSBDemodReport::MsgReportADSBBatch::match(message))
     {
-        ADSBDemodReport::MsgReportADSB& report = (ADSBDemodReport::MsgReportADSB&) message;
-        handleADSB(report.getData(), report.getDateTime(), report.getPreambleCorrelationOnes());
+        ADSBDemodReport::MsgReportADSBBatch& report = (ADSBDemodReport::MsgReportADSBBatch&) message;
+
+        for (int i = 0; i < report.getNbFrames(); i++) {
+            handleADSB(report.getData(i), report.getDateTime(i), report.getPreambleCorrelationOnes(i));
+        }
+
         return true;
     }
     else
@@ -169,7 +175,7 @@ void ADSBDemodWorker::handleADSB(QByteArray data, const QDateTime dateTime, floa
        signalStrength = (unsigned char)correlation;
 
     *p++ = BEAST_ESC;
-    *p++ = '3'; // Mode-S long
+    *p++ = data.length() == ADS_B_SHORT_BYTES ? '2' : '3'; // Mode-S short or long
 
     p = escape(p, timestamp >> 56); // Big-endian timestamp
     p = escape(p, timestamp >> 48);
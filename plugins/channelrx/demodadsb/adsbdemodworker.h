@@ -24,6 +24,7 @@
 #include <QTcpSocket>
 
 #include "util/message.h"
+#include "util/messagepool.h"
 #include "util/messagequeue.h"
 
 #include "adsbdemodsettings.h"
@@ -34,6 +35,7 @@ class ADSBDemodWorker : public QObject
 public:
      class MsgConfigureADSBDemodWorker : public Message {
         MESSAGE_CLASS_DECLARATION
+        MESSAGE_POOL_DECLARATION
 
     public:
         const ADSBDemodSettings& getSettings() const { return m_settings; }
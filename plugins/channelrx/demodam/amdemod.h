@@ -66,6 +66,8 @@ public:
 	virtual void destroy() { delete this; }
 
 	virtual void feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end, bool po);
+	virtual bool acceptsBlocks() const { return true; }
+	virtual void feedBlock(const SampleBlockRef& block, bool positiveOnly);
 	virtual void start();
 	virtual void stop();
 	virtual bool handleMessage(const Message& cmd);
@@ -26,12 +26,14 @@
 MESSAGE_CLASS_DEFINITION(AMDemodBaseband::MsgConfigureAMDemodBaseband, Message)
 
 AMDemodBaseband::AMDemodBaseband() :
+    m_sampleFifo(256), // about 0.5s of device transfers
+    m_blockPool(new SampleBlockPool()),
     m_running(false),
+    m_subbandFrequencyOffset(0),
     m_mutex(QMutex::Recursive)
 {
     qDebug("AMDemodBaseband::AMDemodBaseband");
 
-    m_sampleFifo.setSize(SampleSinkFifo::getSizePolicy(48000));
     m_channelizer = new DownChannelizer(&m_sink);
 
     DSPEngine::instance()->getAudioDeviceManager()->addAudioSink(m_sink.getAudioFifo(), getInputMessageQueue());
@@ -43,6 +45,7 @@ AMDemodBaseband::~AMDemodBaseband()
     m_inputMessageQueue.clear();
     DSPEngine::instance()->getAudioDeviceManager()->removeAudioSink(m_sink.getAudioFifo());
     delete m_channelizer;
+    m_blockPool->destroy(); // actually deleted when the FIFO releases its last block
 }
 
 void AMDemodBaseband::reset()
@@ -57,7 +60,7 @@ void AMDemodBaseband::startWork()
     QMutexLocker mutexLocker(&m_mutex);
     QObject::connect(
         &m_sampleFifo,
-        &SampleSinkFifo::dataReady,
+        &SampleBlockFifo::dataReady,
         this,
         &AMDemodBaseband::handleData,
         Qt::QueuedConnection
@@ -72,7 +75,7 @@ void AMDemodBaseband::stopWork()
     disconnect(&m_inputMessageQueue, SIGNAL(messageEnqueued()), this, SLOT(handleInputMessages()));
     QObject::disconnect(
         &m_sampleFifo,
-        &SampleSinkFifo::dataReady,
+        &SampleBlockFifo::dataReady,
         this,
         &AMDemodBaseband::handleData
     );
@@ -81,33 +84,24 @@ void AMDemodBaseband::stopWork()
 
 void AMDemodBaseband::feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end)
 {
-    m_sampleFifo.write(begin, end);
+    m_sampleFifo.write(m_blockPool->acquire(begin, end));
+}
+
+void AMDemodBaseband::feedBlock(const SampleBlockRef& block)
+{
+    m_sampleFifo.write(block);
 }
 
 void AMDemodBaseband::handleData()
 {
     QMutexLocker mutexLocker(&m_mutex);
 
-    while ((m_sampleFifo.fill() > 0) && (m_inputMessageQueue.size() == 0))
-    {
-		SampleVector::iterator part1begin;
-		SampleVector::iterator part1end;
-		SampleVector::iterator part2begin;
-		SampleVector::iterator part2end;
-
-        std::size_t count = m_sampleFifo.readBegin(m_sampleFifo.fill(), &part1begin, &part1end, &part2begin, &part2end);
+    SampleBlockRef block;
 
-		// first part of FIFO data
-        if (part1begin != part1end) {
-            m_channelizer->feed(part1begin, part1end);
-        }
-
-		// second part of FIFO data (used when block wraps around)
-		if(part2begin != part2end) {
-            m_channelizer->feed(part2begin, part2end);
-        }
-
-		m_sampleFifo.readCommit((unsigned int) count);
+    while ((m_inputMessageQueue.size() == 0) && m_sampleFifo.read(block))
+    {
+        m_channelizer->feed(block.begin(), block.end());
+        block.reset(); // give the block back to its pool as soon as possible
     }
 }
 
@@ -140,13 +134,35 @@ bool AMDemodBaseband::handleMessage(const Message& cmd)
         QMutexLocker mutexLocker(&m_mutex);
         DSPSignalNotification& notif = (DSPSignalNotification&) cmd;
         qDebug() << "AMDemodBaseband::handleMessage: DSPSignalNotification: basebandSampleRate: " << notif.getSampleRate();
-        m_sampleFifo.setSize(SampleSinkFifo::getSizePolicy(notif.getSampleRate()));
+
+        if (m_subbandFrequencyOffset != 0) // back to full baseband
+        {
+            m_subbandFrequencyOffset = 0;
+            m_channelizer->setChannelization(m_sink.getAudioSampleRate(), m_settings.m_inputFrequencyOffset);
+        }
+
         m_channelizer->setBasebandSampleRate(notif.getSampleRate());
         m_sink.applyChannelSettings(m_channelizer->getChannelSampleRate(), m_channelizer->getChannelFrequencyOffset());
         m_sink.applyAudioSampleRate(m_sink.getAudioSampleRate()); // reapply in case of channel sample rate change
 
 		return true;
     }
+    else if (DSPSubbandNotification::match(cmd))
+    {
+        QMutexLocker mutexLocker(&m_mutex);
+        DSPSubbandNotification& notif = (DSPSubbandNotification&) cmd;
+        qDebug() << "AMDemodBaseband::handleMessage: DSPSubbandNotification:"
+            << " sampleRate: " << notif.getSampleRate()
+            << " subbandFrequencyOffset: " << notif.getSubbandFrequencyOffset();
+        // The FIFO is left alone as it is written by the device engine
+        m_subbandFrequencyOffset = notif.getSubbandFrequencyOffset();
+        m_channelizer->setChannelization(m_sink.getAudioSampleRate(), m_settings.m_inputFrequencyOffset - m_subbandFrequencyOffset);
+        m_channelizer->setBasebandSampleRate(notif.getSampleRate());
+        m_sink.applyChannelSettings(m_channelizer->getChannelSampleRate(), m_channelizer->getChannelFrequencyOffset());
+        m_sink.applyAudioSampleRate(m_sink.getAudioSampleRate()); // reapply in case of channel sample rate change
+
+        return true;
+    }
     else
     {
         return false;
@@ -157,7 +173,7 @@ void AMDemodBaseband::applySettings(const AMDemodSettings& settings, bool force)
 {
     if ((settings.m_inputFrequencyOffset != m_settings.m_inputFrequencyOffset) || force)
     {
-        m_channelizer->setChannelization(m_sink.getAudioSampleRate(), settings.m_inputFrequencyOffset);
+        m_channelizer->setChannelization(m_sink.getAudioSampleRate(), settings.m_inputFrequencyOffset - m_subbandFrequencyOffset);
         m_sink.applyChannelSettings(m_channelizer->getChannelSampleRate(), m_channelizer->getChannelFrequencyOffset());
         m_sink.applyAudioSampleRate(m_sink.getAudioSampleRate()); // reapply in case of channel sample rate change
     }
@@ -173,7 +189,7 @@ void AMDemodBaseband::applySettings(const AMDemodSettings& settings, bool force)
 
         if (m_sink.getAudioSampleRate() != audioSampleRate)
         {
-            m_channelizer->setChannelization(audioSampleRate, settings.m_inputFrequencyOffset);
+            m_channelizer->setChannelization(audioSampleRate, settings.m_inputFrequencyOffset - m_subbandFrequencyOffset);
             m_sink.applyChannelSettings(m_channelizer->getChannelSampleRate(), m_channelizer->getChannelFrequencyOffset());
             m_sink.applyAudioSampleRate(audioSampleRate);
         }
@@ -21,7 +21,7 @@
 #include <QObject>
 #include <QMutex>
 
-#include "dsp/samplesinkfifo.h"
+#include "dsp/sampleblockfifo.h"
 #include "util/message.h"
 #include "util/messagequeue.h"
 
@@ -62,6 +62,7 @@ public:
     void startWork();
     void stopWork();
     void feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end);
+    void feedBlock(const SampleBlockRef& block); //!< keeps a reference to the block instead of copying samples
     MessageQueue *getInputMessageQueue() { return &m_inputMessageQueue; } //!< Get the queue for asynchronous inbound communication
     int getChannelSampleRate() const;
     void getMagSqLevels(double& avg, double& peak, int& nbSamples) { m_sink.getMagSqLevels(avg, peak, nbSamples); }
@@ -74,12 +75,14 @@ public:
     bool isRunning() const { return m_running; }
 
 private:
-    SampleSinkFifo m_sampleFifo;
+    SampleBlockFifo m_sampleFifo;
+    SampleBlockPool *m_blockPool; //!< holds samples not fed as a shared block
     DownChannelizer *m_channelizer;
     AMDemodSink m_sink;
 	MessageQueue m_inputMessageQueue; //!< Queue for asynchronous inbound communication
     AMDemodSettings m_settings;
     bool m_running;
+    qint64 m_subbandFrequencyOffset; //!< center of the input when fed by the device shared channelizer
     QMutex m_mutex;
 
     bool handleMessage(const Message& cmd);
@@ -89,12 +89,43 @@ bool DATVDemodGUI::handleMessage(const Message& message)
         displaySystemConfiguration();
         return true;
     }
+    else if (DATVDemodReport::MsgReportSchedulerCPU::match(message))
+    {
+        DATVDemodReport::MsgReportSchedulerCPU& report = (DATVDemodReport::MsgReportSchedulerCPU&) message;
+        displaySchedulerCPU(report.getStages());
+        return true;
+    }
     else
     {
         return false;
     }
 }
 
+void DATVDemodGUI::displaySchedulerCPU(const std::vector<DATVDemodReport::MsgReportSchedulerCPU::StageLoad>& stages)
+{
+    std::vector<float> threadLoads;
+    QString toolTip = tr("Decoder load per thread in percent of one core");
+
+    for (const auto& stage : stages)
+    {
+        if (stage.m_thread >= (int) threadLoads.size()) {
+            threadLoads.resize(stage.m_thread + 1, 0.0f);
+        }
+
+        threadLoads[stage.m_thread] += stage.m_load;
+        toolTip += QString("\n%1 (T%2): %3%").arg(stage.m_name).arg(stage.m_thread).arg(stage.m_load, 0, 'f', 1);
+    }
+
+    QString text = tr("CPU:");
+
+    for (unsigned int thread = 0; thread < threadLoads.size(); thread++) {
+        text += QString(" T%1 %2%").arg(thread).arg(threadLoads[thread], 0, 'f', 0);
+    }
+
+    ui->cpuText->setText(text);
+    ui->cpuText->setToolTip(toolTip);
+}
+
 void DATVDemodGUI::handleInputMessages()
 {
     Message* message;
@@ -25,6 +25,7 @@
 #include "dsp/movingaverage.h"
 
 #include "datvdemod.h"
+#include "datvdemodreport.h"
 
 #include <QTimer>
 
@@ -122,6 +123,7 @@ private:
 	void applySettings(bool force = false);
     void displaySettings();
     void displaySystemConfiguration();
+    void displaySchedulerCPU(const std::vector<DATVDemodReport::MsgReportSchedulerCPU::StageLoad>& stages);
     void displayStreamIndex();
     QString formatBytes(qint64 intBytes);
 
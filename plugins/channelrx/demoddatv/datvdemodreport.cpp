@@ -18,6 +18,7 @@
 #include "datvdemodreport.h"
 
 MESSAGE_CLASS_DEFINITION(DATVDemodReport::MsgReportModcodCstlnChange, Message)
+MESSAGE_CLASS_DEFINITION(DATVDemodReport::MsgReportSchedulerCPU, Message)
 
 DATVDemodReport::DATVDemodReport()
 {}
@@ -18,6 +18,10 @@
 #ifndef INCLUDE_DATVDEMODREPORT_H
 #define INCLUDE_DATVDEMODREPORT_H
 
+#include <vector>
+
+#include <QString>
+
 #include "util/message.h"
 
 #include "datvdemodsettings.h"
@@ -53,6 +57,32 @@ public:
             m_codeRate(codeRate)
         { }
     };
+
+    class MsgReportSchedulerCPU : public Message {
+        MESSAGE_CLASS_DECLARATION
+
+    public:
+        struct StageLoad
+        {
+            QString m_name;
+            int m_thread;  //!< 0 is the channel thread
+            float m_load;  //!< percentage of one core used since the previous report
+        };
+
+        const std::vector<StageLoad>& getStages() const { return m_stages; }
+
+        static MsgReportSchedulerCPU* create(const std::vector<StageLoad>& stages) {
+            return new MsgReportSchedulerCPU(stages);
+        }
+
+    private:
+        std::vector<StageLoad> m_stages;
+
+        MsgReportSchedulerCPU(const std::vector<StageLoad>& stages) :
+            Message(),
+            m_stages(stages)
+        { }
+    };
 };
 
 #endif // INCLUDE_DATVDEMODREPORT_H
@@ -21,6 +21,7 @@
 
 #include <QDebug>
 #include <QObject>
+#include <QThread>
 
 #include "audio/audiooutput.h"
 #include "dsp/dspengine.h"
@@ -28,9 +29,13 @@
 
 #include "datvdemodreport.h"
 
+const int DATVDemodSink::m_schedulerMaxThreads;
+const int DATVDemodSink::m_ldpcMaxWorkers;
+
 const unsigned int DATVDemodSink::m_rfFilterFftLength = 1024;
 
 DATVDemodSink::DATVDemodSink() :
+    m_objScheduler(nullptr),
     m_blnNeedConfigUpdate(false),
     m_objRegisteredTVScreen(0),
     m_objRegisteredVideoRender(0),
@@ -44,7 +49,8 @@ DATVDemodSink::DATVDemodSink() :
     m_modcodModulation(-1),
     m_modcodCodeRate(-1),
     m_enmModulation(DATVDemodSettings::BPSK /*DATV_FM1*/),
-    m_channelSampleRate(1024000)
+    m_channelSampleRate(1024000),
+    m_messageQueueToGUI(nullptr)
 {
     //*************** DATV PARAMETERS  ***************
     m_blnInitialized=false;
@@ -181,6 +187,7 @@ void DATVDemodSink::CleanUpDATVFramework(bool blnRelease)
         {
             m_objScheduler->shutdown();
             delete m_objScheduler;
+            m_objScheduler = nullptr;
         }
 
         // NOTCH FILTER
@@ -376,7 +383,7 @@ void DATVDemodSink::CleanUpDATVFramework(bool blnRelease)
 
         if(p_fecframes != nullptr)
         {
-            delete (leansdr::pipebuf< leansdr::fecframe<leansdr::hard_sb> >*) p_fecframes;
+            delete (leansdr::pipebuf< leansdr::fecframe<leansdr::llr_sb> >*) p_fecframes;
         }
 
         if(p_bbframes != nullptr)
@@ -386,12 +393,12 @@ void DATVDemodSink::CleanUpDATVFramework(bool blnRelease)
 
         if(p_s2_deinterleaver != nullptr)
         {
-            delete (leansdr::s2_deinterleaver<leansdr::llr_ss,leansdr::hard_sb>*) p_s2_deinterleaver;
+            delete (leansdr::s2_deinterleaver<leansdr::llr_ss,leansdr::llr_sb>*) p_s2_deinterleaver;
         }
 
         if(r_fecdec != nullptr)
         {
-            delete (leansdr::s2_fecdec<bool, leansdr::hard_sb>*) r_fecdec;
+            delete (leansdr::s2_fecdec_soft*) r_fecdec;
         }
 
         if(p_deframer != nullptr)
@@ -405,6 +412,10 @@ void DATVDemodSink::CleanUpDATVFramework(bool blnRelease)
         }
     }
 
+    if (m_objScheduler != nullptr) {
+        m_objScheduler->stop_threads(); // the old graph is left as is but must not run any more
+    }
+
     m_objScheduler=nullptr;
 
     // INPUT
@@ -833,6 +844,26 @@ void DATVDemodSink::InitDATVFramework()
     // OUTPUT
     r_videoplayer = new leansdr::datvvideoplayer<leansdr::tspacket>(m_objScheduler, *p_tspackets, m_objVideoStream, &m_udpStream);
 
+    // Decoding stages on their own threads. The demodulator, the scopes and the outputs
+    // stay on the channel thread as their state is used from there.
+    int nbThreads = std::min(m_schedulerMaxThreads, QThread::idealThreadCount());
+
+    if (nbThreads > 1)
+    {
+        if (m_objCfg.viterbi) {
+            m_objScheduler->set_thread(r, 1);
+        } else {
+            m_objScheduler->set_thread(r_deconv, 1);
+        }
+
+        m_objScheduler->set_thread(r_sync_mpeg, 1); // resynchronizes the deconvolution
+        m_objScheduler->set_thread(r_deinter, 1);
+        m_objScheduler->set_thread(r_rsdec, nbThreads - 1);
+        m_objScheduler->set_thread(r_derand, nbThreads - 1);
+        m_objScheduler->start_threads();
+    }
+
+    m_schedulerReportTimer.start();
     m_blnDVBInitialized = true;
 }
 
@@ -1071,37 +1102,35 @@ void DATVDemodSink::InitDATVS2Framework()
         r_scope_symbols_dvbs2->calculate_cstln_points();
     }
 
-    // Bit-flipping mode.
-    // Deinterleave into hard bits.
+    // Soft decision mode.
+    // Deinterleave into LLR bits.
 
     p_bbframes = new leansdr::pipebuf<leansdr::bbframe>(m_objScheduler, "BB frames", BUF_FRAMES);
 
-    p_fecframes = new leansdr::pipebuf< leansdr::fecframe<leansdr::hard_sb> >(m_objScheduler, "FEC frames", BUF_FRAMES);
+    p_fecframes = new leansdr::pipebuf< leansdr::fecframe<leansdr::llr_sb> >(m_objScheduler, "FEC frames", BUF_FRAMES);
 
-    p_s2_deinterleaver = new leansdr::s2_deinterleaver<leansdr::llr_ss,leansdr::hard_sb>(
+    p_s2_deinterleaver = new leansdr::s2_deinterleaver<leansdr::llr_ss,leansdr::llr_sb>(
         m_objScheduler,
         *(leansdr::pipebuf< leansdr::plslot<leansdr::llr_ss> > *) p_slots_dvbs2,
-        *(leansdr::pipebuf< leansdr::fecframe<leansdr::hard_sb> > * ) p_fecframes
+        *(leansdr::pipebuf< leansdr::fecframe<leansdr::llr_sb> > * ) p_fecframes
     );
 
     p_vbitcount= new leansdr::pipebuf<int>(m_objScheduler, "Bits processed", BUF_S2PACKETS);
     p_verrcount = new leansdr::pipebuf<int>(m_objScheduler, "Bits corrected", BUF_S2PACKETS);
 
-    r_fecdec =  new leansdr::s2_fecdec<bool, leansdr::hard_sb>(
-        m_objScheduler, *(leansdr::pipebuf< leansdr::fecframe<leansdr::hard_sb> > * ) p_fecframes,
+    // LDPC decoding on all cores but the channel thread one
+    int nbLDPCWorkers = std::max(0, std::min(m_ldpcMaxWorkers, QThread::idealThreadCount() - 1));
+
+    r_fecdec =  new leansdr::s2_fecdec_soft(
+        m_objScheduler, *(leansdr::pipebuf< leansdr::fecframe<leansdr::llr_sb> > * ) p_fecframes,
         *(leansdr::pipebuf<leansdr::bbframe> *) p_bbframes,
+        nbLDPCWorkers,
+        m_ldpcMaxIterations,
         p_vbitcount,
         p_verrcount
     );
-    leansdr::s2_fecdec<bool, leansdr::hard_sb> *fecdec = (leansdr::s2_fecdec<bool, leansdr::hard_sb> * ) r_fecdec;
-
-    fecdec->bitflips=0;
-
-    /*
-    fecdec->bitflips = cfg.ldpc_bf; //int TODO
-    if ( ! cfg.ldpc_bf )
-    fprintf(stderr, "Warning: No LDPC error correction selected.\n")
-    */
+    leansdr::s2_fecdec_soft *fecdec = (leansdr::s2_fecdec_soft * ) r_fecdec;
+    qDebug("DATVDemodSink::InitDATVS2Framework: LDPC workers: %d", nbLDPCWorkers);
 
     // Deframe BB frames to TS packets
     p_lock = new leansdr::pipebuf<int> (m_objScheduler, "lock", BUF_SLOW);
@@ -1118,9 +1147,41 @@ void DATVDemodSink::InitDATVS2Framework()
     // OUTPUT
     r_videoplayer = new leansdr::datvvideoplayer<leansdr::tspacket>(m_objScheduler, *p_tspackets, m_objVideoStream, &m_udpStream);
 
+    // Deinterleaving and FEC decoding on their own thread
+    if (QThread::idealThreadCount() > 1)
+    {
+        m_objScheduler->set_thread((leansdr::s2_deinterleaver<leansdr::llr_ss,leansdr::llr_sb> *) p_s2_deinterleaver, 1);
+        m_objScheduler->set_thread(fecdec, 1);
+        m_objScheduler->start_threads();
+    }
+
+    m_schedulerReportTimer.start();
     m_blnDVBInitialized = true;
 }
 
+void DATVDemodSink::reportSchedulerCPU()
+{
+    qint64 elapsed = m_schedulerReportTimer.restart();
+    std::vector<DATVDemodReport::MsgReportSchedulerCPU::StageLoad> stages;
+
+    for (int i = 0; i < m_objScheduler->nrunnables; i++)
+    {
+        leansdr::runnable_common *runnable = m_objScheduler->runnables[i];
+        double busy = runnable->busy_ns.exchange(0, std::memory_order_relaxed) * 1e-6;
+        DATVDemodReport::MsgReportSchedulerCPU::StageLoad stage;
+        stage.m_name = QString(runnable->name);
+        stage.m_thread = runnable->thread;
+        stage.m_load = elapsed == 0 ? 0.0 : (100.0 * busy) / elapsed;
+        stages.push_back(stage);
+    }
+
+    if (getMessageQueueToGUI())
+    {
+        DATVDemodReport::MsgReportSchedulerCPU *msg = DATVDemodReport::MsgReportSchedulerCPU::create(stages);
+        getMessageQueueToGUI()->push(msg);
+    }
+}
+
 void DATVDemodSink::feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end)
 {
     float fltI;
@@ -1133,6 +1194,25 @@ void DATVDemodSink::feed(const SampleVector::const_iterator& begin, const Sample
 
     int lngWritable=0;
 
+    if (m_blnNeedConfigUpdate)
+    {
+        qDebug("DATVDemodSink::feed: Settings applied. Standard : %d...", m_settings.m_standard);
+        m_blnNeedConfigUpdate=false;
+
+        if(m_settings.m_standard==DATVDemodSettings::DVB_S2)
+        {
+            printf("SWITCHING TO DVBS-2\r\n");
+            InitDATVS2Framework();
+        }
+        else
+        {
+            printf("SWITCHING TO DVBS\r\n");
+            InitDATVFramework();
+        }
+    }
+
+    m_rfIn.clear();
+
     //********** Bis repetita : Let's rock and roll buddy ! **********
 
 #ifdef EXTENDED_DIRECT_SAMPLE
@@ -1165,67 +1245,55 @@ void DATVDemodSink::feed(const SampleVector::const_iterator& begin, const Sample
 #endif
 
 
-        //********** demodulation **********
-
-
-        if (m_blnNeedConfigUpdate)
-        {
-            qDebug("DATVDemodSink::feed: Settings applied. Standard : %d...", m_settings.m_standard);
-            m_blnNeedConfigUpdate=false;
-
-            if(m_settings.m_standard==DATVDemodSettings::DVB_S2)
-            {
-                printf("SWITCHING TO DVBS-2\r\n");
-                InitDATVS2Framework();
-            }
-            else
-            {
-                printf("SWITCHING TO DVBS\r\n");
-                InitDATVFramework();
-            }
-        }
-
-
         //********** iq stream ****************
 
         Complex objC(fltI,fltQ);
 
         objC *= m_objNCO.nextIQ();
+        m_rfIn.push_back(objC);
+    } // Samples for loop
 
-        intRFOut = m_objRFFilter->runFilt(objC, &objRF); // filter RF before demod
+    //********** demodulation **********
 
-        for (int intI = 0 ; intI < intRFOut; intI++)
-        {
-            objIQ.re = objRF->real();
-            objIQ.im = objRF->imag();
-            magSq = objIQ.re*objIQ.re + objIQ.im*objIQ.im;
-            m_objMagSqAverage(magSq);
+    // filter RF before demod as a whole
+    m_rfOut.resize(m_rfIn.size() + m_objRFFilter->getBlockSize());
+    intRFOut = m_objRFFilter->runFilt(m_rfIn.data(), m_rfIn.size(), m_rfOut.data());
+    objRF = m_rfOut.data();
 
-            objRF ++;
+    for (int intI = 0 ; intI < intRFOut; intI++)
+    {
+        objIQ.re = objRF->real();
+        objIQ.im = objRF->imag();
+        magSq = objIQ.re*objIQ.re + objIQ.im*objIQ.im;
+        m_objMagSqAverage(magSq);
 
-            if (m_blnDVBInitialized
-               && (p_rawiq_writer!=nullptr)
-               && (m_objScheduler!=nullptr))
-            {
-                p_rawiq_writer->write(objIQ);
-                m_lngReadIQ++;
+        objRF ++;
 
-                lngWritable = p_rawiq_writer->writable();
+        if (m_blnDVBInitialized
+           && (p_rawiq_writer!=nullptr)
+           && (m_objScheduler!=nullptr))
+        {
+            p_rawiq_writer->write(objIQ);
+            m_lngReadIQ++;
+
+            lngWritable = p_rawiq_writer->writable();
 
-                //Leave +1 by safety
-                //if(((m_lngReadIQ+1)>=lngWritable) || (m_lngReadIQ>=768))
-                if((m_lngReadIQ+1)>=lngWritable)
-                {
-                    m_objScheduler->step();
+            //Leave +1 by safety
+            //if(((m_lngReadIQ+1)>=lngWritable) || (m_lngReadIQ>=768))
+            if((m_lngReadIQ+1)>=lngWritable)
+            {
+                m_objScheduler->step();
 
-                    m_lngReadIQ=0;
-                    //delete p_rawiq_writer;
-                    //p_rawiq_writer = new leansdr::pipewriter<leansdr::cf32>(*p_rawiq);
+                if (m_schedulerReportTimer.elapsed() >= m_schedulerReportPeriodMs) {
+                    reportSchedulerCPU();
                 }
-            }
 
+                m_lngReadIQ=0;
+                //delete p_rawiq_writer;
+                //p_rawiq_writer = new leansdr::pipewriter<leansdr::cf32>(*p_rawiq);
+            }
         }
-    } // Samples for loop
+    }
 
     // DVBS2: Track change of constellation via MODCOD
     if (m_settings.m_standard==DATVDemodSettings::DVB_S2)
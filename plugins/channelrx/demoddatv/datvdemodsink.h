@@ -18,6 +18,10 @@
 #ifndef INCLUDE_DATVDEMODSINK_H
 #define INCLUDE_DATVDEMODSINK_H
 
+#include <vector>
+
+#include <QElapsedTimer>
+
 //LeanSDR
 #include "leansdr/framework.h"
 #include "leansdr/generic.h"
@@ -138,6 +142,7 @@ private:
     void CleanUpDATVFramework(bool blnRelease);
     void InitDATVFramework();
     void InitDATVS2Framework();
+    void reportSchedulerCPU();
 
     static int getLeanDVBCodeRateFromDATV(DATVDemodSettings::DATVCodeRate datvCodeRate);
     static int getLeanDVBModulationFromDATV(DATVDemodSettings::DATVModulation datvModulation);
@@ -166,6 +171,11 @@ private:
     //************** LEANDBV Scheduler ***************
 
     leansdr::scheduler * m_objScheduler;
+    QElapsedTimer m_schedulerReportTimer;
+    static const int m_schedulerMaxThreads = 3;          //!< DVB-S decoding stages threads (DVB-S2 uses 2)
+    static const int m_ldpcMaxWorkers = 4;               //!< DVB-S2 LDPC decoding threads
+    static const int m_ldpcMaxIterations = 25;           //!< DVB-S2 LDPC layered min-sum decoder iterations
+    static const int m_schedulerReportPeriodMs = 1000;   //!< time spent in each stage is reported this often
     struct config m_objCfg;
 
     bool m_blnDVBInitialized;
@@ -283,6 +293,8 @@ private:
 	AudioFifo m_audioFifo;
 
     fftfilt * m_objRFFilter;
+    std::vector<fftfilt::cmplx> m_rfIn;  //!< NCO shifted samples collected by feed
+    std::vector<fftfilt::cmplx> m_rfOut; //!< RF filter output of one feed
     NCO m_objNCO;
 
     bool m_blnInitialized;
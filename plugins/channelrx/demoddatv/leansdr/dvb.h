@@ -23,6 +23,7 @@
 #include "leansdr/rs.h"
 #include "leansdr/sdr.h"
 #include "leansdr/viterbi.h"
+#include "leansdr/viterbi_k7.h"
 
 #ifndef M_PI
 #    define M_PI 3.14159265358979323846
@@ -1460,8 +1461,8 @@ struct derandomizer : runnable
 // Supports all code rates and constellations
 // Simplified metric to support large constellations.
 
-// This version implements puncturing by expanding the trellis.
-// TBD Compare performance vs skipping updates in a 1/2 trellis.
+// Puncturing is implemented by skipping the punctured coded bits
+// in the branch metrics of a 1/2 trellis (see viterbi_k7.h).
 
 struct viterbi_sync : runnable
 {
@@ -1470,41 +1471,6 @@ struct viterbi_sync : runnable
     typedef int32_t TPM;
     typedef viterbi_dec_interface<TUS, TCS, TBM, TPM> dvb_dec_interface;
 
-    // 1/2: 6 bits of state, 1 bit in, 2 bits out
-    typedef bitpath<uint32_t, TUS, 1, 32> path_12;
-    typedef trellis<TS, 64, TUS, 2, 4> trellis_12;
-    typedef viterbi_dec<TS, 64, TUS, 2, TCS, 4, TBM, TPM, path_12> dvb_dec_12;
-
-    // 2/3: 6 bits of state, 2 bits in, 3 bits out
-    typedef bitpath<uint64_t, TUS, 3, 21> path_23;
-    typedef trellis<TS, 64, TUS, 4, 8> trellis_23;
-    typedef viterbi_dec<TS, 64, TUS, 4, TCS, 8, TBM, TPM, path_23> dvb_dec_23;
-
-    // 4/6: 6 bits of state, 4 bits in, 6 bits out
-    typedef bitpath<uint64_t, TUS, 4, 16> path_46;
-    typedef trellis<TS, 64, TUS, 16, 64> trellis_46;
-    typedef viterbi_dec<TS, 64, TUS, 16, TCS, 64, TBM, TPM, path_46> dvb_dec_46;
-
-    // 3/4: 6 bits of state, 3 bits in, 4 bits out
-    typedef bitpath<uint64_t, TUS, 3, 21> path_34;
-    typedef trellis<TS, 64, TUS, 8, 16> trellis_34;
-    typedef viterbi_dec<TS, 64, TUS, 8, TCS, 16, TBM, TPM, path_34> dvb_dec_34;
-
-    // 4/5: 6 bits of state, 4 bits in, 5 bits out (non-standard)
-    typedef bitpath<uint64_t, TUS, 4, 16> path_45;
-    typedef trellis<TS, 64, TUS, 16, 32> trellis_45;
-    typedef viterbi_dec<TS, 64, TUS, 16, TCS, 32, TBM, TPM, path_45> dvb_dec_45;
-
-    // 5/6: 6 bits of state, 5 bits in, 6 bits out
-    typedef bitpath<uint64_t, TUS, 5, 12> path_56;
-    typedef trellis<TS, 64, TUS, 32, 64> trellis_56;
-    typedef viterbi_dec<TS, 64, TUS, 32, TCS, 64, TBM, TPM, path_56> dvb_dec_56;
-
-    // 7/8: 6 bits of state, 7 bits in, 8 bits out
-    typedef bitpath<uint64_t, TUS, 7, 9> path_78;
-    typedef trellis<TS, 64, TUS, 128, 256> trellis_78;
-    typedef viterbi_dec<TS, 64, TUS, 128, TCS, 256, TBM, TPM, path_78> dvb_dec_78;
-
   private:
     pipereader<eucl_ss> in;
     pipewriter<unsigned char> out;
@@ -1607,59 +1573,24 @@ struct viterbi_sync : runnable
 #endif
         }
 
-        if (cr == FEC12)
-        {
-            trellis_12 *trell = new trellis_12();
-            trell->init_convolutional(fec->polys);
-            for (int s = 0; s < nsyncs; ++s)
-                syncs[s].dec = new dvb_dec_12(trell);
-        }
-        else if (cr == FEC23)
-        {
-            trellis_23 *trell = new trellis_23();
-            trell->init_convolutional(fec->polys);
-            for (int s = 0; s < nsyncs; ++s)
-                syncs[s].dec = new dvb_dec_23(trell);
-        }
-        else if (cr == FEC46)
-        {
-            trellis_46 *trell = new trellis_46();
-            trell->init_convolutional(fec->polys);
-            for (int s = 0; s < nsyncs; ++s)
-                syncs[s].dec = new dvb_dec_46(trell);
-        }
-        else if (cr == FEC34)
-        {
-            trellis_34 *trell = new trellis_34();
-            trell->init_convolutional(fec->polys);
-            for (int s = 0; s < nsyncs; ++s)
-                syncs[s].dec = new dvb_dec_34(trell);
-        }
-        else if (cr == FEC45)
-        {
-            trellis_45 *trell = new trellis_45();
-            trell->init_convolutional(fec->polys);
-            for (int s = 0; s < nsyncs; ++s)
-                syncs[s].dec = new dvb_dec_45(trell);
-        }
-        else if (cr == FEC56)
-        {
-            trellis_56 *trell = new trellis_56();
-            trell->init_convolutional(fec->polys);
-            for (int s = 0; s < nsyncs; ++s)
-                syncs[s].dec = new dvb_dec_56(trell);
-        }
-        else if (cr == FEC78)
-        {
-            trellis_78 *trell = new trellis_78();
-            trell->init_convolutional(fec->polys);
-            for (int s = 0; s < nsyncs; ++s)
-                syncs[s].dec = new dvb_dec_78(trell);
-        }
-        else
-        {
+        if (!fec->bits_in)
             fail("CR not supported");
+
+        // Cost of a FEC block of noiseless symbols (see update_sync)
+        int dmin2 = 65535;
+
+        for (int i = 0; i < cstln->nsymbols; ++i)
+        {
+            for (int j = i + 1; j < cstln->nsymbols; ++j)
+            {
+                int dI = cstln->symbols[i].re - cstln->symbols[j].re;
+                int dQ = cstln->symbols[i].im - cstln->symbols[j].im;
+                dmin2 = min(dmin2, dI * dI + dQ * dQ);
+            }
         }
+
+        for (int s = 0; s < nsyncs; ++s)
+            syncs[s].dec = new viterbi_k7_dec(fec->bits_in, fec->bits_out, fec->polys, nshifts * dmin2);
     }
 
     TCS *init_map(bool conj, float angle)
@@ -1768,7 +1699,10 @@ struct viterbi_sync : runnable
                     if (totaldiscr[s] > totaldiscr[best])
                         best = s;
 
-                if (best != current_sync)
+                // Some synchronizers decode equivalent codewords. Soft
+                // metrics do not make them tie exactly so only switch to
+                // a clearly better one.
+                if (best != current_sync && totaldiscr[best] - totaldiscr[current_sync] > totaldiscr[current_sync] / 8)
                 {
                     if (sch->debug)
                         fprintf(stderr, "{%d->%d}", current_sync, best);
@@ -33,6 +33,7 @@
 #include "dvb.h"
 #include "softword.h"
 #include "ldpc.h"
+#include "ldpc_minsum.h"
 #include "sdr.h"
 
 namespace leansdr
@@ -2428,6 +2429,102 @@ struct s2_fecdec_helper : runnable
     pipewriter<int> *bitcount, *errcount;
 }; // s2_fecdec_helper
 
+// S2 SOFT FEC DECODER AND BASEBAND DESCRAMBLER
+// Layered min-sum LDPC decoding of LLR frames (see ldpc_minsum.h)
+// on a pool of worker threads, then BCH decoding and descrambling
+// as with s2_fecdec. Frames are output in input order.
+
+struct s2_fecdec_soft : runnable
+{
+    s2_fecdec_soft(scheduler *sch,
+                   pipebuf<fecframe<llr_sb>> &_in, pipebuf<bbframe> &_out,
+                   int nworkers, int max_iterations,
+                   pipebuf<int> *_bitcount = NULL,
+                   pipebuf<int> *_errcount = NULL)
+        : runnable(sch, "S2 fecdec soft"),
+          in(_in), out(_out),
+          bitcount(opt_writer(_bitcount, 1)),
+          errcount(opt_writer(_errcount, 1)),
+          pool(nworkers, max_iterations)
+    {
+        memset(codes, 0, sizeof(codes));
+    }
+    ~s2_fecdec_soft()
+    {
+        for (int sf = 0; sf <= 1; ++sf)
+            for (int fec = 0; fec < FEC_COUNT; ++fec)
+                delete codes[sf][fec];
+    }
+    void run()
+    {
+        // Hand over all the available frames first so that the workers
+        // decode them while the older ones are completed here.
+        ldpc_minsum_pool::job *job;
+        while (in.readable() >= 1 && !plss.full() && (job = pool.get_next()))
+        {
+            fecframe<llr_sb> *pin = in.rd();
+            const modcod_info *mcinfo = check_modcod(pin->pls.modcod);
+            if (!fec_infos[pin->pls.sf][mcinfo->rate].ldpc)
+            {
+                in.read(1); // No such code for this frame size
+                continue;
+            }
+            job->code = get_code(pin->pls.sf, mcinfo->rate);
+            memcpy(job->llrs, pin->bytes, pin->pls.framebits());
+            *plss.put() = pin->pls;
+            pool.push();
+            in.read(1);
+        }
+        while (out.writable() >= 1 &&
+               opt_writable(bitcount, 1) && opt_writable(errcount, 1) &&
+               (job = pool.front()))
+        {
+            const s2_pls *pls = plss.get();
+            const modcod_info *mcinfo = check_modcod(pls->modcod);
+            const fec_info *fi = &fec_infos[pls->sf][mcinfo->rate];
+            if (sch->debug2)
+                fprintf(stderr, "LDPCITER = %d\n", job->iterations);
+            // BCH decode
+            size_t cwbytes = fi->kldpc / 8;
+            bch_interface *bch = s2bch.bchs[pls->sf][mcinfo->rate];
+            int ncorr = bch->decode(job->bits, cwbytes);
+            if (sch->debug2)
+                fprintf(stderr, "BCHCORR = %d\n", ncorr);
+            bool corrupted = (ncorr < 0);
+            // Report VER
+            opt_write(bitcount, fi->Kbch);
+            opt_write(errcount, (ncorr >= 0) ? ncorr : fi->Kbch);
+            if (!corrupted)
+            {
+                // Descramble and output
+                bbframe *pout = out.wr();
+                pout->pls = *pls;
+                bbscrambling.transform(job->bits, fi->Kbch / 8, pout->bytes);
+                out.written(1);
+            }
+            if (sch->debug)
+                fprintf(stderr, "%c", corrupted ? ':' : (job->iterations < 0) ? '!' : ncorr ? '.' : '_');
+            pool.pop();
+        }
+    }
+
+  private:
+    const ldpc_minsum_code *get_code(int sf, int fec)
+    {
+        if (!codes[sf][fec])
+            codes[sf][fec] = new ldpc_minsum_code(fec_infos[sf][fec].ldpc, sf ? 64800 / 4 : 64800);
+        return codes[sf][fec];
+    }
+    pipereader<fecframe<llr_sb>> in;
+    pipewriter<bbframe> out;
+    pipewriter<int> *bitcount, *errcount;
+    ldpc_minsum_code *codes[2][FEC_COUNT]; // [shortframes][fec] built on first use
+    simplequeue<s2_pls, 64> plss;          // Frames in the pool
+    ldpc_minsum_pool pool;
+    s2_bch_engines s2bch;
+    s2_bbscrambling bbscrambling;
+}; // s2_fecdec_soft
+
 // S2 FRAMER
 // EN 302 307-1 section 5.1 Mode adaptation
 
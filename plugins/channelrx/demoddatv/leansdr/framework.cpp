@@ -1,5 +1,16 @@
 #include "framework.h"
 
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 namespace leansdr
 {
 
@@ -13,4 +24,216 @@ void fail(const char *s)
     fprintf(stderr, "** %s\n", s);
 }
 
+static std::size_t ring_granularity()
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwAllocationGranularity; // views are placed at multiples of this
+#else
+    long page = sysconf(_SC_PAGESIZE);
+    return page > 0 ? page : 0;
+#endif
+}
+
+std::size_t ring_unit(std::size_t item_bytes)
+{
+    std::size_t granularity = ring_granularity();
+
+    if (!granularity || !item_bytes)
+        return 0;
+
+    std::size_t a = granularity, b = item_bytes;
+
+    while (b)
+    {
+        std::size_t r = a % b;
+        a = b;
+        b = r;
+    }
+
+    return granularity / a; // ring bytes must be a multiple of the granularity
+}
+
+void *ring_alloc(std::size_t bytes)
+{
+#if defined(_WIN32)
+    HANDLE mapping = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+        (DWORD) ((unsigned long long) bytes >> 32), (DWORD) bytes, NULL);
+
+    if (!mapping)
+        return NULL;
+
+    char *base = NULL;
+
+    // Another thread may take the address range between the probe and the
+    // mapping of the views so try again a few times
+    for (int attempt = 0; (attempt < 8) && !base; ++attempt)
+    {
+        char *probe = (char *) VirtualAlloc(NULL, 2 * bytes, MEM_RESERVE, PAGE_NOACCESS);
+
+        if (!probe)
+            break;
+
+        VirtualFree(probe, 0, MEM_RELEASE);
+        void *lo = MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes, probe);
+
+        if (!lo)
+            continue;
+
+        void *hi = MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes, probe + bytes);
+
+        if (!hi)
+        {
+            UnmapViewOfFile(lo);
+            continue;
+        }
+
+        base = probe;
+    }
+
+    CloseHandle(mapping); // the views hold the mapping
+    return base;
+#else
+    int fd;
+#if defined(MFD_CLOEXEC)
+    fd = memfd_create("leansdr", MFD_CLOEXEC);
+#else
+    static std::atomic<unsigned int> counter(0);
+    char name[32];
+    snprintf(name, sizeof(name), "/leansdr-%d-%u", (int) getpid(), counter++);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+
+    if (fd >= 0)
+        shm_unlink(name);
+#endif
+
+    if (fd < 0)
+        return NULL;
+
+    char *base = NULL;
+
+    if (ftruncate(fd, bytes) == 0)
+    {
+        // reserve the whole range then map the memory twice over it
+        void *range = mmap(NULL, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (range != MAP_FAILED)
+        {
+            char *p = (char *) range;
+
+            if ((mmap(p, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED)
+             && (mmap(p + bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED))
+                base = p;
+            else
+                munmap(range, 2 * bytes);
+        }
+    }
+
+    close(fd); // the mappings hold the memory
+    return base;
+#endif
+}
+
+void ring_free(void *base, std::size_t bytes)
+{
+#if defined(_WIN32)
+    UnmapViewOfFile(base);
+    UnmapViewOfFile((char *) base + bytes);
+#else
+    munmap(base, 2 * bytes);
+#endif
+}
+
+void scheduler::start_threads()
+{
+    stop_threads();
+    nthreads = 1;
+
+    for (int i = 0; i < nrunnables; ++i)
+        nthreads = std::max(nthreads, runnables[i]->thread + 1);
+
+    stopping = false;
+    nidle = 0;
+
+    for (int t = 1; t < nthreads; ++t)
+        threads.push_back(std::thread(&scheduler::thread_loop, this, t));
+}
+
+void scheduler::stop_threads()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    wake.notify_all();
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    threads.clear();
+    nthreads = 1;
+}
+
+// Thread 0 runs its runnables until the whole graph reaches fixpoint. The other
+// threads keep running theirs meanwhile so the stages overlap. Progress is
+// detected from the pipe counters like the serial fixpoint.
+void scheduler::step_threads()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (1)
+    {
+        unsigned long long gen = generation;
+        unsigned long long h = hash();
+        lock.unlock();
+        pass(0);
+        bool progress = hash() != h;
+        lock.lock();
+
+        if (progress)
+        {
+            generation++;
+            nidle = 0; // idle threads have to check again
+            wake.notify_all();
+        }
+        else if (generation == gen)
+        {
+            if (nidle == nthreads - 1)
+                break;
+            // other threads are still busy
+            wake.wait(lock, [&] { return generation != gen || nidle == nthreads - 1; });
+        }
+    }
+}
+
+void scheduler::thread_loop(int t)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (!stopping)
+    {
+        unsigned long long gen = generation;
+        unsigned long long h = hash();
+        lock.unlock();
+        pass(t);
+        bool progress = hash() != h;
+        lock.lock();
+
+        if (progress)
+        {
+            generation++;
+            nidle = 0; // idle threads have to check again
+            wake.notify_all();
+        }
+        else if (generation == gen)
+        {
+            nidle++;
+            wake.notify_all();
+            wake.wait(lock, [&] { return stopping || generation != gen; });
+        }
+    }
+}
+
 } // leansdr
@@ -19,6 +19,13 @@
 
 #include <cstddef>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
 
 #include <math.h>
 #include <stdint.h>
@@ -36,6 +43,12 @@ namespace leansdr
 void fatal(const char *s);
 void fail(const char *s);
 
+// Smallest number of items of [item_bytes] bytes for which ring_alloc works
+std::size_t ring_unit(std::size_t item_bytes);
+// Maps [bytes] of memory twice in a row, NULL if not possible
+void *ring_alloc(std::size_t bytes);
+void ring_free(void *base, std::size_t bytes);
+
 //////////////////////////////////////////////////////////////////////
 // DSP framework
 //////////////////////////////////////////////////////////////////////
@@ -45,10 +58,18 @@ void fail(const char *s);
 // [pipereader] is a client-side hook reading from a [pipebuf].
 // [runnable] is anything that moves data between [pipebufs].
 // [scheduler] is a global context which invokes [runnables] until fixpoint.
+//
+// Runnables may be spread over several threads (see scheduler::set_thread).
+// A [pipebuf] has a single writer and its readers may run on other threads
+// than the writer. Positions are atomic counters and the buffer is a ring
+// mapped twice in a row so that [pipewriter] and [pipereader] still give
+// contiguous windows without moving data. Where the ring cannot be mapped
+// twice every item is copied half a buffer away instead.
 
 static const int MAX_PIPES = 64;
 static const int MAX_RUNNABLES = 64;
 static const int MAX_READERS = 8;
+static const int MAX_THREADS = 8;
 
 struct pipebuf_common
 {
@@ -81,8 +102,10 @@ struct pipebuf_common
 struct runnable_common
 {
     const char *name;
+    int thread;                            // 0: thread calling scheduler::step
+    std::atomic<unsigned long long> busy_ns; // time spent in run(), reset by the reader
 
-    runnable_common(const char *_name) : name(_name)
+    runnable_common(const char *_name) : name(_name), thread(0), busy_ns(0)
     {
     }
 
@@ -125,8 +148,17 @@ struct scheduler
                   windows(NULL),
                   verbose(false),
                   debug(false),
-                  debug2(false)
+                  debug2(false),
+                  nthreads(1),
+                  generation(0),
+                  nidle(0),
+                  stopping(false)
+    {
+    }
+
+    ~scheduler()
     {
+        stop_threads();
     }
 
     void add_pipe(pipebuf_common *p)
@@ -143,10 +175,27 @@ struct scheduler
         runnables[nrunnables++] = r;
     }
 
+    // Runs [r] on thread [t] once start_threads is called.
+    // Runnables sharing state other than pipes must be on the same thread.
+    void set_thread(runnable_common *r, int t)
+    {
+        if (t < 0 || t >= MAX_THREADS)
+            fail("MAX_THREADS");
+        r->thread = t;
+    }
+
+    // Starts the threads of the runnables not on thread 0.
+    // Without threads step() runs each runnable once.
+    // With threads step() runs the thread 0 runnables until all threads reach fixpoint.
+    void start_threads();
+    void stop_threads();
+
     void step()
     {
-        for (int i = 0; i < nrunnables; ++i)
-            runnables[i]->run();
+        if (nthreads > 1)
+            step_threads();
+        else
+            pass(0);
     }
 
     void run()
@@ -165,6 +214,7 @@ struct scheduler
 
     void shutdown()
     {
+        stop_threads();
         for (int i = 0; i < nrunnables; ++i)
             runnables[i]->shutdown();
     }
@@ -186,6 +236,35 @@ struct scheduler
         fprintf(stderr, "Total buffer memory: %ld KiB\n",
                 (unsigned long)total_bufs / 1024);
     }
+
+  private:
+    int nthreads;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    unsigned long long generation; // incremented when a thread makes progress
+    int nidle;                     // threads other than 0 idle since the last progress
+    bool stopping;
+
+    // Runs the runnables of thread [t] once
+    void pass(int t)
+    {
+        for (int i = 0; i < nrunnables; ++i)
+        {
+            runnable_common *r = runnables[i];
+
+            if (r->thread != t)
+                continue;
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            r->run();
+            r->busy_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+        }
+    }
+
+    void step_threads();
+    void thread_loop(int t);
 };
 
 struct runnable : runnable_common
@@ -202,84 +281,140 @@ struct runnable : runnable_common
 template <typename T>
 struct pipebuf : pipebuf_common
 {
-    T *buf;
-    T *rds[MAX_READERS];
+    T *buf;                   // 2*size items
+    unsigned long size;
+    bool mapped;              // the second half of buf is the first one mapped again
+    std::atomic<unsigned long long> rds[MAX_READERS]; // items read by each reader
     int nrd;
-    T *wr;
-    T *end;
+    std::atomic<unsigned long long> wr; // items written
 
     int sizeofT()
     {
         return sizeof(T);
     }
 
-    pipebuf(scheduler *sch, const char *name, unsigned long size) : pipebuf_common(name),
-                                                                    buf(new T[size]),
-                                                                    nrd(0), wr(buf),
-                                                                    end(buf + size),
-                                                                    min_write(1),
-                                                                    total_written(0),
-                                                                    total_read(0)
+    pipebuf(scheduler *sch, const char *name, unsigned long _size) : pipebuf_common(name),
+                                                                     buf(NULL),
+                                                                     size(_size),
+                                                                     mapped(false),
+                                                                     nrd(0), wr(0),
+                                                                     min_write(1)
     {
+        allocate();
         sch->add_pipe(this);
     }
 
+    ~pipebuf()
+    {
+#ifdef DEBUG
+        fprintf(stderr, "Deallocating %s !\n", name);
+#endif
+        if (mapped)
+        {
+            for (unsigned long i = 0; i < size; ++i)
+                buf[i].~T();
+            ring_free(buf, size * sizeof(T));
+        }
+        else
+        {
+            delete[] buf;
+        }
+    }
+
+    // The ring is mapped twice when rounding it to whole pages at most
+    // doubles it or adds less than 1 MiB. Else items are mirrored by copy.
+    void allocate()
+    {
+        unsigned long unit = ring_unit(sizeof(T));
+        unsigned long rounded = ((size + unit - 1) / unit) * unit;
+
+        if (unit && (rounded <= 2 * size || (rounded - size) * sizeof(T) < (1 << 20)))
+        {
+            void *base = ring_alloc(rounded * sizeof(T));
+
+            if (base)
+            {
+                buf = (T *) base;
+                size = rounded;
+                mapped = true;
+                for (unsigned long i = 0; i < size; ++i)
+                    new (buf + i) T;
+                return;
+            }
+        }
+
+        buf = new T[2 * size];
+    }
+
     int add_reader()
     {
         if (nrd == MAX_READERS)
             fail("too many readers");
-        rds[nrd] = wr;
+        rds[nrd].store(wr.load());
         return nrd++;
     }
 
-    void pack()
+    // Oldest item not read by all readers (writer side)
+    unsigned long long min_rd()
     {
-        T *rd = wr;
+        unsigned long long w = wr.load(std::memory_order_relaxed);
+        unsigned long long rd = w;
         for (int i = 0; i < nrd; ++i)
-            if (rds[i] < rd)
-                rd = rds[i];
-        memmove(buf, rd, (wr - rd) * sizeof(T));
-        wr -= rd - buf;
-        for (int i = 0; i < nrd; ++i)
-            rds[i] -= rd - buf;
+        {
+            unsigned long long r = rds[i].load(std::memory_order_acquire);
+            if (w - r > w - rd)
+                rd = r;
+        }
+        return rd;
+    }
+
+    // Copies items [p, p+n) of the buffer to their mirror half a buffer away
+    void mirror(unsigned long p, unsigned long n)
+    {
+        if (mapped)
+            return;
+        if (p < size)
+        {
+            unsigned long n1 = std::min(n, size - p);
+            memcpy(buf + p + size, buf + p, n1 * sizeof(T));
+            p += n1;
+            n -= n1;
+        }
+        if (n)
+            memcpy(buf + p - size, buf + p, n * sizeof(T));
     }
 
     long long hash()
     {
-        return total_written + total_read;
+        unsigned long long h = wr.load(std::memory_order_relaxed);
+        for (int i = 0; i < nrd; ++i)
+            h += rds[i].load(std::memory_order_relaxed);
+        return h;
     }
 
     void dump(std::size_t *total_bufs)
     {
-        if (total_written < 10000)
-            fprintf(stderr, ".%-16s : %4ld/%4ld", name, total_read,
-                    total_written);
-        else if (total_written < 1000000)
-            fprintf(stderr, ".%-16s : %3ldk/%3ldk", name, total_read / 1000,
-                    total_written / 1000);
+        unsigned long long w = wr.load();
+        unsigned long long total_read = 0;
+        for (int j = 0; j < nrd; ++j)
+            total_read += rds[j].load();
+        if (w < 10000)
+            fprintf(stderr, ".%-16s : %4llu/%4llu", name, total_read, w);
+        else if (w < 1000000)
+            fprintf(stderr, ".%-16s : %3lluk/%3lluk", name, total_read / 1000,
+                    w / 1000);
         else
-            fprintf(stderr, ".%-16s : %3ldM/%3ldM", name, total_read / 1000000,
-                    total_written / 1000000);
-        *total_bufs += (end - buf) * sizeof(T);
-        unsigned long nw = end - wr;
+            fprintf(stderr, ".%-16s : %3lluM/%3lluM", name, total_read / 1000000,
+                    w / 1000000);
+        *total_bufs += 2 * size * sizeof(T);
+        unsigned long nw = size - (w - min_rd());
         fprintf(stderr, " %6ld writable %c,", nw, (nw < min_write) ? '!' : ' ');
-        T *rd = wr;
+        fprintf(stderr, " %6d unread (", (int)(w - min_rd()));
         for (int j = 0; j < nrd; ++j)
-            if (rds[j] < rd)
-                rd = rds[j];
-        fprintf(stderr, " %6d unread (", (int)(wr - rd));
-        for (int j = 0; j < nrd; ++j)
-            fprintf(stderr, " %d", (int)(wr - rds[j]));
+            fprintf(stderr, " %d", (int)(w - rds[j].load()));
         fprintf(stderr, " )\n");
     }
     unsigned long min_write;
-    unsigned long total_written, total_read;
-#ifdef DEBUG
-    ~pipebuf()
-    {
-        fprintf(stderr, "Deallocating %s !\n", name);
-    }
-#endif
 };
 
 template <typename T>
@@ -295,25 +430,25 @@ struct pipewriter
     // Return number of items writable at this->wr, 0 if full.
     long writable()
     {
-        if (buf.end < buf.min_write + buf.wr)
-            buf.pack();
-        return buf.end - buf.wr;
+        return buf.size - (buf.wr.load(std::memory_order_relaxed) - buf.min_rd());
     }
 
     T *wr()
     {
-        return buf.wr;
+        return buf.buf + buf.wr.load(std::memory_order_relaxed) % buf.size;
     }
 
     void written(unsigned long n)
     {
-        if (buf.wr + n > buf.end)
+        unsigned long long w = buf.wr.load(std::memory_order_relaxed);
+
+        if (w + n - buf.min_rd() > buf.size)
         {
             fprintf(stderr, "Bug: overflow to %s\n", buf.name);
         }
 
-        buf.wr += n;
-        buf.total_written += n;
+        buf.mirror(w % buf.size, n);
+        buf.wr.store(w + n, std::memory_order_release);
     }
 
     void write(const T &e)
@@ -356,23 +491,24 @@ struct pipereader
 
     long readable()
     {
-        return buf.wr - buf.rds[id];
+        return buf.wr.load(std::memory_order_acquire) - buf.rds[id].load(std::memory_order_relaxed);
     }
 
     T *rd()
     {
-        return buf.rds[id];
+        return buf.buf + buf.rds[id].load(std::memory_order_relaxed) % buf.size;
     }
 
     void read(unsigned long n)
     {
-        if (buf.rds[id] + n > buf.wr)
+        unsigned long long r = buf.rds[id].load(std::memory_order_relaxed);
+
+        if (r + n > buf.wr.load(std::memory_order_acquire))
         {
             fprintf(stderr, "Bug: underflow from %s\n", buf.name);
         }
 
-        buf.rds[id] += n;
-        buf.total_read += n;
+        buf.rds[id].store(r + n, std::memory_order_release);
     }
 };
 
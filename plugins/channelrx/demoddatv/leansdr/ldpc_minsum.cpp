@@ -0,0 +1,602 @@
+#include "ldpc_minsum.h"
+
+#include <algorithm>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define LDPC_X86
+#define LDPC_TARGET(arch) __attribute__((target(arch)))
+#elif defined(_MSC_VER) && (defined(_M_AMD64) || defined(_M_IX86))
+#include <immintrin.h>
+#define LDPC_X86
+#define LDPC_TARGET(arch)
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define LDPC_NEON
+#endif
+
+namespace leansdr
+{
+
+// Channel LLRs are scaled up so that the normalization of the
+// check to bit messages by 3/4 does not lose too much precision.
+static const int LLR_SCALE = 4;
+static const int16_t LLR_MAX = 32767;
+
+static inline uint8_t get_bit(const uint8_t *p, int b)
+{
+    return (p[b >> 3] >> (7 - (b & 7))) & 1;
+}
+
+static inline void set_bit(uint8_t *p, int b, uint8_t v)
+{
+    uint8_t mask = 1 << (7 - (b & 7));
+    p[b >> 3] = (p[b >> 3] & ~mask) | (v ? mask : 0);
+}
+
+static inline int16_t sat16(int v)
+{
+    return v > 32767 ? 32767 : v < -32768 ? -32768 : v;
+}
+
+// LDPC CODE LAYOUT
+
+ldpc_minsum_code::ldpc_minsum_code(const ldpc_table<uint16_t> *_table, int _n)
+    : k(_table->nrows * 360), n(_n), q(_table->q), max_degree(0), table(_table)
+{
+    int n_k = n - k;
+
+    if (q * 360 != n_k)
+        fatal("Bad q");
+
+    // Table column c connects check c+mw*q mod n-k to message bit
+    // row*360+mw, i.e. lane (c/q+mw) mod 360 of layer c%q.
+    std::vector<std::vector<edge>> info_edges(q);
+
+    for (int row = 0; row < table->nrows; ++row)
+    {
+        for (int nc = 0; nc < table->rows[row].ncols; ++nc)
+        {
+            int c = table->rows[row].cols[nc];
+            if (c >= n_k)
+                fail("Invalid LDPC table");
+            edge e = {row * 360, c / q};
+            info_edges[c % q].push_back(e);
+        }
+    }
+
+    // Check r+j*q also connects parities r+j*q and r-1+j*q
+    // (r-1 is q-1 one lane before for r=0 and check 0 has only one).
+    layers.resize(q + 1);
+
+    for (int r = 0; r < q; ++r)
+    {
+        layers[r] = edges.size();
+        edges.insert(edges.end(), info_edges[r].begin(), info_edges[r].end());
+        edge cur = {k + r * 360, 0};
+        edge prev = {r ? k + (r - 1) * 360 : k + (q - 1) * 360, r ? 0 : 1};
+        edges.push_back(cur);
+        edges.push_back(prev);
+        max_degree = std::max(max_degree, (int)(edges.size() - layers[r]));
+    }
+
+    layers[q] = edges.size();
+}
+
+void ldpc_minsum_code::encode(const uint8_t *msg, uint8_t *cw) const
+{
+    int n_k = n - k;
+    std::vector<uint8_t> parity(n_k, 0);
+
+    for (int row = 0; row < table->nrows; ++row)
+    {
+        for (int mw = 0; mw < 360; ++mw)
+        {
+            if (!get_bit(msg, row * 360 + mw))
+                continue;
+            for (int nc = 0; nc < table->rows[row].ncols; ++nc)
+            {
+                int a = table->rows[row].cols[nc] + mw * q;
+                parity[a % n_k] ^= 1;
+            }
+        }
+    }
+
+    // EN 302 307-1 5.3.2.1 post-processing of parity bits
+    for (int i = 1; i < n_k; ++i)
+        parity[i] ^= parity[i - 1];
+
+    if (cw != msg)
+        memcpy(cw, msg, k / 8);
+
+    for (int i = 0; i < n_k; ++i)
+        set_bit(cw, k + i, parity[i]);
+}
+
+bool ldpc_minsum_code::check(const uint8_t *cw) const
+{
+    int n_k = n - k;
+    std::vector<uint8_t> syndrome(n_k, 0);
+
+    for (int row = 0; row < table->nrows; ++row)
+    {
+        for (int mw = 0; mw < 360; ++mw)
+        {
+            if (!get_bit(cw, row * 360 + mw))
+                continue;
+            for (int nc = 0; nc < table->rows[row].ncols; ++nc)
+            {
+                int a = table->rows[row].cols[nc] + mw * q;
+                syndrome[a % n_k] ^= 1;
+            }
+        }
+    }
+
+    uint8_t prev = 0;
+
+    for (int i = 0; i < n_k; ++i)
+    {
+        uint8_t p = get_bit(cw, k + i);
+        if (syndrome[i] ^ p ^ prev)
+            return false;
+        prev = p;
+    }
+
+    return true;
+}
+
+// CHECK NODE KERNELS
+// For each lane of a layer:
+//   t[e] = t[e]-r[e]  (bit LLR without the message of this check)
+//   r'[e] = 3/4 * product of the signs of the other t * min of the other |t|
+//   t[e] = r'[e]-r[e], r[e] = r'[e]  (to be added to the bit LLR)
+//   syn |= product of the signs of the bit LLRs (check not satisfied)
+// All kernels compute exactly the same saturated int16_t values.
+
+static void layer_generic(int16_t *t, int16_t *r, int degree, int16_t *syn)
+{
+    const int S = ldpc_minsum_code::STRIDE;
+
+    for (int j = 0; j < S; ++j)
+    {
+        int16_t min1 = LLR_MAX, min2 = LLR_MAX, sgn = 0, par = 0;
+        int idx = 0;
+
+        for (int e = 0; e < degree; ++e)
+        {
+            int16_t *pt = &t[e * S + j];
+            par ^= *pt;
+            int16_t v = sat16(*pt - r[e * S + j]);
+            *pt = v;
+            sgn ^= v;
+            int16_t a = std::max(v, sat16(-v));
+            if (a < min1)
+                idx = e;
+            min2 = std::min(min2, std::max(min1, a));
+            min1 = std::min(min1, a);
+        }
+
+        int16_t m1 = min1 - (min1 >> 2);
+        int16_t m2 = min2 - (min2 >> 2);
+
+        for (int e = 0; e < degree; ++e)
+        {
+            int16_t *pt = &t[e * S + j];
+            int16_t *pr = &r[e * S + j];
+            int16_t mag = (e == idx) ? m2 : m1;
+            int16_t rn = ((int16_t)(*pt ^ sgn) < 0) ? -mag : mag;
+            *pt = sat16(rn - *pr);
+            *pr = rn;
+        }
+
+        syn[j] |= par;
+    }
+}
+
+static void add_generic(int16_t *dst, const int16_t *src, int n)
+{
+    for (int i = 0; i < n; ++i)
+        dst[i] = sat16(dst[i] + src[i]);
+}
+
+#if defined(LDPC_X86)
+LDPC_TARGET("sse2")
+static void layer_sse2(int16_t *t, int16_t *r, int degree, int16_t *syn)
+{
+    const int S = ldpc_minsum_code::STRIDE;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i llrmax = _mm_set1_epi16(LLR_MAX);
+
+    for (int j = 0; j < S; j += 8)
+    {
+        __m128i min1 = llrmax, min2 = llrmax, idx = zero, sgn = zero, par = zero;
+
+        for (int e = 0; e < degree; ++e)
+        {
+            __m128i *pt = (__m128i *)&t[e * S + j];
+            __m128i l = _mm_loadu_si128(pt);
+            par = _mm_xor_si128(par, l);
+            __m128i v = _mm_subs_epi16(l, _mm_loadu_si128((__m128i *)&r[e * S + j]));
+            _mm_storeu_si128(pt, v);
+            sgn = _mm_xor_si128(sgn, v);
+            __m128i a = _mm_max_epi16(v, _mm_subs_epi16(zero, v));
+            __m128i lt = _mm_cmplt_epi16(a, min1);
+            idx = _mm_or_si128(_mm_and_si128(lt, _mm_set1_epi16(e)), _mm_andnot_si128(lt, idx));
+            min2 = _mm_min_epi16(min2, _mm_max_epi16(min1, a));
+            min1 = _mm_min_epi16(min1, a);
+        }
+
+        __m128i m1 = _mm_sub_epi16(min1, _mm_srai_epi16(min1, 2));
+        __m128i m2 = _mm_sub_epi16(min2, _mm_srai_epi16(min2, 2));
+
+        for (int e = 0; e < degree; ++e)
+        {
+            __m128i *pt = (__m128i *)&t[e * S + j];
+            __m128i *pr = (__m128i *)&r[e * S + j];
+            __m128i eq = _mm_cmpeq_epi16(idx, _mm_set1_epi16(e));
+            __m128i mag = _mm_or_si128(_mm_and_si128(eq, m2), _mm_andnot_si128(eq, m1));
+            __m128i neg = _mm_srai_epi16(_mm_xor_si128(_mm_loadu_si128(pt), sgn), 15);
+            __m128i rn = _mm_sub_epi16(_mm_xor_si128(mag, neg), neg);
+            _mm_storeu_si128(pt, _mm_subs_epi16(rn, _mm_loadu_si128(pr)));
+            _mm_storeu_si128(pr, rn);
+        }
+
+        _mm_storeu_si128((__m128i *)&syn[j], _mm_or_si128(_mm_loadu_si128((__m128i *)&syn[j]), par));
+    }
+}
+
+LDPC_TARGET("sse2")
+static void add_sse2(int16_t *dst, const int16_t *src, int n)
+{
+    int i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i d = _mm_loadu_si128((__m128i *)&dst[i]);
+        _mm_storeu_si128((__m128i *)&dst[i], _mm_adds_epi16(d, _mm_loadu_si128((const __m128i *)&src[i])));
+    }
+
+    add_generic(dst + i, src + i, n - i);
+}
+
+LDPC_TARGET("avx2")
+static void layer_avx2(int16_t *t, int16_t *r, int degree, int16_t *syn)
+{
+    const int S = ldpc_minsum_code::STRIDE;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i llrmax = _mm256_set1_epi16(LLR_MAX);
+
+    for (int j = 0; j < S; j += 16)
+    {
+        __m256i min1 = llrmax, min2 = llrmax, idx = zero, sgn = zero, par = zero;
+
+        for (int e = 0; e < degree; ++e)
+        {
+            __m256i *pt = (__m256i *)&t[e * S + j];
+            __m256i l = _mm256_loadu_si256(pt);
+            par = _mm256_xor_si256(par, l);
+            __m256i v = _mm256_subs_epi16(l, _mm256_loadu_si256((__m256i *)&r[e * S + j]));
+            _mm256_storeu_si256(pt, v);
+            sgn = _mm256_xor_si256(sgn, v);
+            __m256i a = _mm256_max_epi16(v, _mm256_subs_epi16(zero, v));
+            __m256i lt = _mm256_cmpgt_epi16(min1, a);
+            idx = _mm256_blendv_epi8(idx, _mm256_set1_epi16(e), lt);
+            min2 = _mm256_min_epi16(min2, _mm256_max_epi16(min1, a));
+            min1 = _mm256_min_epi16(min1, a);
+        }
+
+        __m256i m1 = _mm256_sub_epi16(min1, _mm256_srai_epi16(min1, 2));
+        __m256i m2 = _mm256_sub_epi16(min2, _mm256_srai_epi16(min2, 2));
+
+        for (int e = 0; e < degree; ++e)
+        {
+            __m256i *pt = (__m256i *)&t[e * S + j];
+            __m256i *pr = (__m256i *)&r[e * S + j];
+            __m256i eq = _mm256_cmpeq_epi16(idx, _mm256_set1_epi16(e));
+            __m256i mag = _mm256_blendv_epi8(m1, m2, eq);
+            __m256i neg = _mm256_srai_epi16(_mm256_xor_si256(_mm256_loadu_si256(pt), sgn), 15);
+            __m256i rn = _mm256_sub_epi16(_mm256_xor_si256(mag, neg), neg);
+            _mm256_storeu_si256(pt, _mm256_subs_epi16(rn, _mm256_loadu_si256(pr)));
+            _mm256_storeu_si256(pr, rn);
+        }
+
+        _mm256_storeu_si256((__m256i *)&syn[j], _mm256_or_si256(_mm256_loadu_si256((__m256i *)&syn[j]), par));
+    }
+}
+
+LDPC_TARGET("avx2")
+static void add_avx2(int16_t *dst, const int16_t *src, int n)
+{
+    int i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i d = _mm256_loadu_si256((__m256i *)&dst[i]);
+        _mm256_storeu_si256((__m256i *)&dst[i], _mm256_adds_epi16(d, _mm256_loadu_si256((const __m256i *)&src[i])));
+    }
+
+    add_sse2(dst + i, src + i, n - i);
+}
+#endif // LDPC_X86
+
+#if defined(LDPC_NEON)
+static void layer_neon(int16_t *t, int16_t *r, int degree, int16_t *syn)
+{
+    const int S = ldpc_minsum_code::STRIDE;
+    const int16x8_t zero = vdupq_n_s16(0);
+    const int16x8_t llrmax = vdupq_n_s16(LLR_MAX);
+
+    for (int j = 0; j < S; j += 8)
+    {
+        int16x8_t min1 = llrmax, min2 = llrmax, idx = zero, sgn = zero, par = zero;
+
+        for (int e = 0; e < degree; ++e)
+        {
+            int16_t *pt = &t[e * S + j];
+            int16x8_t l = vld1q_s16(pt);
+            par = veorq_s16(par, l);
+            int16x8_t v = vqsubq_s16(l, vld1q_s16(&r[e * S + j]));
+            vst1q_s16(pt, v);
+            sgn = veorq_s16(sgn, v);
+            int16x8_t a = vmaxq_s16(v, vqnegq_s16(v));
+            idx = vbslq_s16(vcltq_s16(a, min1), vdupq_n_s16(e), idx);
+            min2 = vminq_s16(min2, vmaxq_s16(min1, a));
+            min1 = vminq_s16(min1, a);
+        }
+
+        int16x8_t m1 = vsubq_s16(min1, vshrq_n_s16(min1, 2));
+        int16x8_t m2 = vsubq_s16(min2, vshrq_n_s16(min2, 2));
+
+        for (int e = 0; e < degree; ++e)
+        {
+            int16_t *pt = &t[e * S + j];
+            int16_t *pr = &r[e * S + j];
+            int16x8_t mag = vbslq_s16(vceqq_s16(idx, vdupq_n_s16(e)), m2, m1);
+            int16x8_t neg = vshrq_n_s16(veorq_s16(vld1q_s16(pt), sgn), 15);
+            int16x8_t rn = vsubq_s16(veorq_s16(mag, neg), neg);
+            vst1q_s16(pt, vqsubq_s16(rn, vld1q_s16(pr)));
+            vst1q_s16(pr, rn);
+        }
+
+        vst1q_s16(&syn[j], vorrq_s16(vld1q_s16(&syn[j]), par));
+    }
+}
+
+static void add_neon(int16_t *dst, const int16_t *src, int n)
+{
+    int i = 0;
+
+    for (; i + 8 <= n; i += 8)
+        vst1q_s16(&dst[i], vqaddq_s16(vld1q_s16(&dst[i]), vld1q_s16(&src[i])));
+
+    add_generic(dst + i, src + i, n - i);
+}
+#endif // LDPC_NEON
+
+// LDPC DECODER
+
+ldpc_minsum_decoder::ldpc_minsum_decoder(CPUFeatures::SIMDLevel _level)
+    : syn(ldpc_minsum_code::STRIDE)
+{
+    const CPUFeatures &cpu = CPUFeatures::instance();
+    (void)cpu;
+    layer = layer_generic;
+    add = add_generic;
+    level = CPUFeatures::SIMDGeneric;
+
+#if defined(LDPC_X86)
+    if (((_level == CPUFeatures::SIMDAVX2) || (_level == CPUFeatures::SIMDAVX512)) && cpu.hasAVX2())
+    {
+        layer = layer_avx2;
+        add = add_avx2;
+        level = CPUFeatures::SIMDAVX2;
+    }
+    else if ((_level >= CPUFeatures::SIMDSSE2) && (_level != CPUFeatures::SIMDNEON) && cpu.hasSSE2())
+    {
+        layer = layer_sse2;
+        add = add_sse2;
+        level = CPUFeatures::SIMDSSE2;
+    }
+#elif defined(LDPC_NEON)
+    if (((_level == CPUFeatures::SIMDNEON) || (_level == CPUFeatures::SIMDAVX512)) && cpu.hasNEON())
+    {
+        layer = layer_neon;
+        add = add_neon;
+        level = CPUFeatures::SIMDNEON;
+    }
+#else
+    (void)_level;
+#endif
+}
+
+int ldpc_minsum_decoder::decode(const ldpc_minsum_code *code, const int8_t *llrs,
+                                uint8_t *bits, int max_iterations)
+{
+    const int S = ldpc_minsum_code::STRIDE;
+    int k = code->k, q = code->q;
+
+    if ((int)l.size() < code->n)
+        l.resize(code->n);
+    if (r.size() < code->edges.size() * S)
+        r.resize(code->edges.size() * S);
+    if ((int)t.size() < code->max_degree * S)
+        t.resize(code->max_degree * S);
+
+    for (int i = 0; i < k; ++i)
+        l[i] = llrs[i] * LLR_SCALE;
+    for (int p = 0; p < q; ++p)
+        for (int j = 0; j < 360; ++j)
+            l[k + p * 360 + j] = llrs[k + p + j * q] * LLR_SCALE;
+    std::fill(r.begin(), r.begin() + code->edges.size() * S, 0);
+
+    for (int it = 1; it <= max_iterations; ++it)
+    {
+        std::fill(syn.begin(), syn.end(), 0);
+
+        for (int p = 0; p < q; ++p)
+        {
+            int e0 = code->layers[p];
+            int degree = code->layers[p + 1] - e0;
+            const ldpc_minsum_code::edge *edges = &code->edges[e0];
+
+            for (int e = 0; e < degree; ++e)
+            {
+                const int16_t *src = &l[edges[e].offset];
+                int16_t *dst = &t[e * S];
+                int shift = edges[e].shift;
+                memcpy(dst + shift, src, (360 - shift) * sizeof(int16_t));
+                memcpy(dst, src + 360 - shift, shift * sizeof(int16_t));
+            }
+
+            // Check 0 has no previous parity
+            if (p == 0)
+                t[(degree - 1) * S] = LLR_MAX;
+
+            layer(&t[0], &r[e0 * S], degree, &syn[0]);
+
+            for (int e = 0; e < degree; ++e)
+            {
+                int16_t *dst = &l[edges[e].offset];
+                const int16_t *src = &t[e * S];
+                int shift = edges[e].shift;
+                add(dst, src + shift, 360 - shift);
+                if (p != 0 || e != degree - 1)
+                    add(dst + 360 - shift, src, shift);
+            }
+        }
+
+        // Confirm on the hard decisions when no check failed during the iteration
+        bool satisfied = true;
+
+        for (int j = 0; j < 360; ++j)
+            satisfied = satisfied && (syn[j] >= 0);
+
+        if (satisfied)
+        {
+            harden(code, bits);
+            if (code->check(bits))
+                return it;
+        }
+    }
+
+    harden(code, bits);
+    return -1;
+}
+
+void ldpc_minsum_decoder::harden(const ldpc_minsum_code *code, uint8_t *bits)
+{
+    int k = code->k, q = code->q;
+
+    for (int i = 0; i < k; i += 8)
+    {
+        uint8_t byte = 0;
+        for (int b = 0; b < 8; ++b)
+            byte |= (l[i + b] < 0) << (7 - b);
+        bits[i / 8] = byte;
+    }
+
+    for (int p = 0; p < q; ++p)
+        for (int j = 0; j < 360; ++j)
+            set_bit(bits, k + p + j * q, l[k + p * 360 + j] < 0);
+}
+
+// LDPC DECODER POOL
+
+ldpc_minsum_pool::ldpc_minsum_pool(int _nworkers, int _max_iterations)
+    : nworkers(_nworkers),
+      max_iterations(_max_iterations),
+      head(0),
+      tail(0),
+      queued(0),
+      claimed(0),
+      stopping(false)
+{
+    // Two jobs per worker so that workers keep decoding while the oldest job is taken back
+    int njobs = nworkers ? 2 * nworkers : 1;
+
+    for (int i = 0; i < njobs; ++i)
+        jobs.push_back(new job);
+    for (int i = 0; i < nworkers; ++i)
+        threads.push_back(std::thread(&ldpc_minsum_pool::work, this));
+}
+
+ldpc_minsum_pool::~ldpc_minsum_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    wake.notify_all();
+
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+    for (size_t i = 0; i < jobs.size(); ++i)
+        delete jobs[i];
+}
+
+ldpc_minsum_pool::job *ldpc_minsum_pool::get_next()
+{
+    if (head - tail == jobs.size())
+        return NULL;
+
+    return jobs[head % jobs.size()];
+}
+
+void ldpc_minsum_pool::push()
+{
+    job *j = jobs[head % jobs.size()];
+    j->done.store(false, std::memory_order_relaxed);
+    ++head;
+
+    if (!nworkers)
+    {
+        j->iterations = inline_decoder.decode(j->code, j->llrs, j->bits, max_iterations);
+        j->done.store(true, std::memory_order_relaxed);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued = head;
+    }
+
+    wake.notify_one();
+}
+
+ldpc_minsum_pool::job *ldpc_minsum_pool::front()
+{
+    if (tail == head)
+        return NULL;
+
+    job *j = jobs[tail % jobs.size()];
+    return j->done.load(std::memory_order_acquire) ? j : NULL;
+}
+
+void ldpc_minsum_pool::pop()
+{
+    ++tail;
+}
+
+void ldpc_minsum_pool::work()
+{
+    ldpc_minsum_decoder decoder;
+
+    while (true)
+    {
+        job *j;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || (claimed < queued); });
+            if (stopping)
+                return;
+            j = jobs[claimed++ % jobs.size()];
+        }
+
+        j->iterations = decoder.decode(j->code, j->llrs, j->bits, max_iterations);
+        j->done.store(true, std::memory_order_release);
+    }
+}
+
+} // namespace leansdr
@@ -0,0 +1,149 @@
+// This file is part of LeanSDR Copyright (C) 2016-2018 <pabr@pabr.org>.
+// See the toplevel README for more information.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef LEANSDR_LDPC_MINSUM_H
+#define LEANSDR_LDPC_MINSUM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "leansdr/framework.h"
+#include "leansdr/sdr.h"
+#include "leansdr/softword.h"
+#include "leansdr/ldpc.h"
+
+#include "util/cpufeatures.h"
+
+namespace leansdr
+{
+
+// LAYERED NORMALIZED MIN-SUM LDPC DECODER
+// For the quasi-cyclic codes specified like in the DVB-S2 standard.
+//
+// Checks are processed in q layers of 360. Layer r holds the checks
+// r+j*q for j=0..359. The info bits of a table row connected to them
+// are a cyclic shift of the 360 bits of the row and the parity bits
+// (accumulator) are stored permuted so that parity r+j*q is at
+// k+r*360+j. The 360 check node updates of a layer are then computed
+// in parallel on contiguous lanes by SIMD kernels.
+
+struct ldpc_minsum_code
+{
+    static const int LANES = 360;
+    static const int STRIDE = 368; // LANES padded to 16 int16_t
+
+    // 360 bits at offset in the decoder layout.
+    // Lane j connects bit offset+(j-shift) mod 360.
+    struct edge
+    {
+        int offset;
+        int shift;
+    };
+
+    int k; // Message size in bits
+    int n; // Codeword size in bits
+    int q;
+    std::vector<int> layers;  // [q+1] First edge of each layer
+    std::vector<edge> edges;  // Info edges then current and previous parity
+    int max_degree;
+
+    ldpc_minsum_code(const ldpc_table<uint16_t> *table, int _n);
+
+    // Hard encoding and check, codewords packed MSB first
+    // (k message bits followed by n-k parity bits).
+    void encode(const uint8_t *msg, uint8_t *cw) const;
+    bool check(const uint8_t *cw) const;
+
+  private:
+    const ldpc_table<uint16_t> *table;
+};
+
+struct ldpc_minsum_decoder
+{
+    typedef void (*layer_kernel)(int16_t *t, int16_t *r, int degree, int16_t *syn);
+    typedef void (*add_kernel)(int16_t *dst, const int16_t *src, int n);
+
+    // Kernels for the best SIMD level of the host unless specified (benchmarks)
+    ldpc_minsum_decoder(CPUFeatures::SIMDLevel level = CPUFeatures::SIMDAVX512);
+
+    // llrs: n LLRs of the received codeword, log(p(0)/p(1)) as llr_t.
+    // bits: n/8 bytes of hard decisions, MSB first.
+    // Returns the number of iterations or -1 if the codeword is
+    // not valid after max_iterations.
+    int decode(const ldpc_minsum_code *code, const int8_t *llrs,
+               uint8_t *bits, int max_iterations);
+
+    CPUFeatures::SIMDLevel level;
+
+  private:
+    std::vector<int16_t> l;   // Bit LLRs in the decoder layout
+    std::vector<int16_t> r;   // Check to bit messages [edges][STRIDE]
+    std::vector<int16_t> t;   // Gathered LLRs of the layer [degree][STRIDE]
+    std::vector<int16_t> syn; // Parity of the gathered LLRs signs [STRIDE]
+    layer_kernel layer;
+    add_kernel add;
+
+    void harden(const ldpc_minsum_code *code, uint8_t *bits);
+};
+
+// LDPC DECODER POOL
+// Decodes several FEC frames in parallel, one per worker thread.
+// Jobs are filled and taken back by a single thread, in order.
+// With no worker threads push() decodes the frame immediately.
+
+struct ldpc_minsum_pool
+{
+    struct job
+    {
+        const ldpc_minsum_code *code;
+        int8_t llrs[64800];
+        uint8_t bits[64800 / 8];
+        int iterations; // Result of ldpc_minsum_decoder::decode
+        std::atomic<bool> done;
+    };
+
+    ldpc_minsum_pool(int _nworkers, int _max_iterations);
+    ~ldpc_minsum_pool();
+
+    job *get_next(); // Job to fill or NULL if all are in flight
+    void push();     // The job given by get_next is filled
+    job *front();    // Oldest job if decoded else NULL
+    void pop();      // Releases the job given by front
+
+    int nworkers;
+    int max_iterations;
+
+  private:
+    std::vector<job *> jobs;
+    unsigned long head;    // Next job to fill (producer only)
+    unsigned long tail;    // Oldest job in flight (producer only)
+    unsigned long queued;  // Jobs given to the workers (under mutex)
+    unsigned long claimed; // Next job to decode (under mutex)
+    bool stopping;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<std::thread> threads;
+    ldpc_minsum_decoder inline_decoder;
+
+    void work();
+};
+
+} // namespace leansdr
+
+#endif // LEANSDR_LDPC_MINSUM_H
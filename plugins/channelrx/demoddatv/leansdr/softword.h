@@ -64,7 +64,7 @@ inline void softwords_flip(hard_sb p[], int b)
 {
     p[b / 8] ^= 1 << (7 - (b & 7));
 }
-uint8_t *softbytes_harden(hard_sb p[], int nbytes, uint8_t storage[])
+inline uint8_t *softbytes_harden(hard_sb p[], int nbytes, uint8_t storage[])
 {
     return p;
 }
@@ -76,11 +76,11 @@ struct llr_sb
     llr_t bits[8]; // bits[0] is transmitted first.
 };
 
-float prob(llr_t l)
+inline float prob(llr_t l)
 {
     return (127.0 + l) / 254;
 }
-llr_t llr(float p)
+inline llr_t llr(float p)
 {
     int r = -127 + 254 * p;
     if (r < -127)
@@ -158,7 +158,7 @@ inline void softwords_flip(llr_sb p[], int b)
     llr_t *l = &p[b / 8].bits[b & 7];
     *l = -*l;
 }
-uint8_t *softbytes_harden(llr_sb p[], int nbytes, uint8_t storage[])
+inline uint8_t *softbytes_harden(llr_sb p[], int nbytes, uint8_t storage[])
 {
     for (uint8_t *q = storage; nbytes--; ++p, ++q)
         *q = softbyte_harden(*p);
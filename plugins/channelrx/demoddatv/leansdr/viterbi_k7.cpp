@@ -0,0 +1,473 @@
+#include "viterbi_k7.h"
+
+#include <string.h>
+
+#include "leansdr/framework.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define VITERBI_X86
+#define VITERBI_TARGET(arch) __attribute__((target(arch)))
+#elif defined(_MSC_VER) && (defined(_M_AMD64) || defined(_M_IX86))
+#include <immintrin.h>
+#define VITERBI_X86
+#define VITERBI_TARGET(arch)
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define VITERBI_NEON
+#endif
+
+namespace leansdr
+{
+
+// Weight of the coded bits of a noiseless block. Path metrics fit
+// in int16 whatever the constellation.
+static const int WEIGHT_UNIT = 32;
+static const int WEIGHT_MAX = 255;
+
+static inline int16_t sat16(int v)
+{
+    return v > 32767 ? 32767 : v < -32768 ? -32768 : v;
+}
+
+// Best and second best of the path metrics from per lane minimums.
+static inline int quality(const int16_t *min1, const int16_t *min2, int n, int16_t *best)
+{
+    int b = min1[0], b2 = min2[0];
+
+    for (int i = 1; i < n; ++i)
+    {
+        int m = min1[i] > b ? min1[i] : b;
+        b2 = min2[i] < b2 ? min2[i] : b2;
+        b2 = m < b2 ? m : b2;
+        b = min1[i] < b ? min1[i] : b;
+    }
+
+    *best = b;
+    return b2 - b;
+}
+
+// ADD-COMPARE-SELECT KERNELS
+// State s has the last 6 uncoded bits, newest in bit 5. Butterfly p
+// goes from states 2p and 2p+1 to states p (bit 0) and p+32 (bit 1).
+// All polynomials tap both ends of the register, so the branch metric
+// m of 2p->p is also that of 2p+1->p+32 and the two other branches
+// have the complementary metric W-m. Decision bit t of a step is set
+// when new state t comes from the odd predecessor.
+
+static int acs_generic(int16_t *pm, int nsteps, const int16_t *const *units,
+                       const int *ncoded, int16_t weight, uint64_t *decisions)
+{
+    int16_t npm[viterbi_k7_dec::NSTATES];
+
+    for (int s = 0; s < nsteps; ++s)
+    {
+        const int16_t *u = units[s];
+        int16_t W = ncoded[s] * weight;
+        uint64_t d = 0;
+
+        for (int p = 0; p < 32; ++p)
+        {
+            int16_t m = u[p] * weight;
+            int16_t c = W - m;
+            int16_t a0 = sat16(pm[2 * p] + m), b0 = sat16(pm[2 * p + 1] + c);
+            int16_t a1 = sat16(pm[2 * p] + c), b1 = sat16(pm[2 * p + 1] + m);
+            npm[p] = b0 < a0 ? b0 : a0;
+            npm[p + 32] = b1 < a1 ? b1 : a1;
+            d |= (uint64_t)(b0 < a0) << p;
+            d |= (uint64_t)(b1 < a1) << (p + 32);
+        }
+
+        memcpy(pm, npm, sizeof(npm));
+        decisions[s] = d;
+    }
+
+    int b = pm[0], b2 = 32767;
+
+    for (int i = 1; i < viterbi_k7_dec::NSTATES; ++i)
+    {
+        if (pm[i] < b)
+        {
+            b2 = b;
+            b = pm[i];
+        }
+        else if (pm[i] < b2)
+            b2 = pm[i];
+    }
+
+    for (int i = 0; i < viterbi_k7_dec::NSTATES; ++i)
+        pm[i] -= b;
+
+    return b2 - b;
+}
+
+#if defined(VITERBI_X86)
+VITERBI_TARGET("sse2")
+static int acs_sse2(int16_t *pm, int nsteps, const int16_t *const *units,
+                    const int *ncoded, int16_t weight, uint64_t *decisions)
+{
+    __m128i v[8];
+    const __m128i w = _mm_set1_epi16(weight);
+
+    for (int i = 0; i < 8; ++i)
+        v[i] = _mm_loadu_si128((const __m128i *)&pm[i * 8]);
+
+    for (int s = 0; s < nsteps; ++s)
+    {
+        const int16_t *u = units[s];
+        const __m128i W = _mm_set1_epi16(ncoded[s] * weight);
+        __m128i nv[8];
+        uint64_t d = 0;
+
+        for (int q = 0; q < 4; ++q)
+        {
+            // Even and odd predecessors of butterflies 8q..8q+7
+            __m128i e = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(v[2 * q], 16), 16),
+                                        _mm_srai_epi32(_mm_slli_epi32(v[2 * q + 1], 16), 16));
+            __m128i o = _mm_packs_epi32(_mm_srai_epi32(v[2 * q], 16),
+                                        _mm_srai_epi32(v[2 * q + 1], 16));
+            __m128i m = _mm_mullo_epi16(_mm_loadu_si128((const __m128i *)&u[q * 8]), w);
+            __m128i c = _mm_sub_epi16(W, m);
+            __m128i a0 = _mm_adds_epi16(e, m), b0 = _mm_adds_epi16(o, c);
+            __m128i a1 = _mm_adds_epi16(e, c), b1 = _mm_adds_epi16(o, m);
+            nv[q] = _mm_min_epi16(a0, b0);
+            nv[q + 4] = _mm_min_epi16(a1, b1);
+            int mask = _mm_movemask_epi8(_mm_packs_epi16(_mm_cmpgt_epi16(a0, b0), _mm_cmpgt_epi16(a1, b1)));
+            d |= (uint64_t)(mask & 0xff) << (q * 8);
+            d |= (uint64_t)(mask >> 8) << (32 + q * 8);
+        }
+
+        for (int i = 0; i < 8; ++i)
+            v[i] = nv[i];
+
+        decisions[s] = d;
+    }
+
+    __m128i min1 = v[0], min2 = _mm_set1_epi16(32767);
+
+    for (int i = 1; i < 8; ++i)
+    {
+        min2 = _mm_min_epi16(min2, _mm_max_epi16(min1, v[i]));
+        min1 = _mm_min_epi16(min1, v[i]);
+    }
+
+    int16_t m1[8], m2[8], best;
+    _mm_storeu_si128((__m128i *)m1, min1);
+    _mm_storeu_si128((__m128i *)m2, min2);
+    int q = quality(m1, m2, 8, &best);
+    const __m128i b = _mm_set1_epi16(best);
+
+    for (int i = 0; i < 8; ++i)
+        _mm_storeu_si128((__m128i *)&pm[i * 8], _mm_sub_epi16(v[i], b));
+
+    return q;
+}
+
+VITERBI_TARGET("avx2")
+static int acs_avx2(int16_t *pm, int nsteps, const int16_t *const *units,
+                    const int *ncoded, int16_t weight, uint64_t *decisions)
+{
+    __m256i v[4];
+    const __m256i w = _mm256_set1_epi16(weight);
+
+    for (int i = 0; i < 4; ++i)
+        v[i] = _mm256_loadu_si256((const __m256i *)&pm[i * 16]);
+
+    for (int s = 0; s < nsteps; ++s)
+    {
+        const int16_t *u = units[s];
+        const __m256i W = _mm256_set1_epi16(ncoded[s] * weight);
+        __m256i nv[4];
+        uint64_t d = 0;
+
+        for (int q = 0; q < 2; ++q)
+        {
+            // Even and odd predecessors of butterflies 16q..16q+15,
+            // packs works within 128 bits lanes.
+            __m256i e = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_slli_epi32(v[2 * q], 16), 16),
+                                           _mm256_srai_epi32(_mm256_slli_epi32(v[2 * q + 1], 16), 16));
+            __m256i o = _mm256_packs_epi32(_mm256_srai_epi32(v[2 * q], 16),
+                                           _mm256_srai_epi32(v[2 * q + 1], 16));
+            e = _mm256_permute4x64_epi64(e, 0xd8);
+            o = _mm256_permute4x64_epi64(o, 0xd8);
+            __m256i m = _mm256_mullo_epi16(_mm256_loadu_si256((const __m256i *)&u[q * 16]), w);
+            __m256i c = _mm256_sub_epi16(W, m);
+            __m256i a0 = _mm256_adds_epi16(e, m), b0 = _mm256_adds_epi16(o, c);
+            __m256i a1 = _mm256_adds_epi16(e, c), b1 = _mm256_adds_epi16(o, m);
+            nv[q] = _mm256_min_epi16(a0, b0);
+            nv[q + 2] = _mm256_min_epi16(a1, b1);
+            __m256i dd = _mm256_packs_epi16(_mm256_cmpgt_epi16(a0, b0), _mm256_cmpgt_epi16(a1, b1));
+            uint32_t mask = _mm256_movemask_epi8(_mm256_permute4x64_epi64(dd, 0xd8));
+            d |= (uint64_t)(mask & 0xffff) << (q * 16);
+            d |= (uint64_t)(mask >> 16) << (32 + q * 16);
+        }
+
+        for (int i = 0; i < 4; ++i)
+            v[i] = nv[i];
+
+        decisions[s] = d;
+    }
+
+    __m256i min1 = v[0], min2 = _mm256_set1_epi16(32767);
+
+    for (int i = 1; i < 4; ++i)
+    {
+        min2 = _mm256_min_epi16(min2, _mm256_max_epi16(min1, v[i]));
+        min1 = _mm256_min_epi16(min1, v[i]);
+    }
+
+    int16_t m1[16], m2[16], best;
+    _mm256_storeu_si256((__m256i *)m1, min1);
+    _mm256_storeu_si256((__m256i *)m2, min2);
+    int q = quality(m1, m2, 16, &best);
+    const __m256i b = _mm256_set1_epi16(best);
+
+    for (int i = 0; i < 4; ++i)
+        _mm256_storeu_si256((__m256i *)&pm[i * 16], _mm256_sub_epi16(v[i], b));
+
+    return q;
+}
+#endif // VITERBI_X86
+
+#if defined(VITERBI_NEON)
+static int acs_neon(int16_t *pm, int nsteps, const int16_t *const *units,
+                    const int *ncoded, int16_t weight, uint64_t *decisions)
+{
+    static const uint8_t bitmask[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const uint8x16_t bm = vld1q_u8(bitmask);
+    int16x8_t v[8];
+
+    for (int i = 0; i < 8; ++i)
+        v[i] = vld1q_s16(&pm[i * 8]);
+
+    for (int s = 0; s < nsteps; ++s)
+    {
+        const int16_t *u = units[s];
+        const int16x8_t W = vdupq_n_s16(ncoded[s] * weight);
+        int16x8_t nv[8];
+        uint64_t d = 0;
+
+        for (int q = 0; q < 4; ++q)
+        {
+            int16x8x2_t eo = vuzpq_s16(v[2 * q], v[2 * q + 1]);
+            int16x8_t m = vmulq_n_s16(vld1q_s16(&u[q * 8]), weight);
+            int16x8_t c = vsubq_s16(W, m);
+            int16x8_t a0 = vqaddq_s16(eo.val[0], m), b0 = vqaddq_s16(eo.val[1], c);
+            int16x8_t a1 = vqaddq_s16(eo.val[0], c), b1 = vqaddq_s16(eo.val[1], m);
+            nv[q] = vminq_s16(a0, b0);
+            nv[q + 4] = vminq_s16(a1, b1);
+            uint8x16_t dd = vandq_u8(vcombine_u8(vmovn_u16(vcltq_s16(b0, a0)), vmovn_u16(vcltq_s16(b1, a1))), bm);
+            uint8x8_t x = vpadd_u8(vget_low_u8(dd), vget_high_u8(dd));
+            x = vpadd_u8(x, x);
+            x = vpadd_u8(x, x);
+            d |= (uint64_t)vget_lane_u8(x, 0) << (q * 8);
+            d |= (uint64_t)vget_lane_u8(x, 1) << (32 + q * 8);
+        }
+
+        for (int i = 0; i < 8; ++i)
+            v[i] = nv[i];
+
+        decisions[s] = d;
+    }
+
+    int16x8_t min1 = v[0], min2 = vdupq_n_s16(32767);
+
+    for (int i = 1; i < 8; ++i)
+    {
+        min2 = vminq_s16(min2, vmaxq_s16(min1, v[i]));
+        min1 = vminq_s16(min1, v[i]);
+    }
+
+    int16_t m1[8], m2[8], best;
+    vst1q_s16(m1, min1);
+    vst1q_s16(m2, min2);
+    int q = quality(m1, m2, 8, &best);
+    const int16x8_t b = vdupq_n_s16(best);
+
+    for (int i = 0; i < 8; ++i)
+        vst1q_s16(&pm[i * 8], vsubq_s16(v[i], b));
+
+    return q;
+}
+#endif // VITERBI_NEON
+
+// DECODER
+
+viterbi_k7_dec::viterbi_k7_dec(int _bits_in, int _bits_out, const uint16_t *polys, TBM _unit_cost,
+                               CPUFeatures::SIMDLevel _level)
+    : bits_in(_bits_in), bits_out(_bits_out), unit_cost(_unit_cost),
+      pm(NSTATES, 0), ncoded(_bits_in, 0),
+      steps(0), decoded(DELAY), popped(0)
+{
+    if (bits_in < 1 || bits_in > 8 || bits_out < bits_in || bits_out > 8)
+        fail("Unsupported code rate");
+
+    if (unit_cost <= 0)
+        fail("Invalid unit cost");
+
+    // Coded bits of each step, as positions in the coded symbol
+    std::vector<std::vector<int>> coded(bits_in);
+    std::vector<std::vector<int>> bases(bits_in);
+
+    for (int g = 0; g < bits_out; ++g)
+    {
+        int j = 0;
+
+        while (j < bits_in && !((polys[g] >> j) & 1))
+            ++j;
+
+        int base = polys[g] >> j;
+
+        if (j == bits_in || base >= 128 || !(base & 64))
+            fail("Unsupported convolutional code");
+
+        coded[j].push_back(bits_out - 1 - g);
+        bases[j].push_back(base);
+        ncoded[j]++;
+    }
+
+    // Unit metrics of the butterflies for each step and received bits
+    std::vector<int> offsets(bits_in);
+
+    for (int j = 0; j < bits_in; ++j)
+    {
+        offsets[j] = lut.size();
+
+        for (int r = 0; r < (1 << ncoded[j]); ++r)
+        {
+            for (int p = 0; p < 32; ++p)
+            {
+                int m = 0;
+
+                for (int c = 0; c < ncoded[j]; ++c)
+                    m += parity((uint8_t)(2 * p & bases[j][c])) != ((r >> c) & 1);
+
+                lut.push_back(m);
+            }
+        }
+    }
+
+    units.resize((1 << bits_out) * bits_in);
+
+    for (int cs = 0; cs < (1 << bits_out); ++cs)
+    {
+        for (int j = 0; j < bits_in; ++j)
+        {
+            int r = 0;
+
+            for (int c = 0; c < ncoded[j]; ++c)
+                r |= ((cs >> coded[j][c]) & 1) << c;
+
+            units[cs * bits_in + j] = offsets[j] + r * 32;
+        }
+    }
+
+    memset(decisions, 0, sizeof(decisions));
+    memset(bits, 0, sizeof(bits));
+
+    const CPUFeatures &cpu = CPUFeatures::instance();
+    (void)cpu;
+    acs = acs_generic;
+    level = CPUFeatures::SIMDGeneric;
+
+#if defined(VITERBI_X86)
+    if (((_level == CPUFeatures::SIMDAVX2) || (_level == CPUFeatures::SIMDAVX512)) && cpu.hasAVX2())
+    {
+        acs = acs_avx2;
+        level = CPUFeatures::SIMDAVX2;
+    }
+    else if ((_level >= CPUFeatures::SIMDSSE2) && (_level != CPUFeatures::SIMDNEON) && cpu.hasSSE2())
+    {
+        acs = acs_sse2;
+        level = CPUFeatures::SIMDSSE2;
+    }
+#elif defined(VITERBI_NEON)
+    if (((_level == CPUFeatures::SIMDNEON) || (_level == CPUFeatures::SIMDAVX512)) && cpu.hasNEON())
+    {
+        acs = acs_neon;
+        level = CPUFeatures::SIMDNEON;
+    }
+#else
+    (void)_level;
+#endif
+}
+
+viterbi_k7_dec::TUS viterbi_k7_dec::update(TBM *costs, TPM *quality)
+{
+    int ncs = 1 << bits_out;
+    int best = 0, best2 = -1;
+
+    for (int cs = 1; cs < ncs; ++cs)
+    {
+        if (costs[cs] < costs[best])
+        {
+            best2 = best;
+            best = cs;
+        }
+        else if (best2 < 0 || costs[cs] < costs[best2])
+            best2 = cs;
+    }
+
+    return update_block(best, costs[best2] - costs[best], quality);
+}
+
+viterbi_k7_dec::TUS viterbi_k7_dec::update(TCS cs, TBM cost, TPM *quality)
+{
+    return update_block(cs, -cost, quality);
+}
+
+viterbi_k7_dec::TUS viterbi_k7_dec::update_block(TCS cs, TBM reliability, TPM *quality)
+{
+    int64_t weight = ((int64_t)reliability * WEIGHT_UNIT + unit_cost / 2) / unit_cost;
+
+    if (weight > WEIGHT_MAX)
+        weight = WEIGHT_MAX;
+
+    const int16_t *u[8];
+    uint64_t d[8];
+
+    for (int j = 0; j < bits_in; ++j)
+        u[j] = &lut[units[cs * bits_in + j]];
+
+    int q = acs(pm.data(), bits_in, u, ncoded.data(), weight, d);
+
+    for (int j = 0; j < bits_in; ++j, ++steps)
+        decisions[steps % HISTORY] = d[j];
+
+    if (quality)
+        *quality = q;
+
+    if (decoded < steps)
+        traceback();
+
+    TUS us = 0;
+
+    for (int j = 0; j < bits_in; ++j, ++popped)
+        us = (us << 1) | bits[popped % HISTORY];
+
+    return us;
+}
+
+void viterbi_k7_dec::traceback()
+{
+    // Path metrics are normalized: the best state is at 0.
+    int t = 0;
+
+    while (pm[t])
+        ++t;
+
+    unsigned long end = steps - TRACEBACK;
+    unsigned long start = decoded - DELAY;
+
+    for (unsigned long i = steps; i-- > start;)
+    {
+        if (i < end)
+            bits[(i + DELAY) % HISTORY] = t >> 5;
+
+        t = ((t << 1) & 63) | ((decisions[i % HISTORY] >> t) & 1);
+    }
+
+    decoded = end + DELAY;
+}
+
+} // namespace leansdr
@@ -0,0 +1,97 @@
+// This file is part of LeanSDR Copyright (C) 2016-2018 <pabr@pabr.org>.
+// See the toplevel README for more information.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef LEANSDR_VITERBI_K7_H
+#define LEANSDR_VITERBI_K7_H
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "leansdr/math.h"
+#include "leansdr/viterbi.h"
+
+#include "util/cpufeatures.h"
+
+namespace leansdr
+{
+
+// VITERBI DECODER FOR PUNCTURED K=7 CODES
+// Runs the 64 states rate 1/2 trellis one uncoded bit at a time
+// instead of expanding it for each code rate. Punctured coded bits
+// simply do not contribute to the branch metrics. The add-compare-select
+// of the 32 butterflies is computed in parallel on int16 path metrics
+// by SIMD kernels and the survivors are recovered by traceback of the
+// decision bits.
+//
+// Branch metrics are the Hamming distances between the received and
+// expected coded bits, weighted by the reliability of the received FEC
+// block relative to unit_cost, the reliability of a noiseless block.
+// The uncoded symbols are returned with a constant delay of DELAY bits.
+
+struct viterbi_k7_dec : viterbi_dec_interface<uint8_t, uint8_t, int32_t, int32_t>
+{
+    typedef uint8_t TUS, TCS;
+    typedef int32_t TBM, TPM;
+
+    static const int NSTATES = 64;
+    static const int TRACEBACK = 96; // Depth of survivor merging, in bits
+    static const int CHUNK = 64;     // Bits decoded per traceback
+    static const int DELAY = TRACEBACK + CHUNK;
+
+    // Returns the quality after the update of the path metrics
+    // and writes the decisions of each step.
+    typedef int (*acs_kernel)(int16_t *pm, int nsteps,
+                              const int16_t *const *units, const int *ncoded,
+                              int16_t weight, uint64_t *decisions);
+
+    // polys: [bits_out] as in fec_spec. Polynomial g applies to the
+    // 7 bits from uncoded bit ctz(g) of the block, MSB is newest.
+    // All base polynomials must tap the oldest and newest bits.
+    viterbi_k7_dec(int _bits_in, int _bits_out, const uint16_t *polys, TBM _unit_cost,
+                   CPUFeatures::SIMDLevel level = CPUFeatures::SIMDAVX512);
+
+    // Full metric: the best label is used with the margin to the
+    // second best as reliability.
+    TUS update(TBM *costs, TPM *quality = NULL);
+    // Single symbol metric as in viterbi_dec. cost must be negative.
+    TUS update(TCS cs, TBM cost, TPM *quality = NULL);
+
+    int bits_in, bits_out;
+    TBM unit_cost;
+    CPUFeatures::SIMDLevel level;
+
+  private:
+    static const int HISTORY = 256; // Ring buffers of decisions and decoded bits
+
+    std::vector<int16_t> pm;  // [NSTATES] Path metrics, natural order
+    std::vector<int16_t> lut; // Unit branch metrics of the 32 butterflies per step and received bits
+    std::vector<int> units;   // [1<<bits_out][bits_in] Offsets in lut for each coded symbol
+    std::vector<int> ncoded;  // [bits_in] Coded bits of each step
+    uint64_t decisions[HISTORY];
+    uint8_t bits[HISTORY];
+    unsigned long steps;   // Uncoded bits received
+    unsigned long decoded; // Uncoded bits known, including DELAY leading zeros
+    unsigned long popped;  // Uncoded bits returned
+    acs_kernel acs;
+
+    TUS update_block(TCS cs, TBM reliability, TPM *quality);
+    void traceback();
+};
+
+} // namespace leansdr
+
+#endif // LEANSDR_VITERBI_K7_H
@@ -91,6 +91,12 @@ void DSDDemod::feed(const SampleVector::const_iterator& begin, const SampleVecto
     m_basebandSink->feed(begin, end);
 }
 
+void DSDDemod::feedBlock(const SampleBlockRef& block, bool positiveOnly)
+{
+    (void) positiveOnly;
+    m_basebandSink->feedBlock(block);
+}
+
 void DSDDemod::start()
 {
     qDebug() << "DSDDemod::start";
@@ -133,6 +139,16 @@ bool DSDDemod::handleMessage(const Message& cmd)
         m_basebandSink->getInputMessageQueue()->push(rep);
 
 	    return true;
+    }
+    else if (DSPSubbandNotification::match(cmd))
+    {
+        // m_basebandSampleRate stays the device baseband rate
+        DSPSubbandNotification& notif = (DSPSubbandNotification&) cmd;
+        DSPSubbandNotification* rep = new DSPSubbandNotification(notif); // make a copy
+        qDebug() << "DSDDemod::handleMessage: DSPSubbandNotification";
+        m_basebandSink->getInputMessageQueue()->push(rep);
+
+        return true;
     }
 	else
 	{
@@ -166,6 +182,16 @@ void DSDDemod::applySettings(const DSDDemodSettings& settings, bool force)
             << " m_streamIndex: " << settings.m_streamIndex
             << " force: " << force;
 
+    if ((settings.m_inputFrequencyOffset != m_settings.m_inputFrequencyOffset)
+     || (settings.m_rfBandwidth != m_settings.m_rfBandwidth)
+     || (settings.m_audioDeviceName != m_settings.m_audioDeviceName) || force)
+    {
+        // the channel is decimated down to the audio rate so the sub-band cannot be slower
+        AudioDeviceManager *audioDeviceManager = DSPEngine::instance()->getAudioDeviceManager();
+        int audioSampleRate = audioDeviceManager->getOutputSampleRate(audioDeviceManager->getOutputDeviceIndex(settings.m_audioDeviceName));
+        m_deviceAPI->configureSubbandRequest(this, settings.m_inputFrequencyOffset, (int) settings.m_rfBandwidth, audioSampleRate);
+    }
+
     QList<QString> reverseAPIKeys;
 
     if ((settings.m_inputFrequencyOffset != m_settings.m_inputFrequencyOffset) || force) {
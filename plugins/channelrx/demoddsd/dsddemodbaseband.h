@@ -21,7 +21,7 @@
 #include <QObject>
 #include <QMutex>
 
-#include "dsp/samplesinkfifo.h"
+#include "dsp/sampleblockfifo.h"
 #include "util/message.h"
 #include "util/messagequeue.h"
 
@@ -60,6 +60,7 @@ public:
     ~DSDDemodBaseband();
     void reset();
     void feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end);
+    void feedBlock(const SampleBlockRef& block); //!< keeps a reference to the block instead of copying samples
     MessageQueue *getInputMessageQueue() { return &m_inputMessageQueue; } //!< Get the queue for asynchronous inbound communication
     int getChannelSampleRate() const;
     int getAudioSampleRate() const { return m_sink.getAudioSampleRate(); }
@@ -73,11 +74,13 @@ public:
     const char *updateAndGetStatusText() { return m_sink.updateAndGetStatusText(); }
 
 private:
-    SampleSinkFifo m_sampleFifo;
+    SampleBlockFifo m_sampleFifo;
+    SampleBlockPool *m_blockPool; //!< holds samples not fed as a shared block
     DownChannelizer *m_channelizer;
     DSDDemodSink m_sink;
 	MessageQueue m_inputMessageQueue; //!< Queue for asynchronous inbound communication
     DSDDemodSettings m_settings;
+    qint64 m_subbandFrequencyOffset; //!< center of the input when fed by the device shared channelizer
     QMutex m_mutex;
 
     bool handleMessage(const Message& cmd);
@@ -164,9 +164,8 @@ FreeDVDemodSink::FreeDVDemodSink() :
     m_simpleAGC.resizeNew(m_modemSampleRate/10, 0.003);
 
 	SSBFilter = new fftfilt(m_lowCutoff / m_modemSampleRate, m_hiCutoff / m_modemSampleRate, m_ssbFftLen);
-    m_SSBFilterBuffer = new fftfilt::cmplx[m_ssbFftLen];
-    std::fill(m_SSBFilterBuffer, m_SSBFilterBuffer + m_ssbFftLen, fftfilt::cmplx{0.0f, 0.0f});
-    m_SSBFilterBufferIndex = 0;
+    // the filtered samples are demodulated one block late so that there is one for each input sample
+    m_SSBFilterBuffer.assign(SSBFilter->getBlockSize(), fftfilt::cmplx{0.0f, 0.0f});
 
     applyChannelSettings(m_channelSampleRate, m_channelFrequencyOffset, true);
 	applySettings(m_settings, true);
@@ -175,7 +174,6 @@ FreeDVDemodSink::FreeDVDemodSink() :
 FreeDVDemodSink::~FreeDVDemodSink()
 {
     delete SSBFilter;
-    delete[] m_SSBFilterBuffer;
 }
 
 void FreeDVDemodSink::feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end)
@@ -185,11 +183,7 @@ void FreeDVDemodSink::feed(const SampleVector::const_iterator& begin, const Samp
     }
 
 	Complex ci;
-	fftfilt::cmplx *sideband;
-	int n_out;
-
-	int decim = 1<<(m_spanLog2 - 1);
-	unsigned char decim_mask = decim - 1; // counter LSB bit mask for decimation by 2^(m_scaleLog2 - 1)
+	m_SSBFilterIn.clear();
 
 	for(SampleVector::const_iterator it = begin; it < end; ++it)
 	{
@@ -200,7 +194,7 @@ void FreeDVDemodSink::feed(const SampleVector::const_iterator& begin, const Samp
         {
             while (!m_interpolator.interpolate(&m_interpolatorDistanceRemain, c, &ci))
             {
-                processOneSample(ci);
+                m_SSBFilterIn.push_back(ci);
                 m_interpolatorDistanceRemain += m_interpolatorDistance;
             }
         }
@@ -208,12 +202,14 @@ void FreeDVDemodSink::feed(const SampleVector::const_iterator& begin, const Samp
         {
             if (m_interpolator.decimate(&m_interpolatorDistanceRemain, c, &ci))
             {
-                processOneSample(ci);
+                m_SSBFilterIn.push_back(ci);
                 m_interpolatorDistanceRemain += m_interpolatorDistance;
             }
         }
 	}
 
+	processSamples();
+
 	uint res = m_audioFifo.write((const quint8*)&m_audioBuffer[0], m_audioBufferFill);
 
 	if (res != m_audioBufferFill)
@@ -231,14 +227,27 @@ void FreeDVDemodSink::feed(const SampleVector::const_iterator& begin, const Samp
 	m_sampleBuffer.clear();
 }
 
-void FreeDVDemodSink::processOneSample(Complex &ci)
+void FreeDVDemodSink::processSamples()
+{
+    // the block filter gives the same blocks as the per sample filter
+    std::size_t pending = m_SSBFilterBuffer.size();
+    m_SSBFilterBuffer.resize(pending + m_SSBFilterIn.size() + SSBFilter->getBlockSize());
+    int n_out = SSBFilter->runSSB(m_SSBFilterIn.data(), m_SSBFilterIn.size(), &m_SSBFilterBuffer[pending], true); // always USB side
+    m_SSBFilterBuffer.resize(pending + n_out);
+
+    for (std::size_t i = 0; i < m_SSBFilterIn.size(); i++) {
+        processOneSample(m_SSBFilterBuffer[i]);
+    }
+
+    m_SSBFilterBuffer.erase(m_SSBFilterBuffer.begin(), m_SSBFilterBuffer.begin() + m_SSBFilterIn.size());
+}
+
+void FreeDVDemodSink::processOneSample(const fftfilt::cmplx& z)
 {
-	fftfilt::cmplx *sideband;
-	int n_out = 0;
 	int decim = 1<<(m_spanLog2 - 1);
 	unsigned char decim_mask = decim - 1; // counter LSB bit mask for decimation by 2^(m_scaleLog2 - 1)
 
-    m_sum += m_SSBFilterBuffer[m_SSBFilterBufferIndex];
+    m_sum += z;
 
     if (!(m_undersampleCount++ & decim_mask))
     {
@@ -259,9 +268,8 @@ void FreeDVDemodSink::processOneSample(Complex &ci)
         m_sum.imag(0.0);
     }
 
-    fftfilt::cmplx z = m_SSBFilterBuffer[m_SSBFilterBufferIndex];
     Real demod = (z.real() + z.imag()) * 0.7;
-    // Real demod = m_SSBFilterBuffer[m_SSBFilterBufferIndex].real(); // works as good
+    // Real demod = z.real(); // works as good
 
     if (m_agcActive)
     {
@@ -274,17 +282,6 @@ void FreeDVDemodSink::processOneSample(Complex &ci)
     }
 
     pushSampleToDV((qint16) demod);
-    n_out = SSBFilter->runSSB(ci, &sideband, true); // always USB side
-
-    if (n_out > 0)
-    {
-        std::copy(sideband, sideband + n_out, m_SSBFilterBuffer);
-        m_SSBFilterBufferIndex = 0;
-    }
-    else if (m_SSBFilterBufferIndex < m_ssbFftLen - 1)
-    {
-        m_SSBFilterBufferIndex++;
-    }
 }
 
 void FreeDVDemodSink::pushSampleToDV(int16_t sample)
@@ -173,8 +173,8 @@ private:
     Real m_interpolatorDistance;
     Real m_interpolatorDistanceRemain;
 	fftfilt* SSBFilter;
-    fftfilt::cmplx* m_SSBFilterBuffer;
-    unsigned int m_SSBFilterBufferIndex;
+    std::vector<fftfilt::cmplx> m_SSBFilterIn;     //!< modem rate samples collected by feed
+    std::vector<fftfilt::cmplx> m_SSBFilterBuffer; //!< filtered samples not demodulated yet
 
 	BasebandSampleSink* m_spectrumSink;
 	SampleVector m_sampleBuffer;
@@ -204,7 +204,8 @@ private:
 
 	void pushSampleToDV(int16_t sample);
 	void pushSampleToAudio(int16_t sample);
-    void processOneSample(Complex &ci);
+    void processSamples(); //!< filters the samples collected by feed as a whole and demodulates them
+    void processOneSample(const fftfilt::cmplx& z);
     void calculateLevel(int16_t& sample);
 };
 
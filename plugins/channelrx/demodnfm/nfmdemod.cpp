@@ -90,6 +90,12 @@ void NFMDemod::feed(const SampleVector::const_iterator& begin, const SampleVecto
     m_basebandSink->feed(begin, end);
 }
 
+void NFMDemod::feedBlock(const SampleBlockRef& block, bool positiveOnly)
+{
+    (void) positiveOnly;
+    m_basebandSink->feedBlock(block);
+}
+
 void NFMDemod::start()
 {
     qDebug() << "NFMDemod::start";
@@ -131,6 +137,16 @@ bool NFMDemod::handleMessage(const Message& cmd)
 
 	    return true;
 	}
+    else if (DSPSubbandNotification::match(cmd))
+    {
+        // m_basebandSampleRate stays the device baseband rate
+        DSPSubbandNotification& notif = (DSPSubbandNotification&) cmd;
+        DSPSubbandNotification* rep = new DSPSubbandNotification(notif); // make a copy
+        qDebug() << "NFMDemod::handleMessage: DSPSubbandNotification";
+        m_basebandSink->getInputMessageQueue()->push(rep);
+
+        return true;
+    }
 	else
 	{
 		return false;
@@ -161,6 +177,16 @@ void NFMDemod::applySettings(const NFMDemodSettings& settings, bool force)
             << " m_reverseAPIChannelIndex: " << settings.m_reverseAPIChannelIndex
             << " force: " << force;
 
+    if ((settings.m_inputFrequencyOffset != m_settings.m_inputFrequencyOffset)
+     || (settings.m_rfBandwidth != m_settings.m_rfBandwidth)
+     || (settings.m_audioDeviceName != m_settings.m_audioDeviceName) || force)
+    {
+        // the channel is decimated down to the audio rate so the sub-band cannot be slower
+        AudioDeviceManager *audioDeviceManager = DSPEngine::instance()->getAudioDeviceManager();
+        int audioSampleRate = audioDeviceManager->getOutputSampleRate(audioDeviceManager->getOutputDeviceIndex(settings.m_audioDeviceName));
+        m_deviceAPI->configureSubbandRequest(this, settings.m_inputFrequencyOffset, (int) settings.m_rfBandwidth, audioSampleRate);
+    }
+
     QList<QString> reverseAPIKeys;
 
     if ((settings.m_inputFrequencyOffset != m_settings.m_inputFrequencyOffset) || force) {
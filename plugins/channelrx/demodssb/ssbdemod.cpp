@@ -19,6 +19,8 @@
 
 
 #include <stdio.h>
+#include <cmath>
+#include <algorithm>
 
 #include <QTime>
 #include <QDebug>
@@ -90,6 +92,12 @@ void SSBDemod::feed(const SampleVector::const_iterator& begin, const SampleVecto
     m_basebandSink->feed(begin, end);
 }
 
+void SSBDemod::feedBlock(const SampleBlockRef& block, bool positiveOnly)
+{
+    (void) positiveOnly;
+    m_basebandSink->feedBlock(block);
+}
+
 void SSBDemod::start()
 {
     qDebug() << "SSBDemod::start";
@@ -131,6 +139,16 @@ bool SSBDemod::handleMessage(const Message& cmd)
 
         return true;
     }
+    else if (DSPSubbandNotification::match(cmd))
+    {
+        // m_basebandSampleRate stays the device baseband rate
+        DSPSubbandNotification& notif = (DSPSubbandNotification&) cmd;
+        DSPSubbandNotification* rep = new DSPSubbandNotification(notif); // make a copy
+        qDebug() << "SSBDemod::handleMessage: DSPSubbandNotification";
+        m_basebandSink->getInputMessageQueue()->push(rep);
+
+        return true;
+    }
 	else
 	{
 		return false;
@@ -163,6 +181,19 @@ void SSBDemod::applySettings(const SSBDemodSettings& settings, bool force)
             << " m_reverseAPIChannelIndex: " << settings.m_reverseAPIChannelIndex
             << " force: " << force;
 
+    if ((settings.m_inputFrequencyOffset != m_settings.m_inputFrequencyOffset)
+     || (settings.m_rfBandwidth != m_settings.m_rfBandwidth)
+     || (settings.m_lowCutoff != m_settings.m_lowCutoff)
+     || (settings.m_audioDeviceName != m_settings.m_audioDeviceName) || force)
+    {
+        // sidebands are on either side of the carrier
+        int bandwidth = 2 * (int) std::max(std::fabs(settings.m_rfBandwidth), std::fabs(settings.m_lowCutoff));
+        // the channel is decimated down to the audio rate so the sub-band cannot be slower
+        AudioDeviceManager *audioDeviceManager = DSPEngine::instance()->getAudioDeviceManager();
+        int audioSampleRate = audioDeviceManager->getOutputSampleRate(audioDeviceManager->getOutputDeviceIndex(settings.m_audioDeviceName));
+        m_deviceAPI->configureSubbandRequest(this, settings.m_inputFrequencyOffset, bandwidth, audioSampleRate);
+    }
+
     QList<QString> reverseAPIKeys;
 
     if((m_settings.m_inputFrequencyOffset != settings.m_inputFrequencyOffset) || force) {
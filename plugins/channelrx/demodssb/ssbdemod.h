@@ -69,6 +69,8 @@ public:
     SpectrumVis *getSpectrumVis() { return &m_spectrumVis; }
 
 	virtual void feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end, bool positiveOnly);
+	virtual bool acceptsBlocks() const { return true; }
+	virtual void feedBlock(const SampleBlockRef& block, bool positiveOnly);
 	virtual void start();
 	virtual void stop();
 	virtual bool handleMessage(const Message& cmd);
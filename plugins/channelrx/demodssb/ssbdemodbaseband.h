@@ -21,7 +21,7 @@
 #include <QObject>
 #include <QMutex>
 
-#include "dsp/samplesinkfifo.h"
+#include "dsp/sampleblockfifo.h"
 #include "util/message.h"
 #include "util/messagequeue.h"
 
@@ -60,6 +60,7 @@ public:
     ~SSBDemodBaseband();
     void reset();
     void feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end);
+    void feedBlock(const SampleBlockRef& block); //!< keeps a reference to the block instead of copying samples
     MessageQueue *getInputMessageQueue() { return &m_inputMessageQueue; } //!< Get the queue for asynchronous inbound communication
     int getChannelSampleRate() const;
 	void setSpectrumSink(BasebandSampleSink* spectrumSink) { m_sink.setSpectrumSink(spectrumSink); }
@@ -71,13 +72,15 @@ public:
     void setMessageQueueToGUI(MessageQueue *messageQueue) { m_messageQueueToGUI = messageQueue; }
 
 private:
-    SampleSinkFifo m_sampleFifo;
+    SampleBlockFifo m_sampleFifo;
+    SampleBlockPool *m_blockPool; //!< holds samples not fed as a shared block
     DownChannelizer *m_channelizer;
     SSBDemodSink m_sink;
 	MessageQueue m_inputMessageQueue; //!< Queue for asynchronous inbound communication
     SSBDemodSettings m_settings;
     unsigned int m_audioSampleRate;
     MessageQueue *m_messageQueueToGUI;
+    qint64 m_subbandFrequencyOffset; //!< center of the input when fed by the device shared channelizer
     QMutex m_mutex;
 
     bool handleMessage(const Message& cmd);
@@ -87,6 +87,7 @@ SSBDemodSink::~SSBDemodSink()
 void SSBDemodSink::feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end)
 {
     Complex ci;
+    m_filterIn.clear();
 
 	for(SampleVector::const_iterator it = begin; it < end; ++it)
 	{
@@ -97,7 +98,7 @@ void SSBDemodSink::feed(const SampleVector::const_iterator& begin, const SampleV
         {
             while (!m_interpolator.interpolate(&m_interpolatorDistanceRemain, c, &ci))
             {
-                processOneSample(ci);
+                m_filterIn.push_back(ci);
                 m_interpolatorDistanceRemain += m_interpolatorDistance;
             }
         }
@@ -105,25 +106,38 @@ void SSBDemodSink::feed(const SampleVector::const_iterator& begin, const SampleV
         {
             if (m_interpolator.decimate(&m_interpolatorDistanceRemain, c, &ci))
             {
-                processOneSample(ci);
+                m_filterIn.push_back(ci);
                 m_interpolatorDistanceRemain += m_interpolatorDistance;
             }
         }
     }
+
+    processSamples();
 }
 
-void SSBDemodSink::processOneSample(Complex &ci)
+void SSBDemodSink::processSamples()
 {
-	fftfilt::cmplx *sideband;
 	int n_out = 0;
 	int decim = 1<<(m_spanLog2 - 1);
 	unsigned char decim_mask = decim - 1; // counter LSB bit mask for decimation by 2^(m_scaleLog2 - 1)
 
-    if (m_dsb) {
-        n_out = DSBFilter->runDSB(ci, &sideband);
-    } else {
-        n_out = SSBFilter->runSSB(ci, &sideband, m_usb);
+    if (m_filterIn.size() == 0) {
+        return;
+    }
+
+    // the block filter gives the same blocks as the per sample filter
+    if (m_dsb)
+    {
+        m_filterOut.resize(m_filterIn.size() + DSBFilter->getBlockSize());
+        n_out = DSBFilter->runDSB(m_filterIn.data(), m_filterIn.size(), m_filterOut.data());
     }
+    else
+    {
+        m_filterOut.resize(m_filterIn.size() + SSBFilter->getBlockSize());
+        n_out = SSBFilter->runSSB(m_filterIn.data(), m_filterIn.size(), m_filterOut.data(), m_usb);
+    }
+
+    fftfilt::cmplx *sideband = m_filterOut.data();
 
     for (int i = 0; i < n_out; i++)
     {
@@ -112,6 +112,8 @@ private:
     Real m_interpolatorDistanceRemain;
 	fftfilt* SSBFilter;
 	fftfilt* DSBFilter;
+	std::vector<fftfilt::cmplx> m_filterIn;  //!< channel samples at audio rate collected by feed
+	std::vector<fftfilt::cmplx> m_filterOut;
 
 	BasebandSampleSink* m_spectrumSink;
 	SampleVector m_sampleBuffer;
@@ -124,7 +126,7 @@ private:
 	static const int m_ssbFftLen;
 	static const int m_agcTarget;
 
-    void processOneSample(Complex &ci);
+    void processSamples(); //!< filters the samples collected by feed as a whole and demodulates them
 };
 
 #endif // INCLUDE_SSBDEMODSINK_H
\ No newline at end of file
@@ -268,6 +268,12 @@ void FileSink::applySettings(const FileSinkSettings& settings, bool force)
     if ((settings.m_squelchRecordingEnable != m_settings.m_squelchRecordingEnable) || force) {
         reverseAPIKeys.append("squelchRecordingEnable");
     }
+    if ((settings.m_directIO != m_settings.m_directIO) || force) {
+        reverseAPIKeys.append("directIO");
+    }
+    if ((settings.m_compressed != m_settings.m_compressed) || force) {
+        reverseAPIKeys.append("compressed");
+    }
 
     if (m_settings.m_streamIndex != settings.m_streamIndex)
     {
@@ -452,6 +458,12 @@ void FileSink::webapiUpdateChannelSettings(
     if (channelSettingsKeys.contains("squelchRecordingEnable")) {
         settings.m_squelchRecordingEnable = response.getFileSinkSettings()->getSquelchRecordingEnable() != 0;
     }
+    if (channelSettingsKeys.contains("directIO")) {
+        settings.m_directIO = response.getFileSinkSettings()->getDirectIo() != 0;
+    }
+    if (channelSettingsKeys.contains("compressed")) {
+        settings.m_compressed = response.getFileSinkSettings()->getCompressed() != 0;
+    }
     if (channelSettingsKeys.contains("streamIndex")) {
         settings.m_streamIndex = response.getFileSinkSettings()->getStreamIndex();
     }
@@ -499,6 +511,8 @@ void FileSink::webapiFormatChannelSettings(SWGSDRangel::SWGChannelSettings& resp
     response.getFileSinkSettings()->setPreRecordTime(settings.m_preRecordTime);
     response.getFileSinkSettings()->setSquelchPostRecordTime(settings.m_squelchPostRecordTime);
     response.getFileSinkSettings()->setSquelchRecordingEnable(settings.m_squelchRecordingEnable ? 1 : 0);
+    response.getFileSinkSettings()->setDirectIo(settings.m_directIO ? 1 : 0);
+    response.getFileSinkSettings()->setCompressed(settings.m_compressed ? 1 : 0);
     response.getFileSinkSettings()->setStreamIndex(settings.m_streamIndex);
     response.getFileSinkSettings()->setUseReverseApi(settings.m_useReverseAPI ? 1 : 0);
 
@@ -523,6 +537,9 @@ void FileSink::webapiFormatChannelReport(SWGSDRangel::SWGChannelReport& response
     response.getFileSinkReport()->setRecording(m_basebandSink->isRecording() ? 1 : 0);
     response.getFileSinkReport()->setRecordCaptures(getNbTracks());
     response.getFileSinkReport()->setChannelSampleRate(m_basebandSink->getChannelSampleRate());
+    response.getFileSinkReport()->setWriteLatency(m_basebandSink->getWriteLatencyMs());
+    response.getFileSinkReport()->setWriteLatencyMax(m_basebandSink->getMaxWriteLatencyMs());
+    response.getFileSinkReport()->setDroppedBuffers(m_basebandSink->getDroppedBuffers());
 }
 
 void FileSink::webapiReverseSendSettings(QList<QString>& channelSettingsKeys, const FileSinkSettings& settings, bool force)
@@ -624,6 +641,12 @@ void FileSink::webapiFormatChannelSettings(
     if (channelSettingsKeys.contains("squelchRecordingEnable")) {
         swgFileSinkSettings->setSquelchRecordingEnable(settings.m_squelchRecordingEnable ? 1 : 0);
     }
+    if (channelSettingsKeys.contains("directIO")) {
+        swgFileSinkSettings->setDirectIo(settings.m_directIO ? 1 : 0);
+    }
+    if (channelSettingsKeys.contains("compressed")) {
+        swgFileSinkSettings->setCompressed(settings.m_compressed ? 1 : 0);
+    }
     if (channelSettingsKeys.contains("streamIndex")) {
         swgFileSinkSettings->setStreamIndex(settings.m_streamIndex);
     }
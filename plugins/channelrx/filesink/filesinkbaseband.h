@@ -94,6 +94,9 @@ public:
     uint64_t getMsCount() const { return m_sink.getMsCount(); }
     uint64_t getByteCount() const { return m_sink.getByteCount(); }
     unsigned int getNbTracks() const { return m_sink.getNbTracks(); }
+    float getWriteLatencyMs() const { return m_sink.getWriteLatencyMs(); }
+    float getMaxWriteLatencyMs() const { return m_sink.getMaxWriteLatencyMs(); }
+    quint64 getDroppedBuffers() const { return m_sink.getDroppedBuffers(); }
     void setMessageQueueToGUI(MessageQueue *messageQueue) { m_messageQueueToGUI = messageQueue; m_sink.setMessageQueueToGUI(messageQueue); }
     void setDeviceHwId(const QString& hwId) { m_sink.setDeviceHwId(hwId); }
     void setDeviceUId(int uid) { m_sink.setDeviceUId(uid); }
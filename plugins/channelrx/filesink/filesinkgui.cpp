@@ -243,6 +243,8 @@ void FileSinkGUI::displaySettings()
     ui->postSquelchTimeText->setText(tr("%1").arg(m_settings.m_squelchPostRecordTime));
     ui->squelchedRecording->setChecked(m_settings.m_squelchRecordingEnable);
     ui->record->setEnabled(!m_settings.m_squelchRecordingEnable);
+    ui->directIO->setChecked(m_settings.m_directIO);
+    ui->compressed->setChecked(m_settings.m_compressed);
 
     if (!m_settings.m_spectrumSquelchMode) {
         ui->squelchLevel->setStyleSheet("QDial { background:rgb(79,79,79); }");
@@ -479,6 +481,18 @@ void FileSinkGUI::on_record_toggled(bool checked)
     m_fileSink->record(checked);
 }
 
+void FileSinkGUI::on_directIO_toggled(bool checked)
+{
+    m_settings.m_directIO = checked;
+    applySettings();
+}
+
+void FileSinkGUI::on_compressed_toggled(bool checked)
+{
+    m_settings.m_compressed = checked;
+    applySettings();
+}
+
 void FileSinkGUI::on_showFileDialog_clicked(bool checked)
 {
     (void) checked;
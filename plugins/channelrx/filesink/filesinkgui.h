@@ -101,6 +101,8 @@ private slots:
     void on_postSquelchTime_valueChanged(int value);
     void on_squelchedRecording_toggled(bool checked);
     void on_record_toggled(bool checked);
+    void on_directIO_toggled(bool checked);
+    void on_compressed_toggled(bool checked);
     void on_showFileDialog_clicked(bool checked);
     void onWidgetRolled(QWidget* widget, bool rollDown);
     void onMenuDialogCalled(const QPoint& p);
@@ -41,6 +41,8 @@ void FileSinkSettings::resetToDefaults()
     m_preRecordTime = 0;
     m_squelchPostRecordTime = 0;
     m_squelchRecordingEnable = false;
+    m_directIO = false;
+    m_compressed = false;
     m_streamIndex = 0;
     m_useReverseAPI = false;
     m_reverseAPIAddress = "127.0.0.1";
@@ -74,6 +76,8 @@ QByteArray FileSinkSettings::serialize() const
     s.writeS32(16, m_preRecordTime);
     s.writeS32(17, m_squelchPostRecordTime);
     s.writeBool(18, m_squelchRecordingEnable);
+    s.writeBool(19, m_directIO);
+    s.writeBool(20, m_compressed);
 
     return s.final();
 }
@@ -130,6 +134,8 @@ bool FileSinkSettings::deserialize(const QByteArray& data)
         d.readS32(16, &m_preRecordTime, 0);
         d.readS32(17, &m_squelchPostRecordTime, 0);
         d.readBool(18, &m_squelchRecordingEnable, false);
+        d.readBool(19, &m_directIO, false);
+        d.readBool(20, &m_compressed, false);
 
         return true;
     }
@@ -36,6 +36,8 @@ struct FileSinkSettings
     int m_preRecordTime;
     int m_squelchPostRecordTime;
     bool m_squelchRecordingEnable;
+    bool m_directIO; //!< record without going through the page cache (Linux only)
+    bool m_compressed; //!< record in the compressed chunks format (v2)
     int m_streamIndex; //!< MIMO channel. Not relevant when connected to SI (single Rx).
     bool m_useReverseAPI;
     QString m_reverseAPIAddress;
@@ -264,6 +264,14 @@ void FileSinkSink::applySettings(const FileSinkSettings& settings, bool force)
         }
     }
 
+    if ((settings.m_directIO != m_settings.m_directIO) || force) {
+        m_fileSink.setDirectIO(settings.m_directIO);
+    }
+
+    if ((settings.m_compressed != m_settings.m_compressed) || force) {
+        m_fileSink.setChunked(settings.m_compressed);
+    }
+
     if ((settings.m_preRecordTime != m_settings.m_squelchPostRecordTime) || force)
     {
         m_preRecordBuffer.setSize(settings.m_preRecordTime * m_sinkSampleRate);
@@ -52,6 +52,9 @@ public:
     uint64_t getMsCount() const { return m_msCount; }
     uint64_t getByteCount() const { return m_byteCount; }
     unsigned int getNbTracks() const { return m_nbCaptures; }
+    float getWriteLatencyMs() const { return m_fileSink.getWriteLatencyMs(); }
+    float getMaxWriteLatencyMs() const { return m_fileSink.getMaxWriteLatencyMs(); }
+    quint64 getDroppedBuffers() const { return m_fileSink.getDroppedBuffers(); }
     void setMessageQueueToGUI(MessageQueue *messageQueue) { m_msgQueueToGUI = messageQueue; }
     void squelchRecording(bool squelchOpen);
     int getSampleRate() const { return m_sinkSampleRate; }
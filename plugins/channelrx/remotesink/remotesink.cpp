@@ -40,6 +40,7 @@
 #include "maincore.h"
 
 #include "remotesinkbaseband.h"
+#include "remotesinksender.h"
 
 MESSAGE_CLASS_DEFINITION(RemoteSink::MsgConfigureRemoteSink, Message)
 
@@ -109,6 +110,15 @@ void RemoteSink::stop()
 	m_thread->wait();
 }
 
+void RemoteSink::getTransportStatus(qint64& throughput, int& sendQueueBytes, unsigned int& nbPendingFrames, bool& gso)
+{
+    RemoteSinkSender *sender = m_basebandSink->getSender();
+    throughput = sender->getThroughput();
+    sendQueueBytes = sender->getSendQueueBytes();
+    nbPendingFrames = sender->getNbPendingFrames();
+    gso = sender->isGSO();
+}
+
 bool RemoteSink::handleMessage(const Message& cmd)
 {
     if (MsgConfigureRemoteSink::match(cmd))
@@ -109,6 +109,7 @@ public:
 
     uint32_t getNumberOfDeviceStreams() const;
     int getBasebandSampleRate() const { return m_basebandSampleRate; }
+    void getTransportStatus(qint64& throughput, int& sendQueueBytes, unsigned int& nbPendingFrames, bool& gso);
 
     static const QString m_channelIdURI;
     static const QString m_channelId;
@@ -15,14 +15,22 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.          //
 ///////////////////////////////////////////////////////////////////////////////////
 
+#include <QDebug>
+
 #include "remotesinkfifo.h"
 
 RemoteSinkFifo::RemoteSinkFifo(QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    m_size(0),
+    m_readHead(0),
+    m_servedHead(0),
+    m_writeHead(0),
+    m_nbOverruns(0)
 {}
 
 RemoteSinkFifo::RemoteSinkFifo(unsigned int size, QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    m_nbOverruns(0)
 {
     resize(size);
 }
@@ -50,6 +58,16 @@ void RemoteSinkFifo::reset()
 RemoteDataBlock *RemoteSinkFifo::getDataBlock()
 {
     QMutexLocker mutexLocker(&m_mutex);
+
+    if (calculateRemainder() == (unsigned int) m_size - 1)
+    {
+        // the block to serve has not been read yet: drop the oldest unread block
+        // rather than losing all of them and overwriting one being read
+        m_readHead = m_readHead < m_size - 1 ? m_readHead + 1 : 0;
+        m_nbOverruns++;
+        qWarning("RemoteSinkFifo::getDataBlock: overrun: %u blocks dropped", m_nbOverruns);
+    }
+
     m_servedHead = m_writeHead;
 
     if (m_writeHead < m_size - 1) {
@@ -47,6 +47,7 @@ private:
     unsigned int m_readHead;   //!< index of last data block processed
     unsigned int m_servedHead; //!< index of last data block served
     unsigned int m_writeHead;  //!< index of next data block to serve
+    unsigned int m_nbOverruns; //!< number of unread data blocks dropped
     QMutex m_mutex;
 
     unsigned int calculateRemainder();
@@ -23,6 +23,7 @@
 #include "dsp/hbfilterchainconverter.h"
 #include "dsp/dspcommands.h"
 #include "mainwindow.h"
+#include "maincore.h"
 
 #include "remotesinkgui.h"
 #include "remotesink.h"
@@ -121,6 +122,7 @@ RemoteSinkGUI::RemoteSinkGUI(PluginAPI* pluginAPI, DeviceUISet *deviceUISet, Bas
     m_deviceUISet->addRollupWidget(this);
 
     connect(getInputMessageQueue(), SIGNAL(messageEnqueued()), this, SLOT(handleSourceMessages()));
+    connect(&MainCore::instance()->getMasterTimer(), SIGNAL(timeout()), this, SLOT(tick())); // 50 ms
 
     displaySettings();
     applySettings(true);
@@ -378,7 +380,18 @@ void RemoteSinkGUI::applyPosition()
 
 void RemoteSinkGUI::tick()
 {
-    if (++m_tickCount == 20) { // once per second
+    if (++m_tickCount == 20) // once per second
+    {
         m_tickCount = 0;
+        qint64 throughput;
+        int sendQueueBytes;
+        unsigned int nbPendingFrames;
+        bool gso;
+        m_remoteSink->getTransportStatus(throughput, sendQueueBytes, nbPendingFrames, gso);
+        ui->txStatsText->setText(tr("%1MB/s %2-%3kB%4")
+            .arg(QString::number(throughput / 1e6, 'f', 3))
+            .arg(nbPendingFrames)
+            .arg(sendQueueBytes / 1024)
+            .arg(gso ? " G" : ""));
     }
 }
@@ -22,8 +22,7 @@
 ///////////////////////////////////////////////////////////////////////////////////
 
 
-#include <thread>
-#include <chrono>
+#include <algorithm>
 
 #include <QUdpSocket>
 
@@ -34,12 +33,27 @@
 
 RemoteSinkSender::RemoteSinkSender() :
     m_fifo(20, this),
+    m_encodeJobIndex(0),
     m_address(QHostAddress::LocalHost),
-    m_socket(nullptr)
+    m_socket(new QUdpSocket(this)),
+    m_udpSender(m_socket)
 {
     qDebug("RemoteSinkSender::RemoteSinkSender");
-    m_cm256p = m_cm256.isInitialized() ? &m_cm256 : nullptr;
-    m_socket = new QUdpSocket(this);
+
+    for (int i = 0; i < m_fecPool.getNbContexts(); i++) {
+        m_encoderContexts.push_back(new EncoderContext());
+    }
+
+    m_cm256OK = m_encoderContexts[0]->m_cm256.isInitialized();
+
+    // enough frames in flight to keep all workers busy while the oldest frame is being sent
+    m_encodeJobs.resize(2 * m_fecPool.getNbContexts());
+
+    for (auto& job : m_encodeJobs)
+    {
+        job.m_sender = this;
+        job.m_dataBlock = new RemoteDataBlock();
+    }
 
     QObject::connect(
         &m_fifo,
@@ -53,6 +67,17 @@ RemoteSinkSender::RemoteSinkSender() :
 RemoteSinkSender::~RemoteSinkSender()
 {
     qDebug("RemoteSinkSender::~RemoteSinkSender");
+
+    while (m_fecPool.pop(true)) {}
+
+    for (auto context : m_encoderContexts) {
+        delete context;
+    }
+
+    for (auto& job : m_encodeJobs) {
+        delete job.m_dataBlock;
+    }
+
     delete m_socket;
 }
 
@@ -62,90 +87,96 @@ RemoteDataBlock *RemoteSinkSender::getDataBlock()
 }
 
 void RemoteSinkSender::handleData()
+{
+    RemoteFECPool::Job *job;
+    pushDataBlocks();
+
+    while ((job = m_fecPool.pop(true)))
+    {
+        sendDataBlock(static_cast<EncodeJob*>(job)->m_dataBlock);
+        pushDataBlocks(); // frames served while sending are encoded meanwhile
+    }
+}
+
+void RemoteSinkSender::pushDataBlocks()
 {
     RemoteDataBlock *dataBlock;
-    unsigned int remainder = m_fifo.getRemainder();
 
-    while (remainder != 0)
+    while (m_fecPool.getNbInFlight() < (int) m_encodeJobs.size())
     {
-        remainder = m_fifo.readDataBlock(&dataBlock);
+        m_fifo.readDataBlock(&dataBlock);
 
-        if (dataBlock) {
-            sendDataBlock(dataBlock);
+        if (!dataBlock) {
+            break;
         }
+
+        // The frame is encoded and sent from a copy as the FIFO slot may be served again
+        // to the sink while the frame is still in flight.
+        EncodeJob& job = m_encodeJobs[m_encodeJobIndex];
+        m_encodeJobIndex = (m_encodeJobIndex + 1) % m_encodeJobs.size();
+        job.m_dataBlock->m_txControlBlock = dataBlock->m_txControlBlock;
+        job.m_dataBlock->m_rxControlBlock = dataBlock->m_rxControlBlock;
+        std::copy(dataBlock->m_superBlocks, dataBlock->m_superBlocks + RemoteNbOrginalBlocks, job.m_dataBlock->m_superBlocks);
+        m_fecPool.push(&job);
     }
 }
 
-void RemoteSinkSender::sendDataBlock(RemoteDataBlock *dataBlock)
+void RemoteSinkSender::encodeDataBlock(RemoteDataBlock *dataBlock, int workerIndex)
 {
 	CM256::cm256_encoder_params cm256Params;  //!< Main interface with CM256 encoder
 	CM256::cm256_block descriptorBlocks[256]; //!< Pointers to data for CM256 encoder
-	RemoteProtectedBlock fecBlocks[256];   //!< FEC data
 
     uint16_t frameIndex = dataBlock->m_txControlBlock.m_frameIndex;
     int nbBlocksFEC = dataBlock->m_txControlBlock.m_nbBlocksFEC;
-    int txDelay = dataBlock->m_txControlBlock.m_txDelay;
-    m_address.setAddress(dataBlock->m_txControlBlock.m_dataAddress);
-    uint16_t dataPort = dataBlock->m_txControlBlock.m_dataPort;
     RemoteSuperBlock *txBlockx = dataBlock->m_superBlocks;
+    EncoderContext *context = m_encoderContexts[workerIndex];
 
-    if ((nbBlocksFEC == 0) || !m_cm256p) // Do not FEC encode
-    {
-        if (m_socket)
-        {
-            for (int i = 0; i < RemoteNbOrginalBlocks; i++)
-            {
-                // send block via UDP
-                m_socket->writeDatagram((const char*)&txBlockx[i], (qint64 ) RemoteUdpSize, m_address, dataPort);
-                std::this_thread::sleep_for(std::chrono::microseconds(txDelay));
-            }
-        }
+    if ((nbBlocksFEC == 0) || !m_cm256OK) { // Do not FEC encode
+        return;
     }
-    else
+
+    cm256Params.BlockBytes = sizeof(RemoteProtectedBlock);
+    cm256Params.OriginalCount = RemoteNbOrginalBlocks;
+    cm256Params.RecoveryCount = nbBlocksFEC;
+
+    // Fill pointers to data
+    for (int i = 0; i < cm256Params.OriginalCount + cm256Params.RecoveryCount; ++i)
     {
-        cm256Params.BlockBytes = sizeof(RemoteProtectedBlock);
-        cm256Params.OriginalCount = RemoteNbOrginalBlocks;
-        cm256Params.RecoveryCount = nbBlocksFEC;
-
-        // Fill pointers to data
-        for (int i = 0; i < cm256Params.OriginalCount + cm256Params.RecoveryCount; ++i)
-        {
-            if (i >= cm256Params.OriginalCount) {
-                memset((void *) &txBlockx[i].m_protectedBlock, 0, sizeof(RemoteProtectedBlock));
-            }
-
-            txBlockx[i].m_header.m_frameIndex = frameIndex;
-            txBlockx[i].m_header.m_blockIndex = i;
-            txBlockx[i].m_header.m_sampleBytes = (SDR_RX_SAMP_SZ <= 16 ? 2 : 4);
-            txBlockx[i].m_header.m_sampleBits = SDR_RX_SAMP_SZ;
-            descriptorBlocks[i].Block = (void *) &(txBlockx[i].m_protectedBlock);
-            descriptorBlocks[i].Index = txBlockx[i].m_header.m_blockIndex;
+        if (i >= cm256Params.OriginalCount) {
+            memset((void *) &txBlockx[i].m_protectedBlock, 0, sizeof(RemoteProtectedBlock));
         }
 
-        // Encode FEC blocks
-        if (m_cm256p->cm256_encode(cm256Params, descriptorBlocks, fecBlocks))
-        {
-            qWarning("RemoteSinkSender::handleDataBlock: CM256 encode failed. No transmission.");
-            // TODO: send without FEC changing meta data to set indication of no FEC
-        }
+        txBlockx[i].m_header.m_frameIndex = frameIndex;
+        txBlockx[i].m_header.m_blockIndex = i;
+        txBlockx[i].m_header.m_sampleBytes = (SDR_RX_SAMP_SZ <= 16 ? 2 : 4);
+        txBlockx[i].m_header.m_sampleBits = SDR_RX_SAMP_SZ;
+        descriptorBlocks[i].Block = (void *) &(txBlockx[i].m_protectedBlock);
+        descriptorBlocks[i].Index = txBlockx[i].m_header.m_blockIndex;
+    }
 
-        // Merge FEC with data to transmit
-        for (int i = 0; i < cm256Params.RecoveryCount; i++)
-        {
-            txBlockx[i + cm256Params.OriginalCount].m_protectedBlock = fecBlocks[i];
-        }
+    // Encode FEC blocks
+    if (context->m_cm256.cm256_encode(cm256Params, descriptorBlocks, context->m_fecBlocks))
+    {
+        qWarning("RemoteSinkSender::encodeDataBlock: CM256 encode failed. No transmission.");
+        // TODO: send without FEC changing meta data to set indication of no FEC
+    }
 
-        // Transmit all blocks
-        if (m_socket)
-        {
-            for (int i = 0; i < cm256Params.OriginalCount + cm256Params.RecoveryCount; i++)
-            {
-                // send block via UDP
-                m_socket->writeDatagram((const char*)&txBlockx[i], (qint64 ) RemoteUdpSize, m_address, dataPort);
-                std::this_thread::sleep_for(std::chrono::microseconds(txDelay));
-            }
-        }
+    // Merge FEC with data to transmit
+    for (int i = 0; i < cm256Params.RecoveryCount; i++)
+    {
+        txBlockx[i + cm256Params.OriginalCount].m_protectedBlock = context->m_fecBlocks[i];
     }
+}
 
+void RemoteSinkSender::sendDataBlock(RemoteDataBlock *dataBlock)
+{
+    int nbBlocksFEC = dataBlock->m_txControlBlock.m_nbBlocksFEC;
+    int txDelay = dataBlock->m_txControlBlock.m_txDelay;
+    double txRate = dataBlock->m_txControlBlock.m_txRate;
+    m_address.setAddress(dataBlock->m_txControlBlock.m_dataAddress);
+    uint16_t dataPort = dataBlock->m_txControlBlock.m_dataPort;
+    int nbBlocks = RemoteNbOrginalBlocks + ((nbBlocksFEC == 0) || !m_cm256OK ? 0 : nbBlocksFEC);
+    m_udpSender.setRate(txRate > 0.0 ? txRate : txDelay > 0 ? 1e6 / txDelay : 0.0);
+    m_udpSender.sendBlocks(dataBlock->m_superBlocks, nbBlocks, m_address, dataPort);
     dataBlock->m_txControlBlock.m_processed = true;
 }
@@ -24,6 +24,8 @@
 #ifndef PLUGINS_CHANNELRX_REMOTESINK_REMOTESINKSENDER_H_
 #define PLUGINS_CHANNELRX_REMOTESINK_REMOTESINKSENDER_H_
 
+#include <vector>
+
 #include <QObject>
 #include <QMutex>
 #include <QWaitCondition>
@@ -33,6 +35,8 @@
 
 #include "util/message.h"
 #include "util/messagequeue.h"
+#include "channel/remoteudpsender.h"
+#include "channel/remotefecpool.h"
 
 #include "remotesinkfifo.h"
 
@@ -48,15 +52,41 @@ public:
     ~RemoteSinkSender();
 
     RemoteDataBlock *getDataBlock();
+    qint64 getThroughput() const { return m_udpSender.getThroughput(); } //!< bytes per second
+    int getSendQueueBytes() const { return m_udpSender.getSendQueueBytes(); }
+    unsigned int getNbPendingFrames() { return m_fifo.getRemainder(); }
+    bool isBatched() const { return m_udpSender.isBatched(); }
+    bool isGSO() const { return m_udpSender.isGSO(); }
 
 private:
+    struct EncoderContext //!< one per FEC worker
+    {
+        CM256 m_cm256;
+        RemoteProtectedBlock m_fecBlocks[256];
+    };
+
+    class EncodeJob : public RemoteFECPool::Job
+    {
+    public:
+        EncodeJob() : m_sender(nullptr), m_dataBlock(nullptr) {}
+        virtual void run(int workerIndex) { m_sender->encodeDataBlock(m_dataBlock, workerIndex); }
+        RemoteSinkSender *m_sender;
+        RemoteDataBlock *m_dataBlock; //!< owned copy of the frame so that FIFO slots are free once read
+    };
+
     RemoteSinkFifo m_fifo;
-    CM256 m_cm256;
-    CM256 *m_cm256p;
+    RemoteFECPool m_fecPool;
+    std::vector<EncoderContext*> m_encoderContexts;
+    std::vector<EncodeJob> m_encodeJobs; //!< ring of jobs. Its size limits the number of frames in flight.
+    unsigned int m_encodeJobIndex;
+    bool m_cm256OK;
 
     QHostAddress m_address;
     QUdpSocket *m_socket;
+    RemoteUDPSender m_udpSender;
 
+    void pushDataBlocks();
+    void encodeDataBlock(RemoteDataBlock *dataBlock, int workerIndex);
     void sendDataBlock(RemoteDataBlock *dataBlock);
 
 private slots:
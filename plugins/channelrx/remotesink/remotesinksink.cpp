@@ -37,6 +37,7 @@ RemoteSinkSink::RemoteSinkSink() :
         m_basebandSampleRate(48000),
         m_nbBlocksFEC(0),
         m_txDelay(35),
+        m_txRate(0.0),
         m_dataAddress("127.0.0.1"),
         m_dataPort(9090)
 {
@@ -78,9 +79,11 @@ void RemoteSinkSink::setTxDelay(int txDelay, int nbBlocksFEC, int log2Decim)
     double delay = sampleRate == 0 ? 1.0 : (127*samplesPerBlock*txDelayRatio) / sampleRate;
     delay /= 128 + nbBlocksFEC;
     m_txDelay = roundf(delay*1e6); // microseconds
+    m_txRate = delay == 0.0 ? 0.0 : 1.0 / delay;
     qDebug() << "RemoteSinkSink::setTxDelay:"
         << "txDelay:" << txDelay << "%"
         << "m_txDelay:" << m_txDelay << "us"
+        << "m_txRate:" << m_txRate << "blocks/s"
         << "sampleRate: " << sampleRate << "S/s";
 }
 
@@ -181,6 +184,7 @@ void RemoteSinkSink::feed(const SampleVector::const_iterator& begin, const Sampl
                 m_dataBlock->m_txControlBlock.m_complete = true;
                 m_dataBlock->m_txControlBlock.m_nbBlocksFEC = m_nbBlocksFEC;
                 m_dataBlock->m_txControlBlock.m_txDelay = m_txDelay;
+                m_dataBlock->m_txControlBlock.m_txRate = m_txRate;
                 m_dataBlock->m_txControlBlock.m_dataAddress = m_dataAddress;
                 m_dataBlock->m_txControlBlock.m_dataPort = m_dataPort;
 
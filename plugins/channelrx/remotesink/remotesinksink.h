@@ -44,6 +44,7 @@ public:
     void applySettings(const RemoteSinkSettings& settings, bool force = false);
     void applyBasebandSampleRate(uint32_t sampleRate);
     void setDeviceCenterFrequency(uint64_t frequency) { m_deviceCenterFrequency = frequency; }
+    RemoteSinkSender *getSender() { return m_remoteSinkSender; }
 
 private:
     RemoteSinkSettings m_settings;
@@ -61,7 +62,8 @@ private:
     int64_t m_frequencyOffset;
     uint32_t m_basebandSampleRate;
     int m_nbBlocksFEC;
-    int m_txDelay;
+    int m_txDelay;                       //!< delay between UDP blocks in microseconds
+    double m_txRate;                     //!< UDP blocks per second (exact inverse of the delay)
     QString m_dataAddress;
     uint16_t m_dataPort;
 
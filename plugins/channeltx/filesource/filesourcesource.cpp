@@ -184,7 +184,12 @@ void FileSourceSource::openFileStream(const QString& fileName)
 		m_sampleSize = header.sampleSize;
 		QString crcHex = QString("%1").arg(header.crc32 , 0, 16);
 
-	    if (crcOK)
+	    if (crcOK && FileRecord::isChunked(header))
+	    {
+	        qCritical("FileSourceSource::openFileStream: compressed chunks records are not supported");
+	        m_recordLengthMuSec = 0;
+	    }
+	    else if (crcOK)
 	    {
 	        qDebug("FileSourceSource::openFileStream: CRC32 OK for header: %s", qPrintable(crcHex));
 	        m_recordLengthMuSec = ((fileSize - sizeof(FileRecord::Header)) * 1000000UL) / ((m_sampleSize == 24 ? 8 : 4) * m_fileSampleRate);
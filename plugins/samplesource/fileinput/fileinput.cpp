@@ -17,6 +17,11 @@
 
 #include <string.h>
 #include <errno.h>
+#include <fstream>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#endif
 
 #include <QDebug>
 #include <QNetworkReply>
@@ -52,6 +57,10 @@ MESSAGE_CLASS_DEFINITION(FileInput::MsgReportHeaderCRC, Message)
 FileInput::FileInput(DeviceAPI *deviceAPI) :
     m_deviceAPI(deviceAPI),
 	m_settings(),
+	m_mapData(nullptr),
+	m_mapSize(0),
+	m_chunked(false),
+	m_chunkedSamples(0),
 	m_fileInputWorker(nullptr),
 	m_deviceDescription(),
 	m_fileName("..."),
@@ -78,6 +87,7 @@ FileInput::~FileInput()
     delete m_networkManager;
 
 	stop();
+	closeFileStream();
 }
 
 void FileInput::destroy()
@@ -87,34 +97,45 @@ void FileInput::destroy()
 
 void FileInput::openFileStream()
 {
-	//stopInput();
-
-	if (m_ifstream.is_open()) {
-		m_ifstream.close();
+	if (m_fileInputWorker)
+	{
+		// the worker reads the mapped file
+		qWarning("FileInput::openFileStream: stop acquisition before opening another file");
+		return;
 	}
 
+	closeFileStream();
+
+	std::ifstream headerStream;
 #ifdef Q_OS_WIN
-	m_ifstream.open(m_fileName.toStdWString().c_str(), std::ios::binary | std::ios::ate);
+	headerStream.open(m_fileName.toStdWString().c_str(), std::ios::binary | std::ios::ate);
 #else
-	m_ifstream.open(m_fileName.toStdString().c_str(), std::ios::binary | std::ios::ate);
+	headerStream.open(m_fileName.toStdString().c_str(), std::ios::binary | std::ios::ate);
 #endif
-	quint64 fileSize = m_ifstream.tellg();
+	quint64 fileSize = headerStream.is_open() ? (quint64) headerStream.tellg() : 0;
+	bool crcOK = false;
 
 	if (fileSize > sizeof(FileRecord::Header))
 	{
 	    FileRecord::Header header;
-	    m_ifstream.seekg(0,std::ios_base::beg);
-		bool crcOK = FileRecord::readHeader(m_ifstream, header);
+	    headerStream.seekg(0,std::ios_base::beg);
+		crcOK = FileRecord::readHeader(headerStream, header);
 		m_sampleRate = header.sampleRate;
 		m_centerFrequency = header.centerFrequency;
 		m_startingTimeStamp = header.startTimeStamp;
 		m_sampleSize = header.sampleSize;
+		m_chunked = FileRecord::isChunked(header);
 		QString crcHex = QString("%1").arg(header.crc32 , 0, 16);
 
 	    if (crcOK)
 	    {
 	        qDebug("FileInput::openFileStream: CRC32 OK for header: %s", qPrintable(crcHex));
-	        m_recordLengthMuSec = ((fileSize - sizeof(FileRecord::Header)) * 1000000UL) / ((m_sampleSize == 24 ? 8 : 4) * m_sampleRate);
+
+			if (m_chunked) { // from the chunk index once mapped
+				m_recordLengthMuSec = 0;
+			} else {
+				m_recordLengthMuSec = ((fileSize - sizeof(FileRecord::Header)) * 1000000UL) / ((m_sampleSize == 24 ? 8 : 4) * m_sampleRate);
+			}
 	    }
 	    else
 	    {
@@ -133,8 +154,46 @@ void FileInput::openFileStream()
 		m_recordLengthMuSec = 0;
 	}
 
+	headerStream.close();
+
+	if ((m_recordLengthMuSec != 0) || (crcOK && m_chunked))
+	{
+		// samples are read from the page cache with no copy and no system call per tick
+		m_mapFile.setFileName(m_fileName);
+
+		if (m_mapFile.open(QIODevice::ReadOnly)) {
+			m_mapData = m_mapFile.map(0, fileSize);
+		}
+
+		if (m_mapData)
+		{
+			m_mapSize = fileSize;
+#ifdef Q_OS_UNIX
+			posix_madvise(m_mapData, m_mapSize, POSIX_MADV_SEQUENTIAL);
+#endif
+		}
+		else
+		{
+			qCritical("FileInput::openFileStream: cannot map %s: %s", qPrintable(m_fileName), qPrintable(m_mapFile.errorString()));
+			m_mapFile.close();
+			m_recordLengthMuSec = 0;
+		}
+
+		if (m_mapData && m_chunked)
+		{
+			m_chunkedSamples = FileRecord::readChunkIndex(m_mapData, m_mapSize, m_chunkIndex);
+			m_recordLengthMuSec = m_sampleRate == 0 ? 0 : (m_chunkedSamples * 1000000UL) / m_sampleRate;
+			qDebug("FileInput::openFileStream: %zu chunks %llu samples", m_chunkIndex.size(), m_chunkedSamples);
+
+			if (m_recordLengthMuSec == 0) {
+				closeFileStream();
+			}
+		}
+	}
+
 	qDebug() << "FileInput::openFileStream: " << m_fileName.toStdString().c_str()
 			<< " fileSize: " << fileSize << " bytes"
+			<< " chunked: " << m_chunked
 			<< " length: " << m_recordLengthMuSec << " microseconds"
 			<< " sample rate: " << m_sampleRate << " S/s"
 			<< " center frequency: " << m_centerFrequency << " Hz"
@@ -151,27 +210,44 @@ void FileInput::openFileStream()
 	            m_recordLengthMuSec); // file stream data
 	    getMessageQueueToGUI()->push(report);
 	}
+}
 
-	if (m_recordLengthMuSec == 0) {
-	    m_ifstream.close();
+void FileInput::closeFileStream()
+{
+	if (m_mapData)
+	{
+		m_mapFile.unmap(m_mapData);
+		m_mapData = nullptr;
+		m_mapSize = 0;
+	}
+
+	if (m_mapFile.isOpen()) {
+		m_mapFile.close();
 	}
+
+	m_chunked = false;
+	m_chunkIndex.clear();
+	m_chunkedSamples = 0;
 }
 
 void FileInput::seekFileStream(int seekMillis)
 {
 	QMutexLocker mutexLocker(&m_mutex);
 
-	if ((m_ifstream.is_open()) && m_fileInputWorker && !m_fileInputWorker->isRunning())
+	if (m_mapData && m_fileInputWorker && !m_fileInputWorker->isRunning())
 	{
         quint64 seekPoint = ((m_recordLengthMuSec * seekMillis) / 1000) * m_sampleRate;
         seekPoint /= 1000000UL;
-		m_fileInputWorker->setSamplesCount(seekPoint);
-        seekPoint *= (m_sampleSize == 24 ? 8 : 4); // + sizeof(FileRecord::Header)
-		m_ifstream.clear();
-		m_ifstream.seekg(seekPoint + sizeof(FileRecord::Header), std::ios::beg);
+		m_fileInputWorker->setSamplesCount(seekPoint); // the worker reads at this sample index
 	}
 }
 
+unsigned int FileInput::getSampleFifoSize(quint32 accelerationFactor) const
+{
+	// as fast as possible (0) uses the FIFO of normal speed
+	return (accelerationFactor == 0 ? 1 : accelerationFactor) * m_sampleRate * sizeof(Sample);
+}
+
 void FileInput::init()
 {
     DSPSignalNotification *notif = new DSPSignalNotification(m_sampleRate, m_centerFrequency);
@@ -180,7 +256,7 @@ void FileInput::init()
 
 bool FileInput::start()
 {
-    if (!m_ifstream.is_open())
+    if (!m_mapData)
     {
         qWarning("FileInput::start: file not open. not starting");
         return false;
@@ -189,21 +265,33 @@ bool FileInput::start()
 	QMutexLocker mutexLocker(&m_mutex);
 	qDebug() << "FileInput::start";
 
-	if (m_ifstream.tellg() != (std::streampos)0)
-    {
-		m_ifstream.clear();
-		m_ifstream.seekg(sizeof(FileRecord::Header), std::ios::beg);
-	}
-
-	if (!m_sampleFifo.setSize(m_settings.m_accelerationFactor * m_sampleRate * sizeof(Sample)))
+	if (!m_sampleFifo.setSize(getSampleFifoSize(m_settings.m_accelerationFactor)))
     {
 		qCritical("Could not allocate SampleFifo");
 		return false;
 	}
 
-	m_fileInputWorker = new FileInputWorker(&m_ifstream, &m_sampleFifo, m_masterTimer, &m_inputMessageQueue);
+	if (m_chunked)
+	{
+		m_fileInputWorker = new FileInputWorker(
+			m_mapData,
+			m_mapSize,
+			&m_sampleFifo,
+			m_masterTimer,
+			&m_inputMessageQueue);
+		m_fileInputWorker->setChunkIndex(&m_chunkIndex, m_chunkedSamples);
+	}
+	else
+	{
+		m_fileInputWorker = new FileInputWorker(
+			m_mapData + sizeof(FileRecord::Header),
+			m_mapSize - sizeof(FileRecord::Header),
+			&m_sampleFifo,
+			m_masterTimer,
+			&m_inputMessageQueue);
+	}
 	m_fileInputWorker->moveToThread(&m_fileInputWorkerThread);
-	m_fileInputWorker->setSampleRateAndSize(m_settings.m_accelerationFactor * m_sampleRate, m_sampleSize); // Fast Forward: 1 corresponds to live. 1/2 is half speed, 2 is double speed
+	m_fileInputWorker->setSampleRateAndSize(m_settings.m_accelerationFactor * m_sampleRate, m_sampleSize); // Fast Forward: 1 corresponds to live. 0 is as fast as possible
 	startWorker();
 
 	m_deviceDescription = "FileInput";
@@ -438,11 +526,11 @@ bool FileInput::applySettings(const FileInputSettings& settings, bool force)
         if (m_fileInputWorker)
         {
             QMutexLocker mutexLocker(&m_mutex);
-            if (!m_sampleFifo.setSize(m_settings.m_accelerationFactor * m_sampleRate * sizeof(Sample))) {
-                qCritical("FileInput::applySettings: could not reallocate sample FIFO size to %lu",
-                        m_settings.m_accelerationFactor * m_sampleRate * sizeof(Sample));
+            if (!m_sampleFifo.setSize(getSampleFifoSize(settings.m_accelerationFactor))) {
+                qCritical("FileInput::applySettings: could not reallocate sample FIFO size to %u",
+                        getSampleFifoSize(settings.m_accelerationFactor));
             }
-			m_fileInputWorker->setSampleRateAndSize(settings.m_accelerationFactor * m_sampleRate, m_sampleSize); // Fast Forward: 1 corresponds to live. 1/2 is half speed, 2 is double speed
+			m_fileInputWorker->setSampleRateAndSize(settings.m_accelerationFactor * m_sampleRate, m_sampleSize); // Fast Forward: 1 corresponds to live. 0 is as fast as possible
         }
     }
 
@@ -21,15 +21,18 @@
 #include <ctime>
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 #include <QString>
 #include <QByteArray>
+#include <QFile>
 #include <QTimer>
 #include <QThread>
 #include <QMutex>
 #include <QNetworkRequest>
 
 #include "dsp/devicesamplesource.h"
+#include "dsp/filerecord.h"
 #include "fileinputsettings.h"
 
 class QNetworkAccessManager;
@@ -332,7 +335,12 @@ public:
 	DeviceAPI *m_deviceAPI;
 	QMutex m_mutex;
 	FileInputSettings m_settings;
-	std::ifstream m_ifstream;
+	QFile m_mapFile;
+	uchar *m_mapData;    //!< whole record mapped in memory. nullptr if no valid record is open.
+	quint64 m_mapSize;
+	bool m_chunked;      //!< compressed chunks format (v2)
+	std::vector<FileRecord::ChunkIndexEntry> m_chunkIndex;
+	quint64 m_chunkedSamples;
 	FileInputWorker* m_fileInputWorker;
 	QThread m_fileInputWorkerThread;
 	QString m_deviceDescription;
@@ -349,6 +357,8 @@ public:
 	void startWorker();
 	void stopWorker();
 	void openFileStream();
+	void closeFileStream();
+	unsigned int getSampleFifoSize(quint32 accelerationFactor) const;
 	void seekFileStream(int seekMillis);
 	bool applySettings(const FileInputSettings& settings, bool force = false);
     void webapiFormatDeviceReport(SWGSDRangel::SWGDeviceReport& response);
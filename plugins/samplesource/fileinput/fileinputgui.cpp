@@ -406,6 +406,7 @@ void FileInputGUI::setAccelerationCombo()
         ui->acceleration->addItem(s);
     }
 
+    ui->acceleration->addItem(QString("Max")); // as fast as possible
     ui->acceleration->blockSignals(false);
 }
 
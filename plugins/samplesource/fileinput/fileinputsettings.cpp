@@ -91,6 +91,10 @@ bool FileInputSettings::deserialize(const QByteArray& data)
 
 int FileInputSettings::getAccelerationIndex(int accelerationValue)
 {
+    if (accelerationValue == 0) { // as fast as possible is last
+        return 3*m_accelerationMaxScale + 4;
+    }
+
     if (accelerationValue <= 1) {
         return 0;
     }
@@ -127,6 +131,10 @@ int FileInputSettings::getAccelerationValue(int accelerationIndex)
         return 1;
     }
 
+    if (accelerationIndex > (int) (3*m_accelerationMaxScale + 3)) {
+        return 0; // as fast as possible
+    }
+
     unsigned int v = accelerationIndex - 1;
     int m = pow(10.0, v/3 > m_accelerationMaxScale ? m_accelerationMaxScale : v/3);
     int x = 1;
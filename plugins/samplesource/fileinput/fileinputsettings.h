@@ -23,7 +23,7 @@
 
 struct FileInputSettings {
     QString m_fileName;
-    quint32 m_accelerationFactor;
+    quint32 m_accelerationFactor; //!< 0 for as fast as possible
     bool m_loop;
     bool     m_useReverseAPI;
     QString  m_reverseAPIAddress;
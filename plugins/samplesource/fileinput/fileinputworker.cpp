@@ -18,24 +18,38 @@
 #include <stdio.h>
 #include <errno.h>
 #include <assert.h>
+#include <algorithm>
 #include <QDebug>
+#include <QThread>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #include "dsp/filerecord.h"
+#include "dsp/iqcodec.h"
 #include "fileinputworker.h"
 #include "dsp/samplesinkfifo.h"
 #include "util/messagequeue.h"
 
 MESSAGE_CLASS_DEFINITION(FileInputWorker::MsgReportEOF, Message)
 
-FileInputWorker::FileInputWorker(std::ifstream *samplesStream,
+FileInputWorker::FileInputWorker(const quint8 *samples,
+        quint64 samplesBytes,
         SampleSinkFifo* sampleFifo,
         const QTimer& timer,
         MessageQueue *fileInputMessageQueue,
         QObject* parent) :
 	QObject(parent),
 	m_running(false),
-	m_ifstream(samplesStream),
-	m_fileBuf(nullptr),
+	m_samples(samples),
+	m_samplesBytes(samplesBytes),
+	m_chunkIndex(nullptr),
+	m_chunkedSamples(0),
+	m_chunkStart(0),
+	m_chunkEnd(0),
+	m_readahead(0),
 	m_convertBuf(nullptr),
 	m_bufsize(0),
 	m_chunksize(0),
@@ -49,7 +63,7 @@ FileInputWorker::FileInputWorker(std::ifstream *samplesStream,
     m_throttlems(FILESOURCE_THROTTLE_MS),
     m_throttleToggle(false)
 {
-    assert(m_ifstream != nullptr);
+    assert(m_samples != nullptr);
 }
 
 FileInputWorker::~FileInputWorker()
@@ -58,10 +72,6 @@ FileInputWorker::~FileInputWorker()
 		stopWork();
 	}
 
-	if (m_fileBuf) {
-		free(m_fileBuf);
-	}
-
 	if (m_convertBuf) {
 		free(m_convertBuf);
 	}
@@ -70,18 +80,9 @@ FileInputWorker::~FileInputWorker()
 void FileInputWorker::startWork()
 {
 	qDebug() << "FileInputThread::startWork: ";
-
-    if (m_ifstream->is_open())
-    {
-        qDebug() << "FileInputThread::startWork: file stream open, starting...";
-        m_elapsedTimer.start();
-        connect(&m_timer, SIGNAL(timeout()), this, SLOT(tick()));
-		m_running = true;
-    }
-    else
-    {
-        qDebug() << "FileInputThread::startWork: file stream closed, not starting.";
-    }
+    m_elapsedTimer.start();
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(tick()));
+    m_running = true;
 }
 
 void FileInputWorker::stopWork()
@@ -108,7 +109,12 @@ void FileInputWorker::setSampleRateAndSize(int samplerate, quint32 samplesize)
 		m_samplerate = samplerate;
 		m_samplesize = samplesize;
 		m_samplebytes = m_samplesize > 16 ? sizeof(int32_t) : sizeof(int16_t);
-        m_chunksize = (m_samplerate * 2 * m_samplebytes * m_throttlems) / 1000;
+
+		if (m_samplerate == 0) {
+			m_chunksize = FILESOURCE_FAST_CHUNK * 2 * m_samplebytes;
+		} else {
+			m_chunksize = (m_samplerate * 2 * m_samplebytes * m_throttlems) / 1000;
+		}
 
         setBuffers(m_chunksize);
 	}
@@ -116,6 +122,20 @@ void FileInputWorker::setSampleRateAndSize(int samplerate, quint32 samplesize)
 	//m_samplerate = samplerate;
 }
 
+void FileInputWorker::setSamplesCount(quint64 samplesCount)
+{
+	m_samplesCount = samplesCount;
+	m_readahead = 0;
+}
+
+void FileInputWorker::setChunkIndex(const std::vector<FileRecord::ChunkIndexEntry> *chunkIndex, quint64 nbSamples)
+{
+	m_chunkIndex = chunkIndex;
+	m_chunkedSamples = nbSamples;
+	m_chunkStart = 0;
+	m_chunkEnd = 0;
+}
+
 void FileInputWorker::setBuffers(std::size_t chunksize)
 {
     if (chunksize > m_bufsize)
@@ -123,22 +143,7 @@ void FileInputWorker::setBuffers(std::size_t chunksize)
         m_bufsize = chunksize;
         int nbSamples = m_bufsize/(2 * m_samplebytes);
 
-        if (!m_fileBuf)
-        {
-            qDebug() << "FileInputThread::setBuffers: Allocate file buffer";
-            m_fileBuf = (quint8*) malloc(m_bufsize);
-        }
-        else
-        {
-            qDebug() << "FileInputThread::setBuffers: Re-allocate file buffer";
-            quint8 *buf = m_fileBuf;
-            m_fileBuf = (quint8*) realloc((void*) m_fileBuf, m_bufsize);
-
-            if (!m_fileBuf) {
-                free(buf);
-            }
-        }
-
+        // the file samples are written directly to the FIFO. Only conversions need a buffer.
         if (!m_convertBuf)
         {
             qDebug() << "FileInputThread::setBuffers: Allocate conversion buffer";
@@ -164,6 +169,12 @@ void FileInputWorker::tick()
 {
 	if (m_running)
 	{
+		if (m_samplerate == 0)
+		{
+			tickFast();
+			return;
+		}
+
         qint64 throttlems = m_elapsedTimer.restart();
 
         if (throttlems != m_throttlems)
@@ -174,23 +185,156 @@ void FileInputWorker::tick()
             setBuffers(m_chunksize);
         }
 
-		// read samples directly feeding the SampleFifo (no callback)
-		m_ifstream->read(reinterpret_cast<char*>(m_fileBuf), m_chunksize);
+		if (writeSamples(m_chunksize / (2 * m_samplebytes)) == 0) {
+			reportEOF();
+		}
+	}
+}
 
-        if (m_ifstream->eof())
-        {
-        	writeToSampleFifo(m_fileBuf, (qint32) m_ifstream->gcount());
-        	MsgReportEOF *message = MsgReportEOF::create();
-        	m_fileInputMessageQueue->push(message);
-        }
-        else
-        {
-        	writeToSampleFifo(m_fileBuf, (qint32) m_chunksize);
-    		m_samplesCount += m_chunksize / (2 * m_samplebytes);
-        }
+void FileInputWorker::tickFast()
+{
+	// keep the FIFO full during the timer period. Its size is seconds of samples so the
+	// consumer does not starve until the next tick.
+	m_elapsedTimer.restart();
+
+	while (m_running && (m_elapsedTimer.elapsed() < FILESOURCE_THROTTLE_MS))
+	{
+		unsigned int room = m_sampleFifo->room();
+
+		if (room < FILESOURCE_FAST_CHUNK / 4)
+		{
+			QThread::usleep(500);
+			continue;
+		}
+
+		if (writeSamples(std::min(room, (unsigned int) FILESOURCE_FAST_CHUNK)) == 0)
+		{
+			reportEOF();
+			break;
+		}
 	}
 }
 
+quint64 FileInputWorker::writeSamples(quint64 nbSamples)
+{
+	if (m_chunkIndex) {
+		return writeChunkedSamples(nbSamples);
+	}
+
+	quint64 sampleBytes = 2 * m_samplebytes;
+	quint64 fileSamples = m_samplesBytes / sampleBytes;
+	m_samplesCount = std::min(m_samplesCount, fileSamples);
+	nbSamples = std::min(nbSamples, fileSamples - m_samplesCount);
+	quint64 offset = m_samplesCount * sampleBytes;
+
+	readAhead(offset + nbSamples * sampleBytes);
+	writeToSampleFifo(m_samples + offset, (qint32) (nbSamples * sampleBytes));
+	m_samplesCount += nbSamples;
+
+	return fileSamples - m_samplesCount;
+}
+
+quint64 FileInputWorker::writeChunkedSamples(quint64 nbSamples)
+{
+	quint64 sampleBytes = 2 * m_samplebytes;
+	m_samplesCount = std::min(m_samplesCount, m_chunkedSamples);
+	nbSamples = std::min(nbSamples, m_chunkedSamples - m_samplesCount);
+
+	while (nbSamples > 0)
+	{
+		if ((m_samplesCount < m_chunkStart) || (m_samplesCount >= m_chunkEnd))
+		{
+			int chunk = FileRecord::findChunk(*m_chunkIndex, m_samplesCount);
+
+			if (!decodeChunk(chunk) || (m_samplesCount >= m_chunkEnd))
+			{
+				// bad chunk: playback goes on with the next one
+				qWarning("FileInputWorker::writeChunkedSamples: cannot decode chunk %d", chunk);
+				quint64 next = (unsigned int) (chunk + 1) < m_chunkIndex->size() ? (*m_chunkIndex)[chunk + 1].sampleIndex : m_chunkedSamples;
+				nbSamples -= std::min(nbSamples, next - m_samplesCount);
+				m_samplesCount = next;
+				m_chunkStart = 0;
+				m_chunkEnd = 0;
+				continue;
+			}
+		}
+
+		quint64 len = std::min(nbSamples, m_chunkEnd - m_samplesCount);
+		writeToSampleFifo(&m_decodedChunk[(m_samplesCount - m_chunkStart) * sampleBytes], (qint32) (len * sampleBytes));
+		m_samplesCount += len;
+		nbSamples -= len;
+	}
+
+	return m_chunkedSamples - m_samplesCount;
+}
+
+bool FileInputWorker::decodeChunk(int chunk)
+{
+	m_chunkStart = 0;
+	m_chunkEnd = 0;
+
+	if (chunk < 0) {
+		return false;
+	}
+
+	quint64 offset = (*m_chunkIndex)[chunk].offset;
+	readAhead(offset);
+	const FileRecord::ChunkHeader *chunkHeader = FileRecord::getChunkHeader(m_samples, m_samplesBytes, offset);
+
+	if (!chunkHeader) {
+		return false;
+	}
+
+	const quint8 *payload = m_samples + offset + sizeof(FileRecord::ChunkHeader);
+	m_decodedChunk.resize(chunkHeader->nbSamples * 2 * m_samplebytes);
+	bool decoded;
+
+	if (m_samplebytes == sizeof(int32_t)) {
+		decoded = IQCodec::decode(payload, chunkHeader->payloadSize, (qint32 *) m_decodedChunk.data(), chunkHeader->nbSamples);
+	} else {
+		decoded = IQCodec::decode(payload, chunkHeader->payloadSize, (qint16 *) m_decodedChunk.data(), chunkHeader->nbSamples);
+	}
+
+	if (decoded)
+	{
+		m_chunkStart = chunkHeader->sampleIndex;
+		m_chunkEnd = m_chunkStart + chunkHeader->nbSamples;
+	}
+
+	return decoded;
+}
+
+void FileInputWorker::readAhead(quint64 offset)
+{
+	// renew the hint when half of the readahead window has been consumed
+	if ((m_readahead > offset) && (m_readahead - offset > FILESOURCE_READAHEAD_BYTES / 2)) {
+		return;
+	}
+
+	quint64 start = std::max(m_readahead, offset);
+	quint64 end = std::min(offset + FILESOURCE_READAHEAD_BYTES, m_samplesBytes);
+	m_readahead = end;
+
+	if (end <= start) {
+		return;
+	}
+
+#ifdef Q_OS_UNIX
+	// the mapping starts on a page boundary so rounding the address down stays inside
+	static const quintptr pageMask = sysconf(_SC_PAGESIZE) - 1;
+	quintptr addr = (quintptr) (m_samples + start);
+	quintptr aligned = addr & ~pageMask;
+	posix_madvise((void *) aligned, (end - start) + (addr - aligned), POSIX_MADV_WILLNEED);
+#endif
+}
+
+void FileInputWorker::reportEOF()
+{
+	m_running = false; // until restarted after the EOF is handled
+	MsgReportEOF *message = MsgReportEOF::create();
+	m_fileInputMessageQueue->push(message);
+}
+
 void FileInputWorker::writeToSampleFifo(const quint8* buf, qint32 nbBytes)
 {
 	if (m_samplesize == 16)
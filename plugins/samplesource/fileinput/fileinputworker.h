@@ -20,18 +20,27 @@
 
 #include <QTimer>
 #include <QElapsedTimer>
-#include <iostream>
-#include <fstream>
 #include <cstdlib>
+#include <vector>
 
 #include "dsp/inthalfbandfilter.h"
+#include "dsp/filerecord.h"
 #include "util/message.h"
 
 #define FILESOURCE_THROTTLE_MS 50
+#define FILESOURCE_FAST_CHUNK (1<<16)           //!< samples written at once when playing as fast as possible
+#define FILESOURCE_READAHEAD_BYTES (32<<20)     //!< file data the system is asked to read in advance
 
 class SampleSinkFifo;
 class MessageQueue;
 
+/**
+ * Plays back the I/Q samples of a memory mapped record straight into the sample FIFO.
+ * The position is a sample index so that seeking is immediate. The system is told to read ahead
+ * of the position so that the timer ticks do not wait for the disk.
+ * With a sample rate of 0 the samples are written as fast as they are consumed from the FIFO.
+ * Records in the chunked format are decoded one chunk at a time. A seek looks up the chunk in the index.
+ */
 class FileInputWorker : public QObject {
 	Q_OBJECT
 
@@ -50,7 +59,8 @@ public:
         { }
     };
 
-	FileInputWorker(std::ifstream *samplesStream,
+	FileInputWorker(const quint8 *samples,
+	        quint64 samplesBytes,
 	        SampleSinkFifo* sampleFifo,
 	        const QTimer& timer,
 	        MessageQueue *fileInputMessageQueue,
@@ -63,13 +73,20 @@ public:
     void setBuffers(std::size_t chunksize);
 	bool isRunning() const { return m_running; }
     quint64 getSamplesCount() const { return m_samplesCount; }
-    void setSamplesCount(quint64 samplesCount) { m_samplesCount = samplesCount; }
+    void setSamplesCount(quint64 samplesCount); //!< seek (worker stopped)
+    void setChunkIndex(const std::vector<FileRecord::ChunkIndexEntry> *chunkIndex, quint64 nbSamples); //!< chunked format. The mapping is then the whole file.
 
 private:
 	volatile bool m_running;
 
-	std::ifstream* m_ifstream;
-	quint8  *m_fileBuf;
+	const quint8 *m_samples; //!< mapped samples following the header
+	quint64 m_samplesBytes;
+	const std::vector<FileRecord::ChunkIndexEntry> *m_chunkIndex; //!< nullptr if the samples are not chunked
+	quint64 m_chunkedSamples;
+	quint64 m_chunkStart;    //!< first sample of the decoded chunk
+	quint64 m_chunkEnd;      //!< end of the decoded chunk
+	std::vector<quint8> m_decodedChunk;
+	quint64 m_readahead;     //!< end of the data the system was told to read in advance
 	quint8  *m_convertBuf;
 	std::size_t m_bufsize;
     qint64 m_chunksize;
@@ -78,7 +95,7 @@ private:
     const QTimer& m_timer;
     MessageQueue *m_fileInputMessageQueue;
 
-	int m_samplerate;      //!< File I/Q stream original sample rate
+	int m_samplerate;      //!< File I/Q stream playback sample rate. 0 for as fast as possible.
     quint64 m_samplesize;  //!< File effective sample size in bits (I or Q). Ex: 16, 24.
     quint64 m_samplebytes; //!< Number of bytes used to store a I or Q sample. Ex: 2. 4.
     qint64 m_throttlems;
@@ -87,6 +104,12 @@ private:
 
 	//void decimate1(SampleVector::iterator* it, const qint16* buf, qint32 len);
 	void writeToSampleFifo(const quint8* buf, qint32 nbBytes);
+	quint64 writeSamples(quint64 nbSamples); //!< from the current position. Returns the number of samples left.
+	quint64 writeChunkedSamples(quint64 nbSamples);
+	bool decodeChunk(int chunk);
+	void readAhead(quint64 offset);
+	void tickFast();
+	void reportEOF();
 
 private slots:
 	void tick();
@@ -29,6 +29,7 @@
 RemoteInputBuffer::RemoteInputBuffer() :
         m_decoderSlots(nullptr),
         m_frames(nullptr),
+        m_decodeJobs(nullptr),
         m_decoderIndexHead(m_nbDecoderSlots/2),
         m_curNbBlocks(0),
         m_minNbBlocks(256),
@@ -51,10 +52,12 @@ RemoteInputBuffer::RemoteInputBuffer() :
 	m_tvOut_sec = 0;
 	m_tvOut_usec = 0;
 	m_readNbBytes = 1;
-    m_paramsCM256.BlockBytes = sizeof(RemoteProtectedBlock); // never changes
-    m_paramsCM256.OriginalCount = RemoteNbOrginalBlocks;  // never changes
 
-    if (!m_cm256.isInitialized()) {
+    for (int i = 0; i < m_fecPool.getNbContexts(); i++) {
+        m_cm256s.push_back(new CM256());
+    }
+
+    if (!m_cm256s[0]->isInitialized()) {
         m_cm256_OK = false;
         qDebug() << "RemoteInputBuffer::RemoteInputBuffer: cannot initialize CM256 library";
     } else {
@@ -67,6 +70,12 @@ RemoteInputBuffer::RemoteInputBuffer() :
 
 RemoteInputBuffer::~RemoteInputBuffer()
 {
+    waitAllDecoded();
+
+    for (auto cm256 : m_cm256s) {
+        delete cm256;
+    }
+
 	if (m_readBuffer) {
 		delete[] m_readBuffer;
 	}
@@ -76,10 +85,14 @@ RemoteInputBuffer::~RemoteInputBuffer()
     if (m_frames) {
         delete[] m_frames;
     }
+    if (m_decodeJobs) {
+        delete[] m_decodeJobs;
+    }
 }
 
 void RemoteInputBuffer::setNbDecoderSlots(int nbDecoderSlots)
 {
+    waitAllDecoded();
     m_nbDecoderSlots = nbDecoderSlots;
     m_framesSize = m_nbDecoderSlots * (RemoteNbOrginalBlocks - 1) * RemoteNbBytesPerBlock;
   	m_framesNbBytes = m_nbDecoderSlots * sizeof(BufferFrame);
@@ -91,9 +104,19 @@ void RemoteInputBuffer::setNbDecoderSlots(int nbDecoderSlots)
     if (m_frames) {
         delete[] m_frames;
     }
+    if (m_decodeJobs) {
+        delete[] m_decodeJobs;
+    }
 
     m_decoderSlots = new DecoderSlot[m_nbDecoderSlots];
     m_frames = new BufferFrame[m_nbDecoderSlots];
+    m_decodeJobs = new DecodeJob[m_nbDecoderSlots];
+
+    for (int i = 0; i < m_nbDecoderSlots; i++)
+    {
+        m_decodeJobs[i].m_buffer = this;
+        m_decodeJobs[i].m_slotIndex = i;
+    }
 
     m_frameHead = -1;
 }
@@ -105,6 +128,8 @@ void RemoteInputBuffer::setBufferLenSec(const RemoteMetaDataFEC& metaData)
 
 void RemoteInputBuffer::initDecodeAllSlots()
 {
+    waitAllDecoded();
+
     for (int i = 0; i < m_nbDecoderSlots; i++)
     {
         m_decoderSlots[i].m_blockCount = 0;
@@ -241,6 +266,7 @@ void RemoteInputBuffer::writeData(char *array)
     {
         m_decoderIndexHead = decoderIndex; // new decoder slot head
         m_frameHead = frameIndex;          // new frame head
+        waitDecodedSlot(decoderIndex);     // previous frame in this slot must be completed
         checkSlotData(decoderIndex);       // check slot before re-init
         rwCorrectionEstimate(decoderIndex);
         m_nbWrites++;
@@ -278,87 +304,135 @@ void RemoteInputBuffer::writeData(char *array)
 
     if (m_decoderSlots[decoderIndex].m_blockCount == RemoteNbOrginalBlocks) // ready to decode
     {
+        DecodeJob& job = m_decodeJobs[decoderIndex];
         m_decoderSlots[decoderIndex].m_decoded = true;
+        job.m_decode = m_cm256_OK && (m_decoderSlots[decoderIndex].m_recoveryCount > 0); // recovery data used => need to decode FEC
 
-        if (m_cm256_OK && (m_decoderSlots[decoderIndex].m_recoveryCount > 0)) // recovery data used => need to decode FEC
+        if (job.m_decode)
         {
-            m_paramsCM256.BlockBytes = sizeof(RemoteProtectedBlock); // never changes
-            m_paramsCM256.OriginalCount = RemoteNbOrginalBlocks;  // never changes
+            job.m_params.BlockBytes = sizeof(RemoteProtectedBlock); // never changes
+            job.m_params.OriginalCount = RemoteNbOrginalBlocks;  // never changes
 
             if (m_decoderSlots[decoderIndex].m_metaRetrieved) {
-                m_paramsCM256.RecoveryCount = m_currentMeta.m_nbFECBlocks;
+                job.m_params.RecoveryCount = m_currentMeta.m_nbFECBlocks;
             } else {
-                m_paramsCM256.RecoveryCount = m_decoderSlots[decoderIndex].m_recoveryCount;
+                job.m_params.RecoveryCount = m_decoderSlots[decoderIndex].m_recoveryCount;
             }
+        }
 
-            if (m_cm256.cm256_decode(m_paramsCM256, m_decoderSlots[decoderIndex].m_cm256DescriptorBlocks)) // CM256 decode
-            {
-                qDebug() << "RemoteInputBuffer::writeData: decode CM256 error:"
-                        << " decoderIndex: " << decoderIndex
-                        << " m_blockCount: " << m_decoderSlots[decoderIndex].m_blockCount
-                        << " m_originalCount: " << m_decoderSlots[decoderIndex].m_originalCount
-                        << " m_recoveryCount: " << m_decoderSlots[decoderIndex].m_recoveryCount;
-            }
-            else
+        job.m_inFlight = true;
+        m_fecPool.push(&job); // decoded frames are completed in frame order
+    } // decode
+
+    collectDecodedFrames();
+}
+
+void RemoteInputBuffer::DecodeJob::run(int workerIndex)
+{
+    if (m_decode) {
+        m_result = m_buffer->m_cm256s[workerIndex]->cm256_decode(m_params, m_buffer->m_decoderSlots[m_slotIndex].m_cm256DescriptorBlocks);
+    }
+}
+
+void RemoteInputBuffer::completeDecode(DecodeJob *job)
+{
+    int slotIndex = job->m_slotIndex;
+    job->m_inFlight = false;
+
+    if (job->m_decode)
+    {
+        if (job->m_result) // CM256 decode
+        {
+            qDebug() << "RemoteInputBuffer::completeDecode: decode CM256 error:"
+                    << " slotIndex: " << slotIndex
+                    << " m_blockCount: " << m_decoderSlots[slotIndex].m_blockCount
+                    << " m_originalCount: " << m_decoderSlots[slotIndex].m_originalCount
+                    << " m_recoveryCount: " << m_decoderSlots[slotIndex].m_recoveryCount;
+        }
+        else
+        {
+            qDebug() << "RemoteInputBuffer::completeDecode: decode CM256 success:"
+                    << " slotIndex: " << slotIndex
+                    << " m_blockCount: " << m_decoderSlots[slotIndex].m_blockCount
+                    << " m_originalCount: " << m_decoderSlots[slotIndex].m_originalCount
+                    << " m_recoveryCount: " << m_decoderSlots[slotIndex].m_recoveryCount;
+
+            for (int ir = 0; ir < m_decoderSlots[slotIndex].m_recoveryCount; ir++) // restore missing blocks
             {
-                qDebug() << "RemoteInputBuffer::writeData: decode CM256 success:"
-                        << " decoderIndex: " << decoderIndex
-                        << " m_blockCount: " << m_decoderSlots[decoderIndex].m_blockCount
-                        << " m_originalCount: " << m_decoderSlots[decoderIndex].m_originalCount
-                        << " m_recoveryCount: " << m_decoderSlots[decoderIndex].m_recoveryCount;
+                int recoveryIndex = RemoteNbOrginalBlocks - m_decoderSlots[slotIndex].m_recoveryCount + ir;
+                int blockIndex = m_decoderSlots[slotIndex].m_cm256DescriptorBlocks[recoveryIndex].Index;
+                RemoteProtectedBlock *recoveredBlock = (RemoteProtectedBlock *) m_decoderSlots[slotIndex].m_cm256DescriptorBlocks[recoveryIndex].Block;
 
-                for (int ir = 0; ir < m_decoderSlots[decoderIndex].m_recoveryCount; ir++) // restore missing blocks
+                if (blockIndex == 0) // first block with meta
                 {
-                    int recoveryIndex = RemoteNbOrginalBlocks - m_decoderSlots[decoderIndex].m_recoveryCount + ir;
-                    int blockIndex = m_decoderSlots[decoderIndex].m_cm256DescriptorBlocks[recoveryIndex].Index;
-                    RemoteProtectedBlock *recoveredBlock = (RemoteProtectedBlock *) m_decoderSlots[decoderIndex].m_cm256DescriptorBlocks[recoveryIndex].Block;
+                    RemoteMetaDataFEC *metaData = (RemoteMetaDataFEC *) recoveredBlock;
 
-                    if (blockIndex == 0) // first block with meta
+                    boost::crc_32_type crc32;
+                    crc32.process_bytes(metaData, sizeof(RemoteMetaDataFEC)-4);
+
+                    if (crc32.checksum() == metaData->m_crc32)
                     {
-                        RemoteMetaDataFEC *metaData = (RemoteMetaDataFEC *) recoveredBlock;
-
-                        boost::crc_32_type crc32;
-                        crc32.process_bytes(metaData, sizeof(RemoteMetaDataFEC)-4);
-
-                        if (crc32.checksum() == metaData->m_crc32)
-                        {
-                            m_decoderSlots[decoderIndex].m_metaRetrieved = true;
-                            printMeta("RemoteInputBuffer::writeData: recovered meta", metaData);
-                        }
-                        else
-                        {
-                            qDebug() << "RemoteInputBuffer::writeData: recovered meta: invalid CRC32";
-                        }
+                        m_decoderSlots[slotIndex].m_metaRetrieved = true;
+                        printMeta("RemoteInputBuffer::completeDecode: recovered meta", metaData);
                     }
+                    else
+                    {
+                        qDebug() << "RemoteInputBuffer::completeDecode: recovered meta: invalid CRC32";
+                    }
+                }
+
+                storeOriginalBlock(slotIndex, blockIndex, *recoveredBlock);
 
-                    storeOriginalBlock(decoderIndex, blockIndex, *recoveredBlock);
+                qDebug() << "RemoteInputBuffer::completeDecode: recovered block #" << blockIndex;
+            } // restore missing blocks
+        } // CM256 decode
+    } // recovery
 
-                    qDebug() << "RemoteInputBuffer::writeData: recovered block #" << blockIndex;
-                } // restore missing blocks
-            } // CM256 decode
-        } // recovery
+    if (m_decoderSlots[slotIndex].m_metaRetrieved) // block zero with its meta data has been received
+    {
+        RemoteMetaDataFEC *metaData = getMetaData(slotIndex);
 
-        if (m_decoderSlots[decoderIndex].m_metaRetrieved) // block zero with its meta data has been received
+        if (!(*metaData == m_currentMeta))
         {
-            RemoteMetaDataFEC *metaData = getMetaData(decoderIndex);
+            uint32_t sampleRate =  metaData->m_sampleRate;
 
-            if (!(*metaData == m_currentMeta))
+            if (sampleRate != 0)
             {
-                uint32_t sampleRate =  metaData->m_sampleRate;
+                setBufferLenSec(*metaData);
+                m_balCorrLimit = sampleRate / 400; // +/- 5% correction max per read
+                m_readNbBytes = (sampleRate * metaData->m_sampleBytes * 2) / 20;
+            }
 
-                if (sampleRate != 0)
-                {
-                    setBufferLenSec(*metaData);
-                    m_balCorrLimit = sampleRate / 400; // +/- 5% correction max per read
-                    m_readNbBytes = (sampleRate * metaData->m_sampleBytes * 2) / 20;
-                }
+            printMeta("RemoteInputBuffer::completeDecode: new meta", metaData); // print for change other than timestamp
+        }
 
-                printMeta("RemoteInputBuffer::writeData: new meta", metaData); // print for change other than timestamp
-            }
+        m_currentMeta = *metaData; // renew current meta
+    } // check block 0
+}
 
-            m_currentMeta = *metaData; // renew current meta
-        } // check block 0
-    } // decode
+void RemoteInputBuffer::collectDecodedFrames()
+{
+    RemoteFECPool::Job *job;
+
+    while ((job = m_fecPool.pop(false))) {
+        completeDecode(static_cast<DecodeJob*>(job));
+    }
+}
+
+void RemoteInputBuffer::waitDecodedSlot(int slotIndex)
+{
+    while (m_decodeJobs[slotIndex].m_inFlight) {
+        completeDecode(static_cast<DecodeJob*>(m_fecPool.pop(true)));
+    }
+}
+
+void RemoteInputBuffer::waitAllDecoded()
+{
+    RemoteFECPool::Job *job;
+
+    while ((job = m_fecPool.pop(true))) {
+        completeDecode(static_cast<DecodeJob*>(job));
+    }
 }
 
 uint8_t *RemoteInputBuffer::readData(int32_t length)
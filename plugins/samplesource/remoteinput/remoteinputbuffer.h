@@ -22,8 +22,10 @@
 #include <QString>
 #include <QDebug>
 #include <cstdlib>
+#include <vector>
 #include "cm256cc/cm256.h"
 #include "util/movingaverage.h"
+#include "channel/remotefecpool.h"
 
 
 #define REMOTEINPUT_UDPSIZE 512               // UDP payload size
@@ -135,8 +137,20 @@ private:
         DecoderSlot() {}
     };
 
+    class DecodeJob : public RemoteFECPool::Job //!< one per decoder slot
+    {
+    public:
+        DecodeJob() : m_buffer(nullptr), m_slotIndex(0), m_decode(false), m_result(0), m_inFlight(false) {}
+        virtual void run(int workerIndex);
+        RemoteInputBuffer *m_buffer;
+        int m_slotIndex;
+        CM256::cm256_encoder_params m_params;
+        bool m_decode;    //!< recovery data used => need to decode FEC
+        int m_result;     //!< CM256 decoder return code
+        bool m_inFlight;  //!< pushed to the FEC pool and not completed yet
+    };
+
     RemoteMetaDataFEC m_currentMeta;             //!< Stored current meta data
-    CM256::cm256_encoder_params m_paramsCM256;   //!< CM256 decoder parameters block
     DecoderSlot          *m_decoderSlots;        //!< CM256 decoding control/buffer slots
     BufferFrame          *m_frames;              //!< Samples buffer
     int                  m_framesNbBytes;        //!< Number of bytes in samples buffer
@@ -167,7 +181,9 @@ private:
     int      m_nbWrites;      //!< Number of buffer writes since start of auto R/W balance correction period
     int      m_balCorrection; //!< R/W balance correction in number of samples
     int      m_balCorrLimit;  //!< Correction absolute value limit in number of samples
-    CM256    m_cm256;         //!< CM256 library
+    RemoteFECPool        m_fecPool;    //!< CM256 decoding workers
+    std::vector<CM256*>  m_cm256s;     //!< CM256 library one per FEC worker
+    DecodeJob           *m_decodeJobs; //!< one per decoder slot
     bool     m_cm256_OK;      //!< CM256 library initialized OK
 
     inline RemoteProtectedBlock* storeOriginalBlock(int slotIndex, int blockIndex, const RemoteProtectedBlock& protectedBlock)
@@ -214,6 +230,10 @@ private:
     void rwCorrectionEstimate(int slotIndex);
     void checkSlotData(int slotIndex);
     void initDecodeSlot(int slotIndex);
+    void completeDecode(DecodeJob *job);
+    void collectDecodedFrames();
+    void waitDecodedSlot(int slotIndex);
+    void waitAllDecoded();
 
     static void printMeta(const QString& header, RemoteMetaDataFEC *metaData);
 };
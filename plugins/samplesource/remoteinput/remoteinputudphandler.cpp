@@ -15,7 +15,6 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.          //
 ///////////////////////////////////////////////////////////////////////////////////
 
-#include <QUdpSocket>
 #include <QDebug>
 #include <QTimer>
 
@@ -35,15 +34,13 @@ RemoteInputUDPHandler::RemoteInputUDPHandler(SampleSinkFifo *sampleFifo, DeviceA
     m_masterTimerConnected(false),
     m_running(false),
     m_rateDivider(1000/REMOTEINPUT_THROTTLE_MS),
-	m_dataSocket(0),
 	m_dataAddress(QHostAddress::LocalHost),
 	m_remoteAddress(QHostAddress::LocalHost),
 	m_dataPort(9090),
     m_multicastAddress(QStringLiteral("224.0.0.1")),
     m_multicast(false),
 	m_dataConnected(false),
-	m_udpBuf(0),
-	m_udpReadBytes(0),
+	m_udpReceiver(nullptr),
 	m_sampleFifo(sampleFifo),
 	m_samplerate(0),
 	m_centerFrequency(0),
@@ -60,7 +57,7 @@ RemoteInputUDPHandler::RemoteInputUDPHandler(SampleSinkFifo *sampleFifo, DeviceA
     m_throttleToggle(false),
 	m_autoCorrBuffer(true)
 {
-    m_udpBuf = new char[RemoteUdpSize];
+    m_udpReceiver = new RemoteUDPReceiver(this);
 
 #ifdef USE_INTERNAL_TIMER
 #warning "Uses internal timer"
@@ -78,7 +75,6 @@ RemoteInputUDPHandler::RemoteInputUDPHandler(SampleSinkFifo *sampleFifo, DeviceA
 RemoteInputUDPHandler::~RemoteInputUDPHandler()
 {
 	stop();
-	delete[] m_udpBuf;
 	if (m_converterBuffer) { delete[] m_converterBuffer; }
 #ifdef USE_INTERNAL_TIMER
     if (m_timer) {
@@ -95,26 +91,12 @@ void RemoteInputUDPHandler::start()
 	    return;
 	}
 
-	if (!m_dataSocket) {
-		m_dataSocket = new QUdpSocket(this);
-	}
-
     if (!m_dataConnected)
 	{
-        if (m_dataSocket->bind(m_multicast ? QHostAddress::AnyIPv4 : m_dataAddress, m_dataPort, QUdpSocket::ShareAddress))
+        if (m_udpReceiver->open(m_multicast ? QHostAddress(QHostAddress::AnyIPv4) : m_dataAddress, m_dataPort, m_multicast, m_multicastAddress))
 		{
 			qDebug("RemoteInputUDPHandler::start: bind data socket to %s:%d", m_dataAddress.toString().toStdString().c_str(),  m_dataPort);
-
-            if (m_multicast)
-            {
-                if (m_dataSocket->joinMulticastGroup(m_multicastAddress)) {
-                    qDebug("RemoteInputUDPHandler::start: joined multicast group %s", qPrintable(m_multicastAddress.toString()));
-                } else {
-                    qDebug("RemoteInputUDPHandler::start: failed joining multicast group %s", qPrintable(m_multicastAddress.toString()));
-                }
-            }
-
-            connect(m_dataSocket, SIGNAL(readyRead()), this, SLOT(dataReadyRead())); //, Qt::QueuedConnection);
+            connect(m_udpReceiver, SIGNAL(dataReady()), this, SLOT(dataReadyRead()));
 			m_dataConnected = true;
 		}
 		else
@@ -141,14 +123,10 @@ void RemoteInputUDPHandler::stop()
     if (m_dataConnected)
     {
 		m_dataConnected = false;
-	    disconnect(m_dataSocket, SIGNAL(readyRead()), this, SLOT(dataReadyRead()));
+	    disconnect(m_udpReceiver, SIGNAL(dataReady()), this, SLOT(dataReadyRead()));
 	}
 
-	if (m_dataSocket)
-	{
-		delete m_dataSocket;
-		m_dataSocket = 0;
-	}
+	m_udpReceiver->close();
 
 	m_centerFrequency = 0;
 	m_samplerate = 0;
@@ -193,23 +171,24 @@ void RemoteInputUDPHandler::applyUDPLink(const QString& address, quint16 port, c
 
 void RemoteInputUDPHandler::dataReadyRead()
 {
-    m_udpReadBytes = 0;
+    int nbDatagrams;
 
-	while (m_dataSocket->hasPendingDatagrams() && m_dataConnected)
-	{
-		qint64 pendingDataSize = m_dataSocket->pendingDatagramSize();
-		m_udpReadBytes += m_dataSocket->readDatagram(&m_udpBuf[m_udpReadBytes], pendingDataSize, &m_remoteAddress, 0);
+    while (m_dataConnected && ((nbDatagrams = m_udpReceiver->readBatch()) > 0))
+    {
+        for (int i = 0; i < nbDatagrams; i++)
+        {
+            if (m_udpReceiver->getDatagramSize(i) == RemoteUdpSize) {
+                processData(m_udpReceiver->getDatagram(i));
+            }
+        }
 
-		if (m_udpReadBytes == RemoteUdpSize) {
-		    processData();
-		    m_udpReadBytes = 0;
-		}
-	}
+        m_remoteAddress = m_udpReceiver->getSenderAddress();
+    }
 }
 
-void RemoteInputUDPHandler::processData()
+void RemoteInputUDPHandler::processData(char *udpBuf)
 {
-    m_remoteInputBuffer.writeData(m_udpBuf);
+    m_remoteInputBuffer.writeData(udpBuf);
     const RemoteMetaDataFEC& metaData =  m_remoteInputBuffer.getCurrentMeta();
     bool change = false;
 
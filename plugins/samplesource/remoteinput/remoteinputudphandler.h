@@ -25,6 +25,7 @@
 #include <QElapsedTimer>
 
 #include "util/messagequeue.h"
+#include "channel/remoteudpreceiver.h"
 #include "remoteinputbuffer.h"
 
 #define REMOTEINPUT_THROTTLE_MS 50
@@ -113,15 +114,13 @@ private:
 	bool m_running;
     uint32_t m_rateDivider;
 	RemoteInputBuffer m_remoteInputBuffer;
-	QUdpSocket *m_dataSocket;
 	QHostAddress m_dataAddress;
 	QHostAddress m_remoteAddress;
 	quint16 m_dataPort;
 	QHostAddress m_multicastAddress;
 	bool m_multicast;
 	bool m_dataConnected;
-	char *m_udpBuf;
-	qint64 m_udpReadBytes;
+	RemoteUDPReceiver *m_udpReceiver;
 	SampleSinkFifo *m_sampleFifo;
 	uint32_t m_samplerate;
 	uint64_t m_centerFrequency;
@@ -145,7 +144,7 @@ private:
 
 	void connectTimer();
     void disconnectTimer();
-	void processData();
+	void processData(char *udpBuf);
     void adjustNbDecoderSlots(const RemoteMetaDataFEC& metaData);
 	void applyUDPLink(const QString& address, quint16 port, const QString& multicastAddress, bool muticastJoin);
 	bool handleMessage(const Message& message);
@@ -17,30 +17,28 @@
 ///////////////////////////////////////////////////////////////////////////////////
 
 #include <string.h>
-#include <QTime>
+#include <algorithm>
+#include <QThread>
 #include "dsp/dsptypes.h"
 #include "audio/audiofifo.h"
-#include "audio/audionetsink.h"
-
-#define MIN(x, y) ((x) < (y) ? (x) : (y))
 
 AudioFifo::AudioFifo() :
+	m_transfers(0),
+	m_resizing(false),
 	m_fifo(0),
 	m_sampleSize(sizeof(AudioSample))
 {
 	m_size = 0;
-	m_fill = 0;
-	m_head = 0;
-	m_tail = 0;
 }
 
 AudioFifo::AudioFifo(uint32_t numSamples) :
+	m_transfers(0),
+	m_resizing(false),
 	m_fifo(0),
-    m_sampleSize(sizeof(AudioSample))
+	m_sampleSize(sizeof(AudioSample))
 {
-	QMutexLocker mutexLocker(&m_mutex);
-
-	create(numSamples);
+	m_size = 0;
+	setSize(numSamples);
 }
 
 AudioFifo::~AudioFifo()
@@ -60,106 +58,132 @@ bool AudioFifo::setSize(uint32_t numSamples)
 {
 	QMutexLocker mutexLocker(&m_mutex);
 
-	return create(numSamples);
+	m_resizing.store(true);
+
+	// the transfers in progress are short: spin until they complete
+	while (m_transfers.load() != 0) {
+		QThread::yieldCurrentThread();
+	}
+
+	bool res = create(numSamples);
+	m_resizing.store(false);
+
+	return res;
 }
 
-uint AudioFifo::write(const quint8* data, uint32_t numSamples)
+bool AudioFifo::beginTransfer()
 {
-	uint32_t total;
-	uint32_t remaining;
-	uint32_t copyLen;
+	// sequentially consistent with setSize: either it sees this transfer or this sees the resize
+	m_transfers.fetch_add(1);
 
-	if (m_fifo == 0) {
+	if (m_resizing.load())
+	{
+		m_transfers.fetch_sub(1);
+		return false;
+	}
+
+	return true;
+}
+
+uint32_t AudioFifo::write(const quint8* data, uint32_t numSamples)
+{
+	if (!beginTransfer()) {
 		return 0;
 	}
 
-	m_mutex.lock();
+	if (m_size == 0)
+	{
+		endTransfer();
+		return 0;
+	}
 
-	total = MIN(numSamples, m_size - m_fill);
-	remaining = total;
+	quint64 tail = m_tail.m_value.load(std::memory_order_relaxed);
+	uint32_t fill = tail - m_head.m_value.load(std::memory_order_acquire);
+	uint32_t total = std::min(numSamples, m_size - fill);
+	uint32_t remaining = total;
+	uint32_t index = tail % m_size;
 
 	while (remaining != 0)
 	{
-		if (isFull())
-		{
-			m_mutex.unlock();
-			return total - remaining; // written so far
-		}
-
-		copyLen = MIN(remaining, m_size - m_fill);
-		copyLen = MIN(copyLen, m_size - m_tail);
-		memcpy(m_fifo + (m_tail * m_sampleSize), data, copyLen * m_sampleSize);
-		m_tail += copyLen;
-		m_tail %= m_size;
-		m_fill += copyLen;
+		uint32_t copyLen = std::min(remaining, m_size - index);
+		memcpy(m_fifo + (index * m_sampleSize), data, copyLen * m_sampleSize);
+		index = (index + copyLen) % m_size;
 		data += copyLen * m_sampleSize;
 		remaining -= copyLen;
 	}
 
-	m_mutex.unlock();
+	m_tail.m_value.store(tail + total, std::memory_order_release);
+	endTransfer();
+
 	return total;
 }
 
-uint AudioFifo::read(quint8* data, uint32_t numSamples)
+uint32_t AudioFifo::read(quint8* data, uint32_t numSamples)
 {
-	uint32_t total;
-	uint32_t remaining;
-	uint32_t copyLen;
-
-	if (m_fifo == 0) {
+	if (!beginTransfer()) {
 		return 0;
 	}
 
-	m_mutex.lock();
+	if (m_size == 0)
+	{
+		endTransfer();
+		return 0;
+	}
 
-	total = MIN(numSamples, m_fill);
-	remaining = total;
+	quint64 head = m_head.m_value.load(std::memory_order_relaxed);
+	uint32_t fill = m_tail.m_value.load(std::memory_order_acquire) - head;
+	uint32_t total = std::min(numSamples, fill);
+	uint32_t remaining = total;
+	uint32_t index = head % m_size;
 
 	while (remaining != 0)
 	{
-		if (isEmpty())
-		{
-			m_mutex.unlock();
-			return total - remaining; // read so far
-		}
-
-		copyLen = MIN(remaining, m_fill);
-		copyLen = MIN(copyLen, m_size - m_head);
-		memcpy(data, m_fifo + (m_head * m_sampleSize), copyLen * m_sampleSize);
-
-		m_head += copyLen;
-		m_head %= m_size;
-		m_fill -= copyLen;
+		uint32_t copyLen = std::min(remaining, m_size - index);
+		memcpy(data, m_fifo + (index * m_sampleSize), copyLen * m_sampleSize);
+		index = (index + copyLen) % m_size;
 		data += copyLen * m_sampleSize;
 		remaining -= copyLen;
 	}
 
-	m_mutex.unlock();
+	// fails only if the producer has cleared the FIFO in the meantime
+	m_head.m_value.compare_exchange_strong(head, head + total, std::memory_order_release, std::memory_order_relaxed);
+	endTransfer();
+
 	return total;
 }
 
-uint AudioFifo::drain(uint32_t numSamples)
+uint32_t AudioFifo::drain(uint32_t numSamples)
 {
-	QMutexLocker mutexLocker(&m_mutex);
+	if (!beginTransfer()) {
+		return 0;
+	}
 
-	if(numSamples > m_fill)
-	{
-		numSamples = m_fill;
+	quint64 head = m_head.m_value.load(std::memory_order_relaxed);
+	uint32_t fill = m_tail.m_value.load(std::memory_order_acquire) - head;
+
+	if (numSamples > fill) {
+		numSamples = fill;
 	}
 
-	m_head = (m_head + numSamples) % m_size;
-	m_fill -= numSamples;
+	m_head.m_value.compare_exchange_strong(head, head + numSamples, std::memory_order_release, std::memory_order_relaxed);
+	endTransfer();
 
 	return numSamples;
 }
 
 void AudioFifo::clear()
 {
-	QMutexLocker mutexLocker(&m_mutex);
+	if (!beginTransfer()) {
+		return; // the resize clears the FIFO
+	}
+
+	// the consumer only moves the head forward up to the tail
+	quint64 tail = m_tail.m_value.load(std::memory_order_relaxed);
+	quint64 head = m_head.m_value.load(std::memory_order_relaxed);
+
+	while ((head < tail) && !m_head.m_value.compare_exchange_weak(head, tail, std::memory_order_release, std::memory_order_relaxed));
 
-	m_fill = 0;
-	m_head = 0;
-	m_tail = 0;
+	endTransfer();
 }
 
 bool AudioFifo::create(uint32_t numSamples)
@@ -170,9 +194,8 @@ bool AudioFifo::create(uint32_t numSamples)
 		m_fifo = 0;
 	}
 
-	m_fill = 0;
-	m_head = 0;
-	m_tail = 0;
+	m_head.m_value.store(0);
+	m_tail.m_value.store(0);
 
 	m_fifo = new qint8[numSamples * m_sampleSize];
 	m_size = numSamples;
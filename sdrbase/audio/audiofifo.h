@@ -19,13 +19,26 @@
 #ifndef INCLUDE_AUDIOFIFO_H
 #define INCLUDE_AUDIOFIFO_H
 
+#include <atomic>
+
 #include <QObject>
 #include <QMutex>
-#include <QWaitCondition>
 
 #include "dsp/dsptypes.h"
 #include "export.h"
 
+/**
+ * Lock-free single producer / single consumer audio FIFO.
+ *
+ * write() and clear() must be called from one thread only (producer) and read(), drain() and flush()
+ * from one (possibly other) thread only (consumer). Head and tail are monotonic 64 bit sample counters
+ * living on separate cache lines so that the fill is simply their difference.
+ *
+ * setSize() may be called from any thread while data is being transferred: it waits for the transfers
+ * in progress to complete while the transfers that start during the resize return 0 immediately.
+ * Thus neither side ever blocks on the other. clear() races with a read in progress only in that
+ * this read may return samples written after the clear.
+ */
 class SDRBASE_API AudioFifo : public QObject {
 	Q_OBJECT
 public:
@@ -41,25 +54,33 @@ public:
 	uint32_t drain(uint32_t numSamples);
 	void clear();
 
-	inline uint32_t flush() { return drain(m_fill); }
-	inline uint32_t fill() const { return m_fill; }
-	inline bool isEmpty() const { return m_fill == 0; }
-	inline bool isFull() const { return m_fill == m_size; }
+	inline uint32_t flush() { return drain(fill()); }
+	inline uint32_t fill() const { return m_tail.m_value.load(std::memory_order_acquire) - m_head.m_value.load(std::memory_order_acquire); }
+	inline bool isEmpty() const { return fill() == 0; }
+	inline bool isFull() const { return fill() == m_size; }
 	inline uint32_t size() const { return m_size; }
 
 private:
-	QMutex m_mutex;
+	struct alignas(64) Counter {
+		std::atomic<quint64> m_value;
+		Counter() : m_value(0) {}
+	};
+
+	Counter m_head; //!< consumer position
+	Counter m_tail; //!< producer position
+	std::atomic<int> m_transfers;  //!< reads and writes in progress
+	std::atomic<bool> m_resizing;  //!< transfers are refused while the buffer is reallocated
+	QMutex m_mutex;                //!< serializes the resizes
 
 	qint8* m_fifo;
 
 	const uint32_t m_sampleSize;
 
 	uint32_t m_size;
-	uint32_t m_fill;
-	uint32_t m_head;
-	uint32_t m_tail;
 
 	bool create(uint32_t numSamples);
+	bool beginTransfer();
+	void endTransfer() { m_transfers.fetch_sub(1); }
 };
 
 #endif // INCLUDE_AUDIOFIFO_H
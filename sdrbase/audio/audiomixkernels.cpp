@@ -0,0 +1,191 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <QDebug>
+
+#include "audiomixkernels.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define AUDIOMIX_X86
+#define AUDIOMIX_TARGET(arch) __attribute__((target(arch)))
+#elif defined(_MSC_VER) && (defined(_M_AMD64) || defined(_M_IX86))
+#include <immintrin.h>
+#define AUDIOMIX_X86
+#define AUDIOMIX_TARGET(arch)
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define AUDIOMIX_NEON
+#endif
+
+static void accumulateGeneric(const qint16 *in, qint32 *mix, unsigned int n)
+{
+    for (unsigned int i = 0; i < n; i++) {
+        mix[i] += in[i];
+    }
+}
+
+static void saturateGeneric(const qint32 *mix, qint16 *out, unsigned int n)
+{
+    for (unsigned int i = 0; i < n; i++) {
+        out[i] = mix[i] < -32768 ? -32768 : mix[i] > 32767 ? 32767 : mix[i];
+    }
+}
+
+#if defined(AUDIOMIX_X86)
+AUDIOMIX_TARGET("sse2")
+static void accumulateSSE2(const qint16 *in, qint32 *mix, unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i *) &in[i]);
+        // sign extension: the sample in the upper half shifted back arithmetically
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        _mm_storeu_si128((__m128i *) &mix[i], _mm_add_epi32(_mm_loadu_si128((const __m128i *) &mix[i]), lo));
+        _mm_storeu_si128((__m128i *) &mix[i + 4], _mm_add_epi32(_mm_loadu_si128((const __m128i *) &mix[i + 4]), hi));
+    }
+
+    accumulateGeneric(in + i, mix + i, n - i);
+}
+
+AUDIOMIX_TARGET("sse2")
+static void saturateSSE2(const qint32 *mix, qint16 *out, unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *) &mix[i]);
+        __m128i b = _mm_loadu_si128((const __m128i *) &mix[i + 4]);
+        _mm_storeu_si128((__m128i *) &out[i], _mm_packs_epi32(a, b));
+    }
+
+    saturateGeneric(mix + i, out + i, n - i);
+}
+
+AUDIOMIX_TARGET("avx2")
+static void accumulateAVX2(const qint16 *in, qint32 *mix, unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) &in[i]));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) &in[i + 8]));
+        _mm256_storeu_si256((__m256i *) &mix[i], _mm256_add_epi32(_mm256_loadu_si256((const __m256i *) &mix[i]), lo));
+        _mm256_storeu_si256((__m256i *) &mix[i + 8], _mm256_add_epi32(_mm256_loadu_si256((const __m256i *) &mix[i + 8]), hi));
+    }
+
+    accumulateSSE2(in + i, mix + i, n - i);
+}
+
+AUDIOMIX_TARGET("avx2")
+static void saturateAVX2(const qint32 *mix, qint16 *out, unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *) &mix[i]);
+        __m256i b = _mm256_loadu_si256((const __m256i *) &mix[i + 8]);
+        // packing within 128 bit lanes gives a0 b0 | a1 b1
+        __m256i p = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i *) &out[i], p);
+    }
+
+    saturateSSE2(mix + i, out + i, n - i);
+}
+#endif // AUDIOMIX_X86
+
+#if defined(AUDIOMIX_NEON)
+static void accumulateNEON(const qint16 *in, qint32 *mix, unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        int16x8_t x = vld1q_s16(&in[i]);
+        vst1q_s32(&mix[i], vaddw_s16(vld1q_s32(&mix[i]), vget_low_s16(x)));
+        vst1q_s32(&mix[i + 4], vaddw_s16(vld1q_s32(&mix[i + 4]), vget_high_s16(x)));
+    }
+
+    accumulateGeneric(in + i, mix + i, n - i);
+}
+
+static void saturateNEON(const qint32 *mix, qint16 *out, unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        vst1q_s16(&out[i], vcombine_s16(vqmovn_s32(vld1q_s32(&mix[i])), vqmovn_s32(vld1q_s32(&mix[i + 4]))));
+    }
+
+    saturateGeneric(mix + i, out + i, n - i);
+}
+#endif // AUDIOMIX_NEON
+
+const AudioMixKernels& AudioMixKernels::instance()
+{
+    static AudioMixKernels kernels;
+    return kernels;
+}
+
+AudioMixKernels::AudioMixKernels()
+{
+    getKernels(CPUFeatures::instance().getBestLevel(), m_accumulate, m_saturate, m_level);
+    qInfo("AudioMixKernels::AudioMixKernels: using %s audio mixer kernels", CPUFeatures::getLevelName(m_level));
+}
+
+void AudioMixKernels::getKernels(CPUFeatures::SIMDLevel level, Accumulate& accumulate, Saturate& saturate, CPUFeatures::SIMDLevel& actualLevel)
+{
+    const CPUFeatures& cpu = CPUFeatures::instance();
+    (void) cpu;
+
+#if defined(AUDIOMIX_X86)
+    if (((level == CPUFeatures::SIMDAVX2) || (level == CPUFeatures::SIMDAVX512)) && cpu.hasAVX2())
+    {
+        accumulate = accumulateAVX2;
+        saturate = saturateAVX2;
+        actualLevel = CPUFeatures::SIMDAVX2;
+        return;
+    }
+    else if ((level >= CPUFeatures::SIMDSSE2) && (level != CPUFeatures::SIMDNEON) && cpu.hasSSE2())
+    {
+        accumulate = accumulateSSE2;
+        saturate = saturateSSE2;
+        actualLevel = CPUFeatures::SIMDSSE2;
+        return;
+    }
+#elif defined(AUDIOMIX_NEON)
+    if ((level == CPUFeatures::SIMDNEON) && cpu.hasNEON())
+    {
+        accumulate = accumulateNEON;
+        saturate = saturateNEON;
+        actualLevel = CPUFeatures::SIMDNEON;
+        return;
+    }
+#else
+    (void) level;
+#endif
+
+    accumulate = accumulateGeneric;
+    saturate = saturateGeneric;
+    actualLevel = CPUFeatures::SIMDGeneric;
+}
@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_AUDIO_AUDIOMIXKERNELS_H_
+#define SDRBASE_AUDIO_AUDIOMIXKERNELS_H_
+
+#include <QtGlobal>
+
+#include "util/cpufeatures.h"
+#include "export.h"
+
+/**
+ * Audio mixer kernels selected at run time for the host CPU.
+ *
+ * accumulate adds 16 bit samples to the 32 bit mix: mix[i] += in[i]
+ * saturate converts the mix back to 16 bit samples: out[i] = clamp(mix[i], -32768, 32767)
+ *
+ * Sums are exact up to 65536 sources so the result does not depend on the order of the sources
+ * and all kernels give the same result.
+ */
+class SDRBASE_API AudioMixKernels
+{
+public:
+    typedef void (*Accumulate)(const qint16 *in, qint32 *mix, unsigned int n);
+    typedef void (*Saturate)(const qint32 *mix, qint16 *out, unsigned int n);
+
+    static const AudioMixKernels& instance();
+
+    Accumulate getAccumulate() const { return m_accumulate; }
+    Saturate getSaturate() const { return m_saturate; }
+    CPUFeatures::SIMDLevel getLevel() const { return m_level; }
+    static void getKernels(CPUFeatures::SIMDLevel level, Accumulate& accumulate, Saturate& saturate, CPUFeatures::SIMDLevel& actualLevel); //!< specific kernels (benchmarks). Falls back to generic if not available.
+
+private:
+    AudioMixKernels();
+
+    Accumulate m_accumulate;
+    Saturate m_saturate;
+    CPUFeatures::SIMDLevel m_level;
+};
+
+#endif // SDRBASE_AUDIO_AUDIOMIXKERNELS_H_
@@ -35,6 +35,8 @@ AudioOutput::AudioOutput() :
 	m_onExit(false),
 	m_audioFifos()
 {
+	m_accumulate = AudioMixKernels::instance().getAccumulate();
+	m_saturate = AudioMixKernels::instance().getSaturate();
 }
 
 AudioOutput::~AudioOutput()
@@ -222,12 +224,6 @@ qint64 AudioOutput::readData(char* data, qint64 maxLen)
 {
     //qDebug("AudioOutput::readData: %lld", maxLen);
 
-    // Study this mutex on OSX, for now deadlocks possible
-    // Removed as it may indeed cause lockups and is in fact useless.
-//#ifndef __APPLE__
-//    QMutexLocker mutexLocker(&m_mutex);
-//#endif
-
 	unsigned int samplesPerBuffer = maxLen / 4;
 
 	if (samplesPerBuffer == 0)
@@ -247,88 +243,48 @@ qint64 AudioOutput::readData(char* data, qint64 maxLen)
 
 	memset(&m_mixBuffer[0], 0x00, 2 * samplesPerBuffer * sizeof(m_mixBuffer[0])); // start with silence
 
-	// sum up a block from all fifos
-
-	for (std::list<AudioFifo*>::iterator it = m_audioFifos.begin(); it != m_audioFifos.end(); ++it)
+	// The audio callback never waits: the FIFOs are lock-free and if the list of FIFOs is being
+	// changed this buffer is silent. Holding the mutex while mixing ensures a removed FIFO is not read anymore.
+	if (m_mutex.tryLock())
 	{
-		// use outputBuffer as temp - yes, one memcpy could be saved
-		unsigned int samples = (*it)->read((quint8*) data, samplesPerBuffer);
-		const qint16* src = (const qint16*) data;
-		std::vector<qint32>::iterator dst = m_mixBuffer.begin();
-
-//		if (samples != framesPerBuffer)
-//		{
-//            qDebug("AudioOutput::readData: read %d samples vs %d requested", samples, framesPerBuffer);
-//		}
-
-		for (unsigned int i = 0; i < samples; i++)
+		// sum up a block from all fifos
+		for (std::list<AudioFifo*>::iterator it = m_audioFifos.begin(); it != m_audioFifos.end(); ++it)
 		{
-			*dst += *src;
-			++src;
-			++dst;
-			*dst += *src;
-			++src;
-			++dst;
+			// use outputBuffer as temp - yes, one memcpy could be saved
+			unsigned int samples = (*it)->read((quint8*) data, samplesPerBuffer);
+			m_accumulate((const qint16*) data, m_mixBuffer.data(), 2 * samples);
 		}
-    }
-	// convert to int16
 
-	//std::vector<qint32>::const_iterator src = m_mixBuffer.begin(); // Valgrind optim
+		m_mutex.unlock();
+	}
+
+	// convert to int16
 	qint16* dst = (qint16*) data;
-	qint32 sl, sr;
+	m_saturate(m_mixBuffer.data(), dst, 2 * samplesPerBuffer);
 
-	for (unsigned int i = 0; i < samplesPerBuffer; i++)
+	if ((m_copyAudioToUdp) && (m_audioNetSink))
 	{
-		// left channel
-
-		//s = *src++; // Valgrind optim
-		sl = m_mixBuffer[2*i];
-
-		if(sl < -32768)
-		{
-			sl = -32768;
-		}
-		else if (sl > 32767)
-		{
-			sl = 32767;
-		}
-
-		*dst++ = sl;
-
-		// right channel
-
-		//s = *src++; // Valgrind optim
-		sr = m_mixBuffer[2*i + 1];
-
-		if(sr < -32768)
-		{
-			sr = -32768;
-		}
-		else if (sr > 32767)
-		{
-			sr = 32767;
-		}
-
-		*dst++ = sr;
-
-		if ((m_copyAudioToUdp) && (m_audioNetSink))
+		for (unsigned int i = 0; i < samplesPerBuffer; i++)
 		{
-	        switch (m_udpChannelMode)
-	        {
-            case UDPChannelStereo:
-                m_audioNetSink->write(sl, sr);
-                break;
-            case UDPChannelMixed:
-                m_audioNetSink->write((sl+sr)/2);
-                break;
-            case UDPChannelRight:
-                m_audioNetSink->write(sr);
-                break;
-	        case UDPChannelLeft:
-	        default:
-	            m_audioNetSink->write(sl);
-	            break;
-	        }
+			qint16 sl = dst[2*i];
+			qint16 sr = dst[2*i + 1];
+
+			switch (m_udpChannelMode)
+			{
+			case UDPChannelStereo:
+				m_audioNetSink->write(sl, sr);
+				break;
+			case UDPChannelMixed:
+				m_audioNetSink->write((sl+sr)/2);
+				break;
+			case UDPChannelRight:
+				m_audioNetSink->write(sr);
+				break;
+			case UDPChannelLeft:
+			default:
+				m_audioNetSink->write(sl);
+				break;
+			}
 		}
 	}
 
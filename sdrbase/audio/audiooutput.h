@@ -25,6 +25,7 @@
 #include <list>
 #include <vector>
 #include <stdint.h>
+#include "audio/audiomixkernels.h"
 #include "export.h"
 
 class QAudioOutput;
@@ -84,6 +85,8 @@ private:
 
 	std::list<AudioFifo*> m_audioFifos;
 	std::vector<qint32> m_mixBuffer;
+	AudioMixKernels::Accumulate m_accumulate;
+	AudioMixKernels::Saturate m_saturate;
 
 	QAudioFormat m_audioFormat;
 
@@ -126,7 +126,8 @@ struct RemoteTxControlBlock
     bool m_processed;
     uint16_t m_frameIndex;
     int m_nbBlocksFEC;
-    int m_txDelay;
+    int m_txDelay;         //!< delay between consecutive UDP blocks in microseconds
+    double m_txRate;       //!< UDP blocks per second for senders pacing with a token bucket (0: use m_txDelay)
     QString m_dataAddress;
     uint16_t m_dataPort;
 
@@ -136,6 +137,7 @@ struct RemoteTxControlBlock
         m_frameIndex = 0;
         m_nbBlocksFEC = 0;
         m_txDelay = 100;
+        m_txRate = 0.0;
         m_dataAddress = "127.0.0.1";
         m_dataPort = 9090;
     }
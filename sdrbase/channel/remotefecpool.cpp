@@ -0,0 +1,150 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// Remote data FEC encoding and decoding worker pool                             //
+//                                                                               //
+// SDRangel can serve as a remote SDR front end that handles the interface       //
+// with a physical device and sends or receives the I/Q samples stream via UDP   //
+// to or from another SDRangel instance or any program implementing the same     //
+// protocol. The remote SDRangel is controlled via its Web REST API.             //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+
+#include <QMutexLocker>
+#include <QDebug>
+
+#include "remotefecpool.h"
+
+const int RemoteFECPool::m_maxWorkers;
+
+RemoteFECPool::RemoteFECPool(int nbWorkers) :
+    m_headSeq(0),
+    m_nextSeq(0),
+    m_stop(false)
+{
+    if (nbWorkers < 0) {
+        nbWorkers = getDefaultNbWorkers();
+    }
+
+    for (int i = 0; i < nbWorkers; i++)
+    {
+        m_workers.push_back(new Worker(this, i));
+        m_workers.back()->start();
+    }
+
+    qDebug("RemoteFECPool::RemoteFECPool: %d workers", nbWorkers);
+}
+
+RemoteFECPool::~RemoteFECPool()
+{
+    m_mutex.lock();
+    m_stop = true;
+    m_jobQueued.wakeAll();
+    m_mutex.unlock();
+
+    for (auto worker : m_workers)
+    {
+        worker->wait();
+        delete worker;
+    }
+}
+
+int RemoteFECPool::getDefaultNbWorkers()
+{
+    // one core is left to the thread pushing and popping the jobs
+    return std::max(0, std::min(m_maxWorkers, QThread::idealThreadCount() - 1));
+}
+
+int RemoteFECPool::getNbInFlight()
+{
+    QMutexLocker mutexLocker(&m_mutex);
+    return m_entries.size();
+}
+
+void RemoteFECPool::push(Job *job)
+{
+    if (m_workers.size() == 0)
+    {
+        job->run(0);
+        QMutexLocker mutexLocker(&m_mutex);
+        m_entries.push_back(Entry(job, true));
+        m_nextSeq++;
+        return;
+    }
+
+    QMutexLocker mutexLocker(&m_mutex);
+    m_entries.push_back(Entry(job, false));
+    m_jobQueued.wakeOne();
+}
+
+RemoteFECPool::Job *RemoteFECPool::pop(bool wait)
+{
+    QMutexLocker mutexLocker(&m_mutex);
+
+    if (m_entries.size() == 0) {
+        return nullptr;
+    }
+
+    while (!m_entries.front().m_done)
+    {
+        if (!wait) {
+            return nullptr;
+        }
+
+        m_jobDone.wait(&m_mutex);
+    }
+
+    Job *job = m_entries.front().m_job;
+    m_entries.pop_front();
+    m_headSeq++;
+    return job;
+}
+
+void RemoteFECPool::work(int workerIndex)
+{
+    m_mutex.lock();
+
+    while (true)
+    {
+        while (!m_stop && (m_nextSeq == m_headSeq + m_entries.size())) {
+            m_jobQueued.wait(&m_mutex);
+        }
+
+        if (m_stop) {
+            break;
+        }
+
+        // entries are only removed from the front once done so the index of a running job is stable
+        // relative to the head sequence number
+        quint64 seq = m_nextSeq++;
+        Job *job = m_entries[seq - m_headSeq].m_job;
+        m_mutex.unlock();
+
+        job->run(workerIndex);
+
+        m_mutex.lock();
+        m_entries[seq - m_headSeq].m_done = true;
+        m_jobDone.wakeAll();
+    }
+
+    m_mutex.unlock();
+}
+
+void RemoteFECPool::Worker::run()
+{
+    m_pool->work(m_index);
+}
@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// Remote data FEC encoding and decoding worker pool                             //
+//                                                                               //
+// SDRangel can serve as a remote SDR front end that handles the interface       //
+// with a physical device and sends or receives the I/Q samples stream via UDP   //
+// to or from another SDRangel instance or any program implementing the same     //
+// protocol. The remote SDRangel is controlled via its Web REST API.             //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CHANNEL_REMOTEFECPOOL_H_
+#define CHANNEL_REMOTEFECPOOL_H_
+
+#include <deque>
+#include <vector>
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include "export.h"
+
+/**
+ * Runs the FEC encoding or decoding of several super-frames in parallel and gives them
+ * back in submission order.
+ *
+ * The pool does not depend on the FEC library. A job implements run(workerIndex) where
+ * workerIndex is in [0, getNbContexts()[ so that the owner can keep one codec instance and
+ * scratch buffers per worker. The job itself is not owned by the pool. It is given back by
+ * pop once it has run and all the jobs pushed before it have been popped. The owner does the
+ * order dependent part of the processing (sending, copying to the samples buffer...) there.
+ *
+ * With no worker threads (single core host or nbWorkers = 0) push runs the job immediately.
+ */
+class SDRBASE_API RemoteFECPool
+{
+public:
+    class Job
+    {
+    public:
+        virtual ~Job() {}
+        virtual void run(int workerIndex) = 0;
+    };
+
+    RemoteFECPool(int nbWorkers = -1); //!< -1 for getDefaultNbWorkers()
+    ~RemoteFECPool(); //!< jobs in flight should be popped before as the ones not started are dropped
+
+    int getNbWorkers() const { return (int) m_workers.size(); }
+    int getNbContexts() const { return m_workers.size() == 0 ? 1 : (int) m_workers.size(); }
+    int getNbInFlight(); //!< jobs pushed and not popped yet
+    void push(Job *job);
+    Job *pop(bool wait); //!< oldest job if it has run (or when it has run if wait) else nullptr. nullptr also if nothing is in flight.
+
+    static int getDefaultNbWorkers();
+    static const int m_maxWorkers = 4;
+
+private:
+    class Worker : public QThread
+    {
+    public:
+        Worker(RemoteFECPool *pool, int index) : m_pool(pool), m_index(index) {}
+    protected:
+        virtual void run();
+    private:
+        RemoteFECPool *m_pool;
+        int m_index;
+    };
+
+    struct Entry
+    {
+        Job *m_job;
+        bool m_done;
+        Entry(Job *job, bool done) : m_job(job), m_done(done) {}
+    };
+
+    std::vector<Worker*> m_workers;
+    std::deque<Entry> m_entries;
+    quint64 m_headSeq;  //!< sequence number of the first entry
+    quint64 m_nextSeq;  //!< sequence number of the next entry to run
+    bool m_stop;
+    QMutex m_mutex;
+    QWaitCondition m_jobQueued;
+    QWaitCondition m_jobDone;
+
+    void work(int workerIndex);
+};
+
+#endif // CHANNEL_REMOTEFECPOOL_H_
@@ -0,0 +1,273 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// Remote data blocks batched UDP receiver                                       //
+//                                                                               //
+// SDRangel can serve as a remote SDR front end that handles the interface       //
+// with a physical device and sends or receives the I/Q samples stream via UDP   //
+// to or from another SDRangel instance or any program implementing the same     //
+// protocol. The remote SDRangel is controlled via its Web REST API.             //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <QUdpSocket>
+#include <QSocketNotifier>
+#include <QDebug>
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#define REMOTEUDP_NATIVE
+#endif
+
+#include "remoteudpreceiver.h"
+
+#if defined(REMOTEUDP_NATIVE)
+struct RemoteUDPReceiver::NativeHeaders
+{
+    mmsghdr m_msgs[RemoteUDPReceiver::m_maxBatch];
+    iovec m_iovs[RemoteUDPReceiver::m_maxBatch];
+    sockaddr_storage m_addrs[RemoteUDPReceiver::m_maxBatch];
+};
+#else
+struct RemoteUDPReceiver::NativeHeaders
+{};
+#endif
+
+RemoteUDPReceiver::RemoteUDPReceiver(QObject *parent) :
+    QObject(parent),
+    m_fd(-1),
+    m_notifier(nullptr),
+    m_socket(nullptr),
+    m_nativeHeaders(new NativeHeaders())
+{}
+
+RemoteUDPReceiver::~RemoteUDPReceiver()
+{
+    close();
+    delete m_nativeHeaders;
+}
+
+bool RemoteUDPReceiver::open(const QHostAddress& address, uint16_t port, bool multicast, const QHostAddress& multicastAddress)
+{
+    close();
+    int res = openNative(address, port, multicast, multicastAddress);
+
+    if (res >= 0) {
+        return res == 1;
+    }
+
+    return openQt(address, port, multicast, multicastAddress);
+}
+
+void RemoteUDPReceiver::close()
+{
+    if (m_notifier)
+    {
+        delete m_notifier;
+        m_notifier = nullptr;
+    }
+
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+
+    if (m_socket)
+    {
+        delete m_socket;
+        m_socket = nullptr;
+    }
+}
+
+bool RemoteUDPReceiver::openQt(const QHostAddress& address, uint16_t port, bool multicast, const QHostAddress& multicastAddress)
+{
+    m_socket = new QUdpSocket(this);
+
+    if (!m_socket->bind(address, port, QUdpSocket::ShareAddress))
+    {
+        delete m_socket;
+        m_socket = nullptr;
+        return false;
+    }
+
+    if (multicast)
+    {
+        if (m_socket->joinMulticastGroup(multicastAddress)) {
+            qDebug("RemoteUDPReceiver::openQt: joined multicast group %s", qPrintable(multicastAddress.toString()));
+        } else {
+            qDebug("RemoteUDPReceiver::openQt: failed joining multicast group %s", qPrintable(multicastAddress.toString()));
+        }
+    }
+
+    QObject::connect(m_socket, &QUdpSocket::readyRead, this, &RemoteUDPReceiver::dataReady);
+    qDebug("RemoteUDPReceiver::openQt: using QUdpSocket::readDatagram");
+    return true;
+}
+
+int RemoteUDPReceiver::readBatch()
+{
+    if (m_fd >= 0) {
+        return readBatchNative();
+    } else if (m_socket) {
+        return readBatchQt();
+    } else {
+        return 0;
+    }
+}
+
+int RemoteUDPReceiver::readBatchQt()
+{
+    int nbDatagrams = 0;
+
+    while ((nbDatagrams < m_maxBatch) && m_socket->hasPendingDatagrams())
+    {
+        qint64 pendingSize = m_socket->pendingDatagramSize();
+        qint64 size = m_socket->readDatagram(m_buffers[nbDatagrams], RemoteUdpSize, &m_senderAddress, nullptr);
+
+        if (size < 0) {
+            break;
+        }
+
+        m_sizes[nbDatagrams++] = pendingSize > RemoteUdpSize ? -1 : (int) size;
+    }
+
+    return nbDatagrams;
+}
+
+#if defined(REMOTEUDP_NATIVE)
+
+int RemoteUDPReceiver::openNative(const QHostAddress& address, uint16_t port, bool multicast, const QHostAddress& multicastAddress)
+{
+    sockaddr_storage sockAddr;
+    socklen_t sockAddrLen;
+    memset(&sockAddr, 0, sizeof(sockAddr));
+
+    if (address.protocol() == QAbstractSocket::IPv6Protocol)
+    {
+        sockaddr_in6 *sin6 = (sockaddr_in6*) &sockAddr;
+        Q_IPV6ADDR ip6 = address.toIPv6Address();
+        sin6->sin6_family = AF_INET6;
+        sin6->sin6_port = htons(port);
+        memcpy(&sin6->sin6_addr, &ip6, sizeof(ip6));
+        sin6->sin6_scope_id = address.scopeId().toUInt();
+        sockAddrLen = sizeof(sockaddr_in6);
+    }
+    else
+    {
+        sockaddr_in *sin = (sockaddr_in*) &sockAddr;
+        sin->sin_family = AF_INET;
+        sin->sin_port = htons(port);
+        sin->sin_addr.s_addr = htonl(address.toIPv4Address());
+        sockAddrLen = sizeof(sockaddr_in);
+    }
+
+    m_fd = ::socket(sockAddr.ss_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if (m_fd < 0)
+    {
+        qWarning("RemoteUDPReceiver::openNative: cannot open socket: %s. Falling back to QUdpSocket", strerror(errno));
+        return -1;
+    }
+
+    int reuse = 1;
+    setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    if (::bind(m_fd, (const sockaddr*) &sockAddr, sockAddrLen) < 0)
+    {
+        qWarning("RemoteUDPReceiver::openNative: cannot bind to %s:%u: %s", qPrintable(address.toString()), port, strerror(errno));
+        ::close(m_fd);
+        m_fd = -1;
+        return 0;
+    }
+
+    if (multicast)
+    {
+        ip_mreq mreq;
+        mreq.imr_multiaddr.s_addr = htonl(multicastAddress.toIPv4Address());
+        mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+
+        if (setsockopt(m_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) == 0) {
+            qDebug("RemoteUDPReceiver::openNative: joined multicast group %s", qPrintable(multicastAddress.toString()));
+        } else {
+            qDebug("RemoteUDPReceiver::openNative: failed joining multicast group %s: %s", qPrintable(multicastAddress.toString()), strerror(errno));
+        }
+    }
+
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    QObject::connect(m_notifier, SIGNAL(activated(int)), this, SIGNAL(dataReady()));
+    qDebug("RemoteUDPReceiver::openNative: using recvmmsg");
+    return 1;
+}
+
+int RemoteUDPReceiver::readBatchNative()
+{
+    NativeHeaders& h = *m_nativeHeaders;
+    memset(h.m_msgs, 0, sizeof(h.m_msgs));
+
+    for (int i = 0; i < m_maxBatch; i++)
+    {
+        h.m_iovs[i].iov_base = m_buffers[i];
+        h.m_iovs[i].iov_len = RemoteUdpSize;
+        h.m_msgs[i].msg_hdr.msg_iov = &h.m_iovs[i];
+        h.m_msgs[i].msg_hdr.msg_iovlen = 1;
+        h.m_msgs[i].msg_hdr.msg_name = &h.m_addrs[i];
+        h.m_msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+    }
+
+    int res;
+
+    do {
+        res = ::recvmmsg(m_fd, h.m_msgs, m_maxBatch, MSG_DONTWAIT, nullptr);
+    } while ((res < 0) && (errno == EINTR));
+
+    if (res <= 0)
+    {
+        if ((res < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+            qWarning("RemoteUDPReceiver::readBatchNative: recvmmsg failed: %s", strerror(errno));
+        }
+
+        return 0;
+    }
+
+    for (int i = 0; i < res; i++) {
+        m_sizes[i] = (h.m_msgs[i].msg_hdr.msg_flags & MSG_TRUNC) ? -1 : (int) h.m_msgs[i].msg_len;
+    }
+
+    m_senderAddress.setAddress((const sockaddr*) &h.m_addrs[res-1]);
+    return res;
+}
+
+#else
+
+int RemoteUDPReceiver::openNative(const QHostAddress& address, uint16_t port, bool multicast, const QHostAddress& multicastAddress)
+{
+    (void) address;
+    (void) port;
+    (void) multicast;
+    (void) multicastAddress;
+    return -1;
+}
+
+int RemoteUDPReceiver::readBatchNative()
+{
+    return 0;
+}
+
+#endif // REMOTEUDP_NATIVE
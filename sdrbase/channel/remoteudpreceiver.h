@@ -0,0 +1,86 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// Remote data blocks batched UDP receiver                                       //
+//                                                                               //
+// SDRangel can serve as a remote SDR front end that handles the interface       //
+// with a physical device and sends or receives the I/Q samples stream via UDP   //
+// to or from another SDRangel instance or any program implementing the same     //
+// protocol. The remote SDRangel is controlled via its Web REST API.             //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CHANNEL_REMOTEUDPRECEIVER_H_
+#define CHANNEL_REMOTEUDPRECEIVER_H_
+
+#include <QObject>
+#include <QHostAddress>
+
+#include "channel/remotedatablock.h"
+#include "export.h"
+
+class QUdpSocket;
+class QSocketNotifier;
+
+/**
+ * Receives the UDP blocks of remote data streams in batches.
+ *
+ * On Linux the receiver opens, binds and watches its own native socket and reads the datagrams
+ * with recvmmsg (up to m_maxBatch per system call). Other systems or a failure to create the
+ * native socket fall back to a QUdpSocket read with QUdpSocket::readDatagram. Both bind with
+ * address reuse as QUdpSocket::ShareAddress does.
+ * In both cases dataReady is emitted when datagrams are pending and readBatch should then
+ * be called until it returns 0.
+ */
+class SDRBASE_API RemoteUDPReceiver : public QObject
+{
+    Q_OBJECT
+public:
+    RemoteUDPReceiver(QObject *parent = nullptr);
+    ~RemoteUDPReceiver();
+
+    /** Binds to address and port and joins the IPv4 multicast group if multicast is set */
+    bool open(const QHostAddress& address, uint16_t port, bool multicast, const QHostAddress& multicastAddress);
+    void close();
+    bool isOpen() const { return (m_fd >= 0) || (m_socket != nullptr); }
+    bool isBatched() const { return m_fd >= 0; }
+    int readBatch(); //!< reads pending datagrams and returns their number (0 if none)
+    char *getDatagram(int index) { return m_buffers[index]; }
+    int getDatagramSize(int index) const { return m_sizes[index]; } //!< -1 if truncated
+    const QHostAddress& getSenderAddress() const { return m_senderAddress; } //!< sender of the last datagram read
+
+    static const int m_maxBatch = 64;
+
+signals:
+    void dataReady();
+
+private:
+    struct NativeHeaders;
+
+    int m_fd;                    //!< native socket or -1
+    QSocketNotifier *m_notifier; //!< watches the native socket
+    QUdpSocket *m_socket;        //!< fallback socket
+    NativeHeaders *m_nativeHeaders;
+    char m_buffers[m_maxBatch][RemoteUdpSize];
+    int m_sizes[m_maxBatch];
+    QHostAddress m_senderAddress;
+
+    int openNative(const QHostAddress& address, uint16_t port, bool multicast, const QHostAddress& multicastAddress); //!< 1 bound, 0 failed, -1 not available
+    bool openQt(const QHostAddress& address, uint16_t port, bool multicast, const QHostAddress& multicastAddress);
+    int readBatchNative();
+    int readBatchQt();
+};
+
+#endif // CHANNEL_REMOTEUDPRECEIVER_H_
@@ -0,0 +1,370 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// Remote data blocks batched UDP sender with token bucket pacing                //
+//                                                                               //
+// SDRangel can serve as a remote SDR front end that handles the interface       //
+// with a physical device and sends or receives the I/Q samples stream via UDP   //
+// to or from another SDRangel instance or any program implementing the same     //
+// protocol. The remote SDRangel is controlled via its Web REST API.             //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <thread>
+#include <algorithm>
+
+#include <QUdpSocket>
+#include <QDebug>
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <linux/sockios.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#define REMOTEUDP_NATIVE
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#endif
+
+#include "remoteudpsender.h"
+
+RemoteUDPSender::RemoteUDPSender(QUdpSocket *socket) :
+    m_socket(socket),
+    m_fd(-1),
+    m_fdFamily(-1),
+    m_gso(false),
+    m_rate(0.0),
+    m_burst(m_maxBatch),
+    m_tokens(m_maxBatch),
+    m_lastRefill(Clock::now()),
+    m_periodStart(Clock::now()),
+    m_periodBytes(0),
+    m_throughput(0),
+    m_sendQueueBytes(0),
+    m_nbBlocksSent(0),
+    m_nbBlocksFailed(0)
+{}
+
+RemoteUDPSender::~RemoteUDPSender()
+{
+    releaseSocket();
+}
+
+void RemoteUDPSender::setRate(double blocksPerSecond)
+{
+    if (blocksPerSecond == m_rate) {
+        return;
+    }
+
+    m_rate = blocksPerSecond < 0.0 ? 0.0 : blocksPerSecond;
+    int burst = (int) ((m_rate * m_batchTimeUs) / 1000000.0);
+    m_burst = m_rate == 0.0 ? m_maxBatch : std::max(1, std::min(m_maxBatch, burst));
+    m_tokens = m_burst;
+    m_lastRefill = Clock::now();
+    qDebug("RemoteUDPSender::setRate: %.1f blocks/s burst: %d", m_rate, m_burst);
+}
+
+void RemoteUDPSender::sendBlocks(const RemoteSuperBlock *blocks, int nbBlocks, const QHostAddress& address, uint16_t port)
+{
+    int index = 0;
+
+    while (index < nbBlocks)
+    {
+        int batchSize = std::min(m_burst, nbBlocks - index);
+        waitTokens(batchSize);
+        int sent = sendBatch(&blocks[index], batchSize, address, port);
+        updateStats(sent, batchSize - sent);
+        index += batchSize;
+    }
+}
+
+void RemoteUDPSender::waitTokens(int nbBlocks)
+{
+    if (m_rate == 0.0) {
+        return;
+    }
+
+    Clock::time_point now = Clock::now();
+    m_tokens = std::min((double) m_burst, m_tokens + std::chrono::duration<double>(now - m_lastRefill).count() * m_rate);
+    m_lastRefill = now;
+
+    if (m_tokens < nbBlocks)
+    {
+        // the bucket holds exactly nbBlocks at the deadline. Taking the deadline rather than the wake up time
+        // as the refill time credits the oversleep to the next batch so that the average rate is kept.
+        Clock::time_point deadline = now + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>((nbBlocks - m_tokens) / m_rate));
+        std::this_thread::sleep_until(deadline);
+        m_tokens = nbBlocks;
+        m_lastRefill = deadline;
+    }
+
+    m_tokens -= nbBlocks;
+}
+
+int RemoteUDPSender::sendBatch(const RemoteSuperBlock *blocks, int nbBlocks, const QHostAddress& address, uint16_t port)
+{
+#if defined(REMOTEUDP_NATIVE)
+    int family = address.protocol() == QAbstractSocket::IPv6Protocol ? AF_INET6 : AF_INET;
+
+    if (m_fdFamily != family) {
+        bindSocket(family);
+    }
+
+    if (m_fd >= 0) {
+        return sendBatchNative(blocks, nbBlocks, address, port);
+    }
+#endif
+
+    return sendBatchQt(blocks, nbBlocks, address, port);
+}
+
+int RemoteUDPSender::sendBatchQt(const RemoteSuperBlock *blocks, int nbBlocks, const QHostAddress& address, uint16_t port)
+{
+    int sent = 0;
+
+    if (!m_socket) {
+        return 0;
+    }
+
+    for (int i = 0; i < nbBlocks; i++)
+    {
+        if (m_socket->writeDatagram((const char*) &blocks[i], (qint64) RemoteUdpSize, address, port) == RemoteUdpSize) {
+            sent++;
+        }
+    }
+
+    return sent;
+}
+
+#if defined(REMOTEUDP_NATIVE)
+
+static socklen_t toSockAddr(const QHostAddress& address, uint16_t port, sockaddr_storage& sockAddr)
+{
+    memset(&sockAddr, 0, sizeof(sockAddr));
+
+    if (address.protocol() == QAbstractSocket::IPv6Protocol)
+    {
+        sockaddr_in6 *sin6 = (sockaddr_in6*) &sockAddr;
+        Q_IPV6ADDR ip6 = address.toIPv6Address();
+        sin6->sin6_family = AF_INET6;
+        sin6->sin6_port = htons(port);
+        memcpy(&sin6->sin6_addr, &ip6, sizeof(ip6));
+        sin6->sin6_scope_id = address.scopeId().toUInt();
+        return sizeof(sockaddr_in6);
+    }
+    else
+    {
+        sockaddr_in *sin = (sockaddr_in*) &sockAddr;
+        sin->sin_family = AF_INET;
+        sin->sin_port = htons(port);
+        sin->sin_addr.s_addr = htonl(address.toIPv4Address());
+        return sizeof(sockaddr_in);
+    }
+}
+
+void RemoteUDPSender::bindSocket(int family)
+{
+    releaseSocket();
+    m_fdFamily = family;
+
+    if (!m_socket) {
+        return;
+    }
+
+    // Bind the socket to an ephemeral port before writeDatagram would do it so that its
+    // descriptor can be used for the native sends with the same source port
+    m_socket->abort();
+
+    if (!m_socket->bind(family == AF_INET6 ? QHostAddress::AnyIPv6 : QHostAddress::AnyIPv4, 0))
+    {
+        qWarning("RemoteUDPSender::bindSocket: cannot bind socket: %s. Falling back to QUdpSocket",
+            qPrintable(m_socket->errorString()));
+        return;
+    }
+
+    m_fd = (int) m_socket->socketDescriptor();
+
+    if (m_fd < 0) {
+        return;
+    }
+
+    // room for a full super-frame with all FEC blocks
+    int sndBuf = 2 * 256 * RemoteUdpSize;
+    setsockopt(m_fd, SOL_SOCKET, SO_SNDBUF, &sndBuf, sizeof(sndBuf));
+
+    // a socket wide segment size makes any send larger than one block a GSO send
+    int segmentSize = RemoteUdpSize;
+    m_gso = setsockopt(m_fd, SOL_UDP, UDP_SEGMENT, &segmentSize, sizeof(segmentSize)) == 0;
+
+    qDebug("RemoteUDPSender::bindSocket: %s port %u using %s",
+        family == AF_INET6 ? "IPv6" : "IPv4",
+        m_socket->localPort(),
+        m_gso ? "GSO" : "sendmmsg");
+}
+
+void RemoteUDPSender::releaseSocket()
+{
+    // the descriptor belongs to the QUdpSocket
+    m_fd = -1;
+    m_fdFamily = -1;
+    m_gso = false;
+}
+
+bool RemoteUDPSender::waitWritable()
+{
+    // the QUdpSocket descriptor is non blocking
+    pollfd pfd;
+    pfd.fd = m_fd;
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+    int res;
+
+    do {
+        res = ::poll(&pfd, 1, 100);
+    } while ((res < 0) && (errno == EINTR));
+
+    return res > 0;
+}
+
+int RemoteUDPSender::sendBatchNative(const RemoteSuperBlock *blocks, int nbBlocks, const QHostAddress& address, uint16_t port)
+{
+    sockaddr_storage sockAddr;
+    socklen_t sockAddrLen = toSockAddr(address, port, sockAddr);
+
+    if (m_gso && (nbBlocks > 1))
+    {
+        iovec iov;
+        iov.iov_base = (void*) blocks;
+        iov.iov_len = nbBlocks * RemoteUdpSize;
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name = &sockAddr;
+        msg.msg_namelen = sockAddrLen;
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        ssize_t res;
+
+        do {
+            res = ::sendmsg(m_fd, &msg, 0);
+        } while ((res < 0) && ((errno == EINTR) || (((errno == EAGAIN) || (errno == EWOULDBLOCK)) && waitWritable())));
+
+        if (res >= 0) {
+            return nbBlocks;
+        } else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            return 0; // send queue stuck
+        }
+
+        // e.g. EIO when the egress device cannot offload checksums: no GSO from now on
+        qInfo("RemoteUDPSender::sendBatchNative: GSO send failed: %s. Using sendmmsg", strerror(errno));
+        int segmentSize = 0;
+        setsockopt(m_fd, SOL_UDP, UDP_SEGMENT, &segmentSize, sizeof(segmentSize));
+        m_gso = false;
+    }
+
+    mmsghdr msgs[m_maxBatch];
+    iovec iovs[m_maxBatch];
+    memset(msgs, 0, nbBlocks * sizeof(mmsghdr));
+
+    for (int i = 0; i < nbBlocks; i++)
+    {
+        iovs[i].iov_base = (void*) &blocks[i];
+        iovs[i].iov_len = RemoteUdpSize;
+        msgs[i].msg_hdr.msg_name = &sockAddr;
+        msgs[i].msg_hdr.msg_namelen = sockAddrLen;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int sent = 0;
+
+    while (sent < nbBlocks)
+    {
+        int res = ::sendmmsg(m_fd, &msgs[sent], nbBlocks - sent, 0);
+
+        if (res < 0)
+        {
+            if ((errno == EINTR) || (((errno == EAGAIN) || (errno == EWOULDBLOCK)) && waitWritable())) {
+                continue;
+            }
+
+            qWarning("RemoteUDPSender::sendBatchNative: sendmmsg failed: %s", strerror(errno));
+            break;
+        }
+
+        sent += res;
+    }
+
+    return sent;
+}
+
+#else
+
+void RemoteUDPSender::bindSocket(int family)
+{
+    (void) family;
+}
+
+void RemoteUDPSender::releaseSocket()
+{}
+
+bool RemoteUDPSender::waitWritable()
+{
+    return false;
+}
+
+int RemoteUDPSender::sendBatchNative(const RemoteSuperBlock *blocks, int nbBlocks, const QHostAddress& address, uint16_t port)
+{
+    return sendBatchQt(blocks, nbBlocks, address, port);
+}
+
+#endif // REMOTEUDP_NATIVE
+
+void RemoteUDPSender::updateStats(int nbBlocksSent, int nbBlocksFailed)
+{
+    m_nbBlocksSent.fetch_add(nbBlocksSent);
+
+    if (nbBlocksFailed > 0) {
+        m_nbBlocksFailed.fetch_add(nbBlocksFailed);
+    }
+
+#if defined(REMOTEUDP_NATIVE)
+    int queueBytes = 0;
+
+    if ((m_fd >= 0) && (ioctl(m_fd, SIOCOUTQ, &queueBytes) == 0)) {
+        m_sendQueueBytes.store(queueBytes);
+    }
+#endif
+
+    m_periodBytes += nbBlocksSent * RemoteUdpSize;
+    Clock::time_point now = Clock::now();
+    double elapsed = std::chrono::duration<double>(now - m_periodStart).count();
+
+    if (elapsed >= 1.0)
+    {
+        m_throughput.store((qint64) (m_periodBytes / elapsed));
+        m_periodBytes = 0;
+        m_periodStart = now;
+    }
+}
@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// Remote data blocks batched UDP sender with token bucket pacing                //
+//                                                                               //
+// SDRangel can serve as a remote SDR front end that handles the interface       //
+// with a physical device and sends or receives the I/Q samples stream via UDP   //
+// to or from another SDRangel instance or any program implementing the same     //
+// protocol. The remote SDRangel is controlled via its Web REST API.             //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CHANNEL_REMOTEUDPSENDER_H_
+#define CHANNEL_REMOTEUDPSENDER_H_
+
+#include <stdint.h>
+#include <chrono>
+#include <atomic>
+
+#include <QHostAddress>
+
+#include "channel/remotedatablock.h"
+#include "export.h"
+
+class QUdpSocket;
+
+/**
+ * Sends the UDP blocks of a FEC super-frame in as few system calls as possible.
+ *
+ * On Linux the blocks go out with one sendmsg using UDP generic segmentation offload (GSO)
+ * when the kernel supports it else with sendmmsg. These are made on the descriptor of the
+ * QUdpSocket itself once bound to an ephemeral port so that all blocks leave from the same
+ * source port whichever path is used. Other systems or a failure to bind the socket fall back
+ * to one QUdpSocket::writeDatagram per block.
+ *
+ * Pacing is done with a token bucket refilled at the block rate given by setRate. Its depth
+ * is the number of blocks sent in a batch which is the number of blocks due in m_batchTimeUs
+ * (at least 1 and at most m_maxBatch) so at low rates blocks are still sent one at a time
+ * while at high rates the system call and sleep overheads are spread over several blocks.
+ * Deadlines are absolute so sleep inaccuracies do not accumulate over the frame.
+ *
+ * Statistics are updated by the sending thread and can be read from any thread.
+ */
+class SDRBASE_API RemoteUDPSender
+{
+public:
+    RemoteUDPSender(QUdpSocket *socket); //!< socket to send with. Not owned and must live in the sending thread
+    ~RemoteUDPSender();
+
+    void setRate(double blocksPerSecond); //!< 0 disables pacing
+    void sendBlocks(const RemoteSuperBlock *blocks, int nbBlocks, const QHostAddress& address, uint16_t port);
+
+    bool isBatched() const { return m_fd >= 0; }
+    bool isGSO() const { return m_gso; }
+    qint64 getThroughput() const { return m_throughput.load(); }  //!< achieved throughput in bytes per second over the last second
+    int getSendQueueBytes() const { return m_sendQueueBytes.load(); } //!< bytes waiting in the socket send queue after the last batch
+    quint64 getNbBlocksSent() const { return m_nbBlocksSent.load(); }
+    quint64 getNbBlocksFailed() const { return m_nbBlocksFailed.load(); }
+
+    static const int m_maxBatch = 64;     //!< Maximum number of blocks per system call (GSO limit)
+    static const int m_batchTimeUs = 1000; //!< Batch is made of the blocks due in this time
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    QUdpSocket *m_socket;
+    int m_fd;            //!< descriptor of the bound socket or -1
+    int m_fdFamily;      //!< address family the socket is bound for
+    bool m_gso;
+    double m_rate;       //!< blocks per second
+    int m_burst;         //!< token bucket depth in blocks
+    double m_tokens;
+    Clock::time_point m_lastRefill;
+
+    // throughput measurement
+    Clock::time_point m_periodStart;
+    qint64 m_periodBytes;
+    std::atomic<qint64> m_throughput;
+    std::atomic<int> m_sendQueueBytes;
+    std::atomic<quint64> m_nbBlocksSent;
+    std::atomic<quint64> m_nbBlocksFailed;
+
+    void waitTokens(int nbBlocks);
+    int sendBatch(const RemoteSuperBlock *blocks, int nbBlocks, const QHostAddress& address, uint16_t port);
+    int sendBatchNative(const RemoteSuperBlock *blocks, int nbBlocks, const QHostAddress& address, uint16_t port);
+    int sendBatchQt(const RemoteSuperBlock *blocks, int nbBlocks, const QHostAddress& address, uint16_t port);
+    void bindSocket(int family);
+    void releaseSocket();
+    bool waitWritable();
+    void updateStats(int nbBlocksSent, int nbBlocksFailed);
+};
+
+#endif // CHANNEL_REMOTEUDPSENDER_H_
@@ -47,6 +47,8 @@ DeviceAPI::DeviceAPI(
     m_buddySharedPtr(nullptr),
     m_isBuddyLeader(false),
     m_deviceSourceEngine(deviceSourceEngine),
+    m_sharedChannelizer(false),
+    m_sharedChannelizerLog2Subbands(6),
     m_deviceSinkEngine(deviceSinkEngine),
     m_deviceMIMOEngine(deviceMIMOEngine)
 {
@@ -330,6 +332,23 @@ void DeviceAPI::configureCorrections(bool dcOffsetCorrection, bool iqImbalanceCo
     }
 }
 
+void DeviceAPI::configureSharedChannelizer(bool enable, unsigned int log2NbSubbands)
+{
+    m_sharedChannelizer = enable;
+    m_sharedChannelizerLog2Subbands = log2NbSubbands;
+
+    if (m_deviceSourceEngine) {
+        m_deviceSourceEngine->configureSharedChannelizer(enable, log2NbSubbands);
+    }
+}
+
+void DeviceAPI::configureSubbandRequest(BasebandSampleSink* sink, qint64 frequencyOffset, int bandwidth, int sampleRate)
+{
+    if (m_deviceSourceEngine) {
+        m_deviceSourceEngine->configureSubbandRequest(sink, frequencyOffset, bandwidth, sampleRate);
+    }
+}
+
 void DeviceAPI::setHardwareId(const QString& id)
 {
     m_hardwareId = id;
@@ -496,6 +515,8 @@ void DeviceAPI::loadSamplingDeviceSettings(const Preset* preset)
         {
             qDebug("DeviceAPI::loadSamplingDeviceSettings: no source");
         }
+
+        configureSharedChannelizer(preset->hasSharedChannelizer(), preset->getSharedChannelizerLog2Subbands());
     }
     else if (m_deviceSinkEngine && preset->isSinkPreset())
     {
@@ -577,6 +598,9 @@ void DeviceAPI::saveSamplingDeviceSettings(Preset* preset)
         {
             qDebug("DeviceAPI::saveSamplingDeviceSettings: no source");
         }
+
+        preset->setSharedChannelizer(m_sharedChannelizer);
+        preset->setSharedChannelizerLog2Subbands(m_sharedChannelizerLog2Subbands);
     }
     else if (m_deviceSinkEngine && preset->isSinkPreset())
     {
@@ -100,6 +100,10 @@ public:
     MessageQueue *getSamplingDeviceGUIMessageQueue();   //!< Sampling device (ex: single Tx) GUI input message queue
 
     void configureCorrections(bool dcOffsetCorrection, bool iqImbalanceCorrection, int streamIndex = 0); //!< Configure current device engine DSP corrections (Rx)
+    void configureSharedChannelizer(bool enable, unsigned int log2NbSubbands); //!< Configure filterbank shared by Rx channels (single Rx only)
+    bool getSharedChannelizer() const { return m_sharedChannelizer; }
+    unsigned int getSharedChannelizerLog2Subbands() const { return m_sharedChannelizerLog2Subbands; }
+    void configureSubbandRequest(BasebandSampleSink* sink, qint64 frequencyOffset, int bandwidth, int sampleRate); //!< Channel sink asks to be fed by the shared channelizer (single Rx only)
 
     void setHardwareId(const QString& id);
     void setSamplingDeviceId(const QString& id) { m_samplingDeviceId = id; }
@@ -193,6 +197,8 @@ protected:
 
     DSPDeviceSourceEngine *m_deviceSourceEngine;
     QList<ChannelAPI*> m_channelSinkAPIs;
+    bool m_sharedChannelizer;                    //!< Channels are fed by the filterbank shared at device level
+    unsigned int m_sharedChannelizerLog2Subbands; //!< Log2 of the number of sub-bands of the shared filterbank
 
     // Single Tx (i.e. sink)
 
@@ -21,6 +21,7 @@
 
 #include <QObject>
 #include "dsp/dsptypes.h"
+#include "dsp/sampleblock.h"
 #include "export.h"
 #include "util/messagequeue.h"
 
@@ -35,6 +36,10 @@ public:
 	virtual void start() = 0;
 	virtual void stop() = 0;
 	virtual void feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end, bool positiveOnly) = 0;
+	//! Sinks queuing samples for their own thread return true to be fed by feedBlock with a block shared by all such sinks
+	virtual bool acceptsBlocks() const { return false; }
+	//! Keep a reference to the block instead of copying its samples
+	virtual void feedBlock(const SampleBlockRef& block, bool positiveOnly) { feed(block.begin(), block.end(), positiveOnly); }
 	virtual bool handleMessage(const Message& cmd) = 0; //!< Processing of a message. Returns true if message has actually been processed
 
 	MessageQueue *getInputMessageQueue() { return &m_inputMessageQueue; } //!< Get the queue for asynchronous inbound communication
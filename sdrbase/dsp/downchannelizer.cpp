@@ -16,6 +16,9 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.          //
 ///////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <iterator>
+
 #include <QString>
 #include <QDebug>
 
@@ -24,7 +27,15 @@
 #include "dsp/hbfilterchainconverter.h"
 #include "downchannelizer.h"
 
+std::atomic<unsigned int> DownChannelizer::m_pipelineMaxWorkers(2);
+std::atomic<int> DownChannelizer::m_pipelineMinSampleRate(10000000);
+std::atomic<int> DownChannelizer::m_pipelineWorkersInUse(0);
+
 DownChannelizer::DownChannelizer(ChannelSampleSink* sampleSink) :
+    m_filterChain(getFilterChain(HBFIRKernels::instance().getLevel())),
+    m_pipelinePool(nullptr),
+    m_pipelineOutputFifo(m_pipelineMaxInFlight),
+    m_pipelineInFlight(0),
     m_filterChainSetMode(false),
 	m_sampleSink(sampleSink),
 	m_basebandSampleRate(0),
@@ -54,37 +65,118 @@ void DownChannelizer::feed(const SampleVector::const_iterator& begin, const Samp
 	{
 		m_sampleSink->feed(begin, end);
 	}
+	else if (m_pipeline.size() != 0)
+	{
+		feedPipeline(begin, end);
+	}
 	else
 	{
-		for (SampleVector::const_iterator sample = begin; sample != end; ++sample)
-		{
-			Sample s(*sample);
-			FilterStages::iterator stage = m_filterStages.begin();
+		m_filterChain(m_filterStages.data(), m_filterStages.size(), m_filterStages.size(), begin, end, m_sampleBuffer);
+		m_sampleSink->feed(m_sampleBuffer.begin(), m_sampleBuffer.end());
+		m_sampleBuffer.clear();
+	}
+}
 
-			for (; stage != m_filterStages.end(); ++stage)
-			{
+template<typename FIR>
+void DownChannelizer::filterChain(
+    FilterStage* const *stages,
+    unsigned int nbStages,
+    unsigned int outputShift,
+    const SampleVector::const_iterator& begin,
+    const SampleVector::const_iterator& end,
+    SampleVector& out)
+{
+    for (SampleVector::const_iterator sample = begin; sample != end; ++sample)
+    {
+        Sample s(*sample);
+        unsigned int stage = 0;
+
+        for (; stage < nbStages; stage++)
+        {
 #ifndef SDR_RX_SAMPLE_24BIT
-                s.m_real /= 2; // avoid saturation on 16 bit samples
-                s.m_imag /= 2;
+            s.m_real /= 2; // avoid saturation on 16 bit samples
+            s.m_imag /= 2;
 #endif
-				if (!(*stage)->work(&s)) {
-					break;
-				}
-			}
+            if (!stages[stage]->template work<FIR>(&s)) {
+                break;
+            }
+        }
 
-			if(stage == m_filterStages.end())
-			{
+        if (stage == nbStages)
+        {
 #ifdef SDR_RX_SAMPLE_24BIT
-			    s.m_real /= (1<<(m_filterStages.size())); // on 32 bit samples there is enough headroom to just divide the final result
-			    s.m_imag /= (1<<(m_filterStages.size()));
+            if (outputShift != 0)
+            {
+                s.m_real /= (1<<outputShift); // on 32 bit samples there is enough headroom to just divide the final result
+                s.m_imag /= (1<<outputShift);
+            }
+#else
+            (void) outputShift;
 #endif
-				m_sampleBuffer.push_back(s);
-			}
-		}
+            out.push_back(s);
+        }
+    }
+}
 
-		m_sampleSink->feed(m_sampleBuffer.begin(), m_sampleBuffer.end());
-		m_sampleBuffer.clear();
-	}
+void DownChannelizer::filterChainGeneric(FilterStage* const *stages, unsigned int nbStages, unsigned int outputShift,
+    const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end, SampleVector& out)
+{
+    filterChain<HBFIRKernels::Generic>(stages, nbStages, outputShift, begin, end, out);
+}
+
+#if defined(HBFIR_X86) && defined(SDR_RX_SAMPLE_24BIT)
+void DownChannelizer::filterChainSSE41(FilterStage* const *stages, unsigned int nbStages, unsigned int outputShift,
+    const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end, SampleVector& out)
+{
+    filterChain<HBFIRKernels::SSE41>(stages, nbStages, outputShift, begin, end, out);
+}
+
+void DownChannelizer::filterChainAVX2(FilterStage* const *stages, unsigned int nbStages, unsigned int outputShift,
+    const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end, SampleVector& out)
+{
+    filterChain<HBFIRKernels::AVX2>(stages, nbStages, outputShift, begin, end, out);
+}
+
+void DownChannelizer::filterChainAVX512(FilterStage* const *stages, unsigned int nbStages, unsigned int outputShift,
+    const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end, SampleVector& out)
+{
+    filterChain<HBFIRKernels::AVX512>(stages, nbStages, outputShift, begin, end, out);
+}
+#endif
+
+#if defined(HBFIR_NEON) && defined(SDR_RX_SAMPLE_24BIT)
+void DownChannelizer::filterChainNEON(FilterStage* const *stages, unsigned int nbStages, unsigned int outputShift,
+    const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end, SampleVector& out)
+{
+    filterChain<HBFIRKernels::NEON>(stages, nbStages, outputShift, begin, end, out);
+}
+#endif
+
+DownChannelizer::FilterChain DownChannelizer::getFilterChain(CPUFeatures::SIMDLevel level)
+{
+    // 16 bit samples are stored on 32 bits and always use the generic loop
+    switch (HBFIRKernels::getAvailableLevel(level))
+    {
+#if defined(HBFIR_X86) && defined(SDR_RX_SAMPLE_24BIT)
+    case CPUFeatures::SIMDSSE41:
+        return filterChainSSE41;
+    case CPUFeatures::SIMDAVX2:
+        return filterChainAVX2;
+    case CPUFeatures::SIMDAVX512:
+        return filterChainAVX512;
+#endif
+#if defined(HBFIR_NEON) && defined(SDR_RX_SAMPLE_24BIT)
+    case CPUFeatures::SIMDNEON:
+        return filterChainNEON;
+#endif
+    default:
+        return filterChainGeneric;
+    }
+}
+
+void DownChannelizer::setKernelLevel(CPUFeatures::SIMDLevel level)
+{
+    m_filterChain = getFilterChain(level);
 }
 
 void DownChannelizer::setChannelization(int requestedSampleRate, qint64 requestedCenterFrequency)
@@ -132,6 +224,7 @@ void DownChannelizer::applyChannelization()
 		m_requestedCenterFrequency - m_requestedOutputSampleRate / 2, m_requestedCenterFrequency + m_requestedOutputSampleRate / 2);
 
 	m_channelSampleRate = m_basebandSampleRate / (1 << m_filterStages.size());
+	createPipeline();
 
 	qDebug() << "DownChannelizer::applyChannelization done:"
         << " nb stages:" << m_filterStages.size()
@@ -160,6 +253,7 @@ void DownChannelizer::applyDecimation()
     m_channelFrequencyOffset = m_basebandSampleRate * setFilterChain(stageIndexes);
     m_channelSampleRate = m_basebandSampleRate / (1 << m_filterStages.size());
     m_requestedOutputSampleRate = m_channelSampleRate;
+    createPipeline();
 
 	qDebug() << "DownChannelizer::applyDecimation:"
             << " m_log2Decim:" << m_log2Decim
@@ -172,44 +266,16 @@ void DownChannelizer::applyDecimation()
 #ifdef SDR_RX_SAMPLE_24BIT
 DownChannelizer::FilterStage::FilterStage(Mode mode) :
     m_filter(new IntHalfbandFilterEO<qint64, qint64, DOWNCHANNELIZER_HB_FILTER_ORDER, true>),
-    m_workFunction(0),
     m_mode(mode),
     m_sse(true)
 {
-    switch(mode) {
-        case ModeCenter:
-            m_workFunction = &IntHalfbandFilterEO<qint64, qint64, DOWNCHANNELIZER_HB_FILTER_ORDER, true>::workDecimateCenter;
-            break;
-
-        case ModeLowerHalf:
-            m_workFunction = &IntHalfbandFilterEO<qint64, qint64, DOWNCHANNELIZER_HB_FILTER_ORDER, true>::workDecimateLowerHalf;
-            break;
-
-        case ModeUpperHalf:
-            m_workFunction = &IntHalfbandFilterEO<qint64, qint64, DOWNCHANNELIZER_HB_FILTER_ORDER, true>::workDecimateUpperHalf;
-            break;
-    }
 }
 #else
 DownChannelizer::FilterStage::FilterStage(Mode mode) :
     m_filter(new IntHalfbandFilterEO<qint32, qint32, DOWNCHANNELIZER_HB_FILTER_ORDER, true>),
-    m_workFunction(0),
     m_mode(mode),
     m_sse(true)
 {
-    switch(mode) {
-        case ModeCenter:
-            m_workFunction = &IntHalfbandFilterEO<qint32, qint32, DOWNCHANNELIZER_HB_FILTER_ORDER, true>::workDecimateCenter;
-            break;
-
-        case ModeLowerHalf:
-            m_workFunction = &IntHalfbandFilterEO<qint32, qint32, DOWNCHANNELIZER_HB_FILTER_ORDER, true>::workDecimateLowerHalf;
-            break;
-
-        case ModeUpperHalf:
-            m_workFunction = &IntHalfbandFilterEO<qint32, qint32, DOWNCHANNELIZER_HB_FILTER_ORDER, true>::workDecimateUpperHalf;
-            break;
-    }
 }
 #endif
 
@@ -299,6 +365,8 @@ double DownChannelizer::setFilterChain(const std::vector<unsigned int>& stageInd
 
 void DownChannelizer::freeFilterChain()
 {
+    freePipeline(); // workers refer to the filter stages
+
 	for(FilterStages::iterator it = m_filterStages.begin(); it != m_filterStages.end(); ++it)
 		delete *it;
 	m_filterStages.clear();
@@ -327,3 +395,175 @@ void DownChannelizer::debugFilterChain()
         }
     }
 }
+
+void DownChannelizer::createPipeline()
+{
+    freePipeline();
+
+    unsigned int maxWorkers = m_pipelineMaxWorkers.load();
+
+    if ((maxWorkers == 0) || (m_basebandSampleRate < m_pipelineMinSampleRate.load()) || (m_filterStages.size() == 0)) {
+        return;
+    }
+
+    // The first stage runs at the baseband rate and does as much work as all the following ones together
+    // so one worker per stage is created up to the maximum and the last worker takes the remaining stages.
+    // The sink is still fed in the caller thread. Workers are taken from the process wide budget.
+    int wanted = std::min((unsigned int) m_filterStages.size(), maxWorkers);
+    int budget = std::max(QThread::idealThreadCount() - 1, 0); // leave a core to the engine
+    int inUse = m_pipelineWorkersInUse.load();
+    int nbWorkers;
+
+    do
+    {
+        nbWorkers = std::min(wanted, budget - inUse);
+
+        if (nbWorkers <= 0) {
+            return;
+        }
+    } while (!m_pipelineWorkersInUse.compare_exchange_weak(inUse, inUse + nbWorkers));
+
+    m_pipeline.resize(nbWorkers);
+    FilterStages::const_iterator first = m_filterStages.begin();
+
+    for (int i = nbWorkers - 1; i >= 0; i--) // output side first
+    {
+        SampleBlockFifo *outputFifo = i == nbWorkers - 1 ? &m_pipelineOutputFifo : m_pipeline[i+1]->getInputFifo();
+        QSemaphore *outputSemaphore = i == nbWorkers - 1 ? &m_pipelineOutputSemaphore : m_pipeline[i+1]->getInputSemaphore();
+        FilterStages::const_iterator stageFirst = std::next(first, i);
+        FilterStages::const_iterator stageLast = i == nbWorkers - 1 ? m_filterStages.end() : std::next(stageFirst);
+        unsigned int outputShift = i == nbWorkers - 1 ? m_filterStages.size() : 0;
+        m_pipeline[i] = new PipelineStage(stageFirst, stageLast, outputShift, m_filterChain, m_pipelineMaxInFlight, outputFifo, outputSemaphore);
+    }
+
+    m_pipelinePool = new SampleBlockPool(m_pipelineMaxInFlight);
+
+    for (int i = 0; i < nbWorkers; i++) {
+        m_pipeline[i]->start();
+    }
+
+    qDebug("DownChannelizer::createPipeline: %d workers for %lu stages", nbWorkers, m_filterStages.size());
+}
+
+void DownChannelizer::freePipeline()
+{
+    if (m_pipeline.size() == 0) {
+        return;
+    }
+
+    // feed() always returns with an empty pipeline so there is nothing to flush
+    for (std::vector<PipelineStage*>::iterator it = m_pipeline.begin(); it != m_pipeline.end(); ++it)
+    {
+        (*it)->stop();
+        delete *it;
+    }
+
+    m_pipelineWorkersInUse -= (int) m_pipeline.size();
+    m_pipeline.clear();
+    m_pipelinePool->destroy();
+    m_pipelinePool = nullptr;
+}
+
+void DownChannelizer::feedPipeline(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end)
+{
+    for (SampleVector::const_iterator it = begin; it < end; it += m_pipelineBlockSize)
+    {
+        SampleVector::const_iterator blockEnd = (end - it) > m_pipelineBlockSize ? it + m_pipelineBlockSize : end;
+
+        if (m_pipelineInFlight == m_pipelineMaxInFlight)
+        {
+            m_pipelineOutputSemaphore.acquire();
+            deliverPipelineBlock();
+        }
+
+        m_pipeline.front()->push(m_pipelinePool->acquire(it, blockEnd));
+        m_pipelineInFlight++;
+
+        while (m_pipelineOutputSemaphore.tryAcquire()) { // sink works while the filters work on next blocks
+            deliverPipelineBlock();
+        }
+    }
+
+    while (m_pipelineInFlight != 0)
+    {
+        m_pipelineOutputSemaphore.acquire();
+        deliverPipelineBlock();
+    }
+}
+
+void DownChannelizer::deliverPipelineBlock()
+{
+    SampleBlockRef block;
+    m_pipelineOutputFifo.read(block);
+    m_pipelineInFlight--;
+
+    if (block.size() != 0) {
+        m_sampleSink->feed(block.begin(), block.end());
+    }
+}
+
+DownChannelizer::PipelineStage::PipelineStage(
+    FilterStages::const_iterator first,
+    FilterStages::const_iterator last,
+    unsigned int outputShift,
+    FilterChain filterChain,
+    unsigned int fifoSize,
+    SampleBlockFifo *outputFifo,
+    QSemaphore *outputSemaphore) :
+    m_filterStages(first, last),
+    m_outputShift(outputShift),
+    m_filterChain(filterChain),
+    m_inputFifo(fifoSize),
+    m_outputFifo(outputFifo),
+    m_outputSemaphore(outputSemaphore),
+    m_outputPool(new SampleBlockPool(fifoSize)),
+    m_stop(false)
+{
+}
+
+DownChannelizer::PipelineStage::~PipelineStage()
+{
+    m_inputFifo.reset();
+    m_outputPool->destroy();
+}
+
+void DownChannelizer::PipelineStage::push(const SampleBlockRef& block)
+{
+    m_inputFifo.write(block);
+    m_inputSemaphore.release();
+}
+
+void DownChannelizer::PipelineStage::stop()
+{
+    m_stop.store(true);
+    m_inputSemaphore.release();
+    wait();
+}
+
+void DownChannelizer::PipelineStage::run()
+{
+    SampleBlockRef block;
+
+    while (true)
+    {
+        m_inputSemaphore.acquire();
+
+        if (m_stop.load()) {
+            break;
+        }
+
+        m_inputFifo.read(block);
+        work(block);
+        block.reset();
+    }
+}
+
+void DownChannelizer::PipelineStage::work(const SampleBlockRef& block)
+{
+    m_sampleBuffer.clear();
+    m_filterChain(m_filterStages.data(), m_filterStages.size(), m_outputShift, block.begin(), block.end(), m_sampleBuffer);
+
+    // an empty block is passed on anyway so that the channelizer can count delivered blocks
+    m_outputFifo->write(m_outputPool->acquire(m_sampleBuffer.begin(), m_sampleBuffer.end()));
+    m_outputSemaphore->release();
+}
@@ -19,12 +19,17 @@
 #ifndef SDRBASE_DSP_DOWNCHANNELIZER_H
 #define SDRBASE_DSP_DOWNCHANNELIZER_H
 
-#include <list>
+#include <atomic>
 #include <vector>
 
+#include <QThread>
+#include <QSemaphore>
+
 #include "export.h"
 #include "util/message.h"
 #include "dsp/inthalfbandfiltereo.h"
+#include "dsp/sampleblock.h"
+#include "dsp/sampleblockfifo.h"
 
 #include "channelsamplesink.h"
 
@@ -43,6 +48,16 @@ public:
 	int getBasebandSampleRate() const { return m_basebandSampleRate; }
     int getChannelSampleRate() const { return m_channelSampleRate; }
 	int getChannelFrequencyOffset() const { return m_channelFrequencyOffset; }
+    bool isPipelined() const { return m_pipeline.size() != 0; }
+
+    // Filter chains of basebands at or above 10 MS/s run on up to 2 workers by default. All channelizers of the process
+    // share a budget of one worker per core minus one and a channelizer that finds the budget exhausted runs its chain inline.
+    static void setPipelineMaxWorkers(unsigned int maxWorkers) { m_pipelineMaxWorkers.store(maxWorkers); } //!< workers per channelizer. 0 disables pipelining. Applies on next channelization.
+    static unsigned int getPipelineMaxWorkers() { return m_pipelineMaxWorkers.load(); }
+    static void setPipelineMinSampleRate(int sampleRate) { m_pipelineMinSampleRate.store(sampleRate); } //!< pipeline filter chains of baseband at or above this rate
+    static int getPipelineMinSampleRate() { return m_pipelineMinSampleRate.load(); }
+    static int getPipelineWorkersInUse() { return m_pipelineWorkersInUse.load(); } //!< over all channelizers
+    void setKernelLevel(CPUFeatures::SIMDLevel level); //!< use a specific half-band filter kernel instead of the best one for the host CPU (benchmarks). Applies on next channelization.
 
 protected:
 	struct FilterStage {
@@ -53,27 +68,125 @@ protected:
 		};
 
 #ifdef SDR_RX_SAMPLE_24BIT
-        typedef bool (IntHalfbandFilterEO<qint64, qint64, DOWNCHANNELIZER_HB_FILTER_ORDER, true>::*WorkFunction)(Sample* s);
         IntHalfbandFilterEO<qint64, qint64, DOWNCHANNELIZER_HB_FILTER_ORDER, true>* m_filter;
 #else
-        typedef bool (IntHalfbandFilterEO<qint32, qint32, DOWNCHANNELIZER_HB_FILTER_ORDER, true>::*WorkFunction)(Sample* s);
         IntHalfbandFilterEO<qint32, qint32, DOWNCHANNELIZER_HB_FILTER_ORDER, true>* m_filter;
 #endif
 
-		WorkFunction m_workFunction;
 		Mode m_mode;
 		bool m_sse;
 
 		FilterStage(Mode mode);
 		~FilterStage();
 
+		template<typename FIR>
 		bool work(Sample* sample)
 		{
-			return (m_filter->*m_workFunction)(sample);
+			switch (m_mode)
+			{
+			case ModeLowerHalf:
+				return m_filter->template workDecimateLowerHalf<FIR>(sample);
+			case ModeUpperHalf:
+				return m_filter->template workDecimateUpperHalf<FIR>(sample);
+			default:
+				return m_filter->template workDecimateCenter<FIR>(sample);
+			}
 		}
 	};
-	typedef std::list<FilterStage*> FilterStages;
+	typedef std::vector<FilterStage*> FilterStages;
+
+    /**
+     * Runs a block of samples through a filter chain appending the output to out. 24 bit output samples
+     * are divided by 1<<outputShift. There is one function per half-band filter kernel with the kernel inlined
+     * so that the kernel is selected once per channelizer and not once per output sample.
+     */
+    typedef void (*FilterChain)(
+        FilterStage* const *stages,
+        unsigned int nbStages,
+        unsigned int outputShift,
+        const SampleVector::const_iterator& begin,
+        const SampleVector::const_iterator& end,
+        SampleVector& out);
+
+    template<typename FIR>
+    static void filterChain(
+        FilterStage* const *stages,
+        unsigned int nbStages,
+        unsigned int outputShift,
+        const SampleVector::const_iterator& begin,
+        const SampleVector::const_iterator& end,
+        SampleVector& out);
+
+    static FilterChain getFilterChain(CPUFeatures::SIMDLevel level);
+    HBFIR_FLATTEN static void filterChainGeneric(FilterStage* const *stages, unsigned int nbStages, unsigned int outputShift,
+        const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end, SampleVector& out);
+#if defined(HBFIR_X86) && defined(SDR_RX_SAMPLE_24BIT)
+    HBFIR_TARGET("sse4.1") HBFIR_FLATTEN static void filterChainSSE41(FilterStage* const *stages, unsigned int nbStages, unsigned int outputShift,
+        const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end, SampleVector& out);
+    HBFIR_TARGET("avx2") HBFIR_FLATTEN static void filterChainAVX2(FilterStage* const *stages, unsigned int nbStages, unsigned int outputShift,
+        const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end, SampleVector& out);
+    HBFIR_TARGET("avx512f") HBFIR_FLATTEN static void filterChainAVX512(FilterStage* const *stages, unsigned int nbStages, unsigned int outputShift,
+        const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end, SampleVector& out);
+#endif
+#if defined(HBFIR_NEON) && defined(SDR_RX_SAMPLE_24BIT)
+    HBFIR_FLATTEN static void filterChainNEON(FilterStage* const *stages, unsigned int nbStages, unsigned int outputShift,
+        const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end, SampleVector& out);
+#endif
+
+    /**
+     * Runs a consecutive part of the filter chain on its own thread. Blocks of samples come in through a
+     * wait-free block FIFO and go out to the next pipeline stage FIFO or to the channelizer output FIFO.
+     * The semaphores only count the blocks to wake up the consumers.
+     */
+    class PipelineStage : public QThread
+    {
+    public:
+        PipelineStage(
+            FilterStages::const_iterator first,
+            FilterStages::const_iterator last,
+            unsigned int outputShift,
+            FilterChain filterChain,
+            unsigned int fifoSize,
+            SampleBlockFifo *outputFifo,
+            QSemaphore *outputSemaphore);
+        ~PipelineStage();
+
+        void push(const SampleBlockRef& block);
+        SampleBlockFifo *getInputFifo() { return &m_inputFifo; }
+        QSemaphore *getInputSemaphore() { return &m_inputSemaphore; }
+        void stop();
+
+    protected:
+        virtual void run();
+
+    private:
+        std::vector<FilterStage*> m_filterStages; //!< not owned
+        unsigned int m_outputShift;               //!< final scaling of 24 bit samples: chain length on the last worker else 0
+        FilterChain m_filterChain;
+        SampleBlockFifo m_inputFifo;
+        QSemaphore m_inputSemaphore;
+        SampleBlockFifo *m_outputFifo;
+        QSemaphore *m_outputSemaphore;
+        SampleBlockPool *m_outputPool;
+        SampleVector m_sampleBuffer;
+        std::atomic<bool> m_stop;
+
+        void work(const SampleBlockRef& block);
+    };
+
 	FilterStages m_filterStages;
+    FilterChain m_filterChain;
+    std::vector<PipelineStage*> m_pipeline;
+    SampleBlockPool *m_pipelinePool;  //!< pipeline input blocks
+    SampleBlockFifo m_pipelineOutputFifo;
+    QSemaphore m_pipelineOutputSemaphore;
+    unsigned int m_pipelineInFlight;  //!< blocks pushed in the pipeline not yet delivered to the sink
+    static std::atomic<unsigned int> m_pipelineMaxWorkers;
+    static std::atomic<int> m_pipelineMinSampleRate;
+    static std::atomic<int> m_pipelineWorkersInUse;
+    static const unsigned int m_pipelineBlockSize = 8192;  //!< input samples per pipeline block
+    static const unsigned int m_pipelineMaxInFlight = 16;  //!< also the size of the block FIFOs
+
     bool m_filterChainSetMode;
 	ChannelSampleSink* m_sampleSink; //!< Demodulator
     int m_basebandSampleRate;
@@ -92,6 +205,10 @@ protected:
     double setFilterChain(const std::vector<unsigned int>& stageIndexes);
 	void freeFilterChain();
 	void debugFilterChain();
+    void createPipeline();
+    void freePipeline();
+    void feedPipeline(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end);
+    void deliverPipelineBlock();
 };
 
 #endif // SDRBASE_DSP_DOWNCHANNELIZER_H
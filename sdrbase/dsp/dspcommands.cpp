@@ -38,9 +38,13 @@ MESSAGE_CLASS_DEFINITION(DSPRemoveBasebandSampleSource, Message)
 MESSAGE_CLASS_DEFINITION(DSPAddAudioSink, Message)
 MESSAGE_CLASS_DEFINITION(DSPRemoveAudioSink, Message)
 MESSAGE_CLASS_DEFINITION(DSPConfigureCorrection, Message)
+MESSAGE_CLASS_DEFINITION(DSPConfigureSharedChannelizer, Message)
+MESSAGE_CLASS_DEFINITION(DSPConfigureSubbandRequest, Message)
+MESSAGE_CLASS_DEFINITION(DSPSubbandNotification, Message)
 MESSAGE_CLASS_DEFINITION(DSPEngineReport, Message)
 MESSAGE_CLASS_DEFINITION(DSPConfigureScopeVis, Message)
 MESSAGE_CLASS_DEFINITION(DSPSignalNotification, Message)
+MESSAGE_POOL_DEFINITION(DSPSignalNotification)
 MESSAGE_CLASS_DEFINITION(DSPMIMOSignalNotification, Message)
 MESSAGE_CLASS_DEFINITION(DSPConfigureChannelizer, Message)
 MESSAGE_CLASS_DEFINITION(DSPConfigureAudio, Message)
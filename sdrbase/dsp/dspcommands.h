@@ -21,6 +21,7 @@
 
 #include <QString>
 #include "util/message.h"
+#include "util/messagepool.h"
 #include "fftwindow.h"
 #include "export.h"
 
@@ -226,6 +227,78 @@ private:
 
 };
 
+class SDRBASE_API DSPConfigureSharedChannelizer : public Message {
+	MESSAGE_CLASS_DECLARATION
+
+public:
+	DSPConfigureSharedChannelizer(bool enable, unsigned int log2NbSubbands) :
+		Message(),
+		m_enable(enable),
+		m_log2NbSubbands(log2NbSubbands)
+	{ }
+
+	bool getEnable() const { return m_enable; }
+	unsigned int getLog2NbSubbands() const { return m_log2NbSubbands; }
+
+private:
+	bool m_enable;
+	unsigned int m_log2NbSubbands;
+};
+
+/**
+ * Sent by a baseband sink to the device engine to be fed by the shared channelizer with the
+ * sub-band containing its channel. It is sent again each time the channel offset, bandwidth
+ * or minimum input sample rate changes so that the engine never has to read the channel
+ * settings from its own thread.
+ */
+class SDRBASE_API DSPConfigureSubbandRequest : public Message {
+	MESSAGE_CLASS_DECLARATION
+
+public:
+	DSPConfigureSubbandRequest(BasebandSampleSink* sink, qint64 frequencyOffset, int bandwidth, int sampleRate) :
+		Message(),
+		m_sink(sink),
+		m_frequencyOffset(frequencyOffset),
+		m_bandwidth(bandwidth),
+		m_sampleRate(sampleRate)
+	{ }
+
+	BasebandSampleSink* getSink() const { return m_sink; }
+	qint64 getFrequencyOffset() const { return m_frequencyOffset; }
+	int getBandwidth() const { return m_bandwidth; }
+	int getSampleRate() const { return m_sampleRate; }
+
+private:
+	BasebandSampleSink* m_sink;
+	qint64 m_frequencyOffset;
+	int m_bandwidth;
+	int m_sampleRate; //!< minimum input sample rate of the sink
+};
+
+/**
+ * Sent by the device engine to a baseband sink that is fed by the shared channelizer.
+ * The sink receives a sub-band of the baseband at the given sample rate centered at the
+ * given offset from the device center frequency. When the sink is fed back with the full
+ * baseband the offset is zero and the sample rate is the baseband sample rate.
+ */
+class SDRBASE_API DSPSubbandNotification : public Message {
+	MESSAGE_CLASS_DECLARATION
+
+public:
+	DSPSubbandNotification(int sampleRate, qint64 subbandFrequencyOffset) :
+		Message(),
+		m_sampleRate(sampleRate),
+		m_subbandFrequencyOffset(subbandFrequencyOffset)
+	{ }
+
+	int getSampleRate() const { return m_sampleRate; }
+	qint64 getSubbandFrequencyOffset() const { return m_subbandFrequencyOffset; }
+
+private:
+	int m_sampleRate;
+	qint64 m_subbandFrequencyOffset;
+};
+
 class SDRBASE_API DSPEngineReport : public Message {
 	MESSAGE_CLASS_DECLARATION
 
@@ -267,6 +340,7 @@ private:
 
 class SDRBASE_API DSPSignalNotification : public Message {
 	MESSAGE_CLASS_DECLARATION
+	MESSAGE_POOL_DECLARATION
 
 public:
 	DSPSignalNotification(int samplerate, qint64 centerFrequency) :
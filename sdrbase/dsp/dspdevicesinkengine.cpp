@@ -17,6 +17,7 @@
 ///////////////////////////////////////////////////////////////////////////////////
 
 #include <stdio.h>
+#include <algorithm>
 #include <QDebug>
 #include <QThread>
 
@@ -26,8 +27,12 @@
 #include "dsp/basebandsamplesink.h"
 #include "dsp/devicesamplesink.h"
 #include "dsp/dspcommands.h"
+#include "dsp/samplesumkernels.h"
 #include "samplesourcefifodb.h"
 
+unsigned int DSPDeviceSinkEngine::m_pullMaxWorkers = 3;
+const unsigned int DSPDeviceSinkEngine::m_sumBlockSize;
+
 DSPDeviceSinkEngine::DSPDeviceSinkEngine(uint32_t uid, QObject* parent) :
 	QThread(parent),
     m_uid(uid),
@@ -37,7 +42,9 @@ DSPDeviceSinkEngine::DSPDeviceSinkEngine(uint32_t uid, QObject* parent) :
 	m_basebandSampleSources(),
 	m_spectrumSink(nullptr),
 	m_sampleRate(0),
-	m_centerFrequency(0)
+	m_centerFrequency(0),
+    m_pullNbSamples(0),
+    m_pullNext(0)
 {
 	connect(&m_inputMessageQueue, SIGNAL(messageEnqueued()), this, SLOT(handleInputMessages()), Qt::QueuedConnection);
 	connect(&m_syncMessenger, SIGNAL(messageSent()), this, SLOT(handleSynchronousMessages()), Qt::QueuedConnection);
@@ -49,6 +56,7 @@ DSPDeviceSinkEngine::~DSPDeviceSinkEngine()
 {
     stop();
 	wait();
+    setPullWorkers(0);
 }
 
 void DSPDeviceSinkEngine::run()
@@ -204,32 +212,22 @@ void DSPDeviceSinkEngine::workSamples(SampleVector& data, unsigned int iBegin, u
     }
     else
     {
-        m_sourceSampleBuffer.allocate(nbSamples);
-        SampleVector::iterator sBegin = m_sourceSampleBuffer.m_vector.begin();
-        BasebandSampleSources::const_iterator srcIt = m_basebandSampleSources.begin();
-        BasebandSampleSource *source = *srcIt;
-        source->pull(begin, nbSamples);
-        srcIt++;
-        m_sumIndex = 1;
+        // pull all sources in parallel then sum them divided by N in one pass per block
+        pullSources(nbSamples);
+        const SampleSumKernels& kernels = SampleSumKernels::instance();
+        unsigned int nbSources = m_pullSources.size();
+        m_sumBuffer.resize(2 * m_sumBlockSize);
 
-        for (; srcIt != m_basebandSampleSources.end(); ++srcIt, m_sumIndex++)
+        for (unsigned int i = 0; i < nbSamples; i += m_sumBlockSize)
         {
-            source = *srcIt;
-            source->pull(sBegin, nbSamples);
-            std::transform(
-                sBegin,
-                sBegin + nbSamples,
-                data.begin() + iBegin,
-                data.begin() + iBegin,
-                [this](Sample& a, const Sample& b) -> Sample {
-                    int den = m_sumIndex + 1; // at each stage scale sum by n/n+1 and input by 1/n+1
-                    int nom = m_sumIndex;     // so that final sum is scaled by N (number of channels)
-                    return Sample{
-                        a.real()/den + nom*(b.real()/den),
-                        a.imag()/den + nom*(b.imag()/den)
-                    };
-                }
-            );
+            unsigned int n = std::min(m_sumBlockSize, nbSamples - i);
+            std::fill(m_sumBuffer.begin(), m_sumBuffer.begin() + 2 * n, 0);
+
+            for (unsigned int s = 0; s < m_pullSources.size(); s++) {
+                kernels.getAccumulate()((const FixReal *) &m_pullBuffers[s][i], m_sumBuffer.data(), 2 * n);
+            }
+
+            kernels.getNormalize()(m_sumBuffer.data(), (FixReal *) &data[iBegin + i], 2 * n, nbSources);
         }
     }
 
@@ -239,6 +237,98 @@ void DSPDeviceSinkEngine::workSamples(SampleVector& data, unsigned int iBegin, u
     }
 }
 
+void DSPDeviceSinkEngine::pullSources(unsigned int nbSamples)
+{
+    m_pullSources.assign(m_basebandSampleSources.begin(), m_basebandSampleSources.end());
+
+    if (m_pullBuffers.size() < m_pullSources.size()) {
+        m_pullBuffers.resize(m_pullSources.size());
+    }
+
+    for (unsigned int s = 0; s < m_pullSources.size(); s++)
+    {
+        if (m_pullBuffers[s].size() < nbSamples) {
+            m_pullBuffers[s].resize(nbSamples);
+        }
+    }
+
+    // the engine thread pulls too so one source is left to it
+    unsigned int idealThreadCount = std::max(QThread::idealThreadCount(), 1);
+    setPullWorkers(std::min({(unsigned int) m_pullSources.size() - 1, m_pullMaxWorkers, idealThreadCount - 1}));
+    m_pullNbSamples = nbSamples;
+    m_pullNext.store(0);
+
+    for (SourcePullWorker *worker : m_pullWorkers) {
+        worker->pull();
+    }
+
+    pullNextSources();
+    m_pullDoneSemaphore.acquire(m_pullWorkers.size());
+}
+
+void DSPDeviceSinkEngine::pullNextSources()
+{
+    unsigned int s;
+
+    while ((s = m_pullNext.fetch_add(1)) < m_pullSources.size()) {
+        m_pullSources[s]->pull(m_pullBuffers[s].begin(), m_pullNbSamples);
+    }
+}
+
+void DSPDeviceSinkEngine::setPullWorkers(unsigned int nbWorkers)
+{
+    if (nbWorkers == m_pullWorkers.size()) {
+        return;
+    }
+
+    qDebug("DSPDeviceSinkEngine::setPullWorkers: %u workers", nbWorkers);
+
+    for (SourcePullWorker *worker : m_pullWorkers) {
+        delete worker;
+    }
+
+    m_pullWorkers.clear();
+
+    for (unsigned int i = 0; i < nbWorkers; i++)
+    {
+        m_pullWorkers.push_back(new SourcePullWorker(this));
+        m_pullWorkers.back()->start();
+    }
+}
+
+DSPDeviceSinkEngine::SourcePullWorker::SourcePullWorker(DSPDeviceSinkEngine *engine) :
+    m_engine(engine),
+    m_stop(false)
+{
+}
+
+DSPDeviceSinkEngine::SourcePullWorker::~SourcePullWorker()
+{
+    stop();
+}
+
+void DSPDeviceSinkEngine::SourcePullWorker::stop()
+{
+    m_stop.store(true);
+    m_startSemaphore.release();
+    wait();
+}
+
+void DSPDeviceSinkEngine::SourcePullWorker::run()
+{
+    while (true)
+    {
+        m_startSemaphore.acquire();
+
+        if (m_stop.load()) {
+            break;
+        }
+
+        m_engine->pullNextSources();
+        m_engine->m_pullDoneSemaphore.release();
+    }
+}
+
 // notStarted -> idle -> init -> running -+
 //                ^                       |
 //                +-----------------------+
@@ -490,6 +580,10 @@ void DSPDeviceSinkEngine::handleSynchronousMessages()
 		}
 
 		m_basebandSampleSources.remove(source);
+
+        if (m_basebandSampleSources.size() < 2) { // no more summing
+            setPullWorkers(0);
+        }
 	}
 
 	m_syncMessenger.done(m_state);
@@ -22,11 +22,14 @@
 #include <QThread>
 #include <QTimer>
 #include <QMutex>
+#include <QSemaphore>
 #include <QWaitCondition>
 
 #include <stdint.h>
+#include <atomic>
 #include <list>
 #include <map>
+#include <vector>
 
 #include "dsp/dsptypes.h"
 #include "dsp/fftwindow.h"
@@ -80,7 +83,33 @@ public:
 	QString errorMessage(); //!< Return the current error message
 	QString sinkDeviceDescription(); //!< Return the sink device description
 
+    static void setPullMaxWorkers(unsigned int maxWorkers) { m_pullMaxWorkers = maxWorkers; } //!< 0 pulls all sources on the engine thread
+    static unsigned int getPullMaxWorkers() { return m_pullMaxWorkers; }
+
 private:
+    /**
+     * Pulls baseband sources in parallel with the engine thread. Each round the workers and the
+     * engine thread take the next source to pull until all are done. The semaphores order the
+     * pull parameters and the source buffers between the threads.
+     */
+    class SourcePullWorker : public QThread
+    {
+    public:
+        SourcePullWorker(DSPDeviceSinkEngine *engine);
+        ~SourcePullWorker();
+
+        void pull() { m_startSemaphore.release(); } //!< start a round
+        void stop();
+
+    protected:
+        virtual void run();
+
+    private:
+        DSPDeviceSinkEngine *m_engine;
+        QSemaphore m_startSemaphore;
+        std::atomic<bool> m_stop;
+    };
+
 	uint32_t m_uid; //!< unique ID
 
 	MessageQueue m_inputMessageQueue;  //<! Input message queue. Post here.
@@ -98,16 +127,27 @@ private:
 	BasebandSampleSources m_basebandSampleSources; //!< baseband sample sources within main thread (usually file input)
 
 	BasebandSampleSink *m_spectrumSink;
-    IncrementalVector<Sample> m_sourceSampleBuffer;
     IncrementalVector<Sample> m_sourceZeroBuffer;
 
 	uint32_t m_sampleRate;
 	quint64 m_centerFrequency;
-    unsigned int m_sumIndex; //!< channel index when summing channels
+
+    std::vector<BasebandSampleSource*> m_pullSources; //!< sources of the current pull round
+    std::vector<SampleVector> m_pullBuffers;          //!< samples of each source in the round
+    unsigned int m_pullNbSamples;
+    std::atomic<unsigned int> m_pullNext;             //!< next source to pull in the round
+    std::vector<SourcePullWorker*> m_pullWorkers;
+    QSemaphore m_pullDoneSemaphore;
+    std::vector<qint32> m_sumBuffer;
+    static unsigned int m_pullMaxWorkers;
+    static const unsigned int m_sumBlockSize = 4096;  //!< samples summed per pass so that the sum stays in cache
 
 	void run();
 	void workSampleFifo(); //!< transfer samples from baseband sources to sink if in running state
     void workSamples(SampleVector& data, unsigned int iBegin, unsigned int iEnd);
+    void pullSources(unsigned int nbSamples); //!< pull all sources in their buffers
+    void pullNextSources();                   //!< pull sources of the current round until none is left
+    void setPullWorkers(unsigned int nbWorkers);
 
 	State gotoIdle();     //!< Go to the idle state
 	State gotoInit();     //!< Go to the acquisition init state from idle
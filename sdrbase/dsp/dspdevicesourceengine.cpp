@@ -23,8 +23,8 @@
 #include <stdio.h>
 #include <QDebug>
 #include "dsp/dspcommands.h"
-#include "util/fixed.h"
 #include "samplesinkfifo.h"
+#include "sampleblock.h"
 
 DSPDeviceSourceEngine::DSPDeviceSourceEngine(uint uid, QObject* parent) :
 	QThread(parent),
@@ -35,6 +35,9 @@ DSPDeviceSourceEngine::DSPDeviceSourceEngine(uint uid, QObject* parent) :
 	m_basebandSampleSinks(),
 	m_sampleRate(0),
 	m_centerFrequency(0),
+	m_sharedChannelizerEnabled(false),
+	m_sharedChannelizerLog2Subbands(6),
+	m_sampleBlockPool(new SampleBlockPool()),
 	m_dcOffsetCorrection(false),
 	m_iqImbalanceCorrection(false),
 	m_iOffset(0),
@@ -53,6 +56,7 @@ DSPDeviceSourceEngine::~DSPDeviceSourceEngine()
 {
     stop();
     wait();
+    m_sampleBlockPool->destroy(); // actually deleted when sinks release their last blocks
 }
 
 void DSPDeviceSourceEngine::run()
@@ -141,6 +145,19 @@ void DSPDeviceSourceEngine::configureCorrections(bool dcOffsetCorrection, bool i
 	m_inputMessageQueue.push(cmd);
 }
 
+void DSPDeviceSourceEngine::configureSharedChannelizer(bool enable, unsigned int log2NbSubbands)
+{
+	qDebug() << "DSPDeviceSourceEngine::configureSharedChannelizer: enable: " << enable << " log2NbSubbands: " << log2NbSubbands;
+	DSPConfigureSharedChannelizer* cmd = new DSPConfigureSharedChannelizer(enable, log2NbSubbands);
+	m_inputMessageQueue.push(cmd);
+}
+
+void DSPDeviceSourceEngine::configureSubbandRequest(BasebandSampleSink* sink, qint64 frequencyOffset, int bandwidth, int sampleRate)
+{
+	DSPConfigureSubbandRequest* cmd = new DSPConfigureSubbandRequest(sink, frequencyOffset, bandwidth, sampleRate);
+	m_inputMessageQueue.push(cmd);
+}
+
 QString DSPDeviceSourceEngine::errorMessage()
 {
 	qDebug() << "DSPDeviceSourceEngine::errorMessage";
@@ -159,103 +176,12 @@ QString DSPDeviceSourceEngine::sourceDeviceDescription()
 
 void DSPDeviceSourceEngine::iqCorrections(SampleVector::iterator begin, SampleVector::iterator end, bool imbalanceCorrection)
 {
-    for(SampleVector::iterator it = begin; it < end; it++)
-    {
-        m_iBeta(it->real());
-        m_qBeta(it->imag());
-
-        if (imbalanceCorrection)
-        {
-#if IMBALANCE_INT
-            // acquisition
-            int64_t xi = (it->m_real - (int32_t) m_iBeta) << 5;
-            int64_t xq = (it->m_imag - (int32_t) m_qBeta) << 5;
-
-            // phase imbalance
-            m_avgII((xi*xi)>>28); // <I", I">
-            m_avgIQ((xi*xq)>>28); // <I", Q">
-
-            if ((int64_t) m_avgII != 0)
-            {
-                int64_t phi = (((int64_t) m_avgIQ)<<28) / (int64_t) m_avgII;
-                m_avgPhi(phi);
-            }
-
-            int64_t corrPhi = (((int64_t) m_avgPhi) * xq) >> 28;  //(m_avgPhi.asDouble()/16777216.0) * ((double) xq);
-
-            int64_t yi = xi - corrPhi;
-            int64_t yq = xq;
-
-            // amplitude I/Q imbalance
-            m_avgII2((yi*yi)>>28); // <I, I>
-            m_avgQQ2((yq*yq)>>28); // <Q, Q>
-
-            if ((int64_t) m_avgQQ2 != 0)
-            {
-                int64_t a = (((int64_t) m_avgII2)<<28) / (int64_t) m_avgQQ2;
-                Fixed<int64_t, 28> fA(Fixed<int64_t, 28>::internal(), a);
-                Fixed<int64_t, 28> sqrtA = sqrt((Fixed<int64_t, 28>) fA);
-                m_avgAmp(sqrtA.as_internal());
-            }
-
-            int64_t zq = (((int64_t) m_avgAmp) * yq) >> 28;
-
-            it->m_real = yi >> 5;
-            it->m_imag = zq >> 5;
-
-#else
-            // DC correction and conversion
-            float xi = (it->m_real - (int32_t) m_iBeta) / SDR_RX_SCALEF;
-            float xq = (it->m_imag - (int32_t) m_qBeta) / SDR_RX_SCALEF;
-
-            // phase imbalance
-            m_avgII(xi*xi); // <I", I">
-            m_avgIQ(xi*xq); // <I", Q">
-
-
-            if (m_avgII.asDouble() != 0) {
-                m_avgPhi(m_avgIQ.asDouble()/m_avgII.asDouble());
-            }
-
-            float& yi = xi; // the in phase remains the reference
-            float yq = xq - m_avgPhi.asDouble()*xi;
-
-            // amplitude I/Q imbalance
-            m_avgII2(yi*yi); // <I, I>
-            m_avgQQ2(yq*yq); // <Q, Q>
-
-            if (m_avgQQ2.asDouble() != 0) {
-                m_avgAmp(sqrt(m_avgII2.asDouble() / m_avgQQ2.asDouble()));
-            }
-
-            // final correction
-            float& zi = yi; // the in phase remains the reference
-            float zq = m_avgAmp.asDouble() * yq;
-
-            // convert and store
-            it->m_real = zi * SDR_RX_SCALEF;
-            it->m_imag = zq * SDR_RX_SCALEF;
-#endif
-        }
-        else
-        {
-            // DC correction only
-            it->m_real -= (int32_t) m_iBeta;
-            it->m_imag -= (int32_t) m_qBeta;
-        }
-    }
+    m_iqCorrector.process(begin, end, imbalanceCorrection);
 }
 
 void DSPDeviceSourceEngine::dcOffset(SampleVector::iterator begin, SampleVector::iterator end)
 {
-	// sum and correct in one pass
-	for(SampleVector::iterator it = begin; it < end; it++)
-	{
-	    m_iBeta(it->real());
-	    m_qBeta(it->imag());
-	    it->m_real -= (int32_t) m_iBeta;
-	    it->m_imag -= (int32_t) m_qBeta;
-	}
+    m_iqCorrector.process(begin, end, false);
 }
 
 void DSPDeviceSourceEngine::imbalance(SampleVector::iterator begin, SampleVector::iterator end)
@@ -332,11 +258,7 @@ void DSPDeviceSourceEngine::work()
             }
 
 			// feed data to direct sinks
-			for (BasebandSampleSinks::const_iterator it = m_basebandSampleSinks.begin(); it != m_basebandSampleSinks.end(); ++it)
-			{
-				(*it)->feed(part1begin, part1end, positiveOnly);
-			}
-
+			feedSinks(part1begin, part1end, positiveOnly);
 		}
 
 		// second part of FIFO data (used when block wraps around)
@@ -349,11 +271,28 @@ void DSPDeviceSourceEngine::work()
             }
 
 			// feed data to direct sinks
-			for (BasebandSampleSinks::const_iterator it = m_basebandSampleSinks.begin(); it != m_basebandSampleSinks.end(); it++)
+			feedSinks(part2begin, part2end, positiveOnly);
+		}
+
+		// feed sub-band data to sinks served by the shared channelizer
+		if (m_subbandSinks.size() != 0)
+		{
+			for (SubbandSinks::const_iterator it = m_subbandSinks.begin(); it != m_subbandSinks.end(); ++it)
 			{
-				(*it)->feed(part2begin, part2end, positiveOnly);
+				const SampleVector& subbandSamples = m_sharedChannelizer.getSubbandSamples(it->second);
+
+				if (subbandSamples.size() == 0) {
+					continue;
+				}
+
+				if (it->first->acceptsBlocks()) {
+					it->first->feedBlock(m_sampleBlockPool->acquire(subbandSamples.begin(), subbandSamples.end()), positiveOnly);
+				} else {
+					it->first->feed(subbandSamples.begin(), subbandSamples.end(), positiveOnly);
+				}
 			}
 
+			m_sharedChannelizer.clearSubbandSamples();
 		}
 
 		// adjust FIFO pointers
@@ -362,6 +301,113 @@ void DSPDeviceSourceEngine::work()
 	}
 }
 
+void DSPDeviceSourceEngine::feedSinks(SampleVector::iterator begin, SampleVector::iterator end, bool positiveOnly)
+{
+	if (m_subbandSinks.size() != 0) { // one filterbank pass serves all sub-band sinks
+		m_sharedChannelizer.feed(begin, end);
+	}
+
+	SampleBlockRef block; // the only copy of the data for all the sinks accepting blocks
+
+	for (BasebandSampleSinks::const_iterator it = m_basebandSampleSinks.begin(); it != m_basebandSampleSinks.end(); ++it)
+	{
+		if (m_subbandSinks.find(*it) != m_subbandSinks.end()) {
+			continue;
+		}
+
+		if ((*it)->acceptsBlocks())
+		{
+			if (block.isNull()) {
+				block = m_sampleBlockPool->acquire(begin, end);
+			}
+
+			(*it)->feedBlock(block, positiveOnly);
+		}
+		else
+		{
+			(*it)->feed(begin, end, positiveOnly);
+		}
+	}
+}
+
+void DSPDeviceSourceEngine::updateSubbandSinks()
+{
+	bool changed = false;
+
+	for (BasebandSampleSinks::const_iterator it = m_basebandSampleSinks.begin(); it != m_basebandSampleSinks.end(); ++it)
+	{
+		int subbandIndex = -1;
+		SubbandRequests::const_iterator rit = m_subbandRequests.find(*it);
+
+		if (m_sharedChannelizerEnabled && (m_sharedChannelizer.getNbSubbands() != 0) && (rit != m_subbandRequests.end())
+			&& (m_sharedChannelizer.getSubbandSampleRate() >= rit->second.m_sampleRate))
+		{
+			unsigned int nearest = m_sharedChannelizer.getNearestSubband(rit->second.m_frequencyOffset);
+
+			if (m_sharedChannelizer.subbandContainsChannel(nearest, rit->second.m_frequencyOffset, rit->second.m_bandwidth)) {
+				subbandIndex = nearest;
+			}
+		}
+
+		SubbandSinks::iterator sit = m_subbandSinks.find(*it);
+		int currentIndex = sit == m_subbandSinks.end() ? -1 : sit->second;
+
+		if (subbandIndex == currentIndex) {
+			continue;
+		}
+
+		changed = true;
+
+		if (subbandIndex < 0)
+		{
+			m_subbandSinks.erase(sit);
+			DSPSubbandNotification notif(m_sampleRate, 0);
+			(*it)->handleMessage(notif);
+		}
+		else
+		{
+			m_subbandSinks[*it] = subbandIndex;
+			DSPSubbandNotification notif(
+				m_sharedChannelizer.getSubbandSampleRate(),
+				m_sharedChannelizer.getSubbandFrequencyOffset(subbandIndex)
+			);
+			(*it)->handleMessage(notif);
+		}
+
+		qDebug("DSPDeviceSourceEngine::updateSubbandSinks: %s: sub-band: %d",
+			qPrintable((*it)->objectName()), subbandIndex);
+	}
+
+	if (changed) {
+		updateActiveSubbands();
+	}
+}
+
+void DSPDeviceSourceEngine::updateActiveSubbands()
+{
+	m_sharedChannelizer.clearActiveSubbands();
+
+	for (SubbandSinks::const_iterator it = m_subbandSinks.begin(); it != m_subbandSinks.end(); ++it) {
+		m_sharedChannelizer.setSubbandActive(it->second, true);
+	}
+}
+
+void DSPDeviceSourceEngine::resetSubbandSinks(bool notify)
+{
+	if (notify)
+	{
+		DSPSubbandNotification notif(m_sampleRate, 0);
+
+		for (SubbandSinks::const_iterator it = m_subbandSinks.begin(); it != m_subbandSinks.end(); ++it) {
+			it->first->handleMessage(notif);
+		}
+	}
+
+	m_subbandSinks.clear();
+	m_sharedChannelizer.clearActiveSubbands();
+	m_sharedChannelizer.clearSubbandSamples();
+}
+
 // notStarted -> idle -> init -> running -+
 //                ^                       |
 //                +-----------------------+
@@ -440,6 +486,12 @@ DSPDeviceSourceEngine::State DSPDeviceSourceEngine::gotoInit()
 			<< " sampleRate: " << m_sampleRate
 			<< " centerFrequency: " << m_centerFrequency;
 
+	resetSubbandSinks(false); // sinks are re-initialized with the full baseband just below
+
+	if (m_sharedChannelizerEnabled) {
+		m_sharedChannelizer.configure(m_sharedChannelizerLog2Subbands, m_sampleRate);
+	}
+
 	DSPSignalNotification notif(m_sampleRate, m_centerFrequency);
 
 	for (BasebandSampleSinks::const_iterator it = m_basebandSampleSinks.begin(); it != m_basebandSampleSinks.end(); ++it)
@@ -448,6 +500,8 @@ DSPDeviceSourceEngine::State DSPDeviceSourceEngine::gotoInit()
 		(*it)->handleMessage(notif);
 	}
 
+	updateSubbandSinks();
+
 	// pass data to listeners
 	if (m_deviceSampleSource->getMessageQueueToGUI())
 	{
@@ -583,6 +637,7 @@ void DSPDeviceSourceEngine::handleSynchronousMessages()
         // initialize sample rate and center frequency in the sink:
         DSPSignalNotification msg(m_sampleRate, m_centerFrequency);
         sink->handleMessage(msg);
+        updateSubbandSinks(); // in case the sink requested a sub-band before being added
         // start the sink:
         if(m_state == StRunning) {
             sink->start();
@@ -597,6 +652,11 @@ void DSPDeviceSourceEngine::handleSynchronousMessages()
 		}
 
 		m_basebandSampleSinks.remove(sink);
+		m_subbandRequests.erase(sink);
+
+		if (m_subbandSinks.erase(sink) != 0) {
+			updateActiveSubbands();
+		}
 	}
 
 	m_syncMessenger.done(m_state);
@@ -630,14 +690,34 @@ void DSPDeviceSourceEngine::handleInputMessages()
 				m_imbalance = 65536;
 			}
 
-			m_avgAmp.reset();
-			m_avgII.reset();
-			m_avgII2.reset();
-			m_avgIQ.reset();
-			m_avgPhi.reset();
-			m_avgQQ2.reset();
-			m_iBeta.reset();
-			m_qBeta.reset();
+			m_iqCorrector.reset();
+
+			delete message;
+		}
+		else if (DSPConfigureSharedChannelizer::match(*message))
+		{
+			DSPConfigureSharedChannelizer* conf = (DSPConfigureSharedChannelizer*) message;
+			resetSubbandSinks(true);
+			m_sharedChannelizerEnabled = conf->getEnable();
+			m_sharedChannelizerLog2Subbands = conf->getLog2NbSubbands();
+
+			if (m_sharedChannelizerEnabled && (m_sampleRate != 0)) {
+				m_sharedChannelizer.configure(m_sharedChannelizerLog2Subbands, m_sampleRate);
+			}
+
+			updateSubbandSinks();
+
+			delete message;
+		}
+		else if (DSPConfigureSubbandRequest::match(*message))
+		{
+			DSPConfigureSubbandRequest* conf = (DSPConfigureSubbandRequest*) message;
+			// channels send their first request before they are added so it is kept until then
+			SubbandRequest& request = m_subbandRequests[conf->getSink()];
+			request.m_frequencyOffset = conf->getFrequencyOffset();
+			request.m_bandwidth = conf->getBandwidth();
+			request.m_sampleRate = conf->getSampleRate();
+			updateSubbandSinks();
 
 			delete message;
 		}
@@ -650,6 +730,13 @@ void DSPDeviceSourceEngine::handleInputMessages()
 			m_sampleRate = notif->getSampleRate();
 			m_centerFrequency = notif->getCenterFrequency();
 
+			// sinks get the full baseband notification below and are re-assigned to sub-bands after
+			resetSubbandSinks(false);
+
+			if (m_sharedChannelizerEnabled) {
+				m_sharedChannelizer.configure(m_sharedChannelizerLog2Subbands, m_sampleRate);
+			}
+
 			qDebug() << "DSPDeviceSourceEngine::handleInputMessages: DSPSignalNotification:"
 				<< " m_sampleRate: " << m_sampleRate
 				<< " m_centerFrequency: " << m_centerFrequency;
@@ -662,6 +749,8 @@ void DSPDeviceSourceEngine::handleInputMessages()
 				(*it)->handleMessage(*message);
 			}
 
+			updateSubbandSinks();
+
 			// forward changes to source GUI input queue
 
 			MessageQueue *guiMessageQueue = m_deviceSampleSource->getMessageQueueToGUI();
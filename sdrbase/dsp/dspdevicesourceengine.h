@@ -23,15 +23,20 @@
 #include <QTimer>
 #include <QMutex>
 #include <QWaitCondition>
+
+#include <map>
+
 #include "dsp/dsptypes.h"
 #include "dsp/fftwindow.h"
+#include "dsp/iqcorrector.h"
+#include "dsp/polyphasechannelizer.h"
 #include "util/messagequeue.h"
 #include "util/syncmessenger.h"
 #include "export.h"
-#include "util/movingaverage.h"
 
 class DeviceSampleSource;
 class BasebandSampleSink;
+class SampleBlockPool;
 
 class SDRBASE_API DSPDeviceSourceEngine : public QThread {
 	Q_OBJECT
@@ -67,6 +72,8 @@ public:
 	void removeSink(BasebandSampleSink* sink); //!< Remove a sample sink
 
 	void configureCorrections(bool dcOffsetCorrection, bool iqImbalanceCorrection); //!< Configure DSP corrections
+	void configureSharedChannelizer(bool enable, unsigned int log2NbSubbands); //!< Configure filterbank shared by channels
+	void configureSubbandRequest(BasebandSampleSink* sink, qint64 frequencyOffset, int bandwidth, int sampleRate); //!< Sink asks to be fed by the shared channelizer
 
 	State state() const { return m_state; } //!< Return DSP engine current state
 
@@ -93,31 +100,27 @@ private:
 	uint m_sampleRate;
 	quint64 m_centerFrequency;
 
+	struct SubbandRequest
+	{
+		qint64 m_frequencyOffset;
+		int m_bandwidth;
+		int m_sampleRate;
+	};
+
+	bool m_sharedChannelizerEnabled;
+	unsigned int m_sharedChannelizerLog2Subbands;
+	PolyphaseChannelizer m_sharedChannelizer;
+	typedef std::map<BasebandSampleSink*, SubbandRequest> SubbandRequests;
+	SubbandRequests m_subbandRequests; //!< sinks that can be fed by the shared channelizer
+	typedef std::map<BasebandSampleSink*, int> SubbandSinks;
+	SubbandSinks m_subbandSinks; //!< sinks fed by the shared channelizer with their sub-band index
+	SampleBlockPool *m_sampleBlockPool; //!< blocks shared by the sinks accepting them
+
 	bool m_dcOffsetCorrection;
 	bool m_iqImbalanceCorrection;
 	double m_iOffset, m_qOffset;
 
-	MovingAverageUtil<int32_t, int64_t, 1024> m_iBeta;
-    MovingAverageUtil<int32_t, int64_t, 1024> m_qBeta;
-
-#if IMBALANCE_INT
-    // Fixed point DC + IQ corrections
-    MovingAverageUtil<int64_t, int64_t, 128> m_avgII;
-    MovingAverageUtil<int64_t, int64_t, 128> m_avgIQ;
-    MovingAverageUtil<int64_t, int64_t, 128> m_avgPhi;
-    MovingAverageUtil<int64_t, int64_t, 128> m_avgII2;
-    MovingAverageUtil<int64_t, int64_t, 128> m_avgQQ2;
-    MovingAverageUtil<int64_t, int64_t, 128> m_avgAmp;
-
-#else
-    // Floating point DC + IQ corrections
-    MovingAverageUtil<float, double, 128> m_avgII;
-    MovingAverageUtil<float, double, 128> m_avgIQ;
-    MovingAverageUtil<float, double, 128> m_avgII2;
-    MovingAverageUtil<float, double, 128> m_avgQQ2;
-    MovingAverageUtil<double, double, 128> m_avgPhi;
-    MovingAverageUtil<double, double, 128> m_avgAmp;
-#endif
+	IQCorrector m_iqCorrector;
 
     qint32 m_iRange;
 	qint32 m_qRange;
@@ -129,6 +132,10 @@ private:
 	void dcOffset(SampleVector::iterator begin, SampleVector::iterator end);
 	void imbalance(SampleVector::iterator begin, SampleVector::iterator end);
 	void work(); //!< transfer samples from source to sinks if in running state
+	void feedSinks(SampleVector::iterator begin, SampleVector::iterator end, bool positiveOnly);
+	void updateSubbandSinks(); //!< assign requesting sinks to shared channelizer sub-bands
+	void resetSubbandSinks(bool notify); //!< feed all sinks with full baseband
+	void updateActiveSubbands(); //!< compute only the sub-bands that are fed to a sink
 
 	State gotoIdle();     //!< Go to the idle state
 	State gotoInit();     //!< Go to the acquisition init state from idle
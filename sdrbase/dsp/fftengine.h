@@ -8,17 +8,33 @@
 
 class SDRBASE_API FFTEngine {
 public:
+	enum Type {
+		TypeComplex, //!< complex to complex
+		TypeReal,    //!< real to complex (forward) or complex to real (inverse)
+		TypeMany     //!< batch of complex to complex
+	};
+
 	virtual ~FFTEngine();
 
 	virtual void configure(int n, bool inverse) = 0;
+	//! Forward takes n reals from inReal() to n/2+1 bins in out(). Inverse takes n/2+1 bins from in() to n reals in outReal().
+	//! The inverse transform may overwrite its input.
+	virtual void configureReal(int n, bool inverse) = 0;
+	//! howMany transforms of size n. Sample k of transform m is at index m*distance + k*stride of in() and out().
+	virtual void configureMany(int n, bool inverse, int howMany, int stride, int distance) = 0;
 	virtual void transform() = 0;
 
 	virtual Complex* in() = 0;
 	virtual Complex* out() = 0;
+	virtual Real* inReal() = 0;
+	virtual Real* outReal() = 0;
 
     virtual void setReuse(bool reuse) = 0;
 
 	static FFTEngine* create(const QString& fftWisdomFileName);
+	static int manySize(int n, int howMany, int stride, int distance) { //!< buffer size in samples of a batch
+		return (howMany - 1) * distance + (n - 1) * stride + 1;
+	}
 };
 
 #endif // INCLUDE_FFTENGINE_H
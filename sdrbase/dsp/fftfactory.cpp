@@ -27,7 +27,7 @@ FFTFactory::~FFTFactory()
 {
     qDebug("FFTFactory::~FFTFactory: deleting FFTs");
 
-    for (auto mIt = m_fftEngineBySize.begin(); mIt != m_fftEngineBySize.end(); ++mIt)
+    for (auto mIt = m_engines.begin(); mIt != m_engines.end(); ++mIt)
     {
         for (auto eIt = mIt->second.begin(); eIt != mIt->second.end(); ++eIt) {
             delete eIt->m_engine;
@@ -41,102 +41,154 @@ void FFTFactory::preallocate(
     unsigned int numberFFT,
     unsigned int numberInvFFT)
 {
-    if (minLog2Size <= maxLog2Size)
+    for (unsigned int log2Size = minLog2Size; log2Size <= maxLog2Size; log2Size++)
     {
-        for (unsigned int log2Size = minLog2Size; log2Size <= maxLog2Size; log2Size++)
-        {
-            unsigned int fftSize = 1<<log2Size;
-            m_fftEngineBySize.insert(std::pair<unsigned int, std::vector<AllocatedEngine>>(fftSize, std::vector<AllocatedEngine>()));
-            m_invFFTEngineBySize.insert(std::pair<unsigned int, std::vector<AllocatedEngine>>(fftSize, std::vector<AllocatedEngine>()));
-            std::vector<AllocatedEngine>& fftEngines = m_fftEngineBySize[fftSize];
-            std::vector<AllocatedEngine>& invFFTEngines = m_invFFTEngineBySize[fftSize];
-
-            for (unsigned int i = 0; i < numberFFT; i++)
-            {
-                fftEngines.push_back(AllocatedEngine());
-                fftEngines.back().m_engine = FFTEngine::create(m_fftwWisdomFileName);
-                fftEngines.back().m_engine->setReuse(false);
-                fftEngines.back().m_engine->configure(fftSize, false);
-            }
-
-            for (unsigned int i = 0; i < numberInvFFT; i++)
-            {
-                invFFTEngines.push_back(AllocatedEngine());
-                invFFTEngines.back().m_engine = FFTEngine::create(m_fftwWisdomFileName);
-                fftEngines.back().m_engine->setReuse(false);
-                invFFTEngines.back().m_engine->configure(fftSize, true);
-            }
-        }
+        preallocate(EngineKey(FFTEngine::TypeComplex, 1<<log2Size, false), numberFFT);
+        preallocate(EngineKey(FFTEngine::TypeComplex, 1<<log2Size, true), numberInvFFT);
+    }
+}
+
+void FFTFactory::preallocateReal(
+    unsigned int minLog2Size,
+    unsigned int maxLog2Size,
+    unsigned int numberFFT,
+    unsigned int numberInvFFT)
+{
+    for (unsigned int log2Size = minLog2Size; log2Size <= maxLog2Size; log2Size++)
+    {
+        preallocate(EngineKey(FFTEngine::TypeReal, 1<<log2Size, false), numberFFT);
+        preallocate(EngineKey(FFTEngine::TypeReal, 1<<log2Size, true), numberInvFFT);
     }
 }
 
+void FFTFactory::preallocateMany(
+    unsigned int log2Size,
+    unsigned int howMany,
+    unsigned int stride,
+    unsigned int distance,
+    unsigned int numberFFT,
+    unsigned int numberInvFFT)
+{
+    preallocate(EngineKey(FFTEngine::TypeMany, 1<<log2Size, false, howMany, stride, distance), numberFFT);
+    preallocate(EngineKey(FFTEngine::TypeMany, 1<<log2Size, true, howMany, stride, distance), numberInvFFT);
+}
+
 unsigned int FFTFactory::getEngine(unsigned int fftSize, bool inverse, FFTEngine **engine)
+{
+    return getEngine(EngineKey(FFTEngine::TypeComplex, fftSize, inverse), engine);
+}
+
+void FFTFactory::releaseEngine(unsigned int fftSize, bool inverse, unsigned int engineSequence)
+{
+    releaseEngine(EngineKey(FFTEngine::TypeComplex, fftSize, inverse), engineSequence);
+}
+
+unsigned int FFTFactory::getRealEngine(unsigned int fftSize, bool inverse, FFTEngine **engine)
+{
+    return getEngine(EngineKey(FFTEngine::TypeReal, fftSize, inverse), engine);
+}
+
+void FFTFactory::releaseRealEngine(unsigned int fftSize, bool inverse, unsigned int engineSequence)
+{
+    releaseEngine(EngineKey(FFTEngine::TypeReal, fftSize, inverse), engineSequence);
+}
+
+unsigned int FFTFactory::getManyEngine(
+    unsigned int fftSize,
+    bool inverse,
+    unsigned int howMany,
+    unsigned int stride,
+    unsigned int distance,
+    FFTEngine **engine)
+{
+    return getEngine(EngineKey(FFTEngine::TypeMany, fftSize, inverse, howMany, stride, distance), engine);
+}
+
+void FFTFactory::releaseManyEngine(
+    unsigned int fftSize,
+    bool inverse,
+    unsigned int howMany,
+    unsigned int stride,
+    unsigned int distance,
+    unsigned int engineSequence)
+{
+    releaseEngine(EngineKey(FFTEngine::TypeMany, fftSize, inverse, howMany, stride, distance), engineSequence);
+}
+
+FFTEngine *FFTFactory::createEngine(const EngineKey& key)
+{
+    FFTEngine *engine = FFTEngine::create(m_fftwWisdomFileName);
+    engine->setReuse(false);
+
+    if (key.m_type == FFTEngine::TypeReal) {
+        engine->configureReal(key.m_fftSize, key.m_inverse);
+    } else if (key.m_type == FFTEngine::TypeMany) {
+        engine->configureMany(key.m_fftSize, key.m_inverse, key.m_howMany, key.m_stride, key.m_distance);
+    } else {
+        engine->configure(key.m_fftSize, key.m_inverse);
+    }
+
+    return engine;
+}
+
+// Planning at startup picks the plans from the wisdom file so that getting an engine later does not stall a DSP thread
+void FFTFactory::preallocate(const EngineKey& key, unsigned int number)
 {
     QMutexLocker mutexLocker(&m_mutex);
-    std::map<unsigned int, std::vector<AllocatedEngine>>& enginesBySize = inverse ?
-        m_invFFTEngineBySize : m_fftEngineBySize;
+    std::vector<AllocatedEngine>& engines = m_engines[key];
 
-    if (enginesBySize.find(fftSize) == enginesBySize.end())
+    for (unsigned int i = 0; i < number; i++)
     {
-        qDebug("FFTFactory::getEngine: new FFT %s size: %u", (inverse ? "inv" : "fwd"), fftSize);
-        enginesBySize.insert(std::pair<unsigned int, std::vector<AllocatedEngine>>(fftSize, std::vector<AllocatedEngine>()));
-        std::vector<AllocatedEngine>& engines = enginesBySize[fftSize];
         engines.push_back(AllocatedEngine());
-        engines.back().m_inUse = true;
-        engines.back().m_engine = FFTEngine::create(m_fftwWisdomFileName);
-        engines.back().m_engine->setReuse(false);
-        engines.back().m_engine->configure(fftSize, inverse);
-        *engine = engines.back().m_engine;
-        return 0;
+        engines.back().m_engine = createEngine(key);
     }
-    else
-    {
-        unsigned int i = 0;
+}
 
-        for (; i < enginesBySize[fftSize].size(); i++)
-        {
-            if (!enginesBySize[fftSize][i].m_inUse) {
-                break;
-            }
-        }
+unsigned int FFTFactory::getEngine(const EngineKey& key, FFTEngine **engine)
+{
+    QMutexLocker mutexLocker(&m_mutex);
+    std::vector<AllocatedEngine>& engines = m_engines[key];
+    unsigned int i = 0;
 
-        if (i < enginesBySize[fftSize].size())
-        {
-            qDebug("FFTFactory::getEngine: reuse engine: %u FFT %s size: %u", i, (inverse ? "inv" : "fwd"), fftSize);
-            enginesBySize[fftSize][i].m_inUse = true;
-            *engine = enginesBySize[fftSize][i].m_engine;
-            return i;
-        }
-        else
-        {
-            std::vector<AllocatedEngine>& engines = enginesBySize[fftSize];
-            qDebug("FFTFactory::getEngine: create engine: %lu FFT %s size: %u", engines.size(), (inverse ? "inv" : "fwd"), fftSize);
-            engines.push_back(AllocatedEngine());
-            engines.back().m_inUse = true;
-            engines.back().m_engine = FFTEngine::create(m_fftwWisdomFileName);
-            engines.back().m_engine->setReuse(false);
-            engines.back().m_engine->configure(fftSize, inverse);
-            *engine = engines.back().m_engine;
-            return engines.size() - 1;
+    for (; i < engines.size(); i++)
+    {
+        if (!engines[i].m_inUse) {
+            break;
         }
     }
+
+    if (i < engines.size())
+    {
+        qDebug("FFTFactory::getEngine: reuse engine: %u FFT %s type: %d size: %u",
+            i, (key.m_inverse ? "inv" : "fwd"), (int) key.m_type, key.m_fftSize);
+    }
+    else
+    {
+        qDebug("FFTFactory::getEngine: create engine: %u FFT %s type: %d size: %u",
+            i, (key.m_inverse ? "inv" : "fwd"), (int) key.m_type, key.m_fftSize);
+        engines.push_back(AllocatedEngine());
+        engines.back().m_engine = createEngine(key);
+    }
+
+    engines[i].m_inUse = true;
+    *engine = engines[i].m_engine;
+    return i;
 }
 
-void FFTFactory::releaseEngine(unsigned int fftSize, bool inverse, unsigned int engineSequence)
+void FFTFactory::releaseEngine(const EngineKey& key, unsigned int engineSequence)
 {
     QMutexLocker mutexLocker(&m_mutex);
-    std::map<unsigned int, std::vector<AllocatedEngine>>& enginesBySize = inverse ?
-        m_invFFTEngineBySize : m_fftEngineBySize;
+    auto it = m_engines.find(key);
 
-    if (enginesBySize.find(fftSize) != enginesBySize.end())
+    if (it != m_engines.end())
     {
-        std::vector<AllocatedEngine>& engines = enginesBySize[fftSize];
+        std::vector<AllocatedEngine>& engines = it->second;
 
         if (engineSequence < engines.size())
         {
-            qDebug("FFTFactory::releaseEngine: engineSequence: %u FFT %s size: %u",
-                engineSequence, (inverse ? "inv" : "fwd"), fftSize);
+            qDebug("FFTFactory::releaseEngine: engineSequence: %u FFT %s type: %d size: %u",
+                engineSequence, (key.m_inverse ? "inv" : "fwd"), (int) key.m_type, key.m_fftSize);
             engines[engineSequence].m_inUse = false;
         }
     }
-}
\ No newline at end of file
+}
@@ -19,6 +19,7 @@
 #define _SDRBASE_FFTWFACTORY_H
 
 #include <map>
+#include <tuple>
 #include <vector>
 
 #include <QMutex>
@@ -34,8 +35,14 @@ public:
 	~FFTFactory();
 
     void preallocate(unsigned int minLog2Size, unsigned int maxLog2Size, unsigned int numberFFT, unsigned int numberInvFFT);
+    void preallocateReal(unsigned int minLog2Size, unsigned int maxLog2Size, unsigned int numberFFT, unsigned int numberInvFFT);
+    void preallocateMany(unsigned int log2Size, unsigned int howMany, unsigned int stride, unsigned int distance, unsigned int numberFFT, unsigned int numberInvFFT);
     unsigned int getEngine(unsigned int fftSize, bool inverse, FFTEngine **engine); //!< returns an engine sequence
     void releaseEngine(unsigned int fftSize, bool inverse, unsigned int engineSequence);
+    unsigned int getRealEngine(unsigned int fftSize, bool inverse, FFTEngine **engine); //!< returns an engine sequence
+    void releaseRealEngine(unsigned int fftSize, bool inverse, unsigned int engineSequence);
+    unsigned int getManyEngine(unsigned int fftSize, bool inverse, unsigned int howMany, unsigned int stride, unsigned int distance, FFTEngine **engine); //!< returns an engine sequence
+    void releaseManyEngine(unsigned int fftSize, bool inverse, unsigned int howMany, unsigned int stride, unsigned int distance, unsigned int engineSequence);
 
 private:
     struct AllocatedEngine
@@ -49,10 +56,39 @@ private:
         {}
     };
 
+    struct EngineKey
+    {
+        FFTEngine::Type m_type;
+        unsigned int m_fftSize;
+        bool m_inverse;
+        unsigned int m_howMany;
+        unsigned int m_stride;
+        unsigned int m_distance;
+
+        EngineKey(FFTEngine::Type type, unsigned int fftSize, bool inverse, unsigned int howMany = 1, unsigned int stride = 1, unsigned int distance = 0) :
+            m_type(type),
+            m_fftSize(fftSize),
+            m_inverse(inverse),
+            m_howMany(howMany),
+            m_stride(stride),
+            m_distance(distance)
+        {}
+
+        bool operator<(const EngineKey& other) const
+        {
+            return std::tie(m_type, m_fftSize, m_inverse, m_howMany, m_stride, m_distance)
+                < std::tie(other.m_type, other.m_fftSize, other.m_inverse, other.m_howMany, other.m_stride, other.m_distance);
+        }
+    };
+
     QString m_fftwWisdomFileName;
-    std::map<unsigned int, std::vector<AllocatedEngine>> m_fftEngineBySize;
-    std::map<unsigned int, std::vector<AllocatedEngine>> m_invFFTEngineBySize;
+    std::map<EngineKey, std::vector<AllocatedEngine>> m_engines;
     QMutex m_mutex;
+
+    FFTEngine *createEngine(const EngineKey& key);
+    void preallocate(const EngineKey& key, unsigned int number);
+    unsigned int getEngine(const EngineKey& key, FFTEngine **engine);
+    void releaseEngine(const EngineKey& key, unsigned int engineSequence);
 };
 
 #endif // _SDRBASE_FFTWFACTORY_H
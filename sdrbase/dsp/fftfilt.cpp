@@ -39,19 +39,41 @@
 #include <sys/types.h>
 #include <memory.h>
 
+#include <algorithm>
+#include <map>
+#include <mutex>
+
 #include <dsp/misc.h>
 #include <dsp/fftfilt.h>
 
+namespace {
+
+// FFT tables by length. Transforms only read them so filters in different threads can share them.
+struct FFTPlanCache
+{
+    std::mutex m_mutex;
+    std::map<int, std::pair<g_fft<float>*, int>> m_plans; //!< plan and number of filters using it
+};
+
+FFTPlanCache& planCache()
+{
+    static FFTPlanCache *cache = new FFTPlanCache(); // never destroyed so that filters can be deleted at exit
+    return *cache;
+}
+
+}
+
 //------------------------------------------------------------------------------
 // initialize the filter
 // create forward and reverse FFTs
 //------------------------------------------------------------------------------
 
 // Only need a single instance of g_fft, used for both forward and reverse
+// and shared by the filters of the same length
 void fftfilt::init_filter()
 {
 	flen2	= flen >> 1;
-	fft	= new g_fft<float>(flen);
+	fft	= acquirePlan(flen);
 
 	filter		= new cmplx[flen];
     filterOpp   = new cmplx[flen];
@@ -95,7 +117,7 @@ fftfilt::fftfilt(float f2, int len)
 
 fftfilt::~fftfilt()
 {
-	if (fft) delete fft;
+	if (fft) releasePlan(fft);
 
 	if (filter) delete [] filter;
     if (filterOpp) delete [] filterOpp;
@@ -265,16 +287,8 @@ int fftfilt::runFilt(const cmplx & in, cmplx **out)
 	inptr = 0;
 
 	fft->ComplexFFT(data);
-	for (int i = 0; i < flen; i++)
-		data[i] *= filter[i];
-
-	fft->InverseComplexFFT(data);
-
-	for (int i = 0; i < flen2; i++) {
-		output[i] = ovlbuf[i] + data[i];
-		ovlbuf[i] = data[flen2 + i];
-	}
-	memset (data, 0, flen * sizeof(cmplx));
+	apply(ModeFilt, false, true);
+	inverseOverlapAdd(output);
 
 	*out = output;
 	return flen2;
@@ -289,35 +303,8 @@ int fftfilt::runSSB(const cmplx & in, cmplx **out, bool usb, bool getDC)
 	inptr = 0;
 
 	fft->ComplexFFT(data);
-
-	// get or reject DC component
-	data[0] = getDC ? data[0]*filter[0] : 0;
-
-	// Discard frequencies for ssb
-	if (usb)
-	{
-		for (int i = 1; i < flen2; i++) {
-			data[i] *= filter[i];
-			data[flen2 + i] = 0;
-		}
-	}
-	else
-	{
-		for (int i = 1; i < flen2; i++) {
-			data[i] = 0;
-			data[flen2 + i] *= filter[flen2 + i];
-		}
-	}
-
-	// in-place FFT: freqdata overwritten with filtered timedata
-	fft->InverseComplexFFT(data);
-
-	// overlap and add
-	for (int i = 0; i < flen2; i++) {
-		output[i] = ovlbuf[i] + data[i];
-		ovlbuf[i] = data[i+flen2];
-	}
-	memset (data, 0, flen * sizeof(cmplx));
+	apply(ModeSSB, usb, getDC);
+	inverseOverlapAdd(output);
 
 	*out = output;
 	return flen2;
@@ -332,72 +319,292 @@ int fftfilt::runDSB(const cmplx & in, cmplx **out, bool getDC)
 	inptr = 0;
 
 	fft->ComplexFFT(data);
+	apply(ModeDSB, false, getDC);
+	inverseOverlapAdd(output);
 
-	for (int i = 0; i < flen2; i++) {
-		data[i] *= filter[i];
-		data[flen2 + i] *= filter[flen2 + i];
-	}
+	*out = output;
+	return flen2;
+}
+
+// Version for asymmetrical sidebands. You have to double the FFT size used for SSB.
+int fftfilt::runAsym(const cmplx & in, cmplx **out, bool usb)
+{
+    data[inptr++] = in;
+    if (inptr < flen2)
+        return 0;
+    inptr = 0;
+
+    fft->ComplexFFT(data);
+    apply(ModeAsym, usb, true);
+    inverseOverlapAdd(output);
+
+    *out = output;
+    return flen2;
+}
+
+int fftfilt::runFilt(const cmplx *in, int nbIn, cmplx *out)
+{
+    return runBlocks(in, nbIn, out, ModeFilt, false, true);
+}
 
-    // get or reject DC component
-    data[0] = getDC ? data[0] : 0;
+int fftfilt::runSSB(const cmplx *in, int nbIn, cmplx *out, bool usb, bool getDC)
+{
+    return runBlocks(in, nbIn, out, ModeSSB, usb, getDC);
+}
+
+int fftfilt::runDSB(const cmplx *in, int nbIn, cmplx *out, bool getDC)
+{
+    return runBlocks(in, nbIn, out, ModeDSB, false, getDC);
+}
 
+int fftfilt::runAsym(const cmplx *in, int nbIn, cmplx *out, bool usb)
+{
+    return runBlocks(in, nbIn, out, ModeAsym, usb, true);
+}
+
+int fftfilt::runFilt(const float *in, int nbIn, cmplx *out)
+{
+    return runBlocks(in, nbIn, out, ModeFilt, false, true);
+}
+
+int fftfilt::runSSB(const float *in, int nbIn, cmplx *out, bool usb, bool getDC)
+{
+    return runBlocks(in, nbIn, out, ModeSSB, usb, getDC);
+}
+
+int fftfilt::runDSB(const float *in, int nbIn, cmplx *out, bool getDC)
+{
+    return runBlocks(in, nbIn, out, ModeDSB, false, getDC);
+}
+
+int fftfilt::runAsym(const float *in, int nbIn, cmplx *out, bool usb)
+{
+    return runBlocks(in, nbIn, out, ModeAsym, usb, true);
+}
+
+int fftfilt::runFiltBatch(fftfilt **filters, int nbFilters, const cmplx *in, int nbIn, cmplx **out)
+{
+    if (nbFilters < 1) {
+        return -1;
+    }
+
+    // input is collected in the first filter
+    fftfilt *lead = filters[0];
+    int nbOut = 0;
+
+    for (int k = 1; k < nbFilters; k++)
+    {
+        if (filters[k]->flen != lead->flen) {
+            return -1; // the spectrum of the lead filter would not fit
+        }
+    }
+
+    while (nbIn > 0)
+    {
+        int n = std::min(nbIn, lead->flen2 - lead->inptr);
+        std::copy(in, in + n, lead->data + lead->inptr);
+        in += n;
+        nbIn -= n;
+        lead->inptr += n;
+
+        if (lead->inptr < lead->flen2) {
+            break;
+        }
+
+        lead->inptr = 0;
+        lead->fft->ComplexFFT(lead->data);
+
+        for (int k = 1; k < nbFilters; k++)
+        {
+            std::copy(lead->data, lead->data + lead->flen, filters[k]->data);
+            filters[k]->apply(ModeFilt, false, true);
+            filters[k]->inverseOverlapAdd(out[k] + nbOut);
+        }
+
+        lead->apply(ModeFilt, false, true);
+        lead->inverseOverlapAdd(out[0] + nbOut);
+        nbOut += lead->flen2;
+    }
+
+    return nbOut;
+}
+
+void fftfilt::apply(Mode mode, bool usb, bool getDC)
+{
+	switch (mode)
+	{
+	case ModeFilt:
+		for (int i = 0; i < flen; i++)
+			data[i] *= filter[i];
+		break;
+
+	case ModeSSB:
+		// get or reject DC component
+		data[0] = getDC ? data[0]*filter[0] : 0;
+
+		// Discard frequencies for ssb
+		if (usb)
+		{
+			for (int i = 1; i < flen2; i++) {
+				data[i] *= filter[i];
+				data[flen2 + i] = 0;
+			}
+		}
+		else
+		{
+			for (int i = 1; i < flen2; i++) {
+				data[i] = 0;
+				data[flen2 + i] *= filter[flen2 + i];
+			}
+		}
+		break;
+
+	case ModeDSB:
+		for (int i = 0; i < flen2; i++) {
+			data[i] *= filter[i];
+			data[flen2 + i] *= filter[flen2 + i];
+		}
+
+		// get or reject DC component
+		data[0] = getDC ? data[0] : 0;
+		break;
+
+	case ModeAsym:
+		data[0] *= filter[0]; // always keep DC
+
+		if (usb)
+		{
+			for (int i = 1; i < flen2; i++)
+			{
+				data[i] *= filter[i]; // usb
+				data[flen2 + i] *= filterOpp[flen2 + i]; // lsb is the opposite
+			}
+		}
+		else
+		{
+			for (int i = 1; i < flen2; i++)
+			{
+				data[i] *= filterOpp[i]; // usb is the opposite
+				data[flen2 + i] *= filter[flen2 + i]; // lsb
+			}
+		}
+		break;
+	}
+}
+
+void fftfilt::inverseOverlapAdd(cmplx *out)
+{
 	// in-place FFT: freqdata overwritten with filtered timedata
 	fft->InverseComplexFFT(data);
 
 	// overlap and add
 	for (int i = 0; i < flen2; i++) {
-		output[i] = ovlbuf[i] + data[i];
+		out[i] = ovlbuf[i] + data[i];
 		ovlbuf[i] = data[i+flen2];
 	}
 
 	memset (data, 0, flen * sizeof(cmplx));
-
-	*out = output;
-	return flen2;
 }
 
-// Version for asymmetrical sidebands. You have to double the FFT size used for SSB.
-int fftfilt::runAsym(const cmplx & in, cmplx **out, bool usb)
+void fftfilt::realSpectrum()
 {
-    data[inptr++] = in;
-    if (inptr < flen2)
-        return 0;
-    inptr = 0;
+	// The real FFT leaves the bins 1 to flen2-1 in place and the real parts of DC and
+	// Nyquist in the first bin. The negative frequencies are the conjugates.
+	data[flen2] = data[0].imag();
+	data[0] = data[0].real();
 
-    fft->ComplexFFT(data);
+	for (int i = 1; i < flen2; i++) {
+		data[flen - i] = std::conj(data[i]);
+	}
+}
 
-    data[0] *= filter[0]; // always keep DC
+int fftfilt::runBlocks(const cmplx *in, int nbIn, cmplx *out, Mode mode, bool usb, bool getDC)
+{
+    int nbOut = 0;
 
-    if (usb)
+    while (nbIn > 0)
     {
-        for (int i = 1; i < flen2; i++)
-        {
-            data[i] *= filter[i]; // usb
-            data[flen2 + i] *= filterOpp[flen2 + i]; // lsb is the opposite
+        int n = std::min(nbIn, flen2 - inptr);
+        std::copy(in, in + n, data + inptr);
+        in += n;
+        nbIn -= n;
+        inptr += n;
+
+        if (inptr < flen2) {
+            break;
         }
+
+        inptr = 0;
+        fft->ComplexFFT(data);
+        apply(mode, usb, getDC);
+        inverseOverlapAdd(out + nbOut);
+        nbOut += flen2;
     }
-    else
+
+    return nbOut;
+}
+
+int fftfilt::runBlocks(const float *in, int nbIn, cmplx *out, Mode mode, bool usb, bool getDC)
+{
+    // flen real samples of which the last half is zero padding fit in the first half of data
+    float *rdata = reinterpret_cast<float*>(data);
+    int nbOut = 0;
+
+    while (nbIn > 0)
     {
-        for (int i = 1; i < flen2; i++)
-        {
-            data[i] *= filterOpp[i]; // usb is the opposite
-            data[flen2 + i] *= filter[flen2 + i]; // lsb
+        int n = std::min(nbIn, flen2 - inptr);
+        std::copy(in, in + n, rdata + inptr);
+        in += n;
+        nbIn -= n;
+        inptr += n;
+
+        if (inptr < flen2) {
+            break;
         }
+
+        inptr = 0;
+        fft->RealFFT(data);
+        realSpectrum();
+        apply(mode, usb, getDC);
+        inverseOverlapAdd(out + nbOut);
+        nbOut += flen2;
     }
 
-    // in-place FFT: freqdata overwritten with filtered timedata
-    fft->InverseComplexFFT(data);
+    return nbOut;
+}
 
-    // overlap and add
-    for (int i = 0; i < flen2; i++) {
-        output[i] = ovlbuf[i] + data[i];
-        ovlbuf[i] = data[i+flen2];
+g_fft<float> *fftfilt::acquirePlan(int len)
+{
+    FFTPlanCache& cache = planCache();
+    std::lock_guard<std::mutex> lock(cache.m_mutex);
+    std::pair<g_fft<float>*, int>& plan = cache.m_plans[len];
+
+    if (!plan.first) {
+        plan.first = new g_fft<float>(len);
     }
 
-    memset (data, 0, flen * sizeof(cmplx));
+    plan.second++;
+    return plan.first;
+}
+
+void fftfilt::releasePlan(g_fft<float> *plan)
+{
+    FFTPlanCache& cache = planCache();
+    std::lock_guard<std::mutex> lock(cache.m_mutex);
 
-    *out = output;
-    return flen2;
+    for (std::map<int, std::pair<g_fft<float>*, int>>::iterator it = cache.m_plans.begin(); it != cache.m_plans.end(); ++it)
+    {
+        if (it->second.first == plan)
+        {
+            if (--it->second.second == 0)
+            {
+                delete plan;
+                cache.m_plans.erase(it);
+            }
+
+            return;
+        }
+    }
 }
 
 /* Sliding FFT from Fldigi */
@@ -36,7 +36,27 @@ public:
 	int runDSB(const cmplx& in, cmplx **out, bool getDC = true);
 	int runAsym(const cmplx & in, cmplx **out, bool usb); //!< Asymmetrical fitering can be used for vestigial sideband
 
+// Block API: consumes nbIn samples and writes the output blocks completed to out that must
+// have room for nbIn + getBlockSize() samples. Returns the number of output samples, a multiple
+// of the block size. The output is the same as with the per sample API that can be mixed with it.
+	int getBlockSize() const { return flen2; }
+	int runFilt(const cmplx *in, int nbIn, cmplx *out);
+	int runSSB(const cmplx *in, int nbIn, cmplx *out, bool usb, bool getDC = true);
+	int runDSB(const cmplx *in, int nbIn, cmplx *out, bool getDC = true);
+	int runAsym(const cmplx *in, int nbIn, cmplx *out, bool usb);
+// Real input (audio) with a real FFT of half the cost. Do not mix with complex input on the same filter.
+	int runFilt(const float *in, int nbIn, cmplx *out);
+	int runSSB(const float *in, int nbIn, cmplx *out, bool usb, bool getDC = true);
+	int runDSB(const float *in, int nbIn, cmplx *out, bool getDC = true);
+	int runAsym(const float *in, int nbIn, cmplx *out, bool usb);
+// Several filters of the same length on the same input share the forward FFT. out[k] is the
+// output of filters[k] as with runFilt. The filters must only be run together in this batch.
+// Returns -1 without filtering if the filters do not all have the same length.
+	static int runFiltBatch(fftfilt **filters, int nbFilters, const cmplx *in, int nbIn, cmplx **out);
+
 protected:
+	enum Mode {ModeFilt, ModeSSB, ModeDSB, ModeAsym};
+
 	int flen;
 	int flen2;
 	g_fft<float> *fft;
@@ -88,6 +108,14 @@ protected:
 
 	void init_filter();
 	void init_dsb_filter();
+	void apply(Mode mode, bool usb, bool getDC); //!< multiply the spectrum in data by the filter
+	void inverseOverlapAdd(cmplx *out);           //!< back to time domain and out the next block
+	void realSpectrum();                           //!< full spectrum in data from the real FFT of data
+	int runBlocks(const cmplx *in, int nbIn, cmplx *out, Mode mode, bool usb, bool getDC);
+	int runBlocks(const float *in, int nbIn, cmplx *out, Mode mode, bool usb, bool getDC);
+
+	static g_fft<float> *acquirePlan(int len); //!< filters of the same length share the FFT tables
+	static void releasePlan(g_fft<float> *plan);
 };
 
 
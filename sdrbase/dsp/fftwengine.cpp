@@ -32,12 +32,28 @@ FFTWEngine::~FFTWEngine()
 }
 
 void FFTWEngine::configure(int n, bool inverse)
+{
+    createPlan(TypeComplex, n, inverse, 1, 1, n);
+}
+
+void FFTWEngine::configureReal(int n, bool inverse)
+{
+    createPlan(TypeReal, n, inverse, 1, 1, n);
+}
+
+void FFTWEngine::configureMany(int n, bool inverse, int howMany, int stride, int distance)
+{
+    createPlan(TypeMany, n, inverse, howMany, stride, distance);
+}
+
+void FFTWEngine::createPlan(Type type, int n, bool inverse, int howMany, int stride, int distance)
 {
     if (m_reuse)
     {
         for (Plans::const_iterator it = m_plans.begin(); it != m_plans.end(); ++it)
         {
-            if (((*it)->n == n) && ((*it)->inverse == inverse))
+            if (((*it)->type == type) && ((*it)->n == n) && ((*it)->inverse == inverse)
+             && ((*it)->howMany == howMany) && ((*it)->stride == stride) && ((*it)->distance == distance))
             {
                 m_currentPlan = *it;
                 return;
@@ -45,37 +61,75 @@ void FFTWEngine::configure(int n, bool inverse)
         }
     }
 
+    // real transforms use n/2+1 complex samples on the spectrum side and n reals in the same room on the other side
+    int size = type == TypeReal ? n/2 + 1 : type == TypeMany ? manySize(n, howMany, stride, distance) : n;
+
 	m_currentPlan = new Plan;
+	m_currentPlan->type = type;
 	m_currentPlan->n = n;
 	m_currentPlan->inverse = inverse;
-	m_currentPlan->in = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * n);
-	m_currentPlan->out = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * n);
+	m_currentPlan->howMany = howMany;
+	m_currentPlan->stride = stride;
+	m_currentPlan->distance = distance;
+	m_currentPlan->in = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * size);
+	m_currentPlan->out = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * size);
 	QElapsedTimer t;
 	t.start();
-    m_globalPlanMutex.lock();
+    m_globalPlanMutex.lock(); // the FFTW planner is not thread safe
+    importWisdom();
 
-    if (m_fftWisdomFileName.size() > 0)
+    if (type == TypeReal)
     {
-        int rc = fftwf_import_wisdom_from_filename(m_fftWisdomFileName.toStdString().c_str());
-
-        if (rc == 0) { // that's an error (undocumented)
-            qInfo("FFTWEngine::configure: importing from FFTW wisdom file: '%s' failed", qPrintable(m_fftWisdomFileName));
+        if (inverse) {
+            m_currentPlan->plan = fftwf_plan_dft_c2r_1d(n, m_currentPlan->in, (float*) m_currentPlan->out, FFTW_PATIENT);
         } else {
-            qDebug("FFTWEngine::configure: successfully imported from FFTW wisdom file: '%s'", qPrintable(m_fftWisdomFileName));
+            m_currentPlan->plan = fftwf_plan_dft_r2c_1d(n, (float*) m_currentPlan->in, m_currentPlan->out, FFTW_PATIENT);
         }
     }
+    else if (type == TypeMany)
+    {
+        m_currentPlan->plan = fftwf_plan_many_dft(1, &n, howMany,
+            m_currentPlan->in, nullptr, stride, distance,
+            m_currentPlan->out, nullptr, stride, distance,
+            inverse ? FFTW_BACKWARD : FFTW_FORWARD, FFTW_PATIENT);
+    }
     else
     {
-        qDebug("FFTWEngine::configure: no FFTW wisdom file");
+        m_currentPlan->plan = fftwf_plan_dft_1d(n, m_currentPlan->in, m_currentPlan->out, inverse ? FFTW_BACKWARD : FFTW_FORWARD, FFTW_PATIENT);
     }
 
-	m_currentPlan->plan = fftwf_plan_dft_1d(n, m_currentPlan->in, m_currentPlan->out, inverse ? FFTW_BACKWARD : FFTW_FORWARD, FFTW_PATIENT);
     m_globalPlanMutex.unlock();
 
-    qDebug("FFT: creating FFTW plan (n=%d,%s) took %lld ms", n, inverse ? "inverse" : "forward", t.elapsed());
+    qDebug("FFT: creating FFTW plan (n=%d,%s,%s,howMany=%d) took %lld ms",
+        n, inverse ? "inverse" : "forward", type == TypeReal ? "real" : "complex", howMany, t.elapsed());
 	m_plans.push_back(m_currentPlan);
 }
 
+void FFTWEngine::importWisdom()
+{
+    if (m_fftWisdomFileName.size() == 0)
+    {
+        qDebug("FFTWEngine::importWisdom: no FFTW wisdom file");
+        return;
+    }
+
+    if (m_fftWisdomFileName == m_importedWisdomFileName) {
+        return;
+    }
+
+    int rc = fftwf_import_wisdom_from_filename(m_fftWisdomFileName.toStdString().c_str());
+
+    if (rc == 0) // that's an error (undocumented)
+    {
+        qInfo("FFTWEngine::importWisdom: importing from FFTW wisdom file: '%s' failed", qPrintable(m_fftWisdomFileName));
+    }
+    else
+    {
+        qDebug("FFTWEngine::importWisdom: successfully imported from FFTW wisdom file: '%s'", qPrintable(m_fftWisdomFileName));
+        m_importedWisdomFileName = m_fftWisdomFileName;
+    }
+}
+
 void FFTWEngine::transform()
 {
 	if(m_currentPlan != NULL)
@@ -96,7 +150,22 @@ Complex* FFTWEngine::out()
 	else return NULL;
 }
 
+Real* FFTWEngine::inReal()
+{
+	if(m_currentPlan != NULL)
+		return reinterpret_cast<Real*>(m_currentPlan->in);
+	else return NULL;
+}
+
+Real* FFTWEngine::outReal()
+{
+	if(m_currentPlan != NULL)
+		return reinterpret_cast<Real*>(m_currentPlan->out);
+	else return NULL;
+}
+
 QMutex FFTWEngine::m_globalPlanMutex;
+QString FFTWEngine::m_importedWisdomFileName;
 
 void FFTWEngine::freeAll()
 {
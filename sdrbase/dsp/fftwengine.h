@@ -32,20 +32,29 @@ public:
 	virtual ~FFTWEngine();
 
 	virtual void configure(int n, bool inverse);
+	virtual void configureReal(int n, bool inverse);
+	virtual void configureMany(int n, bool inverse, int howMany, int stride, int distance);
 	virtual void transform();
 
 	virtual Complex* in();
 	virtual Complex* out();
+	virtual Real* inReal();
+	virtual Real* outReal();
 
     virtual void setReuse(bool reuse) { m_reuse = reuse; }
 
 protected:
 	static QMutex m_globalPlanMutex;
+	static QString m_importedWisdomFileName; //!< wisdom is imported once and stays in the FFTW planner
     QString m_fftWisdomFileName;
 
 	struct Plan {
+		Type type;
 		int n;
 		bool inverse;
+		int howMany;
+		int stride;
+		int distance;
 		fftwf_plan plan;
 		fftwf_complex* in;
 		fftwf_complex* out;
@@ -56,6 +65,8 @@ protected:
     bool m_reuse;
 
 	void freeAll();
+	void createPlan(Type type, int n, bool inverse, int howMany, int stride, int distance);
+	void importWisdom();
 };
 
 #endif // INCLUDE_FFTWENGINE_H
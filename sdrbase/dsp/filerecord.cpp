@@ -15,6 +15,9 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.          //
 ///////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <cstring>
+
 #include <boost/crc.hpp>
 #include <boost/cstdint.hpp>
 
@@ -22,11 +25,16 @@
 #include <QDateTime>
 
 #include "dsp/dspcommands.h"
+#include "dsp/iqcodec.h"
 #include "util/simpleserializer.h"
 #include "util/message.h"
 
 #include "filerecord.h"
 
+const quint32 FileRecord::m_chunkedFormatTag;
+const quint32 FileRecord::m_chunkMagic;
+const quint32 FileRecord::m_indexMagic;
+
 FileRecord::FileRecord() :
 	FileRecordInterface(),
     m_fileBase("test"),
@@ -35,7 +43,14 @@ FileRecord::FileRecord() :
 	m_recordOn(false),
     m_recordStart(false),
     m_byteCount(0),
-    m_msShift(0)
+    m_msShift(0),
+    m_directIO(false),
+    m_chunked(false),
+    m_recordChunked(false),
+    m_chunkFill(0),
+    m_fileOffset(0),
+    m_recordSamples(0),
+    m_startTimeMs(0)
 {
 	setObjectName("FileRecord");
 }
@@ -47,7 +62,15 @@ FileRecord::FileRecord(const QString& fileBase) :
     m_centerFrequency(0),
     m_recordOn(false),
     m_recordStart(false),
-    m_byteCount(0)
+    m_byteCount(0),
+    m_msShift(0),
+    m_directIO(false),
+    m_chunked(false),
+    m_recordChunked(false),
+    m_chunkFill(0),
+    m_fileOffset(0),
+    m_recordSamples(0),
+    m_startTimeMs(0)
 {
     setObjectName("FileRecord");
 }
@@ -89,7 +112,27 @@ void FileRecord::feed(const SampleVector::const_iterator& begin, const SampleVec
             m_recordStart = false;
         }
 
-        m_sampleFile.write(reinterpret_cast<const char*>(&*(begin)), (end - begin)*sizeof(Sample));
+        if (m_recordChunked)
+        {
+            SampleVector::const_iterator it = begin;
+
+            while (it < end)
+            {
+                unsigned int len = std::min((unsigned int) (end - it), (unsigned int) m_chunkSamples.size() - m_chunkFill);
+                std::copy(it, it + len, m_chunkSamples.begin() + m_chunkFill);
+                m_chunkFill += len;
+                it += len;
+
+                if (m_chunkFill == m_chunkSamples.size()) {
+                    writeChunk();
+                }
+            }
+        }
+        else
+        {
+            m_sampleFile.write(reinterpret_cast<const char*>(&*(begin)), (end - begin)*sizeof(Sample));
+        }
+
         m_byteCount += end - begin;
     }
 }
@@ -109,22 +152,37 @@ void FileRecord::startRecording()
         stopRecording();
     }
 
-    if (!m_sampleFile.is_open())
+    if (!m_sampleFile.isOpen())
     {
     	qDebug() << "FileRecord::startRecording";
         m_curentFileName = QString("%1.%2.sdriq").arg(m_fileBase).arg(QDateTime::currentDateTimeUtc().toString("yyyy-MM-ddTHH_mm_ss_zzz"));
-        m_sampleFile.open(m_curentFileName.toStdString().c_str(), std::ios::binary);
+
+        if (!m_sampleFile.open(m_curentFileName, m_directIO)) {
+            return;
+        }
+
         m_recordOn = true;
         m_recordStart = true;
+        m_recordChunked = m_chunked;
         m_byteCount = 0;
     }
 }
 
 void FileRecord::stopRecording()
 {
-    if (m_sampleFile.is_open())
+    if (m_sampleFile.isOpen())
     {
     	qDebug() << "FileRecord::stopRecording";
+
+        if (m_recordChunked && !m_recordStart) // header is written
+        {
+            if (m_chunkFill > 0) {
+                writeChunk();
+            }
+
+            writeChunkIndex();
+        }
+
         m_sampleFile.close();
         m_recordOn = false;
         m_recordStart = false;
@@ -161,9 +219,73 @@ void FileRecord::writeHeader()
     std::time_t ts = time(0);
     header.startTimeStamp = ts + (m_msShift / 1000);
     header.sampleSize = SDR_RX_SAMP_SZ;
-    header.filler = 0;
+    header.filler = m_recordChunked ? m_chunkedFormatTag : 0;
+    setHeaderCRC(header);
+
+    m_sampleFile.writeNoDrop((const char *) &header, sizeof(Header));
 
-    writeHeader(m_sampleFile, header);
+    if (m_recordChunked)
+    {
+        // about 100ms per chunk
+        unsigned int chunkSize = std::max(1U<<12, std::min(1U<<18, m_sampleRate / 10));
+        m_chunkSamples.resize(chunkSize);
+        m_chunkData.resize(sizeof(ChunkHeader) + IQCodec::getMaxEncodedSize(chunkSize, sizeof(FixReal)));
+        m_chunkFill = 0;
+        m_chunkIndex.clear();
+        m_fileOffset = sizeof(Header);
+        m_recordSamples = 0;
+        m_startTimeMs = QDateTime::currentMSecsSinceEpoch() + m_msShift;
+    }
+}
+
+void FileRecord::writeChunk()
+{
+    ChunkHeader chunkHeader;
+    chunkHeader.magic = m_chunkMagic;
+    chunkHeader.nbSamples = m_chunkFill;
+    chunkHeader.payloadSize = IQCodec::encode(
+        (const FixReal *) m_chunkSamples.data(),
+        m_chunkFill,
+        m_chunkData.data() + sizeof(ChunkHeader)
+    );
+    chunkHeader.sampleRate = m_sampleRate;
+    chunkHeader.centerFrequency = m_centerFrequency;
+    chunkHeader.timeStampMs = m_startTimeMs + (m_sampleRate == 0 ? 0 : (m_recordSamples * 1000) / m_sampleRate);
+    chunkHeader.sampleIndex = m_recordSamples;
+    chunkHeader.crc32 = getChunkHeaderCRC(chunkHeader);
+    std::memcpy(m_chunkData.data(), &chunkHeader, sizeof(ChunkHeader));
+
+    // a chunk is dropped as a whole when the disk does not keep up so that the file offsets stay known
+    unsigned int chunkBytes = sizeof(ChunkHeader) + chunkHeader.payloadSize;
+
+    if (m_sampleFile.writeRecord((const char *) m_chunkData.data(), chunkBytes))
+    {
+        ChunkIndexEntry entry;
+        entry.offset = m_fileOffset;
+        entry.sampleIndex = m_recordSamples;
+        entry.timeStampMs = chunkHeader.timeStampMs;
+        m_chunkIndex.push_back(entry);
+        m_fileOffset += chunkBytes;
+    }
+
+    m_recordSamples += m_chunkFill;
+    m_chunkFill = 0;
+}
+
+void FileRecord::writeChunkIndex()
+{
+    IndexTrailer trailer;
+    trailer.indexOffset = m_fileOffset;
+    trailer.nbSamples = m_recordSamples;
+    trailer.nbChunks = m_chunkIndex.size();
+    trailer.magic = m_indexMagic;
+
+    if (m_chunkIndex.size() > 0) {
+        m_sampleFile.writeNoDrop((const char *) m_chunkIndex.data(), m_chunkIndex.size() * sizeof(ChunkIndexEntry));
+    }
+
+    m_sampleFile.writeNoDrop((const char *) &trailer, sizeof(IndexTrailer));
+    m_chunkIndex.clear();
 }
 
 bool FileRecord::readHeader(std::ifstream& sampleFile, Header& header)
@@ -175,9 +297,97 @@ bool FileRecord::readHeader(std::ifstream& sampleFile, Header& header)
 }
 
 void FileRecord::writeHeader(std::ofstream& sampleFile, Header& header)
+{
+    setHeaderCRC(header);
+    sampleFile.write((const char *) &header, sizeof(Header));
+}
+
+void FileRecord::setHeaderCRC(Header& header)
 {
     boost::crc_32_type crc32;
     crc32.process_bytes(&header, 28);
     header.crc32 = crc32.checksum();
-    sampleFile.write((const char *) &header, sizeof(Header));
+}
+
+quint32 FileRecord::getChunkHeaderCRC(const ChunkHeader& chunkHeader)
+{
+    boost::crc_32_type crc32;
+    crc32.process_bytes(&chunkHeader, sizeof(ChunkHeader) - sizeof(quint32));
+    return crc32.checksum();
+}
+
+const FileRecord::ChunkHeader *FileRecord::getChunkHeader(const quint8 *data, quint64 size, quint64 offset)
+{
+    if ((offset > size) || (size - offset < sizeof(ChunkHeader))) {
+        return nullptr;
+    }
+
+    const ChunkHeader *chunkHeader = (const ChunkHeader *) (data + offset);
+
+    if ((chunkHeader->magic != m_chunkMagic)
+     || (chunkHeader->crc32 != getChunkHeaderCRC(*chunkHeader))
+     || (size - offset - sizeof(ChunkHeader) < chunkHeader->payloadSize)) {
+        return nullptr;
+    }
+
+    return chunkHeader;
+}
+
+quint64 FileRecord::readChunkIndex(const quint8 *data, quint64 size, std::vector<ChunkIndexEntry>& index)
+{
+    index.clear();
+
+    if (size >= sizeof(Header) + sizeof(IndexTrailer))
+    {
+        IndexTrailer trailer;
+        std::memcpy(&trailer, data + size - sizeof(IndexTrailer), sizeof(IndexTrailer));
+
+        if ((trailer.magic == m_indexMagic)
+         && (trailer.indexOffset >= sizeof(Header))
+         && (trailer.indexOffset + trailer.nbChunks * sizeof(ChunkIndexEntry) + sizeof(IndexTrailer) == size))
+        {
+            index.resize(trailer.nbChunks);
+
+            if (trailer.nbChunks > 0) {
+                std::memcpy(index.data(), data + trailer.indexOffset, trailer.nbChunks * sizeof(ChunkIndexEntry));
+            }
+
+            return trailer.nbSamples;
+        }
+    }
+
+    // the recording was interrupted. Rebuilds the index from the chunk headers.
+    qWarning("FileRecord::readChunkIndex: no index. Scanning the chunks");
+    quint64 offset = sizeof(Header);
+    quint64 nbSamples = 0;
+    const ChunkHeader *chunkHeader;
+
+    while (offset + sizeof(ChunkHeader) <= size)
+    {
+        chunkHeader = getChunkHeader(data, size, offset);
+
+        if (!chunkHeader || (chunkHeader->sampleIndex < nbSamples))
+        {
+            // damaged chunk: resumes at the next valid chunk header
+            offset++;
+            continue;
+        }
+
+        ChunkIndexEntry entry;
+        entry.offset = offset;
+        entry.sampleIndex = chunkHeader->sampleIndex;
+        entry.timeStampMs = chunkHeader->timeStampMs;
+        index.push_back(entry);
+        nbSamples = chunkHeader->sampleIndex + chunkHeader->nbSamples;
+        offset += sizeof(ChunkHeader) + chunkHeader->payloadSize;
+    }
+
+    return nbSamples;
+}
+
+int FileRecord::findChunk(const std::vector<ChunkIndexEntry>& index, quint64 sampleIndex)
+{
+    std::vector<ChunkIndexEntry>::const_iterator it = std::upper_bound(index.begin(), index.end(), sampleIndex,
+        [](quint64 s, const ChunkIndexEntry& entry) { return s < entry.sampleIndex; });
+    return (int) (it - index.begin()) - 1;
 }
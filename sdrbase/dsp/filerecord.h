@@ -23,8 +23,10 @@
 #include <iostream>
 #include <fstream>
 #include <ctime>
+#include <vector>
 
 #include "dsp/filerecordinterface.h"
+#include "dsp/filerecordwriter.h"
 #include "export.h"
 
 class Message;
@@ -39,11 +41,45 @@ public:
         quint64 centerFrequency;
         quint64 startTimeStamp;
         quint32 sampleSize;
-        quint32 filler;
+        quint32 filler;             //!< m_chunkedFormatTag for the chunked format else unused
         quint32 crc32;
     };
+
+    // Chunked format (v2). The header is followed by chunks of samples coded with IQCodec that can
+    // be decoded independently. Each starts with a ChunkHeader. The file ends with the index of the
+    // chunks and an IndexTrailer. The index is rebuilt from the chunk headers if it is missing.
+    struct ChunkHeader
+    {
+        quint32 magic;              //!< m_chunkMagic
+        quint32 nbSamples;
+        quint32 payloadSize;        //!< coded samples bytes following the header
+        quint32 sampleRate;
+        quint64 centerFrequency;
+        quint64 timeStampMs;        //!< UTC time of the first sample in milliseconds since epoch
+        quint64 sampleIndex;        //!< index of the first sample in the record
+        quint32 crc32;              //!< of the above
+    };
+
+    struct ChunkIndexEntry
+    {
+        quint64 offset;             //!< of the chunk header in the file
+        quint64 sampleIndex;
+        quint64 timeStampMs;
+    };
+
+    struct IndexTrailer
+    {
+        quint64 indexOffset;
+        quint64 nbSamples;
+        quint32 nbChunks;
+        quint32 magic;              //!< m_indexMagic
+    };
 #pragma pack(pop)
 
+    static const quint32 m_chunkedFormatTag = 0x32514953; //!< "SIQ2"
+    static const quint32 m_chunkMagic = 0x4b4e4843;       //!< "CHNK"
+    static const quint32 m_indexMagic = 0x58444e49;       //!< "INDX"
+
 	FileRecord();
     FileRecord(const QString& fileBase);
 	virtual ~FileRecord();
@@ -51,6 +87,11 @@ public:
     quint64 getByteCount() const { return m_byteCount; }
     void setMsShift(int shift) { m_msShift = shift; }
     const QString& getCurrentFileName() { return m_curentFileName; }
+    void setDirectIO(bool directIO) { m_directIO = directIO; } //!< applies at the next recording start
+    void setChunked(bool chunked) { m_chunked = chunked; }    //!< compressed chunks format (v2). Applies at the next recording start.
+    quint64 getDroppedBuffers() const { return m_sampleFile.getDroppedBuffers(); }
+    float getWriteLatencyMs() const { return m_sampleFile.getWriteLatencyMs(); }
+    float getMaxWriteLatencyMs() const { return m_sampleFile.getMaxWriteLatencyMs(); }
 
     void genUniqueFileName(uint deviceUID, int istream = -1);
 
@@ -66,6 +107,10 @@ public:
 
     static bool readHeader(std::ifstream& samplefile, Header& header); //!< returns true if CRC checksum is correct else false
     static void writeHeader(std::ofstream& samplefile, Header& header);
+    static bool isChunked(const Header& header) { return header.filler == m_chunkedFormatTag; }
+    static quint64 readChunkIndex(const quint8 *data, quint64 size, std::vector<ChunkIndexEntry>& index); //!< from the whole file data. Returns the number of samples.
+    static const ChunkHeader *getChunkHeader(const quint8 *data, quint64 size, quint64 offset); //!< nullptr if there is no valid chunk at offset
+    static int findChunk(const std::vector<ChunkIndexEntry>& index, quint64 sampleIndex); //!< chunk holding the sample. -1 if none.
 
 private:
 	QString m_fileBase;
@@ -73,12 +118,26 @@ private:
 	quint64 m_centerFrequency;
 	bool m_recordOn;
     bool m_recordStart;
-    std::ofstream m_sampleFile;
+    FileRecordWriter m_sampleFile;
+    bool m_directIO;
+    bool m_chunked;
+    bool m_recordChunked;           //!< format of the current recording
+    SampleVector m_chunkSamples;
+    unsigned int m_chunkFill;
+    std::vector<quint8> m_chunkData;
+    std::vector<ChunkIndexEntry> m_chunkIndex;
+    quint64 m_fileOffset;
+    quint64 m_recordSamples;
+    qint64 m_startTimeMs;
     QString m_curentFileName;
     quint64 m_byteCount;
     int m_msShift;
 
     void writeHeader();
+    void writeChunk();
+    void writeChunkIndex();
+    static void setHeaderCRC(Header& header);
+    static quint32 getChunkHeaderCRC(const ChunkHeader& chunkHeader);
 };
 
 #endif // INCLUDE_FILERECORD_H
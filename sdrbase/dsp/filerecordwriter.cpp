@@ -0,0 +1,369 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstring>
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#include "filerecordwriter.h"
+
+const unsigned int FileRecordWriter::m_defaultBufferSize;
+const unsigned int FileRecordWriter::m_defaultNbBuffers;
+const unsigned int FileRecordWriter::m_alignment;
+const quint64 FileRecordWriter::m_preallocationSize;
+
+FileRecordWriter::FileRecordWriter(unsigned int bufferSize, unsigned int nbBuffers) :
+    m_bufferSize(((bufferSize + m_alignment - 1) / m_alignment) * m_alignment),
+    m_buffers(std::max(2u, nbBuffers)),
+    m_current(nullptr),
+    m_dropFill(0),
+    m_closing(false),
+    m_thread(nullptr),
+    m_directIO(false),
+    m_offset(0),
+    m_preallocated(0),
+    m_droppedBuffers(0),
+    m_buffersWritten(0),
+    m_latencySumNs(0),
+    m_latencyMaxNs(0)
+{
+    for (Buffer& buffer : m_buffers)
+    {
+        buffer.m_data = nullptr;
+        buffer.m_fill = 0;
+    }
+}
+
+FileRecordWriter::~FileRecordWriter()
+{
+    close();
+}
+
+bool FileRecordWriter::open(const QString& fileName, bool directIO)
+{
+    close();
+
+    m_directIO = false;
+#ifdef Q_OS_LINUX
+    int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    int fd = directIO ? ::open(fileName.toLocal8Bit().constData(), flags | O_DIRECT, 0644) : -1;
+
+    if (fd >= 0) {
+        m_directIO = true;
+    } else {
+        fd = ::open(fileName.toLocal8Bit().constData(), flags, 0644); // also when the file system does not support O_DIRECT
+    }
+
+    if ((fd < 0) || !m_file.open(fd, QIODevice::WriteOnly | QIODevice::Unbuffered, QFileDevice::AutoCloseHandle))
+    {
+        qCritical("FileRecordWriter::open: cannot open %s: %s", qPrintable(fileName), strerror(errno));
+
+        if (fd >= 0) {
+            ::close(fd);
+        }
+
+        return false;
+    }
+#else
+    (void) directIO;
+    m_file.setFileName(fileName);
+
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered))
+    {
+        qCritical("FileRecordWriter::open: cannot open %s: %s", qPrintable(fileName), qPrintable(m_file.errorString()));
+        return false;
+    }
+#endif
+
+    qDebug("FileRecordWriter::open: %s%s", qPrintable(fileName), m_directIO ? " (direct I/O)" : "");
+    m_freeBuffers.clear();
+    m_queuedBuffers.clear();
+
+    for (Buffer& buffer : m_buffers)
+    {
+        if (!buffer.m_data) // allocated on first use only as there is one writer per recorder
+        {
+            buffer.m_storage.resize(m_bufferSize + m_alignment);
+            quintptr p = (quintptr) buffer.m_storage.data();
+            buffer.m_data = (char *) ((p + m_alignment - 1) & ~((quintptr) m_alignment - 1));
+        }
+
+        m_freeBuffers.push_back(&buffer);
+    }
+
+    m_current = takeFreeBuffer();
+    m_dropFill = 0;
+    m_closing = false;
+    m_offset = 0;
+    m_preallocated = 0;
+    m_droppedBuffers.store(0);
+    m_buffersWritten.store(0);
+    m_latencySumNs.store(0);
+    m_latencyMaxNs.store(0);
+    m_thread = new WriterThread(this);
+    m_thread->start();
+
+    return true;
+}
+
+void FileRecordWriter::close()
+{
+    if (!m_thread) {
+        return;
+    }
+
+    if (m_current && (m_current->m_fill > 0)) {
+        queueBuffer(m_current);
+    } else if (m_dropFill > 0) {
+        m_droppedBuffers.fetch_add(1);
+    }
+
+    m_current = nullptr;
+    m_mutex.lock();
+    m_closing = true;
+    m_bufferQueued.wakeAll();
+    m_mutex.unlock();
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+
+#ifdef Q_OS_LINUX
+    // releases what was preallocated past the end
+    if (ftruncate(m_file.handle(), m_offset) < 0) {
+        qWarning("FileRecordWriter::close: ftruncate: %s", strerror(errno));
+    }
+#endif
+    m_file.close();
+    qDebug("FileRecordWriter::close: %llu bytes written. %llu buffers dropped. Write latency avg: %.2f ms max: %.2f ms",
+        m_offset, getDroppedBuffers(), getWriteLatencyMs(), getMaxWriteLatencyMs());
+}
+
+void FileRecordWriter::write(const char *data, unsigned int size)
+{
+    if (!m_thread) {
+        return;
+    }
+
+    while (size > 0)
+    {
+        if (!m_current)
+        {
+            // dropping until a buffer is freed and then on buffer boundaries so that O_DIRECT writes stay aligned
+            if ((m_dropFill == 0) && (m_current = takeFreeBuffer())) {
+                continue;
+            }
+
+            unsigned int len = std::min(size, m_bufferSize - m_dropFill);
+            m_dropFill += len;
+            data += len;
+            size -= len;
+
+            if (m_dropFill == m_bufferSize)
+            {
+                m_droppedBuffers.fetch_add(1);
+                m_dropFill = 0;
+            }
+
+            continue;
+        }
+
+        unsigned int len = std::min(size, m_bufferSize - m_current->m_fill);
+        std::memcpy(m_current->m_data + m_current->m_fill, data, len);
+        m_current->m_fill += len;
+        data += len;
+        size -= len;
+
+        if (m_current->m_fill == m_bufferSize)
+        {
+            queueBuffer(m_current);
+            m_current = takeFreeBuffer();
+        }
+    }
+}
+
+bool FileRecordWriter::writeRecord(const char *data, unsigned int size)
+{
+    if (!m_thread) {
+        return false;
+    }
+
+    if (m_current || (m_dropFill == 0))
+    {
+        // only the writer thread frees buffers so the room can only grow until the record is written
+        unsigned int room = m_current ? m_bufferSize - m_current->m_fill : 0;
+
+        if (room < size)
+        {
+            QMutexLocker mutexLocker(&m_mutex);
+            room += m_freeBuffers.size() * m_bufferSize;
+        }
+
+        if (room >= size)
+        {
+            write(data, size);
+            return true;
+        }
+    }
+
+    m_droppedBuffers.fetch_add(1);
+    return false;
+}
+
+void FileRecordWriter::writeNoDrop(const char *data, unsigned int size)
+{
+    if (!m_thread) {
+        return;
+    }
+
+    while (size > 0)
+    {
+        if (!m_current)
+        {
+            m_mutex.lock();
+
+            while (m_freeBuffers.empty()) {
+                m_bufferFreed.wait(&m_mutex);
+            }
+
+            m_mutex.unlock();
+            m_current = takeFreeBuffer();
+            m_dropFill = 0;
+        }
+
+        unsigned int len = std::min(size, m_bufferSize - m_current->m_fill);
+        write(data, len);
+        data += len;
+        size -= len;
+    }
+}
+
+float FileRecordWriter::getWriteLatencyMs() const
+{
+    quint64 nbBuffers = m_buffersWritten.load();
+    return nbBuffers == 0 ? 0.0f : (m_latencySumNs.load() / (float) nbBuffers) / 1e6f;
+}
+
+FileRecordWriter::Buffer *FileRecordWriter::takeFreeBuffer()
+{
+    QMutexLocker mutexLocker(&m_mutex);
+
+    if (m_freeBuffers.empty()) {
+        return nullptr;
+    }
+
+    Buffer *buffer = m_freeBuffers.front();
+    m_freeBuffers.pop_front();
+    buffer->m_fill = 0;
+    return buffer;
+}
+
+void FileRecordWriter::queueBuffer(Buffer *buffer)
+{
+    QMutexLocker mutexLocker(&m_mutex);
+    m_queuedBuffers.push_back(buffer);
+    m_bufferQueued.wakeOne();
+}
+
+void FileRecordWriter::work()
+{
+    QMutexLocker mutexLocker(&m_mutex);
+
+    while (true)
+    {
+        while (m_queuedBuffers.empty() && !m_closing) {
+            m_bufferQueued.wait(&m_mutex);
+        }
+
+        if (m_queuedBuffers.empty()) {
+            break; // closing and everything is written
+        }
+
+        Buffer *buffer = m_queuedBuffers.front();
+        m_queuedBuffers.pop_front();
+        mutexLocker.unlock();
+        writeBuffer(buffer);
+        mutexLocker.relock();
+        m_freeBuffers.push_back(buffer);
+        m_bufferFreed.wakeAll();
+    }
+}
+
+void FileRecordWriter::writeBuffer(Buffer *buffer)
+{
+    QElapsedTimer timer;
+    timer.start();
+    preallocate(m_offset + buffer->m_fill);
+
+#ifdef Q_OS_LINUX
+    if (m_directIO && (buffer->m_fill % m_alignment != 0))
+    {
+        // last write of the file: O_DIRECT needs whole blocks
+        int flags = fcntl(m_file.handle(), F_GETFL);
+
+        if (flags & O_DIRECT) {
+            fcntl(m_file.handle(), F_SETFL, flags & ~O_DIRECT);
+        }
+    }
+#endif
+
+    qint64 written = m_file.write(buffer->m_data, buffer->m_fill);
+
+    if (written != (qint64) buffer->m_fill)
+    {
+        qCritical("FileRecordWriter::writeBuffer: %s", qPrintable(m_file.errorString()));
+        m_droppedBuffers.fetch_add(1);
+    }
+
+    if (written > 0) {
+        m_offset += written;
+    }
+
+    quint64 latency = timer.nsecsElapsed();
+    quint64 latencyMax = m_latencyMaxNs.load();
+    m_latencySumNs.fetch_add(latency);
+    m_buffersWritten.fetch_add(1);
+
+    if (latency > latencyMax) {
+        m_latencyMaxNs.store(latency); // only this thread updates it
+    }
+}
+
+void FileRecordWriter::preallocate(quint64 end)
+{
+#ifdef Q_OS_LINUX
+    if (end <= m_preallocated) {
+        return;
+    }
+
+    // reserves the blocks ahead without changing the file size so that a write does not wait for the allocator
+    if (fallocate(m_file.handle(), FALLOC_FL_KEEP_SIZE, m_preallocated, m_preallocationSize) == 0) {
+        m_preallocated += m_preallocationSize;
+    } else {
+        m_preallocated = (quint64) -1; // not supported by the file system
+    }
+#else
+    (void) end;
+#endif
+}
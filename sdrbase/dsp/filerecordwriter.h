@@ -0,0 +1,120 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_FILERECORDWRITER_H
+#define INCLUDE_FILERECORDWRITER_H
+
+#include <atomic>
+#include <deque>
+#include <vector>
+
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "export.h"
+
+/**
+ * Writes a record file from a dedicated thread so that the thread producing the data
+ * never waits for the disk.
+ *
+ * write() copies the data to the current buffer. Full buffers are queued to the writer
+ * thread which gives them back once written. When no buffer is free because the disk does
+ * not keep up the data is dropped one buffer size at a time and counted in getDroppedBuffers().
+ * Formats that index their records use writeRecord() instead which drops a record as a whole
+ * when it does not fit in the free buffers, so that the file offsets of the records written
+ * are known, and writeNoDrop() for the data that must never be dropped which waits for buffers.
+ * The mutex is only held to exchange buffers, never during a disk write.
+ *
+ * On Linux the file can be opened with O_DIRECT so that the recording does not go through the
+ * page cache. Buffers are aligned for it and only the last write of the file may be partial.
+ * The file is preallocated with fallocate ahead of the write position.
+ * write() must be called from one thread only and open() and close() from the same thread.
+ */
+class SDRBASE_API FileRecordWriter
+{
+public:
+    FileRecordWriter(unsigned int bufferSize = m_defaultBufferSize, unsigned int nbBuffers = m_defaultNbBuffers);
+    ~FileRecordWriter();
+
+    bool open(const QString& fileName, bool directIO = false); //!< truncates the file and resets the statistics
+    void close(); //!< writes the pending data and waits for completion
+    bool isOpen() const { return m_thread != nullptr; }
+    bool isDirectIO() const { return m_directIO; }
+    void write(const char *data, unsigned int size);
+    bool writeRecord(const char *data, unsigned int size); //!< all or nothing. Returns false if dropped.
+    void writeNoDrop(const char *data, unsigned int size); //!< waits for free buffers if necessary
+
+    quint64 getDroppedBuffers() const { return m_droppedBuffers.load(); } //!< including the records dropped
+    float getWriteLatencyMs() const;    //!< average time to write a buffer
+    float getMaxWriteLatencyMs() const { return m_latencyMaxNs.load() / 1e6f; }
+
+    static const unsigned int m_defaultBufferSize = 1<<20;
+    static const unsigned int m_defaultNbBuffers = 8;
+    static const unsigned int m_alignment = 4096; //!< O_DIRECT buffer, size and offset alignment
+    static const quint64 m_preallocationSize = 256<<20;
+
+private:
+    class WriterThread : public QThread
+    {
+    public:
+        WriterThread(FileRecordWriter *writer) : m_writer(writer) {}
+    protected:
+        virtual void run() { m_writer->work(); }
+    private:
+        FileRecordWriter *m_writer;
+    };
+
+    struct Buffer
+    {
+        std::vector<char> m_storage; //!< over allocated for alignment
+        char *m_data;
+        unsigned int m_fill;
+    };
+
+    unsigned int m_bufferSize;
+    std::vector<Buffer> m_buffers;
+    std::deque<Buffer*> m_freeBuffers;
+    std::deque<Buffer*> m_queuedBuffers;
+    Buffer *m_current;              //!< producer buffer. nullptr when dropping.
+    unsigned int m_dropFill;        //!< bytes dropped since the last buffer dropped
+    bool m_closing;
+    QMutex m_mutex;
+    QWaitCondition m_bufferQueued;
+    QWaitCondition m_bufferFreed;
+    WriterThread *m_thread;
+
+    QFile m_file;
+    bool m_directIO;
+    quint64 m_offset;               //!< writer thread
+    quint64 m_preallocated;         //!< writer thread
+
+    std::atomic<quint64> m_droppedBuffers;
+    std::atomic<quint64> m_buffersWritten;
+    std::atomic<quint64> m_latencySumNs;
+    std::atomic<quint64> m_latencyMaxNs;
+
+    Buffer *takeFreeBuffer();
+    void queueBuffer(Buffer *buffer);
+    void work();
+    void writeBuffer(Buffer *buffer);
+    void preallocate(quint64 end);
+};
+
+#endif // INCLUDE_FILERECORDWRITER_H
@@ -3341,7 +3341,8 @@ void g_fft<FFT_TYPE>::RealFFT(std::complex<FFT_TYPE> *buf)
 {
 	void *ptr = buf;
 	FFT_TYPE *nbuf = static_cast<FFT_TYPE *>(ptr);
-	rffts1(nbuf, FFT_N, Utbl, BRLow);
+	// the real FFT runs a complex FFT of half the size with its own bit reverse table
+	rffts1(nbuf, FFT_N, Utbl, FFT_table_2[(FFT_N - 1) / 2]);
 }
 
 //------------------------------------------------------------------------------
@@ -3358,7 +3359,7 @@ void g_fft<FFT_TYPE>::InverseRealFFT(std::complex<FFT_TYPE> *buf)
 {
 	void *ptr = buf;
 	FFT_TYPE *nbuf = static_cast<FFT_TYPE *>(ptr);
-	riffts1(nbuf, FFT_N, Utbl, BRLow);
+	riffts1(nbuf, FFT_N, Utbl, FFT_table_2[(FFT_N - 1) / 2]);
 }
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,46 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_DSP_GLSCOPEINTERFACE_H_
+#define SDRBASE_DSP_GLSCOPEINTERFACE_H_
+
+#include <vector>
+#include "dsp/scopevis.h"
+
+/**
+ * Display side of ScopeVis. Default implementations do nothing so that ScopeVis can run headless.
+ */
+class GLScopeInterface
+{
+public:
+    GLScopeInterface() {}
+    virtual ~GLScopeInterface() {}
+    virtual void setTraces(std::vector<ScopeVis::TraceData>* tracesData, std::vector<float *>* traces) {}
+    virtual void newTraces(std::vector<float *>* traces, int traceIndex, std::vector<Projector::ProjectionType>* projectionTypes) {}
+    virtual int getProcessingTraceIndex() const { return -1; } //!< index of the trace buffer being displayed or -1 if none
+    virtual void setTriggerPre(uint32_t triggerPre, bool emitSignal = false) {}
+    virtual void setTimeOfsProMill(int timeOfsProMill) {}
+    virtual void setSampleRate(int sampleRate) {}
+    virtual void setTimeBase(int timeBase) {}
+    virtual void setFocusedTraceIndex(uint32_t traceIndex) {}
+    virtual void setTraceSize(int traceSize, bool emitSignal = false) {}
+    virtual void updateDisplay() {}
+    virtual void setFocusedTriggerData(ScopeVis::TriggerData& triggerData) {}
+    virtual void setConfigChanged() {}
+};
+
+#endif // SDRBASE_DSP_GLSCOPEINTERFACE_H_
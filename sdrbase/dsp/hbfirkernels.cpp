@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <QDebug>
+
+#include "hbfirkernels.h"
+
+const HBFIRKernels& HBFIRKernels::instance()
+{
+    static HBFIRKernels kernels;
+    return kernels;
+}
+
+HBFIRKernels::HBFIRKernels()
+{
+    m_level = getAvailableLevel(CPUFeatures::instance().getBestLevel());
+    qInfo("HBFIRKernels::HBFIRKernels: using %s half-band filter kernels", CPUFeatures::getLevelName(m_level));
+}
+
+CPUFeatures::SIMDLevel HBFIRKernels::getAvailableLevel(CPUFeatures::SIMDLevel level)
+{
+    const CPUFeatures& cpu = CPUFeatures::instance();
+    (void) cpu;
+
+#if defined(HBFIR_X86)
+    if ((level == CPUFeatures::SIMDAVX512) && cpu.hasAVX512()) {
+        return CPUFeatures::SIMDAVX512;
+    } else if (((level == CPUFeatures::SIMDAVX2) || (level == CPUFeatures::SIMDAVX512)) && cpu.hasAVX2()) {
+        return CPUFeatures::SIMDAVX2;
+    } else if ((level >= CPUFeatures::SIMDSSE41) && (level != CPUFeatures::SIMDNEON) && cpu.hasSSE41()) {
+        return CPUFeatures::SIMDSSE41;
+    }
+#elif defined(HBFIR_NEON)
+    if ((level == CPUFeatures::SIMDNEON) && cpu.hasNEON()) {
+        return CPUFeatures::SIMDNEON;
+    }
+#else
+    (void) level;
+#endif
+
+    return CPUFeatures::SIMDGeneric;
+}
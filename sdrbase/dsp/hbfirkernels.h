@@ -0,0 +1,224 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+#ifndef SDRBASE_DSP_HBFIRKERNELS_H_
+#define SDRBASE_DSP_HBFIRKERNELS_H_
+
+#include <QtGlobal>
+
+#include "util/cpufeatures.h"
+#include "export.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HBFIR_X86
+#define HBFIR_TARGET(arch) __attribute__((target(arch)))
+#define HBFIR_FLATTEN __attribute__((flatten))
+#elif defined(_MSC_VER) && (defined(_M_AMD64) || defined(_M_IX86))
+#include <immintrin.h>
+#define HBFIR_X86
+#define HBFIR_TARGET(arch)
+#define HBFIR_FLATTEN
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define HBFIR_NEON
+#define HBFIR_TARGET(arch)
+#define HBFIR_FLATTEN __attribute__((flatten))
+#else
+#define HBFIR_TARGET(arch)
+#define HBFIR_FLATTEN
+#endif
+
+/**
+ * Half-band FIR symmetric tap kernels selected at run time for the host CPU.
+ *
+ * Each kernel computes for the I and Q rails:
+ *   acc += sum_{i=0}^{nbTaps-1} (tip[-i] + tail[i]) * coeffs[i]
+ * with 64 bit storage holding 32 bit values (FixReal or int32_t as stored by the half-band filters).
+ * All kernels give bit exact results with the generic one.
+ *
+ * Kernels are policy classes given as template argument to the IntHalfbandFilterEO work methods.
+ * They only have around 12 or 16 taps to process so they have to be inlined: the caller compiles
+ * a whole block loop per kernel in a function with the matching HBFIR_TARGET and HBFIR_FLATTEN
+ * attributes and selects one of these functions once (see DownChannelizer).
+ */
+class SDRBASE_API HBFIRKernels
+{
+public:
+    // Stored values fit in 32 bits so each product is done on 32 bit operands with a 64 bit result
+    // as with _mm_mul_epi32 or vmlal_s32. The tip and tail sums are not formed before the
+    // multiplication since they could need 33 bits.
+
+    struct Generic
+    {
+        static inline void symmetricFIR64(
+            const qint64 *tipI, const qint64 *tipQ,
+            const qint64 *tailI, const qint64 *tailQ,
+            const qint32 *coeffs, int nbTaps,
+            qint64& iAcc, qint64& qAcc)
+        {
+            for (int i = 0; i < nbTaps; i++)
+            {
+                iAcc += (tipI[-i] + tailI[i]) * coeffs[i];
+                qAcc += (tipQ[-i] + tailQ[i]) * coeffs[i];
+            }
+        }
+    };
+
+#if defined(HBFIR_X86)
+    struct SSE41
+    {
+        HBFIR_TARGET("sse4.1")
+        static inline void symmetricFIR64(
+            const qint64 *tipI, const qint64 *tipQ,
+            const qint64 *tailI, const qint64 *tailQ,
+            const qint32 *coeffs, int nbTaps,
+            qint64& iAcc, qint64& qAcc)
+        {
+            __m128i accI = _mm_setzero_si128();
+            __m128i accQ = _mm_setzero_si128();
+            int i = 0;
+
+            for (; i + 2 <= nbTaps; i += 2)
+            {
+                __m128i c = _mm_cvtepi32_epi64(_mm_loadl_epi64((const __m128i*) &coeffs[i])); // c[i], c[i+1]
+                __m128i cr = _mm_shuffle_epi32(c, _MM_SHUFFLE(1, 0, 3, 2));                    // c[i+1], c[i]
+                accI = _mm_add_epi64(accI, _mm_mul_epi32(_mm_loadu_si128((const __m128i*) &tailI[i]), c));
+                accI = _mm_add_epi64(accI, _mm_mul_epi32(_mm_loadu_si128((const __m128i*) &tipI[-i-1]), cr));
+                accQ = _mm_add_epi64(accQ, _mm_mul_epi32(_mm_loadu_si128((const __m128i*) &tailQ[i]), c));
+                accQ = _mm_add_epi64(accQ, _mm_mul_epi32(_mm_loadu_si128((const __m128i*) &tipQ[-i-1]), cr));
+            }
+
+            __m128i sum = _mm_add_epi64(_mm_unpacklo_epi64(accI, accQ), _mm_unpackhi_epi64(accI, accQ)); // I, Q
+            qint64 sums[2];
+            _mm_storeu_si128((__m128i*) sums, sum);
+            iAcc += sums[0];
+            qAcc += sums[1];
+
+            Generic::symmetricFIR64(tipI - i, tipQ - i, tailI + i, tailQ + i, coeffs + i, nbTaps - i, iAcc, qAcc);
+        }
+    };
+
+    struct AVX2
+    {
+        HBFIR_TARGET("avx2")
+        static inline void symmetricFIR64(
+            const qint64 *tipI, const qint64 *tipQ,
+            const qint64 *tailI, const qint64 *tailQ,
+            const qint32 *coeffs, int nbTaps,
+            qint64& iAcc, qint64& qAcc)
+        {
+            __m256i accI = _mm256_setzero_si256();
+            __m256i accQ = _mm256_setzero_si256();
+            int i = 0;
+
+            for (; i + 4 <= nbTaps; i += 4)
+            {
+                __m256i c = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*) &coeffs[i])); // c[i] .. c[i+3]
+                __m256i cr = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(0, 1, 2, 3));               // c[i+3] .. c[i]
+                accI = _mm256_add_epi64(accI, _mm256_mul_epi32(_mm256_loadu_si256((const __m256i*) &tailI[i]), c));
+                accI = _mm256_add_epi64(accI, _mm256_mul_epi32(_mm256_loadu_si256((const __m256i*) &tipI[-i-3]), cr));
+                accQ = _mm256_add_epi64(accQ, _mm256_mul_epi32(_mm256_loadu_si256((const __m256i*) &tailQ[i]), c));
+                accQ = _mm256_add_epi64(accQ, _mm256_mul_epi32(_mm256_loadu_si256((const __m256i*) &tipQ[-i-3]), cr));
+            }
+
+            __m256i sum4 = _mm256_add_epi64(_mm256_unpacklo_epi64(accI, accQ), _mm256_unpackhi_epi64(accI, accQ)); // I, Q, I, Q
+            __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(sum4), _mm256_extracti128_si256(sum4, 1));           // I, Q
+            qint64 sums[2];
+            _mm_storeu_si128((__m128i*) sums, sum);
+            iAcc += sums[0];
+            qAcc += sums[1];
+
+            Generic::symmetricFIR64(tipI - i, tipQ - i, tailI + i, tailQ + i, coeffs + i, nbTaps - i, iAcc, qAcc);
+        }
+    };
+
+    struct AVX512
+    {
+        HBFIR_TARGET("avx512f")
+        static inline void symmetricFIR64(
+            const qint64 *tipI, const qint64 *tipQ,
+            const qint64 *tailI, const qint64 *tailQ,
+            const qint32 *coeffs, int nbTaps,
+            qint64& iAcc, qint64& qAcc)
+        {
+            const __m512i reverse = _mm512_set_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+            __m512i accI = _mm512_setzero_si512();
+            __m512i accQ = _mm512_setzero_si512();
+            int i = 0;
+
+            for (; i + 8 <= nbTaps; i += 8)
+            {
+                __m512i c = _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i*) &coeffs[i])); // c[i] .. c[i+7]
+                __m512i cr = _mm512_permutexvar_epi64(reverse, c);                                   // c[i+7] .. c[i]
+                accI = _mm512_add_epi64(accI, _mm512_mul_epi32(_mm512_loadu_si512((const void*) &tailI[i]), c));
+                accI = _mm512_add_epi64(accI, _mm512_mul_epi32(_mm512_loadu_si512((const void*) &tipI[-i-7]), cr));
+                accQ = _mm512_add_epi64(accQ, _mm512_mul_epi32(_mm512_loadu_si512((const void*) &tailQ[i]), c));
+                accQ = _mm512_add_epi64(accQ, _mm512_mul_epi32(_mm512_loadu_si512((const void*) &tipQ[-i-7]), cr));
+            }
+
+            iAcc += _mm512_reduce_add_epi64(accI);
+            qAcc += _mm512_reduce_add_epi64(accQ);
+
+            // remainder of 12 taps filters (order 48) goes through AVX2
+            AVX2::symmetricFIR64(tipI - i, tipQ - i, tailI + i, tailQ + i, coeffs + i, nbTaps - i, iAcc, qAcc);
+        }
+    };
+#endif // HBFIR_X86
+
+#if defined(HBFIR_NEON)
+    struct NEON
+    {
+        static inline void symmetricFIR64(
+            const qint64 *tipI, const qint64 *tipQ,
+            const qint64 *tailI, const qint64 *tailQ,
+            const qint32 *coeffs, int nbTaps,
+            qint64& iAcc, qint64& qAcc)
+        {
+            int64x2_t accI = vdupq_n_s64(0);
+            int64x2_t accQ = vdupq_n_s64(0);
+            int i = 0;
+
+            for (; i + 2 <= nbTaps; i += 2)
+            {
+                int32x2_t c = vld1_s32(&coeffs[i]); // c[i], c[i+1]
+                int32x2_t cr = vrev64_s32(c);       // c[i+1], c[i]
+                accI = vmlal_s32(accI, vmovn_s64(vld1q_s64((const int64_t*) &tailI[i])), c);
+                accI = vmlal_s32(accI, vmovn_s64(vld1q_s64((const int64_t*) &tipI[-i-1])), cr);
+                accQ = vmlal_s32(accQ, vmovn_s64(vld1q_s64((const int64_t*) &tailQ[i])), c);
+                accQ = vmlal_s32(accQ, vmovn_s64(vld1q_s64((const int64_t*) &tipQ[-i-1])), cr);
+            }
+
+            iAcc += vgetq_lane_s64(accI, 0) + vgetq_lane_s64(accI, 1);
+            qAcc += vgetq_lane_s64(accQ, 0) + vgetq_lane_s64(accQ, 1);
+
+            Generic::symmetricFIR64(tipI - i, tipQ - i, tailI + i, tailQ + i, coeffs + i, nbTaps - i, iAcc, qAcc);
+        }
+    };
+#endif // HBFIR_NEON
+
+    static const HBFIRKernels& instance();
+
+    CPUFeatures::SIMDLevel getLevel() const { return m_level; } //!< best kernel for the host CPU
+    static CPUFeatures::SIMDLevel getAvailableLevel(CPUFeatures::SIMDLevel level); //!< kernel actually used when asking for level. Falls back to generic if not available.
+
+private:
+    HBFIRKernels();
+
+    CPUFeatures::SIMDLevel m_level;
+};
+
+#endif // SDRBASE_DSP_HBFIRKERNELS_H_
@@ -27,6 +27,7 @@
 #include <cstdlib>
 #include "dsp/dsptypes.h"
 #include "dsp/hbfiltertraits.h"
+#include "dsp/hbfirkernels.h"
 
 template<typename EOStorageType, typename AccuType, uint32_t HBFilterOrder, bool IQorder>
 class IntHalfbandFilterEO {
@@ -50,6 +51,8 @@ public:
     }
 
     // downsample by 2, return center part of original spectrum
+    // FIR is the HBFIRKernels kernel used for 64 bit storage. It is inlined so the caller selects it per block.
+    template<typename FIR = HBFIRKernels::Generic>
     bool workDecimateCenter(Sample* sample)
     {
         // insert sample into ring-buffer
@@ -67,7 +70,7 @@ public:
 
             default:
                 // save result
-                doFIR(sample);
+                doFIR<FIR>(sample);
                 // advance write-pointer
                 advancePointer();
                 // next state
@@ -171,6 +174,7 @@ public:
     }
 
     // downsample by 2, return lower half of original spectrum
+    template<typename FIR = HBFIRKernels::Generic>
     bool workDecimateLowerHalf(Sample* sample)
     {
         switch(m_state)
@@ -189,7 +193,7 @@ public:
                 // insert sample into ring-buffer
                 storeSample((FixReal) -sample->real(), (FixReal) -sample->imag());
                 // save result
-                doFIR(sample);
+                doFIR<FIR>(sample);
                 // advance write-pointer
                 advancePointer();
                 // next state
@@ -211,7 +215,7 @@ public:
                 // insert sample into ring-buffer
                 storeSample((FixReal) sample->real(), (FixReal) sample->imag());
                 // save result
-                doFIR(sample);
+                doFIR<FIR>(sample);
                 // advance write-pointer
                 advancePointer();
                 // next state
@@ -370,6 +374,7 @@ public:
     }
 
     // downsample by 2, return upper half of original spectrum
+    template<typename FIR = HBFIRKernels::Generic>
     bool workDecimateUpperHalf(Sample* sample)
     {
         switch(m_state)
@@ -388,7 +393,7 @@ public:
                 // insert sample into ring-buffer
                 storeSample((FixReal) -sample->real(), (FixReal) -sample->imag());
                 // save result
-                doFIR(sample);
+                doFIR<FIR>(sample);
                 // advance write-pointer
                 advancePointer();
                 // next state
@@ -410,7 +415,7 @@ public:
                 // insert sample into ring-buffer
                 storeSample((FixReal) sample->real(), (FixReal) sample->imag());
                 // save result
-                doFIR(sample);
+                doFIR<FIR>(sample);
                 // advance write-pointer
                 advancePointer();
                 // next state
@@ -837,30 +842,42 @@ protected:
         m_ptr = m_ptr + 1 < 2*m_size ? m_ptr + 1: 0;
     }
 
-    void doFIR(Sample* sample)
+    template<typename FIR = HBFIRKernels::Generic>
+    void doSymmetricFIR(AccuType& iAcc, AccuType& qAcc)
     {
-        AccuType iAcc = 0;
-        AccuType qAcc = 0;
-
+        EOStorageType (*eo)[HBFIRFilterTraits<HBFilterOrder>::hbOrder] = (m_ptr % 2) == 0 ? m_even : m_odd;
         int a = m_ptr/2 + m_size; // tip pointer
         int b = m_ptr/2 + 1; // tail pointer
 
+        symmetricFIR<FIR>(&eo[0][a], &eo[1][a], &eo[0][b], &eo[1][b], iAcc, qAcc);
+    }
+
+    // 64 bit storage: kernel given by the caller
+    template<typename FIR>
+    void symmetricFIR(const qint64 *tipI, const qint64 *tipQ, const qint64 *tailI, const qint64 *tailQ, qint64& iAcc, qint64& qAcc)
+    {
+        FIR::symmetricFIR64(tipI, tipQ, tailI, tailQ,
+            HBFIRFilterTraits<HBFilterOrder>::hbCoeffs, HBFIRFilterTraits<HBFilterOrder>::hbOrder / 4, iAcc, qAcc);
+    }
+
+    // 32 bit storage (16 bit samples): generic loop whatever the kernel
+    template<typename FIR, typename T>
+    void symmetricFIR(const T *tipI, const T *tipQ, const T *tailI, const T *tailQ, AccuType& iAcc, AccuType& qAcc)
+    {
         for (int i = 0; i < HBFIRFilterTraits<HBFilterOrder>::hbOrder / 4; i++)
         {
-            if ((m_ptr % 2) == 0)
-            {
-                iAcc += ((EOStorageType)(m_even[0][a] + m_even[0][b])) * HBFIRFilterTraits<HBFilterOrder>::hbCoeffs[i];
-                qAcc += ((EOStorageType)(m_even[1][a] + m_even[1][b])) * HBFIRFilterTraits<HBFilterOrder>::hbCoeffs[i];
-            }
-            else
-            {
-                iAcc += ((EOStorageType)(m_odd[0][a] + m_odd[0][b])) * HBFIRFilterTraits<HBFilterOrder>::hbCoeffs[i];
-                qAcc += ((EOStorageType)(m_odd[1][a] + m_odd[1][b])) * HBFIRFilterTraits<HBFilterOrder>::hbCoeffs[i];
-            }
-
-            a -= 1;
-            b += 1;
+            iAcc += ((EOStorageType)(tipI[-i] + tailI[i])) * HBFIRFilterTraits<HBFilterOrder>::hbCoeffs[i];
+            qAcc += ((EOStorageType)(tipQ[-i] + tailQ[i])) * HBFIRFilterTraits<HBFilterOrder>::hbCoeffs[i];
         }
+    }
+
+    template<typename FIR = HBFIRKernels::Generic>
+    void doFIR(Sample* sample)
+    {
+        AccuType iAcc = 0;
+        AccuType qAcc = 0;
+
+        doSymmetricFIR<FIR>(iAcc, qAcc);
 
         if ((m_ptr % 2) == 0)
         {
@@ -882,25 +899,7 @@ protected:
         AccuType iAcc = 0;
         AccuType qAcc = 0;
 
-        int a = m_ptr/2 + m_size; // tip pointer
-        int b = m_ptr/2 + 1; // tail pointer
-
-        for (int i = 0; i < HBFIRFilterTraits<HBFilterOrder>::hbOrder / 4; i++)
-        {
-            if ((m_ptr % 2) == 0)
-            {
-                iAcc += ((EOStorageType)(m_even[0][a] + m_even[0][b])) * HBFIRFilterTraits<HBFilterOrder>::hbCoeffs[i];
-                qAcc += ((EOStorageType)(m_even[1][a] + m_even[1][b])) * HBFIRFilterTraits<HBFilterOrder>::hbCoeffs[i];
-            }
-            else
-            {
-                iAcc += ((EOStorageType)(m_odd[0][a] + m_odd[0][b])) * HBFIRFilterTraits<HBFilterOrder>::hbCoeffs[i];
-                qAcc += ((EOStorageType)(m_odd[1][a] + m_odd[1][b])) * HBFIRFilterTraits<HBFilterOrder>::hbCoeffs[i];
-            }
-
-            a -= 1;
-            b += 1;
-        }
+        doSymmetricFIR(iAcc, qAcc);
 
         if ((m_ptr % 2) == 0)
         {
@@ -0,0 +1,248 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstring>
+
+#include "iqcodec.h"
+
+const unsigned int IQCodec::m_blockSize;
+
+namespace {
+
+template<typename T> struct IQCodecTraits;
+template<> struct IQCodecTraits<qint16> { typedef quint16 U; };
+template<> struct IQCodecTraits<qint32> { typedef quint32 U; };
+
+// ..., -2, -1, 0, 1, 2, ... to ..., 3, 1, 0, 2, 4, ...
+template<typename T>
+inline typename IQCodecTraits<T>::U zigzag(T v)
+{
+    typedef typename IQCodecTraits<T>::U U;
+    return (U) (((U) v << 1) ^ (U) (v >> (sizeof(T)*8 - 1)));
+}
+
+template<typename T>
+inline T unzigzag(typename IQCodecTraits<T>::U u)
+{
+    typedef typename IQCodecTraits<T>::U U;
+    return (T) (U) ((u >> 1) ^ (U) (0 - (u & 1)));
+}
+
+inline unsigned int bitWidth(quint32 v)
+{
+    unsigned int width = 0;
+
+    while (v)
+    {
+        width++;
+        v >>= 1;
+    }
+
+    return width;
+}
+
+// m_blockSize values of width bits take exactly width 32 bit words
+template<typename U>
+inline quint8 *pack(const U *values, unsigned int width, quint8 *out)
+{
+    quint64 acc = 0;
+    unsigned int bits = 0;
+
+    for (unsigned int i = 0; i < IQCodec::m_blockSize; i++)
+    {
+        acc |= (quint64) values[i] << bits;
+        bits += width;
+
+        if (bits >= 32)
+        {
+            quint32 word = (quint32) acc;
+            std::memcpy(out, &word, sizeof(word));
+            out += sizeof(word);
+            acc >>= 32;
+            bits -= 32;
+        }
+    }
+
+    return out;
+}
+
+template<typename U>
+inline void unpack(const quint8 *in, unsigned int width, U *values)
+{
+    quint64 mask = (1ULL << width) - 1;
+    quint64 acc = 0;
+    unsigned int bits = 0;
+
+    for (unsigned int i = 0; i < IQCodec::m_blockSize; i++)
+    {
+        if (bits < width)
+        {
+            quint32 word;
+            std::memcpy(&word, in, sizeof(word));
+            in += sizeof(word);
+            acc |= (quint64) word << bits;
+            bits += 32;
+        }
+
+        values[i] = (U) (acc & mask);
+        acc >>= width;
+        bits -= width;
+    }
+}
+
+template<typename T>
+unsigned int encodeIQ(const T *iq, unsigned int nbSamples, quint8 *out)
+{
+    typedef typename IQCodecTraits<T>::U U;
+    const unsigned int blockSize = IQCodec::m_blockSize;
+    quint8 *p = out;
+    T prev[2] = {0, 0};
+    U raw[blockSize];
+    U diff[blockSize];
+
+    for (unsigned int b = 0; b < nbSamples; b += blockSize)
+    {
+        unsigned int n = std::min(blockSize, nbSamples - b);
+
+        for (int c = 0; c < 2; c++)
+        {
+            const T *x = &iq[2*b + c];
+            T last = prev[c];
+            U rawOr = 0;
+            U diffOr = 0;
+
+            for (unsigned int i = 0; i < n; i++)
+            {
+                raw[i] = zigzag<T>(x[2*i]);
+                diff[i] = zigzag<T>((T) (U) ((U) x[2*i] - (U) last));
+                last = x[2*i];
+                rawOr |= raw[i];
+                diffOr |= diff[i];
+            }
+
+            for (unsigned int i = n; i < blockSize; i++)
+            {
+                raw[i] = 0;
+                diff[i] = 0;
+            }
+
+            prev[c] = last;
+            unsigned int rawWidth = bitWidth(rawOr);
+            unsigned int diffWidth = bitWidth(diffOr);
+
+            if (diffWidth < rawWidth)
+            {
+                *p++ = 0x80 | diffWidth;
+                p = pack(diff, diffWidth, p);
+            }
+            else
+            {
+                *p++ = rawWidth;
+                p = pack(raw, rawWidth, p);
+            }
+        }
+    }
+
+    return p - out;
+}
+
+template<typename T>
+bool decodeIQ(const quint8 *in, unsigned int size, T *iq, unsigned int nbSamples)
+{
+    typedef typename IQCodecTraits<T>::U U;
+    const unsigned int blockSize = IQCodec::m_blockSize;
+    const quint8 *p = in;
+    const quint8 *end = in + size;
+    T prev[2] = {0, 0};
+    U values[blockSize];
+
+    for (unsigned int b = 0; b < nbSamples; b += blockSize)
+    {
+        unsigned int n = std::min(blockSize, nbSamples - b);
+
+        for (int c = 0; c < 2; c++)
+        {
+            if (p >= end) {
+                return false;
+            }
+
+            bool isDiff = (*p & 0x80) != 0;
+            unsigned int width = *p & 0x3f;
+            p++;
+
+            if ((width > sizeof(T)*8) || ((unsigned int) (end - p) < width * 4)) {
+                return false;
+            }
+
+            unpack(p, width, values);
+            p += width * 4;
+            T *x = &iq[2*b + c];
+
+            if (isDiff)
+            {
+                T last = prev[c];
+
+                for (unsigned int i = 0; i < n; i++)
+                {
+                    last = (T) (U) ((U) last + (U) unzigzag<T>(values[i]));
+                    x[2*i] = last;
+                }
+
+                prev[c] = last;
+            }
+            else
+            {
+                for (unsigned int i = 0; i < n; i++) {
+                    x[2*i] = unzigzag<T>(values[i]);
+                }
+
+                prev[c] = x[2*(n-1)];
+            }
+        }
+    }
+
+    return true;
+}
+
+}
+
+unsigned int IQCodec::getMaxEncodedSize(unsigned int nbSamples, unsigned int sampleBytes)
+{
+    unsigned int nbBlocks = (nbSamples + m_blockSize - 1) / m_blockSize;
+    return nbBlocks * 2 * (1 + m_blockSize * sampleBytes);
+}
+
+unsigned int IQCodec::encode(const qint16 *iq, unsigned int nbSamples, quint8 *out)
+{
+    return encodeIQ(iq, nbSamples, out);
+}
+
+unsigned int IQCodec::encode(const qint32 *iq, unsigned int nbSamples, quint8 *out)
+{
+    return encodeIQ(iq, nbSamples, out);
+}
+
+bool IQCodec::decode(const quint8 *in, unsigned int size, qint16 *iq, unsigned int nbSamples)
+{
+    return decodeIQ(in, size, iq, nbSamples);
+}
+
+bool IQCodec::decode(const quint8 *in, unsigned int size, qint32 *iq, unsigned int nbSamples)
+{
+    return decodeIQ(in, size, iq, nbSamples);
+}
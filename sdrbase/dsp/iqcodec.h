@@ -0,0 +1,48 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_IQCODEC_H
+#define INCLUDE_IQCODEC_H
+
+#include <QtGlobal>
+
+#include "export.h"
+
+/**
+ * Fast lossless coding of interleaved I/Q samples.
+ *
+ * I and Q are coded separately in blocks of m_blockSize samples. Each block is stored either
+ * as is or as the differences with the previous sample whichever needs the less bits. The values
+ * are zigzag mapped to unsigned and packed with the bit width of the largest one. A block
+ * starts with one byte: bit 7 set for differences and the bit width in the low bits.
+ *
+ * A coded buffer does not depend on any other so it can be decoded on its own. The data is
+ * little endian like the rest of the record files.
+ */
+class SDRBASE_API IQCodec
+{
+public:
+    static const unsigned int m_blockSize = 32;
+
+    static unsigned int getMaxEncodedSize(unsigned int nbSamples, unsigned int sampleBytes); //!< bytes to reserve for encode()
+    static unsigned int encode(const qint16 *iq, unsigned int nbSamples, quint8 *out); //!< returns the number of bytes written
+    static unsigned int encode(const qint32 *iq, unsigned int nbSamples, quint8 *out);
+    static bool decode(const quint8 *in, unsigned int size, qint16 *iq, unsigned int nbSamples); //!< false if the data is short or invalid
+    static bool decode(const quint8 *in, unsigned int size, qint32 *iq, unsigned int nbSamples);
+};
+
+#endif // INCLUDE_IQCODEC_H
@@ -0,0 +1,472 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+
+#include <QDebug>
+
+#include "iqcorrector.h"
+
+// SIMD kernels work on the 24 bit sample layout (two packed int32) only
+#if defined(SDR_RX_SAMPLE_24BIT)
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define IQCORR_X86
+#define IQCORR_TARGET(arch) __attribute__((target(arch)))
+#elif defined(_MSC_VER) && (defined(_M_AMD64) || defined(_M_IX86))
+#include <immintrin.h>
+#define IQCORR_X86
+#define IQCORR_TARGET(arch)
+#elif defined(__aarch64__) // 64 bit lane widening multiply accumulate and across vector add
+#include <arm_neon.h>
+#define IQCORR_NEON
+#endif
+#endif
+
+static void sumsGeneric(const Sample *samples, unsigned int n, IQCorrector::Moments& moments)
+{
+    for (unsigned int i = 0; i < n; i++)
+    {
+        moments.m_i += samples[i].m_real;
+        moments.m_q += samples[i].m_imag;
+    }
+}
+
+static void momentsGeneric(const Sample *samples, unsigned int n, IQCorrector::Moments& moments)
+{
+    for (unsigned int i = 0; i < n; i++)
+    {
+        int64_t xi = samples[i].m_real;
+        int64_t xq = samples[i].m_imag;
+        moments.m_i += xi;
+        moments.m_q += xq;
+        moments.m_ii += xi*xi;
+        moments.m_iq += xi*xq;
+        moments.m_qq += xq*xq;
+    }
+}
+
+static void dcGeneric(Sample *samples, unsigned int n, int32_t dcI, int32_t dcQ)
+{
+    for (unsigned int i = 0; i < n; i++)
+    {
+        samples[i].m_real -= dcI;
+        samples[i].m_imag -= dcQ;
+    }
+}
+
+static void imbalanceGeneric(Sample *samples, unsigned int n, int32_t dcI, int32_t dcQ, float a, float b)
+{
+    for (unsigned int i = 0; i < n; i++)
+    {
+        int32_t xi = samples[i].m_real - dcI;
+        int32_t xq = samples[i].m_imag - dcQ;
+        samples[i].m_real = xi;
+        samples[i].m_imag = (int32_t) (a * xq - b * xi);
+    }
+}
+
+#if defined(IQCORR_X86)
+IQCORR_TARGET("sse4.1")
+static void sumsSSE41(const Sample *samples, unsigned int n, IQCorrector::Moments& moments)
+{
+    // 2 samples per vector as I0 Q0 I1 Q1
+    const __m128i *p = (const __m128i*) samples;
+    unsigned int nv = n / 2;
+    __m128i acc = _mm_setzero_si128(); // I Q
+
+    for (unsigned int i = 0; i < nv; i++)
+    {
+        __m128i x = _mm_loadu_si128(p + i);
+        acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(x));
+        acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(_mm_srli_si128(x, 8)));
+    }
+
+    moments.m_i += _mm_extract_epi64(acc, 0);
+    moments.m_q += _mm_extract_epi64(acc, 1);
+    sumsGeneric(samples + 2*nv, n - 2*nv, moments);
+}
+
+IQCORR_TARGET("sse4.1")
+static void momentsSSE41(const Sample *samples, unsigned int n, IQCorrector::Moments& moments)
+{
+    const __m128i *p = (const __m128i*) samples;
+    unsigned int nv = n / 2;
+    __m128i acc = _mm_setzero_si128(); // I Q
+    __m128i accII = _mm_setzero_si128();
+    __m128i accIQ = _mm_setzero_si128();
+    __m128i accQQ = _mm_setzero_si128();
+
+    for (unsigned int i = 0; i < nv; i++)
+    {
+        __m128i x = _mm_loadu_si128(p + i);
+        __m128i q = _mm_srli_epi64(x, 32); // Q in the low half of each 64 bit lane
+        acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(x));
+        acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(_mm_srli_si128(x, 8)));
+        accII = _mm_add_epi64(accII, _mm_mul_epi32(x, x));
+        accIQ = _mm_add_epi64(accIQ, _mm_mul_epi32(x, q));
+        accQQ = _mm_add_epi64(accQQ, _mm_mul_epi32(q, q));
+    }
+
+    moments.m_i += _mm_extract_epi64(acc, 0);
+    moments.m_q += _mm_extract_epi64(acc, 1);
+    moments.m_ii += _mm_extract_epi64(accII, 0) + _mm_extract_epi64(accII, 1);
+    moments.m_iq += _mm_extract_epi64(accIQ, 0) + _mm_extract_epi64(accIQ, 1);
+    moments.m_qq += _mm_extract_epi64(accQQ, 0) + _mm_extract_epi64(accQQ, 1);
+    momentsGeneric(samples + 2*nv, n - 2*nv, moments);
+}
+
+IQCORR_TARGET("sse4.1")
+static void dcSSE41(Sample *samples, unsigned int n, int32_t dcI, int32_t dcQ)
+{
+    __m128i *p = (__m128i*) samples;
+    unsigned int nv = n / 2;
+    const __m128i dc = _mm_setr_epi32(dcI, dcQ, dcI, dcQ);
+
+    for (unsigned int i = 0; i < nv; i++) {
+        _mm_storeu_si128(p + i, _mm_sub_epi32(_mm_loadu_si128(p + i), dc));
+    }
+
+    dcGeneric(samples + 2*nv, n - 2*nv, dcI, dcQ);
+}
+
+IQCORR_TARGET("sse4.1")
+static void imbalanceSSE41(Sample *samples, unsigned int n, int32_t dcI, int32_t dcQ, float a, float b)
+{
+    __m128i *p = (__m128i*) samples;
+    unsigned int nv = n / 2;
+    const __m128i dc = _mm_setr_epi32(dcI, dcQ, dcI, dcQ);
+    const __m128 coef = _mm_setr_ps(-b, a, -b, a);
+
+    for (unsigned int i = 0; i < nv; i++)
+    {
+        __m128i x = _mm_sub_epi32(_mm_loadu_si128(p + i), dc);
+        __m128 m = _mm_mul_ps(_mm_cvtepi32_ps(x), coef); // -b*I0 a*Q0 -b*I1 a*Q1
+        __m128 z = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+        _mm_storeu_si128(p + i, _mm_blend_epi16(x, _mm_cvttps_epi32(z), 0xCC)); // Q lanes from z
+    }
+
+    imbalanceGeneric(samples + 2*nv, n - 2*nv, dcI, dcQ, a, b);
+}
+
+IQCORR_TARGET("avx2")
+static void sumsAVX2(const Sample *samples, unsigned int n, IQCorrector::Moments& moments)
+{
+    // 4 samples per vector as I0 Q0 ... I3 Q3
+    const __m256i *p = (const __m256i*) samples;
+    unsigned int nv = n / 4;
+    __m256i acc = _mm256_setzero_si256(); // I Q I Q
+
+    for (unsigned int i = 0; i < nv; i++)
+    {
+        __m256i x = _mm256_loadu_si256(p + i);
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+    }
+
+    __m128i s = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    moments.m_i += _mm_extract_epi64(s, 0);
+    moments.m_q += _mm_extract_epi64(s, 1);
+    sumsGeneric(samples + 4*nv, n - 4*nv, moments);
+}
+
+IQCORR_TARGET("avx2")
+static inline int64_t hsumAVX2(__m256i v)
+{
+    __m128i s = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    return _mm_extract_epi64(s, 0) + _mm_extract_epi64(s, 1);
+}
+
+IQCORR_TARGET("avx2")
+static void momentsAVX2(const Sample *samples, unsigned int n, IQCorrector::Moments& moments)
+{
+    const __m256i *p = (const __m256i*) samples;
+    unsigned int nv = n / 4;
+    __m256i acc = _mm256_setzero_si256(); // I Q I Q
+    __m256i accII = _mm256_setzero_si256();
+    __m256i accIQ = _mm256_setzero_si256();
+    __m256i accQQ = _mm256_setzero_si256();
+
+    for (unsigned int i = 0; i < nv; i++)
+    {
+        __m256i x = _mm256_loadu_si256(p + i);
+        __m256i q = _mm256_srli_epi64(x, 32); // Q in the low half of each 64 bit lane
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+        accII = _mm256_add_epi64(accII, _mm256_mul_epi32(x, x));
+        accIQ = _mm256_add_epi64(accIQ, _mm256_mul_epi32(x, q));
+        accQQ = _mm256_add_epi64(accQQ, _mm256_mul_epi32(q, q));
+    }
+
+    __m128i s = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    moments.m_i += _mm_extract_epi64(s, 0);
+    moments.m_q += _mm_extract_epi64(s, 1);
+    moments.m_ii += hsumAVX2(accII);
+    moments.m_iq += hsumAVX2(accIQ);
+    moments.m_qq += hsumAVX2(accQQ);
+    momentsGeneric(samples + 4*nv, n - 4*nv, moments);
+}
+
+IQCORR_TARGET("avx2")
+static void dcAVX2(Sample *samples, unsigned int n, int32_t dcI, int32_t dcQ)
+{
+    __m256i *p = (__m256i*) samples;
+    unsigned int nv = n / 4;
+    const __m256i dc = _mm256_setr_epi32(dcI, dcQ, dcI, dcQ, dcI, dcQ, dcI, dcQ);
+
+    for (unsigned int i = 0; i < nv; i++) {
+        _mm256_storeu_si256(p + i, _mm256_sub_epi32(_mm256_loadu_si256(p + i), dc));
+    }
+
+    dcGeneric(samples + 4*nv, n - 4*nv, dcI, dcQ);
+}
+
+IQCORR_TARGET("avx2")
+static void imbalanceAVX2(Sample *samples, unsigned int n, int32_t dcI, int32_t dcQ, float a, float b)
+{
+    __m256i *p = (__m256i*) samples;
+    unsigned int nv = n / 4;
+    const __m256i dc = _mm256_setr_epi32(dcI, dcQ, dcI, dcQ, dcI, dcQ, dcI, dcQ);
+    const __m256 coef = _mm256_setr_ps(-b, a, -b, a, -b, a, -b, a);
+
+    for (unsigned int i = 0; i < nv; i++)
+    {
+        __m256i x = _mm256_sub_epi32(_mm256_loadu_si256(p + i), dc);
+        __m256 m = _mm256_mul_ps(_mm256_cvtepi32_ps(x), coef);
+        __m256 z = _mm256_add_ps(m, _mm256_permute_ps(m, _MM_SHUFFLE(2, 3, 0, 1)));
+        _mm256_storeu_si256(p + i, _mm256_blend_epi32(x, _mm256_cvttps_epi32(z), 0xAA)); // Q lanes from z
+    }
+
+    imbalanceGeneric(samples + 4*nv, n - 4*nv, dcI, dcQ, a, b);
+}
+#endif // IQCORR_X86
+
+#if defined(IQCORR_NEON)
+static void sumsNEON(const Sample *samples, unsigned int n, IQCorrector::Moments& moments)
+{
+    const int32_t *p = (const int32_t*) samples;
+    unsigned int nv = n / 4;
+    int64x2_t accI = vdupq_n_s64(0);
+    int64x2_t accQ = vdupq_n_s64(0);
+
+    for (unsigned int i = 0; i < nv; i++, p += 8)
+    {
+        int32x4x2_t iq = vld2q_s32(p); // de-interleaved I and Q
+        accI = vpadalq_s32(accI, iq.val[0]);
+        accQ = vpadalq_s32(accQ, iq.val[1]);
+    }
+
+    moments.m_i += vaddvq_s64(accI);
+    moments.m_q += vaddvq_s64(accQ);
+    sumsGeneric(samples + 4*nv, n - 4*nv, moments);
+}
+
+static void momentsNEON(const Sample *samples, unsigned int n, IQCorrector::Moments& moments)
+{
+    const int32_t *p = (const int32_t*) samples;
+    unsigned int nv = n / 4;
+    int64x2_t accI = vdupq_n_s64(0);
+    int64x2_t accQ = vdupq_n_s64(0);
+    int64x2_t accII = vdupq_n_s64(0);
+    int64x2_t accIQ = vdupq_n_s64(0);
+    int64x2_t accQQ = vdupq_n_s64(0);
+
+    for (unsigned int i = 0; i < nv; i++, p += 8)
+    {
+        int32x4x2_t iq = vld2q_s32(p);
+        accI = vpadalq_s32(accI, iq.val[0]);
+        accQ = vpadalq_s32(accQ, iq.val[1]);
+        accII = vmlal_high_s32(vmlal_s32(accII, vget_low_s32(iq.val[0]), vget_low_s32(iq.val[0])), iq.val[0], iq.val[0]);
+        accIQ = vmlal_high_s32(vmlal_s32(accIQ, vget_low_s32(iq.val[0]), vget_low_s32(iq.val[1])), iq.val[0], iq.val[1]);
+        accQQ = vmlal_high_s32(vmlal_s32(accQQ, vget_low_s32(iq.val[1]), vget_low_s32(iq.val[1])), iq.val[1], iq.val[1]);
+    }
+
+    moments.m_i += vaddvq_s64(accI);
+    moments.m_q += vaddvq_s64(accQ);
+    moments.m_ii += vaddvq_s64(accII);
+    moments.m_iq += vaddvq_s64(accIQ);
+    moments.m_qq += vaddvq_s64(accQQ);
+    momentsGeneric(samples + 4*nv, n - 4*nv, moments);
+}
+
+static void dcNEON(Sample *samples, unsigned int n, int32_t dcI, int32_t dcQ)
+{
+    int32_t *p = (int32_t*) samples;
+    unsigned int nv = n / 2;
+    const int32_t dcs[4] = {dcI, dcQ, dcI, dcQ};
+    const int32x4_t dc = vld1q_s32(dcs);
+
+    for (unsigned int i = 0; i < nv; i++, p += 4) {
+        vst1q_s32(p, vsubq_s32(vld1q_s32(p), dc));
+    }
+
+    dcGeneric(samples + 2*nv, n - 2*nv, dcI, dcQ);
+}
+
+static void imbalanceNEON(Sample *samples, unsigned int n, int32_t dcI, int32_t dcQ, float a, float b)
+{
+    int32_t *p = (int32_t*) samples;
+    unsigned int nv = n / 4;
+    const int32x4_t dcIv = vdupq_n_s32(dcI);
+    const int32x4_t dcQv = vdupq_n_s32(dcQ);
+
+    for (unsigned int i = 0; i < nv; i++, p += 8)
+    {
+        int32x4x2_t iq = vld2q_s32(p);
+        iq.val[0] = vsubq_s32(iq.val[0], dcIv);
+        float32x4_t zq = vsubq_f32(
+            vmulq_n_f32(vcvtq_f32_s32(vsubq_s32(iq.val[1], dcQv)), a),
+            vmulq_n_f32(vcvtq_f32_s32(iq.val[0]), b));
+        iq.val[1] = vcvtq_s32_f32(zq); // rounds towards zero
+        vst2q_s32(p, iq);
+    }
+
+    imbalanceGeneric(samples + 4*nv, n - 4*nv, dcI, dcQ, a, b);
+}
+#endif // IQCORR_NEON
+
+IQCorrector::IQCorrector()
+{
+    reset();
+    setKernelLevel(CPUFeatures::instance().getBestLevel());
+}
+
+void IQCorrector::reset()
+{
+    m_n = 0.0;
+    m_i = 0.0;
+    m_q = 0.0;
+    m_ii = 0.0;
+    m_iq = 0.0;
+    m_qq = 0.0;
+    m_dcI = 0;
+    m_dcQ = 0;
+    m_phi = 0.0;
+    m_amp = 1.0;
+    m_imbalanceCorrection = false;
+}
+
+void IQCorrector::setKernelLevel(CPUFeatures::SIMDLevel level)
+{
+    const CPUFeatures& cpu = CPUFeatures::instance();
+    m_kernelLevel = CPUFeatures::SIMDGeneric;
+    m_sumsKernel = sumsGeneric;
+    m_momentsKernel = momentsGeneric;
+    m_dcKernel = dcGeneric;
+    m_imbalanceKernel = imbalanceGeneric;
+
+#if defined(IQCORR_X86)
+    if (((level == CPUFeatures::SIMDAVX2) || (level == CPUFeatures::SIMDAVX512)) && cpu.hasAVX2())
+    {
+        m_kernelLevel = CPUFeatures::SIMDAVX2;
+        m_sumsKernel = sumsAVX2;
+        m_momentsKernel = momentsAVX2;
+        m_dcKernel = dcAVX2;
+        m_imbalanceKernel = imbalanceAVX2;
+    }
+    else if ((level >= CPUFeatures::SIMDSSE41) && (level != CPUFeatures::SIMDNEON) && cpu.hasSSE41())
+    {
+        m_kernelLevel = CPUFeatures::SIMDSSE41;
+        m_sumsKernel = sumsSSE41;
+        m_momentsKernel = momentsSSE41;
+        m_dcKernel = dcSSE41;
+        m_imbalanceKernel = imbalanceSSE41;
+    }
+#elif defined(IQCORR_NEON)
+    if ((level == CPUFeatures::SIMDNEON) && cpu.hasNEON())
+    {
+        m_kernelLevel = CPUFeatures::SIMDNEON;
+        m_sumsKernel = sumsNEON;
+        m_momentsKernel = momentsNEON;
+        m_dcKernel = dcNEON;
+        m_imbalanceKernel = imbalanceNEON;
+    }
+#else
+    (void) level;
+    (void) cpu;
+#endif
+
+    qDebug("IQCorrector::setKernelLevel: requested: %s using: %s",
+        CPUFeatures::getLevelName(level), CPUFeatures::getLevelName(m_kernelLevel));
+}
+
+void IQCorrector::process(SampleVector::iterator begin, SampleVector::iterator end, bool imbalanceCorrection)
+{
+    Sample *samples = &(*begin);
+    unsigned int remainder = end - begin;
+
+    if (imbalanceCorrection != m_imbalanceCorrection) // the second order moments are only summed with imbalance correction
+    {
+        reset();
+        m_imbalanceCorrection = imbalanceCorrection;
+    }
+
+    while (remainder > 0)
+    {
+        unsigned int n = remainder < m_chunkSize ? remainder : m_chunkSize;
+        Moments moments = {0, 0, 0, 0, 0};
+
+        if (imbalanceCorrection)
+        {
+            m_momentsKernel(samples, n, moments);
+            estimate(moments, n, true);
+            m_imbalanceKernel(samples, n, m_dcI, m_dcQ, m_amp, m_amp * m_phi);
+        }
+        else
+        {
+            m_sumsKernel(samples, n, moments);
+            estimate(moments, n, false);
+            m_dcKernel(samples, n, m_dcI, m_dcQ);
+        }
+
+        samples += n;
+        remainder -= n;
+    }
+}
+
+void IQCorrector::estimate(const Moments& moments, unsigned int n, bool imbalanceCorrection)
+{
+    double decay = std::exp(-(double) n / m_timeConstant);
+    m_n = m_n * decay + n;
+    m_i = m_i * decay + moments.m_i;
+    m_q = m_q * decay + moments.m_q;
+    double meanI = m_i / m_n;
+    double meanQ = m_q / m_n;
+    m_dcI = (int32_t) meanI;
+    m_dcQ = (int32_t) meanQ;
+
+    if (!imbalanceCorrection) {
+        return;
+    }
+
+    m_ii = m_ii * decay + moments.m_ii;
+    m_iq = m_iq * decay + moments.m_iq;
+    m_qq = m_qq * decay + moments.m_qq;
+    double varI = m_ii / m_n - meanI * meanI;
+    double covIQ = m_iq / m_n - meanI * meanQ;
+    double varQ = m_qq / m_n - meanQ * meanQ;
+
+    if (varI > 0)
+    {
+        m_phi = covIQ / varI;
+        double varYQ = varQ - m_phi * covIQ; // variance of Q - phi * I
+
+        if (varYQ > 0) {
+            m_amp = std::sqrt(varI / varYQ);
+        }
+    }
+}
@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_DSP_IQCORRECTOR_H_
+#define SDRBASE_DSP_IQCORRECTOR_H_
+
+#include <stdint.h>
+
+#include "dsp/dsptypes.h"
+#include "util/cpufeatures.h"
+#include "export.h"
+
+/**
+ * DC offset and I/Q imbalance correction estimated once per block and applied by SIMD kernels.
+ *
+ * Each chunk of at most m_chunkSize samples is processed in two passes. The first pass sums the raw
+ * moments I, Q, I*I, I*Q and Q*Q of the chunk in 64 bit integers. They are added to exponentially
+ * decaying moments with a time constant of m_timeConstant samples from which the DC (means), the phase
+ * coefficient phi = cov(I,Q) / var(I) and the amplitude coefficient amp = sqrt(var(I) / var(Q - phi*I))
+ * are computed. The second pass applies them as constants over the chunk:
+ *   DC only:   I' = I - dcI, Q' = Q - dcQ
+ *   imbalance: I' = I - dcI, Q' = amp * (Q - dcQ) - amp * phi * (I - dcI)
+ *
+ * The former per sample estimator (moving averages of 1024 samples for DC and of 128 per sample ratios
+ * for phi and amp) is not reproduced bit for bit: the coefficients are piecewise constant over a chunk
+ * and come from the moments rather than from averaged per sample ratios, so they are less noisy.
+ */
+class SDRBASE_API IQCorrector
+{
+public:
+    IQCorrector();
+
+    void reset();
+    void process(SampleVector::iterator begin, SampleVector::iterator end, bool imbalanceCorrection);
+
+    int32_t getDCI() const { return m_dcI; }
+    int32_t getDCQ() const { return m_dcQ; }
+    double getPhi() const { return m_phi; }
+    double getAmp() const { return m_amp; }
+    CPUFeatures::SIMDLevel getKernelLevel() const { return m_kernelLevel; }
+    void setKernelLevel(CPUFeatures::SIMDLevel level); //!< force a kernel (benchmarks). Falls back to generic if not available.
+
+    static const unsigned int m_chunkSize = 4096;     //!< maximum samples per estimation
+    static const unsigned int m_timeConstant = 1024;  //!< decay of the moments in samples
+
+    struct Moments
+    {
+        int64_t m_i;
+        int64_t m_q;
+        int64_t m_ii;
+        int64_t m_iq;
+        int64_t m_qq;
+    };
+
+    typedef void (*SumsKernel)(const Sample *samples, unsigned int n, Moments& moments); //!< I and Q sums only
+    typedef void (*MomentsKernel)(const Sample *samples, unsigned int n, Moments& moments);
+    typedef void (*DCKernel)(Sample *samples, unsigned int n, int32_t dcI, int32_t dcQ);
+    typedef void (*ImbalanceKernel)(Sample *samples, unsigned int n, int32_t dcI, int32_t dcQ, float a, float b);
+
+private:
+    // exponentially decaying moments in sample units
+    double m_n;
+    double m_i;
+    double m_q;
+    double m_ii;
+    double m_iq;
+    double m_qq;
+    // coefficients of the last chunk
+    int32_t m_dcI;
+    int32_t m_dcQ;
+    double m_phi;
+    double m_amp;
+    bool m_imbalanceCorrection; //!< mode of the moments
+
+    CPUFeatures::SIMDLevel m_kernelLevel;
+    SumsKernel m_sumsKernel;
+    MomentsKernel m_momentsKernel;
+    DCKernel m_dcKernel;
+    ImbalanceKernel m_imbalanceKernel;
+
+    void estimate(const Moments& moments, unsigned int n, bool imbalanceCorrection);
+};
+
+#endif // SDRBASE_DSP_IQCORRECTOR_H_
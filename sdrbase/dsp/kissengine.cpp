@@ -1,7 +1,22 @@
+#include <cmath>
+
 #include "dsp/kissengine.h"
 
+KissEngine::KissEngine() :
+	m_type(TypeComplex),
+	m_n(0),
+	m_inverse(false),
+	m_howMany(1),
+	m_stride(1),
+	m_distance(0)
+{
+}
+
 void KissEngine::configure(int n, bool inverse)
 {
+	m_type = TypeComplex;
+	m_n = n;
+	m_inverse = inverse;
 	m_fft.configure(n, inverse);
 	if(n > m_in.size())
 		m_in.resize(n);
@@ -9,9 +24,111 @@ void KissEngine::configure(int n, bool inverse)
 		m_out.resize(n);
 }
 
+// n real samples are packed into n/2 complex samples and the half size spectrum is split
+// into the spectra of the even and odd samples to get the n/2+1 bins of the real signal
+void KissEngine::configureReal(int n, bool inverse)
+{
+	m_type = TypeReal;
+	m_n = n;
+	m_inverse = inverse;
+	m_fft.configure(n/2, inverse);
+	m_in.resize(n/2 + 1);
+	m_out.resize(n/2 + 1);
+	m_work.resize(n/2);
+	m_workOut.resize(n/2);
+	m_twiddles.resize(n/2);
+
+	for (int k = 0; k < n/2; k++) {
+		m_twiddles[k] = std::polar(1.0f, (Real) (-2.0 * M_PI * k / n));
+	}
+}
+
+void KissEngine::configureMany(int n, bool inverse, int howMany, int stride, int distance)
+{
+	m_type = TypeMany;
+	m_n = n;
+	m_inverse = inverse;
+	m_howMany = howMany;
+	m_stride = stride;
+	m_distance = distance;
+	m_fft.configure(n, inverse);
+	m_in.resize(manySize(n, howMany, stride, distance));
+	m_out.resize(manySize(n, howMany, stride, distance));
+	m_work.resize(n);
+	m_workOut.resize(n);
+}
+
 void KissEngine::transform()
 {
-	m_fft.transform(&m_in[0], &m_out[0]);
+	if (m_type == TypeReal)
+	{
+		if (m_inverse) {
+			transformRealInverse();
+		} else {
+			transformReal();
+		}
+	}
+	else if (m_type == TypeMany)
+	{
+		transformMany();
+	}
+	else
+	{
+		m_fft.transform(&m_in[0], &m_out[0]);
+	}
+}
+
+void KissEngine::transformReal()
+{
+	int h = m_n/2;
+	m_fft.transform(&m_in[0], &m_work[0]); // the n reals of inReal() are the n/2 complex of m_in
+
+	m_out[0] = Complex(m_work[0].real() + m_work[0].imag(), 0.0f);
+	m_out[h] = Complex(m_work[0].real() - m_work[0].imag(), 0.0f);
+
+	for (int k = 1; k < h; k++)
+	{
+		Complex z = m_work[k];
+		Complex zc = std::conj(m_work[h - k]);
+		Complex even = 0.5f * (z + zc);
+		Complex odd = Complex(0.0f, -0.5f) * (z - zc);
+		m_out[k] = even + m_twiddles[k] * odd;
+	}
+}
+
+void KissEngine::transformRealInverse()
+{
+	int h = m_n/2;
+
+	for (int k = 0; k < h; k++)
+	{
+		Complex x = m_in[k];
+		Complex xc = std::conj(m_in[h - k]);
+		Complex even = x + xc;
+		Complex odd = (x - xc) * std::conj(m_twiddles[k]);
+		m_work[k] = even + Complex(0.0f, 1.0f) * odd;
+	}
+
+	m_fft.transform(&m_work[0], &m_out[0]); // n/2 complex of m_out are the n reals of outReal()
+}
+
+void KissEngine::transformMany()
+{
+	for (int m = 0; m < m_howMany; m++)
+	{
+		const Complex *in = &m_in[m * m_distance];
+		Complex *out = &m_out[m * m_distance];
+
+		for (int k = 0; k < m_n; k++) {
+			m_work[k] = in[k * m_stride];
+		}
+
+		m_fft.transform(&m_work[0], &m_workOut[0]);
+
+		for (int k = 0; k < m_n; k++) {
+			out[k * m_stride] = m_workOut[k];
+		}
+	}
 }
 
 Complex* KissEngine::in()
@@ -24,7 +141,17 @@ Complex* KissEngine::out()
 	return &m_out[0];
 }
 
+Real* KissEngine::inReal()
+{
+	return reinterpret_cast<Real*>(&m_in[0]);
+}
+
+Real* KissEngine::outReal()
+{
+	return reinterpret_cast<Real*>(&m_out[0]);
+}
+
 void KissEngine::setReuse(bool reuse)
 {
     (void) reuse;
-}
\ No newline at end of file
+}
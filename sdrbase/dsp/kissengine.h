@@ -7,11 +7,17 @@
 
 class SDRBASE_API KissEngine : public FFTEngine {
 public:
+	KissEngine();
+
 	virtual void configure(int n, bool inverse);
+	virtual void configureReal(int n, bool inverse);
+	virtual void configureMany(int n, bool inverse, int howMany, int stride, int distance);
 	virtual void transform();
 
 	virtual Complex* in();
 	virtual Complex* out();
+	virtual Real* inReal();
+	virtual Real* outReal();
 
     virtual void setReuse(bool reuse);
 
@@ -19,8 +25,22 @@ protected:
 	typedef kissfft<Real, Complex> KissFFT;
 	KissFFT m_fft;
 
+	Type m_type;
+	int m_n;
+	bool m_inverse;
+	int m_howMany;
+	int m_stride;
+	int m_distance;
+
 	std::vector<Complex> m_in;
 	std::vector<Complex> m_out;
+	std::vector<Complex> m_work;    //!< half size transform of real data or one transform of a batch
+	std::vector<Complex> m_workOut;
+	std::vector<Complex> m_twiddles; //!< exp(-2i*pi*k/n) to split the half size transform of real data
+
+	void transformReal();
+	void transformRealInverse();
+	void transformMany();
 };
 
 #endif // INCLUDE_KISSENGINE_H
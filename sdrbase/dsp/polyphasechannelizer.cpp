@@ -0,0 +1,250 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <algorithm>
+
+#include <QDebug>
+
+#include "dsp/dspengine.h"
+#include "dsp/fftfactory.h"
+#include "dsp/fftengine.h"
+#include "polyphasechannelizer.h"
+
+const float PolyphaseChannelizer::m_passbandRatio = 0.65f;
+
+PolyphaseChannelizer::PolyphaseChannelizer() :
+    m_nbSubbands(0),
+    m_decimation(0),
+    m_basebandSampleRate(0),
+    m_subbandSampleRate(0),
+    m_subbandSpacing(0),
+    m_historyLength(0),
+    m_historyIndex(0),
+    m_inputCount(0),
+    m_frameCount(0),
+    m_fft(nullptr),
+    m_fftSequence(0)
+{
+}
+
+PolyphaseChannelizer::~PolyphaseChannelizer()
+{
+    releaseFFT();
+}
+
+void PolyphaseChannelizer::configure(unsigned int log2NbSubbands, int basebandSampleRate)
+{
+    log2NbSubbands = log2NbSubbands > m_maxLog2Subbands ? m_maxLog2Subbands : log2NbSubbands;
+
+    // spacing fs/M must be exact else sub-band centers drift away from the channel offsets
+    while ((log2NbSubbands >= m_minLog2Subbands) && ((basebandSampleRate % (1 << log2NbSubbands)) != 0)) {
+        log2NbSubbands--;
+    }
+
+    if ((basebandSampleRate <= 0) || (log2NbSubbands < m_minLog2Subbands))
+    {
+        qWarning("PolyphaseChannelizer::configure: baseband rate %d cannot be split in at least %u sub-bands",
+            basebandSampleRate, 1U << m_minLog2Subbands);
+        releaseFFT();
+        m_nbSubbands = 0;
+        m_basebandSampleRate = basebandSampleRate;
+        m_subbandSpacing = 0;
+        m_subbandSampleRate = 0;
+        m_active.clear();
+        m_subbandSamples.clear();
+        return;
+    }
+
+    unsigned int nbSubbands = 1 << log2NbSubbands;
+
+    if ((nbSubbands != m_nbSubbands) || (m_fft == nullptr))
+    {
+        releaseFFT();
+        m_nbSubbands = nbSubbands;
+        m_decimation = nbSubbands / 2;
+        m_historyLength = m_nbSubbands * m_tapsPerBranch;
+        m_history.assign(2*m_historyLength, Complex{0.0f, 0.0f});
+        m_active.assign(m_nbSubbands, false);
+        m_subbandSamples.assign(m_nbSubbands, SampleVector());
+        createPrototype();
+        FFTFactory *fftFactory = DSPEngine::instance()->getFFTFactory();
+        m_fftSequence = fftFactory->getEngine(m_nbSubbands, true, &m_fft);
+    }
+
+    m_basebandSampleRate = basebandSampleRate;
+    m_subbandSpacing = basebandSampleRate / (int) m_nbSubbands;
+    m_subbandSampleRate = 2 * m_subbandSpacing;
+    m_historyIndex = 0;
+    m_inputCount = 0;
+    m_frameCount = 0;
+    std::fill(m_history.begin(), m_history.end(), Complex{0.0f, 0.0f});
+
+    qDebug("PolyphaseChannelizer::configure: M: %u baseband: %d spacing: %d sub-band rate: %d",
+        m_nbSubbands, m_basebandSampleRate, m_subbandSpacing, m_subbandSampleRate);
+}
+
+void PolyphaseChannelizer::releaseFFT()
+{
+    if (m_fft)
+    {
+        FFTFactory *fftFactory = DSPEngine::instance()->getFFTFactory();
+        fftFactory->releaseEngine(m_nbSubbands, true, m_fftSequence);
+        m_fft = nullptr;
+    }
+}
+
+void PolyphaseChannelizer::createPrototype()
+{
+    // Windowed sinc with cutoff at the sub-band spacing (i.e. the Nyquist frequency of the sub-band output)
+    // Blackman-Harris window gives > 90 dB stop band attenuation past (1 + 1 - m_passbandRatio) times the spacing
+    m_prototype.resize(m_historyLength);
+    double fc = 1.0 / m_nbSubbands;
+    double center = (m_historyLength - 1) / 2.0;
+    double sum = 0.0;
+
+    for (unsigned int i = 0; i < m_historyLength; i++)
+    {
+        double t = i - center;
+        double sinc = (t == 0.0) ? 2.0*fc : std::sin(2.0*M_PI*fc*t) / (M_PI*t);
+        double x = (2.0*M_PI*i) / (m_historyLength - 1);
+        double window = 0.35875 - 0.48829*std::cos(x) + 0.14128*std::cos(2.0*x) - 0.01168*std::cos(3.0*x);
+        m_prototype[i] = sinc * window;
+        sum += m_prototype[i];
+    }
+
+    for (unsigned int i = 0; i < m_historyLength; i++) { // unity DC gain
+        m_prototype[i] /= sum;
+    }
+}
+
+void PolyphaseChannelizer::setSubbandActive(unsigned int subbandIndex, bool active)
+{
+    if (subbandIndex < m_nbSubbands) {
+        m_active[subbandIndex] = active;
+    }
+}
+
+void PolyphaseChannelizer::clearActiveSubbands()
+{
+    std::fill(m_active.begin(), m_active.end(), false);
+}
+
+void PolyphaseChannelizer::clearSubbandSamples()
+{
+    for (unsigned int k = 0; k < m_nbSubbands; k++) {
+        m_subbandSamples[k].clear();
+    }
+}
+
+qint64 PolyphaseChannelizer::getSubbandFrequencyOffset(unsigned int subbandIndex) const
+{
+    qint64 k = subbandIndex < m_nbSubbands/2 ? (qint64) subbandIndex : (qint64) subbandIndex - m_nbSubbands;
+    return k * m_subbandSpacing;
+}
+
+unsigned int PolyphaseChannelizer::getNearestSubband(qint64 frequencyOffset) const
+{
+    if (m_subbandSpacing == 0) {
+        return 0;
+    }
+
+    qint64 k = std::llround((double) frequencyOffset / m_subbandSpacing);
+    k = k < -((qint64) m_nbSubbands/2) ? -((qint64) m_nbSubbands/2) : k > ((qint64) m_nbSubbands/2) - 1 ? ((qint64) m_nbSubbands/2) - 1 : k;
+
+    return k < 0 ? k + m_nbSubbands : k;
+}
+
+bool PolyphaseChannelizer::subbandContainsChannel(unsigned int subbandIndex, qint64 frequencyOffset, int bandwidth) const
+{
+    qint64 shift = frequencyOffset - getSubbandFrequencyOffset(subbandIndex);
+    return (std::abs(shift) + bandwidth/2) <= m_passbandRatio * m_subbandSpacing;
+}
+
+void PolyphaseChannelizer::feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end)
+{
+    if (m_fft == nullptr) {
+        return;
+    }
+
+    for (SampleVector::const_iterator it = begin; it != end; ++it)
+    {
+        Complex c(it->m_real, it->m_imag);
+        m_history[m_historyIndex] = c;
+        m_history[m_historyIndex + m_historyLength] = c;
+        m_historyIndex = (m_historyIndex + 1) % m_historyLength;
+
+        if (++m_inputCount == m_decimation)
+        {
+            processFrame();
+            m_inputCount = 0;
+        }
+    }
+}
+
+void PolyphaseChannelizer::processFrame()
+{
+    // history window so that x[n-j] = window[L-1-j] where x[n] is the last input sample
+    const Complex *window = &m_history[m_historyIndex];
+    const float *h = m_prototype.data();
+    Complex *fftIn = m_fft->in();
+    unsigned int last = m_historyLength - 1;
+
+    // polyphase partial sums v[m] = sum_p h[m+pM] x[n-m-pM]
+    for (unsigned int m = 0; m < m_nbSubbands; m++)
+    {
+        float accI = 0.0f, accQ = 0.0f;
+
+        for (unsigned int i = m; i < m_historyLength; i += m_nbSubbands)
+        {
+            const Complex& x = window[last - i];
+            accI += h[i] * x.real();
+            accQ += h[i] * x.imag();
+        }
+
+        fftIn[m] = Complex{accI, accQ};
+    }
+
+    // Y[k] = sum_m v[m] exp(+j2pi km/M) then frequency shift by exp(-j2pi kn/M) which boils down
+    // to a sign flip of odd sub-bands every other frame since n advances by M/2 between frames
+    m_fft->transform();
+    const Complex *fftOut = m_fft->out();
+    bool oddFrame = (m_frameCount & 1) != 0;
+
+    for (unsigned int k = 0; k < m_nbSubbands; k++)
+    {
+        if (!m_active[k]) {
+            continue;
+        }
+
+        float re = fftOut[k].real();
+        float im = fftOut[k].imag();
+
+        if (oddFrame && (k & 1))
+        {
+            re = -re;
+            im = -im;
+        }
+
+        m_subbandSamples[k].push_back(Sample(
+            (FixReal) std::max(-SDR_RX_SCALEF, std::min(SDR_RX_SCALEF - 1.0f, std::round(re))),
+            (FixReal) std::max(-SDR_RX_SCALEF, std::min(SDR_RX_SCALEF - 1.0f, std::round(im)))
+        ));
+    }
+
+    m_frameCount++;
+}
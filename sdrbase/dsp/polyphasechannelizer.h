@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_DSP_POLYPHASECHANNELIZER_H
+#define SDRBASE_DSP_POLYPHASECHANNELIZER_H
+
+#include <vector>
+
+#include "dsp/dsptypes.h"
+#include "export.h"
+
+class FFTEngine;
+
+/**
+ * 2x oversampled polyphase FFT filterbank.
+ *
+ * The baseband is split in M sub-bands spaced by fs/M. Each sub-band is output at 2fs/M
+ * so that a channel of bandwidth up to fs/M can be placed anywhere within +/- fs/(2M) of
+ * the nearest sub-band center without aliasing. One FFT of size M is run every M/2 input
+ * samples whatever the number of sub-bands actually used so the cost does not depend on the
+ * number of channels served. Only the sub-bands flagged active are converted back to samples.
+ *
+ * Sub-band k (0 <= k < M) is centered at k*fs/M for k < M/2 and (k-M)*fs/M above.
+ * M is lowered until it divides fs so that the sub-band centers and rate are exact. When
+ * fs cannot be split in at least 2^m_minLog2Subbands sub-bands the filterbank is disabled
+ * and getNbSubbands() returns 0.
+ */
+class SDRBASE_API PolyphaseChannelizer
+{
+public:
+    PolyphaseChannelizer();
+    ~PolyphaseChannelizer();
+
+    void configure(unsigned int log2NbSubbands, int basebandSampleRate); //!< M = 2^log2NbSubbands at most
+    void feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end);
+
+    void setSubbandActive(unsigned int subbandIndex, bool active);
+    void clearActiveSubbands();
+    const SampleVector& getSubbandSamples(unsigned int subbandIndex) const { return m_subbandSamples[subbandIndex]; }
+    void clearSubbandSamples(); //!< to be called after all sub-band outputs have been consumed
+
+    unsigned int getNbSubbands() const { return m_nbSubbands; }
+    int getSubbandSampleRate() const { return m_subbandSampleRate; }
+    int getSubbandSpacing() const { return m_subbandSpacing; }
+    qint64 getSubbandFrequencyOffset(unsigned int subbandIndex) const;
+    unsigned int getNearestSubband(qint64 frequencyOffset) const;
+    bool subbandContainsChannel(unsigned int subbandIndex, qint64 frequencyOffset, int bandwidth) const;
+
+    static const unsigned int m_tapsPerBranch = 12;
+    static const unsigned int m_minLog2Subbands = 2;
+    static const unsigned int m_maxLog2Subbands = 10;
+    static const float m_passbandRatio; //!< usable fraction of the sub-band spacing on each side of the sub-band center
+
+private:
+    unsigned int m_nbSubbands;      //!< M
+    unsigned int m_decimation;      //!< M/2
+    int m_basebandSampleRate;
+    int m_subbandSampleRate;
+    int m_subbandSpacing;
+    std::vector<float> m_prototype; //!< M * m_tapsPerBranch prototype low pass taps
+    std::vector<Complex> m_history; //!< input history doubled to avoid modulo on the inner loop
+    unsigned int m_historyLength;   //!< M * m_tapsPerBranch
+    unsigned int m_historyIndex;
+    unsigned int m_inputCount;      //!< input samples since last output frame
+    unsigned int m_frameCount;      //!< output frames parity for the oversampling phase correction
+    std::vector<bool> m_active;
+    std::vector<SampleVector> m_subbandSamples;
+    FFTEngine *m_fft;
+    unsigned int m_fftSequence;
+
+    void createPrototype();
+    void releaseFFT();
+    void processFrame();
+};
+
+#endif // SDRBASE_DSP_POLYPHASECHANNELIZER_H
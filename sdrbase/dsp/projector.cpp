@@ -19,6 +19,8 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include "projector.h"
+#include "projectorkernels.h"
+#include "spectrumkernels.h"
 
 Projector::Projector(ProjectionType projectionType) :
     m_projectionType(projectionType),
@@ -73,19 +75,12 @@ Real Projector::run(const Sample& s)
             v = std::atan2((float) s.m_imag, (float) s.m_real) / M_PI; // normalize
             break;
         case ProjectionDOAP:
-        {
-            // calculate phase. Assume phase difference between two sources at half wavelength distance with sources axis as reference (positive side)
-            // cos(theta) = phi / 2*pi*k
-            Real p = std::atan2((float) s.m_imag, (float) s.m_real); // do not mormalize phi (phi in -pi..+pi)
-            v = acos(p/M_PI) / M_PI; // normalize theta
-        }
-            break;
         case ProjectionDOAN:
-        {
-            // calculate phase. Assume phase difference between two sources at half wavelength distance with sources axis as reference (negative source)
-            Real p = std::atan2((float) s.m_imag, (float) s.m_real); // do not mormalize phi (phi in -pi..+pi)
-            v = -acos(p/M_PI) / M_PI; // normalize theta
-        }
+        case ProjectionBPSK:
+        case ProjectionQPSK:
+        case Projection8PSK:
+        case Projection16PSK:
+            v = projectArg(m_projectionType, std::atan2((float) s.m_imag, (float) s.m_real));
             break;
         case ProjectionDPhase:
         {
@@ -102,106 +97,6 @@ Real Projector::run(const Sample& s)
             v = dPhi;
         }
             break;
-        case ProjectionBPSK:
-        {
-            Real arg = std::atan2((float) s.m_imag, (float) s.m_real);
-            v = normalizeAngle(2*arg) / (2.0*M_PI); // generic estimation around 0
-            // mapping on 2 symbols
-            if (arg < -M_PI/2) {
-                v -= 1.0/2;
-            } else if (arg < M_PI/2) {
-                v += 1.0/2;
-            } else if (arg < M_PI) {
-                v -= 1.0/2;
-            }
-        }
-            break;
-        case ProjectionQPSK:
-        {
-            Real arg = std::atan2((float) s.m_imag, (float) s.m_real);
-            v = normalizeAngle(4*arg) / (4.0*M_PI); // generic estimation around 0
-            // mapping on 4 symbols
-            if (arg < -3*M_PI/4) {
-                v -= 3.0/4;
-            } else if (arg < -M_PI/4) {
-                v -= 1.0/4;
-            } else if (arg < M_PI/4) {
-                v += 1.0/4;
-            } else if (arg < 3*M_PI/4) {
-                v += 3.0/4;
-            } else if (arg < M_PI) {
-                v -= 3.0/4;
-            }
-        }
-            break;
-        case Projection8PSK:
-        {
-            Real arg = std::atan2((float) s.m_imag, (float) s.m_real);
-            v = normalizeAngle(8*arg) / (8.0*M_PI); // generic estimation around 0
-            // mapping on 8 symbols
-            if (arg < -7*M_PI/8) {
-               v -= 7.0/8;
-            } else if (arg < -5*M_PI/8) {
-                v -= 5.0/8;
-            } else if (arg < -3*M_PI/8) {
-                v -= 3.0/8;
-            } else if (arg < -M_PI/8) {
-                v -= 1.0/8;
-            } else if (arg < M_PI/8) {
-                v += 1.0/8;
-            } else if (arg < 3*M_PI/8) {
-                v += 3.0/8;
-            } else if (arg < 5*M_PI/8) {
-                v += 5.0/8;
-            } else if (arg < 7*M_PI/8) {
-                v += 7.0/8;
-            } else if (arg < M_PI) {
-                v -= 7.0/8;
-            }
-        }
-            break;
-        case Projection16PSK:
-        {
-            Real arg = std::atan2((float) s.m_imag, (float) s.m_real);
-            v = normalizeAngle(16*arg) / (16.0*M_PI); // generic estimation around 0
-            // mapping on 16 symbols
-            if (arg < -15*M_PI/16) {
-               v -= 15.0/16;
-            } else if (arg < -13*M_PI/16) {
-                v -= 13.0/6;
-            } else if (arg < -11*M_PI/16) {
-                v -= 11.0/16;
-            } else if (arg < -9*M_PI/16) {
-                v -= 9.0/16;
-            } else if (arg < -7*M_PI/16) {
-                v -= 7.0/16;
-            } else if (arg < -5*M_PI/16) {
-                v -= 5.0/16;
-            } else if (arg < -3*M_PI/16) {
-                v -= 3.0/16;
-            } else if (arg < -M_PI/16) {
-                v -= 1.0/16;
-            } else if (arg < M_PI/16) {
-                v += 1.0/16;
-            } else if (arg < 3.0*M_PI/16) {
-                v += 3.0/16;
-            } else if (arg < 5.0*M_PI/16) {
-                v += 5.0/16;
-            } else if (arg < 7.0*M_PI/16) {
-                v += 7.0/16;
-            } else if (arg < 9.0*M_PI/16) {
-                v += 9.0/16;
-            } else if (arg < 11.0*M_PI/16) {
-                v += 11.0/16;
-            } else if (arg < 13.0*M_PI/16) {
-                v += 13.0/16;
-            } else if (arg < 15.0*M_PI/16) {
-                v += 15.0/16;
-            } else if (arg < M_PI) {
-                v -= 15.0/16;
-            }
-        }
-            break;
         case ProjectionReal:
         default:
             v = s.m_real / SDR_RX_SCALEF;
@@ -216,6 +111,190 @@ Real Projector::run(const Sample& s)
     }
 }
 
+Real Projector::projectArg(ProjectionType projectionType, Real arg)
+{
+    Real v;
+
+    switch (projectionType)
+    {
+    case ProjectionDOAP:
+    {
+        // calculate phase. Assume phase difference between two sources at half wavelength distance with sources axis as reference (positive side)
+        // cos(theta) = phi / 2*pi*k
+        Real p = arg; // do not mormalize phi (phi in -pi..+pi)
+        v = acos(p/M_PI) / M_PI; // normalize theta
+    }
+        break;
+    case ProjectionDOAN:
+    {
+        // calculate phase. Assume phase difference between two sources at half wavelength distance with sources axis as reference (negative source)
+        Real p = arg; // do not mormalize phi (phi in -pi..+pi)
+        v = -acos(p/M_PI) / M_PI; // normalize theta
+    }
+        break;
+    case ProjectionBPSK:
+    {
+        v = normalizeAngle(2*arg) / (2.0*M_PI); // generic estimation around 0
+        // mapping on 2 symbols
+        if (arg < -M_PI/2) {
+            v -= 1.0/2;
+        } else if (arg < M_PI/2) {
+            v += 1.0/2;
+        } else if (arg < M_PI) {
+            v -= 1.0/2;
+        }
+    }
+        break;
+    case ProjectionQPSK:
+    {
+        v = normalizeAngle(4*arg) / (4.0*M_PI); // generic estimation around 0
+        // mapping on 4 symbols
+        if (arg < -3*M_PI/4) {
+            v -= 3.0/4;
+        } else if (arg < -M_PI/4) {
+            v -= 1.0/4;
+        } else if (arg < M_PI/4) {
+            v += 1.0/4;
+        } else if (arg < 3*M_PI/4) {
+            v += 3.0/4;
+        } else if (arg < M_PI) {
+            v -= 3.0/4;
+        }
+    }
+        break;
+    case Projection8PSK:
+    {
+        v = normalizeAngle(8*arg) / (8.0*M_PI); // generic estimation around 0
+        // mapping on 8 symbols
+        if (arg < -7*M_PI/8) {
+           v -= 7.0/8;
+        } else if (arg < -5*M_PI/8) {
+            v -= 5.0/8;
+        } else if (arg < -3*M_PI/8) {
+            v -= 3.0/8;
+        } else if (arg < -M_PI/8) {
+            v -= 1.0/8;
+        } else if (arg < M_PI/8) {
+            v += 1.0/8;
+        } else if (arg < 3*M_PI/8) {
+            v += 3.0/8;
+        } else if (arg < 5*M_PI/8) {
+            v += 5.0/8;
+        } else if (arg < 7*M_PI/8) {
+            v += 7.0/8;
+        } else if (arg < M_PI) {
+            v -= 7.0/8;
+        }
+    }
+        break;
+    case Projection16PSK:
+    {
+        v = normalizeAngle(16*arg) / (16.0*M_PI); // generic estimation around 0
+        // mapping on 16 symbols
+        if (arg < -15*M_PI/16) {
+           v -= 15.0/16;
+        } else if (arg < -13*M_PI/16) {
+            v -= 13.0/6;
+        } else if (arg < -11*M_PI/16) {
+            v -= 11.0/16;
+        } else if (arg < -9*M_PI/16) {
+            v -= 9.0/16;
+        } else if (arg < -7*M_PI/16) {
+            v -= 7.0/16;
+        } else if (arg < -5*M_PI/16) {
+            v -= 5.0/16;
+        } else if (arg < -3*M_PI/16) {
+            v -= 3.0/16;
+        } else if (arg < -M_PI/16) {
+            v -= 1.0/16;
+        } else if (arg < M_PI/16) {
+            v += 1.0/16;
+        } else if (arg < 3.0*M_PI/16) {
+            v += 3.0/16;
+        } else if (arg < 5.0*M_PI/16) {
+            v += 5.0/16;
+        } else if (arg < 7.0*M_PI/16) {
+            v += 7.0/16;
+        } else if (arg < 9.0*M_PI/16) {
+            v += 9.0/16;
+        } else if (arg < 11.0*M_PI/16) {
+            v += 11.0/16;
+        } else if (arg < 13.0*M_PI/16) {
+            v += 13.0/16;
+        } else if (arg < 15.0*M_PI/16) {
+            v += 15.0/16;
+        } else if (arg < M_PI) {
+            v -= 15.0/16;
+        }
+    }
+        break;
+    default:
+        v = arg / M_PI;
+        break;
+    }
+
+    return v;
+}
+
+void Projector::run(const Sample *in, unsigned int n, Real *out)
+{
+    const ProjectorKernels& kernels = ProjectorKernels::instance();
+
+    switch (m_projectionType)
+    {
+    case ProjectionImag:
+        kernels.getImagPart()(in, out, n);
+        break;
+    case ProjectionMagLin:
+        kernels.getMagLin()(in, out, n);
+        break;
+    case ProjectionMagSq:
+        kernels.getMagSq()(in, out, n);
+        break;
+    case ProjectionMagDB:
+        kernels.getMagSq()(in, out, n);
+        SpectrumKernels::instance().getLog2Scale()(out, out, n, 3.01029996f, 0.0f); // 10*log10(x) = 10*log10(2) * log2(x)
+        break;
+    case ProjectionPhase:
+        kernels.getArg()(in, out, n, 1.0f / M_PI); // normalize
+        break;
+    case ProjectionDPhase:
+        kernels.getArg()(in, out, n, 1.0f);
+
+        for (unsigned int i = 0; i < n; i++)
+        {
+            Real curArg = out[i];
+            Real dPhi = (curArg - m_prevArg) / M_PI;
+            m_prevArg = curArg;
+
+            if (dPhi < -1.0f) {
+                dPhi += 2.0f;
+            } else if (dPhi > 1.0f) {
+                dPhi -= 2.0f;
+            }
+
+            out[i] = dPhi;
+        }
+        break;
+    case ProjectionDOAP:
+    case ProjectionDOAN:
+    case ProjectionBPSK:
+    case ProjectionQPSK:
+    case Projection8PSK:
+    case Projection16PSK:
+        kernels.getArg()(in, out, n, 1.0f);
+
+        for (unsigned int i = 0; i < n; i++) {
+            out[i] = projectArg(m_projectionType, out[i]);
+        }
+        break;
+    case ProjectionReal:
+    default:
+        kernels.getRealPart()(in, out, n);
+        break;
+    }
+}
+
 Real Projector::normalizeAngle(Real angle)
 {
     while (angle <= -M_PI) {
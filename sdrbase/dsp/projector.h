@@ -49,9 +49,16 @@ public:
     void setCacheMaster(bool cacheMaster) { m_cacheMaster = cacheMaster; }
 
     Real run(const Sample& s);
+    /**
+     * Projects n samples at once. This uses the run time selected SIMD kernels and fast atan2 and log
+     * approximations (errors below 1e-5 radian and 1e-4 dB). A null sample gives about -382 dB instead of
+     * -infinity. The cache is not used.
+     */
+    void run(const Sample *in, unsigned int n, Real *out);
 
 private:
     static Real normalizeAngle(Real angle);
+    static Real projectArg(ProjectionType projectionType, Real arg); //!< projections derived from the phase (except derivative)
     ProjectionType m_projectionType;
     Real m_prevArg;
     Real *m_cache;
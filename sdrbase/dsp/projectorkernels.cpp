@@ -0,0 +1,526 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+
+#include <QDebug>
+
+#include "projectorkernels.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define PROJECTOR_X86
+#define PROJECTOR_TARGET(arch) __attribute__((target(arch)))
+#elif defined(_MSC_VER) && (defined(_M_AMD64) || defined(_M_IX86))
+#include <immintrin.h>
+#define PROJECTOR_X86
+#define PROJECTOR_TARGET(arch)
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__aarch64__)
+#include <arm_neon.h>
+#define PROJECTOR_NEON // vector division is only available on AArch64
+#endif
+
+static const float projScale = 1.0f / SDR_RX_SCALEF; // power of two so multiplying is the same as dividing
+static const float atanPi = 3.14159265f;
+static const float atanHalfPi = 1.57079633f;
+static const float atanTiny = 1e-30f; // avoids 0/0 for a null sample
+// atan(a) = a . (c1 + c3.a^2 + ... + c11.a^10) for a in [0, 1]
+static const float atanC1 = 0.99997726f;
+static const float atanC3 = -0.33262347f;
+static const float atanC5 = 0.19354346f;
+static const float atanC7 = -0.11643287f;
+static const float atanC9 = 0.05265332f;
+static const float atanC11 = -0.01172120f;
+
+static void realPartGeneric(const Sample *in, Real *out, unsigned int n)
+{
+    for (unsigned int i = 0; i < n; i++) {
+        out[i] = in[i].m_real * projScale;
+    }
+}
+
+static void imagPartGeneric(const Sample *in, Real *out, unsigned int n)
+{
+    for (unsigned int i = 0; i < n; i++) {
+        out[i] = in[i].m_imag * projScale;
+    }
+}
+
+static void magSqGeneric(const Sample *in, Real *out, unsigned int n)
+{
+    for (unsigned int i = 0; i < n; i++)
+    {
+        float re = in[i].m_real * projScale;
+        float im = in[i].m_imag * projScale;
+        out[i] = re * re + im * im;
+    }
+}
+
+static void magLinGeneric(const Sample *in, Real *out, unsigned int n)
+{
+    for (unsigned int i = 0; i < n; i++)
+    {
+        float re = in[i].m_real * projScale;
+        float im = in[i].m_imag * projScale;
+        out[i] = std::sqrt(re * re + im * im);
+    }
+}
+
+static void argGeneric(const Sample *in, Real *out, unsigned int n, Real mult)
+{
+    for (unsigned int i = 0; i < n; i++)
+    {
+        float x = in[i].m_real;
+        float y = in[i].m_imag;
+        float ax = std::fabs(x);
+        float ay = std::fabs(y);
+        float a = std::min(ax, ay) / std::max(std::max(ax, ay), atanTiny);
+        float s = a * a;
+        float p = ((((atanC11 * s + atanC9) * s + atanC7) * s + atanC5) * s + atanC3) * s + atanC1;
+        float r = p * a;
+        r = ay > ax ? atanHalfPi - r : r;
+        r = x < 0.0f ? atanPi - r : r;
+        r = y < 0.0f ? -r : r;
+        out[i] = r * mult;
+    }
+}
+
+#if defined(PROJECTOR_X86)
+// 4 samples as float vectors of their real and imaginary parts (not normalized)
+PROJECTOR_TARGET("sse2")
+static inline void loadSSE2(const Sample *in, __m128& re, __m128& im)
+{
+#ifdef SDR_RX_SAMPLE_24BIT
+    __m128 a = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *) &in[0])); // r0 i0 r1 i1
+    __m128 b = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *) &in[2])); // r2 i2 r3 i3
+    re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+#else
+    __m128i s = _mm_loadu_si128((const __m128i *) in); // one sample in each 32 bit lane
+    re = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(s, 16), 16));
+    im = _mm_cvtepi32_ps(_mm_srai_epi32(s, 16));
+#endif
+}
+
+PROJECTOR_TARGET("sse2")
+static void realPartSSE2(const Sample *in, Real *out, unsigned int n)
+{
+    const __m128 scale = _mm_set1_ps(projScale);
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 re, im;
+        loadSSE2(&in[i], re, im);
+        _mm_storeu_ps(&out[i], _mm_mul_ps(re, scale));
+    }
+
+    realPartGeneric(in + i, out + i, n - i);
+}
+
+PROJECTOR_TARGET("sse2")
+static void imagPartSSE2(const Sample *in, Real *out, unsigned int n)
+{
+    const __m128 scale = _mm_set1_ps(projScale);
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 re, im;
+        loadSSE2(&in[i], re, im);
+        _mm_storeu_ps(&out[i], _mm_mul_ps(im, scale));
+    }
+
+    imagPartGeneric(in + i, out + i, n - i);
+}
+
+PROJECTOR_TARGET("sse2")
+static void magSqSSE2(const Sample *in, Real *out, unsigned int n)
+{
+    const __m128 scale = _mm_set1_ps(projScale);
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 re, im;
+        loadSSE2(&in[i], re, im);
+        re = _mm_mul_ps(re, scale);
+        im = _mm_mul_ps(im, scale);
+        _mm_storeu_ps(&out[i], _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im)));
+    }
+
+    magSqGeneric(in + i, out + i, n - i);
+}
+
+PROJECTOR_TARGET("sse2")
+static void magLinSSE2(const Sample *in, Real *out, unsigned int n)
+{
+    const __m128 scale = _mm_set1_ps(projScale);
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 re, im;
+        loadSSE2(&in[i], re, im);
+        re = _mm_mul_ps(re, scale);
+        im = _mm_mul_ps(im, scale);
+        _mm_storeu_ps(&out[i], _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im))));
+    }
+
+    magLinGeneric(in + i, out + i, n - i);
+}
+
+PROJECTOR_TARGET("sse2")
+static void argSSE2(const Sample *in, Real *out, unsigned int n, Real mult)
+{
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 pi = _mm_set1_ps(atanPi);
+    const __m128 halfPi = _mm_set1_ps(atanHalfPi);
+    const __m128 tiny = _mm_set1_ps(atanTiny);
+    const __m128 c1 = _mm_set1_ps(atanC1);
+    const __m128 c3 = _mm_set1_ps(atanC3);
+    const __m128 c5 = _mm_set1_ps(atanC5);
+    const __m128 c7 = _mm_set1_ps(atanC7);
+    const __m128 c9 = _mm_set1_ps(atanC9);
+    const __m128 c11 = _mm_set1_ps(atanC11);
+    const __m128 multv = _mm_set1_ps(mult);
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 x, y;
+        loadSSE2(&in[i], x, y);
+        __m128 ax = _mm_and_ps(x, absMask);
+        __m128 ay = _mm_and_ps(y, absMask);
+        __m128 a = _mm_div_ps(_mm_min_ps(ax, ay), _mm_max_ps(_mm_max_ps(ax, ay), tiny));
+        __m128 s = _mm_mul_ps(a, a);
+        __m128 p = _mm_add_ps(_mm_mul_ps(c11, s), c9);
+        p = _mm_add_ps(_mm_mul_ps(p, s), c7);
+        p = _mm_add_ps(_mm_mul_ps(p, s), c5);
+        p = _mm_add_ps(_mm_mul_ps(p, s), c3);
+        p = _mm_add_ps(_mm_mul_ps(p, s), c1);
+        __m128 r = _mm_mul_ps(p, a);
+        __m128 mask = _mm_cmpgt_ps(ay, ax);
+        r = _mm_or_ps(_mm_and_ps(mask, _mm_sub_ps(halfPi, r)), _mm_andnot_ps(mask, r));
+        mask = _mm_cmplt_ps(x, zero);
+        r = _mm_or_ps(_mm_and_ps(mask, _mm_sub_ps(pi, r)), _mm_andnot_ps(mask, r));
+        r = _mm_xor_ps(r, _mm_and_ps(_mm_cmplt_ps(y, zero), signMask));
+        _mm_storeu_ps(&out[i], _mm_mul_ps(r, multv));
+    }
+
+    argGeneric(in + i, out + i, n - i, mult);
+}
+
+// 8 samples as float vectors of their real and imaginary parts (not normalized)
+PROJECTOR_TARGET("avx2")
+static inline void loadAVX2(const Sample *in, __m256& re, __m256& im)
+{
+#ifdef SDR_RX_SAMPLE_24BIT
+    __m256 a = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i *) &in[0])); // r0 i0 r1 i1 | r2 i2 r3 i3
+    __m256 b = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i *) &in[4])); // r4 i4 r5 i5 | r6 i6 r7 i7
+    // shuffles within 128 bit lanes give 0 1 4 5 | 2 3 6 7
+    re = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    im = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    re = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(re), _MM_SHUFFLE(3, 1, 2, 0)));
+    im = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(im), _MM_SHUFFLE(3, 1, 2, 0)));
+#else
+    __m256i s = _mm256_loadu_si256((const __m256i *) in); // one sample in each 32 bit lane
+    re = _mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(s, 16), 16));
+    im = _mm256_cvtepi32_ps(_mm256_srai_epi32(s, 16));
+#endif
+}
+
+PROJECTOR_TARGET("avx2")
+static void realPartAVX2(const Sample *in, Real *out, unsigned int n)
+{
+    const __m256 scale = _mm256_set1_ps(projScale);
+    unsigned int i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 re, im;
+        loadAVX2(&in[i], re, im);
+        _mm256_storeu_ps(&out[i], _mm256_mul_ps(re, scale));
+    }
+
+    realPartSSE2(in + i, out + i, n - i);
+}
+
+PROJECTOR_TARGET("avx2")
+static void imagPartAVX2(const Sample *in, Real *out, unsigned int n)
+{
+    const __m256 scale = _mm256_set1_ps(projScale);
+    unsigned int i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 re, im;
+        loadAVX2(&in[i], re, im);
+        _mm256_storeu_ps(&out[i], _mm256_mul_ps(im, scale));
+    }
+
+    imagPartSSE2(in + i, out + i, n - i);
+}
+
+PROJECTOR_TARGET("avx2")
+static void magSqAVX2(const Sample *in, Real *out, unsigned int n)
+{
+    const __m256 scale = _mm256_set1_ps(projScale);
+    unsigned int i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 re, im;
+        loadAVX2(&in[i], re, im);
+        re = _mm256_mul_ps(re, scale);
+        im = _mm256_mul_ps(im, scale);
+        _mm256_storeu_ps(&out[i], _mm256_add_ps(_mm256_mul_ps(re, re), _mm256_mul_ps(im, im)));
+    }
+
+    magSqSSE2(in + i, out + i, n - i);
+}
+
+PROJECTOR_TARGET("avx2")
+static void magLinAVX2(const Sample *in, Real *out, unsigned int n)
+{
+    const __m256 scale = _mm256_set1_ps(projScale);
+    unsigned int i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 re, im;
+        loadAVX2(&in[i], re, im);
+        re = _mm256_mul_ps(re, scale);
+        im = _mm256_mul_ps(im, scale);
+        _mm256_storeu_ps(&out[i], _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(re, re), _mm256_mul_ps(im, im))));
+    }
+
+    magLinSSE2(in + i, out + i, n - i);
+}
+
+PROJECTOR_TARGET("avx2")
+static void argAVX2(const Sample *in, Real *out, unsigned int n, Real mult)
+{
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 pi = _mm256_set1_ps(atanPi);
+    const __m256 halfPi = _mm256_set1_ps(atanHalfPi);
+    const __m256 tiny = _mm256_set1_ps(atanTiny);
+    const __m256 c1 = _mm256_set1_ps(atanC1);
+    const __m256 c3 = _mm256_set1_ps(atanC3);
+    const __m256 c5 = _mm256_set1_ps(atanC5);
+    const __m256 c7 = _mm256_set1_ps(atanC7);
+    const __m256 c9 = _mm256_set1_ps(atanC9);
+    const __m256 c11 = _mm256_set1_ps(atanC11);
+    const __m256 multv = _mm256_set1_ps(mult);
+    unsigned int i = 0;
+
+    // no FMA so that the results are the same as with the other kernels
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 x, y;
+        loadAVX2(&in[i], x, y);
+        __m256 ax = _mm256_and_ps(x, absMask);
+        __m256 ay = _mm256_and_ps(y, absMask);
+        __m256 a = _mm256_div_ps(_mm256_min_ps(ax, ay), _mm256_max_ps(_mm256_max_ps(ax, ay), tiny));
+        __m256 s = _mm256_mul_ps(a, a);
+        __m256 p = _mm256_add_ps(_mm256_mul_ps(c11, s), c9);
+        p = _mm256_add_ps(_mm256_mul_ps(p, s), c7);
+        p = _mm256_add_ps(_mm256_mul_ps(p, s), c5);
+        p = _mm256_add_ps(_mm256_mul_ps(p, s), c3);
+        p = _mm256_add_ps(_mm256_mul_ps(p, s), c1);
+        __m256 r = _mm256_mul_ps(p, a);
+        r = _mm256_blendv_ps(r, _mm256_sub_ps(halfPi, r), _mm256_cmp_ps(ay, ax, _CMP_GT_OQ));
+        r = _mm256_blendv_ps(r, _mm256_sub_ps(pi, r), _mm256_cmp_ps(x, zero, _CMP_LT_OQ));
+        r = _mm256_xor_ps(r, _mm256_and_ps(_mm256_cmp_ps(y, zero, _CMP_LT_OQ), signMask));
+        _mm256_storeu_ps(&out[i], _mm256_mul_ps(r, multv));
+    }
+
+    argSSE2(in + i, out + i, n - i, mult);
+}
+#endif // PROJECTOR_X86
+
+#if defined(PROJECTOR_NEON)
+// 4 samples as float vectors of their real and imaginary parts (not normalized)
+static inline void loadNEON(const Sample *in, float32x4_t& re, float32x4_t& im)
+{
+#ifdef SDR_RX_SAMPLE_24BIT
+    int32x4x2_t s = vld2q_s32((const int32_t *) in);
+    re = vcvtq_f32_s32(s.val[0]);
+    im = vcvtq_f32_s32(s.val[1]);
+#else
+    int16x4x2_t s = vld2_s16((const int16_t *) in);
+    re = vcvtq_f32_s32(vmovl_s16(s.val[0]));
+    im = vcvtq_f32_s32(vmovl_s16(s.val[1]));
+#endif
+}
+
+static void realPartNEON(const Sample *in, Real *out, unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        float32x4_t re, im;
+        loadNEON(&in[i], re, im);
+        vst1q_f32(&out[i], vmulq_n_f32(re, projScale));
+    }
+
+    realPartGeneric(in + i, out + i, n - i);
+}
+
+static void imagPartNEON(const Sample *in, Real *out, unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        float32x4_t re, im;
+        loadNEON(&in[i], re, im);
+        vst1q_f32(&out[i], vmulq_n_f32(im, projScale));
+    }
+
+    imagPartGeneric(in + i, out + i, n - i);
+}
+
+static void magSqNEON(const Sample *in, Real *out, unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        float32x4_t re, im;
+        loadNEON(&in[i], re, im);
+        re = vmulq_n_f32(re, projScale);
+        im = vmulq_n_f32(im, projScale);
+        vst1q_f32(&out[i], vaddq_f32(vmulq_f32(re, re), vmulq_f32(im, im)));
+    }
+
+    magSqGeneric(in + i, out + i, n - i);
+}
+
+static void magLinNEON(const Sample *in, Real *out, unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        float32x4_t re, im;
+        loadNEON(&in[i], re, im);
+        re = vmulq_n_f32(re, projScale);
+        im = vmulq_n_f32(im, projScale);
+        vst1q_f32(&out[i], vsqrtq_f32(vaddq_f32(vmulq_f32(re, re), vmulq_f32(im, im))));
+    }
+
+    magLinGeneric(in + i, out + i, n - i);
+}
+
+static void argNEON(const Sample *in, Real *out, unsigned int n, Real mult)
+{
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t pi = vdupq_n_f32(atanPi);
+    const float32x4_t halfPi = vdupq_n_f32(atanHalfPi);
+    const float32x4_t tiny = vdupq_n_f32(atanTiny);
+    const float32x4_t c1 = vdupq_n_f32(atanC1);
+    const float32x4_t c3 = vdupq_n_f32(atanC3);
+    const float32x4_t c5 = vdupq_n_f32(atanC5);
+    const float32x4_t c7 = vdupq_n_f32(atanC7);
+    const float32x4_t c9 = vdupq_n_f32(atanC9);
+    const float32x4_t c11 = vdupq_n_f32(atanC11);
+    unsigned int i = 0;
+
+    // separate multiplies and adds (no vfmaq) so that the results are the same as with the other kernels
+    for (; i + 4 <= n; i += 4)
+    {
+        float32x4_t x, y;
+        loadNEON(&in[i], x, y);
+        float32x4_t ax = vabsq_f32(x);
+        float32x4_t ay = vabsq_f32(y);
+        float32x4_t a = vdivq_f32(vminq_f32(ax, ay), vmaxq_f32(vmaxq_f32(ax, ay), tiny));
+        float32x4_t s = vmulq_f32(a, a);
+        float32x4_t p = vaddq_f32(vmulq_f32(c11, s), c9);
+        p = vaddq_f32(vmulq_f32(p, s), c7);
+        p = vaddq_f32(vmulq_f32(p, s), c5);
+        p = vaddq_f32(vmulq_f32(p, s), c3);
+        p = vaddq_f32(vmulq_f32(p, s), c1);
+        float32x4_t r = vmulq_f32(p, a);
+        r = vbslq_f32(vcgtq_f32(ay, ax), vsubq_f32(halfPi, r), r);
+        r = vbslq_f32(vcltq_f32(x, zero), vsubq_f32(pi, r), r);
+        r = vbslq_f32(vcltq_f32(y, zero), vnegq_f32(r), r);
+        vst1q_f32(&out[i], vmulq_n_f32(r, mult));
+    }
+
+    argGeneric(in + i, out + i, n - i, mult);
+}
+#endif // PROJECTOR_NEON
+
+const ProjectorKernels& ProjectorKernels::instance()
+{
+    static ProjectorKernels kernels(CPUFeatures::instance().getBestLevel());
+    return kernels;
+}
+
+ProjectorKernels::ProjectorKernels(CPUFeatures::SIMDLevel level) :
+    m_realPart(realPartGeneric),
+    m_imagPart(imagPartGeneric),
+    m_magSq(magSqGeneric),
+    m_magLin(magLinGeneric),
+    m_arg(argGeneric),
+    m_level(CPUFeatures::SIMDGeneric)
+{
+    const CPUFeatures& cpu = CPUFeatures::instance();
+    (void) cpu;
+
+#if defined(PROJECTOR_X86)
+    if (((level == CPUFeatures::SIMDAVX2) || (level == CPUFeatures::SIMDAVX512)) && cpu.hasAVX2())
+    {
+        m_realPart = realPartAVX2;
+        m_imagPart = imagPartAVX2;
+        m_magSq = magSqAVX2;
+        m_magLin = magLinAVX2;
+        m_arg = argAVX2;
+        m_level = CPUFeatures::SIMDAVX2;
+    }
+    else if ((level >= CPUFeatures::SIMDSSE2) && (level != CPUFeatures::SIMDNEON) && cpu.hasSSE2())
+    {
+        m_realPart = realPartSSE2;
+        m_imagPart = imagPartSSE2;
+        m_magSq = magSqSSE2;
+        m_magLin = magLinSSE2;
+        m_arg = argSSE2;
+        m_level = CPUFeatures::SIMDSSE2;
+    }
+#elif defined(PROJECTOR_NEON)
+    if ((level == CPUFeatures::SIMDNEON) && cpu.hasNEON())
+    {
+        m_realPart = realPartNEON;
+        m_imagPart = imagPartNEON;
+        m_magSq = magSqNEON;
+        m_magLin = magLinNEON;
+        m_arg = argNEON;
+        m_level = CPUFeatures::SIMDNEON;
+    }
+#else
+    (void) level;
+#endif
+
+    qInfo("ProjectorKernels::ProjectorKernels: using %s projector kernels", CPUFeatures::getLevelName(m_level));
+}
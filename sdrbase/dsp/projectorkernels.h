@@ -0,0 +1,65 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_DSP_PROJECTORKERNELS_H_
+#define SDRBASE_DSP_PROJECTORKERNELS_H_
+
+#include "dsp/dsptypes.h"
+#include "util/cpufeatures.h"
+#include "export.h"
+
+/**
+ * Kernels projecting blocks of samples for the scope selected at run time for the host CPU.
+ * Samples are normalized by SDR_RX_SCALEF.
+ *
+ * realPart and imagPart extract a component: out[i] = re(in[i]) or im(in[i])
+ * magSq computes the power: out[i] = re(in[i])^2 + im(in[i])^2
+ * magLin computes the modulus: out[i] = sqrt(re(in[i])^2 + im(in[i])^2)
+ * arg computes the phase: out[i] = mult * atan2(im(in[i]), re(in[i]))
+ *
+ * atan2 is reduced to atan on [0, 1] by octant symmetries and approximated there by an odd
+ * polynomial of degree 11. The error is below 1e-5 radian. Like std::atan2 the result is
+ * in [-pi, pi] with pi for a negative real axis and 0 for a null sample.
+ * The SIMD kernels use the same operations in the same order as the generic one.
+ */
+class SDRBASE_API ProjectorKernels
+{
+public:
+    typedef void (*Component)(const Sample *in, Real *out, unsigned int n);
+    typedef void (*Arg)(const Sample *in, Real *out, unsigned int n, Real mult);
+
+    ProjectorKernels(CPUFeatures::SIMDLevel level); //!< specific kernels (benchmarks). Falls back to generic if not available.
+
+    static const ProjectorKernels& instance(); //!< best kernels for the host CPU
+
+    Component getRealPart() const { return m_realPart; }
+    Component getImagPart() const { return m_imagPart; }
+    Component getMagSq() const { return m_magSq; }
+    Component getMagLin() const { return m_magLin; }
+    Arg getArg() const { return m_arg; }
+    CPUFeatures::SIMDLevel getLevel() const { return m_level; }
+
+private:
+    Component m_realPart;
+    Component m_imagPart;
+    Component m_magSq;
+    Component m_magLin;
+    Arg m_arg;
+    CPUFeatures::SIMDLevel m_level;
+};
+
+#endif // SDRBASE_DSP_PROJECTORKERNELS_H_
@@ -0,0 +1,127 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <QMutexLocker>
+
+#include "sampleblock.h"
+
+SampleBlockRef::SampleBlockRef(SampleBlock *block) :
+    m_block(block)
+{
+    if (m_block) {
+        m_block->m_refCount.ref();
+    }
+}
+
+SampleBlockRef::SampleBlockRef(const SampleBlockRef& other) :
+    m_block(other.m_block)
+{
+    if (m_block) {
+        m_block->m_refCount.ref();
+    }
+}
+
+SampleBlockRef& SampleBlockRef::operator=(const SampleBlockRef& other)
+{
+    if (other.m_block != m_block)
+    {
+        if (other.m_block) {
+            other.m_block->m_refCount.ref();
+        }
+
+        reset();
+        m_block = other.m_block;
+    }
+
+    return *this;
+}
+
+void SampleBlockRef::reset()
+{
+    if (m_block)
+    {
+        if (!m_block->m_refCount.deref()) {
+            m_block->m_pool->recycle(m_block);
+        }
+
+        m_block = nullptr;
+    }
+}
+
+SampleBlockPool::SampleBlockPool(unsigned int maxFreeBlocks) :
+    m_maxFreeBlocks(maxFreeBlocks),
+    m_refCount(1)
+{}
+
+SampleBlockPool::~SampleBlockPool()
+{
+    for (std::vector<SampleBlock*>::iterator it = m_freeBlocks.begin(); it != m_freeBlocks.end(); ++it) {
+        delete *it;
+    }
+}
+
+void SampleBlockPool::destroy()
+{
+    unref();
+}
+
+void SampleBlockPool::unref()
+{
+    if (!m_refCount.deref()) {
+        delete this;
+    }
+}
+
+SampleBlockRef SampleBlockPool::acquire(SampleVector::const_iterator begin, SampleVector::const_iterator end)
+{
+    SampleBlock *block = nullptr;
+
+    {
+        QMutexLocker mutexLocker(&m_mutex);
+
+        if (m_freeBlocks.size() != 0)
+        {
+            block = m_freeBlocks.back();
+            m_freeBlocks.pop_back();
+        }
+    }
+
+    if (!block) {
+        block = new SampleBlock(this);
+    }
+
+    block->m_samples.assign(begin, end); // keeps capacity of recycled blocks
+    m_refCount.ref();
+
+    return SampleBlockRef(block);
+}
+
+void SampleBlockPool::recycle(SampleBlock *block)
+{
+    {
+        QMutexLocker mutexLocker(&m_mutex);
+
+        if (m_freeBlocks.size() < m_maxFreeBlocks)
+        {
+            m_freeBlocks.push_back(block);
+            block = nullptr;
+        }
+    }
+
+    delete block;
+    unref();
+}
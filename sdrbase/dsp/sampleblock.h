@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_DSP_SAMPLEBLOCK_H_
+#define SDRBASE_DSP_SAMPLEBLOCK_H_
+
+#include <vector>
+
+#include <QAtomicInt>
+#include <QMutex>
+
+#include "dsp/dsptypes.h"
+#include "export.h"
+
+class SampleBlockPool;
+
+/**
+ * Immutable block of samples shared by several consumers.
+ * It is filled once by the pool when acquired then only read through SampleBlockRef handles.
+ */
+class SDRBASE_API SampleBlock
+{
+public:
+    const SampleVector& samples() const { return m_samples; }
+
+private:
+    friend class SampleBlockPool;
+    friend class SampleBlockRef;
+
+    SampleBlock(SampleBlockPool *pool) : m_refCount(0), m_pool(pool) {}
+
+    SampleVector m_samples;
+    QAtomicInt m_refCount;
+    SampleBlockPool *m_pool;
+};
+
+/**
+ * Reference counted handle on a SampleBlock. The block returns to its pool when the last handle is released.
+ */
+class SDRBASE_API SampleBlockRef
+{
+public:
+    SampleBlockRef() : m_block(nullptr) {}
+    SampleBlockRef(const SampleBlockRef& other);
+    SampleBlockRef& operator=(const SampleBlockRef& other);
+    ~SampleBlockRef() { reset(); }
+
+    void reset();
+    bool isNull() const { return m_block == nullptr; }
+    SampleVector::const_iterator begin() const { return m_block->m_samples.begin(); }
+    SampleVector::const_iterator end() const { return m_block->m_samples.end(); }
+    unsigned int size() const { return m_block ? m_block->m_samples.size() : 0; }
+
+private:
+    friend class SampleBlockPool;
+    explicit SampleBlockRef(SampleBlock *block); //!< takes a new reference
+
+    SampleBlock *m_block;
+};
+
+/**
+ * Pool of sample blocks recycled when their last reference is released.
+ * The owner calls destroy() instead of delete: the pool is actually deleted when all its blocks are back.
+ */
+class SDRBASE_API SampleBlockPool
+{
+public:
+    SampleBlockPool(unsigned int maxFreeBlocks = 64);
+
+    SampleBlockRef acquire(SampleVector::const_iterator begin, SampleVector::const_iterator end); //!< the only copy of the samples
+    void destroy();
+    int getNbOutstandingBlocks() const { return m_refCount.load() - 1; }
+
+private:
+    friend class SampleBlockRef;
+    ~SampleBlockPool();
+
+    void recycle(SampleBlock *block);
+    void unref();
+
+    unsigned int m_maxFreeBlocks;
+    std::vector<SampleBlock*> m_freeBlocks;
+    QMutex m_mutex;
+    QAtomicInt m_refCount; //!< owner plus outstanding blocks
+};
+
+#endif // SDRBASE_DSP_SAMPLEBLOCK_H_
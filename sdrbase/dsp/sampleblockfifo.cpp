@@ -0,0 +1,83 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include "sampleblockfifo.h"
+
+SampleBlockFifo::SampleBlockFifo(unsigned int nbBlocks, QObject* parent) :
+    QObject(parent),
+    m_blocks(nbBlocks),
+    m_dataReadyPending(false),
+    m_dropped(0)
+{}
+
+SampleBlockFifo::~SampleBlockFifo()
+{}
+
+bool SampleBlockFifo::write(const SampleBlockRef& block)
+{
+    quint64 tail = m_tail.m_value.load(std::memory_order_relaxed);
+
+    if (tail - m_head.m_value.load(std::memory_order_acquire) >= m_blocks.size())
+    {
+        if ((m_dropped++ % 1000) == 0) {
+            qCritical("SampleBlockFifo::write: overflow - %u blocks dropped", m_dropped);
+        }
+
+        return false;
+    }
+
+    m_blocks[tail % m_blocks.size()] = block;
+    m_tail.m_value.store(tail + 1, std::memory_order_release);
+
+    if (!m_dataReadyPending.exchange(true)) {
+        emit dataReady();
+    }
+
+    return true;
+}
+
+bool SampleBlockFifo::read(SampleBlockRef& block)
+{
+    m_dataReadyPending.store(false);
+    quint64 head = m_head.m_value.load(std::memory_order_relaxed);
+
+    if (head == m_tail.m_value.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    SampleBlockRef& slot = m_blocks[head % m_blocks.size()];
+    block = slot;
+    slot.reset(); // the slot must not keep the block alive
+    m_head.m_value.store(head + 1, std::memory_order_release);
+
+    return true;
+}
+
+unsigned int SampleBlockFifo::fill()
+{
+    m_dataReadyPending.store(false);
+    return m_tail.m_value.load(std::memory_order_acquire) - m_head.m_value.load(std::memory_order_relaxed);
+}
+
+void SampleBlockFifo::reset()
+{
+    SampleBlockRef block;
+
+    while (read(block)) {
+        block.reset();
+    }
+}
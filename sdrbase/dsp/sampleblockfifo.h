@@ -0,0 +1,62 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_DSP_SAMPLEBLOCKFIFO_H_
+#define SDRBASE_DSP_SAMPLEBLOCKFIFO_H_
+
+#include <atomic>
+#include <vector>
+
+#include <QObject>
+
+#include "dsp/sampleblock.h"
+#include "export.h"
+
+/**
+ * Wait-free single producer / single consumer FIFO of sample block references.
+ * Used by sinks to hand shared blocks over to their processing thread without copying the samples.
+ * Like SampleSinkFifo dataReady is emitted once until the consumer polls again.
+ */
+class SDRBASE_API SampleBlockFifo : public QObject
+{
+    Q_OBJECT
+public:
+    SampleBlockFifo(unsigned int nbBlocks = 64, QObject* parent = nullptr);
+    ~SampleBlockFifo();
+
+    bool write(const SampleBlockRef& block); //!< false and block dropped if full
+    bool read(SampleBlockRef& block);        //!< false if empty
+    unsigned int fill();
+    void reset(); //!< consumer side only
+
+signals:
+    void dataReady();
+
+private:
+    struct alignas(64) Counter {
+        std::atomic<quint64> m_value;
+        Counter() : m_value(0) {}
+    };
+
+    std::vector<SampleBlockRef> m_blocks;
+    Counter m_head;
+    Counter m_tail;
+    std::atomic<bool> m_dataReadyPending;
+    unsigned int m_dropped;
+};
+
+#endif // SDRBASE_DSP_SAMPLEBLOCKFIFO_H_
@@ -18,14 +18,11 @@
 
 #include "samplesinkfifo.h"
 
-//#define MIN(x, y) (((x) < (y)) ? (x) : (y))
-
 void SampleSinkFifo::create(unsigned int s)
 {
 	m_size = 0;
-	m_fill = 0;
-	m_head = 0;
-	m_tail = 0;
+	m_head.m_value.store(0);
+	m_tail.m_value.store(0);
 
 	m_data.resize(s);
 	m_size = m_data.size();
@@ -34,9 +31,9 @@ void SampleSinkFifo::create(unsigned int s)
 void SampleSinkFifo::reset()
 {
 	m_suppressed = -1;
-	m_fill = 0;
-	m_head = 0;
-	m_tail = 0;
+	m_head.m_value.store(0);
+	m_tail.m_value.store(0);
+	m_dataReadyPending.m_value.store(false);
 }
 
 SampleSinkFifo::SampleSinkFifo(QObject* parent) :
@@ -45,9 +42,6 @@ SampleSinkFifo::SampleSinkFifo(QObject* parent) :
 {
 	m_suppressed = -1;
 	m_size = 0;
-	m_fill = 0;
-	m_head = 0;
-	m_tail = 0;
 }
 
 SampleSinkFifo::SampleSinkFifo(int size, QObject* parent) :
@@ -64,14 +58,10 @@ SampleSinkFifo::SampleSinkFifo(const SampleSinkFifo& other) :
 {
   	m_suppressed = -1;
 	m_size = m_data.size();
-	m_fill = 0;
-	m_head = 0;
-	m_tail = 0;
 }
 
 SampleSinkFifo::~SampleSinkFifo()
 {
-	QMutexLocker mutexLocker(&m_mutex);
 	m_size = 0;
 }
 
@@ -82,140 +72,111 @@ bool SampleSinkFifo::setSize(int size)
 	return m_data.size() == (unsigned int)size;
 }
 
-unsigned int SampleSinkFifo::write(const quint8* data, unsigned int count)
+void SampleSinkFifo::reportOverflow(unsigned int count, unsigned int total)
 {
-	QMutexLocker mutexLocker(&m_mutex);
-	unsigned int total;
-	unsigned int remaining;
-	unsigned int len;
-	const Sample* begin = (const Sample*)data;
-	count /= sizeof(Sample);
-
-	total = std::min(count, m_size - m_fill);
-
-    if (total < count)
-    {
-		if (m_suppressed < 0)
-        {
-			m_suppressed = 0;
-			m_msgRateTimer.start();
+	if (m_suppressed < 0)
+	{
+		m_suppressed = 0;
+		m_msgRateTimer.start();
+		qCritical("SampleSinkFifo::write: overflow - dropping %u samples", count - total);
+	}
+	else
+	{
+		if (m_msgRateTimer.elapsed() > 2500)
+		{
+			qCritical("SampleSinkFifo::write: %u messages dropped", m_suppressed);
 			qCritical("SampleSinkFifo::write: overflow - dropping %u samples", count - total);
+			m_suppressed = -1;
 		}
-        else
-        {
-			if (m_msgRateTimer.elapsed() > 2500)
-            {
-				qCritical("SampleSinkFifo::write: %u messages dropped", m_suppressed);
-				qCritical("SampleSinkFifo::write: overflow - dropping %u samples", count - total);
-				m_suppressed = -1;
-			}
-            else
-            {
-				m_suppressed++;
-			}
+		else
+		{
+			m_suppressed++;
 		}
 	}
+}
 
-	remaining = total;
-
-    while (remaining > 0)
-    {
-		len = std::min(remaining, m_size - m_tail);
-		std::copy(begin, begin + len, m_data.begin() + m_tail);
-		m_tail += len;
-		m_tail %= m_size;
-		m_fill += len;
-		begin += len;
-		remaining -= len;
-	}
+void SampleSinkFifo::notifyConsumer()
+{
+	// only one signal until the consumer polls the FIFO again
+	// the fence orders the tail store before the flag exchange (pairs with the fence in fill)
+	std::atomic_thread_fence(std::memory_order_seq_cst);
 
-	if (m_fill > 0) {
+	if (!m_dataReadyPending.m_value.exchange(true)) {
 		emit dataReady();
-    }
-
-	return total;
+	}
 }
 
-unsigned int SampleSinkFifo::write(SampleVector::const_iterator begin, SampleVector::const_iterator end)
+unsigned int SampleSinkFifo::write(const quint8* data, unsigned int count)
 {
-	QMutexLocker mutexLocker(&m_mutex);
-	unsigned int count = end - begin;
-	unsigned int total;
-	unsigned int remaining;
-	unsigned int len;
+	const Sample* begin = (const Sample*)data;
+	count /= sizeof(Sample);
 
-	total = std::min(count, m_size - m_fill);
+	if (m_size == 0) {
+		return 0;
+	}
 
-    if (total < count)
-    {
-		if (m_suppressed < 0)
-        {
-			m_suppressed = 0;
-			m_msgRateTimer.start();
-			qCritical("SampleSinkFifo::write: overflow - dropping %u samples", count - total);
-		}
-        else
-        {
-			if (m_msgRateTimer.elapsed() > 2500)
-            {
-				qCritical("SampleSinkFifo::write: %u messages dropped", m_suppressed);
-				qCritical("SampleSinkFifo::write: overflow - dropping %u samples", count - total);
-				m_suppressed = -1;
-			}
-            else
-            {
-				m_suppressed++;
-			}
-		}
+	quint64 tail = m_tail.m_value.load(std::memory_order_relaxed);
+	unsigned int fill = tail - m_head.m_value.load(std::memory_order_acquire);
+	unsigned int total = std::min(count, m_size - fill);
+
+	if (total < count) {
+		reportOverflow(count, total);
 	}
 
-	remaining = total;
+	unsigned int remaining = total;
+	unsigned int index = tail % m_size;
 
-    while (remaining > 0)
-    {
-		len = std::min(remaining, m_size - m_tail);
-		std::copy(begin, begin + len, m_data.begin() + m_tail);
-		m_tail += len;
-		m_tail %= m_size;
-		m_fill += len;
+	while (remaining > 0)
+	{
+		unsigned int len = std::min(remaining, m_size - index);
+		std::copy(begin, begin + len, m_data.begin() + index);
+		index = (index + len) % m_size;
 		begin += len;
 		remaining -= len;
 	}
 
-	if (m_fill > 0) {
-		emit dataReady();
-    }
+	m_tail.m_value.store(tail + total, std::memory_order_release);
+
+	if (fill + total > 0) {
+		notifyConsumer();
+	}
 
 	return total;
 }
 
+unsigned int SampleSinkFifo::write(SampleVector::const_iterator begin, SampleVector::const_iterator end)
+{
+	if (begin == end) {
+		return 0;
+	}
+
+	return write((const quint8*) &(*begin), (end - begin) * sizeof(Sample));
+}
+
 unsigned int SampleSinkFifo::read(SampleVector::iterator begin, SampleVector::iterator end)
 {
-	QMutexLocker mutexLocker(&m_mutex);
 	unsigned int count = end - begin;
-	unsigned int total;
-	unsigned int remaining;
-	unsigned int len;
-
-	total = std::min(count, m_fill);
+	unsigned int total = std::min(count, fill());
 
     if (total < count) {
 		qCritical("SampleSinkFifo::read: underflow - missing %u samples", count - total);
     }
 
-	remaining = total;
+	quint64 head = m_head.m_value.load(std::memory_order_relaxed);
+	unsigned int index = m_size == 0 ? 0 : head % m_size;
+	unsigned int remaining = total;
 
     while (remaining > 0)
     {
-		len = std::min(remaining, m_size - m_head);
-		std::copy(m_data.begin() + m_head, m_data.begin() + m_head + len, begin);
-		m_head += len;
-		m_head %= m_size;
-		m_fill -= len;
+		unsigned int len = std::min(remaining, m_size - index);
+		std::copy(m_data.begin() + index, m_data.begin() + index + len, begin);
+		index = (index + len) % m_size;
 		begin += len;
 		remaining -= len;
 	}
 
+	m_head.m_value.store(head + total, std::memory_order_release);
+
 	return total;
 }
 
@@ -223,13 +184,10 @@ unsigned int SampleSinkFifo::readBegin(unsigned int count,
 	SampleVector::iterator* part1Begin, SampleVector::iterator* part1End,
 	SampleVector::iterator* part2Begin, SampleVector::iterator* part2End)
 {
-	QMutexLocker mutexLocker(&m_mutex);
-	unsigned int total;
+	unsigned int total = std::min(count, fill());
 	unsigned int remaining;
 	unsigned int len;
-	unsigned int head = m_head;
-
-	total = std::min(count, m_fill);
+	unsigned int head = m_size == 0 ? 0 : m_head.m_value.load(std::memory_order_relaxed) % m_size;
 
     if (total < count) {
 		qCritical("SampleSinkFifo::readBegin: underflow - missing %u samples", count - total);
@@ -269,16 +227,16 @@ unsigned int SampleSinkFifo::readBegin(unsigned int count,
 
 unsigned int SampleSinkFifo::readCommit(unsigned int count)
 {
-	QMutexLocker mutexLocker(&m_mutex);
+	quint64 head = m_head.m_value.load(std::memory_order_relaxed);
+	unsigned int fill = m_tail.m_value.load(std::memory_order_acquire) - head;
 
-	if (count > m_fill)
+	if (count > fill)
     {
 		qCritical("SampleSinkFifo::readCommit: cannot commit more than available samples");
-		count = m_fill;
+		count = fill;
 	}
 
-    m_head = (m_head + count) % m_size;
-	m_fill -= count;
+	m_head.m_value.store(head + count, std::memory_order_release);
 
 	return count;
 }
@@ -286,4 +244,4 @@ unsigned int SampleSinkFifo::readCommit(unsigned int count)
 unsigned int SampleSinkFifo::getSizePolicy(unsigned int sampleRate)
 {
     return (sampleRate/100)*64; // .64s
-}
\ No newline at end of file
+}
@@ -19,28 +19,50 @@
 #ifndef INCLUDE_SAMPLEFIFO_H
 #define INCLUDE_SAMPLEFIFO_H
 
+#include <atomic>
+
 #include <QObject>
-#include <QMutex>
 #include <QElapsedTimer>
 #include "dsp/dsptypes.h"
 #include "export.h"
 
+/**
+ * Wait-free single producer / single consumer sample FIFO.
+ *
+ * write() and room() must be called from one thread only and fill(), read(), readBegin() and readCommit()
+ * from one (possibly other) thread only. Head and tail are monotonic 64 bit sample counters
+ * living on separate cache lines so that the fill is simply their difference.
+ *
+ * dataReady is emitted only when the consumer has polled the FIFO (fill() or readBegin())
+ * since the last emission. This coalesces the signals while the consumer is busy.
+ * setSize() and reset() must not be called while data is being transferred.
+ */
 class SDRBASE_API SampleSinkFifo : public QObject {
 	Q_OBJECT
 
 private:
-	QMutex m_mutex;
+	struct alignas(64) Counter {
+		std::atomic<quint64> m_value;
+		Counter() : m_value(0) {}
+	};
+
+	Counter m_head; //!< consumer position
+	Counter m_tail; //!< producer position
+	struct alignas(64) Flag {
+		std::atomic<bool> m_value;
+		Flag() : m_value(false) {}
+	} m_dataReadyPending;
+
 	QElapsedTimer m_msgRateTimer;
 	int m_suppressed;
 
 	SampleVector m_data;
 
 	unsigned int m_size;
-	unsigned int m_fill;
-	unsigned int m_head;
-	unsigned int m_tail;
 
 	void create(unsigned int s);
+	void reportOverflow(unsigned int count, unsigned int total);
+	void notifyConsumer();
 
 public:
 	SampleSinkFifo(QObject* parent = nullptr);
@@ -51,7 +73,17 @@ public:
 	bool setSize(int size);
     void reset();
 	inline unsigned int size() const { return m_size; }
-	inline unsigned int fill() { QMutexLocker mutexLocker(&m_mutex); unsigned int fill = m_fill; return fill; }
+	inline unsigned int fill()
+	{
+		m_dataReadyPending.m_value.store(false);
+		// pairs with the fence in notifyConsumer: either we see the new tail or the producer sees the cleared flag
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		return m_tail.m_value.load(std::memory_order_acquire) - m_head.m_value.load(std::memory_order_relaxed);
+	}
+	inline unsigned int room() const //!< free space for the producer
+	{
+		return m_size - (m_tail.m_value.load(std::memory_order_relaxed) - m_head.m_value.load(std::memory_order_acquire));
+	}
 
 	unsigned int write(const quint8* data, unsigned int count);
 	unsigned int write(SampleVector::const_iterator begin, SampleVector::const_iterator end);
@@ -0,0 +1,268 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <QDebug>
+
+#include "samplesumkernels.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SAMPLESUM_X86
+#define SAMPLESUM_TARGET(arch) __attribute__((target(arch)))
+#elif defined(_MSC_VER) && (defined(_M_AMD64) || defined(_M_IX86))
+#include <immintrin.h>
+#define SAMPLESUM_X86
+#define SAMPLESUM_TARGET(arch)
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SAMPLESUM_NEON
+#endif
+
+static void accumulateGeneric(const FixReal *in, qint32 *sum, unsigned int n)
+{
+    for (unsigned int i = 0; i < n; i++) {
+        sum[i] += in[i];
+    }
+}
+
+static void normalizeGeneric(const qint32 *sum, FixReal *out, unsigned int n, unsigned int nbSources)
+{
+    qint32 d = (qint32) nbSources;
+
+    for (unsigned int i = 0; i < n; i++) {
+        out[i] = (FixReal) (sum[i] / d);
+    }
+}
+
+#if defined(SAMPLESUM_X86)
+SAMPLESUM_TARGET("sse2")
+static void accumulateSSE2(const FixReal *in, qint32 *sum, unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+#ifdef SDR_RX_SAMPLE_24BIT
+        __m128i lo = _mm_loadu_si128((const __m128i *) &in[i]);
+        __m128i hi = _mm_loadu_si128((const __m128i *) &in[i + 4]);
+#else
+        __m128i x = _mm_loadu_si128((const __m128i *) &in[i]);
+        // sign extension: the component in the upper half shifted back arithmetically
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+#endif
+        _mm_storeu_si128((__m128i *) &sum[i], _mm_add_epi32(_mm_loadu_si128((const __m128i *) &sum[i]), lo));
+        _mm_storeu_si128((__m128i *) &sum[i + 4], _mm_add_epi32(_mm_loadu_si128((const __m128i *) &sum[i + 4]), hi));
+    }
+
+    accumulateGeneric(in + i, sum + i, n - i);
+}
+
+#ifdef SDR_RX_SAMPLE_24BIT
+SAMPLESUM_TARGET("sse2")
+static inline __m128i divideSSE2(__m128i x, __m128d d)
+{
+    __m128d lo = _mm_div_pd(_mm_cvtepi32_pd(x), d);
+    __m128d hi = _mm_div_pd(_mm_cvtepi32_pd(_mm_unpackhi_epi64(x, x)), d);
+    return _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi));
+}
+#endif
+
+SAMPLESUM_TARGET("sse2")
+static void normalizeSSE2(const qint32 *sum, FixReal *out, unsigned int n, unsigned int nbSources)
+{
+    unsigned int i = 0;
+#ifdef SDR_RX_SAMPLE_24BIT
+    const __m128d d = _mm_set1_pd((double) nbSources);
+
+    for (; i + 8 <= n; i += 8)
+    {
+        _mm_storeu_si128((__m128i *) &out[i], divideSSE2(_mm_loadu_si128((const __m128i *) &sum[i]), d));
+        _mm_storeu_si128((__m128i *) &out[i + 4], divideSSE2(_mm_loadu_si128((const __m128i *) &sum[i + 4]), d));
+    }
+#else
+    const __m128 d = _mm_set1_ps((float) nbSources);
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i a = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *) &sum[i])), d));
+        __m128i b = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *) &sum[i + 4])), d));
+        _mm_storeu_si128((__m128i *) &out[i], _mm_packs_epi32(a, b)); // the mean is in range: no saturation
+    }
+#endif
+
+    normalizeGeneric(sum + i, out + i, n - i, nbSources);
+}
+
+SAMPLESUM_TARGET("avx2")
+static void accumulateAVX2(const FixReal *in, qint32 *sum, unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+#ifdef SDR_RX_SAMPLE_24BIT
+        __m256i lo = _mm256_loadu_si256((const __m256i *) &in[i]);
+        __m256i hi = _mm256_loadu_si256((const __m256i *) &in[i + 8]);
+#else
+        __m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) &in[i]));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) &in[i + 8]));
+#endif
+        _mm256_storeu_si256((__m256i *) &sum[i], _mm256_add_epi32(_mm256_loadu_si256((const __m256i *) &sum[i]), lo));
+        _mm256_storeu_si256((__m256i *) &sum[i + 8], _mm256_add_epi32(_mm256_loadu_si256((const __m256i *) &sum[i + 8]), hi));
+    }
+
+    accumulateSSE2(in + i, sum + i, n - i);
+}
+
+#ifdef SDR_RX_SAMPLE_24BIT
+SAMPLESUM_TARGET("avx2")
+static inline __m256i divideAVX2(__m256i x, __m256d d)
+{
+    __m128i lo = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(x)), d));
+    __m128i hi = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(x, 1)), d));
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+#endif
+
+SAMPLESUM_TARGET("avx2")
+static void normalizeAVX2(const qint32 *sum, FixReal *out, unsigned int n, unsigned int nbSources)
+{
+    unsigned int i = 0;
+#ifdef SDR_RX_SAMPLE_24BIT
+    const __m256d d = _mm256_set1_pd((double) nbSources);
+
+    for (; i + 16 <= n; i += 16)
+    {
+        _mm256_storeu_si256((__m256i *) &out[i], divideAVX2(_mm256_loadu_si256((const __m256i *) &sum[i]), d));
+        _mm256_storeu_si256((__m256i *) &out[i + 8], divideAVX2(_mm256_loadu_si256((const __m256i *) &sum[i + 8]), d));
+    }
+#else
+    const __m256 d = _mm256_set1_ps((float) nbSources);
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i a = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i *) &sum[i])), d));
+        __m256i b = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i *) &sum[i + 8])), d));
+        // packing within 128 bit lanes gives a0 b0 | a1 b1
+        __m256i p = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i *) &out[i], p);
+    }
+#endif
+
+    normalizeSSE2(sum + i, out + i, n - i, nbSources);
+}
+#endif // SAMPLESUM_X86
+
+#if defined(SAMPLESUM_NEON)
+static void accumulateNEON(const FixReal *in, qint32 *sum, unsigned int n)
+{
+    unsigned int i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+#ifdef SDR_RX_SAMPLE_24BIT
+        vst1q_s32(&sum[i], vaddq_s32(vld1q_s32(&sum[i]), vld1q_s32(&in[i])));
+        vst1q_s32(&sum[i + 4], vaddq_s32(vld1q_s32(&sum[i + 4]), vld1q_s32(&in[i + 4])));
+#else
+        int16x8_t x = vld1q_s16(&in[i]);
+        vst1q_s32(&sum[i], vaddw_s16(vld1q_s32(&sum[i]), vget_low_s16(x)));
+        vst1q_s32(&sum[i + 4], vaddw_s16(vld1q_s32(&sum[i + 4]), vget_high_s16(x)));
+#endif
+    }
+
+    accumulateGeneric(in + i, sum + i, n - i);
+}
+
+static void normalizeNEON(const qint32 *sum, FixReal *out, unsigned int n, unsigned int nbSources)
+{
+    unsigned int i = 0;
+#if defined(__aarch64__) // 32 bit ARM has no vector division: generic division
+#ifdef SDR_RX_SAMPLE_24BIT
+    const float64x2_t d = vdupq_n_f64((double) nbSources);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        int32x4_t x = vld1q_s32(&sum[i]);
+        int64x2_t lo = vcvtq_s64_f64(vdivq_f64(vcvtq_f64_s64(vmovl_s32(vget_low_s32(x))), d));
+        int64x2_t hi = vcvtq_s64_f64(vdivq_f64(vcvtq_f64_s64(vmovl_s32(vget_high_s32(x))), d));
+        vst1q_s32(&out[i], vcombine_s32(vmovn_s64(lo), vmovn_s64(hi)));
+    }
+#else
+    const float32x4_t d = vdupq_n_f32((float) nbSources);
+
+    for (; i + 8 <= n; i += 8)
+    {
+        int32x4_t a = vcvtq_s32_f32(vdivq_f32(vcvtq_f32_s32(vld1q_s32(&sum[i])), d));
+        int32x4_t b = vcvtq_s32_f32(vdivq_f32(vcvtq_f32_s32(vld1q_s32(&sum[i + 4])), d));
+        vst1q_s16(&out[i], vcombine_s16(vmovn_s32(a), vmovn_s32(b)));
+    }
+#endif
+#endif // __aarch64__
+
+    normalizeGeneric(sum + i, out + i, n - i, nbSources);
+}
+#endif // SAMPLESUM_NEON
+
+const SampleSumKernels& SampleSumKernels::instance()
+{
+    static SampleSumKernels kernels;
+    return kernels;
+}
+
+SampleSumKernels::SampleSumKernels()
+{
+    getKernels(CPUFeatures::instance().getBestLevel(), m_accumulate, m_normalize, m_level);
+    qInfo("SampleSumKernels::SampleSumKernels: using %s sample sum kernels", CPUFeatures::getLevelName(m_level));
+}
+
+void SampleSumKernels::getKernels(CPUFeatures::SIMDLevel level, Accumulate& accumulate, Normalize& normalize, CPUFeatures::SIMDLevel& actualLevel)
+{
+    const CPUFeatures& cpu = CPUFeatures::instance();
+    (void) cpu;
+
+#if defined(SAMPLESUM_X86)
+    if (((level == CPUFeatures::SIMDAVX2) || (level == CPUFeatures::SIMDAVX512)) && cpu.hasAVX2())
+    {
+        accumulate = accumulateAVX2;
+        normalize = normalizeAVX2;
+        actualLevel = CPUFeatures::SIMDAVX2;
+        return;
+    }
+    else if ((level >= CPUFeatures::SIMDSSE2) && (level != CPUFeatures::SIMDNEON) && cpu.hasSSE2())
+    {
+        accumulate = accumulateSSE2;
+        normalize = normalizeSSE2;
+        actualLevel = CPUFeatures::SIMDSSE2;
+        return;
+    }
+#elif defined(SAMPLESUM_NEON)
+    if ((level == CPUFeatures::SIMDNEON) && cpu.hasNEON())
+    {
+        accumulate = accumulateNEON;
+        normalize = normalizeNEON;
+        actualLevel = CPUFeatures::SIMDNEON;
+        return;
+    }
+#else
+    (void) level;
+#endif
+
+    accumulate = accumulateGeneric;
+    normalize = normalizeGeneric;
+    actualLevel = CPUFeatures::SIMDGeneric;
+}
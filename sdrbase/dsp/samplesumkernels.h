@@ -0,0 +1,58 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_DSP_SAMPLESUMKERNELS_H_
+#define SDRBASE_DSP_SAMPLESUMKERNELS_H_
+
+#include "dsp/dsptypes.h"
+#include "util/cpufeatures.h"
+#include "export.h"
+
+/**
+ * Kernels summing the samples of several baseband sources selected at run time for the host CPU.
+ * They work on the n real and imaginary components of n/2 samples.
+ *
+ * accumulate adds the components to the 32 bit sum: sum[i] += in[i]
+ * normalize gives the mean of the components: out[i] = sum[i] / nbSources (integer division)
+ *
+ * Sums are exact up to 256 sources of 24 bit samples so the result does not depend on the order
+ * of the sources. The SIMD kernels divide in float for 16 bit samples and in double for 24 bit
+ * samples where the sums do not all fit in the float mantissa. Both hold the sums exactly and
+ * the rounded quotient never crosses an integer so all kernels give the integer division.
+ */
+class SDRBASE_API SampleSumKernels
+{
+public:
+    typedef void (*Accumulate)(const FixReal *in, qint32 *sum, unsigned int n);
+    typedef void (*Normalize)(const qint32 *sum, FixReal *out, unsigned int n, unsigned int nbSources);
+
+    static const SampleSumKernels& instance();
+
+    Accumulate getAccumulate() const { return m_accumulate; }
+    Normalize getNormalize() const { return m_normalize; }
+    CPUFeatures::SIMDLevel getLevel() const { return m_level; }
+    static void getKernels(CPUFeatures::SIMDLevel level, Accumulate& accumulate, Normalize& normalize, CPUFeatures::SIMDLevel& actualLevel); //!< specific kernels (benchmarks). Falls back to generic if not available.
+
+private:
+    SampleSumKernels();
+
+    Accumulate m_accumulate;
+    Normalize m_normalize;
+    CPUFeatures::SIMDLevel m_level;
+};
+
+#endif // SDRBASE_DSP_SAMPLESUMKERNELS_H_
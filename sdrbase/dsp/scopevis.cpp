@@ -21,7 +21,8 @@
 
 #include "scopevis.h"
 #include "dsp/dspcommands.h"
-#include "gui/glscope.h"
+#include "dsp/projectorkernels.h"
+#include "dsp/glscopeinterface.h"
 
 MESSAGE_CLASS_DEFINITION(ScopeVis::MsgConfigureScopeVisNG, Message)
 MESSAGE_CLASS_DEFINITION(ScopeVis::MsgScopeVisNGAddTrigger, Message)
@@ -36,11 +37,13 @@ MESSAGE_CLASS_DEFINITION(ScopeVis::MsgScopeVisNGMoveTrace, Message)
 MESSAGE_CLASS_DEFINITION(ScopeVis::MsgScopeVisNGFocusOnTrace, Message)
 MESSAGE_CLASS_DEFINITION(ScopeVis::MsgScopeVisNGOneShot, Message)
 MESSAGE_CLASS_DEFINITION(ScopeVis::MsgScopeVisNGMemoryTrace, Message)
+MESSAGE_CLASS_DEFINITION(ScopeVis::MsgConfigureWSScopeOpenClose, Message)
+MESSAGE_CLASS_DEFINITION(ScopeVis::MsgConfigureWSScope, Message)
 
 const uint ScopeVis::m_traceChunkDefaultSize = 4800;
 
 
-ScopeVis::ScopeVis(GLScope* glScope) :
+ScopeVis::ScopeVis(GLScopeInterface* glScope) :
     m_glScope(glScope),
     m_preTriggerDelay(0),
     m_livePreTriggerDelay(0),
@@ -67,10 +70,12 @@ ScopeVis::ScopeVis(GLScope* glScope) :
 {
     setObjectName("ScopeVis");
     m_traceDiscreteMemory.resize(m_traceChunkDefaultSize); // arbitrary
-    m_glScope->setTraces(&m_traces.m_tracesData, &m_traces.m_traces[0]);
-    for (int i = 0; i < (int) Projector::nbProjectionTypes; i++) {
-        m_projectorCache[i] = 0.0;
+
+    if (m_glScope) {
+        m_glScope->setTraces(&m_traces.m_tracesData, &m_traces.m_traces[0]);
     }
+
+    m_triggerProjection.resize(m_triggerProjectionChunkSize);
 }
 
 ScopeVis::~ScopeVis()
@@ -80,6 +85,19 @@ ScopeVis::~ScopeVis()
     }
 }
 
+void ScopeVis::setGLScope(GLScopeInterface* glScope)
+{
+    m_glScope = glScope;
+
+    if (m_glScope)
+    {
+        m_glScope->setTraces(&m_traces.m_tracesData, &m_traces.m_traces[0]);
+        m_glScope->setSampleRate(m_sampleRate);
+        m_glScope->setTraceSize(m_traceSize);
+        m_glScope->setTriggerPre(m_preTriggerDelay);
+    }
+}
+
 void ScopeVis::setLiveRate(int sampleRate)
 {
     m_liveSampleRate = sampleRate;
@@ -126,6 +144,24 @@ void ScopeVis::configure(uint32_t traceSize, uint32_t timeBase, uint32_t timeOfs
     getInputMessageQueue()->push(cmd);
 }
 
+void ScopeVis::openWSScope()
+{
+    Message* cmd = MsgConfigureWSScopeOpenClose::create(true);
+    getInputMessageQueue()->push(cmd);
+}
+
+void ScopeVis::closeWSScope()
+{
+    Message* cmd = MsgConfigureWSScopeOpenClose::create(false);
+    getInputMessageQueue()->push(cmd);
+}
+
+void ScopeVis::configureWSScope(const QString& address, uint16_t port)
+{
+    Message* cmd = MsgConfigureWSScope::create(address, port);
+    getInputMessageQueue()->push(cmd);
+}
+
 void ScopeVis::addTrace(const TraceData& traceData)
 {
     qDebug() << "ScopeVis::addTrace:"
@@ -322,6 +358,8 @@ void ScopeVis::processTrace(const SampleVector::const_iterator& cbegin, const Sa
     else if ((m_triggerState == TriggerUntriggered) || (m_triggerState == TriggerDelay)) // look for trigger or past trigger in delay mode
     {
         TriggerCondition* triggerCondition = m_triggerConditions[m_currentTriggerIndex]; // current trigger condition
+        SampleVector::const_iterator projectedBegin = begin; // samples from there to projectedEnd are projected for the trigger
+        SampleVector::const_iterator projectedEnd = begin;
 
         while (begin < end)
         {
@@ -354,7 +392,15 @@ void ScopeVis::processTrace(const SampleVector::const_iterator& cbegin, const Sa
                 }
             }
 
-            if (m_triggerComparator.triggered(*begin, *triggerCondition)) // matched the current trigger
+            if (begin >= projectedEnd) // project the next chunk of samples at once
+            {
+                int count = std::min((int) (end - begin), (int) m_triggerProjection.size());
+                triggerCondition->m_projector.run(&(*begin), count, m_triggerProjection.data());
+                projectedBegin = begin;
+                projectedEnd = begin + count;
+            }
+
+            if (m_triggerComparator.triggered(m_triggerProjection[begin - projectedBegin], *triggerCondition)) // matched the current trigger
             {
                 if (triggerCondition->m_triggerData.m_triggerDelay > 0)
                 {
@@ -490,128 +536,133 @@ int ScopeVis::processTraces(const SampleVector::const_iterator& cbegin, const Sa
     SampleVector::const_iterator begin(cbegin);
     uint32_t shift = (m_timeOfsProMill / 1000.0) * m_traceSize;
     uint32_t length = m_traceSize / m_timeBase;
+    int nbSamples = std::max(0, std::min((int) (end - begin), m_nbSamples)); // samples processed in this call
 
-    while ((begin < end) && (m_nbSamples > 0))
+    if ((int) m_projectionBuffer.size() < nbSamples)
     {
-        std::vector<TraceControl*>::iterator itCtl = m_traces.m_tracesControl.begin();
-        std::vector<TraceData>::iterator itData = m_traces.m_tracesData.begin();
-        std::vector<float *>::iterator itTrace = m_traces.m_traces[m_traces.currentBufferIndex()].begin();
+        m_projectionBuffer.resize(nbSamples);
+        m_magsqBuffer.resize(nbSamples);
+    }
 
-        for (; itCtl != m_traces.m_tracesControl.end(); ++itCtl, ++itData, ++itTrace)
-        {
-            if (traceBack && ((end - begin) > itData->m_traceDelay)) { // before start of trace
-                continue;
-            }
+    std::vector<TraceControl*>::iterator itCtl = m_traces.m_tracesControl.begin();
+    std::vector<TraceData>::iterator itData = m_traces.m_tracesData.begin();
+    std::vector<float *>::iterator itTrace = m_traces.m_traces[m_traces.currentBufferIndex()].begin();
+
+    // each trace projects all its samples at once then scales them to display
+    for (; itCtl != m_traces.m_tracesControl.end(); ++itCtl, ++itData, ++itTrace)
+    {
+        int start = traceBack ? std::max(0, (int) (end - begin) - itData->m_traceDelay) : 0; // skip samples before start of trace
+        uint32_t& traceCount = (*itCtl)->m_traceCount[m_traces.currentBufferIndex()]; // reference for code clarity
+
+        if ((start >= nbSamples) || (traceCount >= m_traceSize)) {
+            continue;
+        }
 
-            Projector::ProjectionType projectionType = itData->m_projectionType;
+        int count = std::min(nbSamples - start, (int) (m_traceSize - traceCount));
+        const Sample *samples = &(*(begin + start));
+        Projector::ProjectionType projectionType = itData->m_projectionType;
+        Real *projected = m_projectionBuffer.data();
+        Real *magsqs = m_magsqBuffer.data();
+        (*itCtl)->m_projector.run(samples, count, projected);
+
+        if (projectionType == Projector::ProjectionMagDB) { // the overlay works with power
+            ProjectorKernels::instance().getMagSq()(samples, magsqs, count);
+        } else if (projectionType == Projector::ProjectionMagSq) {
+            magsqs = projected;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            int nbSamplesLeft = m_nbSamples - (start + i); // including this sample
+            float v;
 
-            if ((*itCtl)->m_traceCount[m_traces.currentBufferIndex()] < m_traceSize)
+            if (projectionType == Projector::ProjectionMagLin)
             {
-                uint32_t& traceCount = (*itCtl)->m_traceCount[m_traces.currentBufferIndex()]; // reference for code clarity
-                float v;
+                v = (projected[i] - itData->m_ofs)*itData->m_amp - 1.0f;
+            }
+            else if ((projectionType == Projector::ProjectionMagSq) || (projectionType == Projector::ProjectionMagDB))
+            {
+                Real magsq = magsqs[i];
 
-                if (projectionType == Projector::ProjectionMagLin)
+                if (projectionType == Projector::ProjectionMagSq)
                 {
-                    v = ((*itCtl)->m_projector.run(*begin) - itData->m_ofs)*itData->m_amp - 1.0f;
+                    v = (magsq - itData->m_ofs)*itData->m_amp - 1.0f;
                 }
-                else if (projectionType == Projector::ProjectionMagSq)
+                else
                 {
-                    Real magsq = (*itCtl)->m_projector.run(*begin);
-                    v = (magsq - itData->m_ofs)*itData->m_amp - 1.0f;
+                    float p = projected[i] - (100.0f * itData->m_ofs);
+                    v = ((p/50.0f) + 2.0f)*itData->m_amp - 1.0f;
+                }
 
-                    if ((traceCount >= shift) && (traceCount < shift+length)) // power display overlay values construction
+                if ((traceCount >= shift) && (traceCount < shift+length)) // power display overlay values construction
+                {
+                    if (traceCount == shift)
                     {
-                        if (traceCount == shift)
-                        {
-                            (*itCtl)->m_maxPow = 0.0f;
-                            (*itCtl)->m_sumPow = 0.0f;
-                            (*itCtl)->m_nbPow = 1;
-                        }
+                        (*itCtl)->m_maxPow = 0.0f;
+                        (*itCtl)->m_sumPow = 0.0f;
+                        (*itCtl)->m_nbPow = 1;
+                    }
 
-                        if (magsq > 0.0f)
+                    if (magsq > 0.0f)
+                    {
+                        if (magsq > (*itCtl)->m_maxPow)
                         {
-                            if (magsq > (*itCtl)->m_maxPow)
-                            {
-                                (*itCtl)->m_maxPow = magsq;
-                            }
-
-                            (*itCtl)->m_sumPow += magsq;
-                            (*itCtl)->m_nbPow++;
+                            (*itCtl)->m_maxPow = magsq;
                         }
-                    }
 
-                    if ((m_nbSamples == 1) && ((*itCtl)->m_nbPow > 0)) // on last sample create power display overlay
-                    {
-                        double avgPow = (*itCtl)->m_sumPow / (*itCtl)->m_nbPow;
-                        itData->m_textOverlay = QString("%1  %2").arg((*itCtl)->m_maxPow, 0, 'e', 2).arg(avgPow, 0, 'e', 2);
-                        (*itCtl)->m_nbPow = 0;
+                        (*itCtl)->m_sumPow += magsq;
+                        (*itCtl)->m_nbPow++;
                     }
                 }
-                else if (projectionType == Projector::ProjectionMagDB)
-                {
-                    Real re = begin->m_real / SDR_RX_SCALEF;
-                    Real im = begin->m_imag / SDR_RX_SCALEF;
-                    double magsq = re*re + im*im;
-                    float pdB = log10f(magsq) * 10.0f;
-                    float p = pdB - (100.0f * itData->m_ofs);
-                    v = ((p/50.0f) + 2.0f)*itData->m_amp - 1.0f;
 
-                    if ((traceCount >= shift) && (traceCount < shift+length)) // power display overlay values construction
+                if ((nbSamplesLeft == 1) && ((*itCtl)->m_nbPow > 0)) // on last sample create power display overlay
+                {
+                    if (projectionType == Projector::ProjectionMagSq)
                     {
-                        if (traceCount == shift)
-                        {
-                            (*itCtl)->m_maxPow = 0.0f;
-                            (*itCtl)->m_sumPow = 0.0f;
-                            (*itCtl)->m_nbPow = 1;
-                        }
-
-                        if (magsq > 0.0f)
-                        {
-                            if (magsq > (*itCtl)->m_maxPow)
-                            {
-                                (*itCtl)->m_maxPow = magsq;
-                            }
-
-                            (*itCtl)->m_sumPow += magsq;
-                            (*itCtl)->m_nbPow++;
-                        }
+                        double avgPow = (*itCtl)->m_sumPow / (*itCtl)->m_nbPow;
+                        itData->m_textOverlay = QString("%1  %2").arg((*itCtl)->m_maxPow, 0, 'e', 2).arg(avgPow, 0, 'e', 2);
                     }
-
-                    if ((m_nbSamples == 1) && ((*itCtl)->m_nbPow > 0)) // on last sample create power display overlay
+                    else
                     {
                         double avgPow = log10f((*itCtl)->m_sumPow / (*itCtl)->m_nbPow)*10.0;
                         double peakPow = log10f((*itCtl)->m_maxPow)*10.0;
                         double peakToAvgPow = peakPow - avgPow;
                         itData->m_textOverlay = QString("%1  %2  %3").arg(peakPow, 0, 'f', 1).arg(avgPow, 0, 'f', 1).arg(peakToAvgPow, 4, 'f', 1, ' ');
-                        (*itCtl)->m_nbPow = 0;
                     }
-                }
-                else
-                {
-                    v = ((*itCtl)->m_projector.run(*begin) - itData->m_ofs) * itData->m_amp;
-                }
 
-                if(v > 1.0f) {
-                    v = 1.0f;
-                } else if (v < -1.0f) {
-                    v = -1.0f;
+                    (*itCtl)->m_nbPow = 0;
                 }
+            }
+            else
+            {
+                v = (projected[i] - itData->m_ofs) * itData->m_amp;
+            }
 
-                (*itTrace)[2*traceCount]
-                           = traceCount - shift;   // display x
-                (*itTrace)[2*traceCount + 1] = v;  // display y
-                traceCount++;
+            if(v > 1.0f) {
+                v = 1.0f;
+            } else if (v < -1.0f) {
+                v = -1.0f;
             }
-        }
 
-        ++begin;
-        m_nbSamples--;
+            (*itTrace)[2*traceCount]
+                       = traceCount - shift;   // display x
+            (*itTrace)[2*traceCount + 1] = v;  // display y
+            traceCount++;
+        }
     }
 
+    begin += nbSamples;
+    m_nbSamples -= nbSamples;
+
     float traceTime = ((float) m_traceSize) / m_sampleRate;
 
-    if (traceTime >= 1.0f) { // display continuously if trace time is 1 second or more
-        m_glScope->newTraces(m_traces.m_traces, m_traces.currentBufferIndex(), &m_traces.m_projectionTypes);
+    if (traceTime >= 1.0f) // display continuously if trace time is 1 second or more
+    {
+        if (m_glScope) {
+            m_glScope->newTraces(m_traces.m_traces, m_traces.currentBufferIndex(), &m_traces.m_projectionTypes);
+        }
+
+        streamTraces();
     }
 
     if (m_nbSamples == 0) // finished
@@ -619,13 +670,15 @@ int ScopeVis::processTraces(const SampleVector::const_iterator& cbegin, const Sa
         // display only at trace end if trace time is less than 1 second
         if (traceTime < 1.0f)
         {
-            if (m_glScope->getProcessingTraceIndex().load() < 0) {
+            if (m_glScope && (m_glScope->getProcessingTraceIndex() < 0)) {
                 m_glScope->newTraces(m_traces.m_traces, m_traces.currentBufferIndex(), &m_traces.m_projectionTypes);
             }
+
+            streamTraces();
         }
 
         // switch to next buffer only if it is not being processed by the scope
-        if (m_glScope->getProcessingTraceIndex().load() != (((int) m_traces.currentBufferIndex() + 1) % 2)) {
+        if (!m_glScope || (m_glScope->getProcessingTraceIndex() != (((int) m_traces.currentBufferIndex() + 1) % 2))) {
             m_traces.switchBuffer();
         }
 
@@ -704,7 +757,7 @@ bool ScopeVis::handleMessage(const Message& message)
                 << " m_preTriggerDelay: " << m_preTriggerDelay
                 << " m_freeRun: " << m_freeRun;
 
-        if ((m_glScope) && (m_currentTraceMemoryIndex > 0)) {
+        if (m_currentTraceMemoryIndex > 0) {
             processMemoryTrace();
         }
 
@@ -733,7 +786,11 @@ bool ScopeVis::handleMessage(const Message& message)
             if (triggerIndex == m_focusedTriggerIndex)
             {
                 computeDisplayTriggerLevels();
-                m_glScope->setFocusedTriggerData(m_triggerConditions[m_focusedTriggerIndex]->m_triggerData);
+
+                if (m_glScope) {
+                    m_glScope->setFocusedTriggerData(m_triggerConditions[m_focusedTriggerIndex]->m_triggerData);
+                }
+
                 updateGLScopeDisplay();
             }
         }
@@ -774,7 +831,11 @@ bool ScopeVis::handleMessage(const Message& message)
         m_triggerConditions[triggerIndex] = nextTrigger;
 
         computeDisplayTriggerLevels();
-        m_glScope->setFocusedTriggerData(m_triggerConditions[m_focusedTriggerIndex]->m_triggerData);
+
+        if (m_glScope) {
+            m_glScope->setFocusedTriggerData(m_triggerConditions[m_focusedTriggerIndex]->m_triggerData);
+        }
+
         updateGLScopeDisplay();
 
         return true;
@@ -789,7 +850,11 @@ bool ScopeVis::handleMessage(const Message& message)
         {
             m_focusedTriggerIndex = triggerIndex;
             computeDisplayTriggerLevels();
-            m_glScope->setFocusedTriggerData(m_triggerConditions[m_focusedTriggerIndex]->m_triggerData);
+
+            if (m_glScope) {
+                m_glScope->setFocusedTriggerData(m_triggerConditions[m_focusedTriggerIndex]->m_triggerData);
+            }
+
             updateGLScopeDisplay();
         }
 
@@ -854,7 +919,11 @@ bool ScopeVis::handleMessage(const Message& message)
         {
             m_focusedTraceIndex = traceIndex;
             computeDisplayTriggerLevels();
-            m_glScope->setFocusedTraceIndex(m_focusedTraceIndex);
+
+            if (m_glScope) {
+                m_glScope->setFocusedTraceIndex(m_focusedTraceIndex);
+            }
+
             updateGLScopeDisplay();
         }
 
@@ -904,6 +973,20 @@ bool ScopeVis::handleMessage(const Message& message)
         }
         return true;
     }
+    else if (MsgConfigureWSScopeOpenClose::match(message))
+    {
+        MsgConfigureWSScopeOpenClose& conf = (MsgConfigureWSScopeOpenClose&) message;
+        qDebug() << "ScopeVis::handleMessage: MsgConfigureWSScopeOpenClose: " << conf.getOpenClose();
+        handleWSOpenClose(conf.getOpenClose());
+        return true;
+    }
+    else if (MsgConfigureWSScope::match(message))
+    {
+        MsgConfigureWSScope& conf = (MsgConfigureWSScope&) message;
+        qDebug() << "ScopeVis::handleMessage: MsgConfigureWSScope: " << conf.getAddress() << ":" << conf.getPort();
+        handleConfigureWSScope(conf.getAddress(), conf.getPort());
+        return true;
+    }
     else
     {
         qDebug() << "ScopeVis::handleMessage" << message.getIdentifier() << " not handled";
@@ -914,13 +997,9 @@ bool ScopeVis::handleMessage(const Message& message)
 void ScopeVis::updateMaxTraceDelay()
 {
     int maxTraceDelay = 0;
-    bool allocateCache = false;
-    uint32_t projectorCounts[(int) Projector::nbProjectionTypes];
-    memset(projectorCounts, 0, ((int) Projector::nbProjectionTypes)*sizeof(uint32_t));
     std::vector<TraceData>::iterator itData = m_traces.m_tracesData.begin();
-    std::vector<TraceControl*>::iterator itCtrl = m_traces.m_tracesControl.begin();
 
-    for (; itData != m_traces.m_tracesData.end(); ++itData, ++itCtrl)
+    for (; itData != m_traces.m_tracesData.end(); ++itData)
     {
         if (itData->m_traceDelay > maxTraceDelay)
         {
@@ -930,29 +1009,6 @@ void ScopeVis::updateMaxTraceDelay()
         if (itData->m_projectionType < 0) {
             itData->m_projectionType = Projector::ProjectionReal;
         }
-
-        if (projectorCounts[(int) itData->m_projectionType] > 0)
-        {
-            allocateCache = true;
-            (*itCtrl)->m_projector.setCacheMaster(false);
-        }
-        else
-        {
-            (*itCtrl)->m_projector.setCacheMaster(true);
-        }
-
-        projectorCounts[(int) itData->m_projectionType]++;
-    }
-
-    itCtrl = m_traces.m_tracesControl.begin();
-
-    for (; itCtrl != m_traces.m_tracesControl.end(); ++itCtrl)
-    {
-        if (allocateCache) {
-            (*itCtrl)->m_projector.setCache(m_projectorCache);
-        } else {
-            (*itCtrl)->m_projector.setCache(0);
-        }
     }
 
     m_maxTraceDelay = maxTraceDelay;
@@ -1021,10 +1077,60 @@ void ScopeVis::computeDisplayTriggerLevels()
 
 void ScopeVis::updateGLScopeDisplay()
 {
-    if (m_currentTraceMemoryIndex > 0) {
-        m_glScope->setConfigChanged();
+    if (m_currentTraceMemoryIndex > 0)
+    {
+        if (m_glScope) {
+            m_glScope->setConfigChanged();
+        }
+
         processMemoryTrace();
-    } else {
+    }
+    else if (m_glScope)
+    {
         m_glScope->updateDisplay();
     }
 }
+
+void ScopeVis::streamTraces()
+{
+    if (m_wsScope.socketOpened())
+    {
+        m_wsScope.newTraces(
+            m_traces.m_traces[m_traces.currentBufferIndex()],
+            m_traceSize,
+            m_traces.m_projectionTypes,
+            m_sampleRate,
+            m_preTriggerDelay
+        );
+    }
+}
+
+void ScopeVis::handleWSOpenClose(bool openClose)
+{
+    QMutexLocker configLocker(&m_mutex);
+
+    if (openClose) {
+        m_wsScope.openSocket();
+    } else {
+        m_wsScope.closeSocket();
+    }
+}
+
+void ScopeVis::handleConfigureWSScope(const QString& address, uint16_t port)
+{
+    QMutexLocker configLocker(&m_mutex);
+    bool wsScopeWasOpen = false;
+
+    if (m_wsScope.socketOpened())
+    {
+        m_wsScope.closeSocket();
+        wsScopeWasOpen = true;
+    }
+
+    m_wsScope.setListeningAddress(address);
+    m_wsScope.setPort(port);
+
+    if (wsScopeWasOpen) {
+        m_wsScope.openSocket();
+    }
+}
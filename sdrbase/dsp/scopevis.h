@@ -36,13 +36,14 @@
 #include "export.h"
 #include "util/message.h"
 #include "util/doublebuffer.h"
+#include "websockets/wsscope.h"
 
 #undef M_PI
 #define M_PI		3.14159265358979323846
 
-class GLScope;
+class GLScopeInterface;
 
-class SDRGUI_API ScopeVis : public BasebandSampleSink {
+class SDRBASE_API ScopeVis : public BasebandSampleSink {
 
 public:
     struct TraceData
@@ -150,11 +151,13 @@ public:
     static const uint32_t m_traceChunkDefaultSize;
     static const uint32_t m_maxNbTriggers = 10;
     static const uint32_t m_maxNbTraces = 10;
+    static const uint32_t m_triggerProjectionChunkSize = 256; //!< samples projected at once while looking for a trigger
     static const uint32_t m_nbTraceMemories = 50;
 
-    ScopeVis(GLScope* glScope = 0);
+    ScopeVis(GLScopeInterface* glScope = nullptr);
     virtual ~ScopeVis();
 
+    void setGLScope(GLScopeInterface* glScope);
     void setLiveRate(int sampleRate);
     void configure(uint32_t traceSize, uint32_t timeBase, uint32_t timeOfsProMill, uint32_t triggerPre, bool freeRun);
     void addTrace(const TraceData& traceData);
@@ -171,6 +174,9 @@ public:
     void setMemoryIndex(uint32_t memoryIndex);
     void setTraceChunkSize(uint32_t chunkSize) { m_traceChunkSize = chunkSize; }
     uint32_t getTraceChunkSize() const { return m_traceChunkSize; }
+    void openWSScope();
+    void closeWSScope();
+    void configureWSScope(const QString& address, uint16_t port);
 
     QByteArray serializeMemory() const
     {
@@ -209,7 +215,7 @@ public:
             d.readBlob(4, &buf);
             traceDiscreteMemorySuccess = m_traceDiscreteMemory.deserialize(buf);
 
-            if (traceDiscreteMemorySuccess && (m_glScope) && (m_currentTraceMemoryIndex > 0)) {
+            if (traceDiscreteMemorySuccess && (m_currentTraceMemoryIndex > 0)) {
                 processMemoryTrace();
             }
 
@@ -557,6 +563,52 @@ private:
         {}
     };
 
+    // ---------------------------------------------
+    class MsgConfigureWSScopeOpenClose : public Message {
+        MESSAGE_CLASS_DECLARATION
+
+    public:
+        static MsgConfigureWSScopeOpenClose* create(
+                bool openClose)
+        {
+            return new MsgConfigureWSScopeOpenClose(openClose);
+        }
+
+        bool getOpenClose() const { return m_openClose; }
+
+    private:
+        bool m_openClose;
+
+        MsgConfigureWSScopeOpenClose(bool openClose) :
+            m_openClose(openClose)
+        {}
+    };
+
+    // ---------------------------------------------
+    class MsgConfigureWSScope : public Message {
+        MESSAGE_CLASS_DECLARATION
+
+    public:
+        static MsgConfigureWSScope* create(
+                const QString& address,
+                uint16_t port)
+        {
+            return new MsgConfigureWSScope(address, port);
+        }
+
+        const QString& getAddress() const { return m_address; }
+        uint16_t getPort() const { return m_port; }
+
+    private:
+        QString m_address;
+        uint16_t m_port;
+
+        MsgConfigureWSScope(const QString& address, uint16_t port) :
+            m_address(address),
+            m_port(port)
+        {}
+    };
+
     // ---------------------------------------------
 
     /**
@@ -1047,7 +1099,7 @@ private:
             computeLevels();
         }
 
-        bool triggered(const Sample& s, TriggerCondition& triggerCondition)
+        bool triggered(Real projected, TriggerCondition& triggerCondition) //!< sample projected by the trigger projector
         {
             if (triggerCondition.m_triggerData.m_triggerLevel != m_level)
             {
@@ -1058,13 +1110,13 @@ private:
             bool condition, trigger;
 
             if (triggerCondition.m_projector.getProjectionType() == Projector::ProjectionMagDB) {
-                condition = triggerCondition.m_projector.run(s) > m_levelPowerDB;
+                condition = projected > m_levelPowerDB;
             } else if (triggerCondition.m_projector.getProjectionType() == Projector::ProjectionMagLin) {
-                condition = triggerCondition.m_projector.run(s) > m_levelPowerLin;
+                condition = projected > m_levelPowerLin;
             } else if (triggerCondition.m_projector.getProjectionType() == Projector::ProjectionMagSq) {
-                condition = triggerCondition.m_projector.run(s) > m_levelPowerLin;
+                condition = projected > m_levelPowerLin;
             } else {
-                condition = triggerCondition.m_projector.run(s) > m_level;
+                condition = projected > m_level;
             }
 
             if (condition)
@@ -1131,7 +1183,7 @@ private:
         bool m_reset;
     };
 
-    GLScope* m_glScope;
+    GLScopeInterface* m_glScope;
     uint32_t m_preTriggerDelay;                    //!< Pre-trigger delay in number of samples
     uint32_t m_livePreTriggerDelay;                //!< Pre-trigger delay in number of samples in live mode
     std::vector<TriggerCondition*> m_triggerConditions; //!< Chain of triggers
@@ -1155,10 +1207,13 @@ private:
     int m_maxTraceDelay;                           //!< Maximum trace delay
     TriggerComparator m_triggerComparator;         //!< Compares sample level to trigger level
     QMutex m_mutex;
-    Real m_projectorCache[(int) Projector::nbProjectionTypes];
+    std::vector<Real> m_projectionBuffer;          //!< Samples of a trace projected at once
+    std::vector<Real> m_magsqBuffer;               //!< Power of the samples of a trace for the overlay
+    std::vector<Real> m_triggerProjection;         //!< Chunk of samples projected at once for the trigger
     bool m_triggerOneShot;                         //!< True when one shot mode is active
     bool m_triggerWaitForReset;                    //!< In one shot mode suspended until reset by UI
     uint32_t m_currentTraceMemoryIndex;            //!< The current index of trace in memory (0: current)
+    WSScope m_wsScope;                             //!< Streams decimated traces to remote clients
 
     /**
      * Moves on to the next trigger if any or increments trigger count if in repeat mode
@@ -1210,6 +1265,14 @@ private:
      */
     void updateGLScopeDisplay();
 
+    /**
+     * Stream the current traces buffer to the websocket clients if any
+     */
+    void streamTraces();
+
+    void handleWSOpenClose(bool openClose);
+    void handleConfigureWSScope(const QString& address, uint16_t port);
+
     /**
      * Set the actual sample rate
      */
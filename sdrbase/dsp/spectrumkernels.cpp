@@ -0,0 +1,295 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+
+#include <QDebug>
+
+#include "spectrumkernels.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SPECTRUM_X86
+#define SPECTRUM_TARGET(arch) __attribute__((target(arch)))
+#elif defined(_MSC_VER) && (defined(_M_AMD64) || defined(_M_IX86))
+#include <immintrin.h>
+#define SPECTRUM_X86
+#define SPECTRUM_TARGET(arch)
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__aarch64__)
+#include <arm_neon.h>
+#define SPECTRUM_NEON // vector division is only available on AArch64
+#endif
+
+// log2(x) = e + log2(m) with x = m.2^e and m in [sqrt(2)/2, sqrt(2)[
+// log2(m) = 2/ln(2) . atanh(y) with y = (m-1)/(m+1) in ]-0.172, 0.172[
+//         = 2/ln(2) . (y + y^3/3 + y^5/5 + y^7/7) truncated below 5e-8
+static const float log2Sqrt2 = 1.41421356f;
+static const float log2C1 = 2.88539008f; // 2/ln(2)
+static const float log2C3 = 0.96179669f; // 2/(3.ln(2))
+static const float log2C5 = 0.57707801f; // 2/(5.ln(2))
+static const float log2C7 = 0.41219858f; // 2/(7.ln(2))
+
+static void magSqGeneric(const Complex *in, Real *out, unsigned int n)
+{
+    for (unsigned int i = 0; i < n; i++) {
+        out[i] = in[i].real() * in[i].real() + in[i].imag() * in[i].imag();
+    }
+}
+
+static void log2ScaleGeneric(const Real *in, Real *out, unsigned int n, Real mult, Real ofs)
+{
+    for (unsigned int i = 0; i < n; i++)
+    {
+        quint32 bits;
+        std::memcpy(&bits, &in[i], sizeof(bits));
+        float e = (float) ((int) ((bits >> 23) & 0xff) - 127);
+        bits = (bits & 0x007fffff) | 0x3f800000;
+        float m;
+        std::memcpy(&m, &bits, sizeof(m));
+
+        if (m > log2Sqrt2)
+        {
+            m = m * 0.5f;
+            e = e + 1.0f;
+        }
+
+        float y = (m - 1.0f) / (m + 1.0f);
+        float y2 = y * y;
+        float p = ((log2C7 * y2 + log2C5) * y2 + log2C3) * y2 + log2C1;
+        out[i] = mult * (p * y + e) + ofs;
+    }
+}
+
+#if defined(SPECTRUM_X86)
+SPECTRUM_TARGET("sse2")
+static void magSqSSE2(const Complex *in, Real *out, unsigned int n)
+{
+    const float *f = (const float *) in;
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 a = _mm_loadu_ps(&f[2*i]);     // r0 i0 r1 i1
+        __m128 b = _mm_loadu_ps(&f[2*i + 4]); // r2 i2 r3 i3
+        __m128 re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(&out[i], _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im)));
+    }
+
+    magSqGeneric(in + i, out + i, n - i);
+}
+
+SPECTRUM_TARGET("sse2")
+static void log2ScaleSSE2(const Real *in, Real *out, unsigned int n, Real mult, Real ofs)
+{
+    const __m128i expMask = _mm_set1_epi32(0xff);
+    const __m128i expBias = _mm_set1_epi32(127);
+    const __m128i mantMask = _mm_set1_epi32(0x007fffff);
+    const __m128i one = _mm_set1_epi32(0x3f800000);
+    const __m128 onef = _mm_set1_ps(1.0f);
+    const __m128 halff = _mm_set1_ps(0.5f);
+    const __m128 sqrt2 = _mm_set1_ps(log2Sqrt2);
+    const __m128 c1 = _mm_set1_ps(log2C1);
+    const __m128 c3 = _mm_set1_ps(log2C3);
+    const __m128 c5 = _mm_set1_ps(log2C5);
+    const __m128 c7 = _mm_set1_ps(log2C7);
+    const __m128 multv = _mm_set1_ps(mult);
+    const __m128 ofsv = _mm_set1_ps(ofs);
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i bits = _mm_castps_si128(_mm_loadu_ps(&in[i]));
+        __m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(bits, 23), expMask), expBias));
+        __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, mantMask), one));
+        __m128 above = _mm_cmpgt_ps(m, sqrt2);
+        m = _mm_or_ps(_mm_and_ps(above, _mm_mul_ps(m, halff)), _mm_andnot_ps(above, m));
+        e = _mm_add_ps(e, _mm_and_ps(above, onef));
+        __m128 y = _mm_div_ps(_mm_sub_ps(m, onef), _mm_add_ps(m, onef));
+        __m128 y2 = _mm_mul_ps(y, y);
+        __m128 p = _mm_add_ps(_mm_mul_ps(c7, y2), c5);
+        p = _mm_add_ps(_mm_mul_ps(p, y2), c3);
+        p = _mm_add_ps(_mm_mul_ps(p, y2), c1);
+        __m128 r = _mm_add_ps(_mm_mul_ps(p, y), e);
+        _mm_storeu_ps(&out[i], _mm_add_ps(_mm_mul_ps(multv, r), ofsv));
+    }
+
+    log2ScaleGeneric(in + i, out + i, n - i, mult, ofs);
+}
+
+SPECTRUM_TARGET("avx2")
+static void magSqAVX2(const Complex *in, Real *out, unsigned int n)
+{
+    const float *f = (const float *) in;
+    unsigned int i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 a = _mm256_loadu_ps(&f[2*i]);
+        __m256 b = _mm256_loadu_ps(&f[2*i + 8]);
+        // pairwise sums within 128 bit lanes give p0 p1 p4 p5 | p2 p3 p6 p7
+        __m256 p = _mm256_hadd_ps(_mm256_mul_ps(a, a), _mm256_mul_ps(b, b));
+        p = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(p), _MM_SHUFFLE(3, 1, 2, 0)));
+        _mm256_storeu_ps(&out[i], p);
+    }
+
+    magSqSSE2(in + i, out + i, n - i);
+}
+
+SPECTRUM_TARGET("avx2")
+static void log2ScaleAVX2(const Real *in, Real *out, unsigned int n, Real mult, Real ofs)
+{
+    const __m256i expMask = _mm256_set1_epi32(0xff);
+    const __m256i expBias = _mm256_set1_epi32(127);
+    const __m256i mantMask = _mm256_set1_epi32(0x007fffff);
+    const __m256i one = _mm256_set1_epi32(0x3f800000);
+    const __m256 onef = _mm256_set1_ps(1.0f);
+    const __m256 halff = _mm256_set1_ps(0.5f);
+    const __m256 sqrt2 = _mm256_set1_ps(log2Sqrt2);
+    const __m256 c1 = _mm256_set1_ps(log2C1);
+    const __m256 c3 = _mm256_set1_ps(log2C3);
+    const __m256 c5 = _mm256_set1_ps(log2C5);
+    const __m256 c7 = _mm256_set1_ps(log2C7);
+    const __m256 multv = _mm256_set1_ps(mult);
+    const __m256 ofsv = _mm256_set1_ps(ofs);
+    unsigned int i = 0;
+
+    // no FMA so that the results are the same as with the other kernels
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i bits = _mm256_castps_si256(_mm256_loadu_ps(&in[i]));
+        __m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_and_si256(_mm256_srli_epi32(bits, 23), expMask), expBias));
+        __m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, mantMask), one));
+        __m256 above = _mm256_cmp_ps(m, sqrt2, _CMP_GT_OQ);
+        m = _mm256_blendv_ps(m, _mm256_mul_ps(m, halff), above);
+        e = _mm256_add_ps(e, _mm256_and_ps(above, onef));
+        __m256 y = _mm256_div_ps(_mm256_sub_ps(m, onef), _mm256_add_ps(m, onef));
+        __m256 y2 = _mm256_mul_ps(y, y);
+        __m256 p = _mm256_add_ps(_mm256_mul_ps(c7, y2), c5);
+        p = _mm256_add_ps(_mm256_mul_ps(p, y2), c3);
+        p = _mm256_add_ps(_mm256_mul_ps(p, y2), c1);
+        __m256 r = _mm256_add_ps(_mm256_mul_ps(p, y), e);
+        _mm256_storeu_ps(&out[i], _mm256_add_ps(_mm256_mul_ps(multv, r), ofsv));
+    }
+
+    log2ScaleSSE2(in + i, out + i, n - i, mult, ofs);
+}
+#endif // SPECTRUM_X86
+
+#if defined(SPECTRUM_NEON)
+static void magSqNEON(const Complex *in, Real *out, unsigned int n)
+{
+    const float *f = (const float *) in;
+    unsigned int i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        float32x4x2_t c = vld2q_f32(&f[2*i]); // deinterleaved real and imaginary parts
+        vst1q_f32(&out[i], vaddq_f32(vmulq_f32(c.val[0], c.val[0]), vmulq_f32(c.val[1], c.val[1])));
+    }
+
+    magSqGeneric(in + i, out + i, n - i);
+}
+
+static void log2ScaleNEON(const Real *in, Real *out, unsigned int n, Real mult, Real ofs)
+{
+    const uint32x4_t expMask = vdupq_n_u32(0xff);
+    const int32x4_t expBias = vdupq_n_s32(127);
+    const uint32x4_t mantMask = vdupq_n_u32(0x007fffff);
+    const uint32x4_t one = vdupq_n_u32(0x3f800000);
+    const float32x4_t onef = vdupq_n_f32(1.0f);
+    const float32x4_t halff = vdupq_n_f32(0.5f);
+    const float32x4_t sqrt2 = vdupq_n_f32(log2Sqrt2);
+    const float32x4_t c1 = vdupq_n_f32(log2C1);
+    const float32x4_t c3 = vdupq_n_f32(log2C3);
+    const float32x4_t c5 = vdupq_n_f32(log2C5);
+    const float32x4_t c7 = vdupq_n_f32(log2C7);
+    const float32x4_t multv = vdupq_n_f32(mult);
+    const float32x4_t ofsv = vdupq_n_f32(ofs);
+    unsigned int i = 0;
+
+    // separate multiplies and adds (no vfmaq) so that the results are the same as with the other kernels
+    for (; i + 4 <= n; i += 4)
+    {
+        uint32x4_t bits = vreinterpretq_u32_f32(vld1q_f32(&in[i]));
+        int32x4_t ei = vsubq_s32(vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(bits, 23), expMask)), expBias);
+        float32x4_t e = vcvtq_f32_s32(ei);
+        float32x4_t m = vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, mantMask), one));
+        uint32x4_t above = vcgtq_f32(m, sqrt2);
+        m = vbslq_f32(above, vmulq_f32(m, halff), m);
+        e = vaddq_f32(e, vreinterpretq_f32_u32(vandq_u32(above, vreinterpretq_u32_f32(onef))));
+        float32x4_t y = vdivq_f32(vsubq_f32(m, onef), vaddq_f32(m, onef));
+        float32x4_t y2 = vmulq_f32(y, y);
+        float32x4_t p = vaddq_f32(vmulq_f32(c7, y2), c5);
+        p = vaddq_f32(vmulq_f32(p, y2), c3);
+        p = vaddq_f32(vmulq_f32(p, y2), c1);
+        float32x4_t r = vaddq_f32(vmulq_f32(p, y), e);
+        vst1q_f32(&out[i], vaddq_f32(vmulq_f32(multv, r), ofsv));
+    }
+
+    log2ScaleGeneric(in + i, out + i, n - i, mult, ofs);
+}
+#endif // SPECTRUM_NEON
+
+const SpectrumKernels& SpectrumKernels::instance()
+{
+    static SpectrumKernels kernels;
+    return kernels;
+}
+
+SpectrumKernels::SpectrumKernels()
+{
+    getKernels(CPUFeatures::instance().getBestLevel(), m_magSq, m_log2Scale, m_level);
+    qInfo("SpectrumKernels::SpectrumKernels: using %s spectrum kernels", CPUFeatures::getLevelName(m_level));
+}
+
+void SpectrumKernels::getKernels(CPUFeatures::SIMDLevel level, MagSq& magSq, Log2Scale& log2Scale, CPUFeatures::SIMDLevel& actualLevel)
+{
+    const CPUFeatures& cpu = CPUFeatures::instance();
+    (void) cpu;
+
+#if defined(SPECTRUM_X86)
+    if (((level == CPUFeatures::SIMDAVX2) || (level == CPUFeatures::SIMDAVX512)) && cpu.hasAVX2())
+    {
+        magSq = magSqAVX2;
+        log2Scale = log2ScaleAVX2;
+        actualLevel = CPUFeatures::SIMDAVX2;
+        return;
+    }
+    else if ((level >= CPUFeatures::SIMDSSE2) && (level != CPUFeatures::SIMDNEON) && cpu.hasSSE2())
+    {
+        magSq = magSqSSE2;
+        log2Scale = log2ScaleSSE2;
+        actualLevel = CPUFeatures::SIMDSSE2;
+        return;
+    }
+#elif defined(SPECTRUM_NEON)
+    if ((level == CPUFeatures::SIMDNEON) && cpu.hasNEON())
+    {
+        magSq = magSqNEON;
+        log2Scale = log2ScaleNEON;
+        actualLevel = CPUFeatures::SIMDNEON;
+        return;
+    }
+#else
+    (void) level;
+#endif
+
+    magSq = magSqGeneric;
+    log2Scale = log2ScaleGeneric;
+    actualLevel = CPUFeatures::SIMDGeneric;
+}
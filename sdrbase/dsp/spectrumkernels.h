@@ -0,0 +1,59 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_DSP_SPECTRUMKERNELS_H_
+#define SDRBASE_DSP_SPECTRUMKERNELS_H_
+
+#include "dsp/dsptypes.h"
+#include "util/cpufeatures.h"
+#include "export.h"
+
+/**
+ * Power spectrum kernels selected at run time for the host CPU.
+ *
+ * magSq computes the power of each FFT bin: out[i] = re(in[i])^2 + im(in[i])^2
+ * log2Scale converts powers to dB: out[i] = mult * log2(in[i]) + ofs
+ *
+ * log2 is approximated from the float exponent and the atanh series of the mantissa
+ * reduced to [sqrt(2)/2, sqrt(2)[. The series is truncated below 5e-8 so that the error
+ * is that of float rounding (below 2e-5 dB) as with log2f.
+ * A zero power gives -127 instead of -infinity that is well below any display range.
+ * The SIMD kernels use the same operations in the same order as the generic one. They only differ
+ * if the compiler contracts the generic multiply-adds into fused ones.
+ */
+class SDRBASE_API SpectrumKernels
+{
+public:
+    typedef void (*MagSq)(const Complex *in, Real *out, unsigned int n);
+    typedef void (*Log2Scale)(const Real *in, Real *out, unsigned int n, Real mult, Real ofs);
+
+    static const SpectrumKernels& instance();
+
+    MagSq getMagSq() const { return m_magSq; }
+    Log2Scale getLog2Scale() const { return m_log2Scale; }
+    CPUFeatures::SIMDLevel getLevel() const { return m_level; }
+    static void getKernels(CPUFeatures::SIMDLevel level, MagSq& magSq, Log2Scale& log2Scale, CPUFeatures::SIMDLevel& actualLevel); //!< specific kernels (benchmarks). Falls back to generic if not available.
+
+private:
+    SpectrumKernels();
+
+    MagSq m_magSq;
+    Log2Scale m_log2Scale;
+    CPUFeatures::SIMDLevel m_level;
+};
+
+#endif // SDRBASE_DSP_SPECTRUMKERNELS_H_
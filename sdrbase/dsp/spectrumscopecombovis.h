@@ -8,7 +8,7 @@
 class Message;
 class ScopeVis;
 
-class SDRGUI_API SpectrumScopeComboVis : public BasebandSampleSink {
+class SDRBASE_API SpectrumScopeComboVis : public BasebandSampleSink {
 public:
 
     SpectrumScopeComboVis(SpectrumVis* spectrumVis, ScopeVis* scopeVis);
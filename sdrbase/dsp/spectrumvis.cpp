@@ -18,6 +18,8 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.          //
 ///////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+
 #include "glspectruminterface.h"
 #include "dspcommands.h"
 #include "dspengine.h"
@@ -35,6 +37,82 @@ inline double log2f(double n)
 }
 #endif
 
+namespace {
+
+// Averaging policies of SpectrumVis::averageAndSendSpectrum. process averages the bin powers in place
+// and returns true when an averaged spectrum is available.
+
+struct NoAveraging
+{
+    bool process(Real *powers, unsigned int nbBins)
+    {
+        (void) powers;
+        (void) nbBins;
+        return true;
+    }
+};
+
+struct MovingAveraging
+{
+    MovingAveraging(MovingAverage2D<double>& average) : m_average(average) {}
+
+    bool process(Real *powers, unsigned int nbBins)
+    {
+        for (unsigned int i = 0; i < nbBins; i++) {
+            powers[i] = m_average.storeAndGetAvg(powers[i], i);
+        }
+
+        m_average.nextAverage();
+        return true;
+    }
+
+    MovingAverage2D<double>& m_average;
+};
+
+struct FixedAveraging
+{
+    FixedAveraging(FixedAverage2D<double>& average) : m_average(average) {}
+
+    bool process(Real *powers, unsigned int nbBins)
+    {
+        double avg;
+
+        for (unsigned int i = 0; i < nbBins; i++)
+        {
+            if (m_average.storeAndGetAvg(avg, powers[i], i)) { // result available
+                powers[i] = avg;
+            }
+        }
+
+        return m_average.nextAverage();
+    }
+
+    FixedAverage2D<double>& m_average;
+};
+
+struct MaxAveraging
+{
+    MaxAveraging(Max2D<double>& max) : m_max(max) {}
+
+    bool process(Real *powers, unsigned int nbBins)
+    {
+        double max;
+
+        for (unsigned int i = 0; i < nbBins; i++)
+        {
+            if (m_max.storeAndGetMax(max, powers[i], i)) { // result available
+                powers[i] = max;
+            }
+        }
+
+        return m_max.nextMax();
+    }
+
+    Max2D<double>& m_max;
+};
+
+}
+
 MESSAGE_CLASS_DEFINITION(SpectrumVis::MsgConfigureSpectrumVis, Message)
 MESSAGE_CLASS_DEFINITION(SpectrumVis::MsgConfigureScalingFactor, Message)
 MESSAGE_CLASS_DEFINITION(SpectrumVis::MsgConfigureWSpectrumOpenClose, Message)
@@ -49,7 +127,10 @@ SpectrumVis::SpectrumVis(Real scalef) :
 	m_fft(nullptr),
     m_fftEngineSequence(0),
 	m_fftBuffer(MAX_FFT_SIZE),
+	m_powerBins(MAX_FFT_SIZE),
 	m_powerSpectrum(MAX_FFT_SIZE),
+	m_magSq(SpectrumKernels::instance().getMagSq()),
+	m_log2Scale(SpectrumKernels::instance().getLog2Scale()),
 	m_fftBufferFill(0),
 	m_needMoreSamples(false),
 	m_scalef(scalef),
@@ -152,170 +233,11 @@ void SpectrumVis::feed(const Complex *begin, unsigned int length)
         return;
     }
 
-    Complex c;
-    Real v;
-
-    if (m_settings.m_averagingMode == GLSpectrumSettings::AvgModeNone)
-    {
-        for (unsigned int i = 0; i < m_settings.m_fftSize; i++)
-        {
-            if (i < length) {
-                c = begin[i];
-            } else {
-                c = Complex{0,0};
-            }
-
-            v = c.real() * c.real() + c.imag() * c.imag();
-            v = m_settings.m_linear ? v/m_powFFTDiv : m_mult * log2f(v) + m_ofs;
-            m_powerSpectrum[i] = v;
-        }
-
-        // send new data to visualisation
-        if (m_glSpectrum) {
-            m_glSpectrum->newSpectrum(m_powerSpectrum, m_settings.m_fftSize);
-        }
-
-        // web socket spectrum connections
-        if (m_wsSpectrum.socketOpened())
-        {
-            m_wsSpectrum.newSpectrum(
-                m_powerSpectrum,
-                m_settings.m_fftSize,
-                m_settings.m_refLevel,
-                m_settings.m_powerRange,
-                m_centerFrequency,
-                m_sampleRate,
-                m_settings.m_linear
-            );
-        }
-    }
-    else if (m_settings.m_averagingMode == GLSpectrumSettings::AvgModeMoving)
-    {
-        for (unsigned int i = 0; i < m_settings.m_fftSize; i++)
-        {
-            if (i < length) {
-                c = begin[i];
-            } else {
-                c = Complex{0,0};
-            }
-
-            v = c.real() * c.real() + c.imag() * c.imag();
-            v = m_movingAverage.storeAndGetAvg(v, i);
-            v = m_settings.m_linear ? v/m_powFFTDiv : m_mult * log2f(v) + m_ofs;
-            m_powerSpectrum[i] = v;
-        }
-
-        // send new data to visualisation
-        if (m_glSpectrum) {
-            m_glSpectrum->newSpectrum(m_powerSpectrum, m_settings.m_fftSize);
-        }
-
-        // web socket spectrum connections
-        if (m_wsSpectrum.socketOpened())
-        {
-            m_wsSpectrum.newSpectrum(
-                m_powerSpectrum,
-                m_settings.m_fftSize,
-                m_settings.m_refLevel,
-                m_settings.m_powerRange,
-                m_centerFrequency,
-                m_sampleRate,
-                m_settings.m_linear
-            );
-        }
-
-        m_movingAverage.nextAverage();
-    }
-    else if (m_settings.m_averagingMode == GLSpectrumSettings::AvgModeFixed)
-    {
-        double avg;
-
-        for (unsigned int i = 0; i < m_settings.m_fftSize; i++)
-        {
-            if (i < length) {
-                c = begin[i];
-            } else {
-                c = Complex{0,0};
-            }
-
-            v = c.real() * c.real() + c.imag() * c.imag();
-
-            // result available
-            if (m_fixedAverage.storeAndGetAvg(avg, v, i))
-            {
-                avg = m_settings.m_linear ? avg/m_powFFTDiv : m_mult * log2f(avg) + m_ofs;
-                m_powerSpectrum[i] = avg;
-            }
-        }
-
-        // result available
-        if (m_fixedAverage.nextAverage())
-        {
-            // send new data to visualisation
-            if (m_glSpectrum) {
-                m_glSpectrum->newSpectrum(m_powerSpectrum, m_settings.m_fftSize);
-            }
-
-            // web socket spectrum connections
-            if (m_wsSpectrum.socketOpened())
-            {
-                m_wsSpectrum.newSpectrum(
-                    m_powerSpectrum,
-                    m_settings.m_fftSize,
-                    m_settings.m_refLevel,
-                    m_settings.m_powerRange,
-                    m_centerFrequency,
-                    m_sampleRate,
-                    m_settings.m_linear
-                );
-            }
-        }
-    }
-    else if (m_settings.m_averagingMode == GLSpectrumSettings::AvgModeMax)
-    {
-        double max;
-
-        for (unsigned int i = 0; i < m_settings.m_fftSize; i++)
-        {
-            if (i < length) {
-                c = begin[i];
-            } else {
-                c = Complex{0,0};
-            }
-
-            v = c.real() * c.real() + c.imag() * c.imag();
-
-            // result available
-            if (m_max.storeAndGetMax(max, v, i))
-            {
-                max = m_settings.m_linear ? max/m_powFFTDiv : m_mult * log2f(max) + m_ofs;
-                m_powerSpectrum[i] = max;
-            }
-        }
-
-        // result available
-        if (m_max.nextMax())
-        {
-            // send new data to visualisation
-            if (m_glSpectrum) {
-                m_glSpectrum->newSpectrum(m_powerSpectrum, m_settings.m_fftSize);
-            }
-
-            // web socket spectrum connections
-            if (m_wsSpectrum.socketOpened())
-            {
-                m_wsSpectrum.newSpectrum(
-                    m_powerSpectrum,
-                    m_settings.m_fftSize,
-                    m_settings.m_refLevel,
-                    m_settings.m_powerRange,
-                    m_centerFrequency,
-                    m_sampleRate,
-                    m_settings.m_linear
-                );
-            }
-        }
-    }
+    unsigned int fftSize = m_settings.m_fftSize;
+    unsigned int nbBins = length < fftSize ? length : fftSize;
+    m_magSq(begin, &m_powerBins[0], nbBins);
+    std::fill(m_powerBins.begin() + nbBins, m_powerBins.begin() + fftSize, 0.0f);
+    processPowerBins(fftSize, false, false);
 
     m_mutex.unlock();
 }
@@ -360,270 +282,18 @@ void SpectrumVis::feed(const SampleVector::const_iterator& cbegin, const SampleV
 
 			// extract power spectrum and reorder buckets
 			const Complex* fftOut = m_fft->out();
-			Complex c;
-			Real v;
 			std::size_t halfSize = m_settings.m_fftSize / 2;
 
-			if (m_settings.m_averagingMode == GLSpectrumSettings::AvgModeNone)
-			{
-                m_specMax = 0.0f;
-
-                if ( positiveOnly )
-                {
-                    for (std::size_t i = 0; i < halfSize; i++)
-                    {
-                        c = fftOut[i];
-                        v = c.real() * c.real() + c.imag() * c.imag();
-                        m_specMax = v > m_specMax ? v : m_specMax;
-                        v = m_settings.m_linear ? v/m_powFFTDiv : m_mult * log2f(v) + m_ofs;
-                        m_powerSpectrum[i * 2] = v;
-                        m_powerSpectrum[i * 2 + 1] = v;
-                    }
-                }
-                else
-                {
-                    for (std::size_t i = 0; i < halfSize; i++)
-                    {
-                        c = fftOut[i + halfSize];
-                        v = c.real() * c.real() + c.imag() * c.imag();
-                        m_specMax = v > m_specMax ? v : m_specMax;
-                        v = m_settings.m_linear ? v/m_powFFTDiv : m_mult * log2f(v) + m_ofs;
-                        m_powerSpectrum[i] = v;
-
-                        c = fftOut[i];
-                        v = c.real() * c.real() + c.imag() * c.imag();
-                        m_specMax = v > m_specMax ? v : m_specMax;
-                        v = m_settings.m_linear ? v/m_powFFTDiv : m_mult * log2f(v) + m_ofs;
-                        m_powerSpectrum[i + halfSize] = v;
-                    }
-                }
-
-                // send new data to visualisation
-                if (m_glSpectrum) {
-                    m_glSpectrum->newSpectrum(m_powerSpectrum, m_settings.m_fftSize);
-                }
-
-                // web socket spectrum connections
-                if (m_wsSpectrum.socketOpened())
-                {
-                    m_wsSpectrum.newSpectrum(
-                        m_powerSpectrum,
-                        m_settings.m_fftSize,
-                        m_settings.m_refLevel,
-                        m_settings.m_powerRange,
-                        m_centerFrequency,
-                        m_sampleRate,
-                        m_settings.m_linear
-                    );
-                }
-			}
-			else if (m_settings.m_averagingMode == GLSpectrumSettings::AvgModeMoving)
+			if (positiveOnly)
 			{
-                m_specMax = 0.0f;
-
-	            if ( positiveOnly )
-	            {
-	                for (std::size_t i = 0; i < halfSize; i++)
-	                {
-	                    c = fftOut[i];
-	                    v = c.real() * c.real() + c.imag() * c.imag();
-	                    v = m_movingAverage.storeAndGetAvg(v, i);
-                        m_specMax = v > m_specMax ? v : m_specMax;
-	                    v = m_settings.m_linear ? v/m_powFFTDiv : m_mult * log2f(v) + m_ofs;
-	                    m_powerSpectrum[i * 2] = v;
-	                    m_powerSpectrum[i * 2 + 1] = v;
-	                }
-	            }
-	            else
-	            {
-	                for (std::size_t i = 0; i < halfSize; i++)
-	                {
-	                    c = fftOut[i + halfSize];
-	                    v = c.real() * c.real() + c.imag() * c.imag();
-	                    v = m_movingAverage.storeAndGetAvg(v, i+halfSize);
-                        m_specMax = v > m_specMax ? v : m_specMax;
-	                    v = m_settings.m_linear ? v/m_powFFTDiv : m_mult * log2f(v) + m_ofs;
-	                    m_powerSpectrum[i] = v;
-
-	                    c = fftOut[i];
-	                    v = c.real() * c.real() + c.imag() * c.imag();
-	                    v = m_movingAverage.storeAndGetAvg(v, i);
-                        m_specMax = v > m_specMax ? v : m_specMax;
-	                    v = m_settings.m_linear ? v/m_powFFTDiv : m_mult * log2f(v) + m_ofs;
-	                    m_powerSpectrum[i + halfSize] = v;
-	                }
-	            }
-
-	            // send new data to visualisation
-                if (m_glSpectrum) {
-    	            m_glSpectrum->newSpectrum(m_powerSpectrum, m_settings.m_fftSize);
-                }
-
-                // web socket spectrum connections
-                if (m_wsSpectrum.socketOpened())
-                {
-                    m_wsSpectrum.newSpectrum(
-                        m_powerSpectrum,
-                        m_settings.m_fftSize,
-                        m_settings.m_refLevel,
-                        m_settings.m_powerRange,
-                        m_centerFrequency,
-                        m_sampleRate,
-                        m_settings.m_linear
-                    );
-                }
-
-	            m_movingAverage.nextAverage();
+                m_magSq(fftOut, &m_powerBins[0], halfSize);
+                processPowerBins(halfSize, true, true);
 			}
-			else if (m_settings.m_averagingMode == GLSpectrumSettings::AvgModeFixed)
+			else
 			{
-			    double avg;
-                Real specMax = 0.0f;
-
-                if ( positiveOnly )
-                {
-                    for (std::size_t i = 0; i < halfSize; i++)
-                    {
-                        c = fftOut[i];
-                        v = c.real() * c.real() + c.imag() * c.imag();
-
-                        // result available
-                        if (m_fixedAverage.storeAndGetAvg(avg, v, i))
-                        {
-                            specMax = avg > specMax ? avg : specMax;
-                            avg = m_settings.m_linear ? avg/m_powFFTDiv : m_mult * log2f(avg) + m_ofs;
-                            m_powerSpectrum[i * 2] = avg;
-                            m_powerSpectrum[i * 2 + 1] = avg;
-                        }
-                    }
-                }
-                else
-                {
-                    for (std::size_t i = 0; i < halfSize; i++)
-                    {
-                        c = fftOut[i + halfSize];
-                        v = c.real() * c.real() + c.imag() * c.imag();
-
-                        // result available
-                        if (m_fixedAverage.storeAndGetAvg(avg, v, i+halfSize))
-                        {
-                            specMax = avg > specMax ? avg : specMax;
-                            avg = m_settings.m_linear ? avg/m_powFFTDiv : m_mult * log2f(avg) + m_ofs;
-                            m_powerSpectrum[i] = avg;
-                        }
-
-                        c = fftOut[i];
-                        v = c.real() * c.real() + c.imag() * c.imag();
-
-                        // result available
-                        if (m_fixedAverage.storeAndGetAvg(avg, v, i))
-                        {
-                            specMax = avg > specMax ? avg : specMax;
-                            avg = m_settings.m_linear ? avg/m_powFFTDiv : m_mult * log2f(avg) + m_ofs;
-                            m_powerSpectrum[i + halfSize] = avg;
-                        }
-                    }
-                }
-
-                // result available
-                if (m_fixedAverage.nextAverage())
-                {
-                    m_specMax = specMax;
-
-                    // send new data to visualisation
-                    if (m_glSpectrum) {
-                        m_glSpectrum->newSpectrum(m_powerSpectrum, m_settings.m_fftSize);
-                    }
-
-                    // web socket spectrum connections
-                    if (m_wsSpectrum.socketOpened())
-                    {
-                        m_wsSpectrum.newSpectrum(
-                            m_powerSpectrum,
-                            m_settings.m_fftSize,
-                            m_settings.m_refLevel,
-                            m_settings.m_powerRange,
-                            m_centerFrequency,
-                            m_sampleRate,
-                            m_settings.m_linear
-                        );
-                    }
-                }
-			}
-			else if (m_settings.m_averagingMode == GLSpectrumSettings::AvgModeMax)
-			{
-			    double max;
-                Real specMax = 0.0f;
-
-                if ( positiveOnly )
-                {
-                    for (std::size_t i = 0; i < halfSize; i++)
-                    {
-                        c = fftOut[i];
-                        v = c.real() * c.real() + c.imag() * c.imag();
-
-                        // result available
-                        if (m_max.storeAndGetMax(max, v, i))
-                        {
-                            specMax = max > specMax ? max : specMax;
-                            max = m_settings.m_linear ? max/m_powFFTDiv : m_mult * log2f(max) + m_ofs;
-                            m_powerSpectrum[i * 2] = max;
-                            m_powerSpectrum[i * 2 + 1] = max;
-                        }
-                    }
-                }
-                else
-                {
-                    for (std::size_t i = 0; i < halfSize; i++)
-                    {
-                        c = fftOut[i + halfSize];
-                        v = c.real() * c.real() + c.imag() * c.imag();
-
-                        // result available
-                        if (m_max.storeAndGetMax(max, v, i+halfSize))
-                        {
-                            specMax = max > specMax ? max : specMax;
-                            max = m_settings.m_linear ? max/m_powFFTDiv : m_mult * log2f(max) + m_ofs;
-                            m_powerSpectrum[i] = max;
-                        }
-
-                        c = fftOut[i];
-                        v = c.real() * c.real() + c.imag() * c.imag();
-
-                        // result available
-                        if (m_max.storeAndGetMax(max, v, i))
-                        {
-                            specMax = max > specMax ? max : specMax;
-                            max = m_settings.m_linear ? max/m_powFFTDiv : m_mult * log2f(max) + m_ofs;
-                            m_powerSpectrum[i + halfSize] = max;
-                        }
-                    }
-                }
-
-                // result available
-                if (m_max.nextMax())
-                {
-                    m_specMax = specMax;
-
-                    // send new data to visualisation
-                    if (m_glSpectrum) {
-                        m_glSpectrum->newSpectrum(m_powerSpectrum, m_settings.m_fftSize);
-                    }
-
-                    // web socket spectrum connections
-                    if (m_wsSpectrum.socketOpened())
-                    {
-                        m_wsSpectrum.newSpectrum(
-                            m_powerSpectrum,
-                            m_settings.m_fftSize,
-                            m_settings.m_refLevel,
-                            m_settings.m_powerRange,
-                            m_centerFrequency,
-                            m_sampleRate,
-                            m_settings.m_linear
-                        );
-                    }
-                }
+                m_magSq(&fftOut[halfSize], &m_powerBins[0], halfSize);
+                m_magSq(fftOut, &m_powerBins[halfSize], halfSize);
+                processPowerBins(m_settings.m_fftSize, false, true);
 			}
 
 			// advance buffer respecting the fft overlap factor
@@ -649,6 +319,81 @@ void SpectrumVis::feed(const SampleVector::const_iterator& cbegin, const SampleV
 	 m_mutex.unlock();
 }
 
+void SpectrumVis::processPowerBins(unsigned int nbBins, bool positiveOnly, bool updateSpecMax)
+{
+    if (m_settings.m_averagingMode == GLSpectrumSettings::AvgModeMoving)
+    {
+        MovingAveraging averaging(m_movingAverage);
+        averageAndSendSpectrum(averaging, nbBins, positiveOnly, updateSpecMax);
+    }
+    else if (m_settings.m_averagingMode == GLSpectrumSettings::AvgModeFixed)
+    {
+        FixedAveraging averaging(m_fixedAverage);
+        averageAndSendSpectrum(averaging, nbBins, positiveOnly, updateSpecMax);
+    }
+    else if (m_settings.m_averagingMode == GLSpectrumSettings::AvgModeMax)
+    {
+        MaxAveraging averaging(m_max);
+        averageAndSendSpectrum(averaging, nbBins, positiveOnly, updateSpecMax);
+    }
+    else
+    {
+        NoAveraging averaging;
+        averageAndSendSpectrum(averaging, nbBins, positiveOnly, updateSpecMax);
+    }
+}
+
+template<class Averaging>
+void SpectrumVis::averageAndSendSpectrum(Averaging& averaging, unsigned int nbBins, bool positiveOnly, bool updateSpecMax)
+{
+    if (!averaging.process(&m_powerBins[0], nbBins)) { // no result available yet
+        return;
+    }
+
+    if (updateSpecMax) {
+        m_specMax = *std::max_element(m_powerBins.begin(), m_powerBins.begin() + nbBins);
+    }
+
+    if (m_settings.m_linear)
+    {
+        for (unsigned int i = 0; i < nbBins; i++) {
+            m_powerSpectrum[i] = m_powerBins[i] / m_powFFTDiv;
+        }
+    }
+    else
+    {
+        m_log2Scale(&m_powerBins[0], &m_powerSpectrum[0], nbBins, m_mult, m_ofs);
+    }
+
+    if (positiveOnly) // each bin is displayed twice. Going backwards does not overwrite bins not yet expanded.
+    {
+        for (int i = nbBins - 1; i >= 0; i--)
+        {
+            m_powerSpectrum[i * 2 + 1] = m_powerSpectrum[i];
+            m_powerSpectrum[i * 2] = m_powerSpectrum[i];
+        }
+    }
+
+    // send new data to visualisation
+    if (m_glSpectrum) {
+        m_glSpectrum->newSpectrum(m_powerSpectrum, m_settings.m_fftSize);
+    }
+
+    // web socket spectrum connections
+    if (m_wsSpectrum.socketOpened())
+    {
+        m_wsSpectrum.newSpectrum(
+            m_powerSpectrum,
+            m_settings.m_fftSize,
+            m_settings.m_refLevel,
+            m_settings.m_powerRange,
+            m_centerFrequency,
+            m_sampleRate,
+            m_settings.m_linear
+        );
+    }
+}
+
 void SpectrumVis::start()
 {
     setRunning(true);
@@ -27,6 +27,7 @@
 #include "dsp/fftengine.h"
 #include "dsp/fftwindow.h"
 #include "dsp/glspectrumsettings.h"
+#include "dsp/spectrumkernels.h"
 #include "export.h"
 #include "util/message.h"
 #include "util/movingaverage2d.h"
@@ -177,7 +178,10 @@ private:
     unsigned int m_fftEngineSequence;
 
 	std::vector<Complex> m_fftBuffer;
+	std::vector<Real> m_powerBins;     //!< power of the FFT bins in display order before averaging
 	std::vector<Real> m_powerSpectrum;
+	SpectrumKernels::MagSq m_magSq;
+	SpectrumKernels::Log2Scale m_log2Scale;
 
     GLSpectrumSettings m_settings;
 	std::size_t m_overlapSize;
@@ -203,6 +207,9 @@ private:
 	QMutex m_mutex;
 
     void setRunning(bool running) { m_running = running; }
+    void processPowerBins(unsigned int nbBins, bool positiveOnly, bool updateSpecMax);
+    template<class Averaging>
+    void averageAndSendSpectrum(Averaging& averaging, unsigned int nbBins, bool positiveOnly, bool updateSpecMax);
     void applySettings(const GLSpectrumSettings& settings, bool force = false);
     void handleConfigureDSP(uint64_t centerFrequency, int sampleRate);
     void handleScalef(Real scalef);
@@ -34,6 +34,8 @@ Preset::Preset(const Preset& other) :
 	m_spectrumConfig(other.m_spectrumConfig),
 	m_dcOffsetCorrection(other.m_dcOffsetCorrection),
 	m_iqImbalanceCorrection(other.m_iqImbalanceCorrection),
+	m_sharedChannelizer(other.m_sharedChannelizer),
+	m_sharedChannelizerLog2Subbands(other.m_sharedChannelizerLog2Subbands),
 	m_channelConfigs(other.m_channelConfigs),
 	m_deviceConfigs(other.m_deviceConfigs),
 	m_layout(other.m_layout)
@@ -50,6 +52,8 @@ void Preset::resetToDefaults()
 	m_channelConfigs.clear();
 	m_dcOffsetCorrection = false;
 	m_iqImbalanceCorrection = false;
+	m_sharedChannelizer = false;
+	m_sharedChannelizerLog2Subbands = 6;
 }
 
 QByteArray Preset::serialize() const
@@ -69,6 +73,8 @@ QByteArray Preset::serialize() const
 	s.writeBlob(5, m_spectrumConfig);
     s.writeBool(6, m_presetType == PresetSource);
 	s.writeS32(7, (int) m_presetType);
+	s.writeBool(8, m_sharedChannelizer);
+	s.writeU32(9, m_sharedChannelizerLog2Subbands);
 
 	s.writeS32(20, m_deviceConfigs.size());
 
@@ -132,6 +138,10 @@ bool Preset::deserialize(const QByteArray& data)
             m_presetType = tmpBool ? PresetSource : PresetSink;
         }
 
+        d.readBool(8, &m_sharedChannelizer, false);
+        d.readU32(9, &m_sharedChannelizerLog2Subbands, 6);
+        m_sharedChannelizerLog2Subbands = m_sharedChannelizerLog2Subbands < 2 ? 2 : m_sharedChannelizerLog2Subbands > 10 ? 10 : m_sharedChannelizerLog2Subbands;
+
 //		qDebug("Preset::deserialize: m_group: %s mode: %s m_description: %s m_centerFrequency: %llu",
 //				qPrintable(m_group),
 //				m_sourcePreset ? "Rx" : "Tx",
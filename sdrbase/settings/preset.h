@@ -96,6 +96,11 @@ public:
 	bool hasIQImbalanceCorrection() const { return m_iqImbalanceCorrection; }
     void setIQImbalanceCorrection(bool iqImbalanceCorrection) { m_iqImbalanceCorrection = iqImbalanceCorrection; }
 
+	bool hasSharedChannelizer() const { return m_sharedChannelizer; }
+	void setSharedChannelizer(bool sharedChannelizer) { m_sharedChannelizer = sharedChannelizer; }
+	unsigned int getSharedChannelizerLog2Subbands() const { return m_sharedChannelizerLog2Subbands; }
+	void setSharedChannelizerLog2Subbands(unsigned int log2Subbands) { m_sharedChannelizerLog2Subbands = log2Subbands; }
+
 	void setLayout(const QByteArray& data) { m_layout = data; }
 	const QByteArray& getLayout() const { return m_layout; }
 
@@ -157,6 +162,10 @@ protected:
 	bool m_dcOffsetCorrection;
 	bool m_iqImbalanceCorrection;
 
+	// filterbank shared by the Rx channels
+	bool m_sharedChannelizer;
+	unsigned int m_sharedChannelizerLog2Subbands;
+
 	// channels and configurations
 	ChannelConfigs m_channelConfigs;
 
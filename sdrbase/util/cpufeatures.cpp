@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#if defined(_MSC_VER) && (defined(_M_AMD64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+#include "cpufeatures.h"
+
+const CPUFeatures& CPUFeatures::instance()
+{
+    static CPUFeatures features;
+    return features;
+}
+
+CPUFeatures::CPUFeatures() :
+    m_sse2(false),
+    m_sse41(false),
+    m_avx2(false),
+    m_avx512(false),
+    m_neon(false)
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    m_sse2 = __builtin_cpu_supports("sse2");
+    m_sse41 = __builtin_cpu_supports("sse4.1");
+    m_avx2 = __builtin_cpu_supports("avx2");
+    m_avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#elif defined(_MSC_VER) && (defined(_M_AMD64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 0);
+    int nIds = info[0];
+
+    if (nIds >= 1)
+    {
+        __cpuidex(info, 1, 0);
+        m_sse2 = (info[3] & (1<<26)) != 0;
+        m_sse41 = (info[2] & (1<<19)) != 0;
+        bool osxsave = (info[2] & (1<<27)) != 0;
+        unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+        bool ymmSaved = (xcr0 & 0x6) == 0x6;
+        bool zmmSaved = (xcr0 & 0xe6) == 0xe6;
+
+        if (nIds >= 7)
+        {
+            __cpuidex(info, 7, 0);
+            m_avx2 = ymmSaved && ((info[1] & (1<<5)) != 0);
+            m_avx512 = zmmSaved && ((info[1] & (1<<16)) != 0) && ((info[1] & (1<<30)) != 0);
+        }
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(__aarch64__)
+    m_neon = true; // NEON is part of the ABI when the compiler targets it
+#endif
+}
+
+CPUFeatures::SIMDLevel CPUFeatures::getBestLevel() const
+{
+    if (m_avx512) {
+        return SIMDAVX512;
+    } else if (m_avx2) {
+        return SIMDAVX2;
+    } else if (m_sse41) {
+        return SIMDSSE41;
+    } else if (m_sse2) {
+        return SIMDSSE2;
+    } else if (m_neon) {
+        return SIMDNEON;
+    } else {
+        return SIMDGeneric;
+    }
+}
+
+const char *CPUFeatures::getLevelName(SIMDLevel level)
+{
+    switch (level)
+    {
+    case SIMDSSE2:
+        return "SSE2";
+    case SIMDSSE41:
+        return "SSE4.1";
+    case SIMDAVX2:
+        return "AVX2";
+    case SIMDAVX512:
+        return "AVX-512";
+    case SIMDNEON:
+        return "NEON";
+    case SIMDGeneric:
+    default:
+        return "generic";
+    }
+}
@@ -0,0 +1,60 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_UTIL_CPUFEATURES_H_
+#define INCLUDE_UTIL_CPUFEATURES_H_
+
+#include "export.h"
+
+/**
+ * SIMD instruction sets available on the host CPU detected at run time.
+ * This is what allows a binary built for the generic target to select the best kernels.
+ */
+class SDRBASE_API CPUFeatures
+{
+public:
+    enum SIMDLevel
+    {
+        SIMDGeneric,
+        SIMDSSE2,
+        SIMDSSE41,
+        SIMDAVX2,
+        SIMDAVX512,
+        SIMDNEON
+    };
+
+    static const CPUFeatures& instance();
+
+    bool hasSSE2() const { return m_sse2; }
+    bool hasSSE41() const { return m_sse41; }
+    bool hasAVX2() const { return m_avx2; }
+    bool hasAVX512() const { return m_avx512; } //!< AVX-512 F and BW
+    bool hasNEON() const { return m_neon; }
+    SIMDLevel getBestLevel() const;
+    static const char *getLevelName(SIMDLevel level);
+
+private:
+    CPUFeatures();
+
+    bool m_sse2;
+    bool m_sse41;
+    bool m_avx2;
+    bool m_avx512;
+    bool m_neon;
+};
+
+#endif /* INCLUDE_UTIL_CPUFEATURES_H_ */
@@ -24,10 +24,23 @@
 const char* Message::m_identifier = 0;
 
 Message::Message() :
-	m_destination(0)
+	m_destination(0),
+	m_next(nullptr)
 {
 }
 
+Message::Message(const Message& other) :
+	m_destination(other.m_destination),
+	m_next(nullptr)
+{
+}
+
+Message& Message::operator=(const Message& other)
+{
+	m_destination = other.m_destination;
+	return *this;
+}
+
 Message::~Message()
 {
 }
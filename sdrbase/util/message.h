@@ -20,13 +20,17 @@
 #define INCLUDE_MESSAGE_H
 
 #include <stdlib.h>
+#include <atomic>
 #include "export.h"
 
 class SDRBASE_API Message {
 public:
 	Message();
+	Message(const Message& other);
 	virtual ~Message();
 
+	Message& operator=(const Message& other);
+
 	virtual const char* getIdentifier() const;
 	virtual bool matchIdentifier(const char* identifier) const;
 	static bool match(const Message* message);
@@ -38,6 +42,10 @@ protected:
 	// addressing
 	static const char* m_identifier;
 	void* m_destination;
+
+private:
+	friend class MessageQueue;
+	std::atomic<Message*> m_next; //!< link in a MessageQueue. Not copied.
 };
 
 #define MESSAGE_CLASS_DECLARATION \
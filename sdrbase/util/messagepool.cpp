@@ -0,0 +1,126 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <new>
+
+#include "util/messagepool.h"
+
+MessagePool::MessagePool(std::size_t blockSize, unsigned int maxBlocks) :
+    m_blockSize(blockSize),
+    m_maxBlocks(maxBlocks),
+    m_blocks(new Header*[maxBlocks]),
+    m_nbBlocks(0),
+    m_free(m_noIndex),
+    m_nbFree(0)
+{
+}
+
+MessagePool::~MessagePool()
+{
+    quint32 nbBlocks = m_nbBlocks.load();
+
+    for (quint32 i = 0; i < nbBlocks; i++)
+    {
+        m_blocks[i]->~Header();
+        ::operator delete(m_blocks[i]);
+    }
+
+    delete[] m_blocks;
+}
+
+MessagePool::Header *MessagePool::newBlock(std::size_t size)
+{
+    Header *header = new (::operator new(m_headerSize + size)) Header();
+    header->m_index = m_noIndex;
+
+    if (size == m_blockSize)
+    {
+        quint32 index = m_nbBlocks.load(std::memory_order_relaxed);
+
+        while ((index < m_maxBlocks) && !m_nbBlocks.compare_exchange_weak(index, index + 1, std::memory_order_relaxed)) {
+        }
+
+        if (index < m_maxBlocks)
+        {
+            // published by the push of the first deallocation
+            m_blocks[index] = header;
+            header->m_index = index;
+        }
+    }
+
+    return header;
+}
+
+void *MessagePool::allocate(std::size_t size)
+{
+    Header *header = nullptr;
+
+    if (size == m_blockSize)
+    {
+        quint64 head = m_free.load(std::memory_order_acquire);
+
+        while ((quint32) head != m_noIndex)
+        {
+            // the block may be popped by another thread meanwhile in which case the tag has
+            // changed and the next index read here is not used
+            Header *first = m_blocks[(quint32) head];
+            quint64 next = ((head >> 32) + 1) << 32 | first->m_next.load(std::memory_order_relaxed);
+
+            if (m_free.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire))
+            {
+                header = first;
+                m_nbFree.fetch_sub(1, std::memory_order_relaxed);
+                break;
+            }
+        }
+    }
+
+    if (!header) {
+        header = newBlock(size);
+    }
+
+    return (char *) header + m_headerSize;
+}
+
+void MessagePool::deallocate(void *p, std::size_t size)
+{
+    (void) size;
+
+    if (!p) {
+        return;
+    }
+
+    Header *header = (Header *) ((char *) p - m_headerSize);
+
+    if (header->m_index == m_noIndex)
+    {
+        header->~Header();
+        ::operator delete(header);
+        return;
+    }
+
+    quint64 head = m_free.load(std::memory_order_relaxed);
+    quint64 next;
+
+    do
+    {
+        header->m_next.store((quint32) head, std::memory_order_relaxed);
+        next = ((head >> 32) + 1) << 32 | header->m_index;
+    } while (!m_free.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed));
+
+    m_nbFree.fetch_add(1, std::memory_order_relaxed);
+}
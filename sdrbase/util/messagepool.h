@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDE_MESSAGEPOOL_H
+#define INCLUDE_MESSAGEPOOL_H
+
+#include <atomic>
+#include <cstddef>
+
+#include <QtGlobal>
+
+#include "export.h"
+
+/**
+ * Free list of fixed size blocks for the messages of one class. Messages are created in
+ * one thread and deleted in another one so the free list is a lock free stack. Blocks
+ * are numbered and the head of the stack is the index of the first free block tagged
+ * with a counter so that a block popped and pushed back in between is detected (ABA).
+ * At most maxBlocks blocks are pooled. Other blocks and the blocks of another size
+ * (derived classes) go to the global heap.
+ */
+class SDRBASE_API MessagePool
+{
+public:
+    MessagePool(std::size_t blockSize, unsigned int maxBlocks = 1024);
+    ~MessagePool(); //!< only when no message of the pool exists
+
+    void *allocate(std::size_t size);
+    void deallocate(void *p, std::size_t size);
+    unsigned int getNbFree() const { return m_nbFree.load(std::memory_order_relaxed); }
+
+private:
+    struct Header
+    {
+        std::atomic<quint32> m_next; //!< index of the next free block
+        quint32 m_index;             //!< index of this block or m_noIndex if not pooled
+    };
+
+    static const quint32 m_noIndex = 0xffffffff;
+    static const std::size_t m_headerSize = ((sizeof(Header) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t)) * alignof(std::max_align_t);
+
+    std::size_t m_blockSize;
+    unsigned int m_maxBlocks;
+    Header **m_blocks;
+    std::atomic<quint32> m_nbBlocks;
+    std::atomic<quint64> m_free; //!< ABA tag in the upper 32 bits, index of the first free block in the lower ones
+    std::atomic<unsigned int> m_nbFree;
+
+    Header *newBlock(std::size_t size);
+};
+
+/**
+ * Allocation of the messages of a class in its pool. Use in the class declaration after
+ * MESSAGE_CLASS_DECLARATION and MESSAGE_POOL_DEFINITION(Name) in the implementation file.
+ * The pool is never destroyed so that messages still queued at exit can be deleted.
+ */
+#define MESSAGE_POOL_DECLARATION \
+	public: \
+		static void* operator new(std::size_t size) { return getPool().allocate(size); } \
+		static void operator delete(void* p, std::size_t size) { getPool().deallocate(p, size); } \
+		static MessagePool& getPool(); \
+	private:
+
+#define MESSAGE_POOL_DEFINITION(Name) \
+	MessagePool& Name::getPool() { \
+		static MessagePool *pool = new MessagePool(sizeof(Name)); \
+		return *pool; \
+	}
+
+#endif // INCLUDE_MESSAGEPOOL_H
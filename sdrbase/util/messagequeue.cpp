@@ -15,17 +15,20 @@
 // You should have received a copy of the GNU General Public License             //
 // along with this program. If not, see <http://www.gnu.org/licenses/>.          //
 ///////////////////////////////////////////////////////////////////////////////////
-
 #include <QDebug>
+#include <QMetaMethod>
 #include <QMutexLocker>
 #include "util/messagequeue.h"
 #include "util/message.h"
 
 MessageQueue::MessageQueue(QObject* parent) :
 	QObject(parent),
-	m_lock(QMutex::Recursive),
-	m_queue()
+	m_size(0),
+	m_signalPending(false),
+	m_stub(new Message())
 {
+	m_head.store(m_stub);
+	m_tail = m_stub;
 }
 
 MessageQueue::~MessageQueue()
@@ -37,18 +40,21 @@ MessageQueue::~MessageQueue()
 		qDebug() << "MessageQueue::~MessageQueue: message: " << message->getIdentifier() << " was still in queue";
 		delete message;
 	}
+
+	delete m_stub;
 }
 
 void MessageQueue::push(Message* message, bool emitSignal)
 {
 	if (message)
 	{
-		m_lock.lock();
-		m_queue.append(message);
-		m_lock.unlock();
+		m_size.fetch_add(1, std::memory_order_relaxed);
+		pushNode(message);
 	}
 
-	if (emitSignal)
+	// the consumer has not yet emptied the queue since the last signal
+	// so it will see this message without another wakeup
+	if (emitSignal && !m_signalPending.exchange(true))
 	{
 		emit messageEnqueued();
 	}
@@ -56,30 +62,90 @@ void MessageQueue::push(Message* message, bool emitSignal)
 
 Message* MessageQueue::pop()
 {
-	QMutexLocker locker(&m_lock);
+	QMutexLocker locker(&m_popLock);
+	Message* message = popNode();
 
-	if (m_queue.isEmpty())
+	if (!message)
 	{
-		return 0;
+		// Re-arm the signal then look again for a message pushed by a producer
+		// that saw the signal still pending. Both sides use sequentially
+		// consistent operations so that either this second look finds the
+		// message or the producer emits the signal.
+		m_signalPending.store(false);
+		message = popNode();
 	}
-	else
-	{
-		return m_queue.takeFirst();
+
+	if (message) {
+		m_size.fetch_sub(1, std::memory_order_relaxed);
 	}
+
+	return message;
 }
 
 int MessageQueue::size()
 {
-	QMutexLocker locker(&m_lock);
-
-	return m_queue.size();
+	return m_size.load(std::memory_order_relaxed);
 }
 
 void MessageQueue::clear()
 {
-	QMutexLocker locker(&m_lock);
+	Message* message;
+
+	while ((message = pop()) != 0) {
+		delete message;
+	}
+}
+
+void MessageQueue::connectNotify(const QMetaMethod& signal)
+{
+	// A new receiver must be woken up by the next push like with a signal per push
+	if (signal == QMetaMethod::fromSignal(&MessageQueue::messageEnqueued)) {
+		m_signalPending.store(false);
+	}
+}
+
+void MessageQueue::pushNode(Message* message)
+{
+	message->m_next.store(nullptr, std::memory_order_relaxed);
+	Message* prev = m_head.exchange(message, std::memory_order_acq_rel);
+	prev->m_next.store(message); // a message is visible to the consumer from here
+}
+
+Message* MessageQueue::popNode()
+{
+	Message* tail = m_tail;
+	Message* next = tail->m_next.load();
+
+	if (tail == m_stub)
+	{
+		if (!next) {
+			return nullptr;
+		}
+
+		m_tail = next;
+		tail = next;
+		next = next->m_next.load();
+	}
+
+	if (next)
+	{
+		m_tail = next;
+		return tail;
+	}
+
+	if (tail != m_head.load()) {
+		return nullptr; // a producer is between the exchange of m_head and the link to its message
+	}
+
+	// tail is the last message: put the stub behind it so that it can be unlinked
+	pushNode(m_stub);
+	next = tail->m_next.load();
+
+	if (next)
+	{
+		m_tail = next;
+		return tail;
+	}
 
-    while (!m_queue.isEmpty()) {
-        delete m_queue.takeFirst();
-    }
+	return nullptr;
 }
@@ -19,13 +19,21 @@
 #ifndef INCLUDE_MESSAGEQUEUE_H
 #define INCLUDE_MESSAGEQUEUE_H
 
+#include <atomic>
+
 #include <QObject>
-#include <QQueue>
 #include <QMutex>
 #include "export.h"
 
 class Message;
 
+/**
+ * Intrusive multiple producers single consumer queue (D. Vyukov) linked through Message::m_next.
+ * push() is lock free and may be called from any thread. The messageEnqueued signal is
+ * coalesced: it is emitted only by the first push after the consumer has found the queue
+ * empty so the consumer must pop messages until pop() returns null. Consumers are serialized
+ * by a mutex that is not contended in the usual case of a single consumer.
+ */
 class SDRBASE_API MessageQueue : public QObject {
 	Q_OBJECT
 
@@ -42,9 +50,19 @@ public:
 signals:
 	void messageEnqueued();
 
+protected:
+	void connectNotify(const QMetaMethod& signal) override;
+
 private:
-	QMutex m_lock;
-	QQueue<Message*> m_queue;
+	alignas(64) std::atomic<Message*> m_head; //!< last pushed message (producers)
+	std::atomic<int> m_size;
+	std::atomic<bool> m_signalPending;        //!< a signal was emitted and the consumer has not found the queue empty since
+	alignas(64) Message* m_tail;              //!< next message to pop (consumer)
+	Message* m_stub;
+	QMutex m_popLock;
+
+	void pushNode(Message* message);
+	Message* popNode();
 };
 
 #endif // INCLUDE_MESSAGEQUEUE_H
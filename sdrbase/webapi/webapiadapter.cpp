@@ -35,6 +35,8 @@
 #include "dsp/dspdevicesinkengine.h"
 #include "dsp/dspdevicemimoengine.h"
 #include "dsp/dspengine.h"
+#include "dsp/hbfirkernels.h"
+#include "dsp/polyphasechannelizer.h"
 #include "plugin/pluginapi.h"
 #include "plugin/pluginmanager.h"
 #include "channel/channelapi.h"
@@ -60,6 +62,7 @@
 #include "SWGDeviceState.h"
 #include "SWGDeviceReport.h"
 #include "SWGDeviceActions.h"
+#include "SWGSharedChannelizerSettings.h"
 #include "SWGChannelsDetail.h"
 #include "SWGChannelSettings.h"
 #include "SWGChannelReport.h"
@@ -106,6 +109,7 @@ int WebAPIAdapter::instanceSummary(
     *response.getArchitecture() = QString(QSysInfo::currentCpuArchitecture());
     *response.getOs() = QString(QSysInfo::prettyProductName());
 #endif
+    *response.getSimdKernels() = QString(CPUFeatures::getLevelName(HBFIRKernels::instance().getLevel()));
 
     SWGSDRangel::SWGLoggingInfo *logging = response.getLogging();
     logging->init();
@@ -1469,6 +1473,89 @@ int WebAPIAdapter::devicesetFocusPatch(
     }
 }
 
+int WebAPIAdapter::devicesetChannelizerGet(
+        int deviceSetIndex,
+        SWGSDRangel::SWGSharedChannelizerSettings& response,
+        SWGSDRangel::SWGErrorResponse& error)
+{
+    if ((deviceSetIndex >= 0) && (deviceSetIndex < (int) m_mainCore->m_deviceSets.size()))
+    {
+        DeviceSet *deviceSet = m_mainCore->m_deviceSets[deviceSetIndex];
+
+        if (deviceSet->m_deviceSourceEngine) // Single Rx
+        {
+            response.init();
+            response.setEnable(deviceSet->m_deviceAPI->getSharedChannelizer() ? 1 : 0);
+            response.setLog2Subbands(deviceSet->m_deviceAPI->getSharedChannelizerLog2Subbands());
+            return 200;
+        }
+        else
+        {
+            error.init();
+            *error.getMessage() = QString("Device set %1 is not a single Rx device set").arg(deviceSetIndex);
+            return 400;
+        }
+    }
+    else
+    {
+        error.init();
+        *error.getMessage() = QString("There is no device set with index %1").arg(deviceSetIndex);
+        return 404;
+    }
+}
+
+int WebAPIAdapter::devicesetChannelizerPutPatch(
+        int deviceSetIndex,
+        bool force,
+        const QStringList& channelizerKeys,
+        SWGSDRangel::SWGSharedChannelizerSettings& response,
+        SWGSDRangel::SWGErrorResponse& error)
+{
+    if ((deviceSetIndex >= 0) && (deviceSetIndex < (int) m_mainCore->m_deviceSets.size()))
+    {
+        DeviceSet *deviceSet = m_mainCore->m_deviceSets[deviceSetIndex];
+
+        if (deviceSet->m_deviceSourceEngine) // Single Rx
+        {
+            bool enable = deviceSet->m_deviceAPI->getSharedChannelizer();
+            int log2Subbands = deviceSet->m_deviceAPI->getSharedChannelizerLog2Subbands();
+
+            if (force || channelizerKeys.contains("enable")) {
+                enable = response.getEnable() != 0;
+            }
+            if (force || channelizerKeys.contains("log2Subbands")) {
+                log2Subbands = response.getLog2Subbands();
+            }
+
+            if ((log2Subbands < (int) PolyphaseChannelizer::m_minLog2Subbands) || (log2Subbands > (int) PolyphaseChannelizer::m_maxLog2Subbands))
+            {
+                error.init();
+                *error.getMessage() = QString("log2Subbands must be between %1 and %2")
+                    .arg(PolyphaseChannelizer::m_minLog2Subbands).arg(PolyphaseChannelizer::m_maxLog2Subbands);
+                return 400;
+            }
+
+            deviceSet->m_deviceAPI->configureSharedChannelizer(enable, log2Subbands);
+            response.init();
+            response.setEnable(enable ? 1 : 0);
+            response.setLog2Subbands(log2Subbands);
+            return 200;
+        }
+        else
+        {
+            error.init();
+            *error.getMessage() = QString("Device set %1 is not a single Rx device set").arg(deviceSetIndex);
+            return 400;
+        }
+    }
+    else
+    {
+        error.init();
+        *error.getMessage() = QString("There is no device set with index %1").arg(deviceSetIndex);
+        return 404;
+    }
+}
+
 int WebAPIAdapter::devicesetDevicePut(
         int deviceSetIndex,
         SWGSDRangel::SWGDeviceListItem& query,
@@ -218,6 +218,18 @@ public:
             SWGSDRangel::SWGSuccessResponse& response,
             SWGSDRangel::SWGErrorResponse& error);
 
+    virtual int devicesetChannelizerGet(
+            int deviceSetIndex,
+            SWGSDRangel::SWGSharedChannelizerSettings& response,
+            SWGSDRangel::SWGErrorResponse& error);
+
+    virtual int devicesetChannelizerPutPatch(
+            int deviceSetIndex,
+            bool force,
+            const QStringList& channelizerKeys,
+            SWGSDRangel::SWGSharedChannelizerSettings& response,
+            SWGSDRangel::SWGErrorResponse& error);
+
     virtual int devicesetDevicePut(
             int deviceSetIndex,
             SWGSDRangel::SWGDeviceListItem& query,
@@ -0,0 +1,178 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+
+#include <QtWebSockets>
+#include <QHostAddress>
+#include <QDebug>
+
+#include "wsscope.h"
+
+WSScope::WSScope(QObject *parent) :
+    QObject(parent),
+    m_listeningAddress(QHostAddress::LocalHost),
+    m_port(8888),
+    m_webSocketServer(nullptr),
+    m_nbPoints(512),
+    m_minIntervalMs(100)
+{
+    m_timer.start();
+}
+
+WSScope::~WSScope()
+{
+    closeSocket();
+}
+
+void WSScope::openSocket()
+{
+    m_webSocketServer = new QWebSocketServer(
+        QStringLiteral("Scope Server"),
+        QWebSocketServer::NonSecureMode,
+        this);
+
+    if (m_webSocketServer->listen(m_listeningAddress, m_port))
+    {
+        qDebug() << "WSScope::openSocket: scope server listening at " << m_listeningAddress.toString() << " on port " << m_port;
+        connect(m_webSocketServer, &QWebSocketServer::newConnection, this, &WSScope::onNewConnection);
+    }
+    else
+    {
+        qInfo("WSScope::openSocket: cannot start scope server at %s on port %u", qPrintable(m_listeningAddress.toString()), m_port);
+    }
+}
+
+void WSScope::closeSocket()
+{
+    if (m_webSocketServer)
+    {
+        delete m_webSocketServer;
+        m_webSocketServer = nullptr;
+    }
+}
+
+bool WSScope::socketOpened()
+{
+    return m_webSocketServer && m_webSocketServer->isListening();
+}
+
+QString WSScope::getWebSocketIdentifier(QWebSocket *peer)
+{
+    return QStringLiteral("%1:%2").arg(peer->peerAddress().toString(), QString::number(peer->peerPort()));
+}
+
+void WSScope::onNewConnection()
+{
+    auto pSocket = m_webSocketServer->nextPendingConnection();
+    qDebug() << " WSScope::onNewConnection: " << getWebSocketIdentifier(pSocket) << " connected";
+    pSocket->setParent(this);
+
+    connect(pSocket, &QWebSocket::textMessageReceived, this, &WSScope::processClientMessage);
+    connect(pSocket, &QWebSocket::disconnected, this, &WSScope::socketDisconnected);
+
+    m_clients << pSocket;
+}
+
+void WSScope::processClientMessage(const QString &message)
+{
+     qDebug() << "WSScope::processClientMessage: " << message;
+}
+
+void WSScope::socketDisconnected()
+{
+    QWebSocket *pClient = qobject_cast<QWebSocket *>(sender());
+    qDebug() << getWebSocketIdentifier(pClient) << " disconnected";
+
+    if (pClient)
+    {
+        m_clients.removeAll(pClient);
+        pClient->deleteLater();
+    }
+}
+
+/**
+ * Frame layout (host byte order):
+ * - int nbTraces, int nbPoints, int traceSize, int sampleRate, uint32 preTrigger, int64 frame time (ms)
+ * - then for each trace: int projection type followed by nbPoints (min, max) float pairs
+ */
+void WSScope::newTraces(
+    const std::vector<float *>& traces,
+    int traceSize,
+    const std::vector<Projector::ProjectionType>& projectionTypes,
+    int sampleRate,
+    uint32_t preTrigger
+)
+{
+    if (m_clients.isEmpty() || (traceSize <= 0) || (m_timer.elapsed() < m_minIntervalMs)) {
+        return;
+    }
+
+    qint64 elapsed = m_timer.restart();
+    int nbTraces = traces.size();
+    int nbPoints = std::min(m_nbPoints, traceSize);
+    QByteArray payload;
+    QBuffer buffer(&payload);
+    buffer.open(QIODevice::WriteOnly);
+    buffer.write((char*) &nbTraces, sizeof(int));
+    buffer.write((char*) &nbPoints, sizeof(int));
+    buffer.write((char*) &traceSize, sizeof(int));
+    buffer.write((char*) &sampleRate, sizeof(int));
+    buffer.write((char*) &preTrigger, sizeof(uint32_t));
+    buffer.write((char*) &elapsed, sizeof(int64_t));
+
+    for (int i = 0; i < nbTraces; i++)
+    {
+        int projectionType = i < (int) projectionTypes.size() ? (int) projectionTypes[i] : (int) Projector::ProjectionReal;
+        decimate(traces[i], traceSize, nbPoints, m_minMax);
+        buffer.write((char*) &projectionType, sizeof(int));
+        buffer.write((char*) m_minMax.data(), 2*nbPoints*sizeof(float));
+    }
+
+    buffer.close();
+
+    for (QWebSocket *pClient : qAsConst(m_clients)) {
+        pClient->sendBinaryMessage(payload);
+    }
+}
+
+void WSScope::decimate(const float *trace, int traceSize, int nbPoints, std::vector<float>& minMax)
+{
+    minMax.assign(2*nbPoints, 0.0f);
+
+    if (!trace) {
+        return;
+    }
+
+    for (int k = 0; k < nbPoints; k++)
+    {
+        int begin = ((int64_t) k * traceSize) / nbPoints;
+        int end = ((int64_t) (k + 1) * traceSize) / nbPoints;
+        float vmin = trace[2*begin + 1]; // trace is made of (x, y) pairs
+        float vmax = vmin;
+
+        for (int i = begin + 1; i < end; i++)
+        {
+            float v = trace[2*i + 1];
+            vmin = v < vmin ? v : vmin;
+            vmax = v > vmax ? v : vmax;
+        }
+
+        minMax[2*k] = vmin;
+        minMax[2*k + 1] = vmax;
+    }
+}
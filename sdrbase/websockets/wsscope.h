@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB.                                  //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SDRBASE_WEBSOCKETS_WSSCOPE_H_
+#define SDRBASE_WEBSOCKETS_WSSCOPE_H_
+
+#include <vector>
+
+#include <QObject>
+#include <QList>
+#include <QElapsedTimer>
+#include <QHostAddress>
+
+#include "dsp/projector.h"
+
+#include "export.h"
+
+class QWebSocketServer;
+class QWebSocket;
+
+/**
+ * Streams scope traces to websocket clients. Each trace is reduced to at most m_nbPoints
+ * min/max pairs of its display values so that the payload does not depend on the trace length,
+ * and frames are sent at most every m_minIntervalMs milliseconds.
+ * It is owned by ScopeVis and opened through the settings of the channel owning the scope.
+ */
+class SDRBASE_API WSScope : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WSScope(QObject *parent = nullptr);
+    ~WSScope() override;
+
+    void openSocket();
+    void closeSocket();
+    bool socketOpened();
+    void setListeningAddress(const QString& address) { m_listeningAddress.setAddress(address); }
+    void setPort(quint16 port) { m_port = port; }
+    void setNbPoints(int nbPoints) { m_nbPoints = nbPoints; }
+    void setMinInterval(int minIntervalMs) { m_minIntervalMs = minIntervalMs; }
+    /**
+     * Traces are given as in ScopeVis: traceSize (x, y) pairs per trace with y in [-1, 1]
+     */
+    void newTraces(
+        const std::vector<float *>& traces,
+        int traceSize,
+        const std::vector<Projector::ProjectionType>& projectionTypes,
+        int sampleRate,
+        uint32_t preTrigger
+    );
+
+private slots:
+    void onNewConnection();
+    void processClientMessage(const QString &message);
+    void socketDisconnected();
+
+private:
+    QHostAddress m_listeningAddress;
+    quint16 m_port;
+    QWebSocketServer* m_webSocketServer;
+    QList<QWebSocket*> m_clients;
+    QElapsedTimer m_timer;
+    int m_nbPoints;      //!< Maximum number of min/max pairs per trace
+    int m_minIntervalMs; //!< Minimum time between two frames
+    std::vector<float> m_minMax; //!< Decimated trace
+
+    static QString getWebSocketIdentifier(QWebSocket *peer);
+    static void decimate(const float *trace, int traceSize, int nbPoints, std::vector<float>& minMax);
+};
+
+#endif // SDRBASE_WEBSOCKETS_WSSCOPE_H_
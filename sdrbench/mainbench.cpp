@@ -17,21 +17,62 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.          //
 ///////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <cmath>
+
+#include <QCoreApplication>
 #include <QDebug>
 #include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
 
 #include "ambe/ambeengine.h"
+#include "dsp/channelsamplesink.h"
+#include "dsp/downchannelizer.h"
+#include "dsp/iqcorrector.h"
+#include "dsp/hbfirkernels.h"
+#include "util/cpufeatures.h"
 
 #include "mainbench.h"
 
 MainBench *MainBench::m_instance = 0;
 
+const MainBench::TestEntry MainBench::m_tests[] = {
+    {"decimateii",      &MainBench::testDecimateII,      true},
+    {"decimateif",      &MainBench::testDecimateIF,      true},
+    {"decimatefi",      &MainBench::testDecimateFI,      true},
+    {"decimateff",      &MainBench::testDecimateFF,      true},
+    {"decimateinfii",   &MainBench::testDecimateInfII,   true},
+    {"decimatesupii",   &MainBench::testDecimateSupII,   true},
+    {"ambe",            &MainBench::testAMBE,            false}, // needs AMBE devices
+    {"iqcorr",          &MainBench::testIQCorrection,    true},
+    {"decimatekernels", &MainBench::testDecimateKernels, true},
+    {"downchannelizer", &MainBench::testDownChannelizer, true},
+    {"upchannelizer",   &MainBench::testUpChannelizer,   true},
+    {"fftfilt",         &MainBench::testFFTFilter,       true},
+    {"spectrumvis",     &MainBench::testSpectrumVis,     true},
+    {"interpolator",    &MainBench::testInterpolator,    true},
+    {"samplesinkfifo",  &MainBench::testSampleSinkFifo,  true},
+    {"demodsinks",      &MainBench::testDemodSinks,      true},
+    {"fec",             &MainBench::testFEC,             true},
+    {"adsb",            &MainBench::testADSB,            true},
+    {"ldpc",            &MainBench::testLDPC,            true},
+    {"viterbi",         &MainBench::testViterbi,         true},
+    {"audiomix",        &MainBench::testAudioMix,        true},
+    {"iqcodec",         &MainBench::testIQCodec,         true},
+    {"messagequeue",    &MainBench::testMessageQueue,    true},
+    {"projector",       &MainBench::testProjector,       true},
+};
+
 MainBench::MainBench(qtwebapp::LoggerWithFile *logger, const ParserBench& parser, QObject *parent) :
     QObject(parent),
     m_logger(logger),
     m_parser(parser),
     m_uniform_distribution_f(-1.0, 1.0),
-    m_uniform_distribution_s16(-2048, 2047)
+    m_uniform_distribution_s16(-2048, 2047),
+    m_nbFailures(0)
 {
     qDebug() << "MainBench::MainBench: start";
     m_instance = this;
@@ -41,76 +82,111 @@ MainBench::MainBench(qtwebapp::LoggerWithFile *logger, const ParserBench& parser
 MainBench::~MainBench()
 {}
 
+QStringList MainBench::getTestNames()
+{
+    QStringList names;
+
+    for (const TestEntry& test : m_tests) {
+        names.append(test.m_name);
+    }
+
+    names.append("all");
+    return names;
+}
+
 void MainBench::run()
 {
     qDebug() << "MainBench::run: parameters:"
         << " testStr: " << m_parser.getTestStr()
-        << " testType: " << (int) m_parser.getTestType()
         << " nsamples: " << m_parser.getNbSamples()
         << " repet: " << m_parser.getRepetition()
         << " log2f: " << m_parser.getLog2Factor();
 
-    if (m_parser.getTestType() == ParserBench::TestDecimatorsII) {
-        testDecimateII();
-    } else if (m_parser.getTestType() == ParserBench::TestDecimatorsInfII) {
-        testDecimateII(ParserBench::TestDecimatorsInfII);
-    } else if (m_parser.getTestType() == ParserBench::TestDecimatorsSupII) {
-        testDecimateII(ParserBench::TestDecimatorsSupII);
-    } else if (m_parser.getTestType() == ParserBench::TestDecimatorsIF) {
-        testDecimateIF();
-    } else if (m_parser.getTestType() == ParserBench::TestDecimatorsFI) {
-        testDecimateFI();
-    } else if (m_parser.getTestType() == ParserBench::TestDecimatorsFF) {
-        testDecimateFF();
-    } else if (m_parser.getTestType() == ParserBench::TestAMBE) {
-        testAMBE();
-    } else {
-        qDebug() << "MainBench::run: unknown test type: " << m_parser.getTestType();
+    const QString& testStr = m_parser.getTestStr();
+
+    if (testStr == "all")
+    {
+        for (const TestEntry& test : m_tests)
+        {
+            if (test.m_inAll) {
+                runTest(test);
+            }
+        }
+    }
+    else
+    {
+        const TestEntry *found = &m_tests[0]; // decimateii by default
+
+        for (const TestEntry& test : m_tests)
+        {
+            if (testStr == test.m_name)
+            {
+                found = &test;
+                break;
+            }
+        }
+
+        if (testStr != found->m_name) {
+            qWarning() << "MainBench::run: unknown test: " << testStr << " running " << found->m_name;
+        }
+
+        runTest(*found);
+    }
+
+    writeJsonResults();
+
+    if (m_nbFailures > 0) {
+        qWarning("MainBench::run: %u check(s) failed", m_nbFailures);
     }
 
     emit finished();
 }
 
-void MainBench::testDecimateII(ParserBench::TestType testType)
+void MainBench::runTest(const TestEntry& test)
+{
+    m_currentTest = test.m_name;
+    (this->*test.m_test)();
+}
+
+void MainBench::testDecimateII()
+{
+    benchDecimateII("MainBench::testDecimateII", &MainBench::decimateII);
+}
+
+void MainBench::testDecimateInfII()
+{
+    benchDecimateII("MainBench::testDecimateInfII", &MainBench::decimateInfII);
+}
+
+void MainBench::testDecimateSupII()
+{
+    benchDecimateII("MainBench::testDecimateSupII", &MainBench::decimateSupII);
+}
+
+void MainBench::benchDecimateII(const QString& prefix, void (MainBench::*decimate)(const qint16 *buf, int len))
 {
     QElapsedTimer timer;
     qint64 nsecs = 0;
 
-    qDebug() << "MainBench::testDecimateII: create test data";
+    qDebug() << prefix << ": create test data";
 
     qint16 *buf = new qint16[m_parser.getNbSamples()*2];
     m_convertBuffer.resize(m_parser.getNbSamples()/(1<<m_parser.getLog2Factor()));
     auto my_rand = std::bind(m_uniform_distribution_s16, m_generator);
     std::generate(buf, buf + m_parser.getNbSamples()*2 - 1, my_rand);
 
-    qDebug() << "MainBench::testDecimateII: run test";
+    qDebug() << prefix << ": run test";
 
     for (uint32_t i = 0; i < m_parser.getRepetition(); i++)
     {
-        switch (testType)
-        {
-        case ParserBench::TestDecimatorsInfII:
-            timer.start();
-            decimateInfII(buf, m_parser.getNbSamples()*2);
-            nsecs += timer.nsecsElapsed();
-            break;
-        case ParserBench::TestDecimatorsSupII:
-            timer.start();
-            decimateSupII(buf, m_parser.getNbSamples()*2);
-            nsecs += timer.nsecsElapsed();
-            break;
-        case ParserBench::TestDecimatorsII:
-        default:
-            timer.start();
-            decimateII(buf, m_parser.getNbSamples()*2);
-            nsecs += timer.nsecsElapsed();
-            break;
-        }
+        timer.start();
+        (this->*decimate)(buf, m_parser.getNbSamples()*2);
+        nsecs += timer.nsecsElapsed();
     }
 
-    printResults("MainBench::testDecimateII", nsecs);
+    printResults(prefix, nsecs);
 
-    qDebug() << "MainBench::testDecimateII: cleanup test data";
+    qDebug() << prefix << ": cleanup test data";
     delete[] buf;
 }
 
@@ -207,6 +283,268 @@ void MainBench::testAMBE()
     }
 }
 
+void MainBench::testDecimateKernels()
+{
+    // collects the channel samples to compare kernels
+    class KernelChannelSink : public ChannelSampleSink
+    {
+    public:
+        virtual void feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end) {
+            m_samples.insert(m_samples.end(), begin, end);
+        }
+        SampleVector m_samples;
+    };
+
+    QElapsedTimer timer;
+    qint64 nsecs;
+    unsigned int nbSamples = m_parser.getNbSamples();
+    int basebandSampleRate = 61440000;
+    int channelSampleRate = basebandSampleRate >> m_parser.getLog2Factor();
+    unsigned int pipelineMaxWorkers = DownChannelizer::getPipelineMaxWorkers();
+
+    qDebug() << "MainBench::testDecimateKernels: create test data";
+
+    SampleVector samples;
+    createTestSamples(samples, nbSamples);
+    SampleVector reference;
+
+    qInfo("MainBench::testDecimateKernels: best kernel for this CPU: %s",
+        CPUFeatures::getLevelName(HBFIRKernels::instance().getLevel()));
+
+    CPUFeatures::SIMDLevel levels[] = {
+        CPUFeatures::SIMDGeneric,
+        CPUFeatures::SIMDSSE41,
+        CPUFeatures::SIMDAVX2,
+        CPUFeatures::SIMDAVX512,
+        CPUFeatures::SIMDNEON
+    };
+    std::vector<CPUFeatures::SIMDLevel> levelsRun;
+    DownChannelizer::setPipelineMaxWorkers(0); // time the filter chain in this thread
+
+    for (unsigned int l = 0; l < sizeof(levels)/sizeof(levels[0]); l++)
+    {
+        CPUFeatures::SIMDLevel actualLevel = HBFIRKernels::getAvailableLevel(levels[l]);
+
+        if (std::find(levelsRun.begin(), levelsRun.end(), actualLevel) != levelsRun.end()) {
+            continue; // not available on this CPU
+        }
+
+        levelsRun.push_back(actualLevel);
+        KernelChannelSink sink;
+        nsecs = 0;
+
+        for (uint32_t i = 0; i < m_parser.getRepetition(); i++)
+        {
+            // new channelizer so that every kernel starts from the same filter state
+            DownChannelizer channelizer(&sink);
+            channelizer.setKernelLevel(actualLevel);
+            channelizer.setBasebandSampleRate(basebandSampleRate);
+            channelizer.setChannelization(channelSampleRate, channelSampleRate / 4);
+            sink.m_samples.clear();
+            timer.start();
+
+            for (unsigned int b = 0; b < nbSamples; b += m_blockSize) {
+                channelizer.feed(samples.begin() + b, samples.begin() + (b + m_blockSize < nbSamples ? b + m_blockSize : nbSamples));
+            }
+
+            nsecs += timer.nsecsElapsed();
+        }
+
+        printResults(QString("MainBench::testDecimateKernels: %1").arg(CPUFeatures::getLevelName(actualLevel)), nsecs);
+
+        if (reference.size() == 0)
+        {
+            reference = sink.m_samples;
+        }
+        else
+        {
+            unsigned int mismatches = reference.size() == sink.m_samples.size() ? 0 : reference.size();
+
+            for (unsigned int i = 0; (mismatches == 0) && (i < reference.size()); i++)
+            {
+                if ((reference[i].real() != sink.m_samples[i].real()) || (reference[i].imag() != sink.m_samples[i].imag())) {
+                    mismatches++;
+                }
+            }
+
+            checkResult(QString("MainBench::testDecimateKernels: %1").arg(CPUFeatures::getLevelName(actualLevel)),
+                mismatches == 0,
+                QString("%1 samples differ from generic").arg(mismatches));
+        }
+    }
+
+    DownChannelizer::setPipelineMaxWorkers(pipelineMaxWorkers);
+}
+
+void MainBench::testIQCorrection()
+{
+    QElapsedTimer timer;
+    qint64 nsecs;
+    unsigned int nbSamples = m_parser.getNbSamples();
+    unsigned int blockSize = 1 << (m_parser.getLog2Factor() + 10); // typical device FIFO read sizes
+
+    qDebug() << "MainBench::testIQCorrection: create test data";
+
+    // tone plus noise with DC offsets, a phase error of 3 degrees and an amplitude error of 1 dB
+    SampleVector src(nbSamples);
+    std::normal_distribution<float> noise(0.0f, 0.05f);
+    float phaseError = 3.0f * (M_PI / 180.0f);
+    float ampError = 0.891f;
+
+    for (unsigned int i = 0; i < nbSamples; i++)
+    {
+        float phase = std::fmod(0.9 * i, 2.0 * M_PI); // keeps the phase error significant in float
+        float re = std::cos(phase) + noise(m_generator);
+        float im = ampError * std::sin(phase + phaseError) + noise(m_generator);
+        src[i].setReal(re * 0.5f * SDR_RX_SCALEF + 0.02f * SDR_RX_SCALEF);
+        src[i].setImag(im * 0.5f * SDR_RX_SCALEF - 0.01f * SDR_RX_SCALEF);
+    }
+
+    qDebug() << "MainBench::testIQCorrection: run test";
+
+    SampleVector ref;
+    nsecs = 0;
+
+    for (uint32_t i = 0; i < m_parser.getRepetition(); i++)
+    {
+        ref = src;
+        m_iBeta.reset();
+        m_qBeta.reset();
+        m_avgII.reset();
+        m_avgIQ.reset();
+        m_avgPhi.reset();
+        m_avgII2.reset();
+        m_avgQQ2.reset();
+        m_avgAmp.reset();
+        timer.start();
+        iqCorrectionsReference(ref);
+        nsecs += timer.nsecsElapsed();
+    }
+
+    printResults("MainBench::testIQCorrection: per sample", nsecs);
+
+    CPUFeatures::SIMDLevel levels[] = {CPUFeatures::SIMDGeneric, CPUFeatures::SIMDSSE41, CPUFeatures::SIMDAVX2, CPUFeatures::SIMDNEON};
+    std::vector<CPUFeatures::SIMDLevel> levelsRun;
+    IQCorrector iqCorrector;
+    SampleVector out;
+    SampleVector generic;
+
+    for (unsigned int l = 0; l < sizeof(levels)/sizeof(levels[0]); l++)
+    {
+        iqCorrector.setKernelLevel(levels[l]);
+
+        if (std::find(levelsRun.begin(), levelsRun.end(), iqCorrector.getKernelLevel()) != levelsRun.end()) {
+            continue; // not available on this CPU
+        }
+
+        levelsRun.push_back(iqCorrector.getKernelLevel());
+        nsecs = 0;
+
+        for (uint32_t i = 0; i < m_parser.getRepetition(); i++)
+        {
+            out = src;
+            iqCorrector.reset();
+            timer.start();
+
+            for (unsigned int b = 0; b < nbSamples; b += blockSize) {
+                iqCorrector.process(out.begin() + b, out.begin() + std::min(b + blockSize, nbSamples), true);
+            }
+
+            nsecs += timer.nsecsElapsed();
+        }
+
+        printResults(QString("MainBench::testIQCorrection: %1").arg(CPUFeatures::getLevelName(iqCorrector.getKernelLevel())), nsecs);
+
+        // the estimation is per block so the output differs from the per sample one: check what is left of the
+        // imbalance once settled and that the SIMD kernels give the generic output
+        double dcI, dcQ, phi, amp;
+        iqResidual(out, dcI, dcQ, phi, amp);
+        bool settled = (std::abs(dcI) < 1e-4) && (std::abs(dcQ) < 1e-4) && (std::abs(phi) < 1e-3) && (std::abs(amp - 1.0) < 1e-3);
+        int maxDiff = 0;
+
+        if (iqCorrector.getKernelLevel() == CPUFeatures::SIMDGeneric)
+        {
+            generic = out;
+        }
+        else
+        {
+            for (unsigned int i = 0; i < nbSamples; i++)
+            {
+                maxDiff = std::max(maxDiff, std::abs(out[i].real() - generic[i].real()));
+                maxDiff = std::max(maxDiff, std::abs(out[i].imag() - generic[i].imag()));
+            }
+        }
+
+        checkResult(QString("MainBench::testIQCorrection: %1").arg(CPUFeatures::getLevelName(iqCorrector.getKernelLevel())),
+            settled && (maxDiff <= 1),
+            QString("residual dc: %1 %2 phi: %3 amp: %4 max difference to generic: %5")
+                .arg(dcI).arg(dcQ).arg(phi).arg(amp).arg(maxDiff));
+    }
+
+    double dcI, dcQ, phi, amp;
+    iqResidual(ref, dcI, dcQ, phi, amp);
+    qDebug() << "MainBench::testIQCorrection: per sample residual dc:" << dcI << dcQ << "phi:" << phi << "amp:" << amp;
+}
+
+void MainBench::iqResidual(const SampleVector& samples, double& dcI, double& dcQ, double& phi, double& amp)
+{
+    // moments of the second half in full scale units
+    double n = samples.size() - samples.size()/2;
+    double si = 0, sq = 0, sii = 0, siq = 0, sqq = 0;
+
+    for (unsigned int i = samples.size()/2; i < samples.size(); i++)
+    {
+        double xi = samples[i].real() / SDR_RX_SCALED;
+        double xq = samples[i].imag() / SDR_RX_SCALED;
+        si += xi;
+        sq += xq;
+        sii += xi*xi;
+        siq += xi*xq;
+        sqq += xq*xq;
+    }
+
+    dcI = si / n;
+    dcQ = sq / n;
+    double varI = sii / n - dcI*dcI;
+    phi = (siq / n - dcI*dcQ) / varI;
+    amp = std::sqrt((sqq / n - dcQ*dcQ) / varI);
+}
+
+void MainBench::iqCorrectionsReference(SampleVector& samples)
+{
+    for (SampleVector::iterator it = samples.begin(); it < samples.end(); it++)
+    {
+        m_iBeta(it->real());
+        m_qBeta(it->imag());
+
+        float xi = (it->m_real - (int32_t) m_iBeta) / SDR_RX_SCALEF;
+        float xq = (it->m_imag - (int32_t) m_qBeta) / SDR_RX_SCALEF;
+
+        m_avgII(xi*xi);
+        m_avgIQ(xi*xq);
+
+        if (m_avgII.asDouble() != 0) {
+            m_avgPhi(m_avgIQ.asDouble()/m_avgII.asDouble());
+        }
+
+        float& yi = xi;
+        float yq = xq - m_avgPhi.asDouble()*xi;
+
+        m_avgII2(yi*yi);
+        m_avgQQ2(yq*yq);
+
+        if (m_avgQQ2.asDouble() != 0) {
+            m_avgAmp(sqrt(m_avgII2.asDouble() / m_avgQQ2.asDouble()));
+        }
+
+        float& zi = yi;
+        float zq = m_avgAmp.asDouble() * yq;
+
+        it->m_real = zi * SDR_RX_SCALEF;
+        it->m_imag = zq * SDR_RX_SCALEF;
+    }
+}
+
 void MainBench::decimateII(const qint16* buf, int len)
 {
     SampleVector::iterator it = m_convertBuffer.begin();
@@ -399,10 +737,86 @@ void MainBench::decimateFF(const float *buf, int len)
     }
 }
 
+void MainBench::createTestSamples(SampleVector& samples, unsigned int nbSamples)
+{
+    std::normal_distribution<float> noise(0.0f, 0.01f);
+    float phase = 0.0f;
+    samples.resize(nbSamples);
+
+    for (unsigned int i = 0; i < nbSamples; i++)
+    {
+        // 1 kHz tone with 5 kHz deviation at 48 kS/s nominal rate
+        phase += (5000.0f / 48000.0f) * 2.0f * M_PI * std::sin((1000.0f / 48000.0f) * 2.0f * M_PI * (i % 48000));
+        phase = phase > M_PI ? phase - 2.0f * M_PI : phase < -M_PI ? phase + 2.0f * M_PI : phase;
+        samples[i].setReal((0.5f * std::cos(phase) + noise(m_generator)) * SDR_RX_SCALEF);
+        samples[i].setImag((0.5f * std::sin(phase) + noise(m_generator)) * SDR_RX_SCALEF);
+    }
+}
+
 void MainBench::printResults(const QString& prefix, qint64 nsecs)
 {
-    double ratekSs = (m_parser.getNbSamples()*m_parser.getRepetition() / (double) nsecs) * 1e6;
+    quint64 nbSamples = (quint64) m_parser.getNbSamples() * m_parser.getRepetition();
+    double ratekSs = (nbSamples / (double) nsecs) * 1e6;
+    double nsPerSample = nbSamples == 0 ? 0.0 : nsecs / (double) nbSamples;
     QDebug info = qInfo();
     info.noquote();
-    info << tr("%1: ran test in %L2 ns - sample rate: %3 kS/s").arg(prefix).arg(nsecs).arg(ratekSs);
+    info << tr("%1: ran test in %L2 ns - sample rate: %3 kS/s - %4 ns/S").arg(prefix).arg(nsecs).arg(ratekSs).arg(nsPerSample);
+
+    QJsonObject result;
+    result.insert("test", m_currentTest);
+    result.insert("name", prefix);
+    result.insert("samples", (double) nbSamples);
+    result.insert("nsecs", (double) nsecs);
+    result.insert("samplesPerSecond", ratekSs * 1e3);
+    result.insert("nsPerSample", nsPerSample);
+    m_jsonResults.append(result);
+}
+
+bool MainBench::checkResult(const QString& prefix, bool passed, const QString& details)
+{
+    if (passed)
+    {
+        qInfo("%s: passed: %s", qPrintable(prefix), qPrintable(details));
+    }
+    else
+    {
+        qWarning("%s: FAILED: %s", qPrintable(prefix), qPrintable(details));
+        m_nbFailures++;
+    }
+
+    return passed;
+}
+
+void MainBench::writeJsonResults()
+{
+    if (m_parser.getJsonFile().isEmpty()) {
+        return;
+    }
+
+    QJsonObject parameters;
+    parameters.insert("test", m_parser.getTestStr());
+    parameters.insert("nbSamples", (double) m_parser.getNbSamples());
+    parameters.insert("repetition", (double) m_parser.getRepetition());
+    parameters.insert("log2Factor", (double) m_parser.getLog2Factor());
+    parameters.insert("rxSampleSize", SDR_RX_SAMP_SZ);
+    parameters.insert("cpuArchitecture", QSysInfo::currentCpuArchitecture());
+    parameters.insert("simdLevel", CPUFeatures::getLevelName(CPUFeatures::instance().getBestLevel()));
+
+    QJsonObject root;
+    root.insert("version", QCoreApplication::applicationVersion());
+    root.insert("parameters", parameters);
+    root.insert("results", m_jsonResults);
+    root.insert("failures", (double) m_nbFailures);
+
+    QFile file(m_parser.getJsonFile());
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning("MainBench::writeJsonResults: cannot open %s", qPrintable(m_parser.getJsonFile()));
+        return;
+    }
+
+    file.write(QJsonDocument(root).toJson());
+    file.close();
+    qInfo("MainBench::writeJsonResults: %d results written to %s", m_jsonResults.size(), qPrintable(m_parser.getJsonFile()));
 }
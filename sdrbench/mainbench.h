@@ -21,13 +21,18 @@
 #define SDRBENCH_MAINBENCH_H_
 
 #include <QObject>
+#include <QJsonArray>
+#include <QStringList>
 #include <random>
 #include <functional>
+#include <complex>
+#include <vector>
 
 #include "dsp/decimators.h"
 #include "dsp/decimatorsif.h"
 #include "dsp/decimatorsfi.h"
 #include "dsp/decimatorsff.h"
+#include "util/movingaverage.h"
 #include "parserbench.h"
 
 namespace qtwebapp {
@@ -41,6 +46,9 @@ public:
     explicit MainBench(qtwebapp::LoggerWithFile *logger, const ParserBench& parser, QObject *parent = 0);
     ~MainBench();
 
+    unsigned int getNbFailures() const { return m_nbFailures; }
+    static QStringList getTestNames(); //!< registered test names in run order followed by "all"
+
 public slots:
     void run();
 
@@ -48,18 +56,56 @@ signals:
     void finished();
 
 private:
-    void testDecimateII(ParserBench::TestType testType = ParserBench::TestDecimatorsII);
+    typedef void (MainBench::*TestFunction)();
+
+    struct TestEntry
+    {
+        const char *m_name;    //!< name given to the --test option
+        TestFunction m_test;
+        bool m_inAll;          //!< run as part of "all"
+    };
+
+    static const TestEntry m_tests[]; //!< test registry: add a test by adding a line here and its test function
+
+    void testDecimateII();
+    void testDecimateInfII();
+    void testDecimateSupII();
     void testDecimateIF();
     void testDecimateFI();
     void testDecimateFF();
     void testAMBE();
+    void testIQCorrection();
+    void testDecimateKernels();
+    void testDownChannelizer();
+    void testUpChannelizer();
+    void testFFTFilter();
+    void testSpectrumVis();
+    void testInterpolator();
+    void testSampleSinkFifo();
+    void testDemodSinks();
+    void testFEC();
+    void testADSB();
+    void testLDPC();
+    void testViterbi();
+    void testAudioMix();
+    void testIQCodec();
+    void testMessageQueue();
+    void testProjector();
+    void runTest(const TestEntry& test);
+    void benchDecimateII(const QString& prefix, void (MainBench::*decimate)(const qint16 *buf, int len));
     void decimateII(const qint16 *buf, int len);
     void decimateInfII(const qint16 *buf, int len);
     void decimateSupII(const qint16 *buf, int len);
     void decimateIF(const qint16 *buf, int len);
     void decimateFI(const float *buf, int len);
     void decimateFF(const float *buf, int len);
+    void iqCorrectionsReference(SampleVector& samples);
+    static void iqResidual(const SampleVector& samples, double& dcI, double& dcQ, double& phi, double& amp); //!< DC and imbalance left in the second half
+    void checkFFTFilter(const std::vector<std::complex<float>>& in, const std::vector<float>& inReal, int fftLength, unsigned int chunkSize); //!< block, real and batch paths against per sample
+    void createTestSamples(SampleVector& samples, unsigned int nbSamples); //!< FM modulated carrier with noise at -6 dBFS
     void printResults(const QString& prefix, qint64 nsecs);
+    bool checkResult(const QString& prefix, bool passed, const QString& details); //!< counts failures for the exit code
+    void writeJsonResults();
 
     static MainBench *m_instance;
     qtwebapp::LoggerWithFile *m_logger;
@@ -75,6 +121,21 @@ private:
 
     SampleVector m_convertBuffer;
     FSampleVector m_convertBufferF;
+    QJsonArray m_jsonResults;
+    QString m_currentTest;
+    unsigned int m_nbFailures;
+
+    static const unsigned int m_blockSize = 16384; //!< samples per feed or pull in streaming tests
+
+    // per sample DC + IQ corrections as formerly in DSPDeviceSourceEngine
+    MovingAverageUtil<int32_t, int64_t, 1024> m_iBeta;
+    MovingAverageUtil<int32_t, int64_t, 1024> m_qBeta;
+    MovingAverageUtil<float, double, 128> m_avgII;
+    MovingAverageUtil<float, double, 128> m_avgIQ;
+    MovingAverageUtil<double, double, 128> m_avgPhi;
+    MovingAverageUtil<float, double, 128> m_avgII2;
+    MovingAverageUtil<float, double, 128> m_avgQQ2;
+    MovingAverageUtil<double, double, 128> m_avgAmp;
 };
 
 #endif // SDRBENCH_MAINBENCH_H_
@@ -21,10 +21,11 @@
 #include <QDebug>
 
 #include "parserbench.h"
+#include "mainbench.h"
 
 ParserBench::ParserBench() :
     m_testOption(QStringList() << "t" << "test",
-        "Test type: decimateii, decimatefi, decimateff, decimateif, decimateinfii, decimatesupii, ambe",
+        "Test type: " + MainBench::getTestNames().join(", "),
         "test",
         "decimateii"),
     m_nbSamplesOption(QStringList() << "n" << "nb-samples",
@@ -38,7 +39,11 @@ ParserBench::ParserBench() :
     m_log2FactorOption(QStringList() << "l" << "log2-factor",
         "Log2 factor for rate conversion.",
         "log2",
-        "2")
+        "2"),
+    m_jsonFileOption(QStringList() << "j" << "json",
+        "Export results to this JSON file.",
+        "file",
+        "")
 {
     m_testStr = "decimateii";
     m_nbSamples = 1048576;
@@ -53,6 +58,7 @@ ParserBench::ParserBench() :
     m_parser.addOption(m_nbSamplesOption);
     m_parser.addOption(m_repetitionOption);
     m_parser.addOption(m_log2FactorOption);
+    m_parser.addOption(m_jsonFileOption);
 }
 
 ParserBench::~ParserBench()
@@ -111,23 +117,8 @@ void ParserBench::parse(const QCoreApplication& app)
     } else {
         qWarning() << "ParserBench::parse: repetilog2 factortion invalid. Defaulting to " << m_log2Factor;
     }
-}
 
-ParserBench::TestType ParserBench::getTestType() const
-{
-    if (m_testStr == "decimatefi") {
-        return TestDecimatorsFI;
-    } else if (m_testStr == "decimateff") {
-        return TestDecimatorsFF;
-    } else if (m_testStr == "decimateif") {
-        return TestDecimatorsIF;
-    } else if (m_testStr == "decimateinfii") {
-        return TestDecimatorsInfII;
-    } else if (m_testStr == "decimatesupii") {
-        return TestDecimatorsSupII;
-    } else if (m_testStr == "ambe") {
-        return TestAMBE;
-    } else {
-        return TestDecimatorsII;
-    }
+    // JSON results file
+
+    m_jsonFile = m_parser.value(m_jsonFileOption);
 }
@@ -25,39 +25,30 @@
 class ParserBench
 {
 public:
-    typedef enum
-    {
-        TestDecimatorsII,
-        TestDecimatorsIF,
-        TestDecimatorsFI,
-        TestDecimatorsFF,
-        TestDecimatorsInfII,
-        TestDecimatorsSupII,
-        TestAMBE
-    } TestType;
-
     ParserBench();
     ~ParserBench();
 
     void parse(const QCoreApplication& app);
 
     const QString& getTestStr() const { return m_testStr; }
-    TestType getTestType() const;
     uint32_t getNbSamples() const { return m_nbSamples; }
     uint32_t getRepetition() const { return m_repetition; }
     uint32_t getLog2Factor() const { return m_log2Factor; }
+    const QString& getJsonFile() const { return m_jsonFile; }
 
 private:
     QString  m_testStr;
     uint32_t m_nbSamples;
     uint32_t m_repetition;
     uint32_t m_log2Factor;
+    QString  m_jsonFile;
 
     QCommandLineParser m_parser;
     QCommandLineOption m_testOption;
     QCommandLineOption m_nbSamplesOption;
     QCommandLineOption m_repetitionOption;
     QCommandLineOption m_log2FactorOption;
+    QCommandLineOption m_jsonFileOption;
 };
 
 
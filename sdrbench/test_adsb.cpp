@@ -0,0 +1,176 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <vector>
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include "util/crc.h"
+#include "util/messagequeue.h"
+
+#ifdef BENCH_ADSB
+#include "adsbdemodsink.h"
+#include "adsbdemodsettings.h"
+#include "adsbdemodreport.h"
+#include "adsb.h"
+#endif
+
+#include "mainbench.h"
+
+#ifdef BENCH_ADSB
+
+namespace {
+
+int popADSBReports(MessageQueue& messageQueue)
+{
+    Message *message;
+    int nbFrames = 0;
+
+    while ((message = messageQueue.pop()))
+    {
+        nbFrames += ((ADSBDemodReport::MsgReportADSBBatch *) message)->getNbFrames();
+        delete message;
+    }
+
+    return nbFrames;
+}
+
+}
+
+void MainBench::testADSB()
+{
+    QElapsedTimer timer;
+    static const int samplesPerBitValues[] = {2, 4, 8};
+    static const int framePeriodBits = 1000; // one frame per millisecond i.e. a busy airspace
+    std::normal_distribution<float> noise(0.0f, 0.01f); // -40 dBFS
+    std::uniform_int_distribution<int> byteDistribution(0, 255);
+    std::uniform_real_distribution<float> phaseDistribution(-M_PI, M_PI);
+    unsigned int nbSamples = m_parser.getNbSamples();
+
+    for (int samplesPerBit : samplesPerBitValues)
+    {
+        qDebug() << "MainBench::testADSB: create test data: samples per bit:" << samplesPerBit;
+
+        // DF17 extended squitters with random address and payload at -6 dBFS on top of the noise
+        // and one in four DF11 all call replies to acquisition squitters
+        SampleVector samples(nbSamples);
+        int framePeriod = framePeriodBits * samplesPerBit;
+        int nbFrames = 0;
+
+        for (unsigned int i = 0; i < nbSamples; i++)
+        {
+            samples[i].setReal(noise(m_generator) * SDR_RX_SCALEF);
+            samples[i].setImag(noise(m_generator) * SDR_RX_SCALEF);
+        }
+
+        for (unsigned int start = framePeriod / 2; start + framePeriod <= nbSamples; start += framePeriod)
+        {
+            unsigned char data[ADS_B_ES_BYTES];
+            int nbBytes = nbFrames % 4 == 3 ? ADS_B_SHORT_BYTES : ADS_B_ES_BYTES;
+            data[0] = ((nbBytes == ADS_B_SHORT_BYTES ? 11 : 17) << 3) | 5;
+
+            for (int i = 1; i < nbBytes - 3; i++) {
+                data[i] = byteDistribution(m_generator);
+            }
+
+            crcadsb crc;
+            crc.calculate(data, nbBytes - 3);
+            int parity = crc.get();
+            data[nbBytes - 3] = (parity >> 16) & 0xff;
+            data[nbBytes - 2] = (parity >> 8) & 0xff;
+            data[nbBytes - 1] = parity & 0xff;
+
+            // preamble pulses on chips 0, 2, 7 and 9 then one pulse per bit in the first chip for 1 or in the second for 0
+            int samplesPerChip = samplesPerBit / ADS_B_CHIPS_PER_BIT;
+            std::vector<int> chips = {0, 2, 7, 9};
+
+            for (int bit = 0; bit < 8*nbBytes; bit++)
+            {
+                bool one = (data[bit / 8] >> (7 - (bit % 8))) & 1;
+                chips.push_back(ADS_B_PREAMBLE_CHIPS + 2*bit + (one ? 0 : 1));
+            }
+
+            float phase = phaseDistribution(m_generator);
+            FixReal re = 0.5f * std::cos(phase) * SDR_RX_SCALEF;
+            FixReal im = 0.5f * std::sin(phase) * SDR_RX_SCALEF;
+
+            for (int chip : chips)
+            {
+                for (int i = 0; i < samplesPerChip; i++)
+                {
+                    Sample& s = samples[start + chip*samplesPerChip + i];
+                    s.setReal(s.real() + re);
+                    s.setImag(s.imag() + im);
+                }
+            }
+
+            nbFrames++;
+        }
+
+        ADSBDemodSink sink;
+        ADSBDemodSettings settings;
+        MessageQueue messageQueue;
+        settings.m_samplesPerBit = samplesPerBit;
+        settings.m_correlationThreshold = -20.0f; // above noise correlation at all rates
+        sink.applySettings(settings, true);
+        sink.applyChannelSettings(ADS_B_BITS_PER_SECOND * samplesPerBit, 0, true); // no interpolation
+        sink.setMessageQueueToGUI(&messageQueue);
+        qint64 nsecs = 0;
+        int nbDecoded = 0;
+
+        qDebug() << "MainBench::testADSB: run test: frames:" << nbFrames;
+
+        for (uint32_t r = 0; r < m_parser.getRepetition(); r++)
+        {
+            timer.start();
+
+            // reports are consumed as they come as batches are recycled once their messages are deleted
+            for (unsigned int b = 0; b < nbSamples; b += m_blockSize)
+            {
+                sink.feed(samples.begin() + b, samples.begin() + (b + m_blockSize < nbSamples ? b + m_blockSize : nbSamples));
+                nbDecoded += popADSBReports(messageQueue);
+            }
+
+            sink.flushReports();
+            nbDecoded += popADSBReports(messageQueue);
+            nsecs += timer.nsecsElapsed();
+        }
+
+        QString prefix = QString("MainBench::testADSB: %1 samples per bit").arg(samplesPerBit);
+        printResults(prefix, nsecs);
+        double nsPerSample = nsecs / ((double) nbSamples * m_parser.getRepetition());
+        QDebug info = qInfo();
+        info.noquote();
+        info << tr("%1: decoded %2 of %3 frames - %4 frames/s - %5 % CPU per MS/s")
+            .arg(prefix)
+            .arg(nbDecoded)
+            .arg(nbFrames * m_parser.getRepetition())
+            .arg(nbDecoded / (nsecs * 1e-9))
+            .arg(nsPerSample / 10.0); // ns per sample * 1e6 S/s / 1e9 ns/s * 100 %
+    }
+}
+
+#else
+
+void MainBench::testADSB()
+{
+    qInfo("MainBench::testADSB: not available as sdrbench is built without the ADS-B demodulator plugin");
+}
+
+#endif // BENCH_ADSB
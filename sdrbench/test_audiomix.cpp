@@ -0,0 +1,128 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include "audio/audiofifo.h"
+#include "audio/audiomixkernels.h"
+
+#include "mainbench.h"
+
+void MainBench::testAudioMix()
+{
+    QElapsedTimer timer;
+    static const unsigned int nbFifos = 40;      // demodulators feeding the same audio output
+    static const unsigned int bufferSize = 1024; // samples per audio callback
+    CPUFeatures::SIMDLevel levels[] = {
+        CPUFeatures::SIMDGeneric,
+        CPUFeatures::SIMDSSE2,
+        CPUFeatures::SIMDAVX2,
+        CPUFeatures::SIMDNEON
+    };
+    // the number of samples is taken as the number of stereo samples output
+    unsigned int nbBuffers = std::max(1u, m_parser.getNbSamples() / bufferSize);
+
+    qDebug() << "MainBench::testAudioMix: create test data:"
+        << "fifos:" << nbFifos
+        << "buffers:" << nbBuffers;
+
+    std::uniform_int_distribution<int> sampleDistribution(-32768, 32767);
+    std::vector<AudioSample> in(bufferSize);
+
+    for (AudioSample& sample : in)
+    {
+        sample.l = sampleDistribution(m_generator);
+        sample.r = sampleDistribution(m_generator);
+    }
+
+    std::vector<std::unique_ptr<AudioFifo>> fifos;
+
+    for (unsigned int i = 0; i < nbFifos; i++) {
+        fifos.emplace_back(new AudioFifo(4 * bufferSize));
+    }
+
+    std::vector<qint32> mix(2 * bufferSize);
+    std::vector<AudioSample> out(bufferSize);
+    std::vector<CPUFeatures::SIMDLevel> levelsRun;
+
+    for (CPUFeatures::SIMDLevel level : levels)
+    {
+        AudioMixKernels::Accumulate accumulate;
+        AudioMixKernels::Saturate saturate;
+        CPUFeatures::SIMDLevel actualLevel;
+        AudioMixKernels::getKernels(level, accumulate, saturate, actualLevel);
+
+        if (std::find(levelsRun.begin(), levelsRun.end(), actualLevel) != levelsRun.end()) {
+            continue; // not available on this CPU
+        }
+
+        levelsRun.push_back(actualLevel);
+        qint64 nsecs = 0;
+
+        for (uint32_t r = 0; r < m_parser.getRepetition(); r++)
+        {
+            for (unsigned int b = 0; b < nbBuffers; b++)
+            {
+                // the producers are not timed
+                for (const std::unique_ptr<AudioFifo>& fifo : fifos) {
+                    fifo->write((const quint8*) in.data(), bufferSize);
+                }
+
+                // as in AudioOutput::readData
+                timer.start();
+                std::memset(mix.data(), 0, mix.size() * sizeof(qint32));
+
+                for (const std::unique_ptr<AudioFifo>& fifo : fifos)
+                {
+                    unsigned int samples = fifo->read((quint8*) out.data(), bufferSize);
+                    accumulate((const qint16*) out.data(), mix.data(), 2 * samples);
+                }
+
+                saturate(mix.data(), (qint16*) out.data(), 2 * bufferSize);
+                nsecs += timer.nsecsElapsed();
+            }
+        }
+
+        QString prefix = QString("MainBench::testAudioMix: %1 sources %2").arg(nbFifos).arg(CPUFeatures::getLevelName(actualLevel));
+        printResults(prefix, nsecs);
+        qInfo("%s: %.1f us per %u samples buffer",
+            qPrintable(prefix),
+            (nsecs * 1e-3) / (nbBuffers * (double) m_parser.getRepetition()),
+            bufferSize);
+
+        // all sources carry the same buffer so the mix is the saturated multiple of it
+        unsigned int mismatches = 0;
+
+        for (unsigned int i = 0; i < bufferSize; i++)
+        {
+            qint32 l = std::max(-32768, std::min(32767, in[i].l * (qint32) nbFifos));
+            qint32 r = std::max(-32768, std::min(32767, in[i].r * (qint32) nbFifos));
+
+            if ((out[i].l != l) || (out[i].r != r)) {
+                mismatches++;
+            }
+        }
+
+        checkResult(prefix, mismatches == 0, QString("%1 samples differ from the saturated sum").arg(mismatches));
+    }
+}
@@ -0,0 +1,151 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include "dsp/channelsamplesink.h"
+#include "dsp/channelsamplesource.h"
+#include "dsp/downchannelizer.h"
+#include "dsp/upchannelizer.h"
+
+#include "mainbench.h"
+
+namespace {
+
+// counts channel samples so that the channelizer output is consumed
+class BenchChannelSink : public ChannelSampleSink
+{
+public:
+    BenchChannelSink() : m_count(0) {}
+    virtual void feed(const SampleVector::const_iterator& begin, const SampleVector::const_iterator& end) {
+        m_count += end - begin;
+    }
+    quint64 m_count;
+};
+
+// replays the test samples in a loop
+class BenchChannelSource : public ChannelSampleSource
+{
+public:
+    BenchChannelSource(const SampleVector& samples) : m_samples(samples), m_index(0) {}
+    virtual void pull(SampleVector::iterator begin, unsigned int nbSamples)
+    {
+        for (unsigned int i = 0; i < nbSamples; i++) {
+            pullOne(*begin++);
+        }
+    }
+    virtual void pullOne(Sample& sample)
+    {
+        sample = m_samples[m_index];
+        m_index = m_index + 1 < m_samples.size() ? m_index + 1 : 0;
+    }
+    virtual void prefetch(unsigned int nbSamples) { (void) nbSamples; }
+private:
+    const SampleVector& m_samples;
+    unsigned int m_index;
+};
+
+}
+
+void MainBench::testDownChannelizer()
+{
+    QElapsedTimer timer;
+    unsigned int nbSamples = m_parser.getNbSamples();
+    unsigned int blockSize = m_blockSize;
+    int basebandSampleRate = 61440000;
+    int channelSampleRate = basebandSampleRate >> m_parser.getLog2Factor();
+    unsigned int pipelineMaxWorkers = DownChannelizer::getPipelineMaxWorkers();
+    int pipelineMinSampleRate = DownChannelizer::getPipelineMinSampleRate();
+
+    qDebug() << "MainBench::testDownChannelizer: create test data";
+
+    SampleVector samples;
+    createTestSamples(samples, nbSamples);
+
+    qDebug() << "MainBench::testDownChannelizer: run test";
+
+    // single thread then filter stages pipelined on worker threads
+    for (unsigned int nbWorkers = 0; nbWorkers <= 2; nbWorkers++)
+    {
+        DownChannelizer::setPipelineMaxWorkers(nbWorkers);
+        DownChannelizer::setPipelineMinSampleRate(0);
+        BenchChannelSink sink;
+        DownChannelizer channelizer(&sink);
+        channelizer.setBasebandSampleRate(basebandSampleRate);
+        channelizer.setChannelization(channelSampleRate, channelSampleRate / 4);
+        qint64 nsecs = 0;
+
+        if ((nbWorkers != 0) && !channelizer.isPipelined()) {
+            break; // single core or single stage
+        }
+
+        for (uint32_t i = 0; i < m_parser.getRepetition(); i++)
+        {
+            timer.start();
+
+            for (unsigned int b = 0; b < nbSamples; b += blockSize) {
+                channelizer.feed(samples.begin() + b, samples.begin() + (b + blockSize < nbSamples ? b + blockSize : nbSamples));
+            }
+
+            nsecs += timer.nsecsElapsed();
+        }
+
+        printResults(QString("MainBench::testDownChannelizer: %1 S/s -> %2 S/s %3 workers")
+            .arg(basebandSampleRate).arg(channelizer.getChannelSampleRate()).arg(nbWorkers), nsecs);
+        qDebug() << "MainBench::testDownChannelizer: channel samples:" << sink.m_count;
+    }
+
+    DownChannelizer::setPipelineMaxWorkers(pipelineMaxWorkers);
+    DownChannelizer::setPipelineMinSampleRate(pipelineMinSampleRate);
+}
+
+void MainBench::testUpChannelizer()
+{
+    QElapsedTimer timer;
+    qint64 nsecs = 0;
+    unsigned int nbSamples = m_parser.getNbSamples();
+    unsigned int blockSize = m_blockSize;
+    int basebandSampleRate = 3072000;
+    int channelSampleRate = basebandSampleRate >> m_parser.getLog2Factor();
+
+    qDebug() << "MainBench::testUpChannelizer: create test data";
+
+    SampleVector samples;
+    createTestSamples(samples, 48000);
+    BenchChannelSource source(samples);
+    UpChannelizer channelizer(&source);
+    channelizer.setBasebandSampleRate(basebandSampleRate);
+    channelizer.setChannelization(channelSampleRate, channelSampleRate / 4);
+    SampleVector baseband(blockSize);
+
+    qDebug() << "MainBench::testUpChannelizer: run test";
+
+    // nbSamples is the number of baseband samples pulled
+    for (uint32_t i = 0; i < m_parser.getRepetition(); i++)
+    {
+        timer.start();
+
+        for (unsigned int b = 0; b < nbSamples; b += blockSize) {
+            channelizer.pull(baseband.begin(), b + blockSize < nbSamples ? blockSize : nbSamples - b);
+        }
+
+        nsecs += timer.nsecsElapsed();
+    }
+
+    printResults(QString("MainBench::testUpChannelizer: %1 S/s -> %2 S/s").arg(channelizer.getChannelSampleRate()).arg(basebandSampleRate), nsecs);
+}
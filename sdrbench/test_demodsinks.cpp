@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include "audio/audiofifo.h"
+
+#ifdef BENCH_DEMODSINKS
+#include "nfmdemodsink.h"
+#include "amdemodsink.h"
+#include "ssbdemodsink.h"
+#include "wfmdemodsink.h"
+#include "bfmdemodsink.h"
+#endif
+#ifdef BENCH_ADSB
+#include "adsbdemodsink.h"
+#include "adsb.h"
+#endif
+
+#include "mainbench.h"
+
+#ifdef BENCH_DEMODSINKS
+
+namespace {
+
+// Feeds the sink block by block as the channel baseband does. The audio FIFO is
+// cleared after each block in place of the audio output thread.
+qint64 feedSink(ChannelSampleSink& sink, AudioFifo *audioFifo, const SampleVector& samples, unsigned int blockSize, uint32_t repetition)
+{
+    QElapsedTimer timer;
+    qint64 nsecs = 0;
+    unsigned int nbSamples = samples.size();
+
+    for (uint32_t i = 0; i < repetition; i++)
+    {
+        timer.start();
+
+        for (unsigned int b = 0; b < nbSamples; b += blockSize)
+        {
+            sink.feed(samples.begin() + b, samples.begin() + (b + blockSize < nbSamples ? b + blockSize : nbSamples));
+
+            if (audioFifo) {
+                audioFifo->clear();
+            }
+        }
+
+        nsecs += timer.nsecsElapsed();
+    }
+
+    return nsecs;
+}
+
+}
+
+void MainBench::testDemodSinks()
+{
+    unsigned int audioSampleRate = 48000;
+    qint64 nsecs;
+
+    qDebug() << "MainBench::testDemodSinks: create test data";
+
+    SampleVector samples;
+    createTestSamples(samples, m_parser.getNbSamples());
+
+    qDebug() << "MainBench::testDemodSinks: run test";
+
+    {
+        NFMDemodSink sink;
+        sink.applyChannelSettings(audioSampleRate, 0, true);
+        sink.applyAudioSampleRate(audioSampleRate);
+        nsecs = feedSink(sink, sink.getAudioFifo(), samples, m_blockSize, m_parser.getRepetition());
+        printResults(QString("MainBench::testDemodSinks: NFM %1 S/s").arg(audioSampleRate), nsecs);
+    }
+    {
+        AMDemodSink sink;
+        sink.applyChannelSettings(audioSampleRate, 0, true);
+        sink.applyAudioSampleRate(audioSampleRate);
+        nsecs = feedSink(sink, sink.getAudioFifo(), samples, m_blockSize, m_parser.getRepetition());
+        printResults(QString("MainBench::testDemodSinks: AM %1 S/s").arg(audioSampleRate), nsecs);
+    }
+    {
+        SSBDemodSink sink;
+        sink.applyChannelSettings(audioSampleRate, 0, true);
+        sink.applyAudioSampleRate(audioSampleRate);
+        nsecs = feedSink(sink, sink.getAudioFifo(), samples, m_blockSize, m_parser.getRepetition());
+        printResults(QString("MainBench::testDemodSinks: SSB %1 S/s").arg(audioSampleRate), nsecs);
+    }
+    {
+        WFMDemodSink sink;
+        int channelSampleRate = WFMDemodSettings::requiredBW(WFMDemodSettings().m_rfBandwidth);
+        sink.applyChannelSettings(channelSampleRate, 0, true);
+        sink.applyAudioSampleRate(audioSampleRate);
+        nsecs = feedSink(sink, sink.getAudioFifo(), samples, m_blockSize, m_parser.getRepetition());
+        printResults(QString("MainBench::testDemodSinks: WFM %1 S/s").arg(channelSampleRate), nsecs);
+    }
+    {
+        BFMDemodSink sink;
+        int channelSampleRate = BFMDemodSettings::requiredBW(BFMDemodSettings().m_rfBandwidth);
+        sink.applyChannelSettings(channelSampleRate, 0, true);
+        sink.applyAudioSampleRate(audioSampleRate);
+        nsecs = feedSink(sink, sink.getAudioFifo(), samples, m_blockSize, m_parser.getRepetition());
+        printResults(QString("MainBench::testDemodSinks: BFM %1 S/s").arg(channelSampleRate), nsecs);
+    }
+#ifdef BENCH_ADSB
+    {
+        ADSBDemodSink sink;
+        int channelSampleRate = ADS_B_BITS_PER_SECOND * ADSBDemodSettings().m_samplesPerBit;
+        sink.applyChannelSettings(channelSampleRate, 0, true);
+        nsecs = feedSink(sink, nullptr, samples, m_blockSize, m_parser.getRepetition());
+        printResults(QString("MainBench::testDemodSinks: ADS-B %1 S/s").arg(channelSampleRate), nsecs);
+    }
+#endif
+}
+
+#else
+
+void MainBench::testDemodSinks()
+{
+    qInfo("MainBench::testDemodSinks: not available as sdrbench is built without the channel plugins");
+}
+
+#endif // BENCH_DEMODSINKS
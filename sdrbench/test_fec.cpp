@@ -0,0 +1,242 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <vector>
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include "dsp/dsptypes.h"
+#include "channel/remotedatablock.h"
+#include "channel/remotefecpool.h"
+
+#ifdef HAS_CM256CC
+#include "cm256cc/cm256.h"
+#endif
+
+#include "mainbench.h"
+
+#ifdef HAS_CM256CC
+
+namespace {
+
+// one super-frame as sent with its recovery blocks and as received when the first nbFEC
+// original blocks are lost which is the worst case the decoder has to recover from
+struct FECBenchFrame
+{
+    int m_nbFEC;
+    RemoteProtectedBlock m_originals[RemoteNbOrginalBlocks];
+    RemoteProtectedBlock m_received[RemoteNbOrginalBlocks];
+    unsigned char m_receivedIndexes[RemoteNbOrginalBlocks];
+};
+
+int encodeFrame(CM256& cm256, const FECBenchFrame& frame, RemoteProtectedBlock *recovery)
+{
+    CM256::cm256_encoder_params params;
+    CM256::cm256_block descriptors[RemoteNbOrginalBlocks];
+    params.BlockBytes = sizeof(RemoteProtectedBlock);
+    params.OriginalCount = RemoteNbOrginalBlocks;
+    params.RecoveryCount = frame.m_nbFEC;
+
+    for (int i = 0; i < RemoteNbOrginalBlocks; i++)
+    {
+        descriptors[i].Block = (void *) &frame.m_originals[i];
+        descriptors[i].Index = i;
+    }
+
+    return cm256.cm256_encode(params, descriptors, recovery);
+}
+
+// the received blocks are copied as the decoder restores the lost blocks in place
+int decodeFrame(CM256& cm256, const FECBenchFrame& frame, RemoteProtectedBlock *work, CM256::cm256_block *descriptors)
+{
+    CM256::cm256_encoder_params params;
+    params.BlockBytes = sizeof(RemoteProtectedBlock);
+    params.OriginalCount = RemoteNbOrginalBlocks;
+    params.RecoveryCount = frame.m_nbFEC;
+    std::memcpy(work, frame.m_received, sizeof(frame.m_received));
+
+    for (int i = 0; i < RemoteNbOrginalBlocks; i++)
+    {
+        descriptors[i].Block = (void *) &work[i];
+        descriptors[i].Index = frame.m_receivedIndexes[i];
+    }
+
+    return cm256.cm256_decode(params, descriptors);
+}
+
+class FECBenchJob : public RemoteFECPool::Job
+{
+public:
+    FECBenchJob(std::vector<CM256*>& cm256s, const FECBenchFrame& frame, bool encode) :
+        m_cm256s(cm256s),
+        m_frame(frame),
+        m_encode(encode),
+        m_result(0)
+    {}
+
+    virtual void run(int workerIndex)
+    {
+        CM256& cm256 = *m_cm256s[workerIndex];
+        m_result = m_encode ? encodeFrame(cm256, m_frame, m_work) : decodeFrame(cm256, m_frame, m_work, m_descriptors);
+    }
+
+    int getResult() const { return m_result; }
+
+private:
+    std::vector<CM256*>& m_cm256s;
+    const FECBenchFrame& m_frame;
+    bool m_encode;
+    int m_result;
+    RemoteProtectedBlock m_work[256];
+    CM256::cm256_block m_descriptors[RemoteNbOrginalBlocks];
+};
+
+} // namespace
+
+void MainBench::testFEC()
+{
+    QElapsedTimer timer;
+    static const int nbFECValues[] = {8, 16, 32, 64, 128};
+    // a super-frame carries the samples in all original blocks but the first one with the meta data
+    unsigned int samplesPerFrame = ((RemoteNbOrginalBlocks - 1) * RemoteNbBytesPerBlock) / sizeof(Sample);
+    unsigned int nbFrames = (m_parser.getNbSamples() + samplesPerFrame - 1) / samplesPerFrame;
+    int nbWorkers = RemoteFECPool::getDefaultNbWorkers();
+
+    qDebug() << "MainBench::testFEC: create test data:"
+        << " frames: " << nbFrames
+        << " samples per frame: " << samplesPerFrame
+        << " workers: " << nbWorkers;
+
+    SampleVector samples;
+    createTestSamples(samples, samplesPerFrame);
+    FECBenchFrame *frame = new FECBenchFrame();
+    std::memset(frame->m_originals, 0, sizeof(frame->m_originals));
+    std::memcpy(&frame->m_originals[1], samples.data(), samplesPerFrame * sizeof(Sample));
+
+    for (int nbFEC : nbFECValues)
+    {
+        frame->m_nbFEC = nbFEC;
+
+        // sequential runs use a pool without workers that runs the jobs as they are pushed
+        for (int poolWorkers : {0, nbWorkers})
+        {
+            RemoteFECPool pool(poolWorkers);
+            std::vector<CM256*> cm256s;
+
+            for (int i = 0; i < pool.getNbContexts(); i++) {
+                cm256s.push_back(new CM256());
+            }
+
+            if (!cm256s[0]->isInitialized())
+            {
+                qWarning("MainBench::testFEC: cannot initialize CM256 library");
+                for (auto cm256 : cm256s) {
+                    delete cm256;
+                }
+                delete frame;
+                return;
+            }
+
+            // received frame: recovery blocks in place of the first nbFEC original blocks
+            RemoteProtectedBlock *recovery = new RemoteProtectedBlock[nbFEC];
+            encodeFrame(*cm256s[0], *frame, recovery);
+
+            for (int i = 0; i < RemoteNbOrginalBlocks; i++)
+            {
+                if (i < nbFEC)
+                {
+                    frame->m_received[i] = recovery[i];
+                    frame->m_receivedIndexes[i] = RemoteNbOrginalBlocks + i;
+                }
+                else
+                {
+                    frame->m_received[i] = frame->m_originals[i];
+                    frame->m_receivedIndexes[i] = i;
+                }
+            }
+
+            delete[] recovery;
+            QString workersStr = poolWorkers == 0 ? QString("sequential") : QString("%1 workers").arg(poolWorkers);
+
+            for (bool encode : {true, false})
+            {
+                // two jobs per context keep the workers busy while the oldest one is popped
+                std::vector<FECBenchJob*> jobs;
+                int nbFailed = 0;
+                qint64 nsecs = 0;
+
+                for (int i = 0; i < 2 * pool.getNbContexts(); i++) {
+                    jobs.push_back(new FECBenchJob(cm256s, *frame, encode));
+                }
+
+                for (uint32_t r = 0; r < m_parser.getRepetition(); r++)
+                {
+                    timer.start();
+
+                    for (unsigned int f = 0; f < nbFrames; f++)
+                    {
+                        if (f >= jobs.size()) {
+                            nbFailed += ((FECBenchJob *) pool.pop(true))->getResult() != 0 ? 1 : 0;
+                        }
+
+                        pool.push(jobs[f % jobs.size()]);
+                    }
+
+                    RemoteFECPool::Job *job;
+
+                    while ((job = pool.pop(true))) {
+                        nbFailed += ((FECBenchJob *) job)->getResult() != 0 ? 1 : 0;
+                    }
+
+                    nsecs += timer.nsecsElapsed();
+                }
+
+                if (nbFailed != 0) {
+                    qWarning("MainBench::testFEC: %d frames failed", nbFailed);
+                }
+
+                printResults(QString("MainBench::testFEC: %1 FEC %2 %3")
+                    .arg(encode ? "encode" : "decode").arg(nbFEC).arg(workersStr), nsecs);
+
+                for (auto job : jobs) {
+                    delete job;
+                }
+            }
+
+            for (auto cm256 : cm256s) {
+                delete cm256;
+            }
+
+            if (nbWorkers == 0) { // no pool runs on a single core host
+                break;
+            }
+        }
+    }
+
+    delete frame;
+}
+
+#else
+
+void MainBench::testFEC()
+{
+    qInfo("MainBench::testFEC: not available as sdrbench is built without the CM256cc library");
+}
+
+#endif // HAS_CM256CC
@@ -0,0 +1,320 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include "dsp/fftfilt.h"
+#include "dsp/interpolator.h"
+
+#include "mainbench.h"
+
+// per sample API output of a whole input
+template<typename Run>
+static void runPerSample(const std::vector<fftfilt::cmplx>& in, std::vector<fftfilt::cmplx>& out, Run run)
+{
+    fftfilt::cmplx *rf;
+    out.clear();
+
+    for (unsigned int s = 0; s < in.size(); s++)
+    {
+        int n = run(in[s], &rf);
+        out.insert(out.end(), rf, rf + n);
+    }
+}
+
+// block API output of a whole input fed in chunks
+template<typename T, typename Run>
+static void runPerBlock(const std::vector<T>& in, unsigned int chunkSize, int blockSize, std::vector<fftfilt::cmplx>& out, Run run)
+{
+    std::vector<fftfilt::cmplx> buf(chunkSize + blockSize);
+    out.clear();
+
+    for (unsigned int s = 0; s < in.size(); s += chunkSize)
+    {
+        int n = run(&in[s], std::min(chunkSize, (unsigned int) in.size() - s), buf.data());
+        out.insert(out.end(), buf.begin(), buf.begin() + n);
+    }
+}
+
+// largest difference relative to the reference peak magnitude. 1 if the sizes differ.
+static float maxDeviation(const std::vector<fftfilt::cmplx>& ref, const std::vector<fftfilt::cmplx>& out)
+{
+    if ((ref.size() != out.size()) || (ref.size() == 0)) {
+        return 1.0f;
+    }
+
+    float peak = 0.0f;
+    float deviation = 0.0f;
+
+    for (unsigned int i = 0; i < ref.size(); i++)
+    {
+        peak = std::max(peak, std::abs(ref[i]));
+        deviation = std::max(deviation, std::abs(out[i] - ref[i]));
+    }
+
+    return peak == 0.0f ? deviation : deviation / peak;
+}
+
+void MainBench::checkFFTFilter(const std::vector<std::complex<float>>& in, const std::vector<float>& inReal, int fftLength, unsigned int chunkSize)
+{
+    // float rounding of the FFTs. The real FFT takes a different path than the complex FFT.
+    const float tolerance = 1e-5f;
+    QString prefix = QString("MainBench::testFFTFilter: check %1").arg(fftLength);
+    std::vector<fftfilt::cmplx> inRealComplex(inReal.size());
+    std::vector<fftfilt::cmplx> ref;
+    std::vector<fftfilt::cmplx> out;
+    std::vector<fftfilt::cmplx> ref1;
+    std::vector<fftfilt::cmplx> out1;
+
+    for (unsigned int i = 0; i < inReal.size(); i++) {
+        inRealComplex[i] = fftfilt::cmplx(inReal[i], 0.0f);
+    }
+
+    fftfilt bandpass(-0.1f, 0.1f, fftLength);
+    fftfilt bandpassBlock(-0.1f, 0.1f, fftLength);
+    runPerSample(in, ref, [&](const fftfilt::cmplx& x, fftfilt::cmplx **rf) { return bandpass.runFilt(x, rf); });
+    runPerBlock(in, chunkSize, bandpassBlock.getBlockSize(), out,
+        [&](const fftfilt::cmplx *x, int n, fftfilt::cmplx *y) { return bandpassBlock.runFilt(x, n, y); });
+    float deviation = maxDeviation(ref, out);
+    checkResult(prefix + " runFilt block", deviation < tolerance, QString("max deviation %1 over %2 samples").arg(deviation).arg(out.size()));
+
+    fftfilt ssb(0.01f, 0.1f, fftLength);
+    fftfilt ssbBlock(0.01f, 0.1f, fftLength);
+    runPerSample(in, ref, [&](const fftfilt::cmplx& x, fftfilt::cmplx **rf) { return ssb.runSSB(x, rf, true); });
+    runPerBlock(in, chunkSize, ssbBlock.getBlockSize(), out,
+        [&](const fftfilt::cmplx *x, int n, fftfilt::cmplx *y) { return ssbBlock.runSSB(x, n, y, true); });
+    deviation = maxDeviation(ref, out);
+    checkResult(prefix + " runSSB block", deviation < tolerance, QString("max deviation %1 over %2 samples").arg(deviation).arg(out.size()));
+
+    fftfilt ssbRef(0.01f, 0.1f, fftLength);
+    fftfilt ssbReal(0.01f, 0.1f, fftLength);
+    runPerSample(inRealComplex, ref, [&](const fftfilt::cmplx& x, fftfilt::cmplx **rf) { return ssbRef.runSSB(x, rf, false); });
+    runPerBlock(inReal, chunkSize, ssbReal.getBlockSize(), out,
+        [&](const float *x, int n, fftfilt::cmplx *y) { return ssbReal.runSSB(x, n, y, false); });
+    deviation = maxDeviation(ref, out);
+    checkResult(prefix + " runSSB real block", deviation < tolerance, QString("max deviation %1 over %2 samples").arg(deviation).arg(out.size()));
+
+    fftfilt ref0Filter(-0.1f, 0.0f, fftLength);
+    fftfilt ref1Filter(0.0f, 0.1f, fftLength);
+    fftfilt batch0(-0.1f, 0.0f, fftLength);
+    fftfilt batch1(0.0f, 0.1f, fftLength);
+    fftfilt *batch[2] = {&batch0, &batch1};
+    std::vector<fftfilt::cmplx> buf0(chunkSize + fftLength);
+    std::vector<fftfilt::cmplx> buf1(chunkSize + fftLength);
+    fftfilt::cmplx *batchOut[2] = {buf0.data(), buf1.data()};
+    runPerSample(in, ref, [&](const fftfilt::cmplx& x, fftfilt::cmplx **rf) { return ref0Filter.runFilt(x, rf); });
+    runPerSample(in, ref1, [&](const fftfilt::cmplx& x, fftfilt::cmplx **rf) { return ref1Filter.runFilt(x, rf); });
+    out.clear();
+    out1.clear();
+
+    for (unsigned int s = 0; s < in.size(); s += chunkSize)
+    {
+        int n = fftfilt::runFiltBatch(batch, 2, &in[s], std::min(chunkSize, (unsigned int) in.size() - s), batchOut);
+        out.insert(out.end(), buf0.begin(), buf0.begin() + n);
+        out1.insert(out1.end(), buf1.begin(), buf1.begin() + n);
+    }
+
+    deviation = std::max(maxDeviation(ref, out), maxDeviation(ref1, out1));
+    checkResult(prefix + " runFiltBatch", deviation < tolerance, QString("max deviation %1 over %2 samples").arg(deviation).arg(out.size()));
+
+    fftfilt otherLength(-0.1f, 0.1f, 2 * fftLength);
+    fftfilt *mismatched[2] = {&bandpass, &otherLength};
+    checkResult(prefix + " runFiltBatch length mismatch", fftfilt::runFiltBatch(mismatched, 2, in.data(), chunkSize, batchOut) == -1,
+        "mixed filter lengths are not rejected");
+}
+
+void MainBench::testFFTFilter()
+{
+    QElapsedTimer timer;
+    unsigned int nbSamples = m_parser.getNbSamples();
+
+    qDebug() << "MainBench::testFFTFilter: create test data";
+
+    SampleVector samples;
+    createTestSamples(samples, nbSamples);
+    std::vector<fftfilt::cmplx> in(nbSamples);
+
+    std::vector<float> inReal(nbSamples);
+
+    for (unsigned int i = 0; i < nbSamples; i++)
+    {
+        in[i] = fftfilt::cmplx(samples[i].real(), samples[i].imag());
+        inReal[i] = samples[i].real();
+    }
+
+    qDebug() << "MainBench::testFFTFilter: run test";
+
+    // the block API is fed with chunks of the size channel sinks typically get
+    const unsigned int chunkSize = 1024;
+
+    // same filter lengths as the WFM RF filter and the SSB demodulator
+    int fftLengths[] = {1024, 2048};
+
+    for (unsigned int l = 0; l < sizeof(fftLengths)/sizeof(fftLengths[0]); l++)
+    {
+        checkFFTFilter(in, inReal, fftLengths[l], chunkSize);
+
+        fftfilt bandpass(-0.1f, 0.1f, fftLengths[l]);
+        fftfilt ssb(0.01f, 0.1f, fftLengths[l]);
+        fftfilt bandpassBlock(-0.1f, 0.1f, fftLengths[l]);
+        fftfilt ssbBlock(0.01f, 0.1f, fftLengths[l]);
+        fftfilt ssbReal(0.01f, 0.1f, fftLengths[l]);
+        fftfilt batch0(-0.1f, 0.0f, fftLengths[l]);
+        fftfilt batch1(0.0f, 0.1f, fftLengths[l]);
+        fftfilt *batch[2] = {&batch0, &batch1};
+        std::vector<fftfilt::cmplx> out0(chunkSize + fftLengths[l]);
+        std::vector<fftfilt::cmplx> out1(chunkSize + fftLengths[l]);
+        fftfilt::cmplx *batchOut[2] = {out0.data(), out1.data()};
+        fftfilt::cmplx *rf;
+        qint64 nsecsFilt = 0;
+        qint64 nsecsSSB = 0;
+        qint64 nsecsFiltBlock = 0;
+        qint64 nsecsSSBBlock = 0;
+        qint64 nsecsSSBReal = 0;
+        qint64 nsecsBatch = 0;
+        quint64 outCount = 0;
+
+        for (uint32_t i = 0; i < m_parser.getRepetition(); i++)
+        {
+            timer.start();
+
+            for (unsigned int s = 0; s < nbSamples; s++) {
+                outCount += bandpass.runFilt(in[s], &rf);
+            }
+
+            nsecsFilt += timer.nsecsElapsed();
+            timer.start();
+
+            for (unsigned int s = 0; s < nbSamples; s++) {
+                outCount += ssb.runSSB(in[s], &rf, true);
+            }
+
+            nsecsSSB += timer.nsecsElapsed();
+            timer.start();
+
+            for (unsigned int s = 0; s < nbSamples; s += chunkSize) {
+                outCount += bandpassBlock.runFilt(&in[s], std::min(chunkSize, nbSamples - s), out0.data());
+            }
+
+            nsecsFiltBlock += timer.nsecsElapsed();
+            timer.start();
+
+            for (unsigned int s = 0; s < nbSamples; s += chunkSize) {
+                outCount += ssbBlock.runSSB(&in[s], std::min(chunkSize, nbSamples - s), out0.data(), true);
+            }
+
+            nsecsSSBBlock += timer.nsecsElapsed();
+            timer.start();
+
+            for (unsigned int s = 0; s < nbSamples; s += chunkSize) {
+                outCount += ssbReal.runSSB(&inReal[s], std::min(chunkSize, nbSamples - s), out0.data(), true);
+            }
+
+            nsecsSSBReal += timer.nsecsElapsed();
+            timer.start();
+
+            for (unsigned int s = 0; s < nbSamples; s += chunkSize) {
+                outCount += fftfilt::runFiltBatch(batch, 2, &in[s], std::min(chunkSize, nbSamples - s), batchOut);
+            }
+
+            nsecsBatch += timer.nsecsElapsed();
+        }
+
+        printResults(QString("MainBench::testFFTFilter: runFilt %1").arg(fftLengths[l]), nsecsFilt);
+        printResults(QString("MainBench::testFFTFilter: runSSB %1").arg(fftLengths[l]), nsecsSSB);
+        printResults(QString("MainBench::testFFTFilter: runFilt block %1").arg(fftLengths[l]), nsecsFiltBlock);
+        printResults(QString("MainBench::testFFTFilter: runSSB block %1").arg(fftLengths[l]), nsecsSSBBlock);
+        printResults(QString("MainBench::testFFTFilter: runSSB real block %1").arg(fftLengths[l]), nsecsSSBReal);
+        printResults(QString("MainBench::testFFTFilter: runFiltBatch 2 filters %1").arg(fftLengths[l]), nsecsBatch);
+        qDebug() << "MainBench::testFFTFilter: output samples:" << outCount;
+    }
+}
+
+void MainBench::testInterpolator()
+{
+    QElapsedTimer timer;
+    unsigned int nbSamples = m_parser.getNbSamples();
+
+    qDebug() << "MainBench::testInterpolator: create test data";
+
+    SampleVector samples;
+    createTestSamples(samples, nbSamples);
+    std::vector<Complex> in(nbSamples);
+
+    for (unsigned int i = 0; i < nbSamples; i++) {
+        in[i] = Complex(samples[i].real(), samples[i].imag());
+    }
+
+    qDebug() << "MainBench::testInterpolator: run test";
+
+    // channel to audio rate as in the demodulators
+    Interpolator decimator;
+    Real decimatorDistance = 72000.0f / 48000.0f;
+    Real decimatorDistanceRemain = 0.0f;
+    decimator.create(16, 72000, 12500 / 2.2);
+    qint64 nsecs = 0;
+    quint64 outCount = 0;
+    Complex ci;
+
+    for (uint32_t i = 0; i < m_parser.getRepetition(); i++)
+    {
+        timer.start();
+
+        for (unsigned int s = 0; s < nbSamples; s++)
+        {
+            if (decimator.decimate(&decimatorDistanceRemain, in[s], &ci))
+            {
+                outCount++;
+                decimatorDistanceRemain += decimatorDistance;
+            }
+        }
+
+        nsecs += timer.nsecsElapsed();
+    }
+
+    printResults("MainBench::testInterpolator: decimate 72000 -> 48000 (input samples)", nsecs);
+
+    // audio to channel rate as in the modulators. nbSamples are output samples.
+    Interpolator interpolator;
+    Real interpolatorDistance = 48000.0f / 72000.0f;
+    Real interpolatorDistanceRemain = 0.0f;
+    interpolator.create(48, 48000, 12500 / 2.2, 3.0);
+    nsecs = 0;
+    unsigned int inIndex = 0;
+
+    for (uint32_t i = 0; i < m_parser.getRepetition(); i++)
+    {
+        timer.start();
+
+        for (unsigned int s = 0; s < nbSamples; s++)
+        {
+            if (interpolator.interpolate(&interpolatorDistanceRemain, in[inIndex], &ci)) {
+                inIndex = inIndex + 1 < nbSamples ? inIndex + 1 : 0;
+            }
+
+            interpolatorDistanceRemain += interpolatorDistance;
+        }
+
+        nsecs += timer.nsecsElapsed();
+    }
+
+    printResults("MainBench::testInterpolator: interpolate 48000 -> 72000 (output samples)", nsecs);
+    qDebug() << "MainBench::testInterpolator: output samples:" << outCount << "last:" << ci.real();
+}
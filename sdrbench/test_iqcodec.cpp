@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <vector>
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include "dsp/iqcodec.h"
+
+#include "mainbench.h"
+
+void MainBench::testIQCodec()
+{
+    QElapsedTimer timer;
+    static const unsigned int chunkSize = 1<<16; // samples coded independently as in the sdriq v2 chunks
+    static const int attenuations[] = {0, 30};   // dB below the -6 dBFS test signal
+    unsigned int nbSamples = m_parser.getNbSamples();
+    unsigned int nbChunks = (nbSamples + chunkSize - 1) / chunkSize;
+    unsigned int maxChunkBytes = IQCodec::getMaxEncodedSize(chunkSize, sizeof(FixReal));
+    SampleVector samples;
+
+    qDebug() << "MainBench::testIQCodec: create test data:"
+        << "samples:" << nbSamples
+        << "chunks:" << nbChunks;
+
+    createTestSamples(samples, nbSamples);
+    SampleVector decoded(nbSamples);
+    std::vector<quint8> coded(nbChunks * maxChunkBytes);
+    std::vector<unsigned int> codedSizes(nbChunks);
+
+    for (int attenuation : attenuations)
+    {
+        SampleVector in(samples);
+        int shift = attenuation / 6;
+
+        for (Sample& sample : in)
+        {
+            sample.setReal(sample.real() >> shift);
+            sample.setImag(sample.imag() >> shift);
+        }
+
+        qint64 encodeNsecs = 0;
+        qint64 decodeNsecs = 0;
+        quint64 codedBytes = 0;
+        int nbErrors = 0;
+
+        for (uint32_t r = 0; r < m_parser.getRepetition(); r++)
+        {
+            timer.start();
+
+            for (unsigned int c = 0; c < nbChunks; c++)
+            {
+                unsigned int n = std::min(chunkSize, nbSamples - c * chunkSize);
+                codedSizes[c] = IQCodec::encode((const FixReal *) &in[c * chunkSize], n, &coded[c * maxChunkBytes]);
+            }
+
+            encodeNsecs += timer.nsecsElapsed();
+            timer.start();
+
+            for (unsigned int c = 0; c < nbChunks; c++)
+            {
+                unsigned int n = std::min(chunkSize, nbSamples - c * chunkSize);
+                nbErrors += IQCodec::decode(&coded[c * maxChunkBytes], codedSizes[c], (FixReal *) &decoded[c * chunkSize], n) ? 0 : 1;
+            }
+
+            decodeNsecs += timer.nsecsElapsed();
+
+            for (unsigned int i = 0; i < nbSamples; i++) {
+                nbErrors += (decoded[i].real() != in[i].real()) || (decoded[i].imag() != in[i].imag()) ? 1 : 0;
+            }
+        }
+
+        for (unsigned int c = 0; c < nbChunks; c++) {
+            codedBytes += codedSizes[c];
+        }
+
+        QString prefix = QString("MainBench::testIQCodec: -%1 dBFS").arg(6 + 6 * shift);
+        printResults(prefix + " encode", encodeNsecs);
+        printResults(prefix + " decode", decodeNsecs);
+        checkResult(prefix,
+            nbErrors == 0,
+            QString("%1% of the raw size - %2 errors")
+                .arg((100.0 * codedBytes) / ((double) nbSamples * sizeof(Sample)), 0, 'f', 1)
+                .arg(nbErrors));
+    }
+}
@@ -0,0 +1,200 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QThread>
+
+#ifdef BENCH_DATV
+#include "leansdr/ldpc_minsum.h"
+#endif
+
+#include "mainbench.h"
+
+#ifdef BENCH_DATV
+
+namespace leansdr {
+// DVB-S2 LDPC tables as in dvbs2.h
+typedef ldpc_table<uint16_t> s2_ldpc_table;
+#include "leansdr/dvbs2_data.h"
+}
+
+namespace {
+
+struct LDPCBenchCode
+{
+    const char *m_name;
+    const leansdr::s2_ldpc_table *m_table;
+    int m_n;
+    float m_ebN0; //!< dB. A little above the waterfall so that some frames need many iterations.
+};
+
+}
+
+void MainBench::testLDPC()
+{
+    QElapsedTimer timer;
+    static const LDPCBenchCode codes[] = {
+        {"normal 1/2", &leansdr::ldpc_nf_fec12, 64800, 2.2f},
+        {"normal 3/4", &leansdr::ldpc_nf_fec34, 64800, 3.2f},
+        {"normal 9/10", &leansdr::ldpc_nf_fec910, 64800, 4.6f},
+        {"short 2/3", &leansdr::ldpc_sf_fec23, 16200, 3.2f}
+    };
+    static const int maxIterations = 25;
+    CPUFeatures::SIMDLevel levels[] = {
+        CPUFeatures::SIMDGeneric,
+        CPUFeatures::SIMDSSE2,
+        CPUFeatures::SIMDAVX2,
+        CPUFeatures::SIMDNEON
+    };
+    int nbWorkers = std::max(1, QThread::idealThreadCount() - 1);
+    std::uniform_int_distribution<int> byteDistribution(0, 255);
+
+    for (const LDPCBenchCode& benchCode : codes)
+    {
+        leansdr::ldpc_minsum_code code(benchCode.m_table, benchCode.m_n);
+        // the number of samples is taken as the number of code bits
+        unsigned int nbFrames = std::max(4u, m_parser.getNbSamples() / code.n);
+
+        qDebug() << "MainBench::testLDPC: create test data:"
+            << benchCode.m_name
+            << "frames:" << nbFrames
+            << "Eb/N0:" << benchCode.m_ebN0;
+
+        // BPSK over AWGN with LLRs quantized as by the DATV demodulator soft symbols
+        float rate = code.k / (float) code.n;
+        float sigma = std::sqrt(1.0f / (2.0f * rate * std::pow(10.0f, benchCode.m_ebN0 / 10.0f)));
+        float llrScale = 16.0f / (sigma * sigma); // 8 units per natural LLR unit
+        std::normal_distribution<float> noise(0.0f, sigma);
+        std::vector<uint8_t> codewords(nbFrames * (code.n / 8));
+        std::vector<int8_t> llrs(nbFrames * code.n);
+
+        for (unsigned int f = 0; f < nbFrames; f++)
+        {
+            uint8_t *codeword = &codewords[f * (code.n / 8)];
+
+            for (int i = 0; i < code.k / 8; i++) {
+                codeword[i] = byteDistribution(m_generator);
+            }
+
+            code.encode(codeword, codeword);
+
+            for (int i = 0; i < code.n; i++)
+            {
+                float y = ((codeword[i / 8] >> (7 - (i % 8))) & 1 ? -1.0f : 1.0f) + noise(m_generator);
+                llrs[f * code.n + i] = std::max(-127.0f, std::min(127.0f, std::round(y * llrScale)));
+            }
+        }
+
+        std::vector<uint8_t> bits(code.n / 8);
+        std::vector<CPUFeatures::SIMDLevel> levelsRun;
+
+        for (CPUFeatures::SIMDLevel level : levels)
+        {
+            leansdr::ldpc_minsum_decoder decoder(level);
+
+            if (std::find(levelsRun.begin(), levelsRun.end(), decoder.level) != levelsRun.end()) {
+                continue; // not available on this CPU
+            }
+
+            levelsRun.push_back(decoder.level);
+            qint64 nsecs = 0;
+            int nbErrors = 0;
+            int nbIterations = 0;
+
+            for (uint32_t r = 0; r < m_parser.getRepetition(); r++)
+            {
+                timer.start();
+
+                for (unsigned int f = 0; f < nbFrames; f++)
+                {
+                    int iterations = decoder.decode(&code, &llrs[f * code.n], bits.data(), maxIterations);
+                    nbIterations += iterations < 0 ? maxIterations : iterations;
+                    nbErrors += std::memcmp(bits.data(), &codewords[f * (code.n / 8)], code.n / 8) != 0 ? 1 : 0;
+                }
+
+                nsecs += timer.nsecsElapsed();
+            }
+
+            QString prefix = QString("MainBench::testLDPC: %1 %2").arg(benchCode.m_name).arg(CPUFeatures::getLevelName(decoder.level));
+            printResults(prefix, nsecs);
+            unsigned int nbDecoded = nbFrames * m_parser.getRepetition();
+            qInfo("%s: %.1f frames/s per core - %.1f iterations per frame - FER %g",
+                qPrintable(prefix),
+                nbDecoded / (nsecs * 1e-9),
+                nbIterations / (double) nbDecoded,
+                nbErrors / (double) nbDecoded);
+        }
+
+        // pool of workers with the best kernels
+        leansdr::ldpc_minsum_pool pool(nbWorkers, maxIterations);
+        qint64 nsecs = 0;
+        int nbErrors = 0;
+
+        for (uint32_t r = 0; r < m_parser.getRepetition(); r++)
+        {
+            unsigned int pushed = 0;
+            unsigned int popped = 0;
+            timer.start();
+
+            while (popped < nbFrames)
+            {
+                leansdr::ldpc_minsum_pool::job *job;
+
+                while ((pushed < nbFrames) && (job = pool.get_next()))
+                {
+                    job->code = &code;
+                    std::memcpy(job->llrs, &llrs[pushed * code.n], code.n);
+                    pool.push();
+                    pushed++;
+                }
+
+                if ((job = pool.front()))
+                {
+                    nbErrors += std::memcmp(job->bits, &codewords[popped * (code.n / 8)], code.n / 8) != 0 ? 1 : 0;
+                    pool.pop();
+                    popped++;
+                }
+                else
+                {
+                    QThread::yieldCurrentThread();
+                }
+            }
+
+            nsecs += timer.nsecsElapsed();
+        }
+
+        QString prefix = QString("MainBench::testLDPC: %1 pool of %2 workers").arg(benchCode.m_name).arg(nbWorkers);
+        printResults(prefix, nsecs);
+        unsigned int nbDecoded = nbFrames * m_parser.getRepetition();
+        qInfo("%s: %.1f frames/s - FER %g", qPrintable(prefix), nbDecoded / (nsecs * 1e-9), nbErrors / (double) nbDecoded);
+    }
+}
+
+#else
+
+void MainBench::testLDPC()
+{
+    qInfo("MainBench::testLDPC: not available as sdrbench is built without the DATV demodulator plugin");
+}
+
+#endif // BENCH_DATV
@@ -0,0 +1,157 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include "util/message.h"
+#include "util/messagepool.h"
+#include "util/messagequeue.h"
+
+#include "mainbench.h"
+
+namespace {
+
+// a small report as sent by the channel sinks
+class MsgBenchReport : public Message {
+    MESSAGE_CLASS_DECLARATION
+
+public:
+    MsgBenchReport(int producer, qint64 index) :
+        Message(),
+        m_producer(producer),
+        m_index(index)
+    { }
+
+    int getProducer() const { return m_producer; }
+    qint64 getIndex() const { return m_index; }
+
+private:
+    int m_producer;
+    qint64 m_index;
+};
+
+class MsgBenchPooledReport : public MsgBenchReport {
+    MESSAGE_CLASS_DECLARATION
+    MESSAGE_POOL_DECLARATION
+
+public:
+    MsgBenchPooledReport(int producer, qint64 index) :
+        MsgBenchReport(producer, index)
+    { }
+};
+
+MESSAGE_CLASS_DEFINITION(MsgBenchReport, Message)
+MESSAGE_CLASS_DEFINITION(MsgBenchPooledReport, MsgBenchReport)
+MESSAGE_POOL_DEFINITION(MsgBenchPooledReport)
+
+}
+
+void MainBench::testMessageQueue()
+{
+    QElapsedTimer timer;
+    static const int producers[] = {1, 2, 4};
+    unsigned int nbMessages = m_parser.getNbSamples();
+
+    qDebug() << "MainBench::testMessageQueue:"
+        << "messages:" << nbMessages
+        << "cores:" << QThread::idealThreadCount();
+
+    for (int pooled = 0; pooled < 2; pooled++)
+    {
+        for (int nbProducers : producers)
+        {
+            unsigned int nbPerProducer = nbMessages / nbProducers;
+            qint64 nsecs = 0;
+            qint64 nbWakeups = 0;
+            int nbErrors = 0;
+
+            for (uint32_t r = 0; r < m_parser.getRepetition(); r++)
+            {
+                MessageQueue queue;
+                std::atomic<qint64> wakeups(0);
+                QObject::connect(&queue, &MessageQueue::messageEnqueued, [&wakeups]() {
+                    wakeups.fetch_add(1, std::memory_order_relaxed);
+                });
+                std::vector<std::thread> threads;
+                std::vector<qint64> next(nbProducers, 0);
+                unsigned int popped = 0;
+                timer.start();
+
+                for (int p = 0; p < nbProducers; p++)
+                {
+                    threads.emplace_back([&queue, p, nbPerProducer, pooled]() {
+                        for (unsigned int i = 0; i < nbPerProducer; i++)
+                        {
+                            if (pooled) {
+                                queue.push(new MsgBenchPooledReport(p, i));
+                            } else {
+                                queue.push(new MsgBenchReport(p, i));
+                            }
+                        }
+                    });
+                }
+
+                // consumer: drain the queue like the message handlers do
+                while (popped < nbPerProducer * nbProducers)
+                {
+                    Message *message;
+                    bool idle = true;
+
+                    while ((message = queue.pop()) != nullptr)
+                    {
+                        const MsgBenchReport *report = (const MsgBenchReport *) message;
+                        // messages of a producer are received in order
+                        nbErrors += report->getIndex() == next[report->getProducer()]++ ? 0 : 1;
+                        delete message;
+                        popped++;
+                        idle = false;
+                    }
+
+                    if (idle) {
+                        QThread::yieldCurrentThread();
+                    }
+                }
+
+                nsecs += timer.nsecsElapsed();
+
+                for (std::thread& thread : threads) {
+                    thread.join();
+                }
+
+                nbWakeups += wakeups.load();
+            }
+
+            QString prefix = QString("MainBench::testMessageQueue: %1 %2 producers")
+                .arg(pooled ? "pooled" : "heap")
+                .arg(nbProducers);
+            printResults(prefix, nsecs);
+            qint64 nbReceived = (qint64) nbPerProducer * nbProducers * m_parser.getRepetition();
+            checkResult(prefix,
+                nbErrors == 0,
+                QString("%1 Mmessages/s - %2 wakeups per message - %3 errors")
+                    .arg(nbReceived / (nsecs * 1e-3), 0, 'f', 2)
+                    .arg(nbWakeups / (double) nbReceived, 0, 'f', 3)
+                    .arg(nbErrors));
+        }
+    }
+}
@@ -0,0 +1,152 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include "dsp/projector.h"
+#include "dsp/projectorkernels.h"
+
+#include "mainbench.h"
+
+void MainBench::testProjector()
+{
+    QElapsedTimer timer;
+    unsigned int nbSamples = m_parser.getNbSamples();
+    unsigned int blockSize = m_blockSize;
+
+    qDebug() << "MainBench::testProjector: create test data";
+
+    SampleVector samples;
+    createTestSamples(samples, nbSamples);
+    std::vector<Real> reference(nbSamples);
+    std::vector<Real> projected(nbSamples);
+
+    qDebug() << "MainBench::testProjector: run test";
+
+    const char *names[] = {"real", "imag", "maglin", "magsq", "magdb", "phase", "doap", "doan", "dphase", "bpsk", "qpsk", "8psk", "16psk"};
+
+    // per sample projection as in the former scope against block projection
+    for (int t = 0; t < (int) Projector::nbProjectionTypes; t++)
+    {
+        Projector perSample((Projector::ProjectionType) t);
+        Projector block((Projector::ProjectionType) t);
+        qint64 nsecsPerSample = 0;
+        qint64 nsecsBlock = 0;
+
+        for (uint32_t i = 0; i < m_parser.getRepetition(); i++)
+        {
+            timer.start();
+
+            for (unsigned int s = 0; s < nbSamples; s++) {
+                reference[s] = perSample.run(samples[s]);
+            }
+
+            nsecsPerSample += timer.nsecsElapsed();
+            timer.start();
+
+            for (unsigned int b = 0; b < nbSamples; b += blockSize) {
+                block.run(&samples[b], std::min(blockSize, nbSamples - b), &projected[b]);
+            }
+
+            nsecsBlock += timer.nsecsElapsed();
+        }
+
+        printResults(QString("MainBench::testProjector: %1 per sample").arg(names[t]), nsecsPerSample);
+        printResults(QString("MainBench::testProjector: %1 block").arg(names[t]), nsecsBlock);
+
+        // the phase derivative of the first sample depends on the previous run. Phase derived projections
+        // wrap with a period of 2 so a sample on a branch cut may land on the other side.
+        float maxDeviation = 0.0f;
+
+        for (unsigned int s = 1; s < nbSamples; s++)
+        {
+            if (std::isfinite(reference[s]) && std::isfinite(projected[s]))
+            {
+                float deviation = std::fabs(projected[s] - reference[s]);
+                maxDeviation = std::max(maxDeviation, std::min(deviation, std::fabs(2.0f - deviation)));
+            }
+        }
+
+        // 1e-5 radian normalized by pi for the phase projections and 1e-4 dB for magdb
+        float tolerance = t == (int) Projector::ProjectionMagDB ? 1e-4f : 1e-5f;
+        checkResult(QString("MainBench::testProjector: %1").arg(names[t]),
+            maxDeviation < tolerance,
+            QString("max deviation from per sample: %1").arg(maxDeviation));
+    }
+
+    // kernels for each SIMD level
+    qInfo("MainBench::testProjector: best projector kernels for this CPU: %s",
+        CPUFeatures::getLevelName(ProjectorKernels::instance().getLevel()));
+
+    CPUFeatures::SIMDLevel levels[] = {
+        CPUFeatures::SIMDGeneric,
+        CPUFeatures::SIMDSSE2,
+        CPUFeatures::SIMDAVX2,
+        CPUFeatures::SIMDNEON
+    };
+    std::vector<CPUFeatures::SIMDLevel> levelsRun;
+
+    for (unsigned int l = 0; l < sizeof(levels)/sizeof(levels[0]); l++)
+    {
+        ProjectorKernels kernels(levels[l]);
+
+        if (std::find(levelsRun.begin(), levelsRun.end(), kernels.getLevel()) != levelsRun.end()) {
+            continue; // not available on this CPU
+        }
+
+        levelsRun.push_back(kernels.getLevel());
+        qint64 nsecsMagSq = 0;
+        qint64 nsecsArg = 0;
+
+        for (uint32_t i = 0; i < m_parser.getRepetition(); i++)
+        {
+            timer.start();
+
+            for (unsigned int b = 0; b < nbSamples; b += blockSize) {
+                kernels.getMagSq()(&samples[b], &projected[b], std::min(blockSize, nbSamples - b));
+            }
+
+            nsecsMagSq += timer.nsecsElapsed();
+            timer.start();
+
+            for (unsigned int b = 0; b < nbSamples; b += blockSize) {
+                kernels.getArg()(&samples[b], &projected[b], std::min(blockSize, nbSamples - b), 1.0f);
+            }
+
+            nsecsArg += timer.nsecsElapsed();
+        }
+
+        printResults(QString("MainBench::testProjector: magsq kernel %1").arg(CPUFeatures::getLevelName(kernels.getLevel())), nsecsMagSq);
+        printResults(QString("MainBench::testProjector: arg kernel %1").arg(CPUFeatures::getLevelName(kernels.getLevel())), nsecsArg);
+
+        float maxDeviation = 0.0f;
+
+        for (unsigned int s = 0; s < nbSamples; s++)
+        {
+            float deviation = std::fabs(projected[s] - std::atan2((float) samples[s].m_imag, (float) samples[s].m_real));
+            maxDeviation = std::max(maxDeviation, std::min(deviation, std::fabs(2.0f * (float) M_PI - deviation)));
+        }
+
+        checkResult(QString("MainBench::testProjector: arg kernel %1").arg(CPUFeatures::getLevelName(kernels.getLevel())),
+            maxDeviation < 1e-5f,
+            QString("max deviation from atan2: %1 radian").arg(maxDeviation));
+    }
+}
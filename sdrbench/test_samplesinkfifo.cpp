@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <thread>
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include "dsp/samplesinkfifo.h"
+
+#include "mainbench.h"
+
+void MainBench::testSampleSinkFifo()
+{
+    QElapsedTimer timer;
+    qint64 nsecs = 0;
+    unsigned int nbSamples = m_parser.getNbSamples();
+    unsigned int blockSize = m_blockSize;
+    unsigned int fifoSize = 16 * blockSize;
+
+    qDebug() << "MainBench::testSampleSinkFifo: create test data";
+
+    SampleVector samples;
+    createTestSamples(samples, nbSamples);
+    SampleVector out(blockSize);
+    SampleSinkFifo fifo(fifoSize);
+
+    qDebug() << "MainBench::testSampleSinkFifo: run test";
+
+    // write and read back a block at a time in the same thread
+    for (uint32_t i = 0; i < m_parser.getRepetition(); i++)
+    {
+        timer.start();
+
+        for (unsigned int b = 0; b < nbSamples; b += blockSize)
+        {
+            unsigned int count = b + blockSize < nbSamples ? blockSize : nbSamples - b;
+            fifo.write(samples.begin() + b, samples.begin() + b + count);
+            fifo.read(out.begin(), out.begin() + count);
+        }
+
+        nsecs += timer.nsecsElapsed();
+    }
+
+    printResults("MainBench::testSampleSinkFifo: single thread", nsecs);
+
+    // device thread writing and DSP thread reading as in DSPDeviceSourceEngine.
+    // The producer waits for room so that no sample is dropped.
+    nsecs = 0;
+    fifo.reset();
+
+    for (uint32_t i = 0; i < m_parser.getRepetition(); i++)
+    {
+        std::atomic<quint64> consumed(0);
+        quint64 produced = 0;
+        quint64 total = nbSamples;
+
+        timer.start();
+
+        std::thread consumer([&fifo, &consumed, &out, total, blockSize]()
+        {
+            SampleVector::iterator part1Begin, part1End, part2Begin, part2End;
+
+            while (consumed.load(std::memory_order_relaxed) < total)
+            {
+                unsigned int count = fifo.fill();
+
+                if (count == 0)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                count = fifo.readBegin(count < blockSize ? count : blockSize, &part1Begin, &part1End, &part2Begin, &part2End);
+                std::copy(part2Begin, part2End, std::copy(part1Begin, part1End, out.begin()));
+                fifo.readCommit(count);
+                consumed.fetch_add(count, std::memory_order_release);
+            }
+        });
+
+        while (produced < total)
+        {
+            unsigned int count = produced + blockSize < total ? blockSize : total - produced;
+
+            if (produced + count - consumed.load(std::memory_order_acquire) > fifoSize)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            fifo.write(samples.begin() + produced, samples.begin() + produced + count);
+            produced += count;
+        }
+
+        consumer.join();
+        nsecs += timer.nsecsElapsed();
+    }
+
+    printResults("MainBench::testSampleSinkFifo: producer and consumer threads", nsecs);
+}
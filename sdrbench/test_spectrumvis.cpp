@@ -0,0 +1,207 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include "dsp/glspectruminterface.h"
+#include "dsp/glspectrumsettings.h"
+#include "dsp/spectrumvis.h"
+#include "dsp/spectrumkernels.h"
+
+#include "mainbench.h"
+
+namespace {
+
+// SpectrumVis does nothing unless a spectrum display is attached
+class BenchGLSpectrum : public GLSpectrumInterface
+{
+public:
+    BenchGLSpectrum() : m_count(0) {}
+    virtual void newSpectrum(const std::vector<Real>& spectrum, int fftSize) {
+        (void) spectrum;
+        (void) fftSize;
+        m_count++;
+    }
+    unsigned int m_count;
+};
+
+}
+
+void MainBench::testSpectrumVis()
+{
+    QElapsedTimer timer;
+    unsigned int nbSamples = m_parser.getNbSamples();
+    unsigned int blockSize = m_blockSize;
+
+    qDebug() << "MainBench::testSpectrumVis: create test data";
+
+    SampleVector samples;
+    createTestSamples(samples, nbSamples);
+
+    qDebug() << "MainBench::testSpectrumVis: run test";
+
+    struct {
+        int fftSize;
+        int overlap;
+        SpectrumVis::AvgMode avgMode;
+        unsigned int avgNb;
+        const char *name;
+    } configs[] = {
+        {1024, 0, SpectrumVis::AvgModeNone, 1, "1024 no averaging"},
+        {4096, 0, SpectrumVis::AvgModeNone, 1, "4096 no averaging"},
+        {4096, 50, SpectrumVis::AvgModeNone, 1, "4096 50% overlap"},
+        {4096, 0, SpectrumVis::AvgModeMovingAvg, 10, "4096 moving average 10"},
+        {4096, 0, SpectrumVis::AvgModeFixedAvg, 10, "4096 fixed average 10"},
+        {4096, 0, SpectrumVis::AvgModeMax, 10, "4096 max 10"}
+    };
+
+    for (unsigned int c = 0; c < sizeof(configs)/sizeof(configs[0]); c++)
+    {
+        BenchGLSpectrum glSpectrum;
+        SpectrumVis spectrumVis(SDR_RX_SCALEF);
+        spectrumVis.setGLSpectrum(&glSpectrum);
+        // applied synchronously as there is no event loop to process the input message queue
+        GLSpectrumSettings settings;
+        settings.m_fftSize = configs[c].fftSize;
+        settings.m_refLevel = 0.0f;
+        settings.m_powerRange = 100.0f;
+        settings.m_fftOverlap = configs[c].overlap;
+        settings.m_averagingMode = (GLSpectrumSettings::AveragingMode) configs[c].avgMode;
+        settings.m_averagingIndex = GLSpectrumSettings::getAveragingIndex(configs[c].avgNb, settings.m_averagingMode);
+        settings.m_fftWindow = FFTWindow::BlackmanHarris;
+        settings.m_linear = false;
+        SpectrumVis::MsgConfigureSpectrumVis *msg = SpectrumVis::MsgConfigureSpectrumVis::create(settings, true);
+        spectrumVis.handleMessage(*msg);
+        delete msg;
+        qint64 nsecs = 0;
+
+        for (uint32_t i = 0; i < m_parser.getRepetition(); i++)
+        {
+            timer.start();
+
+            for (unsigned int b = 0; b < nbSamples; b += blockSize) {
+                spectrumVis.feed(samples.begin() + b, samples.begin() + (b + blockSize < nbSamples ? b + blockSize : nbSamples), false);
+            }
+
+            nsecs += timer.nsecsElapsed();
+        }
+
+        printResults(QString("MainBench::testSpectrumVis: %1").arg(configs[c].name), nsecs);
+        bool expectSpectra = (quint64) nbSamples * m_parser.getRepetition() >= (quint64) configs[c].fftSize * configs[c].avgNb;
+        checkResult(QString("MainBench::testSpectrumVis: %1").arg(configs[c].name),
+            (spectrumVis.getSettings().m_fftSize == configs[c].fftSize) && (!expectSpectra || (glSpectrum.m_count > 0)),
+            QString("FFT size: %1 spectra: %2").arg(spectrumVis.getSettings().m_fftSize).arg(glSpectrum.m_count));
+    }
+
+    // power spectrum kernels against the former per bin log2f computation
+    unsigned int fftSize = 4096;
+    unsigned int nbFFTs = nbSamples / fftSize;
+
+    if (nbFFTs == 0) {
+        return;
+    }
+
+    std::vector<Complex> bins(nbFFTs * fftSize);
+    std::vector<Real> powers(fftSize);
+    std::vector<Real> reference(fftSize);
+    std::vector<Real> spectrum(fftSize);
+    Real mult = 10.0f / log2f(10.0f);
+    Real ofs = 20.0f * log10f(1.0f / fftSize);
+
+    for (unsigned int i = 0; i < bins.size(); i++) {
+        bins[i] = Complex(samples[i].real() / SDR_RX_SCALEF, samples[i].imag() / SDR_RX_SCALEF);
+    }
+
+    qint64 nsecs = 0;
+
+    for (uint32_t i = 0; i < m_parser.getRepetition(); i++)
+    {
+        timer.start();
+
+        for (unsigned int f = 0; f < nbFFTs; f++)
+        {
+            const Complex *fft = &bins[f * fftSize];
+
+            for (unsigned int b = 0; b < fftSize; b++)
+            {
+                Real v = fft[b].real() * fft[b].real() + fft[b].imag() * fft[b].imag();
+                reference[b] = mult * log2f(v) + ofs;
+            }
+        }
+
+        nsecs += timer.nsecsElapsed();
+    }
+
+    printResults("MainBench::testSpectrumVis: power kernel log2f", nsecs);
+
+    qInfo("MainBench::testSpectrumVis: best power kernel for this CPU: %s",
+        CPUFeatures::getLevelName(SpectrumKernels::instance().getLevel()));
+
+    CPUFeatures::SIMDLevel levels[] = {
+        CPUFeatures::SIMDGeneric,
+        CPUFeatures::SIMDSSE2,
+        CPUFeatures::SIMDAVX2,
+        CPUFeatures::SIMDNEON
+    };
+    std::vector<CPUFeatures::SIMDLevel> levelsRun;
+
+    for (unsigned int l = 0; l < sizeof(levels)/sizeof(levels[0]); l++)
+    {
+        SpectrumKernels::MagSq magSq;
+        SpectrumKernels::Log2Scale log2Scale;
+        CPUFeatures::SIMDLevel actualLevel;
+        SpectrumKernels::getKernels(levels[l], magSq, log2Scale, actualLevel);
+
+        if (std::find(levelsRun.begin(), levelsRun.end(), actualLevel) != levelsRun.end()) {
+            continue; // not available on this CPU
+        }
+
+        levelsRun.push_back(actualLevel);
+        nsecs = 0;
+
+        for (uint32_t i = 0; i < m_parser.getRepetition(); i++)
+        {
+            timer.start();
+
+            for (unsigned int f = 0; f < nbFFTs; f++)
+            {
+                magSq(&bins[f * fftSize], &powers[0], fftSize);
+                log2Scale(&powers[0], &spectrum[0], fftSize, mult, ofs);
+            }
+
+            nsecs += timer.nsecsElapsed();
+        }
+
+        printResults(QString("MainBench::testSpectrumVis: power kernel %1").arg(CPUFeatures::getLevelName(actualLevel)), nsecs);
+
+        // the last FFT is left in both buffers
+        float maxDeviation = 0.0f;
+
+        for (unsigned int b = 0; b < fftSize; b++) {
+            maxDeviation = std::max(maxDeviation, std::fabs(spectrum[b] - reference[b]));
+        }
+
+        // the kernels are as accurate as log2f up to float rounding
+        checkResult(QString("MainBench::testSpectrumVis: power kernel %1").arg(CPUFeatures::getLevelName(actualLevel)),
+            maxDeviation < 1e-4f,
+            QString("max deviation from log2f: %1 dB").arg(maxDeviation));
+    }
+}
@@ -0,0 +1,169 @@
+///////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2020 Edouard Griffiths, F4EXB                                   //
+//                                                                               //
+// This program is free software; you can redistribute it and/or modify          //
+// it under the terms of the GNU General Public License as published by          //
+// the Free Software Foundation as version 3 of the License, or                  //
+// (at your option) any later version.                                           //
+//                                                                               //
+// This program is distributed in the hope that it will be useful,               //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the                  //
+// GNU General Public License V3 for more details.                               //
+//                                                                               //
+// You should have received a copy of the GNU General Public License             //
+// along with this program. If not, see <http://www.gnu.org/licenses/>.          //
+///////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#ifdef BENCH_DATV
+#include "leansdr/framework.h"
+#include "leansdr/dvb.h"
+#endif
+
+#include "mainbench.h"
+
+#ifdef BENCH_DATV
+
+namespace {
+
+struct ViterbiBenchRate
+{
+    const char *m_name;
+    leansdr::code_rate m_rate;
+    float m_ebN0; //!< dB
+};
+
+}
+
+void MainBench::testViterbi()
+{
+    QElapsedTimer timer;
+    static const ViterbiBenchRate rates[] = {
+        {"1/2", leansdr::FEC12, 4.0f},
+        {"2/3", leansdr::FEC23, 4.5f},
+        {"3/4", leansdr::FEC34, 5.0f},
+        {"5/6", leansdr::FEC56, 5.5f},
+        {"7/8", leansdr::FEC78, 6.0f}
+    };
+    static const int amplitude = 64;
+    CPUFeatures::SIMDLevel levels[] = {
+        CPUFeatures::SIMDGeneric,
+        CPUFeatures::SIMDSSE2,
+        CPUFeatures::SIMDAVX2,
+        CPUFeatures::SIMDNEON
+    };
+
+    for (const ViterbiBenchRate& benchRate : rates)
+    {
+        const leansdr::fec_spec& fec = leansdr::fec_specs[benchRate.m_rate];
+        // the number of samples is taken as the number of coded bits
+        unsigned int nbBlocks = std::max(1024u, m_parser.getNbSamples() / fec.bits_out);
+
+        qDebug() << "MainBench::testViterbi: create test data:"
+            << benchRate.m_name
+            << "blocks:" << nbBlocks
+            << "Eb/N0:" << benchRate.m_ebN0;
+
+        // BPSK over AWGN. As in viterbi_sync the cost of a block is minus the sum of
+        // the squared distance margins between the two symbols i.e. 4*A*A*|y|.
+        float rate = fec.bits_in / (float) fec.bits_out;
+        float sigma = std::sqrt(1.0f / (2.0f * rate * std::pow(10.0f, benchRate.m_ebN0 / 10.0f)));
+        std::normal_distribution<float> noise(0.0f, sigma);
+        std::uniform_int_distribution<int> bitDistribution(0, 1);
+        std::vector<uint8_t> uncoded(nbBlocks);
+        std::vector<uint8_t> coded(nbBlocks);
+        std::vector<int32_t> costs(nbBlocks);
+        uint64_t state = 0; // last 6 uncoded bits, newest is bit 5
+
+        for (unsigned int b = 0; b < nbBlocks; b++)
+        {
+            uint64_t shiftreg = state;
+            uncoded[b] = 0;
+
+            for (int j = 0; j < fec.bits_in; j++)
+            {
+                int bit = bitDistribution(m_generator);
+                uncoded[b] = (uncoded[b] << 1) | bit;
+                shiftreg |= (uint64_t) bit << (6 + j);
+            }
+
+            coded[b] = 0;
+            costs[b] = 0;
+
+            for (int g = 0; g < fec.bits_out; g++)
+            {
+                int bit = leansdr::parity((uint64_t) (shiftreg & fec.polys[g]));
+                float y = (bit ? -1.0f : 1.0f) + noise(m_generator);
+                coded[b] = (coded[b] << 1) | (y < 0 ? 1 : 0);
+                costs[b] -= 4 * amplitude * amplitude * std::fabs(y);
+            }
+
+            state = shiftreg >> fec.bits_in;
+        }
+
+        std::vector<CPUFeatures::SIMDLevel> levelsRun;
+        int unitCost = fec.bits_out * 4 * amplitude * amplitude;
+        unsigned int delay = leansdr::viterbi_k7_dec::DELAY;
+
+        for (CPUFeatures::SIMDLevel level : levels)
+        {
+            CPUFeatures::SIMDLevel actualLevel = leansdr::viterbi_k7_dec(fec.bits_in, fec.bits_out, fec.polys, unitCost, level).level;
+
+            if (std::find(levelsRun.begin(), levelsRun.end(), actualLevel) != levelsRun.end()) {
+                continue; // not available on this CPU
+            }
+
+            levelsRun.push_back(actualLevel);
+            std::vector<uint8_t> decoded(nbBlocks);
+            qint64 nsecs = 0;
+            int nbErrors = 0;
+            int nbBits = 0;
+
+            for (uint32_t r = 0; r < m_parser.getRepetition(); r++)
+            {
+                leansdr::viterbi_k7_dec decoder(fec.bits_in, fec.bits_out, fec.polys, unitCost, level);
+                leansdr::viterbi_k7_dec::TPM quality;
+                timer.start();
+
+                for (unsigned int b = 0; b < nbBlocks; b++) {
+                    decoded[b] = decoder.update(coded[b], costs[b], &quality);
+                }
+
+                nsecs += timer.nsecsElapsed();
+
+                // decoded bits come DELAY bits later than the uncoded bits
+                for (unsigned int i = delay; i < nbBlocks * fec.bits_in; i++)
+                {
+                    unsigned int j = i - delay;
+                    int out = (decoded[i / fec.bits_in] >> (fec.bits_in - 1 - i % fec.bits_in)) & 1;
+                    int in = (uncoded[j / fec.bits_in] >> (fec.bits_in - 1 - j % fec.bits_in)) & 1;
+                    nbErrors += out != in ? 1 : 0;
+                    nbBits++;
+                }
+            }
+
+            QString prefix = QString("MainBench::testViterbi: %1 %2").arg(benchRate.m_name).arg(CPUFeatures::getLevelName(actualLevel));
+            printResults(prefix, nsecs);
+            qInfo("%s: %.2f Mb/s per core - BER %g",
+                qPrintable(prefix),
+                (nbBlocks * fec.bits_in * (double) m_parser.getRepetition()) / (nsecs * 1e-3),
+                nbErrors / (double) nbBits);
+        }
+    }
+}
+
+#else
+
+void MainBench::testViterbi()
+{
+    qInfo("MainBench::testViterbi: not available as sdrbench is built without the DATV demodulator plugin");
+}
+
+#endif // BENCH_DATV
@@ -29,6 +29,7 @@
 
 #include "dsp/dsptypes.h"
 #include "dsp/scopevis.h"
+#include "dsp/glscopeinterface.h"
 #include "gui/scaleengine.h"
 #include "gui/glshadercolors.h"
 #include "gui/glshadersimple.h"
@@ -39,7 +40,7 @@
 
 class QPainter;
 
-class SDRGUI_API GLScope: public QGLWidget {
+class SDRGUI_API GLScope: public QGLWidget, public GLScopeInterface {
     Q_OBJECT
 
 public:
@@ -57,31 +58,31 @@ public:
     void connectTimer(const QTimer& timer);
     void disconnectTimer();
 
-    void setTraces(std::vector<ScopeVis::TraceData>* tracesData, std::vector<float *>* traces);
-    void newTraces(std::vector<float *>* traces, int traceIndex, std::vector<Projector::ProjectionType>* projectionTypes);
+    virtual void setTraces(std::vector<ScopeVis::TraceData>* tracesData, std::vector<float *>* traces);
+    virtual void newTraces(std::vector<float *>* traces, int traceIndex, std::vector<Projector::ProjectionType>* projectionTypes);
 
     int getSampleRate() const { return m_sampleRate; }
     int getTraceSize() const { return m_traceSize; }
 
-    void setTriggerPre(uint32_t triggerPre, bool emitSignal = false); //!< number of samples
-    void setTimeOfsProMill(int timeOfsProMill);
-    void setSampleRate(int sampleRate);
-    void setTimeBase(int timeBase);
-    void setFocusedTraceIndex(uint32_t traceIndex);
+    virtual void setTriggerPre(uint32_t triggerPre, bool emitSignal = false); //!< number of samples
+    virtual void setTimeOfsProMill(int timeOfsProMill);
+    virtual void setSampleRate(int sampleRate);
+    virtual void setTimeBase(int timeBase);
+    virtual void setFocusedTraceIndex(uint32_t traceIndex);
     void setDisplayMode(DisplayMode displayMode);
-    void setTraceSize(int trceSize, bool emitSignal = false);
-    void updateDisplay();
+    virtual void setTraceSize(int trceSize, bool emitSignal = false);
+    virtual void updateDisplay();
     void setDisplayGridIntensity(int intensity);
     void setDisplayTraceIntensity(int intensity);
-    void setFocusedTriggerData(ScopeVis::TriggerData& triggerData) { m_focusedTriggerData = triggerData; }
-    void setConfigChanged() { m_configChanged = true; }
+    virtual void setFocusedTriggerData(ScopeVis::TriggerData& triggerData) { m_focusedTriggerData = triggerData; }
+    virtual void setConfigChanged() { m_configChanged = true; }
     //void incrementTraceCounter() { m_traceCounter++; }
 
     bool getDataChanged() const { return m_dataChanged; }
     DisplayMode getDisplayMode() const { return m_displayMode; }
     void setDisplayXYPoints(bool value) { m_displayXYPoints = value; }
     void setDisplayXYPolarGrid(bool value) { m_displayPolGrid = value; }
-    const QAtomicInt& getProcessingTraceIndex() const { return m_processingTraceIndex; }
+    virtual int getProcessingTraceIndex() const { return m_processingTraceIndex.load(); }
     void setTraceModulo(int modulo) { m_traceModulo = modulo; }
 
 signals:
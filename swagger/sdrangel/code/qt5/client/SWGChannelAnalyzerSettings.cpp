@@ -58,6 +58,12 @@ SWGChannelAnalyzerSettings::SWGChannelAnalyzerSettings() {
     m_rgb_color_isSet = false;
     title = nullptr;
     m_title_isSet = false;
+    ws_scope = 0;
+    m_ws_scope_isSet = false;
+    ws_scope_address = nullptr;
+    m_ws_scope_address_isSet = false;
+    ws_scope_port = 0;
+    m_ws_scope_port_isSet = false;
     spectrum_config = nullptr;
     m_spectrum_config_isSet = false;
     scope_config = nullptr;
@@ -100,6 +106,12 @@ SWGChannelAnalyzerSettings::init() {
     m_rgb_color_isSet = false;
     title = new QString("");
     m_title_isSet = false;
+    ws_scope = 0;
+    m_ws_scope_isSet = false;
+    ws_scope_address = new QString("");
+    m_ws_scope_address_isSet = false;
+    ws_scope_port = 0;
+    m_ws_scope_port_isSet = false;
     spectrum_config = new SWGGLSpectrum();
     m_spectrum_config_isSet = false;
     scope_config = new SWGGLScope();
@@ -125,6 +137,11 @@ SWGChannelAnalyzerSettings::cleanup() {
     if(title != nullptr) { 
         delete title;
     }
+
+    if(ws_scope_address != nullptr) { 
+        delete ws_scope_address;
+    }
+
     if(spectrum_config != nullptr) { 
         delete spectrum_config;
     }
@@ -174,6 +191,12 @@ SWGChannelAnalyzerSettings::fromJsonObject(QJsonObject &pJson) {
     
     ::SWGSDRangel::setValue(&title, pJson["title"], "QString", "QString");
     
+    ::SWGSDRangel::setValue(&ws_scope, pJson["wsScope"], "qint32", "");
+    
+    ::SWGSDRangel::setValue(&ws_scope_address, pJson["wsScopeAddress"], "QString", "QString");
+    
+    ::SWGSDRangel::setValue(&ws_scope_port, pJson["wsScopePort"], "qint32", "");
+    
     ::SWGSDRangel::setValue(&spectrum_config, pJson["spectrumConfig"], "SWGGLSpectrum", "SWGGLSpectrum");
     
     ::SWGSDRangel::setValue(&scope_config, pJson["scopeConfig"], "SWGGLScope", "SWGGLScope");
@@ -239,6 +262,15 @@ SWGChannelAnalyzerSettings::asJsonObject() {
     if(title != nullptr && *title != QString("")){
         toJsonValue(QString("title"), title, obj, QString("QString"));
     }
+    if(m_ws_scope_isSet){
+        obj->insert("wsScope", QJsonValue(ws_scope));
+    }
+    if(ws_scope_address != nullptr && *ws_scope_address != QString("")){
+        toJsonValue(QString("wsScopeAddress"), ws_scope_address, obj, QString("QString"));
+    }
+    if(m_ws_scope_port_isSet){
+        obj->insert("wsScopePort", QJsonValue(ws_scope_port));
+    }
     if((spectrum_config != nullptr) && (spectrum_config->isSet())){
         toJsonValue(QString("spectrumConfig"), spectrum_config, obj, QString("SWGGLSpectrum"));
     }
@@ -399,6 +431,36 @@ SWGChannelAnalyzerSettings::setTitle(QString* title) {
     this->m_title_isSet = true;
 }
 
+qint32
+SWGChannelAnalyzerSettings::getWsScope() {
+    return ws_scope;
+}
+void
+SWGChannelAnalyzerSettings::setWsScope(qint32 ws_scope) {
+    this->ws_scope = ws_scope;
+    this->m_ws_scope_isSet = true;
+}
+
+QString*
+SWGChannelAnalyzerSettings::getWsScopeAddress() {
+    return ws_scope_address;
+}
+void
+SWGChannelAnalyzerSettings::setWsScopeAddress(QString* ws_scope_address) {
+    this->ws_scope_address = ws_scope_address;
+    this->m_ws_scope_address_isSet = true;
+}
+
+qint32
+SWGChannelAnalyzerSettings::getWsScopePort() {
+    return ws_scope_port;
+}
+void
+SWGChannelAnalyzerSettings::setWsScopePort(qint32 ws_scope_port) {
+    this->ws_scope_port = ws_scope_port;
+    this->m_ws_scope_port_isSet = true;
+}
+
 SWGGLSpectrum*
 SWGChannelAnalyzerSettings::getSpectrumConfig() {
     return spectrum_config;
@@ -469,6 +531,15 @@ SWGChannelAnalyzerSettings::isSet(){
         if(title && *title != QString("")){
             isObjectUpdated = true; break;
         }
+        if(m_ws_scope_isSet){
+            isObjectUpdated = true; break;
+        }
+        if(ws_scope_address && *ws_scope_address != QString("")){
+            isObjectUpdated = true; break;
+        }
+        if(m_ws_scope_port_isSet){
+            isObjectUpdated = true; break;
+        }
         if(spectrum_config && spectrum_config->isSet()){
             isObjectUpdated = true; break;
         }
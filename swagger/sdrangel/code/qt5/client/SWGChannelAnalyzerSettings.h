@@ -89,6 +89,15 @@ public:
     QString* getTitle();
     void setTitle(QString* title);
 
+    qint32 getWsScope();
+    void setWsScope(qint32 ws_scope);
+
+    QString* getWsScopeAddress();
+    void setWsScopeAddress(QString* ws_scope_address);
+
+    qint32 getWsScopePort();
+    void setWsScopePort(qint32 ws_scope_port);
+
     SWGGLSpectrum* getSpectrumConfig();
     void setSpectrumConfig(SWGGLSpectrum* spectrum_config);
 
@@ -144,6 +153,15 @@ private:
     QString* title;
     bool m_title_isSet;
 
+    qint32 ws_scope;
+    bool m_ws_scope_isSet;
+
+    QString* ws_scope_address;
+    bool m_ws_scope_address_isSet;
+
+    qint32 ws_scope_port;
+    bool m_ws_scope_port_isSet;
+
     SWGGLSpectrum* spectrum_config;
     bool m_spectrum_config_isSet;
 
@@ -44,6 +44,12 @@ SWGFileSinkReport::SWGFileSinkReport() {
     m_record_size_isSet = false;
     record_captures = 0;
     m_record_captures_isSet = false;
+    write_latency = 0.0f;
+    m_write_latency_isSet = false;
+    write_latency_max = 0.0f;
+    m_write_latency_max_isSet = false;
+    dropped_buffers = 0L;
+    m_dropped_buffers_isSet = false;
 }
 
 SWGFileSinkReport::~SWGFileSinkReport() {
@@ -68,6 +74,12 @@ SWGFileSinkReport::init() {
     m_record_size_isSet = false;
     record_captures = 0;
     m_record_captures_isSet = false;
+    write_latency = 0.0f;
+    m_write_latency_isSet = false;
+    write_latency_max = 0.0f;
+    m_write_latency_max_isSet = false;
+    dropped_buffers = 0L;
+    m_dropped_buffers_isSet = false;
 }
 
 void
@@ -109,6 +121,12 @@ SWGFileSinkReport::fromJsonObject(QJsonObject &pJson) {
     
     ::SWGSDRangel::setValue(&record_captures, pJson["recordCaptures"], "qint32", "");
     
+    ::SWGSDRangel::setValue(&write_latency, pJson["writeLatency"], "float", "");
+    
+    ::SWGSDRangel::setValue(&write_latency_max, pJson["writeLatencyMax"], "float", "");
+    
+    ::SWGSDRangel::setValue(&dropped_buffers, pJson["droppedBuffers"], "qint64", "");
+    
 }
 
 QString
@@ -149,6 +167,15 @@ SWGFileSinkReport::asJsonObject() {
     if(m_record_captures_isSet){
         obj->insert("recordCaptures", QJsonValue(record_captures));
     }
+    if(m_write_latency_isSet){
+        obj->insert("writeLatency", QJsonValue(write_latency));
+    }
+    if(m_write_latency_max_isSet){
+        obj->insert("writeLatencyMax", QJsonValue(write_latency_max));
+    }
+    if(m_dropped_buffers_isSet){
+        obj->insert("droppedBuffers", QJsonValue(dropped_buffers));
+    }
 
     return obj;
 }
@@ -233,6 +260,36 @@ SWGFileSinkReport::setRecordCaptures(qint32 record_captures) {
     this->m_record_captures_isSet = true;
 }
 
+float
+SWGFileSinkReport::getWriteLatency() {
+    return write_latency;
+}
+void
+SWGFileSinkReport::setWriteLatency(float write_latency) {
+    this->write_latency = write_latency;
+    this->m_write_latency_isSet = true;
+}
+
+float
+SWGFileSinkReport::getWriteLatencyMax() {
+    return write_latency_max;
+}
+void
+SWGFileSinkReport::setWriteLatencyMax(float write_latency_max) {
+    this->write_latency_max = write_latency_max;
+    this->m_write_latency_max_isSet = true;
+}
+
+qint64
+SWGFileSinkReport::getDroppedBuffers() {
+    return dropped_buffers;
+}
+void
+SWGFileSinkReport::setDroppedBuffers(qint64 dropped_buffers) {
+    this->dropped_buffers = dropped_buffers;
+    this->m_dropped_buffers_isSet = true;
+}
+
 
 bool
 SWGFileSinkReport::isSet(){
@@ -262,6 +319,15 @@ SWGFileSinkReport::isSet(){
         if(m_record_captures_isSet){
             isObjectUpdated = true; break;
         }
+        if(m_write_latency_isSet){
+            isObjectUpdated = true; break;
+        }
+        if(m_write_latency_max_isSet){
+            isObjectUpdated = true; break;
+        }
+        if(m_dropped_buffers_isSet){
+            isObjectUpdated = true; break;
+        }
     }while(false);
     return isObjectUpdated;
 }
@@ -65,6 +65,15 @@ public:
     qint32 getRecordCaptures();
     void setRecordCaptures(qint32 record_captures);
 
+    float getWriteLatency();
+    void setWriteLatency(float write_latency);
+
+    float getWriteLatencyMax();
+    void setWriteLatencyMax(float write_latency_max);
+
+    qint64 getDroppedBuffers();
+    void setDroppedBuffers(qint64 dropped_buffers);
+
 
     virtual bool isSet() override;
 
@@ -93,6 +102,15 @@ private:
     qint32 record_captures;
     bool m_record_captures_isSet;
 
+    float write_latency;
+    bool m_write_latency_isSet;
+
+    float write_latency_max;
+    bool m_write_latency_max_isSet;
+
+    qint64 dropped_buffers;
+    bool m_dropped_buffers_isSet;
+
 };
 
 }
@@ -48,6 +48,10 @@ SWGFileSinkSettings::SWGFileSinkSettings() {
     m_squelch_post_record_time_isSet = false;
     squelch_recording_enable = 0;
     m_squelch_recording_enable_isSet = false;
+    direct_io = 0;
+    m_direct_io_isSet = false;
+    compressed = 0;
+    m_compressed_isSet = false;
     stream_index = 0;
     m_stream_index_isSet = false;
     use_reverse_api = 0;
@@ -88,6 +92,10 @@ SWGFileSinkSettings::init() {
     m_squelch_post_record_time_isSet = false;
     squelch_recording_enable = 0;
     m_squelch_recording_enable_isSet = false;
+    direct_io = 0;
+    m_direct_io_isSet = false;
+    compressed = 0;
+    m_compressed_isSet = false;
     stream_index = 0;
     m_stream_index_isSet = false;
     use_reverse_api = 0;
@@ -159,6 +167,10 @@ SWGFileSinkSettings::fromJsonObject(QJsonObject &pJson) {
     
     ::SWGSDRangel::setValue(&squelch_recording_enable, pJson["squelchRecordingEnable"], "qint32", "");
     
+    ::SWGSDRangel::setValue(&direct_io, pJson["directIO"], "qint32", "");
+    
+    ::SWGSDRangel::setValue(&compressed, pJson["compressed"], "qint32", "");
+    
     ::SWGSDRangel::setValue(&stream_index, pJson["streamIndex"], "qint32", "");
     
     ::SWGSDRangel::setValue(&use_reverse_api, pJson["useReverseAPI"], "qint32", "");
@@ -217,6 +229,12 @@ SWGFileSinkSettings::asJsonObject() {
     if(m_squelch_recording_enable_isSet){
         obj->insert("squelchRecordingEnable", QJsonValue(squelch_recording_enable));
     }
+    if(m_direct_io_isSet){
+        obj->insert("directIO", QJsonValue(direct_io));
+    }
+    if(m_compressed_isSet){
+        obj->insert("compressed", QJsonValue(compressed));
+    }
     if(m_stream_index_isSet){
         obj->insert("streamIndex", QJsonValue(stream_index));
     }
@@ -339,6 +357,26 @@ SWGFileSinkSettings::setSquelchRecordingEnable(qint32 squelch_recording_enable)
     this->m_squelch_recording_enable_isSet = true;
 }
 
+qint32
+SWGFileSinkSettings::getDirectIo() {
+    return direct_io;
+}
+void
+SWGFileSinkSettings::setDirectIo(qint32 direct_io) {
+    this->direct_io = direct_io;
+    this->m_direct_io_isSet = true;
+}
+
+qint32
+SWGFileSinkSettings::getCompressed() {
+    return compressed;
+}
+void
+SWGFileSinkSettings::setCompressed(qint32 compressed) {
+    this->compressed = compressed;
+    this->m_compressed_isSet = true;
+}
+
 qint32
 SWGFileSinkSettings::getStreamIndex() {
     return stream_index;
@@ -434,6 +472,12 @@ SWGFileSinkSettings::isSet(){
         if(m_squelch_recording_enable_isSet){
             isObjectUpdated = true; break;
         }
+        if(m_direct_io_isSet){
+            isObjectUpdated = true; break;
+        }
+        if(m_compressed_isSet){
+            isObjectUpdated = true; break;
+        }
         if(m_stream_index_isSet){
             isObjectUpdated = true; break;
         }
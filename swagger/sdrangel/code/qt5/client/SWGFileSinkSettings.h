@@ -72,6 +72,12 @@ public:
     qint32 getSquelchRecordingEnable();
     void setSquelchRecordingEnable(qint32 squelch_recording_enable);
 
+    qint32 getDirectIo();
+    void setDirectIo(qint32 direct_io);
+
+    qint32 getCompressed();
+    void setCompressed(qint32 compressed);
+
     qint32 getStreamIndex();
     void setStreamIndex(qint32 stream_index);
 
@@ -124,6 +130,12 @@ private:
     qint32 squelch_recording_enable;
     bool m_squelch_recording_enable_isSet;
 
+    qint32 direct_io;
+    bool m_direct_io_isSet;
+
+    qint32 compressed;
+    bool m_compressed_isSet;
+
     qint32 stream_index;
     bool m_stream_index_isSet;
 
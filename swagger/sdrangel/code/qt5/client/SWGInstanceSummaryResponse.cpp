@@ -44,6 +44,8 @@ SWGInstanceSummaryResponse::SWGInstanceSummaryResponse() {
     m_architecture_isSet = false;
     os = nullptr;
     m_os_isSet = false;
+    simd_kernels = nullptr;
+    m_simd_kernels_isSet = false;
     logging = nullptr;
     m_logging_isSet = false;
     devicesetlist = nullptr;
@@ -72,6 +74,8 @@ SWGInstanceSummaryResponse::init() {
     m_architecture_isSet = false;
     os = new QString("");
     m_os_isSet = false;
+    simd_kernels = new QString("");
+    m_simd_kernels_isSet = false;
     logging = new SWGLoggingInfo();
     m_logging_isSet = false;
     devicesetlist = new SWGDeviceSetList();
@@ -98,6 +102,9 @@ SWGInstanceSummaryResponse::cleanup() {
     if(os != nullptr) { 
         delete os;
     }
+    if(simd_kernels != nullptr) { 
+        delete simd_kernels;
+    }
     if(logging != nullptr) { 
         delete logging;
     }
@@ -133,6 +140,8 @@ SWGInstanceSummaryResponse::fromJsonObject(QJsonObject &pJson) {
     
     ::SWGSDRangel::setValue(&os, pJson["os"], "QString", "QString");
     
+    ::SWGSDRangel::setValue(&simd_kernels, pJson["simdKernels"], "QString", "QString");
+    
     ::SWGSDRangel::setValue(&logging, pJson["logging"], "SWGLoggingInfo", "SWGLoggingInfo");
     
     ::SWGSDRangel::setValue(&devicesetlist, pJson["devicesetlist"], "SWGDeviceSetList", "SWGDeviceSetList");
@@ -177,6 +186,9 @@ SWGInstanceSummaryResponse::asJsonObject() {
     if(os != nullptr && *os != QString("")){
         toJsonValue(QString("os"), os, obj, QString("QString"));
     }
+    if(simd_kernels != nullptr && *simd_kernels != QString("")){
+        toJsonValue(QString("simdKernels"), simd_kernels, obj, QString("QString"));
+    }
     if((logging != nullptr) && (logging->isSet())){
         toJsonValue(QString("logging"), logging, obj, QString("SWGLoggingInfo"));
     }
@@ -267,6 +279,16 @@ SWGInstanceSummaryResponse::setOs(QString* os) {
     this->m_os_isSet = true;
 }
 
+QString*
+SWGInstanceSummaryResponse::getSimdKernels() {
+    return simd_kernels;
+}
+void
+SWGInstanceSummaryResponse::setSimdKernels(QString* simd_kernels) {
+    this->simd_kernels = simd_kernels;
+    this->m_simd_kernels_isSet = true;
+}
+
 SWGLoggingInfo*
 SWGInstanceSummaryResponse::getLogging() {
     return logging;
@@ -316,6 +338,9 @@ SWGInstanceSummaryResponse::isSet(){
         if(os && *os != QString("")){
             isObjectUpdated = true; break;
         }
+        if(simd_kernels && *simd_kernels != QString("")){
+            isObjectUpdated = true; break;
+        }
         if(logging && logging->isSet()){
             isObjectUpdated = true; break;
         }
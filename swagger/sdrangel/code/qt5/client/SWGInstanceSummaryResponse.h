@@ -68,6 +68,9 @@ public:
     QString* getOs();
     void setOs(QString* os);
 
+    QString* getSimdKernels();
+    void setSimdKernels(QString* simd_kernels);
+
     SWGLoggingInfo* getLogging();
     void setLogging(SWGLoggingInfo* logging);
 
@@ -102,6 +105,9 @@ private:
     QString* os;
     bool m_os_isSet;
 
+    QString* simd_kernels;
+    bool m_simd_kernels_isSet;
+
     SWGLoggingInfo* logging;
     bool m_logging_isSet;
 
@@ -177,6 +177,7 @@
 #include "SWGSSBModSettings.h"
 #include "SWGSampleRate.h"
 #include "SWGSamplingDevice.h"
+#include "SWGSharedChannelizerSettings.h"
 #include "SWGSimplePTTActions.h"
 #include "SWGSimplePTTReport.h"
 #include "SWGSimplePTTSettings.h"
@@ -698,6 +699,9 @@ namespace SWGSDRangel {
     if(QString("SWGSamplingDevice").compare(type) == 0) {
       return new SWGSamplingDevice();
     }
+    if(QString("SWGSharedChannelizerSettings").compare(type) == 0) {
+      return new SWGSharedChannelizerSettings();
+    }
     if(QString("SWGSimplePTTActions").compare(type) == 0) {
       return new SWGSimplePTTActions();
     }
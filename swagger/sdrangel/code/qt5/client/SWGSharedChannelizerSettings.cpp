@@ -0,0 +1,131 @@
+/**
+ * SDRangel
+ * This is the web REST/JSON API of SDRangel SDR software. SDRangel is an Open Source Qt5/OpenGL 3.0+ (4.3+ in Windows) GUI and server Software Defined Radio and signal analyzer in software. It supports Airspy, BladeRF, HackRF, LimeSDR, PlutoSDR, RTL-SDR, SDRplay RSP1, USRP and FunCube    ---   Limitations and specifcities:    * In SDRangel GUI the first Rx device set cannot be deleted. Conversely the server starts with no device sets and its number of device sets can be reduced to zero by as many calls as necessary to /sdrangel/deviceset with DELETE method.   * Preset import and export from/to file is a server only feature.   * Device set focus is a GUI only feature.   * The following channels are not implemented (status 501 is returned): ATV and DATV demodulators, Channel Analyzer NG, LoRa demodulator   * The device settings and report structures contains only the sub-structure corresponding to the device type. The DeviceSettings and DeviceReport structures documented here shows all of them but only one will be or should be present at a time   * The channel settings and report structures contains only the sub-structure corresponding to the channel type. The ChannelSettings and ChannelReport structures documented here shows all of them but only one will be or should be present at a time    --- 
+ *
+ * OpenAPI spec version: 4.15.0
+ * Contact: f4exb06@gmail.com
+ *
+ * NOTE: This class is auto generated by the swagger code generator program.
+ * https://github.com/swagger-api/swagger-codegen.git
+ * Do not edit the class manually.
+ */
+
+
+#include "SWGSharedChannelizerSettings.h"
+
+#include "SWGHelpers.h"
+
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QObject>
+#include <QDebug>
+
+namespace SWGSDRangel {
+
+SWGSharedChannelizerSettings::SWGSharedChannelizerSettings(QString* json) {
+    init();
+    this->fromJson(*json);
+}
+
+SWGSharedChannelizerSettings::SWGSharedChannelizerSettings() {
+    enable = 0;
+    m_enable_isSet = false;
+    log2_subbands = 0;
+    m_log2_subbands_isSet = false;
+}
+
+SWGSharedChannelizerSettings::~SWGSharedChannelizerSettings() {
+    this->cleanup();
+}
+
+void
+SWGSharedChannelizerSettings::init() {
+    enable = 0;
+    m_enable_isSet = false;
+    log2_subbands = 0;
+    m_log2_subbands_isSet = false;
+}
+
+void
+SWGSharedChannelizerSettings::cleanup() {
+
+
+}
+
+SWGSharedChannelizerSettings*
+SWGSharedChannelizerSettings::fromJson(QString &json) {
+    QByteArray array (json.toStdString().c_str());
+    QJsonDocument doc = QJsonDocument::fromJson(array);
+    QJsonObject jsonObject = doc.object();
+    this->fromJsonObject(jsonObject);
+    return this;
+}
+
+void
+SWGSharedChannelizerSettings::fromJsonObject(QJsonObject &pJson) {
+    ::SWGSDRangel::setValue(&enable, pJson["enable"], "qint32", "");
+    
+    ::SWGSDRangel::setValue(&log2_subbands, pJson["log2Subbands"], "qint32", "");
+    
+}
+
+QString
+SWGSharedChannelizerSettings::asJson ()
+{
+    QJsonObject* obj = this->asJsonObject();
+
+    QJsonDocument doc(*obj);
+    QByteArray bytes = doc.toJson();
+    delete obj;
+    return QString(bytes);
+}
+
+QJsonObject*
+SWGSharedChannelizerSettings::asJsonObject() {
+    QJsonObject* obj = new QJsonObject();
+    if(m_enable_isSet){
+        obj->insert("enable", QJsonValue(enable));
+    }
+    if(m_log2_subbands_isSet){
+        obj->insert("log2Subbands", QJsonValue(log2_subbands));
+    }
+
+    return obj;
+}
+
+qint32
+SWGSharedChannelizerSettings::getEnable() {
+    return enable;
+}
+void
+SWGSharedChannelizerSettings::setEnable(qint32 enable) {
+    this->enable = enable;
+    this->m_enable_isSet = true;
+}
+
+qint32
+SWGSharedChannelizerSettings::getLog2Subbands() {
+    return log2_subbands;
+}
+void
+SWGSharedChannelizerSettings::setLog2Subbands(qint32 log2_subbands) {
+    this->log2_subbands = log2_subbands;
+    this->m_log2_subbands_isSet = true;
+}
+
+
+bool
+SWGSharedChannelizerSettings::isSet(){
+    bool isObjectUpdated = false;
+    do{
+        if(m_enable_isSet){
+            isObjectUpdated = true; break;
+        }
+        if(m_log2_subbands_isSet){
+            isObjectUpdated = true; break;
+        }
+    }while(false);
+    return isObjectUpdated;
+}
+}
+